@@ -77,7 +77,7 @@ CommonPluginEditor::CommonPluginEditor(CommonAudioProcessor& p, juce::String app
     visualiserSettings.setColour(juce::ResizableWindow::backgroundColourId, Colours::dark());
 
     recordingSettings.setLookAndFeel(&getLookAndFeel());
-    recordingSettings.setSize(300, 330);
+    recordingSettings.setSize(300, 435);
 #if JUCE_WINDOWS
     // if not standalone, use native title bar for compatibility with DAWs
     recordingSettingsWindow.setUsingNativeTitleBar(processor.wrapperType == juce::AudioProcessor::WrapperType::wrapperType_Standalone);
@@ -344,7 +344,7 @@ void CommonPluginEditor::saveProject() {
         saveProjectAs();
     } else {
         auto data = juce::MemoryBlock();
-        audioProcessor.getStateInformation(data);
+        audioProcessor.getProjectFileData(data);
         auto file = juce::File(audioProcessor.currentProjectFile);
         file.create();
         file.replaceWithData(data.getData(), data.getSize());
@@ -432,119 +432,139 @@ void CommonPluginEditor::renderAudioFileToVideo() {
             return;
 
         safeThis->audioProcessor.setLastOpenedDirectory(inputFile.getParentDirectory());
+        safeThis->renderAudioFileToVideo(inputFile);
+    });
+#endif
+}
 
-        // Step 2: choose output video file (default: inputName + codec extension)
-        const auto ext = safeThis->recordingSettings.getFileExtensionForCodec();
-        const auto suggestedOutput = inputFile.getParentDirectory().getChildFile(
-            inputFile.getFileNameWithoutExtension() + "." + ext);
-
-        safeThis->chooser = std::make_unique<juce::FileChooser>(
-            "Choose an output video file",
-            suggestedOutput,
-            "*." + ext);
+void CommonPluginEditor::renderAudioFileToVideo(const juce::File& inputFile) {
+#if !OSCI_PREMIUM
+    showPremiumSplashScreen();
+    return;
+#else
+    if (offlineRenderDialog != nullptr) {
+        offlineRenderDialog->toFront(true);
+        return;
+    }
 
-        auto saveFlags = juce::FileBrowserComponent::saveMode |
-            juce::FileBrowserComponent::canSelectFiles;
+    juce::Component::SafePointer<CommonPluginEditor> safeThis(this);
 
-        safeThis->chooser->launchAsync(saveFlags, [safeThis, inputFile, ext](const juce::FileChooser& outputChooser) {
-            if (safeThis == nullptr)
-                return;
+    // Step 2: choose output video file (default: inputName + codec extension)
+    const auto ext = recordingSettings.getFileExtensionForCodec();
+    const auto suggestedOutput = inputFile.getParentDirectory().getChildFile(
+        inputFile.getFileNameWithoutExtension() + "." + ext);
 
-            auto outputFile = outputChooser.getResult();
-            if (outputFile == juce::File())
-                return;
+    chooser = std::make_unique<juce::FileChooser>(
+        "Choose an output video file",
+        suggestedOutput,
+        "*." + ext);
 
-            // Ensure the file extension matches the codec container by default.
-            if (outputFile.getFileExtension().isEmpty())
-                outputFile = outputFile.withFileExtension(ext);
+    auto saveFlags = juce::FileBrowserComponent::saveMode |
+        juce::FileBrowserComponent::canSelectFiles;
 
-            safeThis->audioProcessor.setLastOpenedDirectory(outputFile.getParentDirectory());
+    chooser->launchAsync(saveFlags, [safeThis, inputFile, ext](const juce::FileChooser& outputChooser) {
+        if (safeThis == nullptr)
+            return;
 
-            // Ensure FFmpeg exists. If it doesn't, this will prompt the user to download it.
-            if (!safeThis->audioProcessor.ensureFFmpegExists())
-                return;
+        auto outputFile = outputChooser.getResult();
+        if (outputFile == juce::File())
+            return;
 
-            // Stop any live recording and pause the main visualiser.
-            if (safeThis->audioProcessor.haltRecording != nullptr)
-                safeThis->audioProcessor.haltRecording();
+        // Ensure the file extension matches the codec container by default.
+        if (outputFile.getFileExtension().isEmpty())
+            outputFile = outputFile.withFileExtension(ext);
 
-            const bool wasVisualiserVisible = safeThis->visualiser.isVisible();
-            const bool wasOfflineRenderActive = safeThis->audioProcessor.isOfflineRenderActive();
+        safeThis->audioProcessor.setLastOpenedDirectory(outputFile.getParentDirectory());
 
-            // Make the plugin output silent and skip heavy processing during offline render.
-            safeThis->audioProcessor.setOfflineRenderActive(true);
-            safeThis->visualiser.setVisible(false);
+        // Ensure FFmpeg exists. If it doesn't, this will prompt the user to download it.
+        if (!safeThis->audioProcessor.ensureFFmpegExists())
+            return;
 
-            auto resultHolder = std::make_shared<std::optional<OfflineAudioToVideoRendererComponent::Result>>();
+        // Stop any live recording and pause the main visualiser.
+        if (safeThis->audioProcessor.haltRecording != nullptr)
+            safeThis->audioProcessor.haltRecording();
 
-            auto content = std::make_unique<OfflineAudioToVideoRendererComponent>(
-                safeThis->audioProcessor,
-                safeThis->audioProcessor.visualiserParameters,
-                safeThis->audioProcessor.threadManager,
-                safeThis->recordingSettings,
-                inputFile,
-                outputFile,
-                safeThis->visualiser.getRenderMode());
+        const bool wasVisualiserVisible = safeThis->visualiser.isVisible();
+        const bool wasOfflineRenderActive = safeThis->audioProcessor.isOfflineRenderActive();
 
-            content->setSize(700, 520);
+        // Make the plugin output silent and skip heavy processing during offline render.
+        safeThis->audioProcessor.setOfflineRenderActive(true);
+        safeThis->visualiser.setVisible(false);
 
-            // When the render finishes, store the result and dismiss the modal dialog.
-            content->setOnFinished([safeThis, resultHolder](OfflineAudioToVideoRendererComponent::Result r) {
-                if (safeThis == nullptr)
-                    return;
+        auto resultHolder = std::make_shared<std::optional<OfflineAudioToVideoRendererComponent::Result>>();
 
-                *resultHolder = r;
+        auto content = std::make_unique<OfflineAudioToVideoRendererComponent>(
+            safeThis->audioProcessor,
+            safeThis->audioProcessor.visualiserParameters,
+            safeThis->audioProcessor.threadManager,
+            safeThis->recordingSettings,
+            inputFile,
+            outputFile,
+            safeThis->visualiser.getRenderMode());
 
-                if (auto* dw = safeThis->offlineRenderDialog.getComponent())
-                    dw->exitModalState(1);
-            });
+        content->setSize(700, 520);
 
-            auto* contentPtr = content.get();
+        // Render just the region selected on the timeline when it's this file.
+        const auto selection = safeThis->audioProcessor.wavParser.getLoopRange();
+        if (inputFile == safeThis->audioProcessor.getLoadedAudioFile() && !selection.isEmpty())
+            content->setRenderRange(selection);
 
-            juce::DialogWindow::LaunchOptions options;
-            options.dialogTitle = "Render Audio File to Video";
-            options.dialogBackgroundColour = Colours::dark();
-            options.content.setOwned(content.release());
-            options.componentToCentreAround = safeThis.getComponent();
-            options.escapeKeyTriggersCloseButton = true;
-            options.useNativeTitleBar = true;
-            options.resizable = true;
-            options.useBottomRightCornerResizer = true;
+        // When the render finishes, store the result and dismiss the modal dialog.
+        content->setOnFinished([safeThis, resultHolder](OfflineAudioToVideoRendererComponent::Result r) {
+            if (safeThis == nullptr)
+                return;
 
-            // Create the dialog and enter modal state with a callback so we restore state
-            // regardless of how the dialog is dismissed. The window will auto-delete.
-            auto* window = options.create();
-            safeThis->offlineRenderDialog = window;
+            *resultHolder = r;
 
-            // Ensure this dialog doesn't float above other apps.
-            window->setAlwaysOnTop(false);
+            if (auto* dw = safeThis->offlineRenderDialog.getComponent())
+                dw->exitModalState(1);
+        });
 
-            window->enterModalState(
-                true,
-                juce::ModalCallbackFunction::create([safeThis, wasVisualiserVisible, wasOfflineRenderActive, resultHolder](int) {
-                    if (safeThis == nullptr)
-                        return;
+        auto* contentPtr = content.get();
+
+        juce::DialogWindow::LaunchOptions options;
+        options.dialogTitle = "Render Audio File to Video";
+        options.dialogBackgroundColour = Colours::dark();
+        options.content.setOwned(content.release());
+        options.componentToCentreAround = safeThis.getComponent();
+        options.escapeKeyTriggersCloseButton = true;
+        options.useNativeTitleBar = true;
+        options.resizable = true;
+        options.useBottomRightCornerResizer = true;
+
+        // Create the dialog and enter modal state with a callback so we restore state
+        // regardless of how the dialog is dismissed. The window will auto-delete.
+        auto* window = options.create();
+        safeThis->offlineRenderDialog = window;
+
+        // Ensure this dialog doesn't float above other apps.
+        window->setAlwaysOnTop(false);
+
+        window->enterModalState(
+            true,
+            juce::ModalCallbackFunction::create([safeThis, wasVisualiserVisible, wasOfflineRenderActive, resultHolder](int) {
+                if (safeThis == nullptr)
+                    return;
 
-                    safeThis->audioProcessor.setOfflineRenderActive(wasOfflineRenderActive);
-                    safeThis->visualiser.setVisible(wasVisualiserVisible);
-                    safeThis->offlineRenderDialog = nullptr;
+                safeThis->audioProcessor.setOfflineRenderActive(wasOfflineRenderActive);
+                safeThis->visualiser.setVisible(wasVisualiserVisible);
+                safeThis->offlineRenderDialog = nullptr;
 
-                    if (resultHolder != nullptr && resultHolder->has_value())
+                if (resultHolder != nullptr && resultHolder->has_value())
+                {
+                    const auto& r = resultHolder->value();
+                    if (!r.success && !r.cancelled)
                     {
-                        const auto& r = resultHolder->value();
-                        if (!r.success && !r.cancelled)
-                        {
-                            juce::AlertWindow::showMessageBoxAsync(
-                                juce::AlertWindow::WarningIcon,
-                                "Render Failed",
-                                r.errorMessage.isNotEmpty() ? r.errorMessage : "An error occurred while rendering.");
-                        }
+                        juce::AlertWindow::showMessageBoxAsync(
+                            juce::AlertWindow::WarningIcon,
+                            "Render Failed",
+                            r.errorMessage.isNotEmpty() ? r.errorMessage : "An error occurred while rendering.");
                     }
-                }),
-                true);
+                }
+            }),
+            true);
 
-            contentPtr->start();
-        });
+        contentPtr->start();
     });
 #endif
 }
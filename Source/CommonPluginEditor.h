@@ -47,6 +47,8 @@ public:
 
     // Offline render: input audio file -> encoded video using Recording Settings
     void renderAudioFileToVideo();
+    // Same, skipping the input file chooser (e.g. after an offline project render)
+    void renderAudioFileToVideo(const juce::File& inputFile);
     void resetToDefault();
     void toggleFullScreen();
     void resized() override;
@@ -76,7 +78,7 @@ public:
 
     VisualiserSettings visualiserSettings = VisualiserSettings(audioProcessor.visualiserParameters, 3);
     RecordingSettings recordingSettings = RecordingSettings(audioProcessor.recordingParameters);
-    SettingsWindow recordingSettingsWindow = SettingsWindow("Recording Settings", recordingSettings, 330, 360, 330, 360);
+    SettingsWindow recordingSettingsWindow = SettingsWindow("Recording Settings", recordingSettings, 330, 465, 330, 465);
     VisualiserComponent visualiser{
         audioProcessor,
         *this,
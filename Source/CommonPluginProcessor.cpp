@@ -227,6 +227,7 @@ void CommonAudioProcessor::addAllParameters() {
         }
     }
     undoManager.clearUndoHistory();
+    undoManager.setMaxNumberOfStoredUnits(kMaxUndoHistoryBytes, kMinUndoTransactions);
     midiCCManager.setUndoManager(&undoManager, &undoSuppressed, &stateTree);
 
     // Set MidiCCManager on all parameters so UI components can auto-discover
@@ -419,11 +420,18 @@ void CommonAudioProcessor::loadAudioFile(const juce::File& file) {
     auto stream = std::make_unique<juce::FileInputStream>(file);
     if (stream->openedOk()) {
         loadAudioFile(std::move(stream));
+        loadedAudioFile = file;
+        audioFileThumbnail.setSource(file);
     }
 }
 
 void CommonAudioProcessor::loadAudioFile(std::unique_ptr<juce::InputStream> stream) {
     if (stream != nullptr) {
+        // A bare stream can't be reopened to build peaks; callers that can
+        // reopen it set the thumbnail's source themselves.
+        loadedAudioFile = juce::File();
+        audioFileThumbnail.clear();
+
         juce::SpinLock::ScopedLockType lock(wavParserLock);
         wavParser.parse(std::move(stream));
 
@@ -435,6 +443,9 @@ void CommonAudioProcessor::loadAudioFile(std::unique_ptr<juce::InputStream> stre
 }
 
 void CommonAudioProcessor::stopAudioFile() {
+    loadedAudioFile = juce::File();
+    audioFileThumbnail.clear();
+
     juce::SpinLock::ScopedLockType lock(wavParserLock);
     wavParser.close();
 
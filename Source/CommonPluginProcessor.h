@@ -15,6 +15,7 @@
 #include "visualiser/VisualiserSettings.h"
 #include "visualiser/RecordingSettings.h"
 #include "audio/wav/WavParser.h"
+#include "audio/wav/WaveformThumbnail.h"
 
 class AudioPlayerListener {
 public:
@@ -45,6 +46,10 @@ public:
     virtual void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) = 0;
     virtual juce::AudioProcessorEditor* createEditor() = 0;
 
+    // State written when saving a project file to disk. Defaults to the same
+    // state given to the host, but may embed data the host state only references.
+    virtual void getProjectFileData(juce::MemoryBlock& destData) { getStateInformation(destData); }
+
     bool hasEditor() const override;
 
     const juce::String getName() const override;
@@ -172,6 +177,11 @@ public:
         .getChildFile("Application Support")
 #endif
         .getChildFile("osci-render");
+
+    // Peaks of the audio file loaded into wavParser, for the timeline.
+    WaveformThumbnail audioFileThumbnail { applicationFolder.getChildFile("Waveform Cache") };
+    // The file loaded into wavParser, if it came from disk.
+    juce::File getLoadedAudioFile() const { return loadedAudioFile; }
     
     juce::String ffmpegFileName =
 #if JUCE_WINDOWS
@@ -188,6 +198,8 @@ public:
     
 protected:
     
+    juce::File loadedAudioFile;
+
     bool brightnessEnabled = false;
     bool rgbEnabled = false;
 
@@ -203,6 +215,10 @@ public:
 
     // ValueTree undo support
     juce::UndoManager undoManager;
+    // Undo actions report their size in bytes. Past this, the oldest
+    // transactions are dropped, though the most recent few are always kept.
+    static constexpr int kMaxUndoHistoryBytes = 64 * 1024 * 1024;
+    static constexpr int kMinUndoTransactions = 30;
     juce::ValueTree stateTree { "State" };
 
     // Tracks which parameter last changed, so we start a new undo transaction
@@ -9,7 +9,7 @@
 #include "components/effects/EffectComponent.h"
 #include "components/SyphonInputSelectorComponent.h"
 
-void OscirenderAudioProcessorEditor::registerFileRemovedCallback() {
+void OscirenderAudioProcessorEditor::registerFileListCallbacks() {
     juce::Component::SafePointer<OscirenderAudioProcessorEditor> safeThis(this);
     audioProcessor.setFileRemovedCallback([safeThis](int index) {
         if (safeThis == nullptr)
@@ -22,6 +22,17 @@ void OscirenderAudioProcessorEditor::registerFileRemovedCallback() {
                 safeThis->resized();
         });
     });
+    audioProcessor.setFileInsertedCallback([safeThis](int index) {
+        if (safeThis == nullptr)
+            return;
+
+        safeThis->addCodeEditor(index);
+        safeThis->fileUpdated(safeThis->audioProcessor.getCurrentFileName());
+        juce::MessageManager::callAsync([safeThis] {
+            if (safeThis != nullptr)
+                safeThis->resized();
+        });
+    });
 }
 
 OscirenderAudioProcessorEditor::OscirenderAudioProcessorEditor(OscirenderAudioProcessor& p) : CommonPluginEditor(p, "osci-render", "osci", 1100, 770), audioProcessor(p), collapseButton("Collapse", juce::Colours::white, juce::Colours::white, juce::Colours::white) {
@@ -29,8 +40,8 @@ OscirenderAudioProcessorEditor::OscirenderAudioProcessorEditor(OscirenderAudioPr
     animationTimelineController = std::make_shared<AnimationTimelineController>(audioProcessor);
     audioTimelineController = std::make_shared<OscirenderAudioTimelineController>(audioProcessor);
     
-    // Register the file removal callback
-    registerFileRemovedCallback();
+    // Register the file removal and insertion callbacks
+    registerFileListCallbacks();
 
 #if !OSCI_PREMIUM
     addAndMakeVisible(upgradeButton);
@@ -46,6 +57,13 @@ OscirenderAudioProcessorEditor::OscirenderAudioProcessorEditor(OscirenderAudioPr
     mtsEspLabel.setJustificationType(juce::Justification::centredRight);
 #endif
 
+    addChildComponent(containmentLabel);
+    containmentLabel.setFont(juce::Font(11.0f));
+    containmentLabel.setColour(juce::Label::textColourId, juce::Colours::orange);
+    containmentLabel.setJustificationType(juce::Justification::centredRight);
+    containmentLabel.setTooltip("Number of audio blocks that contained NaN, infinite or runaway samples. "
+                                "They were replaced with silence and the effect that produced them was reset.");
+
     addAndMakeVisible(console);
     console.setConsoleOpen(false);
 
@@ -154,6 +172,10 @@ OscirenderAudioProcessorEditor::~OscirenderAudioProcessorEditor() {
 #if (JUCE_MAC || JUCE_WINDOWS) && OSCI_PREMIUM
     audioProcessor.syphonInputActive = false;
 #endif
+#if JUCE_LINUX && OSCI_PREMIUM
+    audioProcessor.liveVideoInputActive = false;
+    liveVideoSource.reset();
+#endif
 
     // Clear the file removal callback
     audioProcessor.setFileRemovedCallback(nullptr);
@@ -193,12 +215,15 @@ void OscirenderAudioProcessorEditor::filesDropped(const juce::StringArray& files
     if (file.hasFileExtension("osci")) {
         openProject(file);
     } else {
-        juce::SpinLock::ScopedLockType parsersLock(audioProcessor.parsersLock);
-        juce::SpinLock::ScopedLockType effectsLock(audioProcessor.effectsLock);
-
-        audioProcessor.addFile(file);
-        addCodeEditor(audioProcessor.getCurrentFileIndex());
-        fileUpdated(audioProcessor.getCurrentFileName());
+        auto block = std::make_shared<juce::MemoryBlock>();
+        if (!file.loadFileAsData(*block)) {
+            return;
+        }
+        // The action takes the locks itself, and the inserted-file callback
+        // adds the code editor.
+        auto& undoManager = audioProcessor.getUndoManager();
+        undoManager.beginNewTransaction("Open " + file.getFileName());
+        undoManager.perform(FileListChangeAction::add(audioProcessor, file.getFileName(), block));
     }
 }
 
@@ -282,6 +307,8 @@ void OscirenderAudioProcessorEditor::resized() {
         if (mtsEspLabel.isVisible())
             mtsEspLabel.setBounds(topBar.removeFromRight(juce::jmin(150, topBar.getWidth())).reduced(2, 2));
 #endif
+        if (containmentLabel.isVisible())
+            containmentLabel.setBounds(topBar.removeFromRight(juce::jmin(150, topBar.getWidth())).reduced(2, 2));
     }
 
     bool editorVisible = false;
@@ -549,8 +576,6 @@ void OscirenderAudioProcessorEditor::codeDocumentTextInserted(const juce::String
     if (updatingDocumentsWithParserLock) {
         return;
     }
-    juce::SpinLock::ScopedLockType parserLock(audioProcessor.parsersLock);
-    juce::SpinLock::ScopedLockType effectsLock(audioProcessor.effectsLock);
     updateCodeDocument();
 }
 
@@ -561,23 +586,52 @@ void OscirenderAudioProcessorEditor::codeDocumentTextDeleted(int startIndex, int
     if (updatingDocumentsWithParserLock) {
         return;
     }
-    juce::SpinLock::ScopedLockType parserLock(audioProcessor.parsersLock);
-    juce::SpinLock::ScopedLockType effectsLock(audioProcessor.effectsLock);
     updateCodeDocument();
 }
 
-// parsersLock AND effectsLock must be locked before calling this function
+// parsersLock and effectsLock must NOT be held: edits to files go through the
+// undo manager, whose actions take the locks themselves.
 void OscirenderAudioProcessorEditor::updateCodeDocument() {
     if (editingCustomFunction) {
+        juce::SpinLock::ScopedLockType parserLock(audioProcessor.parsersLock);
+        juce::SpinLock::ScopedLockType effectsLock(audioProcessor.effectsLock);
         juce::String file = codeDocuments[0]->getAllContent();
         audioProcessor.luaEffectState->updateCode(file);
-    } else {
+        return;
+    }
+
+    std::unique_ptr<FileContentChangeAction> action;
+    juce::String undoId;
+    {
+        juce::SpinLock::ScopedLockType parserLock(audioProcessor.parsersLock);
+        juce::SpinLock::ScopedLockType effectsLock(audioProcessor.effectsLock);
         int originalIndex = audioProcessor.getCurrentFileIndex();
-        int index = audioProcessor.getCurrentFileIndex();
-        index++;
-        juce::String file = codeDocuments[index]->getAllContent();
-        audioProcessor.updateFileBlock(originalIndex, std::make_shared<juce::MemoryBlock>(file.toRawUTF8(), file.getNumBytesAsUTF8() + 1));
+        if (originalIndex < 0) {
+            return;
+        }
+        juce::String file = codeDocuments[originalIndex + 1]->getAllContent();
+        juce::MemoryBlock contents(file.toRawUTF8(), file.getNumBytesAsUTF8() + 1);
+        action.reset(FileContentChangeAction::fromEdit(audioProcessor, originalIndex, contents));
+        undoId = "file:" + audioProcessor.getFileId(originalIndex);
+    }
+    if (action->splice.isEmpty()) {
+        return;
     }
+
+    // Like slider drags, a run of typing in one file is one transaction.
+    // Anything else in between, an undo, or a pause starts a new one.
+    auto& undoManager = audioProcessor.getUndoManager();
+    const auto transactionName = "Edit " + action->fileName;
+    const auto now = juce::Time::getMillisecondCounter();
+    if (audioProcessor.lastUndoParamId != undoId
+        || undoManager.canRedo()
+        || undoManager.getUndoDescription() != transactionName
+        || now - lastCodeEditTime > CODE_EDIT_UNDO_GAP_MS) {
+        undoManager.beginNewTransaction(transactionName);
+        audioProcessor.lastUndoParamId = undoId;
+    }
+    lastCodeEditTime = now;
+    undoManager.perform(action.release());
 }
 
 bool OscirenderAudioProcessorEditor::keyPressed(const juce::KeyPress& key) {
@@ -689,6 +743,161 @@ void OscirenderAudioProcessorEditor::timerCallback() {
             mtsEspLabel.setText(newText, juce::dontSendNotification);
     }
 #endif
+
+    auto contained = audioProcessor.getContainmentCount();
+    if (contained != shownContainmentCount) {
+        shownContainmentCount = contained;
+        containmentLabel.setText("Bad samples: " + juce::String(contained), juce::dontSendNotification);
+        if (!containmentLabel.isVisible()) {
+            containmentLabel.setVisible(true);
+            resized();
+        }
+    }
+}
+
+namespace {
+
+// Runs OfflineProjectRenderer on a background thread behind a progress window.
+// Deletes itself once the render has finished and onComplete has been called.
+class OfflineProjectRenderThread : public juce::ThreadWithProgressWindow {
+public:
+    OfflineProjectRenderThread(OscirenderAudioProcessor& processor,
+                               OfflineProjectRenderer::Settings settings,
+                               juce::File outputFile,
+                               std::function<void(const OfflineProjectRenderer::Result&)> onComplete)
+        : juce::ThreadWithProgressWindow("Rendering project...", true, true),
+          renderer(processor), settings(std::move(settings)), outputFile(std::move(outputFile)), onComplete(std::move(onComplete)) {}
+
+    void run() override {
+        result = renderer.render(settings, outputFile, [this](double progress) {
+            setProgress(progress);
+            return !threadShouldExit();
+        });
+    }
+
+    void threadComplete(bool userPressedCancel) override {
+        if (userPressedCancel) {
+            result.cancelled = true;
+            result.success = false;
+        }
+        if (onComplete != nullptr) {
+            onComplete(result);
+        }
+        delete this;
+    }
+
+private:
+    OfflineProjectRenderer renderer;
+    OfflineProjectRenderer::Settings settings;
+    juce::File outputFile;
+    std::function<void(const OfflineProjectRenderer::Result&)> onComplete;
+    OfflineProjectRenderer::Result result;
+};
+
+} // namespace
+
+void OscirenderAudioProcessorEditor::renderProjectOffline() {
+    auto* window = new juce::AlertWindow("Render Project Offline",
+        "Renders the current project faster than real time to a 6-channel (X, Y, Z, R, G, B) WAV file.",
+        juce::MessageBoxIconType::NoIcon);
+
+    window->addComboBox("source", { "Fixed note", "MIDI file..." }, "Notes");
+    window->addTextEditor("note", "60", "MIDI note (fixed note only)");
+    window->addTextEditor("length", "10", "Length in seconds (0 = length of MIDI file)");
+    window->addComboBox("sampleRate", { "44100", "48000", "96000", "192000" }, "Sample rate");
+    window->getComboBoxComponent("sampleRate")->setSelectedItemIndex(1);
+#if OSCI_PREMIUM
+    window->addComboBox("output", { "Audio only", "Audio and video" }, "Output");
+#endif
+    window->addButton("Render", 1, juce::KeyPress(juce::KeyPress::returnKey));
+    window->addButton("Cancel", 0, juce::KeyPress(juce::KeyPress::escapeKey));
+
+    juce::Component::SafePointer<OscirenderAudioProcessorEditor> safeThis(this);
+    window->enterModalState(true, juce::ModalCallbackFunction::create([safeThis, window](int button) {
+        if (button != 1 || safeThis == nullptr) {
+            return;
+        }
+
+        OfflineProjectRenderer::Settings settings;
+        settings.note = juce::jlimit(0, 127, window->getTextEditorContents("note").getIntValue());
+        settings.lengthSeconds = juce::jmax(0.0, window->getTextEditorContents("length").getDoubleValue());
+        settings.sampleRate = window->getComboBoxComponent("sampleRate")->getText().getDoubleValue();
+        settings.bpm = safeThis->audioProcessor.currentBpm.load();
+
+        bool renderVideo = false;
+#if OSCI_PREMIUM
+        renderVideo = window->getComboBoxComponent("output")->getSelectedItemIndex() == 1;
+#endif
+
+        const bool useMidiFile = window->getComboBoxComponent("source")->getSelectedItemIndex() == 1;
+        if (!useMidiFile) {
+            if (settings.lengthSeconds <= 0.0) {
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Render Project Offline",
+                    "A length must be given when rendering a fixed note.");
+                return;
+            }
+            safeThis->chooseOfflineProjectRenderOutput(settings, renderVideo);
+            return;
+        }
+
+        safeThis->chooser = std::make_unique<juce::FileChooser>("Choose a MIDI file",
+            safeThis->audioProcessor.getLastOpenedDirectory(), "*.mid;*.midi");
+        auto flags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles;
+        safeThis->chooser->launchAsync(flags, [safeThis, settings, renderVideo](const juce::FileChooser& midiChooser) mutable {
+            if (safeThis == nullptr || midiChooser.getResult() == juce::File()) {
+                return;
+            }
+            settings.midiFile = midiChooser.getResult();
+            safeThis->audioProcessor.setLastOpenedDirectory(settings.midiFile.getParentDirectory());
+            safeThis->chooseOfflineProjectRenderOutput(settings, renderVideo);
+        });
+    }), true);
+}
+
+void OscirenderAudioProcessorEditor::chooseOfflineProjectRenderOutput(OfflineProjectRenderer::Settings settings, bool renderVideo) {
+    auto suggestedName = currentFileName.isNotEmpty() ? currentFileName.upToLastOccurrenceOf(".", false, false) : juce::String("render");
+    chooser = std::make_unique<juce::FileChooser>("Choose an output WAV file",
+        audioProcessor.getLastOpenedDirectory().getChildFile(suggestedName + ".wav"), "*.wav");
+    auto flags = juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles;
+
+    juce::Component::SafePointer<OscirenderAudioProcessorEditor> safeThis(this);
+    chooser->launchAsync(flags, [safeThis, settings, renderVideo](const juce::FileChooser& outputChooser) {
+        if (safeThis == nullptr || outputChooser.getResult() == juce::File()) {
+            return;
+        }
+        auto outputFile = outputChooser.getResult().withFileExtension("wav");
+        safeThis->audioProcessor.setLastOpenedDirectory(outputFile.getParentDirectory());
+        safeThis->startOfflineProjectRender(settings, outputFile, renderVideo);
+    });
+}
+
+void OscirenderAudioProcessorEditor::startOfflineProjectRender(OfflineProjectRenderer::Settings settings, const juce::File& outputFile, bool renderVideo) {
+    // Stop any live recording - it would otherwise capture the device's silence.
+    if (audioProcessor.haltRecording != nullptr) {
+        audioProcessor.haltRecording();
+    }
+
+    const double sampleRate = settings.sampleRate;
+    juce::Component::SafePointer<OscirenderAudioProcessorEditor> safeThis(this);
+    auto* thread = new OfflineProjectRenderThread(audioProcessor, settings, outputFile,
+        [safeThis, outputFile, renderVideo, sampleRate](const OfflineProjectRenderer::Result& result) {
+            if (safeThis == nullptr || result.cancelled) {
+                return;
+            }
+            if (!result.success) {
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Render Failed",
+                    result.errorMessage.isNotEmpty() ? result.errorMessage : "An error occurred while rendering.");
+                return;
+            }
+            if (renderVideo) {
+                safeThis->renderAudioFileToVideo(outputFile);
+                return;
+            }
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon, "Render Complete",
+                "Rendered " + juce::String((double) result.samplesRendered / sampleRate, 1) + "s of audio at "
+                + juce::String(result.getRealTimeFactor(sampleRate), 1) + "x real time to " + outputFile.getFileName() + ".");
+        });
+    thread->launchThread();
 }
 
 void OscirenderAudioProcessorEditor::showLuaDocumentation() {
@@ -779,3 +988,73 @@ juce::String OscirenderAudioProcessorEditor::getSyphonSourceName() const {
     return "";
 }
 #endif
+
+#if JUCE_LINUX && OSCI_PREMIUM
+void OscirenderAudioProcessorEditor::openLiveVideoInputDialog() {
+    auto devices = FFmpegLiveVideoSource::findCaptureDevices();
+    juce::String message = devices.isEmpty() ? "No capture devices were found."
+                                             : "Capture devices: " + devices.joinIntoString(", ");
+    message += "\n\nAnything else ffmpeg can open works too: a video file, a stream URL, or a generator such as testsrc.";
+
+    auto* window = new juce::AlertWindow("Select Live Video Input", message, juce::MessageBoxIconType::NoIcon);
+    window->addTextEditor("input", devices.isEmpty() ? "testsrc" : devices[0], "Input");
+    window->addButton("Connect", 1, juce::KeyPress(juce::KeyPress::returnKey));
+    window->addButton("Cancel", 0, juce::KeyPress(juce::KeyPress::escapeKey));
+
+    juce::Component::SafePointer<OscirenderAudioProcessorEditor> safeThis(this);
+    window->enterModalState(true, juce::ModalCallbackFunction::create([safeThis, window](int button) {
+        if (button == 1 && safeThis != nullptr) {
+            safeThis->connectLiveVideoInput(window->getTextEditorContents("input").trim());
+        }
+    }), true);
+}
+
+void OscirenderAudioProcessorEditor::connectLiveVideoInput(const juce::String& input) {
+    if (input.isEmpty()) {
+        return;
+    }
+
+    juce::Component::SafePointer<OscirenderAudioProcessorEditor> safeThis(this);
+    audioProcessor.ensureFFmpegExists(nullptr, [safeThis, input] {
+        if (safeThis == nullptr) {
+            return;
+        }
+        auto& editor = *safeThis;
+        // The slot takes frames from one producer at a time, so the old
+        // source has to be stopped before the new one starts.
+        editor.disconnectLiveVideoInput();
+
+        juce::Logger::writeToLog("Live video: connecting to '" + input + "'");
+        auto source = std::make_unique<FFmpegLiveVideoSource>(editor.audioProcessor.getFFmpegFile(), input, editor.audioProcessor.liveVideoFrames);
+        if (!source->start()) {
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Error",
+                "Could not start ffmpeg for live video input.");
+            return;
+        }
+        editor.liveVideoSource = std::move(source);
+        editor.audioProcessor.liveVideoInputActive = true;
+        editor.model.resetMenuItems();
+        editor.model.menuItemsChanged();
+        editor.audioProcessor.fileChangeBroadcaster.sendChangeMessage();
+    });
+}
+
+void OscirenderAudioProcessorEditor::disconnectLiveVideoInput() {
+    if (!liveVideoSource) {
+        return;
+    }
+    juce::Logger::writeToLog("Live video: disconnecting from '" + liveVideoSource->getSourceName() + "'");
+    audioProcessor.liveVideoInputActive = false;
+    liveVideoSource.reset();
+    model.resetMenuItems();
+    model.menuItemsChanged();
+    audioProcessor.fileChangeBroadcaster.sendChangeMessage();
+}
+
+juce::String OscirenderAudioProcessorEditor::getLiveVideoSourceName() const {
+    if (liveVideoSource) {
+        return liveVideoSource->getSourceName();
+    }
+    return "";
+}
+#endif
@@ -16,6 +16,7 @@
 #include "components/menu/OsciMainMenuBarModel.h"
 #include "components/SplashScreenComponent.h"
 #include "visualiser/VisualiserSettings.h"
+#include "audio/OfflineProjectRenderer.h"
 
 class OscirenderAudioProcessorEditor : public CommonPluginEditor, private juce::CodeDocument::Listener, public juce::AsyncUpdater, public juce::ChangeListener, public juce::FileDragAndDropTarget, public juce::DragAndDropContainer {
 public:
@@ -44,8 +45,13 @@ public:
 
     void editCustomFunction(bool enabled);
 
+    // Offline render: current project -> 6-channel WAV (and optionally video), faster than real time
+    void renderProjectOffline();
+
 private:
-    void registerFileRemovedCallback();
+    void registerFileListCallbacks();
+    void chooseOfflineProjectRenderOutput(OfflineProjectRenderer::Settings settings, bool renderVideo);
+    void startOfflineProjectRender(OfflineProjectRenderer::Settings settings, const juce::File& outputFile, bool renderVideo);
 
     OscirenderAudioProcessor& audioProcessor;
 
@@ -69,6 +75,10 @@ public:
     juce::Label mtsEspLabel;
 #endif
 
+    // Shown once the audio path has had to contain NaN/Inf samples.
+    juce::Label containmentLabel;
+    juce::uint32 shownContainmentCount = 0;
+
     juce::ComponentAnimator codeEditorAnimator;
     LuaComponent lua{audioProcessor, *this};
     TxtComponent txtFont{audioProcessor, *this};
@@ -99,6 +109,10 @@ public:
 
     std::atomic<bool> updatingDocumentsWithParserLock = false;
 
+    // Keystrokes in the same file less than this far apart are undone together.
+    static constexpr juce::uint32 CODE_EDIT_UNDO_GAP_MS = 1000;
+    juce::uint32 lastCodeEditTime = 0;
+
     void codeDocumentTextInserted(const juce::String& newText, int insertIndex) override;
     void codeDocumentTextDeleted(int startIndex, int endIndex) override;
     void updateCodeDocument();
@@ -125,6 +139,16 @@ public:
     std::unique_ptr<SyphonFrameGrabber> syphonFrameGrabber;
 #endif
 
+#if JUCE_LINUX && OSCI_PREMIUM
+    // Live video input through ffmpeg. Message thread only.
+    void openLiveVideoInputDialog();
+    void connectLiveVideoInput(const juce::String& input);
+    void disconnectLiveVideoInput();
+    juce::String getLiveVideoSourceName() const;
+
+    std::unique_ptr<FFmpegLiveVideoSource> liveVideoSource;
+#endif
+
 private:
     void showLuaDocumentation();
 
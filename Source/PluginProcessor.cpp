@@ -10,9 +10,11 @@
 
 #include "audio/AudioThreadGuard.h"
 #include "PluginEditor.h"
+#include "util/ProjectChunkFormat.h"
 #include "components/modulation/LfoComponent.h"
 #include "components/modulation/EnvelopeComponent.h"
 #include "components/modulation/RandomComponent.h"
+#include "components/modulation/StepSequencerComponent.h"
 #include "components/modulation/SidechainComponent.h"
 #include "audio/effects/BitCrushEffect.h"
 #include "audio/effects/BulgeEffect.h"
@@ -126,6 +128,10 @@ OscirenderAudioProcessor::OscirenderAudioProcessor() : CommonAudioProcessor(Buse
     effects.insert(effects.end(), osciPermanentEffects.begin(), osciPermanentEffects.end());
     effects.insert(effects.end(), luaEffects.begin(), luaEffects.end());
 
+    // Voices clone their effects from the registry, so it must exist before
+    // the voice builder starts.
+    publishEffectRegistry();
+
     // --- Premium mode: strip per-parameter LFO dropdowns and sidechain from all effects ---
     // These are only used in the free version. In premium, modulation is done via
     // the global LFO/ENV module panels with drag-and-drop assignments.
@@ -144,6 +150,7 @@ OscirenderAudioProcessor::OscirenderAudioProcessor() : CommonAudioProcessor(Buse
     booleanParameters.push_back(loopAnimation);
     booleanParameters.push_back(animationSyncBPM);
     booleanParameters.push_back(invertImage);
+    booleanParameters.push_back(hiddenLineRemoval);
 
     // Adopt envelope parameters
     for (auto* p : envelopeParameters.getFloatParameters())
@@ -165,6 +172,12 @@ OscirenderAudioProcessor::OscirenderAudioProcessor() : CommonAudioProcessor(Buse
     for (auto* p : randomParameters.getIntParameters())
         intParameters.push_back(p);
 
+    // Adopt step sequencer parameters from state class (premium only)
+    for (auto* p : stepSequencerParameters.getFloatParameters())
+        floatParameters.push_back(p);
+    for (auto* p : stepSequencerParameters.getIntParameters())
+        intParameters.push_back(p);
+
     // Adopt Sidechain parameters from state class (premium only)
     for (auto* p : sidechainParameters.getFloatParameters())
         floatParameters.push_back(p);
@@ -250,11 +263,12 @@ OscirenderAudioProcessor::OscirenderAudioProcessor() : CommonAudioProcessor(Buse
     buildParamLocationMap();
 
     // Register modulation sources with the engine.
-    // Order determines stacking order (LFO first, then ENV, Random, Sidechain).
+    // Order determines stacking order (LFO first, then ENV, Random, Sidechain, Step Sequencer).
     modulationEngine.addSource(&lfoParameters);
     modulationEngine.addSource(&envelopeParameters);
     modulationEngine.addSource(&randomParameters);
     modulationEngine.addSource(&sidechainParameters);
+    modulationEngine.addSource(&stepSequencerParameters);
 
     // Set colour functions (defined in UI component headers, so set here to avoid
     // coupling the audio-layer headers to UI headers).
@@ -262,6 +276,7 @@ OscirenderAudioProcessor::OscirenderAudioProcessor() : CommonAudioProcessor(Buse
     envelopeParameters.setColourFunction(&EnvelopeComponent::getEnvColour);
     randomParameters.setColourFunction(&RandomComponent::getRandomColour);
     sidechainParameters.setColourFunction(&SidechainComponent::getSidechainColour);
+    stepSequencerParameters.setColourFunction(&StepSequencerComponent::getStepSequencerColour);
 
     // Wire undo manager to modulation sources so assignment changes are undoable.
     lfoParameters.setUndoManager(&undoManager);
@@ -276,6 +291,9 @@ OscirenderAudioProcessor::OscirenderAudioProcessor() : CommonAudioProcessor(Buse
     sidechainParameters.setUndoManager(&undoManager);
     sidechainParameters.setUndoSuppressedFlag(&undoSuppressed);
     sidechainParameters.setUndoGroupingFlag(&undoGrouping);
+    stepSequencerParameters.setUndoManager(&undoManager);
+    stepSequencerParameters.setUndoSuppressedFlag(&undoSuppressed);
+    stepSequencerParameters.setUndoGroupingFlag(&undoGrouping);
 
     // Wire up renderer-side modulation for visualiser effects.
     // The renderer calls this after animateValues() to apply modulation from all sources.
@@ -367,6 +385,9 @@ void VoiceBuilder::run() {
 // ---------------------------------------------------------------------------
 
 OscirenderAudioProcessor::~OscirenderAudioProcessor() {
+    // It calls back into the processor from its own thread
+    oscServer.stop();
+
     // Stop the voice builder before tearing down any processor state it references.
     voiceBuilder.reset();
 
@@ -388,19 +409,18 @@ OscirenderAudioProcessor::~OscirenderAudioProcessor() {
     voices->removeListener(this);
 }
 
-// parsersLock AND effectsLock must be held when calling this
-void OscirenderAudioProcessor::applyFileSelectLocked() {
-    const int previousFileIndex = currentFile.load();
+// Audio thread only. files must stay pinned until the voices have been updated.
+void OscirenderAudioProcessor::applyFileSelect(const FileRegistry& files) {
+    const int previousFileIndex = appliedFileIndex;
     auto* previousSound = activeShapeSound.load(std::memory_order_acquire);
 
     ShapeSound* selectedSound = nullptr;
 
     if (objectServerRendering.load()) {
         selectedSound = objectServerSound.get();
-        activeShapeSound.store(selectedSound, std::memory_order_release);
-        currentFile.store(-1);
+        appliedFileIndex = -1;
     } else {
-        const int fileCount = (int)fileBlocks.size();
+        const int fileCount = (int)files.sounds.size();
 
         // 1-based mapping: 1 -> first file (index 0), 2 -> second file (index 1), ...
         const int requestedParamValue = juce::jlimit(1, 100, (int)fileSelect->getValueUnnormalised());
@@ -414,15 +434,28 @@ void OscirenderAudioProcessor::applyFileSelectLocked() {
             targetFileIndex = juce::jlimit(0, maxIndex, requestedIndex);
         }
 
-        currentFile.store(targetFileIndex);
-        selectedSound = targetFileIndex >= 0 ? sounds[(size_t)targetFileIndex].get() : defaultSound.get();
-        activeShapeSound.store(selectedSound, std::memory_order_release);
+        appliedFileIndex = targetFileIndex;
+        selectedSound = targetFileIndex >= 0 ? files.sounds[(size_t)targetFileIndex].get() : defaultSound.get();
     }
 
     assert(selectedSound != nullptr);
 
-    const int newFileIndex = currentFile.load();
-    const bool selectionChanged = (newFileIndex != previousFileIndex) || (selectedSound != previousSound);
+    activeShapeSound.store(selectedSound, std::memory_order_release);
+    currentFile.store(appliedFileIndex);
+
+    // Key-mapped voices ignore fileSelect, but must let go of a file once
+    // it's been removed. The old registry is still held, so their sounds are
+    // alive until then.
+    if (&files != appliedFileRegistry) {
+        appliedFileRegistry = &files;
+        for (int i = 0; i < synth.getNumVoices(); i++) {
+            if (auto voice = dynamic_cast<ShapeVoice*>(synth.getVoice(i))) {
+                voice->dropUnloadedSound(files, selectedSound);
+            }
+        }
+    }
+
+    const bool selectionChanged = (appliedFileIndex != previousFileIndex) || (selectedSound != previousSound);
     if (!selectionChanged || selectedSound == nullptr) {
         return;
     }
@@ -440,6 +473,22 @@ void OscirenderAudioProcessor::applyFileSelectLocked() {
     }
 }
 
+// Audio thread only. Voices keep the clones after the registry is unpinned,
+// so the caller holds the registry's version until a newer one is applied.
+void OscirenderAudioProcessor::applyPreviewEffect(const EffectRegistry& effects) {
+    if (effects.voicePreviews.get() == appliedVoicePreviews) {
+        return;
+    }
+    appliedVoicePreviews = effects.voicePreviews.get();
+
+    for (int i = 0; i < synth.getNumVoices(); i++) {
+        auto voice = dynamic_cast<ShapeVoice*>(synth.getVoice(i));
+        if (voice != nullptr) {
+            voice->syncPreviewEffect(effects.preview, effects.voicePreviews.get(), !voice->isSilent());
+        }
+    }
+}
+
 void OscirenderAudioProcessor::setAudioThreadCallback(std::function<void(const juce::AudioBuffer<float>&)> callback) {
     juce::SpinLock::ScopedLockType lock(audioThreadCallbackLock);
     audioThreadCallback = callback;
@@ -454,6 +503,8 @@ void OscirenderAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBl
     retriggerMidi = true;
 
     modulationEngine.prepareToPlay(sampleRate, samplesPerBlock);
+    subBlockSplitter.prepareToPlay(samplesPerBlock);
+    preparedBlockSize = samplesPerBlock;
     
     // Update sample rate for all effects so they have correct timing
     {
@@ -505,6 +556,59 @@ void OscirenderAudioProcessor::updateEffectPrecedence() {
         return a->getPrecedence() < b->getPrecedence();
     };
     std::sort(toggleableEffects.begin(), toggleableEffects.end(), sortFunc);
+    publishEffectRegistry();
+}
+
+// effectsLock MUST be held when calling this
+void OscirenderAudioProcessor::publishEffectRegistry() {
+    auto registry = std::make_unique<EffectRegistry>();
+    registry->toggleable = toggleableEffects;
+    registry->preview = previewEffect;
+    registry->voicePreviews = previewVoiceEffects;
+#if OSCI_AUDIO_PROFILER
+    for (auto& effect : toggleableEffects) {
+        registry->profileSlots.push_back(profiler.getSlot("Effect: " + effect->getId()));
+    }
+#endif
+    effectRegistry.publish(std::move(registry));
+}
+
+// Clones the preview effect for each voice that exists now. Voices added
+// later clone it themselves when they start.
+std::shared_ptr<const std::vector<std::shared_ptr<osci::SimpleEffect>>> OscirenderAudioProcessor::makeVoicePreviews(const std::shared_ptr<osci::Effect>& effect) {
+    auto simpleEffect = std::dynamic_pointer_cast<osci::SimpleEffect>(effect);
+    if (simpleEffect == nullptr) {
+        return nullptr;
+    }
+
+    auto clones = std::make_shared<std::vector<std::shared_ptr<osci::SimpleEffect>>>();
+    for (int i = 0; i < synth.getNumVoices(); i++) {
+        auto voice = dynamic_cast<ShapeVoice*>(synth.getVoice(i));
+        if (voice == nullptr) {
+            continue;
+        }
+        const int index = voice->getVoiceIndex();
+        if (index < 0) {
+            continue;
+        }
+        if (index >= (int) clones->size()) {
+            clones->resize(index + 1);
+        }
+        auto cloned = simpleEffect->cloneWithSharedParameters();
+        if (currentSampleRate > 0) {
+            cloned->prepareToPlay(currentSampleRate, 512);
+        }
+        (*clones)[index] = cloned;
+    }
+    return clones;
+}
+
+// parsersLock must be held when calling this
+void OscirenderAudioProcessor::publishFileRegistry() {
+    auto registry = std::make_unique<FileRegistry>();
+    registry->sounds = sounds;
+    registry->keyMap = keyMap;
+    fileRegistry.publish(std::move(registry));
 }
 
 void OscirenderAudioProcessor::applyEffectOrder(const std::vector<juce::String>& order) {
@@ -533,23 +637,84 @@ void OscirenderAudioProcessor::applyEffectOrder(const std::vector<juce::String>&
     broadcaster.sendChangeMessage();
 }
 
+void OscirenderAudioProcessor::withFilesLocked(const std::function<void()>& edit) {
+    juce::SpinLock::ScopedLockType lock1(parsersLock);
+    juce::SpinLock::ScopedLockType lock2(effectsLock);
+    edit();
+}
+
 // parsersLock AND effectsLock must be locked before calling this function
 void OscirenderAudioProcessor::updateFileBlock(int index, std::shared_ptr<juce::MemoryBlock> block) {
     if (index < 0 || index >= fileBlocks.size()) {
         return;
     }
     fileBlocks[index] = block;
+    pendingBlobs[index] = {};
     openFile(index);
 }
 
+// Restored files are listed straight away but only read and parsed when first
+// selected, so restoring a session with many large files doesn't stall the host.
+// parsersLock AND effectsLock must be locked before calling this function
+void OscirenderAudioProcessor::addPendingFile(juce::String fileName, juce::String blobHash, std::shared_ptr<juce::MemoryBlock> data) {
+    fileBlocks.push_back(data);
+    fileNames.push_back(fileName);
+    fileIds.push_back(currentFileId++);
+    pendingBlobs.push_back(blobHash);
+    parsers.push_back(std::make_shared<FileParser>(*this, errorCallback));
+    sounds.push_back(new ShapeSound(*this, parsers.back()));
+    publishFileRegistry();
+}
+
+bool OscirenderAudioProcessor::isFilePending(int index) const {
+    return index >= 0 && index < (int) pendingBlobs.size() && pendingBlobs[index].isNotEmpty();
+}
+
+void OscirenderAudioProcessor::openPendingFiles() {
+    juce::SpinLock::ScopedLockType lock1(parsersLock);
+    juce::SpinLock::ScopedLockType lock2(effectsLock);
+    const int current = currentFile;
+    for (int i = 0; i < (int) fileBlocks.size(); i++) {
+        if (isFilePending(i)) {
+            openFile(i);
+        }
+    }
+    changeCurrentFile(current);
+}
+
+void OscirenderAudioProcessor::openCurrentFileIfPending() {
+    juce::SpinLock::ScopedLockType lock1(parsersLock);
+    juce::SpinLock::ScopedLockType lock2(effectsLock);
+    if (isFilePending(currentFile)) {
+        openFile(currentFile);
+    }
+}
+
+// parsersLock AND effectsLock must be locked before calling this function
+void OscirenderAudioProcessor::openKeyMappedFiles() {
+    const int current = currentFile;
+    bool opened = false;
+    for (const auto& zone : keyMap.zones) {
+        if (isFilePending(zone.fileIndex)) {
+            openFile(zone.fileIndex);
+            opened = true;
+        }
+    }
+    if (opened) {
+        changeCurrentFile(current);
+    }
+}
+
 // parsersLock AND effectsLock must be locked before calling this function
 void OscirenderAudioProcessor::addFile(juce::File file) {
     fileBlocks.push_back(std::make_shared<juce::MemoryBlock>());
     fileNames.push_back(file.getFileName());
     fileIds.push_back(currentFileId++);
+    pendingBlobs.push_back({});
     parsers.push_back(std::make_shared<FileParser>(*this, errorCallback));
     sounds.push_back(new ShapeSound(*this, parsers.back()));
     file.createInputStream()->readIntoMemoryBlock(*fileBlocks.back());
+    publishFileRegistry();
 
     openFile(fileBlocks.size() - 1);
 }
@@ -560,9 +725,11 @@ void OscirenderAudioProcessor::addFile(juce::String fileName, const char* data,
     fileBlocks.push_back(std::make_shared<juce::MemoryBlock>());
     fileNames.push_back(fileName);
     fileIds.push_back(currentFileId++);
+    pendingBlobs.push_back({});
     parsers.push_back(std::make_shared<FileParser>(*this, errorCallback));
     sounds.push_back(new ShapeSound(*this, parsers.back()));
     fileBlocks.back()->append(data, size);
+    publishFileRegistry();
 
     openFile(fileBlocks.size() - 1);
 }
@@ -572,17 +739,63 @@ void OscirenderAudioProcessor::addFile(juce::String fileName, std::shared_ptr<ju
     fileBlocks.push_back(data);
     fileNames.push_back(fileName);
     fileIds.push_back(currentFileId++);
+    pendingBlobs.push_back({});
     parsers.push_back(std::make_shared<FileParser>(*this, errorCallback));
     sounds.push_back(new ShapeSound(*this, parsers.back()));
+    publishFileRegistry();
 
     openFile(fileBlocks.size() - 1);
 }
 
-// Setter for the callback
+// Used by undo and redo to put a file back where it was. The block is
+// shared with the undo history rather than copied.
+// parsersLock AND effectsLock must be locked before calling this function
+void OscirenderAudioProcessor::insertFile(int index, juce::String fileName, std::shared_ptr<juce::MemoryBlock> data) {
+    index = juce::jlimit(0, (int) fileBlocks.size(), index);
+    fileBlocks.insert(fileBlocks.begin() + index, data);
+    fileNames.insert(fileNames.begin() + index, fileName);
+    fileIds.insert(fileIds.begin() + index, currentFileId++);
+    pendingBlobs.insert(pendingBlobs.begin() + index, juce::String());
+    parsers.insert(parsers.begin() + index, std::make_shared<FileParser>(*this, errorCallback));
+    sounds.insert(sounds.begin() + index, new ShapeSound(*this, parsers[index]));
+    keyMap.fileInserted(index);
+    publishFileRegistry();
+
+    openFile(index);
+
+    if (fileInsertedCallback) {
+        fileInsertedCallback(index);
+    }
+}
+
+// parsersLock AND effectsLock must be locked before calling this function
+void OscirenderAudioProcessor::fileContentsRestored(int index) {
+    // updateFileBlock() has already made it the current file, so the
+    // editor reloads it when it hears about the change.
+    fileChangeBroadcaster.sendChangeMessage();
+}
+
+// Keeps a closed file's keymap zones with its undo history.
+// parsersLock AND effectsLock must be locked before calling this function
+void OscirenderAudioProcessor::saveFileSettings(int index, juce::XmlElement& settings) {
+    keyMap.saveFile(index, &settings);
+}
+
+// parsersLock AND effectsLock must be locked before calling this function
+void OscirenderAudioProcessor::restoreFileSettings(int index, const juce::XmlElement& settings) {
+    keyMap.restoreFile(index, &settings);
+    publishFileRegistry();
+}
+
+// Setters for the callbacks
 void OscirenderAudioProcessor::setFileRemovedCallback(std::function<void(int)> callback) {
     fileRemovedCallback = std::move(callback);
 }
 
+void OscirenderAudioProcessor::setFileInsertedCallback(std::function<void(int)> callback) {
+    fileInsertedCallback = std::move(callback);
+}
+
 // parsersLock AND effectsLock must be locked before calling this function
 void OscirenderAudioProcessor::removeFile(int index) {
     if (index < 0 || index >= fileBlocks.size()) {
@@ -591,8 +804,11 @@ void OscirenderAudioProcessor::removeFile(int index) {
     fileBlocks.erase(fileBlocks.begin() + index);
     fileNames.erase(fileNames.begin() + index);
     fileIds.erase(fileIds.begin() + index);
+    pendingBlobs.erase(pendingBlobs.begin() + index);
     parsers.erase(parsers.begin() + index);
     sounds.erase(sounds.begin() + index);
+    keyMap.fileRemoved(index);
+    publishFileRegistry();
 
     auto newFileIndex = index;
     if (newFileIndex >= fileBlocks.size()) {
@@ -632,6 +848,8 @@ void OscirenderAudioProcessor::openFile(int index) {
     if (index < 0 || index >= fileBlocks.size()) {
         return;
     }
+    getFileBlock(index);
+    pendingBlobs[index] = {};
     parsers[index]->parse(juce::String(fileIds[index]), fileNames[index], fileNames[index].fromLastOccurrenceOf(".", true, false).toLowerCase(), std::make_unique<juce::MemoryInputStream>(*fileBlocks[index], false), font);
     changeCurrentFile(index);
 }
@@ -639,36 +857,27 @@ void OscirenderAudioProcessor::openFile(int index) {
 // used ONLY for changing the current file to an EXISTING file.
 // much faster than openFile(int index) because it doesn't reparse any files.
 // parsersLock AND effectsLock must be locked before calling this function
+// The audio thread switches the voices over on its next block, once it sees
+// the new fileSelect value.
 void OscirenderAudioProcessor::changeCurrentFile(int index) {
     if (index == -1) {
         currentFile = -1;
-        changeSound(defaultSound);
     }
     if (index < 0 || index >= fileBlocks.size()) {
         return;
     }
+    if (isFilePending(index)) {
+        // openFile() comes back here once the file is parsed.
+        openFile(index);
+        return;
+    }
     currentFile = index;
-    changeSound(sounds[index]);
 
     // Keep fileSelect parameter in sync with UI-driven file selection.
     const int value = juce::jlimit(1, 100, index + 1);
     fileSelect->setUnnormalisedValueNotifyingHost((float)value);
 }
 
-void OscirenderAudioProcessor::changeSound(ShapeSound::Ptr sound) {
-    if (objectServerRendering && sound != objectServerSound) {
-        return;
-    }
-
-    activeShapeSound.store(sound.get(), std::memory_order_release);
-    for (int i = 0; i < synth.getNumVoices(); i++) {
-        auto voice = dynamic_cast<ShapeVoice*>(synth.getVoice(i));
-        if (voice != nullptr) {
-            voice->updateSound(sound.get());
-        }
-    }
-}
-
 void OscirenderAudioProcessor::notifyErrorListeners(int lineNumber, juce::String id, juce::String error) {
     juce::SpinLock::ScopedLockType lock(errorListenersLock);
     for (auto listener : errorListeners) {
@@ -678,6 +887,27 @@ void OscirenderAudioProcessor::notifyErrorListeners(int lineNumber, juce::String
     }
 }
 
+void OscirenderAudioProcessor::setKeyZones(std::vector<KeyZone> zones) {
+    juce::SpinLock::ScopedLockType lock1(parsersLock);
+    juce::SpinLock::ScopedLockType lock2(effectsLock);
+    keyMap.zones = std::move(zones);
+    openKeyMappedFiles();
+    publishFileRegistry();
+}
+
+std::vector<KeyZone> OscirenderAudioProcessor::getKeyZones() {
+    juce::SpinLock::ScopedLockType lock(parsersLock);
+    return keyMap.zones;
+}
+
+// Audio thread only, from within renderBlock().
+const SoundRegistry<ShapeSound>* OscirenderAudioProcessor::getKeyMapRegistry() const {
+    if (objectServerRendering.load()) {
+        return nullptr;
+    }
+    return audioFileRegistry;
+}
+
 int OscirenderAudioProcessor::getCurrentFileIndex() {
     return currentFile;
 }
@@ -705,7 +935,15 @@ juce::String OscirenderAudioProcessor::getFileId(int index) {
     return juce::String(fileIds[index]);
 }
 
+// Reads a restored file's bytes back from blobStore the first time they're needed.
 std::shared_ptr<juce::MemoryBlock> OscirenderAudioProcessor::getFileBlock(int index) {
+    if (fileBlocks[index] == nullptr) {
+        fileBlocks[index] = blobStore.load(pendingBlobs[index]);
+        if (fileBlocks[index] == nullptr) {
+            juce::Logger::writeToLog("getFileBlock: blob " + pendingBlobs[index] + " for " + fileNames[index] + " is no longer in the store");
+            fileBlocks[index] = std::make_shared<juce::MemoryBlock>();
+        }
+    }
     return fileBlocks[index];
 }
 
@@ -715,9 +953,7 @@ void OscirenderAudioProcessor::setObjectServerRendering(bool enabled) {
         juce::SpinLock::ScopedLockType lock2(effectsLock);
 
         objectServerRendering = enabled;
-        if (enabled) {
-            changeSound(objectServerSound);
-        } else {
+        if (!enabled) {
             changeCurrentFile(currentFile);
         }
     }
@@ -733,37 +969,123 @@ void OscirenderAudioProcessor::setObjectServerPort(int port) {
     objectServer.reload();
 }
 
-void OscirenderAudioProcessor::setPreviewEffectId(const juce::String& effectId) {
-    previewEffect.reset();
-    for (auto& eff : toggleableEffects) {
-        if (eff->getId() == effectId) {
-            previewEffect = eff;
-            break;
+void OscirenderAudioProcessor::setOscServerPort(int port) {
+    setProperty("oscServerPort", port);
+    reloadOscServer();
+}
+
+int OscirenderAudioProcessor::getOscServerPort() {
+    return std::any_cast<int>(getProperty("oscServerPort", 0));
+}
+
+ObjectView::Settings OscirenderAudioProcessor::getObjectViewSettings() {
+    ObjectView::Settings settings;
+
+    VersionedSnapshot<EffectRegistry>::Reader effects(effectRegistry);
+    for (auto& effect : effects->toggleable) {
+        if (effect->enabled == nullptr || !effect->enabled->getBoolValue()) {
+            continue;
+        }
+        const auto id = effect->getId();
+        const float x = effect->getActualValue(0);
+        const float y = effect->getActualValue(1);
+        const float z = effect->getActualValue(2);
+        if (id == "rotateX") {
+            settings.rotate(x, y, z);
+        } else if (id == "scaleX") {
+            settings.scale(x, y, z);
+        } else if (id == "translateX") {
+            settings.translate(x, y, z);
         }
     }
-    // Only set preview effect on active voices to reduce overhead
-    // Inactive voices will get it lazily when they become active
-    auto simplePreview = std::dynamic_pointer_cast<osci::SimpleEffect>(previewEffect);
-    for (int i = 0; i < synth.getNumVoices(); i++) {
-        auto voice = dynamic_cast<ShapeVoice*>(synth.getVoice(i));
-        if (voice && !voice->isSilent()) {
-            voice->setPreviewEffect(simplePreview);
+
+    settings.perspective = perspective->getActualValue(0);
+    settings.fovDegrees = perspective->getActualValue(1);
+    settings.hiddenLineRemoval = hiddenLineRemoval->getBoolValue();
+    return settings;
+}
+
+void OscirenderAudioProcessor::reloadOscServer() {
+    const int port = getOscServerPort();
+    if (port > 0) {
+        oscServer.start(port);
+    } else {
+        oscServer.stop();
+    }
+}
+
+void OscirenderAudioProcessor::oscParameterReceived(const juce::String& id, float value) {
+    juce::AudioProcessorParameter* parameter = getFloatParameter(id);
+    if (parameter == nullptr) {
+        parameter = getIntParameter(id);
+    }
+    if (parameter == nullptr) {
+        parameter = getBooleanParameter(id);
+    }
+    if (parameter == nullptr) {
+        return;
+    }
+
+    // Controllers stream values, so they'd flood the undo history
+    ScopedFlag suppress(undoSuppressed);
+    OscServer::setParameterValue(*parameter, value);
+}
+
+void OscirenderAudioProcessor::oscFrameReceived(juce::MemoryBlock& frame) {
+    if (objectServer.addGplaFrame((char*) frame.getData(), (int) frame.getSize()) && !objectServerRendering) {
+        setObjectServerRendering(true);
+    }
+}
+
+void OscirenderAudioProcessor::oscFramesEnded() {
+    setObjectServerRendering(false);
+}
+
+// The voice clones are made here, outside effectsLock, and picked up by the
+// audio thread from the next registry.
+void OscirenderAudioProcessor::setPreviewEffectId(const juce::String& effectId) {
+    std::shared_ptr<osci::Effect> effect;
+    {
+        juce::SpinLock::ScopedLockType lock(effectsLock);
+        for (auto& eff : toggleableEffects) {
+            if (eff->getId() == effectId) {
+                effect = eff;
+                break;
+            }
         }
     }
+
+    auto clones = makeVoicePreviews(effect);
+
+    juce::SpinLock::ScopedLockType lock(effectsLock);
+    previewEffect = effect;
+    previewVoiceEffects = clones;
+    publishEffectRegistry();
 }
 
 void OscirenderAudioProcessor::clearPreviewEffect() {
+    juce::SpinLock::ScopedLockType lock(effectsLock);
+    if (previewEffect == nullptr) {
+        return;
+    }
     previewEffect.reset();
-    // Clear preview effect from active voices
-    for (int i = 0; i < synth.getNumVoices(); i++) {
-        auto voice = dynamic_cast<ShapeVoice*>(synth.getVoice(i));
-        if (voice && !voice->isSilent()) {
-            voice->clearPreviewEffect();
-        }
+    previewVoiceEffects.reset();
+    publishEffectRegistry();
+}
+
+// Whether a toggleable effect runs at all this block.
+static bool isToggleableEffectActive(osci::Effect& effect) {
+#if !OSCI_PREMIUM
+    if (effect.isPremiumOnly()) {
+        return false;
     }
+#endif
+    const bool isEnabled = effect.enabled != nullptr && effect.enabled->getValue();
+    const bool isSelected = effect.selected == nullptr ? true : effect.selected->getBoolValue();
+    return isEnabled && isSelected;
 }
 
-// effectsLock should be held when calling this
+// Audio thread only - reads the registry pinned by renderBlock().
 void OscirenderAudioProcessor::applyToggleableEffectsToBuffer(
     juce::AudioBuffer<float>& buffer,
     juce::AudioBuffer<float>* externalInput,
@@ -774,7 +1096,39 @@ void OscirenderAudioProcessor::applyToggleableEffectsToBuffer(
     const std::shared_ptr<osci::Effect>& previewEffectInstance) {
     juce::MidiBuffer emptyMidi;
 
-    for (auto& globalEffect : toggleableEffects) {
+    jassert(audioEffectRegistry != nullptr);
+    if (audioEffectRegistry == nullptr) {
+        return;
+    }
+
+    const auto& toggleable = audioEffectRegistry->toggleable;
+    for (size_t e = 0; e < toggleable.size(); e++) {
+        if (auto* run = affineChain.runAt(e)) {
+            // A voice missing one of the run's effects applies the rest one
+            // by one instead, as it always has.
+            bool complete = true;
+            for (size_t r = e; perVoiceEffects != nullptr && r < run->end; r++) {
+                complete &= perVoiceEffects->count(toggleable[r]->getId()) > 0;
+            }
+            if (complete) {
+                OSCI_PROFILE_SCOPE(profiler, audioEffectRegistry->profileSlots[e]);
+                // A voice's clones keep their own smoothing and animation.
+                // Advance them as processing would have, so they carry on from
+                // where the fused values left off when the run breaks up.
+                for (size_t r = e; perVoiceEffects != nullptr && r < run->end; r++) {
+                    std::shared_ptr<osci::Effect> clone = perVoiceEffects->at(toggleable[r]->getId());
+                    if (isToggleableEffectActive(*clone)) {
+                        clone->animateValues(buffer.getNumSamples(), volumeBuffer);
+                    }
+                }
+                run->transform.apply(buffer);
+                containBadSamples(buffer);
+                e = run->end - 1;
+                continue;
+            }
+        }
+
+        auto& globalEffect = toggleable[e];
         std::shared_ptr<osci::Effect> effectInstance = globalEffect;
         if (perVoiceEffects != nullptr) {
             auto it = perVoiceEffects->find(globalEffect->getId());
@@ -784,15 +1138,7 @@ void OscirenderAudioProcessor::applyToggleableEffectsToBuffer(
             effectInstance = it->second;
         }
 
-#if !OSCI_PREMIUM
-        if (effectInstance->isPremiumOnly()) {
-            continue;
-        }
-#endif
-
-        const bool isEnabled = effectInstance->enabled != nullptr && effectInstance->enabled->getValue();
-        const bool isSelected = effectInstance->selected == nullptr ? true : effectInstance->selected->getBoolValue();
-        if (!(isEnabled && isSelected)) {
+        if (!isToggleableEffectActive(*effectInstance)) {
             continue;
         }
 
@@ -800,7 +1146,9 @@ void OscirenderAudioProcessor::applyToggleableEffectsToBuffer(
         if (externalInput != nullptr && globalEffect->getId() == custom->getId()) {
             extInput = externalInput;
         }
+        OSCI_PROFILE_SCOPE(profiler, audioEffectRegistry->profileSlots[e]);
         effectInstance->processBlockWithInputs(buffer, emptyMidi, extInput, volumeBuffer, frequencyBuffer, frameSyncBuffer);
+        containBadSamples(buffer, effectInstance.get());
     }
 
     if (previewEffectInstance != nullptr) {
@@ -814,20 +1162,90 @@ void OscirenderAudioProcessor::applyToggleableEffectsToBuffer(
                 extInput = externalInput;
             }
             previewEffectInstance->processBlockWithInputs(buffer, emptyMidi, extInput, volumeBuffer, frequencyBuffer, frameSyncBuffer);
+            containBadSamples(buffer, previewEffectInstance.get());
         }
     }
 }
 
+bool OscirenderAudioProcessor::containBadSamples(juce::AudioBuffer<float>& buffer, osci::Effect* source) {
+    if (!SampleSanitiser::contain(buffer, source, currentSampleRate, preparedBlockSize)) {
+        return false;
+    }
+    containmentCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
 void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
     juce::ScopedNoDenormals noDenormals;
     AudioThreadGuard::ScopedAudioThread audioThreadGuard;
 
-    if (isOfflineRenderActive()) {
+    // OfflineProjectRenderer holds offlineRenderLock while it drives renderBlock()
+    // itself. Never wait on it from the device callback - just output silence.
+    juce::SpinLock::ScopedTryLockType offlineLock(offlineRenderLock);
+    if (!offlineLock.isLocked() || isOfflineRenderActive()) {
         midiMessages.clear();
         buffer.clear();
         return;
     }
 
+    OSCI_PROFILE_BEGIN_BLOCK(profiler, buffer.getNumSamples(), getSampleRate());
+    subBlockSplitter.render(buffer, midiMessages, getPlayHead(), getSampleRate(),
+        [this](auto& subBuffer, auto& subMidi, auto* subHead) { renderBlock(subBuffer, subMidi, subHead); });
+    OSCI_PROFILE_END_BLOCK(profiler);
+}
+
+void OscirenderAudioProcessor::prepareForOfflineRender(double sampleRate, int samplesPerBlock) {
+    // Files can't be opened on demand mid-render, so open them all now.
+    openPendingFiles();
+    juce::SpinLock::ScopedLockType lock(offlineRenderLock);
+    prepareToPlay(sampleRate, samplesPerBlock);
+}
+
+void OscirenderAudioProcessor::processOfflineBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead& offlinePlayHead) {
+    juce::ScopedNoDenormals noDenormals;
+    juce::SpinLock::ScopedLockType lock(offlineRenderLock);
+
+    renderingOffline = true;
+    OSCI_PROFILE_BEGIN_BLOCK(profiler, buffer.getNumSamples(), getSampleRate());
+    subBlockSplitter.render(buffer, midiMessages, &offlinePlayHead, getSampleRate(),
+        [this](auto& subBuffer, auto& subMidi, auto* subHead) { renderBlock(subBuffer, subMidi, subHead); });
+    OSCI_PROFILE_END_BLOCK(profiler);
+    renderingOffline = false;
+}
+
+bool OscirenderAudioProcessor::waitForVoices(int timeoutMs) {
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+    // +1 overlap voice for kill-fade, matching the target given to voiceBuilder.
+    const int target = (int) voices->getValueUnnormalised() + 1;
+    while (synth.getNumVoices() < target) {
+        if (juce::Time::getMillisecondCounter() > deadline)
+            return false;
+        juce::Thread::sleep(5);
+    }
+    return true;
+}
+
+void OscirenderAudioProcessor::renderBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* head) {
+    // Offline renders follow the supplied free-running transport rather than the
+    // standalone app's internal clock and tempo parameter.
+    const bool useStandaloneClock = juce::JUCEApplicationBase::isStandaloneApp() && !renderingOffline;
+
+    // Pin the effect and file registries for the whole block. Neither takes a
+    // lock, so edits on the message thread can't make this block wait.
+    VersionedSnapshot<EffectRegistry>::Reader effects(effectRegistry);
+    VersionedSnapshot<FileRegistry>::Reader files(fileRegistry);
+    audioEffectRegistry = effects.get();
+    audioFileRegistry = files.get();
+
+    // Apply file selection on the audio thread (among already-loaded files),
+    // and give the voices any new preview effect clones.
+    applyFileSelect(*files);
+    applyPreviewEffect(*effects);
+    // The voices now point into these versions, so keep them alive until
+    // newer ones have been applied.
+    fileRegistry.hold(files);
+    effectRegistry.hold(effects);
+
     // Audio info variables
     int totalNumInputChannels = getTotalNumInputChannels();
     int totalNumOutputChannels = getTotalNumOutputChannels();
@@ -844,7 +1262,7 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
     juce::AudioPlayHead::TimeSignature timeSig;
 
     // Get MIDI transport info
-    playHead = this->getPlayHead();
+    playHead = head;
     if (playHead != nullptr) {
         auto pos = playHead->getPosition();
         if (pos.hasValue()) {
@@ -866,7 +1284,7 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
     }
 
     // In standalone mode, use the standaloneBpm parameter as the tempo source
-    if (juce::JUCEApplicationBase::isStandaloneApp()) {
+    if (useStandaloneClock) {
         bpm = (double)standaloneBpm->getValueUnnormalised();
     }
 
@@ -970,10 +1388,10 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
     // This ensures LFO phases advance exactly once per sample regardless of voice count or processing location
     // Only animate effects that are enabled or being previewed (animation is expensive!)
     {
-        juce::SpinLock::ScopedLockType lock(effectsLock);
-        for (auto& effect : toggleableEffects) {
+        OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::Modulation);
+        for (auto& effect : effects->toggleable) {
             const bool isEnabled = effect->enabled != nullptr && effect->enabled->getBoolValue();
-            const bool isPreviewed = (effect == previewEffect);
+            const bool isPreviewed = (effect == effects->preview);
             if (isEnabled || isPreviewed) {
                 effect->animateValues(numSamples, &currentVolumeBuffer);
             }
@@ -993,6 +1411,8 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
         envelopeParameters.fillBlockBuffers(numSamples, uiVoiceEnvActive, uiVoiceEnvValue);
         randomParameters.fillBlockBuffers(numSamples, sampleRate, midiMessages,
                                           currentBpm.load(std::memory_order_relaxed), uiVoiceActive);
+        stepSequencerParameters.fillBlockBuffers(numSamples, sampleRate, bpm, lfoSyncStartSeconds,
+                                                 hasPpqPosition ? ppqPosition : lfoSyncStartSeconds * bpm / 60.0);
 #endif
 
         // Always run the sidechain envelope follower so the UI display
@@ -1003,6 +1423,10 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
         modulationEngine.applyAllModulation(numSamples);
     }
 
+    // With every parameter final for the block, fuse runs of affine effects
+    // so voices and the input path apply each run as one transform.
+    affineChain.prepareBlock(effects->toggleable, numSamples, isToggleableEffectActive);
+
     if (sampleRate > 0.0)
         lfoSyncTimeSeconds = lfoSyncStartSeconds + (double)numSamples / sampleRate;
 
@@ -1022,10 +1446,21 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
     bool applyToggleableEffectsGlobally = false;
     juce::AudioBuffer<float>* toggleableExternalInput = nullptr;
 
+    // Live image input: Syphon/Spout on macOS and Windows, ffmpeg on Linux.
+    ImageParser* liveImageParser = nullptr;
 #if (JUCE_MAC || JUCE_WINDOWS) && OSCI_PREMIUM
     if (syphonInputActive) {
+        liveImageParser = &syphonImageParser;
+    }
+#elif JUCE_LINUX && OSCI_PREMIUM
+    if (liveVideoInputActive) {
+        liveImageParser = &liveVideoImageParser;
+    }
+#endif
+
+    if (liveImageParser != nullptr) {
         for (int sample = 0; sample < outputBuffer3d.getNumSamples(); sample++) {
-            osci::Point point = syphonImageParser.getSample(sample);
+            osci::Point point = liveImageParser->getSample(sample);
             outputBuffer3d.setSample(0, sample, point.x);
             outputBuffer3d.setSample(1, sample, point.y);
         }
@@ -1039,9 +1474,7 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
         );
 
         applyToggleableEffectsGlobally = true;
-    } else
-#endif
-    if (usingInput && totalNumInputChannels >= 1) {
+    } else if (usingInput && totalNumInputChannels >= 1) {
         if (totalNumInputChannels >= 2) {
             for (auto channel = 0; channel < juce::jmin(2, totalNumInputChannels); channel++) {
                 outputBuffer3d.copyFrom(channel, 0, inputBuffer, channel, 0, buffer.getNumSamples());
@@ -1062,19 +1495,17 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
         applyToggleableEffectsGlobally = true;
         toggleableExternalInput = &inputBuffer;
     } else {
-        juce::SpinLock::ScopedLockType lock1(parsersLock);
-        juce::SpinLock::ScopedLockType lock2(effectsLock);
-
-        // Apply file selection on the audio thread (among already-loaded files)
-        applyFileSelectLocked();
-
+        OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::Synth);
         synth.renderNextBlock(outputBuffer3d, midiMessages, 0, buffer.getNumSamples());
     }
 
+    // Voices are checked individually, but the input and Syphon paths aren't,
+    // and enough loud voices can still sum past the limit.
+    containBadSamples(outputBuffer3d);
+
     // Apply toggleable effects for non-synth paths (Syphon/Spout and audio input)
     if (applyToggleableEffectsGlobally) {
-        juce::SpinLock::ScopedLockType lock(effectsLock);
-
+        OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::InputEffects);
         inputFrequencyBuffer.setSize(1, numSamples, false, false, true);
         {
             const float* freqBuf = frequencyEffect->getAnimatedValuesReadPointer(0, numSamples);
@@ -1085,7 +1516,7 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
             }
         }
 
-        applyToggleableEffectsToBuffer(outputBuffer3d, toggleableExternalInput, &currentVolumeBuffer, &inputFrequencyBuffer, nullptr, nullptr, previewEffect);
+        applyToggleableEffectsToBuffer(outputBuffer3d, toggleableExternalInput, &currentVolumeBuffer, &inputFrequencyBuffer, nullptr, nullptr, effects->preview);
     }
 
     midiMessages.clear();
@@ -1094,8 +1525,9 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
 
     // Handle animation frame updates
     if (animateFrames->getBoolValue()) {
+        OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::Animation);
         double frameIncrement;
-        if (juce::JUCEApplicationBase::isStandaloneApp()) {
+        if (useStandaloneClock) {
             frameIncrement = sTimeSec * animationRate->getValueUnnormalised() * numSamples;
         } else if (animationSyncBPM->getValue()) {
             animationFrame = playTimeBeats * animationRate->getValueUnnormalised() + animationOffset->getValueUnnormalised();
@@ -1105,46 +1537,42 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
             frameIncrement = 0.0; // Already calculated absolute position
         }
 
-        if (juce::JUCEApplicationBase::isStandaloneApp()) {
+        if (useStandaloneClock) {
             animationFrame = animationFrame + frameIncrement;
         }
 
-        juce::SpinLock::ScopedLockType lock1(parsersLock);
-        juce::SpinLock::ScopedLockType lock2(effectsLock);
-        if (currentFile >= 0 && sounds[currentFile]->parser->isAnimatable) {
-            int totalFrames = sounds[currentFile]->parser->getNumFrames();
+        auto* parser = appliedFileIndex >= 0 ? files->sounds[(size_t)appliedFileIndex]->parser.get() : nullptr;
+        if (parser != nullptr && parser->isAnimatable) {
+            int totalFrames = parser->getNumFrames();
             if (loopAnimation->getBoolValue()) {
                 animationFrame = std::fmod(animationFrame, totalFrames);
             } else {
                 animationFrame = juce::jlimit(0.0, (double)totalFrames - 1, animationFrame.load());
             }
-            sounds[currentFile]->parser->setFrame(animationFrame);
+            parser->setFrame(animationFrame);
         }
     }
 
 
     {
-        juce::SpinLock::ScopedLockType lock1(parsersLock);
-        juce::SpinLock::ScopedLockType lock2(effectsLock);
-
-        // If we're in audio-input mode, the synth path above didn't run, but we still
-        // want file selection to affect Lua/custom processing on the audio thread.
-        if (usingInput) {
-            applyFileSelectLocked();
-        }
-
         // Note: toggleableEffects/previewEffect are applied via shared helper:
         // - per-voice when using the synth path
         // - directly to the buffer when using input mode
         // Only permanentEffects and luaEffects are always global
 
-        for (auto& effect : permanentEffects) {
-            effect->processBlockWithInputs(outputBuffer3d, midiMessages, nullptr, &currentVolumeBuffer, nullptr);
+        {
+            OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::PermanentEffects);
+            for (auto& effect : permanentEffects) {
+                effect->processBlockWithInputs(outputBuffer3d, midiMessages, nullptr, &currentVolumeBuffer, nullptr);
+                containBadSamples(outputBuffer3d, effect.get());
+            }
         }
-        auto lua = currentFile >= 0 ? sounds[currentFile]->parser->getLua() : nullptr;
-        if (lua != nullptr || custom->enabled->getBoolValue()) {
+        const bool fileIsLua = appliedFileIndex >= 0 && files->sounds[(size_t)appliedFileIndex]->parser->isLua();
+        if (fileIsLua || custom->enabled->getBoolValue()) {
+            OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::LuaEffects);
             for (auto& effect : luaEffects) {
                 effect->processBlockWithInputs(outputBuffer3d, midiMessages, nullptr, &currentVolumeBuffer, nullptr);
+                containBadSamples(outputBuffer3d, effect.get());
             }
         }
     }
@@ -1152,10 +1580,18 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
     // Process in batches using buffer-wide operations
     auto* outputArray = outputBuffer3d.getArrayOfWritePointers();
     
-    applyVolumeAndThreshold(outputArray, numSamples);
+    {
+        OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::Output);
+        applyVolumeAndThreshold(outputArray, numSamples);
+        // Last line of defence before the visualisers and the host.
+        containBadSamples(outputBuffer3d);
+    }
     
     // Write to thread manager (for visualizers, etc.)
-    threadManager.write(outputBuffer3d);
+    {
+        OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::ThreadManagerWrite);
+        threadManager.write(outputBuffer3d);
+    }
     
     // Apply mute if active
     if (muteParameter->getBoolValue()) {
@@ -1178,10 +1614,16 @@ void OscirenderAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
     }
 
     // used for any callback that must guarantee all audio is recieved (e.g. when recording to a file)
-    juce::SpinLock::ScopedLockType lock(audioThreadCallbackLock);
-    if (audioThreadCallback != nullptr) {
-        audioThreadCallback(buffer);
+    {
+        OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::AudioCallback);
+        juce::SpinLock::ScopedLockType lock(audioThreadCallbackLock);
+        if (audioThreadCallback != nullptr) {
+            audioThreadCallback(buffer);
+        }
     }
+
+    audioEffectRegistry = nullptr;
+    audioFileRegistry = nullptr;
 }
 
 juce::AudioProcessorEditor* OscirenderAudioProcessor::createEditor() {
@@ -1191,6 +1633,17 @@ juce::AudioProcessorEditor* OscirenderAudioProcessor::createEditor() {
 
 //==============================================================================
 void OscirenderAudioProcessor::getStateInformation(juce::MemoryBlock& destData) {
+    writeState(destData, false);
+}
+
+void OscirenderAudioProcessor::getProjectFileData(juce::MemoryBlock& destData) {
+    writeState(destData, true);
+}
+
+// File payloads are stored as hash-addressed blobs alongside the XML rather
+// than Base64 inside it. Host state only references them in blobStore, which
+// keeps session saves small; project files embed them.
+void OscirenderAudioProcessor::writeState(juce::MemoryBlock& destData, bool embedFiles) {
     juce::Logger::writeToLog("getStateInformation: saving state (version " + juce::String(ProjectInfo::versionString) + ")");
 
     // we need to stop recording the visualiser when saving the state, otherwise
@@ -1201,6 +1654,19 @@ void OscirenderAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
         haltRecording();
     }
 
+    // Hashing and storing files can take a while, so it happens after the
+    // locks the audio thread needs have been released.
+    std::vector<ProjectFiles::File> files;
+    auto xml = createStateXml(files);
+
+    ProjectChunkFormat::Writer writer(blobStore, embedFiles);
+    ProjectFiles::save(files, writer, *xml->createNewChildElement("files"));
+    writer.write(*xml, destData);
+    juce::Logger::writeToLog("getStateInformation: saved " + juce::String(effects.size()) + " effects, "
+        + juce::String((int) files.size()) + " files, " + juce::String((int)destData.getSize()) + " bytes");
+}
+
+std::unique_ptr<juce::XmlElement> OscirenderAudioProcessor::createStateXml(std::vector<ProjectFiles::File>& files) {
     juce::SpinLock::ScopedLockType lock1(parsersLock);
     juce::SpinLock::ScopedLockType lock2(effectsLock);
 
@@ -1240,6 +1706,7 @@ void OscirenderAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 
     randomParameters.saveToXml(xml.get());
     sidechainParameters.saveToXml(xml.get());
+    stepSequencerParameters.saveToXml(xml.get());
 #endif
 
     auto customFunction = xml->createNewChildElement("customFunction");
@@ -1250,15 +1717,11 @@ void OscirenderAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
     fontXml->setAttribute("bold", font.isBold());
     fontXml->setAttribute("italic", font.isItalic());
 
-    auto filesXml = xml->createNewChildElement("files");
-
     for (int i = 0; i < fileBlocks.size(); i++) {
-        auto fileXml = filesXml->createNewChildElement("file");
-        fileXml->setAttribute("name", fileNames[i]);
-        auto base64 = fileBlocks[i]->toBase64Encoding();
-        fileXml->addTextElement(base64);
+        files.push_back({ fileNames[i], fileBlocks[i], pendingBlobs[i] });
     }
     xml->setAttribute("currentFile", currentFile);
+    keyMap.save(xml.get());
 
     recordingParameters.save(xml.get());
 
@@ -1266,9 +1729,7 @@ void OscirenderAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 
     saveProperties(*xml);
 
-    copyXmlToBinary(*xml, destData);
-    juce::Logger::writeToLog("getStateInformation: saved " + juce::String(effects.size()) + " effects, "
-        + juce::String(fileBlocks.size()) + " files, " + juce::String((int)destData.getSize()) + " bytes");
+    return xml;
 }
 
 void OscirenderAudioProcessor::setStateInformation(const void* data, int sizeInBytes) {
@@ -1280,9 +1741,13 @@ void OscirenderAudioProcessor::setStateInformation(const void* data, int sizeInB
     }
 
     std::unique_ptr<juce::XmlElement> xml;
+    std::unique_ptr<ProjectChunkFormat::Reader> chunkReader;
 
     const uint32_t magicXmlNumber = 0x21324356;
-    if (sizeInBytes > 8 && juce::ByteOrder::littleEndianInt(data) == magicXmlNumber) {
+    if (ProjectChunkFormat::isChunkedProject(data, (size_t) sizeInBytes)) {
+        chunkReader = std::make_unique<ProjectChunkFormat::Reader>(data, (size_t) sizeInBytes);
+        xml = chunkReader->readXml();
+    } else if (sizeInBytes > 8 && juce::ByteOrder::littleEndianInt(data) == magicXmlNumber) {
         // this is a binary xml format
         xml = getXmlFromBinary(data, sizeInBytes);
     } else {
@@ -1366,32 +1831,56 @@ void OscirenderAudioProcessor::setStateInformation(const void* data, int sizeInB
             removeFile(0);
         }
 
+        // Loaded before the files so zones on a missing file can be dropped.
+        keyMap.load(xml.get());
+
         auto filesXml = xml->getChildByName("files");
+        juce::StringArray missingFiles;
         if (filesXml != nullptr) {
-            int fileCount = 0;
-            for (auto fileXml : filesXml->getChildIterator()) {
-                auto fileName = fileXml->getStringAttribute("name");
-                auto text = fileXml->getAllSubText();
-                std::shared_ptr<juce::MemoryBlock> fileBlock;
-
-                if (lessThanVersion(version, "2.2.0")) {
-                    // Older versions of osci-render opened files in a silly way
-                    auto stream = juce::MemoryOutputStream();
-                    juce::Base64::convertFromBase64(stream, text);
-                    fileBlock = std::make_shared<juce::MemoryBlock>(stream.getData(), stream.getDataSize());
+            auto restored = ProjectFiles::restore(*filesXml, chunkReader.get(), blobStore, lessThanVersion(version, "2.2.0"));
+            for (int index : restored.missingIndices) {
+                keyMap.fileRemoved(index);
+            }
+            missingFiles = restored.missingNames;
+
+            for (auto& file : restored.files) {
+                if (file.pendingBlob.isNotEmpty()) {
+                    addPendingFile(file.name, file.pendingBlob, file.block);
                 } else {
-                    fileBlock = std::make_shared<juce::MemoryBlock>();
-                    fileBlock->fromBase64Encoding(text);
+                    addFile(file.name, file.block);
                 }
-
-                addFile(fileName, fileBlock);
-                fileCount++;
             }
-            juce::Logger::writeToLog("setStateInformation: restored " + juce::String(fileCount) + " files");
+            juce::Logger::writeToLog("setStateInformation: restored " + juce::String((int) restored.files.size()) + " files");
         } else {
             juce::Logger::writeToLog("setStateInformation: no files section found");
         }
+        publishFileRegistry();
         changeCurrentFile(xml->getIntAttribute("currentFile", -1));
+        // Files a zone plays are opened now; the rest wait to be selected.
+        openKeyMappedFiles();
+
+        // Headless renders have no message loop to open files as they're selected.
+        if (isHeadless()) {
+            const int current = currentFile;
+            for (int i = 0; i < (int) fileBlocks.size(); i++) {
+                if (isFilePending(i)) {
+                    openFile(i);
+                }
+            }
+            changeCurrentFile(current);
+        }
+
+        if (!missingFiles.isEmpty() && isHeadless()) {
+            juce::Logger::writeToLog("setStateInformation: missing files: " + missingFiles.joinIntoString(", "));
+        } else if (!missingFiles.isEmpty()) {
+            juce::MessageManager::callAsync([missingFiles]() {
+                juce::AlertWindow::showMessageBoxAsync(
+                    juce::AlertWindow::WarningIcon,
+                    "Missing Files",
+                    "The following files could not be found and were not loaded:\n\n" + missingFiles.joinIntoString("\n"),
+                    "OK");
+            });
+        }
 
         // Load global LFO waveforms & assignments (premium only)
 #if OSCI_PREMIUM
@@ -1420,10 +1909,16 @@ void OscirenderAudioProcessor::setStateInformation(const void* data, int sizeInB
         sidechainParameters.loadFromXml(xml.get());
 #endif
 
+        // Load step sequencer state (premium only)
+#if OSCI_PREMIUM
+        stepSequencerParameters.loadFromXml(xml.get());
+#endif
+
         recordingParameters.load(xml.get());
 
         loadProperties(*xml);
         objectServer.reload();
+        reloadOscServer();
 
         loadMidiCCState(xml.get());
 #if OSCI_PREMIUM
@@ -1437,15 +1932,17 @@ void OscirenderAudioProcessor::setStateInformation(const void* data, int sizeInB
 #if !OSCI_PREMIUM
         if (xml->getBoolAttribute("premiumProject", false)) {
             juce::Logger::writeToLog("setStateInformation: premium project loaded in free build, some features unavailable");
-            juce::MessageManager::callAsync([]() {
-                juce::AlertWindow::showMessageBoxAsync(
-                    juce::AlertWindow::InfoIcon,
-                    "Premium Project",
-                    "This project was saved with the premium version of osci-render. "
-                    "Some features (global LFOs, envelopes, random/sidechain modulation, "
-                    "glide, legato, and premium effects) will not be available.",
-                    "OK");
-            });
+            if (!isHeadless()) {
+                juce::MessageManager::callAsync([]() {
+                    juce::AlertWindow::showMessageBoxAsync(
+                        juce::AlertWindow::InfoIcon,
+                        "Premium Project",
+                        "This project was saved with the premium version of osci-render. "
+                        "Some features (global LFOs, envelopes, random/sidechain modulation, step sequencers, "
+                        "glide, legato, and premium effects) will not be available.",
+                        "OK");
+                });
+            }
         }
 #endif
 
@@ -18,11 +18,21 @@
 #include <unordered_map>
 
 #include "CommonPluginProcessor.h"
+#include "util/FileUndoActions.h"
+#include "util/ProjectBlobStore.h"
+#include "util/ProjectFiles.h"
+#include "util/VersionedSnapshot.h"
+#include "audio/AffineChain.h"
+#include "audio/AudioThreadProfiler.h"
+#include "audio/SampleSanitiser.h"
+#include "audio/SubBlockSplitter.h"
 #include "audio/effects/CustomEffect.h"
 #include "audio/effects/DelayEffect.h"
 #include "audio/modulation/LuaEffectState.h"
 #include "audio/effects/PerspectiveEffect.h"
 #include "audio/synth/VoiceManager.h"
+#include "audio/synth/KeyMap.h"
+#include "audio/synth/SoundRegistry.h"
 #include "audio/platform/SampleRateManager.h"
 #include "audio/synth/ShapeSound.h"
 #include "audio/synth/ShapeVoice.h"
@@ -34,11 +44,14 @@
 #include "audio/modulation/EnvelopeParameters.h"
 #include "audio/modulation/RandomState.h"
 #include "audio/modulation/RandomParameters.h"
+#include "audio/modulation/StepSequencerParameters.h"
 #include "audio/modulation/SidechainState.h"
 #include "audio/modulation/SidechainParameters.h"
 #include "audio/modulation/ModulationEngine.h"
 #include "audio/modulation/ModulationTypes.h"
 #include "obj/ObjectServer.h"
+#include "obj/OscServer.h"
+#include "obj/ObjectView.h"
 
 class FileParser;
 
@@ -46,6 +59,9 @@ class FileParser;
 #include "parser/img/ImageParser.h"
 #include "../modules/juce_sharedtexture/SharedTexture.h"
 #include "video/SyphonFrameGrabber.h"
+#elif JUCE_LINUX && OSCI_PREMIUM
+#include "parser/img/ImageParser.h"
+#include "video/FFmpegLiveVideoSource.h"
 #endif
 
 //==============================================================================
@@ -81,7 +97,7 @@ private:
 
 /**
  */
-class OscirenderAudioProcessor : public CommonAudioProcessor, juce::AudioProcessorParameter::Listener, public VoiceManagerClient
+class OscirenderAudioProcessor : public CommonAudioProcessor, juce::AudioProcessorParameter::Listener, public VoiceManagerClient, OscServer::Listener, public UndoableFileList
 #if JucePlugin_Enable_ARA
     ,
                                  public juce::AudioProcessorARAExtension
@@ -113,12 +129,31 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
+    // --- Offline project rendering (see OfflineProjectRenderer) ---
+
+    // prepareToPlay() while holding offlineRenderLock, so it never overlaps a device callback.
+    void prepareForOfflineRender(double sampleRate, int samplesPerBlock);
+    // Renders one block using |offlinePlayHead| as the transport. Any device callback
+    // that arrives meanwhile outputs silence instead of waiting.
+    void processOfflineBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead& offlinePlayHead);
+    // Full XYZRGB output of the most recent block, after volume and threshold.
+    const juce::AudioBuffer<float>& getLastOutputBuffer3d() const { return outputBuffer3d; }
+    // Waits until VoiceBuilder has built the current polyphony. Returns false on timeout.
+    bool waitForVoices(int timeoutMs);
+
+    // Set by the command-line renderer, where there is nobody to answer a
+    // dialog. Warnings that would show one are logged instead.
+    void setHeadless(bool shouldBeHeadless) { headless = shouldBeHeadless; }
+    bool isHeadless() const { return headless; }
+
     juce::AudioProcessorEditor* createEditor() override;
 
     void setAudioThreadCallback(std::function<void(const juce::AudioBuffer<float>&)> callback);
 
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
+    // Project files embed their file blobs so they can be moved between machines.
+    void getProjectFileData(juce::MemoryBlock& destData) override;
     void parameterValueChanged(int parameterIndex, float newValue) override;
     void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
 
@@ -155,11 +190,39 @@ public:
     // Per-voice per-envelope current values for modulation (written by audio-thread voices)
     std::atomic<float> uiVoiceEnvValue[NUM_ENVELOPES][kMaxUiVoices]{};
 
+    // toggleableEffects and previewEffect are guarded by effectsLock and only
+    // touched on the message thread. The audio thread reads them through
+    // effectRegistry instead, which publishEffectRegistry() rebuilds whenever
+    // either changes. luaEffects and permanentEffects are filled in the
+    // constructor and never change afterwards, so they are read directly.
     std::vector<std::shared_ptr<osci::Effect>> toggleableEffects;
     std::vector<std::shared_ptr<osci::Effect>> luaEffects;
-    // Temporary preview effect applied while hovering effects in the grid (guarded by effectsLock)
+    // Temporary preview effect applied while hovering effects in the grid
     std::shared_ptr<osci::Effect> previewEffect;
 
+    struct EffectRegistry {
+        // toggleableEffects in precedence order.
+        std::vector<std::shared_ptr<osci::Effect>> toggleable;
+        std::shared_ptr<osci::Effect> preview;
+        // Clones of the preview effect for each voice, made when the preview
+        // was set so voices don't clone on the audio thread. Shared between
+        // registries until the preview changes.
+        std::shared_ptr<const std::vector<std::shared_ptr<osci::SimpleEffect>>> voicePreviews;
+#if OSCI_AUDIO_PROFILER
+        // Profiler slot for each effect in toggleable.
+        std::vector<int> profileSlots;
+#endif
+    };
+    VersionedSnapshot<EffectRegistry> effectRegistry;
+
+#if OSCI_AUDIO_PROFILER
+    AudioThreadProfiler profiler;
+#endif
+
+    // Registry pinned for the block being rendered. Audio thread only, and
+    // only valid inside renderBlock().
+    const EffectRegistry* getAudioEffectRegistry() const { return audioEffectRegistry; }
+
     std::shared_ptr<osci::Effect> frequencyEffect = std::make_shared<osci::SimpleEffect>(
         new osci::EffectParameter(
             "Frequency",
@@ -194,10 +257,15 @@ public:
     std::vector<std::shared_ptr<FileParser>> parsers;
     std::vector<ShapeSound::Ptr> sounds;
     std::vector<std::shared_ptr<juce::MemoryBlock>> fileBlocks;
+    // The blob hash of each restored file until it is first opened, empty
+    // after. Its fileBlocks entry stays nullptr until its bytes are needed.
+    std::vector<juce::String> pendingBlobs;
     std::vector<juce::String> fileNames;
     int currentFileId = 0;
     std::vector<int> fileIds;
     std::atomic<int> currentFile = -1;
+    // Which file each note plays, guarded by parsersLock like the files.
+    KeyMap keyMap;
 
     juce::ChangeBroadcaster broadcaster;
     std::atomic<bool> objectServerRendering = false;
@@ -219,6 +287,7 @@ public:
     // === Global modulation state classes ===
     LfoParameters lfoParameters;
     RandomParameters randomParameters;
+    StepSequencerParameters stepSequencerParameters;
     SidechainParameters sidechainParameters;
 
     // Cross-modulation-source operations (delegated to modulationEngine declared below)
@@ -268,6 +337,12 @@ public:
     // Audio-thread readable pointer to the currently selected sound.
     // Lifetime is owned by defaultSound/objectServerSound/sounds[].
     ShapeSound* getActiveShapeSound() const { return activeShapeSound.load(std::memory_order_acquire); }
+    // Audio thread only. The registry whose keymap picks each note's sound,
+    // or nullptr while fileSelect picks it for every note.
+    const SoundRegistry<ShapeSound>* getKeyMapRegistry() const;
+    // Replaces the keymap. Zones refer to files by their index.
+    void setKeyZones(std::vector<KeyZone> zones);
+    std::vector<KeyZone> getKeyZones();
 
     osci::BooleanParameter* animateFrames = new osci::BooleanParameter("Animate", "animateFrames", VERSION_HINT, true, "Enables animation for files that have multiple frames, such as GIFs or Line Art.");
     osci::BooleanParameter* loopAnimation = new osci::BooleanParameter("Loop Animation", "loopAnimation", VERSION_HINT, true, "Loops the animation. If disabled, the animation will stop at the last frame.");
@@ -276,6 +351,7 @@ public:
     osci::FloatParameter* animationOffset = new osci::FloatParameter("Animation Offset", "animationOffset", VERSION_HINT, 0, -10000, 10000);
 
     osci::BooleanParameter* invertImage = new osci::BooleanParameter("Invert Image", "invertImage", VERSION_HINT, false, "Inverts the image so that dark pixels become light, and vice versa.");
+    osci::BooleanParameter* hiddenLineRemoval = new osci::BooleanParameter("Hidden Line Removal", "hiddenLineRemoval", VERSION_HINT, false, "Hides the edges of 3D objects that are behind one of the object's faces, so solid models look solid.");
     std::shared_ptr<osci::Effect> imageThreshold = std::make_shared<osci::SimpleEffect>(
         new osci::EffectParameter(
             "Image Threshold",
@@ -310,44 +386,68 @@ public:
 
     // Add a callback to notify the editor when a file is removed
     std::function<void(int)> fileRemovedCallback;
+    // ...and when undo or redo puts one back
+    std::function<void(int)> fileInsertedCallback;
 
     void addLuaSlider();
     void updateEffectPrecedence();
     // Apply a saved effect ordering by ID.  Used by undo/redo — safe to call
     // even if the editor has been destroyed and recreated.
     void applyEffectOrder(const std::vector<juce::String>& order);
-    void updateFileBlock(int index, std::shared_ptr<juce::MemoryBlock> block);
+    void withFilesLocked(const std::function<void()>& edit) override;
+    void updateFileBlock(int index, std::shared_ptr<juce::MemoryBlock> block) override;
     void addFile(juce::File file);
     void addFile(juce::String fileName, const char* data, const int size);
     void addFile(juce::String fileName, std::shared_ptr<juce::MemoryBlock> data);
-    void removeFile(int index);
-    int numFiles();
+    void insertFile(int index, juce::String fileName, std::shared_ptr<juce::MemoryBlock> data) override;
+    void removeFile(int index) override;
+    void fileContentsRestored(int index) override;
+    void saveFileSettings(int index, juce::XmlElement& settings) override;
+    void restoreFileSettings(int index, const juce::XmlElement& settings) override;
+    int numFiles() override;
     void changeCurrentFile(int index);
     void openFile(int index);
+    // Opens every file still waiting from a restored state, for renders that
+    // can't wait for files to be opened as they are selected.
+    void openPendingFiles();
+    // Opens the current file if it was restored but not opened yet, e.g.
+    // after the audio thread selected it through fileSelect.
+    void openCurrentFileIfPending();
+    // Opens every file a keymap zone plays that is still waiting from a
+    // restored state, since a note can land on it at any time.
+    // parsersLock AND effectsLock must be locked before calling this function
+    void openKeyMappedFiles();
     int getCurrentFileIndex();
     std::shared_ptr<FileParser> getCurrentFileParser();
     juce::String getCurrentFileName();
-    juce::String getFileName(int index);
-    juce::String getFileId(int index);
-    std::shared_ptr<juce::MemoryBlock> getFileBlock(int index);
+    juce::String getFileName(int index) override;
+    juce::String getFileId(int index) override;
+    std::shared_ptr<juce::MemoryBlock> getFileBlock(int index) override;
+    // SHA-256 of a file's contents, cached with the block so saving state
+    // doesn't hash it again. Safe on any thread.
+    juce::String getFileHash(const std::shared_ptr<juce::MemoryBlock>& block) { return blobStore.hashOf(block); }
     void setObjectServerRendering(bool enabled);
     void setObjectServerPort(int port);
+    // 0 turns the OSC server off
+    void setOscServerPort(int port);
+    int getOscServerPort();
+    // The rotate, scale and translate effects and perspective camera that
+    // OBJ files are about to be drawn through
+    ObjectView::Settings getObjectViewSettings();
     void addErrorListener(ErrorListener* listener);
     void removeErrorListener(ErrorListener* listener);
     void notifyErrorListeners(int lineNumber, juce::String id, juce::String error);
 
-    // Preview API: set/clear a temporary effect by ID for hover auditioning
+    // Preview API: set/clear a temporary effect by ID for hover auditioning.
+    // Both take effectsLock themselves, so don't hold it when calling them.
     void setPreviewEffectId(const juce::String& effectId);
     void clearPreviewEffect();
-    std::shared_ptr<osci::SimpleEffect> getCachedPreviewEffect() { 
-        return std::dynamic_pointer_cast<osci::SimpleEffect>(previewEffect); 
-    }
 
     // Get the external input buffer for effects that need it
     juce::AudioBuffer<float>* getInputBuffer() { return &inputBuffer; }
 
     // Centralized toggleable effect application (used by both synth voices and audio-input mode)
-    // effectsLock should be held when calling this from the audio thread.
+    // Audio thread only - reads the registry pinned by renderBlock().
     void applyToggleableEffectsToBuffer(
         juce::AudioBuffer<float>& buffer,
         juce::AudioBuffer<float>* externalInput,
@@ -357,8 +457,17 @@ public:
         const std::unordered_map<juce::String, std::shared_ptr<osci::SimpleEffect>>* perVoiceEffects,
         const std::shared_ptr<osci::Effect>& previewEffectInstance);
 
-    // Setter for the callback
+    // Audio thread only. Replaces any NaN, Inf or runaway samples in `buffer`
+    // and, if `source` produced them, resets it so its state can't keep
+    // feeding them back. Returns true if anything had to be contained.
+    bool containBadSamples(juce::AudioBuffer<float>& buffer, osci::Effect* source = nullptr);
+
+    // Number of blocks so far that needed containing, for the UI.
+    juce::uint32 getContainmentCount() const { return containmentCount.load(std::memory_order_relaxed); }
+
+    // Setters for the callbacks
     void setFileRemovedCallback(std::function<void(int)> callback);
+    void setFileInsertedCallback(std::function<void(int)> callback);
 
     // Added declaration for the new `removeParser` method.
     void removeParser(FileParser* parser);
@@ -386,10 +495,42 @@ public:
     };
 
 private:
+    void renderBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, juce::AudioPlayHead* head);
+    // Files restored from state wait in blobStore, unparsed, until they are
+    // first selected. parsersLock AND effectsLock must be held for these.
+    void addPendingFile(juce::String fileName, juce::String blobHash, std::shared_ptr<juce::MemoryBlock> data);
+    bool isFilePending(int index) const;
+
+    void writeState(juce::MemoryBlock& destData, bool embedFiles);
+    // Everything but the files' contents, with the files to save listed in
+    // `files`. Takes parsersLock and effectsLock.
+    std::unique_ptr<juce::XmlElement> createStateXml(std::vector<ProjectFiles::File>& files);
+
+    // Content-addressed file payloads referenced by saved state.
+    ProjectBlobStore blobStore { applicationFolder.getChildFile("Project Files") };
+
     juce::AudioBuffer<float> inputBuffer;
     juce::AudioBuffer<float> inputFrequencyBuffer;
     juce::AudioBuffer<float> outputBuffer3d;
 
+    // Renders each block in pieces split at MIDI CCs, so CC-mapped parameters
+    // and modulation depths change on the sample the controller arrived.
+    SubBlockSplitter subBlockSplitter;
+
+    // Runs of adjacent affine toggleable effects, fused for the block being
+    // rendered. Audio thread only.
+    AffineChain affineChain;
+
+    std::atomic<juce::uint32> containmentCount { 0 };
+    // Block size from prepareToPlay, so effects reset on the audio thread are
+    // prepared exactly as they were and don't reallocate.
+    int preparedBlockSize = 512;
+
+    // Held by the offline renderer for each block; processBlock only try-locks it.
+    juce::SpinLock offlineRenderLock;
+    bool renderingOffline = false;
+    std::atomic<bool> headless { false };
+
     std::atomic<bool> prevMidiEnabled = !midiEnabled->getBoolValue();
 
     juce::SpinLock audioThreadCallbackLock;
@@ -408,6 +549,13 @@ private:
     std::unique_ptr<VoiceBuilder> voiceBuilder;
 
     ObjectServer objectServer{*this};
+    OscServer oscServer{*this};
+
+    void reloadOscServer();
+    // OscServer::Listener
+    void oscParameterReceived(const juce::String& id, float value) override;
+    void oscFrameReceived(juce::MemoryBlock& frame) override;
+    void oscFramesEnded() override;
 
     // Peak-rectified input audio: per-sample max(|L|, |R|), no smoothing.
     // Fed into envelope followers (sidechain, free-version per-parameter sidechain).
@@ -426,16 +574,41 @@ private:
     std::pair<std::shared_ptr<osci::Effect>, osci::EffectParameter*> effectFromLegacyId(const juce::String& id, bool updatePrecedence = false);
     osci::LfoType lfoTypeFromLegacyAnimationType(const juce::String& type);
     double valueFromLegacy(double value, const juce::String& id);
-    void changeSound(ShapeSound::Ptr sound);
 
-    // parsersLock AND effectsLock must be held when calling this
-    void applyFileSelectLocked();
+    // effectsLock must be held when calling this
+    void publishEffectRegistry();
+    std::shared_ptr<const std::vector<std::shared_ptr<osci::SimpleEffect>>> makeVoicePreviews(const std::shared_ptr<osci::Effect>& effect);
+    // Per-voice clones of previewEffect, guarded by effectsLock.
+    std::shared_ptr<const std::vector<std::shared_ptr<osci::SimpleEffect>>> previewVoiceEffects;
+
+    // The sounds the audio thread can select between. Rebuilt by
+    // publishFileRegistry() whenever a file is added or removed; parsersLock
+    // must be held when calling it.
+    using FileRegistry = SoundRegistry<ShapeSound>;
+    VersionedSnapshot<FileRegistry> fileRegistry;
+    void publishFileRegistry();
+
+    // Audio thread only. Picks the sound from fileSelect (or the object
+    // server) and hands it to the voices if it changed.
+    void applyFileSelect(const FileRegistry& files);
+    // Audio thread only. Gives voices the preview clones from a new registry.
+    void applyPreviewEffect(const EffectRegistry& effects);
 
     std::atomic<ShapeSound*> activeShapeSound { nullptr };
 
+    // Audio-thread state for the registries pinned in renderBlock().
+    const EffectRegistry* audioEffectRegistry = nullptr;
+    const FileRegistry* audioFileRegistry = nullptr;
+    const FileRegistry* appliedFileRegistry = nullptr;
+    const void* appliedVoicePreviews = nullptr;
+    int appliedFileIndex = -1;
+
     struct FileSelectionAsyncNotifier : public juce::AsyncUpdater {
         explicit FileSelectionAsyncNotifier(OscirenderAudioProcessor& p) : processor(p) {}
-        void handleAsyncUpdate() override { processor.fileChangeBroadcaster.sendChangeMessage(); }
+        void handleAsyncUpdate() override {
+            processor.openCurrentFileIfPending();
+            processor.fileChangeBroadcaster.sendChangeMessage();
+        }
         OscirenderAudioProcessor& processor;
     };
 
@@ -475,6 +648,15 @@ public:
     ImageParser syphonImageParser = ImageParser(*this);
 #endif
 
+#if JUCE_LINUX && OSCI_PREMIUM
+public:
+    std::atomic<bool> liveVideoInputActive = false;
+
+    // Filled by the editor's FFmpegLiveVideoSource, sampled on the audio thread.
+    LatestFrameSlot liveVideoFrames;
+    ImageParser liveVideoImageParser = ImageParser(*this, liveVideoFrames);
+#endif
+
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscirenderAudioProcessor)
@@ -7,6 +7,9 @@ SosciAudioProcessor::SosciAudioProcessor() : CommonAudioProcessor(BusesPropertie
     if (juce::JUCEApplicationBase::isStandaloneApp()) {
         std::unique_ptr<juce::InputStream> stream = std::make_unique<juce::MemoryInputStream>(BinaryData::sosci_flac, BinaryData::sosci_flacSize, false);
         loadAudioFile(std::move(stream));
+        audioFileThumbnail.setSource([]() -> std::unique_ptr<juce::InputStream> {
+            return std::make_unique<juce::MemoryInputStream>(BinaryData::sosci_flac, BinaryData::sosci_flacSize, false);
+        });
     }
 
     addAllParameters();
@@ -36,6 +39,7 @@ void SosciAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
 
     // Get source buffer (either from WAV parser or input)
     juce::AudioBuffer<float> sourceBuffer;
+    ChannelLayout layout;
 
     {
         // Scope the wavParserLock to only the section that accesses wavParser.
@@ -51,6 +55,7 @@ void SosciAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
             wavBuffer.clear();
             wavParser.processBlock(wavBuffer);
             sourceBuffer = juce::AudioBuffer<float>(wavBuffer.getArrayOfWritePointers(), wavBuffer.getNumChannels(), numSamples);
+            layout = wavParser.getChannelLayout();
         } else {
             sourceBuffer = juce::AudioBuffer<float>(input.getArrayOfWritePointers(), input.getNumChannels(), numSamples);
         }
@@ -61,77 +66,101 @@ void SosciAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
     auto sourceArray = sourceBuffer.getArrayOfReadPointers();
     auto workArray = workBuffer.getArrayOfWritePointers();
     
-    // Copy X and Y channels
-    for (int ch = 0; ch < 2; ++ch) {
-        if (sourceBuffer.getNumChannels() > ch) {
-            juce::FloatVectorOperations::copy(workArray[ch], sourceArray[ch], numSamples);
-        } else {
-            juce::FloatVectorOperations::clear(workArray[ch], numSamples);
+    if (!layout.isEmpty()) {
+        // The file says which channel is which, so there's nothing to detect.
+        // Disabled inputs get the same defaults as a missing channel.
+        const std::pair<ChannelLayout::Role, float> roles[] = {
+            { ChannelLayout::X, 0.0f },
+            { ChannelLayout::Y, 0.0f },
+            { ChannelLayout::Z, 1.0f },
+            { ChannelLayout::R, 1.0f },
+            { ChannelLayout::G, 0.0f },
+            { ChannelLayout::B, 0.0f },
+        };
+        for (auto [role, missing] : roles) {
+            const int ch = layout.getChannel(role);
+            const bool disabled = (role == ChannelLayout::Z && forceDisableBrightnessInput)
+                || (role >= ChannelLayout::R && forceDisableRgbInput);
+            if (ch >= 0 && ch < sourceBuffer.getNumChannels() && !disabled) {
+                juce::FloatVectorOperations::copy(workArray[role], sourceArray[ch], numSamples);
+            } else {
+                juce::FloatVectorOperations::fill(workArray[role], missing, numSamples);
+            }
+        }
+    } else {
+        // Copy X and Y channels
+        for (int ch = 0; ch < 2; ++ch) {
+            if (sourceBuffer.getNumChannels() > ch) {
+                juce::FloatVectorOperations::copy(workArray[ch], sourceArray[ch], numSamples);
+            } else {
+                juce::FloatVectorOperations::clear(workArray[ch], numSamples);
+            }
         }
-    }
     
-    // Detect brightness mode: check if channel 2 has any signal > EPSILON
-    if (!brightnessEnabled && sourceBuffer.getNumChannels() > 2 && !forceDisableBrightnessInput) {
-        auto range = juce::FloatVectorOperations::findMinAndMax(sourceArray[2], numSamples);
-        if (range.getEnd() > EPSILON) {
-            brightnessEnabled = true;
+        // Detect brightness mode: check if channel 2 has any signal > EPSILON
+        if (!brightnessEnabled && sourceBuffer.getNumChannels() > 2 && !forceDisableBrightnessInput) {
+            auto range = juce::FloatVectorOperations::findMinAndMax(sourceArray[2], numSamples);
+            if (range.getEnd() > EPSILON) {
+                brightnessEnabled = true;
+            }
         }
-    }
     
-    // Detect RGB mode: check if channels 3 or 4 have any signal > EPSILON
-    bool haveG = sourceBuffer.getNumChannels() > 3;
-    bool haveB = sourceBuffer.getNumChannels() > 4;
-    if (!rgbEnabled && !forceDisableRgbInput && (haveG || haveB)) {
-        bool hasGSignal = false;
-        bool hasBSignal = false;
+        // Detect RGB mode: check if channels 3 or 4 have any signal > EPSILON
+        bool haveG = sourceBuffer.getNumChannels() > 3;
+        bool haveB = sourceBuffer.getNumChannels() > 4;
+        if (!rgbEnabled && !forceDisableRgbInput && (haveG || haveB)) {
+            bool hasGSignal = false;
+            bool hasBSignal = false;
         
-        if (haveG) {
-            auto gRange = juce::FloatVectorOperations::findMinAndMax(sourceArray[3], numSamples);
-            hasGSignal = std::abs(gRange.getStart()) > EPSILON || std::abs(gRange.getEnd()) > EPSILON;
-        }
-        if (haveB) {
-            auto bRange = juce::FloatVectorOperations::findMinAndMax(sourceArray[4], numSamples);
-            hasBSignal = std::abs(bRange.getStart()) > EPSILON || std::abs(bRange.getEnd()) > EPSILON;
-        }
+            if (haveG) {
+                auto gRange = juce::FloatVectorOperations::findMinAndMax(sourceArray[3], numSamples);
+                hasGSignal = std::abs(gRange.getStart()) > EPSILON || std::abs(gRange.getEnd()) > EPSILON;
+            }
+            if (haveB) {
+                auto bRange = juce::FloatVectorOperations::findMinAndMax(sourceArray[4], numSamples);
+                hasBSignal = std::abs(bRange.getStart()) > EPSILON || std::abs(bRange.getEnd()) > EPSILON;
+            }
         
-        if (hasGSignal || hasBSignal) {
-            rgbEnabled = true;
+            if (hasGSignal || hasBSignal) {
+                rgbEnabled = true;
+            }
         }
-    }
     
-    // Populate remaining channels based on detected mode
-    if (rgbEnabled && !forceDisableRgbInput) {
-        // RGB mode: z = 1.0; r = ch2 (or 1.0 if unavailable); g = ch3 (or 0.0); b = ch4 (or 0.0)
-        juce::FloatVectorOperations::fill(workArray[2], 1.0f, numSamples);
+        // Populate remaining channels based on detected mode
+        if (rgbEnabled && !forceDisableRgbInput) {
+            // RGB mode: z = 1.0; r = ch2 (or 1.0 if unavailable); g = ch3 (or 0.0); b = ch4 (or 0.0)
+            juce::FloatVectorOperations::fill(workArray[2], 1.0f, numSamples);
         
-        if (sourceBuffer.getNumChannels() > 2) {
-            juce::FloatVectorOperations::copy(workArray[3], sourceArray[2], numSamples);
-        } else {
-            juce::FloatVectorOperations::fill(workArray[3], 1.0f, numSamples);
-        }
+            if (sourceBuffer.getNumChannels() > 2) {
+                juce::FloatVectorOperations::copy(workArray[3], sourceArray[2], numSamples);
+            } else {
+                juce::FloatVectorOperations::fill(workArray[3], 1.0f, numSamples);
+            }
         
-        if (haveG) {
-            juce::FloatVectorOperations::copy(workArray[4], sourceArray[3], numSamples);
-        } else {
-            juce::FloatVectorOperations::clear(workArray[4], numSamples);
-        }
+            if (haveG) {
+                juce::FloatVectorOperations::copy(workArray[4], sourceArray[3], numSamples);
+            } else {
+                juce::FloatVectorOperations::clear(workArray[4], numSamples);
+            }
         
-        if (haveB) {
-            juce::FloatVectorOperations::copy(workArray[5], sourceArray[4], numSamples);
+            if (haveB) {
+                juce::FloatVectorOperations::copy(workArray[5], sourceArray[4], numSamples);
+            } else {
+                juce::FloatVectorOperations::clear(workArray[5], numSamples);
+            }
         } else {
+            // Brightness mode: z=ch2 or 1.0, r=1.0, g=0, b=0
+            if (brightnessEnabled && sourceBuffer.getNumChannels() > 2) {
+                juce::FloatVectorOperations::copy(workArray[2], sourceArray[2], numSamples);
+            } else {
+                juce::FloatVectorOperations::fill(workArray[2], 1.0f, numSamples);
+            }
+        
+            juce::FloatVectorOperations::fill(workArray[3], 1.0f, numSamples);
+            juce::FloatVectorOperations::clear(workArray[4], numSamples);
             juce::FloatVectorOperations::clear(workArray[5], numSamples);
         }
-    } else {
-        // Brightness mode: z=ch2 or 1.0, r=1.0, g=0, b=0
-        if (brightnessEnabled && sourceBuffer.getNumChannels() > 2) {
-            juce::FloatVectorOperations::copy(workArray[2], sourceArray[2], numSamples);
-        } else {
-            juce::FloatVectorOperations::fill(workArray[2], 1.0f, numSamples);
-        }
-        
-        juce::FloatVectorOperations::fill(workArray[3], 1.0f, numSamples);
-        juce::FloatVectorOperations::clear(workArray[4], numSamples);
-        juce::FloatVectorOperations::clear(workArray[5], numSamples);
+    
     }
     
     // Clamp brightness channel
@@ -0,0 +1,120 @@
+#include "AffineChain.h"
+#include <numbers>
+
+namespace {
+    enum class AffineKind { None, Scale, Rotate, Translate, Skew };
+
+    AffineKind kindOf(const juce::String& effectId) {
+        if (effectId == "scaleX") return AffineKind::Scale;
+        if (effectId == "rotateX") return AffineKind::Rotate;
+        if (effectId == "translateX") return AffineKind::Translate;
+        if (effectId == "skewX") return AffineKind::Skew;
+        return AffineKind::None;
+    }
+
+    // Same maths as the effects' apply(), one point at a time
+    osci::Point transformPoint(AffineKind kind, const osci::Point& p, const float (&v)[3]) {
+        switch (kind) {
+            case AffineKind::Scale:
+                return osci::Point(p.x * v[0], p.y * v[1], p.z * v[2]);
+            case AffineKind::Rotate: {
+                osci::Point rotated = p;
+                rotated.rotate(v[0] * std::numbers::pi, v[1] * std::numbers::pi, v[2] * std::numbers::pi);
+                return rotated;
+            }
+            case AffineKind::Translate:
+                return osci::Point(p.x + v[0], p.y + v[1], p.z + v[2]);
+            case AffineKind::Skew: {
+                osci::Point out = p;
+                out.x += v[0] * p.y;
+                out.y += v[1] * p.z;
+                out.z += v[2] * p.x;
+                return out;
+            }
+            case AffineKind::None:
+                break;
+        }
+        return p;
+    }
+
+    constexpr int kChunkSize = 64;
+}
+
+bool AffineChain::isAffine(const juce::String& effectId) {
+    return kindOf(effectId) != AffineKind::None;
+}
+
+bool AffineChain::composeInto(Composition& composition, osci::Effect& effect, int numSamples) {
+    const auto kind = kindOf(effect.getId());
+    if (kind == AffineKind::None || effect.parameters.size() < 3 || numSamples <= 0) {
+        return false;
+    }
+
+    float values[3];
+    for (int p = 0; p < 3; ++p) {
+        const float* animated = effect.getAnimatedValuesReadPointer(p, numSamples);
+        if (animated == nullptr) {
+            return false;
+        }
+        auto range = juce::FloatVectorOperations::findMinAndMax(animated, numSamples);
+        if (range.getStart() != range.getEnd()) {
+            return false;
+        }
+        values[p] = animated[0];
+    }
+
+    for (auto* point : { &composition.origin, &composition.xAxis, &composition.yAxis, &composition.zAxis }) {
+        *point = transformPoint(kind, *point, values);
+    }
+    // If it ends up fused it won't run per sample, so publish the values it
+    // would have shown.
+    effect.publishAnimatedToActual(numSamples);
+    return true;
+}
+
+void AffineChain::finishRun(size_t start, size_t end, int numInRun, const Composition& composition) {
+    if (numInRun < 2) {
+        return;
+    }
+    auto& run = runs[start];
+    run.end = end;
+    run.numFused = numInRun;
+
+    const auto& o = composition.origin;
+    const osci::Point* axes[] = { &composition.xAxis, &composition.yAxis, &composition.zAxis };
+    const double origin[] = { o.x, o.y, o.z };
+    for (int col = 0; col < 3; ++col) {
+        const double axis[] = { axes[col]->x, axes[col]->y, axes[col]->z };
+        for (int row = 0; row < 3; ++row) {
+            run.transform.m[row][col] = (float) (axis[row] - origin[row]);
+        }
+    }
+    for (int row = 0; row < 3; ++row) {
+        run.transform.m[row][3] = (float) origin[row];
+    }
+}
+
+void AffineChain::Transform::apply(juce::AudioBuffer<float>& buffer) const {
+    const int numChannels = juce::jmin(3, buffer.getNumChannels());
+    const int numSamples = buffer.getNumSamples();
+    float* channels[3] = {};
+    for (int ch = 0; ch < numChannels; ++ch) {
+        channels[ch] = buffer.getWritePointer(ch);
+    }
+
+    // Every output row reads all three inputs, so build each chunk aside
+    // before writing it back.
+    float out[3][kChunkSize];
+    for (int start = 0; start < numSamples; start += kChunkSize) {
+        const int n = juce::jmin(kChunkSize, numSamples - start);
+        for (int row = 0; row < numChannels; ++row) {
+            juce::FloatVectorOperations::fill(out[row], m[row][3], n);
+            for (int col = 0; col < numChannels; ++col) {
+                juce::FloatVectorOperations::addWithMultiply(out[row], channels[col] + start, m[row][col], n);
+            }
+        }
+        for (int row = 0; row < numChannels; ++row) {
+            juce::FloatVectorOperations::copy(channels[row] + start, out[row], n);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Runs of adjacent affine effects (scale, rotate, translate and skew),
+// composed into one transform per block.
+//
+// Each of these effects runs per sample through its own virtual apply(), but
+// while its parameters hold still for a block its output is a fixed affine
+// function of its input. A run of them collapses to a single matrix that is
+// applied to the whole block with vector operations. An effect whose
+// parameters move within the block, or that isn't affine, ends the run and
+// is processed as before.
+class AffineChain {
+public:
+    // A 4x4 transform whose last row is always (0, 0, 0, 1), so only the top
+    // three rows are stored.
+    struct Transform {
+        float m[3][4] = {
+            { 1.0f, 0.0f, 0.0f, 0.0f },
+            { 0.0f, 1.0f, 0.0f, 0.0f },
+            { 0.0f, 0.0f, 1.0f, 0.0f },
+        };
+
+        // Transforms channels 0-2 (x, y, z) of the buffer in place. A missing
+        // channel reads as zero.
+        void apply(juce::AudioBuffer<float>& buffer) const;
+    };
+
+    struct Run {
+        // One past the last effect in the run. Inactive effects in between are
+        // skipped along with it.
+        size_t end = 0;
+        int numFused = 0;
+        Transform transform;
+    };
+
+    // Whether the effect with this id is an affine function of its input.
+    static bool isAffine(const juce::String& effectId);
+
+    // Finds this block's runs among `effects`, in the order they are applied.
+    // `isActive` says whether an effect runs at all: inactive ones neither
+    // join nor break a run. Only runs of two or more effects are fused.
+    //
+    // Reads the effects' animated values, so call it once they are final for
+    // the block. Doesn't allocate unless `effects` has grown.
+    template <typename IsActive>
+    void prepareBlock(const std::vector<std::shared_ptr<osci::Effect>>& effects, int numSamples, IsActive&& isActive) {
+        if (runs.size() < effects.size()) {
+            runs.resize(effects.size());
+        }
+        for (auto& run : runs) {
+            run.numFused = 0;
+        }
+
+        Composition composition;
+        size_t start = 0;
+        int numInRun = 0;
+        for (size_t e = 0; e < effects.size(); e++) {
+            if (!isActive(*effects[e])) {
+                continue;
+            }
+            if (numInRun == 0) {
+                composition = Composition();
+                start = e;
+            }
+            if (composeInto(composition, *effects[e], numSamples)) {
+                numInRun++;
+            } else {
+                finishRun(start, e, numInRun, composition);
+                numInRun = 0;
+            }
+        }
+        finishRun(start, effects.size(), numInRun, composition);
+    }
+
+    // The fused run starting at `index`, or nullptr if none starts there.
+    const Run* runAt(size_t index) const {
+        return index < runs.size() && runs[index].numFused > 0 ? &runs[index] : nullptr;
+    }
+
+private:
+    // Where the effects so far take the origin and the ends of the unit axes.
+    struct Composition {
+        osci::Point origin{ 0, 0, 0 };
+        osci::Point xAxis{ 1, 0, 0 };
+        osci::Point yAxis{ 0, 1, 0 };
+        osci::Point zAxis{ 0, 0, 1 };
+    };
+
+    // Appends `effect` to the composition if it is affine and its parameters
+    // hold still for the block. Leaves the composition alone otherwise.
+    static bool composeInto(Composition& composition, osci::Effect& effect, int numSamples);
+
+    // Records the run if it is long enough to be worth fusing.
+    void finishRun(size_t start, size_t end, int numInRun, const Composition& composition);
+
+    // Indexed by the effect each run starts at.
+    std::vector<Run> runs;
+};
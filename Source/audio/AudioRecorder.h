@@ -1,7 +1,17 @@
 #pragma once
 #include <JuceHeader.h>
+#include "ChannelLayout.h"
+
+enum class AudioRecordingFormat {
+    Wav,
+    Aiff,
+    Flac,
+};
 
 //==============================================================================
+// Records the visualiser's XYZRGB channels, or a subset of them, to disk on
+// a background thread. WAV recordings embed a ChannelLayout so sosci can map
+// the channels back when the file is opened.
 class AudioRecorder final {
 public:
     AudioRecorder() {
@@ -17,6 +27,33 @@ public:
         this->sampleRate = sampleRate;
     }
 
+    // Takes effect from the next startRecording(). Bit depths a format can't
+    // store are lowered to the nearest one it can.
+    void setFormat(AudioRecordingFormat format, int bitDepth, int channelMask) {
+        this->format = format;
+        this->bitDepth = bitDepth;
+        this->channelMask = channelMask & ChannelLayout::kMaskAll;
+        if (this->channelMask == 0) {
+            this->channelMask = ChannelLayout::kMaskXY;
+        }
+    }
+
+    static juce::String getFileExtension(AudioRecordingFormat format) {
+        switch (format) {
+            case AudioRecordingFormat::Aiff:
+                return "aiff";
+            case AudioRecordingFormat::Flac:
+                return "flac";
+            case AudioRecordingFormat::Wav:
+            default:
+                return "wav";
+        }
+    }
+
+    juce::String getFileExtension() const {
+        return getFileExtension(format);
+    }
+
     //==============================================================================
     void startRecording(const juce::File& file) {
         stop();
@@ -26,10 +63,10 @@ public:
             file.deleteFile();
 
             if (auto fileStream = std::unique_ptr<juce::FileOutputStream>(file.createOutputStream())) {
-                // Now create a WAV writer object that writes to our output stream...
-                juce::WavAudioFormat wavFormat;
+                layout = ChannelLayout::fromMask(channelMask);
 
-                if (auto writer = wavFormat.createWriterFor(fileStream.get(), sampleRate, 2, 32, {}, 0)) {
+                // Now create a writer object that writes to our output stream...
+                if (auto writer = createWriter(fileStream.get())) {
                     fileStream.release(); // (passes responsibility for deleting the stream to the writer object that is now using it)
 
                     // Now we'll create one of these helper objects which will act as a FIFO buffer, and will
@@ -85,7 +122,19 @@ public:
         int numSamples = buffer.getNumSamples();
 
         if (activeWriter.load() != nullptr) {
-            activeWriter.load()->write(buffer.getArrayOfReadPointers(), numSamples);
+            // Channels the buffer doesn't have are recorded as silence, in
+            // chunks no longer than the silent buffer.
+            const float* channels[ChannelLayout::NumRoles];
+            for (int start = 0; start < numSamples; start += (int) silence.size()) {
+                const int chunk = juce::jmin(numSamples - start, (int) silence.size());
+                for (int role = 0; role < ChannelLayout::NumRoles; role++) {
+                    const int channel = layout.getChannel((ChannelLayout::Role) role);
+                    if (channel >= 0) {
+                        channels[channel] = role < buffer.getNumChannels() ? buffer.getReadPointer(role, start) : silence.data();
+                    }
+                }
+                activeWriter.load()->write(channels, chunk);
+            }
             nextSampleNum += numSamples;
         }
     }
@@ -97,6 +146,36 @@ public:
     std::function<void()> stopCallback;
 
 private:
+    juce::AudioFormatWriter* createWriter(juce::OutputStream* stream) {
+        std::unique_ptr<juce::AudioFormat> audioFormat;
+        switch (format) {
+            case AudioRecordingFormat::Aiff:
+                audioFormat = std::make_unique<juce::AiffAudioFormat>();
+                break;
+            case AudioRecordingFormat::Flac:
+                audioFormat = std::make_unique<juce::FlacAudioFormat>();
+                break;
+            case AudioRecordingFormat::Wav:
+            default:
+                audioFormat = std::make_unique<juce::WavAudioFormat>();
+                break;
+        }
+
+        int bits = 0;
+        for (int possible : audioFormat->getPossibleBitDepths()) {
+            if (possible <= bitDepth || bits == 0) {
+                bits = juce::jmax(bits, possible);
+            }
+        }
+
+        if (format == AudioRecordingFormat::Wav) {
+            // Discrete channels, otherwise six channels are tagged as 5.1.
+            return audioFormat->createWriterFor(stream, sampleRate, juce::AudioChannelSet::discreteChannels(layout.getNumChannels()),
+                                                bits, layout.createWavMetadata(), 0);
+        }
+        return audioFormat->createWriterFor(stream, sampleRate, (unsigned int) layout.getNumChannels(), bits, {}, 0);
+    }
+
     juce::TimeSliceThread backgroundThread { "Audio Recorder Thread" }; // the thread that will write our audio data to disk
     std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> threadedWriter; // the FIFO used to buffer the incoming data
     juce::int64 nextSampleNum = 0;
@@ -104,6 +183,12 @@ private:
     double recordingLength = 99999999999.0;
     double sampleRate = -1;
 
+    AudioRecordingFormat format = AudioRecordingFormat::Wav;
+    int bitDepth = 32;
+    int channelMask = ChannelLayout::kMaskXY;
+    ChannelLayout layout = ChannelLayout::fromMask(ChannelLayout::kMaskXY);
+    std::vector<float> silence = std::vector<float>(4096, 0.0f);
+
     juce::CriticalSection writerLock;
     std::atomic<juce::AudioFormatWriter::ThreadedWriter*> activeWriter { nullptr };
 };
@@ -0,0 +1,309 @@
+#include "AudioThreadProfiler.h"
+
+#if OSCI_AUDIO_PROFILER
+
+AudioThreadProfiler::AudioThreadProfiler()
+    : nsPerTick(1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond()) {
+    for (int i = 0; i < NumStages; i++) {
+        names[i] = getStageName((Stage) i);
+    }
+    numSlots.store(NumStages);
+    std::fill(std::begin(blockParent), std::end(blockParent), -1);
+}
+
+const char* AudioThreadProfiler::getStageName(Stage stage) {
+    switch (stage) {
+        case Block:              return "Block";
+        case Modulation:         return "Modulation";
+        case Synth:              return "Synth";
+        case VoiceSamples:       return "Voice samples";
+        case VoiceShapes:        return "Voice shapes";
+        case VoiceEffects:       return "Voice effects";
+        case InputEffects:       return "Input effects";
+        case Animation:          return "Animation";
+        case PermanentEffects:   return "Permanent effects";
+        case LuaEffects:         return "Lua effects";
+        case Output:             return "Output";
+        case ThreadManagerWrite: return "Thread manager write";
+        case AudioCallback:      return "Audio callback";
+        case NumStages:          break;
+    }
+    return "";
+}
+
+int AudioThreadProfiler::getSlot(const juce::String& name) {
+    juce::ScopedLock sl(namesLock);
+    const int count = numSlots.load();
+    for (int i = 0; i < count; i++) {
+        if (names[i] == name) {
+            return i;
+        }
+    }
+    if (count >= kMaxSlots) {
+        return -1;
+    }
+    names[count] = name;
+    numSlots.store(count + 1);
+    return count;
+}
+
+int AudioThreadProfiler::getBucket(juce::int64 ns) noexcept {
+    if (ns < ((juce::int64) 1 << kMinOctave)) {
+        return 0;
+    }
+    if (ns >= ((juce::int64) 1 << (kMinOctave + kNumOctaves))) {
+        return kNumBuckets - 1;
+    }
+    const int octave = juce::findHighestSetBit((juce::uint32) ns);
+    // The two bits below the top one pick the quarter of the octave.
+    const int quarter = (int) ((ns >> (octave - 2)) & 3);
+    return 1 + (octave - kMinOctave) * kBucketsPerOctave + quarter;
+}
+
+double AudioThreadProfiler::getBucketUpperUs(int bucket) {
+    if (bucket <= 0) {
+        return std::ldexp(1.0, kMinOctave) / 1000.0;
+    }
+    if (bucket >= kNumBuckets - 1) {
+        return std::numeric_limits<double>::infinity();
+    }
+    const int octave = kMinOctave + (bucket - 1) / kBucketsPerOctave;
+    const int quarter = (bucket - 1) % kBucketsPerOctave;
+    return std::ldexp(1.0 + (quarter + 1) / 4.0, octave) / 1000.0;
+}
+
+void AudioThreadProfiler::beginBlock(int numSamples, double sampleRate) noexcept {
+    if (resetRequested.exchange(false, std::memory_order_relaxed)) {
+        clear();
+    }
+
+    blockActive = enabled.load(std::memory_order_relaxed);
+    if (!blockActive) {
+        return;
+    }
+
+    currentScope = Block;
+    numTouched = 0;
+    deadlineNs = sampleRate > 0.0 ? (juce::int64) (1.0e9 * numSamples / sampleRate) : 0;
+    blockStart = now();
+}
+
+void AudioThreadProfiler::add(int slot, int parent, juce::int64 ticks) noexcept {
+    if (blockNs[slot] == 0) {
+        touched[numTouched++] = slot;
+        blockParent[slot] = parent;
+    }
+    // Keep touched slots non-zero so they aren't added to the list twice.
+    blockNs[slot] += juce::jmax((juce::int64) 1, (juce::int64) (ticks * nsPerTick));
+}
+
+void AudioThreadProfiler::endBlock() noexcept {
+    if (!blockActive) {
+        return;
+    }
+    blockActive = false;
+
+    const auto total = juce::jmax((juce::int64) 1, (juce::int64) ((now() - blockStart) * nsPerTick));
+    if (blockNs[Block] == 0) {
+        touched[numTouched++] = Block;
+    }
+    blockNs[Block] = total;
+    blockParent[Block] = -1;
+
+    for (int i = 0; i < numTouched; i++) {
+        const int slot = touched[i];
+        const auto ns = (juce::uint64) blockNs[slot];
+        auto& s = stats[slot];
+        const int bucket = getBucket((juce::int64) ns);
+        s.buckets[bucket].store(s.buckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        increment(s.blocks, 1);
+        increment(s.totalNs, ns);
+        if (ns > s.maxNs.load(std::memory_order_relaxed)) {
+            s.maxNs.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    const auto blockIndex = blocks.load(std::memory_order_relaxed);
+    increment(blocks, 1);
+    lastDeadlineNs.store((juce::uint64) deadlineNs, std::memory_order_relaxed);
+
+    if (deadlineNs > 0 && total > deadlineNs) {
+        // Walk down from the whole block into the longest child scope for as
+        // long as the children account for most of their parent's time.
+        int blamed = Block;
+        while (true) {
+            int longest = -1;
+            juce::int64 childTotal = 0;
+            for (int i = 0; i < numTouched; i++) {
+                const int slot = touched[i];
+                if (slot == blamed || blockParent[slot] != blamed) {
+                    continue;
+                }
+                childTotal += blockNs[slot];
+                if (longest < 0 || blockNs[slot] > blockNs[longest]) {
+                    longest = slot;
+                }
+            }
+            if (longest < 0 || childTotal * 2 < blockNs[blamed]) {
+                break;
+            }
+            blamed = longest;
+        }
+
+        for (int i = 0; i < numTouched; i++) {
+            increment(stats[touched[i]].overrunNs, (juce::uint64) blockNs[touched[i]]);
+        }
+        increment(stats[blamed].overrunsBlamed, 1);
+
+        const auto overrunIndex = overruns.load(std::memory_order_relaxed);
+        auto& record = recentOverruns[overrunIndex % kMaxRecentOverruns];
+        record.block.store(blockIndex, std::memory_order_relaxed);
+        record.blockNs.store((juce::uint64) total, std::memory_order_relaxed);
+        record.deadlineNs.store((juce::uint64) deadlineNs, std::memory_order_relaxed);
+        record.blamed.store(blamed, std::memory_order_relaxed);
+        record.blamedNs.store((juce::uint64) blockNs[blamed], std::memory_order_relaxed);
+        overruns.store(overrunIndex + 1, std::memory_order_release);
+    }
+
+    for (int i = 0; i < numTouched; i++) {
+        blockNs[touched[i]] = 0;
+        blockParent[touched[i]] = -1;
+    }
+    numTouched = 0;
+    currentScope = -1;
+}
+
+void AudioThreadProfiler::clear() noexcept {
+    for (auto& s : stats) {
+        for (auto& bucket : s.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        s.blocks.store(0, std::memory_order_relaxed);
+        s.totalNs.store(0, std::memory_order_relaxed);
+        s.maxNs.store(0, std::memory_order_relaxed);
+        s.overrunsBlamed.store(0, std::memory_order_relaxed);
+        s.overrunNs.store(0, std::memory_order_relaxed);
+    }
+    blocks.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+}
+
+AudioThreadProfiler::Report AudioThreadProfiler::getReport() const {
+    Report report;
+    report.blocks = blocks.load(std::memory_order_relaxed);
+    report.overruns = overruns.load(std::memory_order_acquire);
+    report.lastDeadlineUs = lastDeadlineNs.load(std::memory_order_relaxed) / 1000.0;
+
+    juce::StringArray slotNames;
+    {
+        juce::ScopedLock sl(namesLock);
+        for (int i = 0; i < numSlots.load(); i++) {
+            slotNames.add(names[i]);
+        }
+    }
+
+    for (int i = 0; i < slotNames.size(); i++) {
+        auto& s = stats[i];
+        SlotReport slot;
+        slot.blocks = s.blocks.load(std::memory_order_relaxed);
+        if (slot.blocks == 0) {
+            continue;
+        }
+        slot.name = slotNames[i];
+        slot.slot = i;
+        slot.meanUs = s.totalNs.load(std::memory_order_relaxed) / 1000.0 / (double) slot.blocks;
+        slot.maxUs = s.maxNs.load(std::memory_order_relaxed) / 1000.0;
+        slot.overrunsBlamed = s.overrunsBlamed.load(std::memory_order_relaxed);
+        slot.overrunUs = s.overrunNs.load(std::memory_order_relaxed) / 1000.0;
+
+        juce::uint64 counted = 0;
+        for (int b = 0; b < kNumBuckets; b++) {
+            slot.histogram[b] = s.buckets[b].load(std::memory_order_relaxed);
+            counted += slot.histogram[b];
+        }
+
+        // Percentiles are the upper edge of the bucket they fall in, capped
+        // at the largest time actually seen.
+        auto percentile = [&](double fraction) {
+            const auto target = (juce::uint64) std::ceil(fraction * (double) counted);
+            juce::uint64 seen = 0;
+            for (int b = 0; b < kNumBuckets; b++) {
+                seen += slot.histogram[b];
+                if (seen >= target && seen > 0) {
+                    return juce::jmin(getBucketUpperUs(b), slot.maxUs);
+                }
+            }
+            return slot.maxUs;
+        };
+        slot.p50Us = percentile(0.5);
+        slot.p99Us = percentile(0.99);
+
+        report.slots.push_back(slot);
+    }
+
+    const auto numRecent = (int) juce::jmin<juce::uint64>(report.overruns, kMaxRecentOverruns);
+    for (int i = 0; i < numRecent; i++) {
+        auto& record = recentOverruns[(report.overruns - 1 - i) % kMaxRecentOverruns];
+        OverrunReport overrun;
+        overrun.block = record.block.load(std::memory_order_relaxed);
+        overrun.blockUs = record.blockNs.load(std::memory_order_relaxed) / 1000.0;
+        overrun.deadlineUs = record.deadlineNs.load(std::memory_order_relaxed) / 1000.0;
+        const int blamed = record.blamed.load(std::memory_order_relaxed);
+        overrun.blamed = juce::isPositiveAndBelow(blamed, slotNames.size()) ? slotNames[blamed] : juce::String();
+        overrun.blamedUs = record.blamedNs.load(std::memory_order_relaxed) / 1000.0;
+        report.recentOverruns.push_back(overrun);
+    }
+
+    return report;
+}
+
+juce::var AudioThreadProfiler::toJson() const {
+    const auto report = getReport();
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("blocks", (juce::int64) report.blocks);
+    root->setProperty("overruns", (juce::int64) report.overruns);
+    root->setProperty("deadlineUs", report.lastDeadlineUs);
+
+    juce::Array<juce::var> bucketEdges;
+    for (int b = 0; b < kNumBuckets - 1; b++) {
+        bucketEdges.add(getBucketUpperUs(b));
+    }
+    root->setProperty("bucketUpperUs", bucketEdges);
+
+    juce::Array<juce::var> slots;
+    for (auto& slot : report.slots) {
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("name", slot.name);
+        obj->setProperty("blocks", (juce::int64) slot.blocks);
+        obj->setProperty("meanUs", slot.meanUs);
+        obj->setProperty("p50Us", slot.p50Us);
+        obj->setProperty("p99Us", slot.p99Us);
+        obj->setProperty("maxUs", slot.maxUs);
+        obj->setProperty("overrunsBlamed", (juce::int64) slot.overrunsBlamed);
+        obj->setProperty("overrunUs", slot.overrunUs);
+        juce::Array<juce::var> histogram;
+        for (auto count : slot.histogram) {
+            histogram.add((juce::int64) count);
+        }
+        obj->setProperty("histogram", histogram);
+        slots.add(juce::var(obj));
+    }
+    root->setProperty("stages", slots);
+
+    juce::Array<juce::var> recent;
+    for (auto& overrun : report.recentOverruns) {
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("block", (juce::int64) overrun.block);
+        obj->setProperty("blockUs", overrun.blockUs);
+        obj->setProperty("deadlineUs", overrun.deadlineUs);
+        obj->setProperty("blamed", overrun.blamed);
+        obj->setProperty("blamedUs", overrun.blamedUs);
+        recent.add(juce::var(obj));
+    }
+    root->setProperty("recentOverruns", recent);
+
+    return juce::var(root);
+}
+
+#endif
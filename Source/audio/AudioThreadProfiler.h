@@ -0,0 +1,224 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+    Built-in profiler for the audio thread.
+
+    Each stage of a block (and each effect) is timed with a Scope. Times are
+    summed per block and, at the end of the block, added to a lock-free
+    histogram for that stage. Blocks that take longer than their buffer
+    duration are counted as overruns and blamed on a stage by drilling down
+    from the whole block into whichever nested stage took longest.
+
+    Only the audio thread writes the statistics, using relaxed atomics, so
+    timing a stage is two clock reads and a few adds. Reports are read from
+    any thread with getReport() or toJson().
+
+    Set OSCI_AUDIO_PROFILER=0 to compile it out. The OSCI_PROFILE_* macros
+    then expand to nothing.
+*/
+
+#ifndef OSCI_AUDIO_PROFILER
+#define OSCI_AUDIO_PROFILER 1
+#endif
+
+#if OSCI_AUDIO_PROFILER
+
+class AudioThreadProfiler {
+public:
+    // Fixed stages of renderBlock(). Effects and other named timers get
+    // slots after these from getSlot().
+    enum Stage {
+        Block = 0,
+        Modulation,
+        Synth,
+        VoiceSamples,
+        VoiceShapes,
+        VoiceEffects,
+        InputEffects,
+        Animation,
+        PermanentEffects,
+        LuaEffects,
+        Output,
+        ThreadManagerWrite,
+        AudioCallback,
+        NumStages
+    };
+
+    static constexpr int kMaxSlots = 128;
+    // Four buckets per octave from 64 ns to about 67 ms, plus one below and
+    // one above.
+    static constexpr int kBucketsPerOctave = 4;
+    static constexpr int kMinOctave = 6;
+    static constexpr int kNumOctaves = 20;
+    static constexpr int kNumBuckets = kNumOctaves * kBucketsPerOctave + 2;
+    static constexpr int kMaxRecentOverruns = 16;
+
+    AudioThreadProfiler();
+
+    static const char* getStageName(Stage stage);
+
+    // Returns the slot for a named timer, adding it the first time. Returns
+    // -1 if every slot is taken. Not for the audio thread.
+    int getSlot(const juce::String& name);
+
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Clears all statistics. Takes effect at the start of the next block.
+    void reset() { resetRequested.store(true, std::memory_order_relaxed); }
+
+    // Audio thread. Brackets one processBlock; the deadline is the block's
+    // duration.
+    void beginBlock(int numSamples, double sampleRate) noexcept;
+    void endBlock() noexcept;
+
+    // Times the enclosing code into a slot. Nested scopes record which scope
+    // they ran inside, which is what overrun attribution drills into.
+    class Scope {
+    public:
+        Scope(AudioThreadProfiler& profiler, int slot) noexcept : profiler(profiler), slot(slot) {
+            if (slot >= 0 && profiler.blockActive) {
+                parent = profiler.currentScope;
+                profiler.currentScope = slot;
+                start = now();
+            } else {
+                this->slot = -1;
+            }
+        }
+
+        ~Scope() {
+            stop();
+        }
+
+        // Ends the scope early, for timing part of a function without
+        // wrapping it in a block.
+        void stop() noexcept {
+            if (slot >= 0) {
+                profiler.add(slot, parent, now() - start);
+                profiler.currentScope = parent;
+                slot = -1;
+            }
+        }
+
+    private:
+        AudioThreadProfiler& profiler;
+        int slot;
+        int parent = -1;
+        juce::int64 start = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    struct SlotReport {
+        juce::String name;
+        int slot = -1;
+        juce::uint64 blocks = 0;
+        double meanUs = 0.0;
+        double p50Us = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+        // Overrun blocks this slot was blamed for, and the time it took in
+        // all overrun blocks.
+        juce::uint64 overrunsBlamed = 0;
+        double overrunUs = 0.0;
+        std::array<juce::uint32, kNumBuckets> histogram {};
+    };
+
+    struct OverrunReport {
+        juce::uint64 block = 0;
+        double blockUs = 0.0;
+        double deadlineUs = 0.0;
+        juce::String blamed;
+        double blamedUs = 0.0;
+    };
+
+    struct Report {
+        juce::uint64 blocks = 0;
+        juce::uint64 overruns = 0;
+        double lastDeadlineUs = 0.0;
+        // Slots that have recorded at least one block, in slot order.
+        std::vector<SlotReport> slots;
+        // Most recent first.
+        std::vector<OverrunReport> recentOverruns;
+    };
+
+    Report getReport() const;
+    juce::var toJson() const;
+    juce::String exportJson() const { return juce::JSON::toString(toJson()); }
+
+    // Upper edge of a histogram bucket, in microseconds.
+    static double getBucketUpperUs(int bucket);
+    static int getBucket(juce::int64 ns) noexcept;
+
+    static juce::int64 now() noexcept { return juce::Time::getHighResolutionTicks(); }
+
+private:
+    void add(int slot, int parent, juce::int64 ticks) noexcept;
+    void clear() noexcept;
+
+    struct SlotStats {
+        std::atomic<juce::uint32> buckets[kNumBuckets] {};
+        std::atomic<juce::uint64> blocks { 0 };
+        std::atomic<juce::uint64> totalNs { 0 };
+        std::atomic<juce::uint64> maxNs { 0 };
+        std::atomic<juce::uint64> overrunsBlamed { 0 };
+        std::atomic<juce::uint64> overrunNs { 0 };
+    };
+
+    struct OverrunRecord {
+        std::atomic<juce::uint64> block { 0 };
+        std::atomic<juce::uint64> blockNs { 0 };
+        std::atomic<juce::uint64> deadlineNs { 0 };
+        std::atomic<int> blamed { -1 };
+        std::atomic<juce::uint64> blamedNs { 0 };
+    };
+
+    static void increment(std::atomic<juce::uint64>& value, juce::uint64 amount) noexcept {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    const double nsPerTick;
+
+    std::atomic<bool> enabled { true };
+    std::atomic<bool> resetRequested { false };
+
+    juce::CriticalSection namesLock;
+    juce::String names[kMaxSlots];
+    std::atomic<int> numSlots { 0 };
+
+    SlotStats stats[kMaxSlots];
+    std::atomic<juce::uint64> blocks { 0 };
+    std::atomic<juce::uint64> overruns { 0 };
+    std::atomic<juce::uint64> lastDeadlineNs { 0 };
+    OverrunRecord recentOverruns[kMaxRecentOverruns];
+
+    // Audio-thread state for the block in progress.
+    bool blockActive = false;
+    int currentScope = -1;
+    juce::int64 blockStart = 0;
+    juce::int64 deadlineNs = 0;
+    juce::int64 blockNs[kMaxSlots] {};
+    int blockParent[kMaxSlots] {};
+    int touched[kMaxSlots] {};
+    int numTouched = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioThreadProfiler)
+};
+
+#define OSCI_PROFILE_SCOPE(profiler, slot) AudioThreadProfiler::Scope JUCE_JOIN_MACRO(profileScope_, __LINE__)((profiler), (slot))
+#define OSCI_PROFILE_SCOPE_NAMED(name, profiler, slot) AudioThreadProfiler::Scope name((profiler), (slot))
+#define OSCI_PROFILE_STOP(name) (name).stop()
+#define OSCI_PROFILE_BEGIN_BLOCK(profiler, numSamples, sampleRate) (profiler).beginBlock((numSamples), (sampleRate))
+#define OSCI_PROFILE_END_BLOCK(profiler) (profiler).endBlock()
+
+#else
+
+#define OSCI_PROFILE_SCOPE(profiler, slot)
+#define OSCI_PROFILE_SCOPE_NAMED(name, profiler, slot)
+#define OSCI_PROFILE_STOP(name)
+#define OSCI_PROFILE_BEGIN_BLOCK(profiler, numSamples, sampleRate)
+#define OSCI_PROFILE_END_BLOCK(profiler)
+
+#endif
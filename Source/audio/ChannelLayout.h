@@ -0,0 +1,138 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Describes which of the visualiser's X, Y, Z, R, G, B channels each channel
+// of an audio file carries, so a recording of any subset of them can be
+// mapped back when it is loaded.
+//
+// WAV files store it as a standard iXML chunk with one named TRACK per
+// channel, which other tools (and DAWs) also show as channel names.
+class ChannelLayout {
+public:
+    enum Role {
+        X = 0,
+        Y,
+        Z,
+        R,
+        G,
+        B,
+        NumRoles
+    };
+
+    // Bit i of a mask selects role i.
+    static constexpr int kMaskXY = (1 << X) | (1 << Y);
+    static constexpr int kMaskXYZ = kMaskXY | (1 << Z);
+    static constexpr int kMaskXYRGB = kMaskXY | (1 << R) | (1 << G) | (1 << B);
+    static constexpr int kMaskAll = (1 << NumRoles) - 1;
+
+    ChannelLayout() {
+        channelForRole.fill(-1);
+    }
+
+    // Channels are laid out in role order, i.e. X, Y, Z, R, G, B with the
+    // unselected ones left out.
+    static ChannelLayout fromMask(int mask) {
+        ChannelLayout layout;
+        for (int role = 0; role < NumRoles; role++) {
+            if (mask & (1 << role)) {
+                layout.channelForRole[role] = layout.numChannels++;
+            }
+        }
+        return layout;
+    }
+
+    static const char* getRoleName(Role role) {
+        switch (role) {
+            case X: return "X";
+            case Y: return "Y";
+            case Z: return "Z";
+            case R: return "R";
+            case G: return "G";
+            case B: return "B";
+            case NumRoles: break;
+        }
+        return "";
+    }
+
+    // The file channel carrying a role, or -1 if the file doesn't have it.
+    int getChannel(Role role) const {
+        return channelForRole[role];
+    }
+
+    int getNumChannels() const {
+        return numChannels;
+    }
+
+    bool isEmpty() const {
+        return numChannels == 0;
+    }
+
+    juce::String toIXml() const {
+        juce::XmlElement root("BWFXML");
+        root.createNewChildElement("IXML_VERSION")->addTextElement("1.5");
+        auto* trackList = root.createNewChildElement("TRACK_LIST");
+        trackList->createNewChildElement("TRACK_COUNT")->addTextElement(juce::String(numChannels));
+        for (int channel = 0; channel < numChannels; channel++) {
+            auto* track = trackList->createNewChildElement("TRACK");
+            track->createNewChildElement("CHANNEL_INDEX")->addTextElement(juce::String(channel + 1));
+            track->createNewChildElement("INTERLEAVE_INDEX")->addTextElement(juce::String(channel + 1));
+            track->createNewChildElement("NAME")->addTextElement(getRoleName(getRole(channel)));
+        }
+        return root.toString(juce::XmlElement::TextFormat().withoutHeader().singleLine());
+    }
+
+    // Returns an empty layout unless every track is named after a role and
+    // no role appears twice.
+    static ChannelLayout fromIXml(const juce::String& ixml) {
+        ChannelLayout layout;
+        auto root = juce::parseXML(ixml);
+        if (root == nullptr || !root->hasTagName("BWFXML")) {
+            return layout;
+        }
+        auto* trackList = root->getChildByName("TRACK_LIST");
+        if (trackList == nullptr) {
+            return layout;
+        }
+
+        for (auto* track : trackList->getChildWithTagNameIterator("TRACK")) {
+            const int channel = track->getChildElementAllSubText("INTERLEAVE_INDEX", {}).getIntValue() - 1;
+            const auto name = track->getChildElementAllSubText("NAME", {}).trim();
+            int role = 0;
+            while (role < NumRoles && !name.equalsIgnoreCase(getRoleName((Role) role))) {
+                role++;
+            }
+            if (role == NumRoles || channel < 0 || layout.channelForRole[role] >= 0) {
+                return {};
+            }
+            layout.channelForRole[role] = channel;
+            layout.numChannels = juce::jmax(layout.numChannels, channel + 1);
+        }
+        return layout;
+    }
+
+    // Metadata to pass to a WAV writer so the layout is embedded in the file.
+    juce::StringPairArray createWavMetadata() const {
+        juce::StringPairArray metadata;
+        metadata.set(juce::WavAudioFormat::ixmlChunk, toIXml());
+        return metadata;
+    }
+
+    static ChannelLayout fromMetadata(const juce::StringPairArray& metadata) {
+        const auto ixml = metadata.getValue(juce::WavAudioFormat::ixmlChunk, {});
+        return ixml.isEmpty() ? ChannelLayout() : fromIXml(ixml);
+    }
+
+private:
+    Role getRole(int channel) const {
+        for (int role = 0; role < NumRoles; role++) {
+            if (channelForRole[role] == channel) {
+                return (Role) role;
+            }
+        }
+        return NumRoles;
+    }
+
+    std::array<int, NumRoles> channelForRole;
+    int numChannels = 0;
+};
@@ -0,0 +1,202 @@
+#include "OfflineProjectRenderer.h"
+
+#include "../PluginProcessor.h"
+#include "ChannelLayout.h"
+
+juce::Optional<juce::AudioPlayHead::PositionInfo> OfflineProjectRenderer::FreeRunningPlayHead::getPosition() const {
+    PositionInfo info;
+    const double seconds = (double) samplePosition / sampleRate;
+    info.setIsPlaying(true);
+    info.setBpm(bpm);
+    info.setTimeInSamples(samplePosition);
+    info.setTimeInSeconds(seconds);
+    info.setPpqPosition(seconds * bpm / 60.0);
+    return info;
+}
+
+OfflineProjectRenderer::OfflineProjectRenderer(OscirenderAudioProcessor& p) : processor(p) {}
+
+bool OfflineProjectRenderer::buildTimeline(const Settings& settings, juce::MidiMessageSequence& sequence,
+                                           double& bpmOut, double& midiEndSeconds, juce::String& error) const {
+    bpmOut = settings.bpm;
+    midiEndSeconds = 0.0;
+
+    if (!settings.midiFile.existsAsFile()) {
+        sequence.addEvent(juce::MidiMessage::noteOn(1, settings.note, settings.velocity), 0.0);
+        if (settings.noteLengthSeconds > 0.0) {
+            sequence.addEvent(juce::MidiMessage::noteOff(1, settings.note), settings.noteLengthSeconds);
+        }
+        sequence.updateMatchedPairs();
+        return true;
+    }
+
+    juce::FileInputStream stream(settings.midiFile);
+    juce::MidiFile midiFile;
+    if (!stream.openedOk() || !midiFile.readFrom(stream)) {
+        error = "Could not read MIDI file " + settings.midiFile.getFileName() + ".";
+        return false;
+    }
+
+    midiFile.convertTimestampTicksToSeconds();
+
+    juce::MidiMessageSequence tempoEvents;
+    midiFile.findAllTempoEvents(tempoEvents);
+    if (tempoEvents.getNumEvents() > 0) {
+        const double secondsPerQuarter = tempoEvents.getEventPointer(0)->message.getTempoSecondsPerQuarterNote();
+        if (secondsPerQuarter > 0.0) {
+            bpmOut = 60.0 / secondsPerQuarter;
+        }
+    }
+
+    // Merge all tracks, keeping only events the synth understands.
+    for (int track = 0; track < midiFile.getNumTracks(); track++) {
+        for (auto* event : *midiFile.getTrack(track)) {
+            if (!event->message.isMetaEvent()) {
+                sequence.addEvent(event->message);
+            }
+        }
+    }
+    sequence.sort();
+    sequence.updateMatchedPairs();
+
+    midiEndSeconds = sequence.getEndTime();
+    return true;
+}
+
+OfflineProjectRenderer::Result OfflineProjectRenderer::render(const Settings& settings, const juce::File& outputFile,
+                                                              ProgressCallback onProgress, BlockCallback onBlock) {
+    Result result;
+
+    if (settings.sampleRate <= 0.0 || settings.blockSize <= 0) {
+        result.errorMessage = "Invalid sample rate or block size.";
+        return result;
+    }
+
+    juce::MidiMessageSequence sequence;
+    double bpm = settings.bpm;
+    double midiEndSeconds = 0.0;
+    if (!buildTimeline(settings, sequence, bpm, midiEndSeconds, result.errorMessage)) {
+        return result;
+    }
+
+    double lengthSeconds = settings.lengthSeconds;
+    if (lengthSeconds <= 0.0) {
+        lengthSeconds = midiEndSeconds + juce::jmax(0.0, settings.tailSeconds);
+    }
+    const juce::int64 totalSamples = (juce::int64) std::llround(lengthSeconds * settings.sampleRate);
+    if (totalSamples <= 0) {
+        result.errorMessage = "Render length must be greater than zero.";
+        return result;
+    }
+
+    std::unique_ptr<juce::TemporaryFile> tempFile;
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    if (outputFile != juce::File()) {
+        tempFile = std::make_unique<juce::TemporaryFile>(outputFile);
+        auto fileStream = std::unique_ptr<juce::FileOutputStream>(tempFile->getFile().createOutputStream());
+        juce::WavAudioFormat wavFormat;
+        if (fileStream != nullptr) {
+            writer.reset(wavFormat.createWriterFor(fileStream.get(), settings.sampleRate, juce::AudioChannelSet::discreteChannels(kNumOutputChannels),
+                                                   settings.bitsPerSample, ChannelLayout::fromMask(ChannelLayout::kMaskAll).createWavMetadata(), 0));
+        }
+        if (writer == nullptr) {
+            result.errorMessage = "Could not create " + outputFile.getFullPathName() + ".";
+            return result;
+        }
+        fileStream.release(); // owned by the writer now
+    }
+
+    // Take over the processor: silence the device callback, switch to the render
+    // sample rate and make sure MIDI reaches the synth.
+    const double previousSampleRate = processor.getSampleRate();
+    const int previousBlockSize = processor.getBlockSize();
+    const bool previousOfflineRenderActive = processor.isOfflineRenderActive();
+    const bool previousNonRealtime = processor.isNonRealtime();
+    const bool previousMidiEnabled = processor.midiEnabled->getBoolValue();
+
+    processor.setOfflineRenderActive(true);
+    processor.setNonRealtime(true);
+    processor.midiEnabled->setBoolValue(true);
+    processor.prepareForOfflineRender(settings.sampleRate, settings.blockSize);
+
+    if (!processor.waitForVoices(5000)) {
+        juce::Logger::writeToLog("OfflineProjectRenderer: voices not ready after 5s, rendering with current polyphony");
+    }
+
+    FreeRunningPlayHead playHead;
+    playHead.sampleRate = settings.sampleRate;
+    playHead.bpm = bpm;
+
+    const int numChannels = juce::jmax(2, processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+    juce::AudioBuffer<float> buffer(numChannels, settings.blockSize);
+    juce::MidiBuffer midi;
+
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    int nextEvent = 0;
+
+    for (juce::int64 position = 0; position < totalSamples; position += settings.blockSize) {
+        const int numSamples = (int) juce::jmin((juce::int64) settings.blockSize, totalSamples - position);
+        buffer.setSize(numChannels, numSamples, false, false, true);
+        buffer.clear();
+        midi.clear();
+
+        while (nextEvent < sequence.getNumEvents()) {
+            const auto& message = sequence.getEventPointer(nextEvent)->message;
+            const juce::int64 eventSample = (juce::int64) std::llround(message.getTimeStamp() * settings.sampleRate);
+            if (eventSample >= position + numSamples) {
+                break;
+            }
+            midi.addEvent(message, (int) juce::jmax((juce::int64) 0, eventSample - position));
+            nextEvent++;
+        }
+
+        playHead.samplePosition = position;
+        processor.processOfflineBlock(buffer, midi, playHead);
+
+        const auto& output = processor.getLastOutputBuffer3d();
+        if (writer != nullptr && !writer->writeFromAudioSampleBuffer(output, 0, numSamples)) {
+            result.errorMessage = "An error occurred while writing the rendered audio.";
+            break;
+        }
+        if (onBlock != nullptr) {
+            onBlock(output);
+        }
+
+        result.samplesRendered += numSamples;
+
+        if (onProgress != nullptr && !onProgress((double) result.samplesRendered / (double) totalSamples)) {
+            result.cancelled = true;
+            break;
+        }
+    }
+
+    result.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0;
+
+    // Hand the processor back to the device.
+    processor.midiEnabled->setBoolValue(previousMidiEnabled);
+    processor.setNonRealtime(previousNonRealtime);
+    if (previousSampleRate > 0.0 && previousBlockSize > 0) {
+        processor.prepareForOfflineRender(previousSampleRate, previousBlockSize);
+    }
+    processor.setOfflineRenderActive(previousOfflineRenderActive);
+
+    writer.reset(); // flushes the WAV header
+
+    if (tempFile != nullptr) {
+        if (result.cancelled || result.errorMessage.isNotEmpty()) {
+            tempFile->deleteTemporaryFile();
+            return result;
+        }
+        if (!tempFile->overwriteTargetFileWithTemporary()) {
+            result.errorMessage = "Failed to finalise " + outputFile.getFullPathName() + ".";
+            return result;
+        }
+    }
+
+    result.success = !result.cancelled && result.errorMessage.isEmpty();
+
+    juce::Logger::writeToLog("OfflineProjectRenderer: rendered " + juce::String(result.samplesRendered) + " samples in "
+        + juce::String(result.renderSeconds, 2) + "s (" + juce::String(result.getRealTimeFactor(settings.sampleRate), 1) + "x real time)");
+
+    return result;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+class OscirenderAudioProcessor;
+
+// Renders a whole osci-render project (files, Lua, effects, modulation, MIDI)
+// to a lossless multichannel WAV as fast as the CPU allows.
+//
+// The processor is driven directly through processOfflineBlock() with a
+// free-running transport, so the result does not depend on a DAW or audio
+// device. Notes come either from a standard MIDI file or from a single fixed
+// note held for the length of the render. The output WAV has six channels in
+// the processor's native X, Y, Z, R, G, B order, which the offline video
+// renderer can turn into a video afterwards.
+class OfflineProjectRenderer {
+public:
+    struct Settings {
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+
+        // Total render length. When <= 0 and a MIDI file is used, the length is
+        // the end of the last MIDI event plus tailSeconds.
+        double lengthSeconds = 10.0;
+        double tailSeconds = 1.0;
+
+        // Tempo reported to the project (LFO sync, BPM-synced animation, Lua `bpm`).
+        // A MIDI file's first tempo event overrides this.
+        double bpm = 120.0;
+
+        // MIDI source. If midiFile is not an existing file, a single fixed note
+        // is played instead, released after noteLengthSeconds (<= 0 holds it).
+        juce::File midiFile;
+        int note = 60;
+        float velocity = 1.0f;
+        double noteLengthSeconds = -1.0;
+
+        int bitsPerSample = 32;
+    };
+
+    struct Result {
+        bool success = false;
+        bool cancelled = false;
+        juce::String errorMessage;
+        juce::int64 samplesRendered = 0;
+        double renderSeconds = 0.0;
+
+        double getRealTimeFactor(double sampleRate) const {
+            return renderSeconds > 0.0 ? ((double) samplesRendered / sampleRate) / renderSeconds : 0.0;
+        }
+    };
+
+    // Called after every block with progress in [0, 1]. Return false to cancel.
+    using ProgressCallback = std::function<bool(double)>;
+
+    // Called after every block with the full 6-channel output for that block.
+    using BlockCallback = std::function<void(const juce::AudioBuffer<float>&)>;
+
+    explicit OfflineProjectRenderer(OscirenderAudioProcessor& processor);
+
+    // Renders to outputFile (overwritten if it exists). Pass an invalid File to
+    // render without writing audio, e.g. for benchmarking with a BlockCallback.
+    // Blocking - call from a worker thread, never from the audio thread.
+    Result render(const Settings& settings, const juce::File& outputFile,
+                  ProgressCallback onProgress = nullptr, BlockCallback onBlock = nullptr);
+
+    static constexpr int kNumOutputChannels = 6;
+
+private:
+    // Transport that advances exactly one block per render step.
+    class FreeRunningPlayHead : public juce::AudioPlayHead {
+    public:
+        juce::Optional<PositionInfo> getPosition() const override;
+
+        double sampleRate = 48000.0;
+        double bpm = 120.0;
+        juce::int64 samplePosition = 0;
+    };
+
+    // Builds the note timeline (timestamps in seconds). midiEndSeconds is the
+    // time of the last event, or 0 for the fixed-note timeline.
+    bool buildTimeline(const Settings& settings, juce::MidiMessageSequence& sequence,
+                       double& bpmOut, double& midiEndSeconds, juce::String& error) const;
+
+    OscirenderAudioProcessor& processor;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineProjectRenderer)
+};
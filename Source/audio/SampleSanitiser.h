@@ -0,0 +1,71 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Keeps NaN, Inf and runaway samples from spreading through the render path.
+//
+// A single bad sample is enough to poison every stateful stage after it (a
+// smoother or delay line holds on to a NaN forever), so each stage's output is
+// checked before the next one sees it. Checking is a branch-free scan of the
+// block; samples are only rewritten when the scan finds a problem.
+namespace SampleSanitiser {
+
+// Nothing in the render path legitimately gets this far from the origin, and
+// squaring it in a later stage still stays finite.
+inline constexpr float kMaxMagnitude = 1.0e6f;
+
+// What a bad sample is replaced with. Colour channels use the "no colour"
+// sentinel so a contained sample falls back to the default line colour.
+inline float replacementFor(int channel) {
+    return channel >= 3 ? -1.0f : 0.0f;
+}
+
+// False for NaN, +/-Inf and anything beyond kMaxMagnitude, since NaN fails
+// every comparison.
+inline bool isClean(const float* data, int numSamples) {
+    bool clean = true;
+    for (int i = 0; i < numSamples; ++i) {
+        clean &= std::abs(data[i]) <= kMaxMagnitude;
+    }
+    return clean;
+}
+
+// Replaces each bad sample with `replacement` and returns how many there were.
+inline int sanitise(float* data, int numSamples, float replacement) {
+    int replaced = 0;
+    for (int i = 0; i < numSamples; ++i) {
+        if (!(std::abs(data[i]) <= kMaxMagnitude)) {
+            data[i] = replacement;
+            replaced++;
+        }
+    }
+    return replaced;
+}
+
+// Returns the number of samples replaced across all channels of `buffer`.
+inline int sanitise(juce::AudioBuffer<float>& buffer) {
+    const int numSamples = buffer.getNumSamples();
+    int replaced = 0;
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
+        if (!isClean(buffer.getReadPointer(ch), numSamples)) {
+            replaced += sanitise(buffer.getWritePointer(ch), numSamples, replacementFor(ch));
+        }
+    }
+    return replaced;
+}
+
+// Sanitises the output `source` just wrote into `buffer`. If anything had to
+// be replaced, the effect's state is suspect too, so it is re-prepared with
+// the sizes it already has: that clears its history without reallocating or
+// touching the rest of the chain. Returns true if anything was contained.
+inline bool contain(juce::AudioBuffer<float>& buffer, osci::Effect* source, double sampleRate, int blockSize) {
+    if (sanitise(buffer) == 0) {
+        return false;
+    }
+    if (source != nullptr && sampleRate > 0.0) {
+        source->prepareToPlay(sampleRate, blockSize);
+    }
+    return true;
+}
+
+} // namespace SampleSanitiser
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Splits an audio block at MIDI controller events so everything that runs
+// once per block (CC mappings, animateValues, modulation fills) sees each
+// controller change at its own sample rather than at the next block edge.
+//
+// Controllers closer than kMinSubBlockSize to the previous split stay in the
+// earlier chunk, which bounds the per-chunk overhead for dense CC streams.
+// Blocks with no controllers are rendered in one call, untouched.
+class SubBlockSplitter {
+public:
+    static constexpr int kMinSubBlockSize = 32;
+
+    void prepareToPlay(int samplesPerBlock) {
+        // Roughly one CC per sample of a full block before the buffer grows.
+        subBlockMidi.ensureSize((size_t)juce::jmax(samplesPerBlock, 512) * 4);
+    }
+
+    // Returns the sample positions render() will split at, for tests.
+    static std::vector<int> findSplitPoints(const juce::MidiBuffer& midi, int numSamples) {
+        std::vector<int> points;
+        int lastSplit = 0;
+        for (const auto metadata : midi) {
+            int pos = metadata.samplePosition;
+            if (isSplitPoint(metadata.getMessage(), pos, lastSplit, numSamples)) {
+                points.push_back(pos);
+                lastSplit = pos;
+            }
+        }
+        return points;
+    }
+
+    template <typename Render>
+    void render(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi, juce::AudioPlayHead* head, double sampleRate, Render&& renderChunk) {
+        const int numSamples = buffer.getNumSamples();
+
+        int lastSplit = 0;
+        for (const auto metadata : midi) {
+            int pos = metadata.samplePosition;
+            if (isSplitPoint(metadata.getMessage(), pos, lastSplit, numSamples)) {
+                renderSubBlock(buffer, midi, head, sampleRate, lastSplit, pos - lastSplit, renderChunk);
+                lastSplit = pos;
+            }
+        }
+
+        if (lastSplit == 0) {
+            renderChunk(buffer, midi, head);
+            return;
+        }
+
+        renderSubBlock(buffer, midi, head, sampleRate, lastSplit, numSamples - lastSplit, renderChunk);
+        // The chunks consumed the events; the plugin produces no MIDI output.
+        midi.clear();
+    }
+
+private:
+    // Reports the host position advanced to the start of a sub-block. A
+    // stopped transport doesn't move, so neither do its sub-blocks.
+    class OffsetPlayHead : public juce::AudioPlayHead {
+    public:
+        juce::AudioPlayHead* host = nullptr;
+        int offsetSamples = 0;
+        double sampleRate = 44100.0;
+
+        juce::Optional<PositionInfo> getPosition() const override {
+            if (host == nullptr)
+                return {};
+            auto pos = host->getPosition();
+            if (!pos.hasValue() || offsetSamples == 0 || !pos->getIsPlaying())
+                return pos;
+
+            auto info = *pos;
+            double offsetSeconds = offsetSamples / sampleRate;
+            if (auto samples = info.getTimeInSamples())
+                info.setTimeInSamples(*samples + offsetSamples);
+            if (auto seconds = info.getTimeInSeconds())
+                info.setTimeInSeconds(*seconds + offsetSeconds);
+            if (auto ppq = info.getPpqPosition())
+                if (auto bpm = info.getBpm())
+                    info.setPpqPosition(*ppq + offsetSeconds * *bpm / 60.0);
+            return info;
+        }
+    };
+
+    juce::MidiBuffer subBlockMidi;
+    OffsetPlayHead offsetHead;
+
+    static bool isSplitPoint(const juce::MidiMessage& message, int pos, int lastSplit, int numSamples) {
+        return message.isController() && pos > 0 && pos < numSamples
+            && pos - lastSplit >= kMinSubBlockSize;
+    }
+
+    template <typename Render>
+    void renderSubBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi, juce::AudioPlayHead* head, double sampleRate,
+                        int start, int length, Render& renderChunk) {
+        // Refers to the parent's channels, so rendering writes straight into it.
+        juce::AudioBuffer<float> subBuffer(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, length);
+
+        subBlockMidi.clear();
+        subBlockMidi.addEvents(midi, start, length, -start);
+
+        offsetHead.host = head;
+        offsetHead.offsetSamples = start;
+        offsetHead.sampleRate = sampleRate > 0.0 ? sampleRate : 44100.0;
+
+        renderChunk(subBuffer, subBlockMidi, head != nullptr ? &offsetHead : nullptr);
+    }
+};
@@ -9,6 +9,10 @@ public:
         return std::make_shared<AutoGainControlEffect>();
     }
 
+    void prepareToPlay(float sampleRate) override {
+        smoothedLevel = 0.01;
+    }
+
     osci::Point apply(int index, osci::Point input, osci::Point externalInput, const std::vector<std::atomic<float>>& values, float sampleRate, float frequency) override {
         // Extract parameters from values
         double intensity = values[0]; // How aggressively the gain is adjusted (0.0 - 1.0)
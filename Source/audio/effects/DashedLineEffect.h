@@ -8,7 +8,7 @@ public:
 	}
 
 	void prepareToPlay(float sampleRate) override {
-		buffer.resize((int)std::ceil(sampleRate));
+		buffer.assign((int)std::ceil(sampleRate), osci::Point());
 		bufferIndex = 0;
 		samplesSinceFrameStart = 0;
 	}
@@ -8,7 +8,7 @@ public:
 	}
 
 	void prepareToPlay(float sampleRate) override {
-		delayBuffer.resize((int)sampleRate);
+		delayBuffer.assign((int)sampleRate, osci::Point());
 		head = 0;
 		position = 0;
 		samplesSinceLastDelay = 0;
@@ -10,7 +10,7 @@ public:
     }
 
     void prepareToPlay(float sampleRate) override {
-        buffer.resize((int)sampleRate);
+        buffer.assign((int)sampleRate, osci::Point());
         head = 0;
     }
 
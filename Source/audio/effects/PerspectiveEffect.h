@@ -10,14 +10,16 @@ public:
 
 	osci::Point apply(int index, osci::Point input, osci::Point externalInput, const std::vector<std::atomic<float>>& values, float sampleRate, float frequency) override {
 		auto effectScale = values[0].load();
+		if (effectScale == 0.0f) {
+			return osci::Point(input.x, input.y, 0);
+		}
 		// Far plane clipping happens at about 1.2 deg for 100 far plane dist
 		float fovDegrees = juce::jlimit(1.5f, 179.0f, values[1].load());
 		float fov = juce::degreesToRadians(fovDegrees);
 
-		// Place camera such that field of view is tangent to unit sphere
-		Vec3 origin = Vec3(0, 0, -1.0f / std::sin(0.5f * (float)fov));
-		camera.setPosition(origin);
-		camera.setFov(fov);
+		// Place camera such that field of view is tangent to unit sphere.
+		// Only recomputed when the fov changes, which is rarely per sample.
+		camera.frameUnitSphere(fov);
 		Vec3 vec = Vec3(input.x, input.y, input.z);
 
 		Vec3 projected = camera.project(vec);
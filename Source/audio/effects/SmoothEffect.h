@@ -10,6 +10,10 @@ public:
 		return std::make_shared<SmoothEffect>(idPrefix, smoothingDefault);
 	}
 
+	void prepareToPlay(float sampleRate) override {
+		avg = osci::Point();
+	}
+
 	osci::Point apply(int index, osci::Point input, osci::Point externalInput, const std::vector<std::atomic<float>>& values, float sampleRate, float frequency) override {
 		float weight = juce::jmax(values[0].load(), 0.00001f);
 		weight *= 0.95;
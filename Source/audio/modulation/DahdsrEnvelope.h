@@ -198,6 +198,123 @@ public:
         return envValue;
     }
 
+    // Block equivalent of calling advance(dtSeconds) once per sample. Each stage
+    // run is rendered in one go: curves are stepped with a geometric recurrence
+    // (one multiply per sample) instead of an exp() per sample, and stage
+    // timing is accumulated exactly as advance() does so transitions land on
+    // the same samples.
+    //
+    // out receives one value per sample and may be nullptr when only the end
+    // state is needed. stagesOut, if given, receives getStage() as it would be
+    // after each sample's advance().
+    //
+    // Stops after the sample on which the envelope reaches Done (including
+    // when it was already Done), so the caller can end the voice there.
+    // Returns the number of samples rendered.
+    int advanceBlock(float* out, const int numSamples, const double dtSeconds, Stage* stagesOut = nullptr)
+    {
+        if (numSamples <= 0)
+            return 0;
+
+        if (dtSeconds <= 0.0)
+        {
+            if (out != nullptr)
+                juce::FloatVectorOperations::fill(out, 1.0f, numSamples);
+            if (stagesOut != nullptr)
+                std::fill(stagesOut, stagesOut + numSamples, stage);
+            return numSamples;
+        }
+
+        int pos = 0;
+        while (pos < numSamples)
+        {
+            const Stage runStage = stage;
+            float* runOut = out != nullptr ? out + pos : nullptr;
+            const int remaining = numSamples - pos;
+            int n = 0;
+
+            switch (stage)
+            {
+                case Stage::Delay:
+                    n = renderConstantRun(runOut, remaining, dtSeconds, 0.0f, params.delaySeconds);
+                    if (stageElapsed >= params.delaySeconds)
+                    {
+                        stage = Stage::Attack;
+                        stageElapsed = 0.0;
+                    }
+                    break;
+
+                case Stage::Attack:
+                    n = renderCurveRun(runOut, remaining, dtSeconds, 0.0f, 1.0f, params.attackSeconds, params.attackCurve);
+                    if (stageElapsed >= params.attackSeconds)
+                    {
+                        stage = (params.holdSeconds > 0.0) ? Stage::Hold : Stage::Decay;
+                        stageElapsed = 0.0;
+                    }
+                    break;
+
+                case Stage::Hold:
+                    n = renderConstantRun(runOut, remaining, dtSeconds, 1.0f, params.holdSeconds);
+                    if (stageElapsed >= params.holdSeconds)
+                    {
+                        stage = Stage::Decay;
+                        stageElapsed = 0.0;
+                    }
+                    break;
+
+                case Stage::Decay:
+                    n = renderCurveRun(runOut, remaining, dtSeconds, 1.0f, (float) params.sustainLevel, params.decaySeconds, params.decayCurve);
+                    if (stageElapsed >= params.decaySeconds)
+                    {
+                        stage = Stage::Sustain;
+                        stageElapsed = 0.0;
+                    }
+                    break;
+
+                case Stage::Sustain:
+                    // Only beginRelease() leaves Sustain, and that never happens mid-block.
+                    n = remaining;
+                    currentValue = (float) params.sustainLevel;
+                    if (runOut != nullptr)
+                        juce::FloatVectorOperations::fill(runOut, currentValue, n);
+                    break;
+
+                case Stage::Release:
+                    n = renderCurveRun(runOut, remaining, dtSeconds, releaseStartValue, 0.0f, params.releaseSeconds, params.releaseCurve);
+                    if (stageElapsed >= params.releaseSeconds)
+                    {
+                        stage = Stage::Done;
+                        currentValue = 0.0f;
+                        if (runOut != nullptr)
+                            runOut[n - 1] = 0.0f;
+                    }
+                    break;
+
+                case Stage::Done:
+                    n = 1;
+                    currentValue = 0.0f;
+                    if (runOut != nullptr)
+                        runOut[0] = 0.0f;
+                    break;
+            }
+
+            if (stagesOut != nullptr)
+            {
+                // Every sample of the run reports runStage except the last,
+                // which reports the stage it transitioned into (if any).
+                std::fill(stagesOut + pos, stagesOut + pos + n - 1, runStage);
+                stagesOut[pos + n - 1] = stage;
+            }
+
+            pos += n;
+
+            if (stage == Stage::Done)
+                break;
+        }
+
+        return pos;
+    }
+
     Stage getStage() const { return stage; }
     double getStageElapsed() const { return stageElapsed; }
 
@@ -225,6 +342,88 @@ public:
     float getCurrentValue() const { return currentValue; }
 
 private:
+    // Renders a flat stage until stageElapsed reaches duration or maxSamples
+    // run out. Returns the number of samples rendered (at least 1).
+    int renderConstantRun(float* out, const int maxSamples, const double dt, const float value, const double duration)
+    {
+        int n = 0;
+        do
+        {
+            stageElapsed += dt;
+            ++n;
+        } while (n < maxSamples && stageElapsed < duration);
+
+        currentValue = value;
+        if (out != nullptr)
+            juce::FloatVectorOperations::fill(out, value, n);
+        return n;
+    }
+
+    // Renders a curved segment (see osci_audio::evalSegment) until stageElapsed
+    // reaches duration or maxSamples run out. Returns the number of samples
+    // rendered (at least 1).
+    int renderCurveRun(float* out, const int maxSamples, const double dt,
+                       const float start, const float end, const double duration, const float curve)
+    {
+        if (duration <= 0.0)
+        {
+            stageElapsed += dt;
+            currentValue = end;
+            if (out != nullptr)
+                out[0] = end;
+            return 1;
+        }
+
+        if (out == nullptr)
+        {
+            // Nothing to render - only the final value matters.
+            double lastElapsed = stageElapsed;
+            int n = 0;
+            do
+            {
+                lastElapsed = stageElapsed;
+                stageElapsed += dt;
+                ++n;
+            } while (n < maxSamples && stageElapsed < duration);
+
+            currentValue = osci_audio::evalSegment(start, end, lastElapsed, duration, curve);
+            return n;
+        }
+
+        const double invDuration = 1.0 / duration;
+        const double range = (double) end - (double) start;
+        int n = 0;
+
+        if (std::abs(curve) <= 0.001f)
+        {
+            do
+            {
+                out[n] = (float) (start + range * juce::jmin(1.0, stageElapsed * invDuration));
+                stageElapsed += dt;
+                ++n;
+            } while (n < maxSamples && stageElapsed < duration);
+        }
+        else
+        {
+            // evalCurve01(c, p) = (1 - e^(c p)) / (1 - e^c). p advances by dt/duration
+            // each sample, so e^(c p) advances by a constant factor.
+            const double c = (double) curve;
+            const double scale = range / (1.0 - std::exp(c));
+            const double ratio = std::exp(c * dt * invDuration);
+            double growth = std::exp(c * juce::jmin(1.0, stageElapsed * invDuration));
+            do
+            {
+                out[n] = (float) (start + scale * (1.0 - growth));
+                growth *= ratio;
+                stageElapsed += dt;
+                ++n;
+            } while (n < maxSamples && stageElapsed < duration);
+        }
+
+        currentValue = out[n - 1];
+        return n;
+    }
+
     DahdsrParams params;
     Stage stage = Stage::Delay;
     double stageElapsed = 0.0;
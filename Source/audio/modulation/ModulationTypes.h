@@ -19,6 +19,7 @@ inline const std::vector<ModulationType>& getModulationTypes() {
         { "ENV", "env", 0xFFFF6E4A },
         { "RNG", "rng", 0xFF50FA7B },
         { "SC",  "sc",  0xFFFF6B6B },
+        { "SEQ", "seq", 0xFFF1FA8C },
     };
     return types;
 }
@@ -4,6 +4,7 @@
 #include "ModAssignment.h"
 #include "ModulationAssignmentStore.h"
 #include "LfoState.h"
+#include "StepSequencerState.h"
 
 // UndoableAction for adding a modulation assignment.
 struct AddAssignmentAction : public juce::UndoableAction {
@@ -22,6 +23,10 @@ struct AddAssignmentAction : public juce::UndoableAction {
         store.remove(assignment.sourceIndex, assignment.paramId);
         return true;
     }
+
+    int getSizeInUnits() override {
+        return (int) (sizeof(*this) + assignment.paramId.getNumBytesAsUTF8());
+    }
 };
 
 // UndoableAction for removing a modulation assignment.
@@ -41,6 +46,10 @@ struct RemoveAssignmentAction : public juce::UndoableAction {
         store.add(assignment);
         return true;
     }
+
+    int getSizeInUnits() override {
+        return (int) (sizeof(*this) + assignment.paramId.getNumBytesAsUTF8());
+    }
 };
 
 // UndoableAction for changing an LFO waveform shape.
@@ -68,4 +77,38 @@ struct LfoWaveformChangeAction : public juce::UndoableAction {
         waveforms[index] = oldWaveform;
         return true;
     }
+
+    int getSizeInUnits() override {
+        return (int) (sizeof(*this) + (oldWaveform.nodes.size() + newWaveform.nodes.size()) * sizeof(LfoNode));
+    }
+};
+
+// UndoableAction for editing the steps of a step sequencer.
+struct StepSequenceChangeAction : public juce::UndoableAction {
+    StepSequence* sequences;
+    juce::SpinLock& sequenceLock;
+    int index;
+    StepSequence oldSequence;
+    StepSequence newSequence;
+
+    StepSequenceChangeAction(StepSequence* sequences, juce::SpinLock& lock, int idx,
+                             const StepSequence& oldSeq, const StepSequence& newSeq)
+        : sequences(sequences), sequenceLock(lock), index(idx),
+          oldSequence(oldSeq), newSequence(newSeq) {}
+
+    bool perform() override {
+        juce::SpinLock::ScopedLockType l(sequenceLock);
+        sequences[index] = newSequence;
+        return true;
+    }
+
+    bool undo() override {
+        juce::SpinLock::ScopedLockType l(sequenceLock);
+        sequences[index] = oldSequence;
+        return true;
+    }
+
+    int getSizeInUnits() override {
+        return (int) sizeof(*this);
+    }
 };
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include <atomic>
+#include "StepSequencerState.h"
+#include "ModulationParameterTypes.h"
+#include "ModulationSource.h"
+
+// Encapsulates all DAW-automatable step sequencer parameters, the step data,
+// assignments, and audio-thread state. Follows the RandomParameters pattern.
+class StepSequencerParameters : public ModulationSource {
+public:
+    // DAW-automatable parameters (one per sequencer)
+    osci::FloatParameter* rate[NUM_STEP_SEQUENCERS] = {};
+    LfoRateModeParameter* rateMode[NUM_STEP_SEQUENCERS] = {};
+    TempoDivisionParameter* tempoDivision[NUM_STEP_SEQUENCERS] = {};
+    osci::IntParameter* length[NUM_STEP_SEQUENCERS] = {};
+
+    // Non-parameter state. Steps are edited on the message thread and read
+    // on the audio thread, so access them under sequenceLock.
+    StepSequence sequences[NUM_STEP_SEQUENCERS];
+    mutable juce::SpinLock sequenceLock;
+    int activeTab = 0;
+
+    // Audio-thread state
+    StepSequencerAudioState audioStates[NUM_STEP_SEQUENCERS];
+    std::array<std::vector<float>, NUM_STEP_SEQUENCERS> blockBuffer;
+
+    // Thread-safe snapshots for UI
+    std::atomic<float> currentValues[NUM_STEP_SEQUENCERS] = {};
+    std::atomic<int> currentSteps[NUM_STEP_SEQUENCERS] = {};
+
+    StepSequencerParameters() {
+        for (int i = 0; i < NUM_STEP_SEQUENCERS; ++i) {
+            juce::String idx = juce::String(i + 1);
+            juce::String pfx = "stepSeq" + idx;
+
+            rate[i] = new osci::FloatParameter("Step Seq " + idx + " Rate", pfx + "Rate", VERSION_HINT, 4.0f, 0.01f, 100.0f, 0.01f, "Hz");
+            rateMode[i] = new LfoRateModeParameter("Step Seq " + idx + " Rate Mode", pfx + "RateMode", VERSION_HINT, LfoRateMode::Tempo);
+            tempoDivision[i] = new TempoDivisionParameter("Step Seq " + idx + " Tempo Div", pfx + "TempoDivision", VERSION_HINT, 10);
+            length[i] = new osci::IntParameter("Step Seq " + idx + " Length", pfx + "Length", VERSION_HINT, seq::kDefaultLength, 1, seq::kMaxSteps);
+
+            floatParameters.push_back(rate[i]);
+            intParameters.push_back(rateMode[i]);
+            intParameters.push_back(tempoDivision[i]);
+            intParameters.push_back(length[i]);
+
+            audioStates[i].seed = 0x9E3779B9u + (uint32_t)i * 0x85EBCA6Bu;
+        }
+    }
+
+    // === ModulationSource interface ===
+    juce::String getTypeId() const override { return "seq"; }
+    juce::String getTypeLabel() const override { return "SEQ"; }
+    int getSourceCount() const override { return NUM_STEP_SEQUENCERS; }
+    const std::vector<float>* getBlockBuffers() const override { return blockBuffer.data(); }
+
+    void prepareToPlay(double /*sampleRate*/, int samplesPerBlock) override {
+        for (int i = 0; i < NUM_STEP_SEQUENCERS; ++i)
+            blockBuffer[i].resize(samplesPerBlock);
+    }
+
+    // === Step access (message thread) ===
+
+    StepSequence getSequence(int i) const {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS) return {};
+        juce::SpinLock::ScopedLockType lock(sequenceLock);
+        return sequences[i];
+    }
+
+    void setSequence(int i, const StepSequence& sequence) {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS) return;
+        juce::SpinLock::ScopedLockType lock(sequenceLock);
+        sequences[i] = sequence;
+    }
+
+    void setStep(int i, int stepIndex, const SequencerStep& step) {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS || stepIndex < 0 || stepIndex >= seq::kMaxSteps) return;
+        juce::SpinLock::ScopedLockType lock(sequenceLock);
+        sequences[i].steps[stepIndex] = step;
+    }
+
+    // === Parameter getters ===
+
+    LfoRateMode getRateMode(int i) const {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS || !rateMode[i]) return LfoRateMode::Tempo;
+        return (LfoRateMode)rateMode[i]->getValueUnnormalised();
+    }
+
+    int getTempoDivision(int i) const {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS || !tempoDivision[i]) return 10;
+        return tempoDivision[i]->getValueUnnormalised();
+    }
+
+    int getLength(int i) const {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS || !length[i]) return seq::kDefaultLength;
+        return length[i]->getValueUnnormalised();
+    }
+
+    // === Parameter setters ===
+
+    void setRateMode(int i, LfoRateMode m) {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS || !rateMode[i]) return;
+        rateMode[i]->setUnnormalisedValueNotifyingHost((int)m);
+    }
+
+    void setTempoDivision(int i, int divisionIndex) {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS || !tempoDivision[i]) return;
+        tempoDivision[i]->setUnnormalisedValueNotifyingHost(divisionIndex);
+    }
+
+    void setLength(int i, int steps) {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS || !length[i]) return;
+        length[i]->setUnnormalisedValueNotifyingHost(juce::jlimit(1, seq::kMaxSteps, steps));
+    }
+
+    // === UI snapshot access ===
+
+    float getCurrentValue(int i) const override {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS) return 0.0f;
+        return currentValues[i].load(std::memory_order_relaxed);
+    }
+
+    // Index within the sequence of the step playing at the end of the last block.
+    int getCurrentStep(int i) const {
+        if (i < 0 || i >= NUM_STEP_SEQUENCERS) return 0;
+        return currentSteps[i].load(std::memory_order_relaxed);
+    }
+
+    void resetAudioState() {
+        for (int i = 0; i < NUM_STEP_SEQUENCERS; ++i)
+            audioStates[i].reset();
+    }
+
+    // === Block buffer generation (called from audio thread each processBlock) ===
+    // Sequencers run off the transport rather than MIDI notes: syncStartSeconds
+    // and syncStartBeats are its position at the first sample of the block.
+    void fillBlockBuffers(int numSamples, double sampleRate, double bpm,
+                          double syncStartSeconds, double syncStartBeats) {
+        if (numSamples <= 0) return;
+
+        juce::SpinLock::ScopedLockType lock(sequenceLock);
+        auto& divisions = getTempoDivisions();
+
+        for (int i = 0; i < NUM_STEP_SEQUENCERS; ++i) {
+            if ((int)blockBuffer[i].size() < numSamples)
+                blockBuffer[i].resize(numSamples);
+
+            double startTime, timePerSecond, stepDuration;
+            LfoRateMode rateMd = rateMode[i] ? (LfoRateMode)rateMode[i]->getValueUnnormalised() : LfoRateMode::Tempo;
+            if (rateMd == LfoRateMode::Seconds) {
+                float rt = rate[i] ? rate[i]->getValueUnnormalised() : 4.0f;
+                startTime = syncStartSeconds;
+                timePerSecond = 1.0;
+                stepDuration = rt > 0.0f ? 1.0 / rt : 0.0;
+            } else {
+                int tdIdx = tempoDivision[i] ? tempoDivision[i]->getValueUnnormalised() : 10;
+                int idx = juce::jlimit(0, (int)divisions.size() - 1, tdIdx);
+                startTime = syncStartBeats;
+                timePerSecond = bpm / 60.0;
+                stepDuration = divisions[idx].durationInBeats();
+                if (rateMd == LfoRateMode::TempoDotted)   stepDuration *= 1.5;
+                if (rateMd == LfoRateMode::TempoTriplets) stepDuration *= 2.0 / 3.0;
+            }
+
+            int len = length[i] ? length[i]->getValueUnnormalised() : seq::kDefaultLength;
+            audioStates[i].advanceBlock(blockBuffer[i].data(), numSamples, sequences[i], len,
+                                        startTime, timePerSecond, stepDuration, sampleRate);
+
+            int64_t steps = juce::jlimit(1, seq::kMaxSteps, len);
+            int step = (int)(((audioStates[i].currentStep % steps) + steps) % steps);
+            currentSteps[i].store(step, std::memory_order_relaxed);
+            currentValues[i].store(blockBuffer[i][numSamples - 1], std::memory_order_relaxed);
+        }
+    }
+
+    // === State serialization ===
+
+    void saveToXml(juce::XmlElement* root) const override {
+        auto seqsXml = root->createNewChildElement("stepSequencers");
+        seqsXml->setAttribute("activeTab", activeTab);
+        {
+            juce::SpinLock::ScopedLockType lock(sequenceLock);
+            for (int i = 0; i < NUM_STEP_SEQUENCERS; ++i) {
+                auto seqXml = seqsXml->createNewChildElement("sequence");
+                seqXml->setAttribute("index", i);
+                sequences[i].saveToXml(seqXml);
+            }
+        }
+
+        auto assignmentsXml = seqsXml->createNewChildElement("stepSequencerAssignments");
+        {
+            juce::SpinLock::ScopedLockType lock(assignments.lock);
+            for (const auto& a : assignments.items) {
+                auto xml = assignmentsXml->createNewChildElement("assignment");
+                a.saveToXml(xml, "seq");
+            }
+        }
+    }
+
+    void loadFromXml(const juce::XmlElement* root) override {
+        StepSequence loaded[NUM_STEP_SEQUENCERS];
+        auto seqsXml = root->getChildByName("stepSequencers");
+        if (seqsXml != nullptr) {
+            activeTab = seqsXml->getIntAttribute("activeTab", 0);
+
+            for (auto* seqXml : seqsXml->getChildWithTagNameIterator("sequence")) {
+                int i = seqXml->getIntAttribute("index", -1);
+                if (i >= 0 && i < NUM_STEP_SEQUENCERS)
+                    loaded[i] = StepSequence::loadFromXml(seqXml);
+            }
+
+            auto assignmentsXml = seqsXml->getChildByName("stepSequencerAssignments");
+            if (assignmentsXml != nullptr) {
+                juce::SpinLock::ScopedLockType lock(assignments.lock);
+                assignments.items.clear();
+                for (auto* xml : assignmentsXml->getChildWithTagNameIterator("assignment"))
+                    assignments.items.push_back(StepSequencerAssignment::loadFromXml(xml, "seq"));
+            } else {
+                assignments.clear();
+            }
+        } else {
+            activeTab = 0;
+            assignments.clear();
+        }
+
+        juce::SpinLock::ScopedLockType lock(sequenceLock);
+        for (int i = 0; i < NUM_STEP_SEQUENCERS; ++i)
+            sequences[i] = loaded[i];
+    }
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+#include "ModAssignment.h"
+#include "LfoState.h"
+
+// Number of global step sequencers available.
+namespace seq {
+    inline constexpr int NUM_STEP_SEQUENCERS = 3;
+    inline constexpr int kMaxSteps = 64;
+    inline constexpr int kDefaultLength = 16;
+}
+using seq::NUM_STEP_SEQUENCERS;
+
+// StepSequencerAssignment is a type alias for the generic ModAssignment.
+// XML serialisation uses "seq" as the index attribute name.
+using StepSequencerAssignment = ModAssignment;
+
+// One step of a sequence.
+struct SequencerStep {
+    float value = 0.5f;         // Output [0, 1] while the step plays
+    bool glide = false;         // Ramp from the previous output across the step
+    float probability = 1.0f;   // Chance [0, 1] the step plays; otherwise the previous value holds
+
+    bool operator==(const SequencerStep& o) const {
+        return value == o.value && glide == o.glide && probability == o.probability;
+    }
+};
+
+// The steps of one sequencer. Only the first `length` steps (a parameter)
+// play, but all of them are kept so shortening and lengthening is lossless.
+struct StepSequence {
+    std::array<SequencerStep, seq::kMaxSteps> steps;
+
+    void saveToXml(juce::XmlElement* xml) const {
+        for (int i = 0; i < seq::kMaxSteps; ++i) {
+            if (steps[i] == SequencerStep())
+                continue;
+            auto stepXml = xml->createNewChildElement("step");
+            stepXml->setAttribute("index", i);
+            stepXml->setAttribute("value", (double)steps[i].value);
+            stepXml->setAttribute("glide", steps[i].glide);
+            stepXml->setAttribute("probability", (double)steps[i].probability);
+        }
+    }
+
+    static StepSequence loadFromXml(const juce::XmlElement* xml) {
+        StepSequence sequence;
+        for (auto* stepXml : xml->getChildWithTagNameIterator("step")) {
+            int i = stepXml->getIntAttribute("index", -1);
+            if (i < 0 || i >= seq::kMaxSteps) continue;
+            auto& step = sequence.steps[i];
+            step.value = juce::jlimit(0.0f, 1.0f, (float)stepXml->getDoubleAttribute("value", 0.5));
+            step.glide = stepXml->getBoolAttribute("glide", false);
+            step.probability = juce::jlimit(0.0f, 1.0f, (float)stepXml->getDoubleAttribute("probability", 1.0));
+        }
+        return sequence;
+    }
+};
+
+// Audio-thread state for a single step sequencer.
+//
+// Playback is a pure function of the transport: the step under each sample
+// is floor(time / stepDuration), so steps land on the same samples however
+// the host splits its blocks, and jumping or looping the transport lands on
+// the right step. Probability rolls are hashed from the absolute step index
+// for the same reason.
+struct StepSequencerAudioState {
+    int64_t currentStep = -1;    // Absolute step index playing, -1 before the first
+    float fromValue = 0.5f;      // Output at the start of the current step
+    float toValue = 0.5f;        // Output the current step holds or glides to
+    bool gliding = false;
+    uint32_t seed = 0x9E3779B9u;
+
+    // Hosts report the block start with rounding error, so positions this
+    // close below a boundary count as on it. Far less than a sample at any
+    // usable rate.
+    static constexpr double kBoundaryTolerance = 1e-7;
+
+    // Fills output with numSamples values. Time is in beats when synced to
+    // tempo or seconds otherwise: startTime is the transport position at the
+    // first sample, and it advances timePerSecond per second of audio.
+    void advanceBlock(float* output, int numSamples, const StepSequence& sequence, int length,
+                      double startTime, double timePerSecond, double stepDuration, double sampleRate) {
+        length = juce::jlimit(1, seq::kMaxSteps, length);
+
+        // Freeze, or no clock: hold whatever is playing
+        if (stepDuration <= 0.0 || timePerSecond <= 0.0 || sampleRate <= 0.0) {
+            for (int s = 0; s < numSamples; ++s)
+                output[s] = toValue;
+            return;
+        }
+
+        for (int s = 0; s < numSamples; ++s) {
+            // Computed from the block start rather than accumulated, and
+            // multiplied before dividing, so boundaries that fall on whole
+            // samples are hit exactly.
+            double time = startTime + (double)s * timePerSecond / sampleRate;
+            double position = time / stepDuration;
+            double whole = std::floor(position + kBoundaryTolerance);
+            auto step = (int64_t)whole;
+            if (step != currentStep)
+                enterStep(step, sequence, length);
+
+            if (gliding) {
+                float frac = (float)juce::jmax(0.0, position - whole);
+                output[s] = fromValue + frac * (toValue - fromValue);
+            } else {
+                output[s] = toValue;
+            }
+        }
+    }
+
+    // Whether the step at an absolute index plays, given its probability.
+    bool rollStep(int64_t step, float probability) const {
+        if (probability >= 1.0f) return true;
+        if (probability <= 0.0f) return false;
+        return hash(step) < probability;
+    }
+
+    void reset() {
+        currentStep = -1;
+        fromValue = 0.5f;
+        toValue = 0.5f;
+        gliding = false;
+    }
+
+private:
+    void enterStep(int64_t step, const StepSequence& sequence, int length) {
+        // The value reached by the end of the previous step
+        float previous = toValue;
+        currentStep = step;
+
+        int64_t index = step % length;
+        if (index < 0) index += length;
+        const auto& s = sequence.steps[(size_t)index];
+
+        if (rollStep(step, s.probability)) {
+            fromValue = previous;
+            toValue = s.value;
+            gliding = s.glide;
+        } else {
+            fromValue = previous;
+            toValue = previous;
+            gliding = false;
+        }
+    }
+
+    // Uniform [0, 1) from the absolute step index (splitmix64 finaliser)
+    float hash(int64_t step) const {
+        uint64_t z = (uint64_t)step + ((uint64_t)seed << 32) + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        return (float)(z >> 40) / (float)(1ull << 24);
+    }
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// One of a sampler-style keymap's zones: a range of notes and velocities,
+// and the file they play.
+struct KeyZone {
+    int lowNote = 0;
+    int highNote = 127;
+    // MIDI velocity, 1-127
+    int lowVelocity = 1;
+    int highVelocity = 127;
+    // Index into the loaded files
+    int fileIndex = 0;
+
+    bool contains(int note, int velocity) const {
+        return note >= lowNote && note <= highNote && velocity >= lowVelocity && velocity <= highVelocity;
+    }
+
+    bool operator==(const KeyZone& other) const = default;
+};
+
+// Which file each note plays.
+//
+// Zones are checked in order and the first that covers a note wins, so
+// velocity layers are zones over the same notes with different velocity
+// ranges. Notes no zone covers play the file fileSelect picks, as every note
+// did before there were zones.
+class KeyMap {
+public:
+    std::vector<KeyZone> zones;
+
+    // VoiceState velocities are 0-1; zones use MIDI's 1-127.
+    static int toMidiVelocity(float velocity) {
+        return juce::jlimit(1, 127, juce::roundToInt(velocity * 127.0f));
+    }
+
+    // The file index the note plays, or -1 if no zone covers it.
+    int findFile(int note, float velocity) const {
+        const int midiVelocity = toMidiVelocity(velocity);
+        for (const auto& zone : zones) {
+            if (zone.contains(note, midiVelocity)) {
+                return zone.fileIndex;
+            }
+        }
+        return -1;
+    }
+
+    // Keep zones on the same files when one is inserted at `index`.
+    void fileInserted(int index) {
+        for (auto& zone : zones) {
+            if (zone.fileIndex >= index) {
+                zone.fileIndex++;
+            }
+        }
+    }
+
+    // Zones on the removed file go with it; the rest keep their files.
+    void fileRemoved(int index) {
+        zones.erase(std::remove_if(zones.begin(), zones.end(), [index](const KeyZone& zone) { return zone.fileIndex == index; }), zones.end());
+        for (auto& zone : zones) {
+            if (zone.fileIndex > index) {
+                zone.fileIndex--;
+            }
+        }
+    }
+
+    void save(juce::XmlElement* xml) const {
+        auto keyMapXml = xml->createNewChildElement("keyMap");
+        for (const auto& zone : zones) {
+            saveZone(zone, keyMapXml->createNewChildElement("zone"));
+        }
+    }
+
+    void load(const juce::XmlElement* xml) {
+        zones.clear();
+        auto keyMapXml = xml->getChildByName("keyMap");
+        if (keyMapXml == nullptr) {
+            return;
+        }
+        for (auto zoneXml : keyMapXml->getChildWithTagNameIterator("zone")) {
+            auto zone = loadZone(zoneXml);
+            if (zone.fileIndex >= 0) {
+                zones.push_back(zone);
+            }
+        }
+    }
+
+    // Saves the zones on file `index` and where they sit in the list, so
+    // they can be put back if the file is closed and then reopened.
+    void saveFile(int index, juce::XmlElement* xml) const {
+        auto keyMapXml = xml->createNewChildElement("keyMap");
+        for (size_t i = 0; i < zones.size(); ++i) {
+            if (zones[i].fileIndex == index) {
+                auto zoneXml = keyMapXml->createNewChildElement("zone");
+                saveZone(zones[i], zoneXml);
+                zoneXml->setAttribute("position", (int) i);
+            }
+        }
+    }
+
+    // Puts back zones saved by saveFile() onto file `index`, once the file
+    // is back in the list.
+    void restoreFile(int index, const juce::XmlElement* xml) {
+        auto keyMapXml = xml->getChildByName("keyMap");
+        if (keyMapXml == nullptr) {
+            return;
+        }
+        for (auto zoneXml : keyMapXml->getChildWithTagNameIterator("zone")) {
+            auto zone = loadZone(zoneXml);
+            zone.fileIndex = index;
+            const int position = juce::jlimit(0, (int) zones.size(), zoneXml->getIntAttribute("position", (int) zones.size()));
+            zones.insert(zones.begin() + position, zone);
+        }
+    }
+
+private:
+    static void saveZone(const KeyZone& zone, juce::XmlElement* zoneXml) {
+        zoneXml->setAttribute("lowNote", zone.lowNote);
+        zoneXml->setAttribute("highNote", zone.highNote);
+        zoneXml->setAttribute("lowVelocity", zone.lowVelocity);
+        zoneXml->setAttribute("highVelocity", zone.highVelocity);
+        zoneXml->setAttribute("file", zone.fileIndex);
+    }
+
+    static KeyZone loadZone(const juce::XmlElement* zoneXml) {
+        KeyZone zone;
+        zone.lowNote = juce::jlimit(0, 127, zoneXml->getIntAttribute("lowNote", 0));
+        zone.highNote = juce::jlimit(0, 127, zoneXml->getIntAttribute("highNote", 127));
+        zone.lowVelocity = juce::jlimit(1, 127, zoneXml->getIntAttribute("lowVelocity", 1));
+        zone.highVelocity = juce::jlimit(1, 127, zoneXml->getIntAttribute("highVelocity", 127));
+        zone.fileIndex = zoneXml->getIntAttribute("file", 0);
+        return zone;
+    }
+};
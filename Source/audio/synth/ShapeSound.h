@@ -1,6 +1,7 @@
 #pragma once
 #include <JuceHeader.h>
 #include "../../parser/FrameConsumer.h"
+#include "SharedFrameSource.h"
 
 class FileParser;
 class FrameProducer;
@@ -15,20 +16,23 @@ public:
 	bool appliesToChannel(int channel) override;
 	void addFrame(std::vector<std::unique_ptr<osci::Shape>>& frame, bool force = true) override;
 	void replaceQueueWith(std::vector<std::unique_ptr<osci::Shape>>& frame) override;
-	bool updateFrame(std::vector<std::unique_ptr<osci::Shape>>& frame);
-	double getFrameLength() const;
 
-	// Returns true (and clears the flag) when replaceQueueWith() has
-	// pushed a fresh frame that the audio thread should grab immediately.
-	bool consumeFreshFrame();
+	using FrameCursor = SharedFrameSource::Cursor;
+	using FramePtr = SharedFrameSource::FramePtr;
+
+	// Audio thread only. Each voice drawing this sound keeps its own cursor,
+	// and voices share frames rather than taking them from each other.
+	FrameCursor makeFrameCursor() const { return frames.makeCursor(); }
+	bool nextFrame(FrameCursor& cursor, FramePtr& frame) { return frames.next(cursor, frame); }
+	// Returns true once per cursor when replaceQueueWith() has pushed a
+	// fresh frame that the voice should grab immediately.
+	bool consumeFreshFrame(FrameCursor& cursor) const { return frames.consumeFresh(cursor); }
 
 	std::shared_ptr<FileParser> parser;
 
 	using Ptr = juce::ReferenceCountedObjectPtr<ShapeSound>;
 
 private:
-	osci::BlockingQueue frames{10};
+	SharedFrameSource frames{10};
 	std::unique_ptr<FrameProducer> producer;
-	std::atomic<double> frameLength{0.0};
-	std::atomic<bool> freshFrameAvailable{false};
 };
@@ -11,7 +11,8 @@ ShapeVoice::ShapeVoice(OscirenderAudioProcessor& p, juce::AudioSampleBuffer& ext
 
 void ShapeVoice::initializeEffectsFromGlobal() {
     voiceEffectsMap.clear();
-    for (auto& globalEffect : audioProcessor.toggleableEffects) {
+    VersionedSnapshot<OscirenderAudioProcessor::EffectRegistry>::Reader effects(audioProcessor.effectRegistry);
+    for (auto& globalEffect : effects->toggleable) {
         auto simpleEffect = std::dynamic_pointer_cast<osci::SimpleEffect>(globalEffect);
         if (simpleEffect) {
             auto cloned = simpleEffect->cloneWithSharedParameters();
@@ -40,6 +41,20 @@ void ShapeVoice::clearPreviewEffect() {
     voicePreviewEffect = nullptr;
 }
 
+void ShapeVoice::syncPreviewEffect(const std::shared_ptr<osci::Effect>& preview, const std::vector<std::shared_ptr<osci::SimpleEffect>>* voicePreviews, bool cloneIfMissing) {
+    if (preview == nullptr) {
+        voicePreviewEffect = nullptr;
+    } else if (voicePreviews != nullptr && voiceIndex >= 0 && voiceIndex < (int) voicePreviews->size() && (*voicePreviews)[voiceIndex] != nullptr) {
+        voicePreviewEffect = (*voicePreviews)[voiceIndex];
+    } else if (cloneIfMissing) {
+        // Voices created after the preview was set have no clone prepared.
+        setPreviewEffect(std::dynamic_pointer_cast<osci::SimpleEffect>(preview));
+    } else {
+        // Picked up in voiceActivated() instead.
+        voicePreviewEffect = nullptr;
+    }
+}
+
 void ShapeVoice::prepareToPlay(double sampleRate, int samplesPerBlock) {
     // Update sample rate for all voice effects
     for (auto& pair : voiceEffectsMap) {
@@ -49,6 +64,7 @@ void ShapeVoice::prepareToPlay(double sampleRate, int samplesPerBlock) {
     if (voicePreviewEffect) {
         voicePreviewEffect->prepareToPlay(sampleRate, samplesPerBlock);
     }
+    envStageBuffer.resize(juce::jmax((int) envStageBuffer.size(), samplesPerBlock));
 }
 
 bool ShapeVoice::canPlaySound(juce::SynthesiserSound* sound) {
@@ -66,13 +82,13 @@ void ShapeVoice::captureDrawingState() {
 }
 
 void ShapeVoice::restoreDrawingState(const ShapeVoice* source) {
-    if (source == nullptr || frame.empty()) return;
+    if (source == nullptr || numShapes() == 0) return;
 
     // Restore from the source's SAVED snapshot (captured before kill).
-    currentShape = source->savedDrawingState.currentShape % (int)frame.size();
+    currentShape = source->savedDrawingState.currentShape % numShapes();
     frameDrawn = source->savedDrawingState.frameDrawn;
 
-    double length = currentShape < (int)frame.size() ? frame[currentShape]->len : 0.0;
+    double length = currentShape < numShapes() ? frame->shapes[currentShape]->len : 0.0;
     shapeDrawn = std::min(source->savedDrawingState.shapeDrawn, length);
 }
 
@@ -80,11 +96,15 @@ void ShapeVoice::voiceActivated(const VoiceState& vs, bool isLegato) {
     this->velocity = vs.velocity;
     this->currentMidiNote = vs.midiNote;
 
-    auto* shapeSound = audioProcessor.getActiveShapeSound();
+    // A keymap zone covering the note picks its file; otherwise fileSelect does.
+    bool mapped = false;
+    auto* shapeSound = SoundRegistry<ShapeSound>::pickSound(audioProcessor.getKeyMapRegistry(), vs.midiNote, vs.velocity,
+                                                            audioProcessor.getActiveShapeSound(), mapped);
     if (shapeSound == nullptr) return;
 
     currentlyPlaying = true;
-    this->sound = shapeSound;
+    keyMapped = mapped;
+    setSound(shapeSound);
 
     if (voiceIndex >= 0 && voiceIndex < OscirenderAudioProcessor::kMaxUiVoices) {
         audioProcessor.uiVoiceActive[voiceIndex].store(true, std::memory_order_relaxed);
@@ -92,26 +112,22 @@ void ShapeVoice::voiceActivated(const VoiceState& vs, bool isLegato) {
     }
 
     // Sync preview effect state
-    auto cachedPreview = audioProcessor.getCachedPreviewEffect();
-    if (cachedPreview) {
-        setPreviewEffect(cachedPreview);
+    if (auto* effects = audioProcessor.getAudioEffectRegistry()) {
+        syncPreviewEffect(effects->preview, effects->voicePreviews.get(), true);
     } else {
         clearPreviewEffect();
     }
 
-    auto* currentSound = this->sound.load();
-    auto parser = currentSound != nullptr ? currentSound->parser : nullptr;
-    renderingSample = parser != nullptr && parser->isSample();
-
     if (!isLegato) {
         // Non-legato: full reset — reload frame, reset drawing position,
         // retrigger envelopes.
-        frame.clear();
+        frameCursor = shapeSound->makeFrameCursor();
+        frame = nullptr;
         frameLength = 0.0;
         int tries = 0;
-        while (frame.empty() && tries < 50) {
-            if (shapeSound->updateFrame(frame)) {
-                frameLength = shapeSound->getFrameLength();
+        while (frame == nullptr && tries < 50) {
+            if (shapeSound->nextFrame(frameCursor, frame)) {
+                frameLength = frame->length;
             }
             tries++;
         }
@@ -201,8 +217,9 @@ void ShapeVoice::voiceKilled() {
 
 // TODO this is the slowest part of the program - any way to improve this would help!
 void ShapeVoice::incrementShapeDrawing() {
-    if (frame.size() <= 0) return;
-    double length = currentShape < frame.size() ? frame[currentShape]->len : 0.0;
+    const int shapeCount = numShapes();
+    if (shapeCount <= 0) return;
+    double length = currentShape < shapeCount ? frame->shapes[currentShape]->len : 0.0;
     frameDrawn += lengthIncrement;
     shapeDrawn += lengthIncrement;
 
@@ -212,12 +229,12 @@ void ShapeVoice::incrementShapeDrawing() {
     while (shapeDrawn > length) {
         shapeDrawn -= length;
         currentShape++;
-        if (currentShape >= frame.size()) {
+        if (currentShape >= shapeCount) {
             currentShape = 0;
         }
         // POTENTIAL TODO: Think of a way to make this more efficient when iterating
         // this loop many times
-        length = frame[currentShape]->len;
+        length = frame->shapes[currentShape]->len;
     }
 }
 
@@ -228,11 +245,29 @@ double ShapeVoice::getFrequency() {
 // should be called if the current file is changed so that we interrupt
 // any currently playing sounds / voices
 void ShapeVoice::updateSound(juce::SynthesiserSound* sound) {
-    if (currentlyPlaying) {
-        this->sound = dynamic_cast<ShapeSound*>(sound);
-        auto parser = this->sound.load()->parser;
-        renderingSample = parser != nullptr && parser->isSample();
+    // Key-mapped voices keep playing the file their note was mapped to.
+    if (currentlyPlaying && !keyMapped) {
+        setSound(dynamic_cast<ShapeSound*>(sound));
+    }
+}
+
+void ShapeVoice::dropUnloadedSound(const SoundRegistry<ShapeSound>& loaded, juce::SynthesiserSound* fallback) {
+    if (!currentlyPlaying || !loaded.mustDrop(sound.load(), keyMapped)) {
+        return;
+    }
+    keyMapped = false;
+    setSound(dynamic_cast<ShapeSound*>(fallback));
+}
+
+// The voice carries on drawing its current frame and takes the next one from
+// the new sound.
+void ShapeVoice::setSound(ShapeSound* newSound) {
+    if (newSound != sound.load()) {
+        frameCursor = newSound != nullptr ? newSound->makeFrameCursor() : ShapeSound::FrameCursor();
     }
+    sound = newSound;
+    auto parser = newSound != nullptr ? newSound->parser : nullptr;
+    renderingSample = parser != nullptr && parser->isSample();
 }
 
 void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int startSample, int numSamples) {
@@ -284,6 +319,24 @@ void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int star
     const bool midiEnabled = audioProcessor.midiEnabled->getBoolValue();
     const double dt = 1.0 / audioProcessor.currentSampleRate;
 
+    // Render envelope 0 for the whole block up front. Lua reads the value and
+    // stage *before* each sample's advance, so keep the block-start values too.
+    const float envStartValue = envState.getCurrentValue();
+    const DahdsrState::Stage envStartStage = envState.getStage();
+    const bool trackEnvStages = midiEnabled && renderingSample;
+    if (trackEnvStages && (int) envStageBuffer.size() < numSamples) {
+        envStageBuffer.resize(numSamples);
+    }
+    int envSamples = numSamples;
+    if (midiEnabled) {
+        envSamples = envState.advanceBlock(envelopeBuffer.getWritePointer(0), numSamples, dt,
+                                           trackEnvStages ? envStageBuffer.data() : nullptr);
+    } else {
+        juce::FloatVectorOperations::fill(envelopeBuffer.getWritePointer(0), 1.0f, numSamples);
+    }
+    const int envDoneSample = (midiEnabled && envState.getStage() == DahdsrState::Stage::Done) ? envSamples - 1 : -1;
+    int samplesRendered = numSamples;
+
     // Snapshot DAW transport once per block (constant within a processBlock call)
     const double blockBpm = audioProcessor.luaBpm.load(std::memory_order_relaxed);
     const double blockPlayTime = audioProcessor.luaPlayTime.load(std::memory_order_relaxed);
@@ -298,9 +351,9 @@ void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int star
 
     // If the producer flushed stale frames and pushed a fresh one, grab it
     // immediately instead of waiting until the current frame finishes.
-    if (!renderingSample && currentSound != nullptr && currentlyPlaying && currentSound->consumeFreshFrame()) {
-        if (currentSound->updateFrame(frame)) {
-            frameLength = currentSound->getFrameLength();
+    if (!renderingSample && currentSound != nullptr && currentlyPlaying && currentSound->consumeFreshFrame(frameCursor)) {
+        if (currentSound->nextFrame(frameCursor, frame)) {
+            frameLength = frame->length;
             currentShape = 0;
             frameDrawn = 0;
             shapeDrawn = 0;
@@ -309,6 +362,7 @@ void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int star
     }
 
     // First pass: generate raw audio samples (without gain) and fill frequency buffer + per-sample envelope
+    OSCI_PROFILE_SCOPE_NAMED(samplesScope, audioProcessor.profiler, renderingSample ? AudioThreadProfiler::VoiceSamples : AudioThreadProfiler::VoiceShapes);
     for (int i = 0; i < numSamples; ++i) {
         if (pendingFrameStart) {
             frameSyncBuffer.setSample(0, i, 1.0f);
@@ -367,12 +421,12 @@ void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int star
                 vars.timeSigDenominator = blockTimeSigDen;
 
                 // Envelope
-                vars.envelope = envState.getCurrentValue();
-                vars.envelopeStage = static_cast<int>(envState.getStage());
+                vars.envelope = i == 0 ? envStartValue : envelopeBuffer.getSample(0, i - 1);
+                vars.envelopeStage = static_cast<int>(i == 0 || !trackEnvStages ? envStartStage : envStageBuffer[i - 1]);
 
                 // Block-relative sample index for per-sample parameter reads
                 vars.blockSampleIndex = i;
-                
+            
                 if (externalAudio.getNumSamples() >= 1) {
                     double sampleIndex = sample % externalAudio.getNumSamples();
                     int extNumChannels = externalAudio.getNumChannels();
@@ -389,8 +443,8 @@ void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int star
                 }
 
                 channels = parser->nextSample(L, vars);
-            } else if (currentShape < frame.size()) {
-                auto& shape = frame[currentShape];
+            } else if (currentShape < numShapes()) {
+                auto& shape = frame->shapes[currentShape];
                 double length = shape->length();
                 double drawingProgress = length == 0.0 ? 1 : shapeDrawn / length;
                 channels = shape->nextVector(drawingProgress);
@@ -398,15 +452,7 @@ void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int star
             if (pendingNoteOn) pendingNoteOn = false;
         }
 
-        const float envValue = midiEnabled ? envState.advance(dt) : 1.0f;
-        // Advance modulation envelopes 1..N (envelope 0 == envState)
-        if (midiEnabled) {
-            for (int e = 1; e < NUM_ENVELOPES; ++e)
-                envStates[e].advance(dt);
-        }
-        envelopeBuffer.setSample(0, i, envValue);
-
-        if (midiEnabled && envState.getStage() == DahdsrState::Stage::Done)
+        if (i == envDoneSample)
         {
             const int remainingSamples = numSamples - (i + 1);
             if (remainingSamples > 0)
@@ -423,6 +469,7 @@ void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int star
                 juce::FloatVectorOperations::fill(frequencyBuffer.getWritePointer(0) + startSample2, (float) actualFrequency, remainingSamples);
                 juce::FloatVectorOperations::clear(envelopeBuffer.getWritePointer(0) + startSample2, remainingSamples);
             }
+            samplesRendered = i + 1;
             noteStopped();
             break;
         }
@@ -445,8 +492,8 @@ void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int star
         if (!renderingSample && frameDrawn >= frameLength) {
             double prevFrameLength = frameLength;
             if (currentSound != nullptr && currentlyPlaying) {
-                if (currentSound->updateFrame(frame)) {
-                    frameLength = currentSound->getFrameLength();
+                if (currentSound->nextFrame(frameCursor, frame)) {
+                    frameLength = frame->length;
                 }
             }
             frameDrawn -= prevFrameLength;
@@ -456,6 +503,14 @@ void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int star
             pendingFrameStart = true;
         }
     }
+    OSCI_PROFILE_STOP(samplesScope);
+
+    // Modulation envelopes 1..N (envelope 0 == envState) are only read at the
+    // end of the block, so just advance them over the samples this voice played.
+    if (midiEnabled) {
+        for (int e = 1; e < NUM_ENVELOPES; ++e)
+            envStates[e].advanceBlock(nullptr, samplesRendered, dt);
+    }
 
     if (voiceIndex >= 0 && voiceIndex < OscirenderAudioProcessor::kMaxUiVoices) {
         audioProcessor.uiVoiceActive[voiceIndex].store(currentlyPlaying, std::memory_order_relaxed);
@@ -472,7 +527,14 @@ void ShapeVoice::renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int star
         }
     }
 
-    audioProcessor.applyToggleableEffectsToBuffer(voiceBuffer, audioProcessor.getInputBuffer(), &envelopeBuffer, &frequencyBuffer, &frameSyncBuffer, &voiceEffectsMap, voicePreviewEffect);
+    // A parser or Lua script can produce anything, so don't let it reach the
+    // voice's effects, which would carry it forward in their state.
+    audioProcessor.containBadSamples(voiceBuffer);
+
+    {
+        OSCI_PROFILE_SCOPE(audioProcessor.profiler, AudioThreadProfiler::VoiceEffects);
+        audioProcessor.applyToggleableEffectsToBuffer(voiceBuffer, audioProcessor.getInputBuffer(), &envelopeBuffer, &frequencyBuffer, &frameSyncBuffer, &voiceEffectsMap, voicePreviewEffect);
+    }
 
     // Add processed samples to output buffer (apply envelope/velocity gain AFTER effects)
     // Velocity tracking: at 0% velocity has no effect (gain=1), at 100% full velocity,
@@ -551,6 +613,7 @@ void ShapeVoice::noteStopped() {
     currentlyPlaying = false;
     currentMidiNote = -1;
     sound = nullptr;
+    keyMapped = false;
 
     if (voiceIndex >= 0 && voiceIndex < OscirenderAudioProcessor::kMaxUiVoices) {
         audioProcessor.uiVoiceActive[voiceIndex].store(false, std::memory_order_relaxed);
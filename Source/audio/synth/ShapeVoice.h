@@ -2,6 +2,7 @@
 #include <JuceHeader.h>
 #include "VoiceManager.h"
 #include "ShapeSound.h"
+#include "SoundRegistry.h"
 #include "../modulation/DahdsrEnvelope.h"
 #include "../modulation/EnvState.h"
 #include "../../lua/LuaParser.h"
@@ -19,6 +20,9 @@ public:
 	// lifecycle is driven by voiceActivated/voiceDeactivated/voiceKilled.
 	void startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound* sound, int currentPitchWheelPosition) override;
     void updateSound(juce::SynthesiserSound* sound);
+	// Audio thread. Moves a key-mapped voice onto `fallback` if its file is
+	// no longer in `loaded`.
+	void dropUnloadedSound(const SoundRegistry<ShapeSound>& loaded, juce::SynthesiserSound* fallback);
 	void renderNextBlock(juce::AudioSampleBuffer& outputBuffer, int startSample, int numSamples) override;
 	void stopNote(float velocity, bool allowTailOff) override;
 	void pitchWheelMoved(int newPitchWheelValue) override;
@@ -46,6 +50,10 @@ public:
 	void initializeEffectsFromGlobal();
 	void setPreviewEffect(std::shared_ptr<osci::SimpleEffect> effect);
 	void clearPreviewEffect();
+	// Audio thread. Takes this voice's clone from voicePreviews, or clones
+	// preview itself if there isn't one and cloneIfMissing is set.
+	void syncPreviewEffect(const std::shared_ptr<osci::Effect>& preview, const std::vector<std::shared_ptr<osci::SimpleEffect>>* voicePreviews, bool cloneIfMissing);
+	int getVoiceIndex() const { return voiceIndex; }
 
 	bool renderingSample = false;
 private:
@@ -53,8 +61,13 @@ private:
 
 	OscirenderAudioProcessor& audioProcessor;
 	const int voiceIndex = 0;
-	std::vector<std::unique_ptr<osci::Shape>> frame;
+	// Shared with other voices drawing the same sound; the cursor is this
+	// voice's own place in that sound's frames.
+	ShapeSound::FramePtr frame;
+	ShapeSound::FrameCursor frameCursor;
 	std::atomic<ShapeSound*> sound = nullptr;
+	// Whether the sound came from the keymap rather than fileSelect.
+	bool keyMapped = false;
 
 	double frameLength = 0.0;
 	int currentShape = 0;
@@ -110,8 +123,12 @@ private:
 	juce::AudioBuffer<float> frequencyBuffer;
 	juce::AudioBuffer<float> envelopeBuffer;
 	juce::AudioBuffer<float> frameSyncBuffer;
+	// Envelope 0 stage after each sample, for Lua's envelopeStage.
+	std::vector<DahdsrState::Stage> envStageBuffer;
 	bool pendingFrameStart = true;
 	bool pendingNoteOn = false;
 
 	void noteStopped();
+	int numShapes() const { return frame != nullptr ? (int) frame->shapes.size() : 0; }
+	void setSound(ShapeSound* newSound);
 };
@@ -0,0 +1,98 @@
+#include "SharedFrameSource.h"
+
+SharedFrameSource::SharedFrameSource(size_t capacity) : queue(juce::jmax((size_t) 1, capacity)) {}
+
+void SharedFrameSource::push(std::vector<std::unique_ptr<osci::Shape>>& shapes, bool wait) {
+    auto frame = std::make_shared<Frame>();
+    frame->length = osci::Shape::totalLength(shapes);
+    frame->shapes = std::move(shapes);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (wait) {
+        spaceAvailable.wait(lock, [this] { return killed || count < queue.size(); });
+    }
+    if (killed || count == queue.size()) {
+        return;
+    }
+    queue[(head + count) % queue.size()] = std::move(frame);
+    count++;
+}
+
+void SharedFrameSource::replaceWith(std::vector<std::unique_ptr<osci::Shape>>& shapes) {
+    auto frame = std::make_shared<Frame>();
+    frame->length = osci::Shape::totalLength(shapes);
+    frame->shapes = std::move(shapes);
+
+    // Frames still queued are freed here rather than on the audio thread,
+    // and outside the lock so popping never waits on it.
+    std::vector<FramePtr> stale;
+    stale.reserve(queue.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (killed) {
+            return;
+        }
+        for (; count > 0; count--) {
+            stale.push_back(std::move(queue[head]));
+            head = (head + 1) % queue.size();
+        }
+        queue[head] = std::move(frame);
+        count = 1;
+        // Bumped with the frame in place, so whoever pops it sees it as fresh.
+        freshCount.fetch_add(1, std::memory_order_release);
+    }
+    spaceAvailable.notify_all();
+}
+
+void SharedFrameSource::kill() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        killed = true;
+    }
+    spaceAvailable.notify_all();
+}
+
+bool SharedFrameSource::pop(FramePtr& frame, juce::uint32& freshAtPop) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == 0) {
+            return false;
+        }
+        frame = std::move(queue[head]);
+        head = (head + 1) % queue.size();
+        count--;
+        freshAtPop = freshCount.load(std::memory_order_relaxed);
+    }
+    spaceAvailable.notify_one();
+    return true;
+}
+
+bool SharedFrameSource::next(Cursor& cursor, FramePtr& frame) {
+    // Once replaceWith() has run, the frame other voices are on is stale and
+    // the fresh one is waiting in the queue.
+    const bool latestIsCurrent = latestFrame != nullptr && freshCount.load(std::memory_order_acquire) == latestFreshCount;
+
+    if (!latestIsCurrent || cursor.sequence >= latestSequence) {
+        FramePtr popped;
+        juce::uint32 freshAtPop = 0;
+        if (!pop(popped, freshAtPop)) {
+            return false;
+        }
+        latestFrame = std::move(popped);
+        latestSequence++;
+        latestFreshCount = freshAtPop;
+    }
+
+    frame = latestFrame;
+    cursor.sequence = latestSequence;
+    return true;
+}
+
+bool SharedFrameSource::consumeFresh(Cursor& cursor) const {
+    const auto fresh = freshCount.load(std::memory_order_acquire);
+    if (fresh == cursor.freshCount) {
+        return false;
+    }
+    cursor.freshCount = fresh;
+    return true;
+}
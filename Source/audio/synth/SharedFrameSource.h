@@ -0,0 +1,73 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <condition_variable>
+#include <mutex>
+
+// The frames one file's producer makes, shared by every voice drawing them.
+//
+// The producer pushes whole frames into a small bounded queue and waits
+// while it is full, which paces it to how fast the frames are drawn. Each
+// voice keeps a Cursor and asks for the frame after the one it has: the first
+// voice to finish a frame takes the next one off the queue, and any voice
+// behind it picks up that same frame rather than taking another. So each
+// frame is produced once however many voices draw it, and voices never take
+// frames from each other the way they would sharing the queue directly.
+//
+// Frames are wrapped for sharing on the producer's thread, so handing them
+// out on the audio thread doesn't allocate.
+class SharedFrameSource {
+public:
+    struct Frame {
+        std::vector<std::unique_ptr<osci::Shape>> shapes;
+        double length = 0.0;
+    };
+    using FramePtr = std::shared_ptr<const Frame>;
+
+    // Where one voice has got to. Take a new one from makeCursor() whenever a
+    // voice starts drawing from a source.
+    struct Cursor {
+        juce::uint64 sequence = 0;
+        juce::uint32 freshCount = 0;
+    };
+
+    explicit SharedFrameSource(size_t capacity);
+
+    // Producer thread. If the queue is full, waits for room when `wait` is
+    // set and drops the frame otherwise.
+    void push(std::vector<std::unique_ptr<osci::Shape>>& shapes, bool wait);
+    // Producer thread. Drops everything queued in favour of `shapes`, which
+    // every cursor then sees as fresh.
+    void replaceWith(std::vector<std::unique_ptr<osci::Shape>>& shapes);
+    // Stops a waiting producer for good, e.g. before its thread is stopped.
+    void kill();
+
+    // Audio thread only, as is everything below.
+    Cursor makeCursor() const { return { 0, freshCount.load(std::memory_order_acquire) }; }
+    // Sets `frame` to the one after the cursor's and moves the cursor on.
+    // Returns false, leaving both alone, if there isn't one yet.
+    bool next(Cursor& cursor, FramePtr& frame);
+    // True once per cursor after each replaceWith().
+    bool consumeFresh(Cursor& cursor) const;
+    // How many frames have been taken off the queue, however many voices drew them.
+    juce::uint64 getNumFramesTaken() const { return latestSequence; }
+
+private:
+    // Also returns the fresh count the frame was popped under.
+    bool pop(FramePtr& frame, juce::uint32& freshAtPop);
+
+    std::mutex mutex;
+    std::condition_variable spaceAvailable;
+    // A ring, so popping never frees or allocates queue storage.
+    std::vector<FramePtr> queue;
+    size_t head = 0;
+    size_t count = 0;
+    bool killed = false;
+    std::atomic<juce::uint32> freshCount{ 0 };
+
+    FramePtr latestFrame;
+    juce::uint64 latestSequence = 0;
+    juce::uint32 latestFreshCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(SharedFrameSource)
+};
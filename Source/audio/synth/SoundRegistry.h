@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "KeyMap.h"
+
+// The sounds the audio thread can pick between, and the keymap over them.
+//
+// Rebuilt and published through a VersionedSnapshot whenever a file is added
+// or removed, so a version never changes once the audio thread can see it.
+template <typename Sound>
+struct SoundRegistry {
+    using Ptr = juce::ReferenceCountedObjectPtr<Sound>;
+
+    std::vector<Ptr> sounds;
+    KeyMap keyMap;
+
+    // The sound a zone gives the note, or nullptr if no zone covers it.
+    Sound* findKeyMapped(int midiNote, float velocity) const {
+        const int index = keyMap.findFile(midiNote, velocity);
+        if (index < 0 || index >= (int) sounds.size()) {
+            return nullptr;
+        }
+        return sounds[(size_t) index].get();
+    }
+
+    // The sound a voice starting on this note plays: the sound of the zone
+    // covering it, or `selected` if none does or there is no registry.
+    // keyMapped says whether a zone picked it. Key-mapped voices keep their
+    // sound when fileSelect changes; the rest follow it.
+    static Sound* pickSound(const SoundRegistry* registry, int midiNote, float velocity, Sound* selected, bool& keyMapped) {
+        Sound* mapped = registry != nullptr ? registry->findKeyMapped(midiNote, velocity) : nullptr;
+        keyMapped = mapped != nullptr;
+        return keyMapped ? mapped : selected;
+    }
+
+    // Whether a voice playing `playing` has to fall back to the selected
+    // sound once this version applies, because its zone's file was closed.
+    bool mustDrop(const Sound* playing, bool keyMapped) const {
+        return keyMapped && !contains(playing);
+    }
+
+    bool contains(const Sound* sound) const {
+        for (const auto& loaded : sounds) {
+            if (loaded.get() == sound) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
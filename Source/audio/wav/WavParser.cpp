@@ -13,6 +13,8 @@ bool WavParser::parse(std::unique_ptr<juce::InputStream> stream) {
         return false;
     }
     currentSample = 0;
+    loopStart = 0.0;
+    loopEnd = 0.0;
     juce::AudioFormatManager formatManager;
     formatManager.registerBasicFormats();
     juce::AudioFormatReader* reader = formatManager.createReaderFor(std::move(stream));
@@ -34,6 +36,10 @@ bool WavParser::parse(std::unique_ptr<juce::InputStream> stream) {
         + " samples=" + juce::String(afSource->getTotalLength()));
     fileSampleRate = reader->sampleRate;
     numChannels = (int) reader->numChannels;
+    channelLayout = ChannelLayout::fromMetadata(reader->metadataValues);
+    if (channelLayout.getNumChannels() > numChannels) {
+        channelLayout = ChannelLayout();
+    }
     audioBuffer.setSize(reader->numChannels, 1);
     // Default behaviour: follow the processor sample rate for realtime playback.
     // If the processor sample rate isn't known yet, fall back to the file sample rate.
@@ -78,6 +84,10 @@ int WavParser::getNumChannels() const {
     return numChannels;
 }
 
+ChannelLayout WavParser::getChannelLayout() const {
+    return channelLayout;
+}
+
 void WavParser::close() {
     if (initialised) {
         initialised = false;
@@ -120,7 +130,12 @@ void WavParser::processBlock(juce::AudioBuffer<float> &buffer) {
     }
 
     currentSample += source->getResamplingRatio() * buffer.getNumSamples();
-    if (currentSample >= totalSamples && afSource->isLooping()) {
+    const double loopStartSample = loopStart.load() * totalSamples;
+    const double loopEndSample = loopEnd.load() * totalSamples;
+    if (loopEndSample > loopStartSample && currentSample >= loopEndSample && afSource->isLooping()) {
+        currentSample = loopStartSample;
+        afSource->setNextReadPosition((juce::int64) loopStartSample);
+    } else if (currentSample >= totalSamples && afSource->isLooping()) {
         currentSample = 0;
         afSource->setNextReadPosition(0);
     }
@@ -143,6 +158,16 @@ bool WavParser::isLooping() {
     return looping;
 }
 
+void WavParser::setLoopRange(juce::Range<double> range) {
+    range = range.getIntersectionWith({ 0.0, 1.0 });
+    loopStart = range.getStart();
+    loopEnd = range.getEnd();
+}
+
+juce::Range<double> WavParser::getLoopRange() const {
+    return { loopStart.load(), loopEnd.load() };
+}
+
 void WavParser::setPaused(bool paused) {
     this->paused = paused;
 }
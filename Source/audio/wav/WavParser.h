@@ -1,5 +1,6 @@
 #pragma once
 #include <JuceHeader.h>
+#include "../ChannelLayout.h"
 
 class CommonAudioProcessor;
 class WavParser {
@@ -14,6 +15,10 @@ public:
 	bool isPaused();
 	void setLooping(bool looping);
 	bool isLooping();
+	// Restricts looping to part of the file, given as 0-1 progress. An empty
+	// range loops the whole file.
+	void setLoopRange(juce::Range<double> range);
+	juce::Range<double> getLoopRange() const;
 	bool parse(std::unique_ptr<juce::InputStream> stream);
 
 	// Offline / utility helpers
@@ -24,6 +29,9 @@ public:
 	void setTargetSampleRate(double sampleRate);
 	double getFileSampleRate() const;
 	int getNumChannels() const;
+	// Which visualiser channel each file channel holds, if the file says.
+	// Empty for files without an osci-render channel layout.
+	ChannelLayout getChannelLayout() const;
 
 	void close();
 	bool isInitialised();
@@ -37,6 +45,8 @@ private:
 	std::atomic<bool> initialised = false;
 	std::unique_ptr<juce::AudioFormatReaderSource> afSource;
 	std::atomic<bool> looping = true;
+	std::atomic<double> loopStart = 0.0;
+	std::atomic<double> loopEnd = 0.0;
 	std::unique_ptr<juce::ResamplingAudioSource> source = nullptr;
 	juce::AudioBuffer<float> audioBuffer;
 	std::atomic<bool> paused = false;
@@ -45,5 +55,6 @@ private:
 	std::atomic<bool> followProcessorSampleRate { true };
 	std::atomic<double> targetSampleRate { 0.0 };
 	int numChannels = 0;
+	ChannelLayout channelLayout;
     CommonAudioProcessor& audioProcessor;
 };
@@ -0,0 +1,238 @@
+#include "WaveformPeaks.h"
+
+namespace {
+    constexpr int kMagic = 0x4b50534f; // "OSPK"
+    constexpr int kFormatVersion = 1;
+    constexpr int kReadBlockSize = 1 << 16;
+}
+
+void PeakBucket::merge(const PeakBucket& other) {
+    if (other.numSamples == 0) return;
+    if (numSamples == 0) {
+        *this = other;
+        return;
+    }
+    minX = juce::jmin(minX, other.minX);
+    maxX = juce::jmax(maxX, other.maxX);
+    minY = juce::jmin(minY, other.minY);
+    maxY = juce::jmax(maxY, other.maxY);
+
+    const float total = (float) numSamples + (float) other.numSamples;
+    const float w = (float) other.numSamples / total;
+    red += (other.red - red) * w;
+    green += (other.green - green) * w;
+    blue += (other.blue - blue) * w;
+    numSamples += other.numSamples;
+}
+
+juce::Colour PeakBucket::getColour() const {
+    return juce::Colour::fromFloatRGBA(juce::jlimit(0.0f, 1.0f, red),
+                                       juce::jlimit(0.0f, 1.0f, green),
+                                       juce::jlimit(0.0f, 1.0f, blue), 1.0f);
+}
+
+WaveformPeaks::Channels WaveformPeaks::Channels::forFile(int numChannels, const ChannelLayout& layout) {
+    Channels channels;
+    if (numChannels <= 0) return channels;
+
+    if (!layout.isEmpty()) {
+        auto channelFor = [&](ChannelLayout::Role role) {
+            const int channel = layout.getChannel(role);
+            return channel < numChannels ? channel : -1;
+        };
+        channels.x = juce::jmax(0, channelFor(ChannelLayout::X));
+        channels.y = channelFor(ChannelLayout::Y) >= 0 ? channelFor(ChannelLayout::Y) : channels.x;
+        channels.red = channelFor(ChannelLayout::R);
+        channels.green = channelFor(ChannelLayout::G);
+        channels.blue = channelFor(ChannelLayout::B);
+        return channels;
+    }
+
+    channels.x = 0;
+    channels.y = numChannels > 1 ? 1 : 0;
+    if (numChannels >= 6) {
+        channels.red = 3; channels.green = 4; channels.blue = 5;
+    } else if (numChannels >= 5) {
+        channels.red = 2; channels.green = 3; channels.blue = 4;
+    }
+    return channels;
+}
+
+// ============================================================================
+// Builder
+// ============================================================================
+
+WaveformPeaks::Builder::Builder(Channels channels) : channels(channels) {}
+
+void WaveformPeaks::Builder::addSamples(const float* const* data, int numChannels, int numSamples) {
+    auto channel = [&](int index) { return index >= 0 && index < numChannels ? data[index] : nullptr; };
+    const float* xs = channel(channels.x);
+    const float* ys = channel(channels.y);
+    const float* rs = channel(channels.red);
+    const float* gs = channel(channels.green);
+    const float* bs = channel(channels.blue);
+    const bool withColour = rs != nullptr && gs != nullptr && bs != nullptr;
+
+    for (int i = 0; i < numSamples; ++i) {
+        const float x = xs != nullptr ? xs[i] : 0.0f;
+        const float y = ys != nullptr ? ys[i] : x;
+        if (pending.numSamples == 0) {
+            pending.minX = pending.maxX = x;
+            pending.minY = pending.maxY = y;
+        } else {
+            pending.minX = juce::jmin(pending.minX, x);
+            pending.maxX = juce::jmax(pending.maxX, x);
+            pending.minY = juce::jmin(pending.minY, y);
+            pending.maxY = juce::jmax(pending.maxY, y);
+        }
+        if (withColour) {
+            redSum += rs[i];
+            greenSum += gs[i];
+            blueSum += bs[i];
+        }
+        if (++pending.numSamples == (uint32_t) kBaseBucketSize)
+            flushBucket();
+    }
+    totalSamples += numSamples;
+}
+
+void WaveformPeaks::Builder::flushBucket() {
+    if (pending.numSamples == 0) return;
+    if (channels.hasColour()) {
+        pending.red = (float) (redSum / pending.numSamples);
+        pending.green = (float) (greenSum / pending.numSamples);
+        pending.blue = (float) (blueSum / pending.numSamples);
+    }
+    base.push_back(pending);
+    pending = PeakBucket();
+    redSum = greenSum = blueSum = 0.0;
+}
+
+std::unique_ptr<WaveformPeaks> WaveformPeaks::Builder::finish(double sampleRate) {
+    flushBucket();
+
+    auto peaks = std::make_unique<WaveformPeaks>();
+    peaks->totalSamples = totalSamples;
+    peaks->sampleRate = sampleRate;
+    peaks->colour = channels.hasColour();
+    if (base.empty()) return peaks;
+
+    peaks->levels.push_back(std::move(base));
+    base = {};
+    while (peaks->levels.back().size() > 1) {
+        const auto& below = peaks->levels.back();
+        std::vector<PeakBucket> level((below.size() + kFanout - 1) / kFanout);
+        for (size_t i = 0; i < below.size(); ++i)
+            level[i / kFanout].merge(below[i]);
+        peaks->levels.push_back(std::move(level));
+    }
+    return peaks;
+}
+
+std::unique_ptr<WaveformPeaks> WaveformPeaks::build(juce::AudioFormatReader& reader, const ChannelLayout& layout,
+                                                    const std::function<bool()>& shouldExit) {
+    const int numChannels = (int) reader.numChannels;
+    Builder builder(Channels::forFile(numChannels, layout));
+
+    juce::AudioBuffer<float> buffer(juce::jmax(1, numChannels), kReadBlockSize);
+    for (juce::int64 pos = 0; pos < reader.lengthInSamples; pos += kReadBlockSize) {
+        if (shouldExit != nullptr && shouldExit()) return nullptr;
+        const int n = (int) juce::jmin<juce::int64>(kReadBlockSize, reader.lengthInSamples - pos);
+        if (!reader.read(&buffer, 0, n, pos, true, true)) return nullptr;
+        builder.addSamples(buffer.getArrayOfReadPointers(), numChannels, n);
+    }
+    return builder.finish(reader.sampleRate);
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+void WaveformPeaks::getColumns(double start, double end, int numColumns, std::vector<PeakBucket>& columns) const {
+    columns.assign((size_t) juce::jmax(0, numColumns), PeakBucket());
+    if (isEmpty() || numColumns <= 0 || end <= start) return;
+
+    const double samplesPerColumn = (end - start) * (double) totalSamples / numColumns;
+    int level = 0;
+    double bucketSize = kBaseBucketSize;
+    while (level + 1 < getNumLevels() && bucketSize * kFanout <= samplesPerColumn) {
+        bucketSize *= kFanout;
+        ++level;
+    }
+
+    const auto& buckets = levels[(size_t) level];
+    const int numBuckets = (int) buckets.size();
+    for (int c = 0; c < numColumns; ++c) {
+        const double from = (start + (end - start) * c / numColumns) * (double) totalSamples;
+        const double to = (start + (end - start) * (c + 1) / numColumns) * (double) totalSamples;
+        int first = (int) std::floor(from / bucketSize);
+        // Always take at least one bucket, so zooming past the base
+        // resolution repeats buckets rather than leaving gaps.
+        int last = juce::jmax(first, (int) std::ceil(to / bucketSize) - 1);
+        first = juce::jmax(0, first);
+        last = juce::jmin(numBuckets - 1, last);
+        for (int b = first; b <= last; ++b)
+            columns[(size_t) c].merge(buckets[(size_t) b]);
+    }
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+
+void WaveformPeaks::writeTo(juce::OutputStream& out) const {
+    out.writeInt(kMagic);
+    out.writeInt(kFormatVersion);
+    out.writeInt64(totalSamples);
+    out.writeDouble(sampleRate);
+    out.writeBool(colour);
+    out.writeInt(getNumLevels());
+    for (const auto& level : levels) {
+        out.writeInt((int) level.size());
+        for (const auto& b : level) {
+            out.writeFloat(b.minX);
+            out.writeFloat(b.maxX);
+            out.writeFloat(b.minY);
+            out.writeFloat(b.maxY);
+            out.writeFloat(b.red);
+            out.writeFloat(b.green);
+            out.writeFloat(b.blue);
+            out.writeInt((int) b.numSamples);
+        }
+    }
+}
+
+std::unique_ptr<WaveformPeaks> WaveformPeaks::readFrom(juce::InputStream& in) {
+    if (in.readInt() != kMagic || in.readInt() != kFormatVersion)
+        return nullptr;
+
+    auto peaks = std::make_unique<WaveformPeaks>();
+    peaks->totalSamples = in.readInt64();
+    peaks->sampleRate = in.readDouble();
+    peaks->colour = in.readBool();
+
+    constexpr int kBytesPerBucket = 8 * 4;
+    const int numLevels = in.readInt();
+    if (numLevels < 0 || numLevels > 64) return nullptr;
+    for (int l = 0; l < numLevels; ++l) {
+        const int size = in.readInt();
+        // Reject sizes the rest of the stream can't hold before allocating.
+        if (size <= 0 || (juce::int64) size * kBytesPerBucket > in.getNumBytesRemaining())
+            return nullptr;
+        std::vector<PeakBucket> level((size_t) size);
+        for (auto& b : level) {
+            b.minX = in.readFloat();
+            b.maxX = in.readFloat();
+            b.minY = in.readFloat();
+            b.maxY = in.readFloat();
+            b.red = in.readFloat();
+            b.green = in.readFloat();
+            b.blue = in.readFloat();
+            b.numSamples = (uint32_t) in.readInt();
+        }
+        peaks->levels.push_back(std::move(level));
+    }
+    if (!in.isExhausted())
+        return nullptr;
+    return peaks;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../ChannelLayout.h"
+
+// Summary of a run of samples: the extent of the X and Y channels, and the
+// mean colour for files that carry R, G, B channels.
+struct PeakBucket {
+    float minX = 0.0f, maxX = 0.0f;
+    float minY = 0.0f, maxY = 0.0f;
+    float red = 1.0f, green = 1.0f, blue = 1.0f;
+    uint32_t numSamples = 0;
+
+    void merge(const PeakBucket& other);
+    juce::Colour getColour() const;
+};
+
+// Multi-resolution min/max pyramid of an audio file, used to draw its
+// waveform on the timeline at any zoom without touching the samples.
+//
+// Level 0 has one bucket per kBaseBucketSize samples and each level above it
+// merges kFanout buckets of the one below, up to a single bucket for the
+// whole file. Immutable once built.
+class WaveformPeaks {
+public:
+    static constexpr int kBaseBucketSize = 256;
+    static constexpr int kFanout = 4;
+
+    // Which file channels hold X, Y and colour. -1 for a missing channel.
+    struct Channels {
+        int x = 0, y = 0;
+        int red = -1, green = -1, blue = -1;
+
+        // Uses the file's channel layout if it has one, and otherwise the
+        // same guesses the offline video renderer makes.
+        static Channels forFile(int numChannels, const ChannelLayout& layout);
+        bool hasColour() const { return red >= 0 && green >= 0 && blue >= 0; }
+    };
+
+    // Accumulates samples in order and produces the pyramid.
+    class Builder {
+    public:
+        explicit Builder(Channels channels);
+
+        void addSamples(const float* const* data, int numChannels, int numSamples);
+        std::unique_ptr<WaveformPeaks> finish(double sampleRate);
+
+    private:
+        void flushBucket();
+
+        Channels channels;
+        std::vector<PeakBucket> base;
+        PeakBucket pending;
+        double redSum = 0.0, greenSum = 0.0, blueSum = 0.0;
+        juce::int64 totalSamples = 0;
+    };
+
+    // Reads the whole file. Returns nullptr if shouldExit() asks it to stop.
+    static std::unique_ptr<WaveformPeaks> build(juce::AudioFormatReader& reader, const ChannelLayout& layout,
+                                                const std::function<bool()>& shouldExit);
+
+    bool isEmpty() const { return levels.empty(); }
+    bool hasColour() const { return colour; }
+    juce::int64 getTotalSamples() const { return totalSamples; }
+    double getSampleRate() const { return sampleRate; }
+    int getNumLevels() const { return (int) levels.size(); }
+    const std::vector<PeakBucket>& getLevel(int level) const { return levels[(size_t) level]; }
+
+    // Summarises [start, end) of the file (as 0-1 progress) in numColumns
+    // equal columns, reading the coarsest level that still has at least one
+    // bucket per column. Columns past the end of the file are left empty.
+    void getColumns(double start, double end, int numColumns, std::vector<PeakBucket>& columns) const;
+
+    void writeTo(juce::OutputStream& out) const;
+    // Returns nullptr if the stream doesn't hold peaks in this format.
+    static std::unique_ptr<WaveformPeaks> readFrom(juce::InputStream& in);
+
+private:
+    std::vector<std::vector<PeakBucket>> levels;
+    juce::int64 totalSamples = 0;
+    double sampleRate = 0.0;
+    bool colour = false;
+};
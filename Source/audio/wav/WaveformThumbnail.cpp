@@ -0,0 +1,173 @@
+#include "WaveformThumbnail.h"
+
+WaveformThumbnail::WaveformThumbnail(juce::File cacheDirectory)
+    : juce::Thread("Waveform Thumbnail"), cacheDirectory(std::move(cacheDirectory)) {
+    startThread(juce::Thread::Priority::low);
+}
+
+WaveformThumbnail::~WaveformThumbnail() {
+    signalThreadShouldExit();
+    sourceChanged.signal();
+    stopThread(2000);
+}
+
+void WaveformThumbnail::setSource(StreamOpener opener, CacheKey key) {
+    {
+        const juce::ScopedLock sl(sourceLock);
+        pendingSource = std::move(opener);
+        pendingKey = std::move(key);
+        sourceGeneration++;
+        peaks.publish(std::make_unique<WaveformPeaks>());
+    }
+    sourceChanged.signal();
+}
+
+void WaveformThumbnail::setSource(const juce::File& file) {
+    setSource([file]() -> std::unique_ptr<juce::InputStream> {
+        auto stream = file.createInputStream();
+        if (stream == nullptr || !stream->openedOk()) return nullptr;
+        return stream;
+    }, [file] { return getCacheKeyFor(file); });
+}
+
+void WaveformThumbnail::setSource(std::shared_ptr<juce::MemoryBlock> block, CacheKey key) {
+    if (block == nullptr) {
+        clear();
+        return;
+    }
+    setSource([block]() -> std::unique_ptr<juce::InputStream> {
+        return std::make_unique<juce::MemoryInputStream>(*block, false);
+    }, std::move(key));
+}
+
+void WaveformThumbnail::clear() {
+    setSource(StreamOpener());
+}
+
+juce::File WaveformThumbnail::getCacheFileFor(const juce::String& key) const {
+    return cacheDirectory.getChildFile(key + ".peaks");
+}
+
+juce::String WaveformThumbnail::getCacheKeyFor(const juce::File& file) {
+    if (!file.existsAsFile()) return {};
+    const auto identity = file.getFullPathName() + "|" + juce::String(file.getSize())
+                        + "|" + juce::String(file.getLastModificationTime().toMilliseconds());
+    return juce::SHA256(identity.toUTF8()).toHexString();
+}
+
+int WaveformThumbnail::trimCache(const juce::File& directory, juce::int64 maxBytes) {
+    struct Entry {
+        juce::File file;
+        juce::int64 size;
+        juce::Time lastUsed;
+    };
+    std::vector<Entry> entries;
+    juce::int64 total = 0;
+    for (const auto& entry : juce::RangedDirectoryIterator(directory, false, "*.peaks", juce::File::findFiles)) {
+        entries.push_back({ entry.getFile(), entry.getFileSize(), entry.getModificationTime() });
+        total += entry.getFileSize();
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+    int deleted = 0;
+    for (auto& entry : entries) {
+        if (total <= maxBytes) break;
+        if (entry.file.deleteFile()) {
+            total -= entry.size;
+            deleted++;
+        }
+    }
+    return deleted;
+}
+
+void WaveformThumbnail::run() {
+    while (!threadShouldExit()) {
+        sourceChanged.wait(-1);
+        if (threadShouldExit()) break;
+
+        StreamOpener opener;
+        CacheKey key;
+        uint64_t generation;
+        {
+            const juce::ScopedLock sl(sourceLock);
+            opener = std::move(pendingSource);
+            key = std::move(pendingKey);
+            pendingSource = nullptr;
+            pendingKey = nullptr;
+            generation = sourceGeneration.load();
+        }
+        if (opener == nullptr) continue;
+
+        building = true;
+        auto built = loadOrBuild(opener, key, generation);
+        building = false;
+
+        // Checked under the lock so a stale build can't replace what a newer
+        // setSource() published.
+        const juce::ScopedLock sl(sourceLock);
+        if (built != nullptr && generation == sourceGeneration.load()) {
+            peaks.publish(std::move(built));
+        }
+    }
+}
+
+std::unique_ptr<WaveformPeaks> WaveformThumbnail::loadOrBuild(const StreamOpener& opener, const CacheKey& key, uint64_t generation) {
+    auto shouldStop = [this, generation] {
+        return threadShouldExit() || generation != sourceGeneration.load();
+    };
+
+    auto cacheKey = key != nullptr ? key() : juce::String();
+    if (cacheKey.isEmpty()) {
+        auto stream = opener();
+        if (stream == nullptr) return nullptr;
+        cacheKey = juce::SHA256(*stream).toHexString();
+    }
+    if (shouldStop()) return nullptr;
+
+    const auto cacheFile = getCacheFileFor(cacheKey);
+    if (cacheFile.existsAsFile()) {
+        std::unique_ptr<WaveformPeaks> cached;
+        {
+            juce::FileInputStream in(cacheFile);
+            if (in.openedOk()) {
+                cached = WaveformPeaks::readFrom(in);
+            }
+        }
+        if (cached != nullptr) {
+            // The modification time is the last use, for trimCache().
+            cacheFile.setLastModificationTime(juce::Time::getCurrentTime());
+            return cached;
+        }
+        juce::Logger::writeToLog("WaveformThumbnail: ignoring unreadable cache file " + cacheFile.getFileName());
+    }
+
+    auto stream = opener();
+    if (stream == nullptr) return nullptr;
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(std::move(stream)));
+    if (reader == nullptr) return nullptr;
+
+    auto built = WaveformPeaks::build(*reader, ChannelLayout::fromMetadata(reader->metadataValues), shouldStop);
+    if (built == nullptr) return nullptr;
+
+    // Write beside the final name and move it into place, so a half-written
+    // cache file is never read back.
+    if (cacheDirectory.createDirectory()) {
+        juce::TemporaryFile temp(cacheFile);
+        bool written = false;
+        {
+            juce::FileOutputStream out(temp.getFile());
+            if (out.openedOk()) {
+                built->writeTo(out);
+                out.flush();
+                written = out.getStatus().wasOk();
+            }
+        }
+        if (!written || !temp.overwriteTargetFileWithTemporary()) {
+            juce::Logger::writeToLog("WaveformThumbnail: failed to write cache file " + cacheFile.getFileName());
+        }
+        trimCache(cacheDirectory, kMaxCacheBytes);
+    }
+    return built;
+}
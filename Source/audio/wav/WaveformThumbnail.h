@@ -0,0 +1,63 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "WaveformPeaks.h"
+#include "../../util/VersionedSnapshot.h"
+
+// Builds the WaveformPeaks for an audio file on a background thread and
+// publishes them for the timeline to paint.
+//
+// Peaks are cached on disk so reopening a file (or a project that embeds it)
+// skips the decode. Files are keyed by path, size and modification time;
+// other sources by a key the caller supplies, falling back to the SHA-256 of
+// their contents. The cache is trimmed to kMaxCacheBytes, least recently
+// used first. Readers take a Reader on the snapshot, which never locks; until
+// a build finishes they see empty peaks.
+class WaveformThumbnail : private juce::Thread {
+public:
+    using StreamOpener = std::function<std::unique_ptr<juce::InputStream>()>;
+    // Names the source's peaks in the cache. Called on the background thread;
+    // an empty key means the contents are hashed instead.
+    using CacheKey = std::function<juce::String()>;
+
+    static constexpr juce::int64 kMaxCacheBytes = 256 * 1024 * 1024;
+
+    explicit WaveformThumbnail(juce::File cacheDirectory);
+    ~WaveformThumbnail() override;
+
+    // Starts building peaks for the stream the opener returns. The opener is
+    // called on the background thread to decode, and to hash if there's no key.
+    void setSource(StreamOpener opener, CacheKey key = {});
+    void setSource(const juce::File& file);
+    void setSource(std::shared_ptr<juce::MemoryBlock> block, CacheKey key = {});
+    void clear();
+
+    const VersionedSnapshot<WaveformPeaks>& getPeaks() const { return peaks; }
+    bool isBuilding() const { return building.load(); }
+
+    juce::File getCacheFileFor(const juce::String& key) const;
+
+    // Key for a file's peaks, from its path, size and modification time.
+    static juce::String getCacheKeyFor(const juce::File& file);
+    // Deletes the least recently used cache files until the directory holds
+    // at most maxBytes of them. Returns how many were deleted.
+    static int trimCache(const juce::File& directory, juce::int64 maxBytes);
+
+private:
+    void run() override;
+    std::unique_ptr<WaveformPeaks> loadOrBuild(const StreamOpener& opener, const CacheKey& key, uint64_t generation);
+
+    juce::File cacheDirectory;
+    VersionedSnapshot<WaveformPeaks> peaks;
+
+    juce::CriticalSection sourceLock;
+    StreamOpener pendingSource;
+    CacheKey pendingKey;
+    // Bumped by every setSource()/clear() so a build that has been
+    // superseded stops early and doesn't publish.
+    std::atomic<uint64_t> sourceGeneration { 0 };
+    std::atomic<bool> building { false };
+    juce::WaitableEvent sourceChanged;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformThumbnail)
+};
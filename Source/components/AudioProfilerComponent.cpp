@@ -0,0 +1,152 @@
+#include "AudioProfilerComponent.h"
+
+#if OSCI_AUDIO_PROFILER
+
+void AudioProfilerComponent::launchAsDialog(AudioThreadProfiler& profiler, juce::Component* owner, bool useNativeTitleBar) {
+    juce::DialogWindow::LaunchOptions options;
+    options.content.setOwned(new AudioProfilerComponent(profiler, owner));
+    options.dialogTitle = "Audio Profiler";
+    options.dialogBackgroundColour = Colours::veryDark().brighter(0.1f);
+    options.escapeKeyTriggersCloseButton = true;
+   #if JUCE_WINDOWS || JUCE_MAC
+    options.useNativeTitleBar = useNativeTitleBar;
+   #else
+    juce::ignoreUnused (useNativeTitleBar);
+   #endif
+    options.resizable = true;
+    options.launchAsync();
+}
+
+AudioProfilerComponent::AudioProfilerComponent(AudioThreadProfiler& profiler, juce::Component* owner)
+    : profiler(profiler), owner(owner) {
+    enabledToggle.setToggleState(profiler.isEnabled(), juce::dontSendNotification);
+    enabledToggle.onClick = [this] { this->profiler.setEnabled(enabledToggle.getToggleState()); };
+    resetButton.onClick = [this] { this->profiler.reset(); };
+    exportButton.onClick = [this] { exportJson(); };
+
+    addAndMakeVisible(enabledToggle);
+    addAndMakeVisible(resetButton);
+    addAndMakeVisible(exportButton);
+
+    setSize(760, 520);
+    timerCallback();
+    startTimerHz(4);
+}
+
+void AudioProfilerComponent::timerCallback() {
+    if (owner == nullptr) {
+        // The editor has gone, and the processor may follow, so stop reading
+        // its profiler.
+        stopTimer();
+        // launchAsync() deletes the window when it leaves its modal state.
+        if (auto* window = findParentComponentOfClass<juce::DialogWindow>()) {
+            window->exitModalState(0);
+        }
+        return;
+    }
+
+    report = profiler.getReport();
+    repaint();
+}
+
+void AudioProfilerComponent::exportJson() {
+    chooser = std::make_unique<juce::FileChooser>("Export profile", juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("audio-profile.json"), "*.json");
+    auto flags = juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles | juce::FileBrowserComponent::warnAboutOverwriting;
+
+    chooser->launchAsync(flags, [this](const juce::FileChooser& fc) {
+        auto file = fc.getResult();
+        if (file != juce::File()) {
+            file.replaceWithText(profiler.exportJson());
+        }
+    });
+}
+
+void AudioProfilerComponent::resized() {
+    auto area = getLocalBounds().reduced(kPad).removeFromTop(kHeaderH);
+    enabledToggle.setBounds(area.removeFromLeft(100));
+    exportButton.setBounds(area.removeFromRight(120));
+    area.removeFromRight(8);
+    resetButton.setBounds(area.removeFromRight(80));
+}
+
+void AudioProfilerComponent::paint(juce::Graphics& g) {
+    auto area = getLocalBounds().reduced(kPad);
+    area.removeFromTop(kHeaderH + 8);
+
+    g.setFont(juce::Font(13.0f));
+    g.setColour(juce::Colours::white);
+    g.drawText(juce::String(report.blocks) + " blocks, " + juce::String(report.overruns) + " overruns, deadline "
+                   + juce::String(report.lastDeadlineUs, 0) + " us",
+               area.removeFromTop(kRowH), juce::Justification::centredLeft);
+    area.removeFromTop(6);
+
+    const int columnW = 64;
+    auto drawRow = [&](juce::Rectangle<int> row, const juce::String& name, const juce::StringArray& values) {
+        g.drawText(name, row.removeFromLeft(170), juce::Justification::centredLeft, true);
+        for (auto& value : values) {
+            g.drawText(value, row.removeFromLeft(columnW), juce::Justification::centredRight);
+        }
+        return row;
+    };
+
+    g.setColour(juce::Colours::grey);
+    drawRow(area.removeFromTop(kRowH), "Stage", { "blocks", "mean us", "p50 us", "p99 us", "max us", "blamed" });
+
+    const int overrunH = (kMaxOverrunRows + 2) * kRowH;
+    auto table = area.withTrimmedBottom(overrunH);
+    for (auto& slot : report.slots) {
+        if (table.getHeight() < kRowH) {
+            break;
+        }
+        auto row = table.removeFromTop(kRowH);
+        g.setColour(slot.overrunsBlamed > 0 ? Dracula::orange : juce::Colours::white);
+        auto rest = drawRow(row, slot.name, {
+            juce::String(slot.blocks),
+            juce::String(slot.meanUs, 1),
+            juce::String(slot.p50Us, 1),
+            juce::String(slot.p99Us, 1),
+            juce::String(slot.maxUs, 1),
+            juce::String(slot.overrunsBlamed),
+        });
+        paintHistogram(g, rest.reduced(8, 2).toFloat(), slot);
+    }
+
+    auto overrunArea = area.removeFromBottom(overrunH);
+    g.setColour(juce::Colours::grey);
+    g.drawText("Recent overruns", overrunArea.removeFromTop(kRowH), juce::Justification::centredLeft);
+    g.setColour(juce::Colours::white);
+    for (int i = 0; i < juce::jmin((int) report.recentOverruns.size(), kMaxOverrunRows); i++) {
+        auto& overrun = report.recentOverruns[(size_t) i];
+        g.drawText("Block " + juce::String(overrun.block) + ": " + juce::String(overrun.blockUs, 0) + " / "
+                       + juce::String(overrun.deadlineUs, 0) + " us, " + overrun.blamed + " took "
+                       + juce::String(overrun.blamedUs, 0) + " us",
+                   overrunArea.removeFromTop(kRowH), juce::Justification::centredLeft);
+    }
+}
+
+// Bars for each bucket that has ever been hit, scaled to the fullest bucket.
+void AudioProfilerComponent::paintHistogram(juce::Graphics& g, juce::Rectangle<float> area, const AudioThreadProfiler::SlotReport& slot) const {
+    int first = -1, last = -1;
+    juce::uint32 peak = 0;
+    for (int b = 0; b < AudioThreadProfiler::kNumBuckets; b++) {
+        if (slot.histogram[(size_t) b] > 0) {
+            if (first < 0) {
+                first = b;
+            }
+            last = b;
+            peak = juce::jmax(peak, slot.histogram[(size_t) b]);
+        }
+    }
+    if (first < 0 || area.getWidth() <= 0.0f) {
+        return;
+    }
+
+    const float barW = area.getWidth() / (float) (last - first + 1);
+    g.setColour(Colours::accentColor());
+    for (int b = first; b <= last; b++) {
+        const float h = area.getHeight() * (float) slot.histogram[(size_t) b] / (float) peak;
+        g.fillRect(area.getX() + (b - first) * barW, area.getBottom() - h, juce::jmax(1.0f, barW - 1.0f), h);
+    }
+}
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../LookAndFeel.h"
+#include "../audio/AudioThreadProfiler.h"
+
+#if OSCI_AUDIO_PROFILER
+
+// Debug panel for AudioThreadProfiler: a table of per-stage block times with
+// a small histogram for each, plus the most recent buffer overruns and what
+// they were blamed on.
+class AudioProfilerComponent : public juce::Component, private juce::Timer {
+public:
+    // The panel closes itself if `owner` is deleted, since the profiler
+    // belongs to the processor the owner is editing.
+    AudioProfilerComponent(AudioThreadProfiler& profiler, juce::Component* owner);
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    static void launchAsDialog(AudioThreadProfiler& profiler, juce::Component* owner, bool useNativeTitleBar);
+
+private:
+    void timerCallback() override;
+    void exportJson();
+
+    void paintHistogram(juce::Graphics& g, juce::Rectangle<float> area, const AudioThreadProfiler::SlotReport& slot) const;
+
+    AudioThreadProfiler& profiler;
+    juce::Component::SafePointer<juce::Component> owner;
+    AudioThreadProfiler::Report report;
+
+    juce::ToggleButton enabledToggle { "Enabled" };
+    juce::TextButton resetButton { "Reset" };
+    juce::TextButton exportButton { "Export JSON..." };
+    std::unique_ptr<juce::FileChooser> chooser;
+
+    static constexpr int kPad = 12;
+    static constexpr int kRowH = 18;
+    static constexpr int kHeaderH = 28;
+    static constexpr int kMaxOverrunRows = 6;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioProfilerComponent)
+};
+
+#endif
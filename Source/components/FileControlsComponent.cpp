@@ -40,10 +40,18 @@ FileControlsComponent::FileControlsComponent(OscirenderAudioProcessor& p, Oscire
     addAndMakeVisible(closeFileButton);
     closeFileButton.setTooltip("Close the currently open file.");
     closeFileButton.onClick = [this] {
-        juce::SpinLock::ScopedLockType lock(audioProcessor.parsersLock);
-        int index = audioProcessor.getCurrentFileIndex();
-        if (index == -1) return;
-        audioProcessor.removeFile(audioProcessor.getCurrentFileIndex());
+        FileListChangeAction* action;
+        {
+            juce::SpinLock::ScopedLockType parserLock(audioProcessor.parsersLock);
+            juce::SpinLock::ScopedLockType effectsLock(audioProcessor.effectsLock);
+            int index = audioProcessor.getCurrentFileIndex();
+            if (index == -1) return;
+            action = FileListChangeAction::remove(audioProcessor, index);
+        }
+        // The action takes the locks itself when it removes the file.
+        auto& undoManager = audioProcessor.getUndoManager();
+        undoManager.beginNewTransaction("Close " + action->fileName);
+        undoManager.perform(action);
         updateFileLabel();
     };
 
@@ -132,6 +140,11 @@ void FileControlsComponent::updateFileLabel()
     if (audioProcessor.syphonInputActive) {
         fileLabel.setText(pluginEditor.getSyphonSourceName(), juce::dontSendNotification);
     } else
+#endif
+#if JUCE_LINUX && OSCI_PREMIUM
+    if (audioProcessor.liveVideoInputActive) {
+        fileLabel.setText(pluginEditor.getLiveVideoSourceName(), juce::dontSendNotification);
+    } else
 #endif
     if (audioProcessor.objectServerRendering) {
         fileLabel.setText("Rendering from Blender", juce::dontSendNotification);
@@ -162,6 +162,10 @@ void FractalComponent::updateFileFromUI() {
     }
     obj->setProperty("rules", rulesArray);
 
+    // Not editable here, but keep a line cap set in the file
+    if (currentParser->getMaxLines() != FractalParser::kDefaultMaxLines)
+        obj->setProperty("maxLines", currentParser->getMaxLines());
+
     juce::String json = juce::JSON::toString(juce::var(obj), false);
 
     auto block = std::make_shared<juce::MemoryBlock>();
@@ -144,6 +144,7 @@ void VolumeComponent::handleAsyncUpdate() {
 }
 
 void VolumeComponent::runTask(const juce::AudioBuffer<float>& buffer) {
+    juce::ScopedNoDenormals noDenormals;
     float leftVolume = 0;
     float rightVolume = 0;
 
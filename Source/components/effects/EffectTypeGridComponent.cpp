@@ -84,7 +84,6 @@ void EffectTypeGridComponent::setupEffectItems()
             };
             item->onHoverStart = [this](const juce::String& effectId) {
                 if (audioProcessor.getGlobalBoolValue("previewEffectOnHover", true)) {
-                    juce::SpinLock::ScopedLockType lock(audioProcessor.effectsLock);
                     audioProcessor.setPreviewEffectId(effectId);
                 }
 #if OSCI_PREMIUM
@@ -96,7 +95,6 @@ void EffectTypeGridComponent::setupEffectItems()
             };
             item->onHoverEnd = [this]() {
                 if (audioProcessor.getGlobalBoolValue("previewEffectOnHover", true)) {
-                    juce::SpinLock::ScopedLockType lock(audioProcessor.effectsLock);
                     audioProcessor.clearPreviewEffect();
                 }
                 audioProcessor.clearPreviewLfoAssignments();
@@ -162,6 +162,13 @@ struct AudioEffectListBoxItemData : public DraggableListBoxItemData
             processor.applyEffectOrder(beforeOrder);
             return true;
         }
+        int getSizeInUnits() override {
+            size_t size = sizeof(*this);
+            for (auto* order : { &beforeOrder, &afterOrder })
+                for (auto& id : *order)
+                    size += sizeof(juce::String) + id.getNumBytesAsUTF8();
+            return (int) size;
+        }
 
         OscirenderAudioProcessor& processor;
         std::vector<juce::String> beforeOrder, afterOrder;
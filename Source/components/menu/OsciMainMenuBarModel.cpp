@@ -100,9 +100,22 @@ void OsciMainMenuBarModel::resetMenuItems() {
         AboutComponent::launchAsDialog(aboutInfo, useNativeTitleBar);
     });
     addDiagnosticsMenuItems(aboutMenu, audioProcessor);
+#if OSCI_AUDIO_PROFILER
+    addMenuItem(aboutMenu, "Audio Profiler...", [this] {
+       #if JUCE_WINDOWS
+        const bool useNativeTitleBar = editor.processor.wrapperType == juce::AudioProcessor::WrapperType::wrapperType_Standalone;
+       #else
+        const bool useNativeTitleBar = true;
+       #endif
+        AudioProfilerComponent::launchAsDialog(audioProcessor.profiler, &editor, useNativeTitleBar);
+    });
+#endif
     addMenuItem(aboutMenu, "Randomize Blender Port", [this] {
         audioProcessor.setObjectServerPort(juce::Random::getSystemRandom().nextInt(juce::Range<int>(51600, 51700)));
     });
+    addToggleMenuItem(aboutMenu, "Listen for OSC on Port " + juce::String(OscServer::kDefaultPort), [this] {
+        audioProcessor.setOscServerPort(audioProcessor.getOscServerPort() > 0 ? 0 : OscServer::kDefaultPort);
+    }, [this] { return audioProcessor.getOscServerPort() > 0; });
 
 #if !OSCI_PREMIUM
     addMenuItem(aboutMenu, "Purchase osci-render premium!", [this] {
@@ -122,6 +135,10 @@ void OsciMainMenuBarModel::resetMenuItems() {
 #endif
     });
 
+    addMenuItem(videoMenu, "Render Project Offline...", [this] {
+        editor.renderProjectOffline();
+    });
+
 #if JUCE_MAC || JUCE_WINDOWS
     // Add Syphon/Spout input menu item under Recording
     juce::String syphonMenuLabel =
@@ -142,6 +159,25 @@ void OsciMainMenuBarModel::resetMenuItems() {
         editor.showPremiumSplashScreen();
 #endif
     });
+#elif JUCE_LINUX
+    juce::String liveVideoMenuLabel =
+#if OSCI_PREMIUM
+        audioProcessor.liveVideoInputActive ? "Disconnect Live Video Input" : "Select Live Video Input...";
+#else
+        "Select Live Video Input...";
+#endif
+
+    addMenuItem(videoMenu, liveVideoMenuLabel, [this] {
+#if OSCI_PREMIUM
+        if (audioProcessor.liveVideoInputActive) {
+            editor.disconnectLiveVideoInput();
+        } else {
+            editor.openLiveVideoInputDialog();
+        }
+#else
+        editor.showPremiumSplashScreen();
+#endif
+    });
 #endif
 
     if (editor.processor.wrapperType == juce::AudioProcessor::WrapperType::wrapperType_Standalone) {
@@ -157,7 +193,6 @@ void OsciMainMenuBarModel::resetMenuItems() {
         audioProcessor.setGlobalValue("previewEffectOnHover", newValue);
         audioProcessor.saveGlobalSettings();
         if (! newValue) {
-            juce::SpinLock::ScopedLockType lock(audioProcessor.effectsLock);
             audioProcessor.clearPreviewEffect();
         }
         resetMenuItems(); // update tick state
@@ -2,6 +2,7 @@
 #include <JuceHeader.h>
 
 #include "../AboutComponent.h"
+#include "../AudioProfilerComponent.h"
 #include "MainMenuBarModel.h"
 
 class OscirenderAudioProcessorEditor;
@@ -324,6 +324,9 @@ private:
             if (graphPtr->onNodesChanged) graphPtr->onNodesChanged();
             return true;
         }
+        int getSizeInUnits() override {
+            return (int) (sizeof(*this) + (beforeNodes.size() + afterNodes.size()) * sizeof(GraphNode));
+        }
 
         juce::Component::SafePointer<NodeGraphComponent> graphPtr;
         std::vector<GraphNode> beforeNodes, afterNodes;
@@ -0,0 +1,189 @@
+#include "StepSequencerComponent.h"
+#include "../effects/EffectComponent.h"
+#include "../../PluginProcessor.h"
+#include "../../LookAndFeel.h"
+
+// ============================================================================
+// Colours
+// ============================================================================
+
+juce::Colour StepSequencerComponent::getStepSequencerColour(int index) {
+    static const juce::Colour colours[] = {
+        juce::Colour(0xFFF1FA8C), // 0 Yellow
+        juce::Colour(0xFFFF79C6), // 1 Pink
+        juce::Colour(0xFF8BE9FD), // 2 Cyan
+    };
+    return colours[juce::jlimit(0, (int)std::size(colours) - 1, index)];
+}
+
+// ============================================================================
+// Config builders
+// ============================================================================
+
+static ModulationSourceConfig buildStepSequencerConfig(OscirenderAudioProcessor& proc) {
+    ModulationSourceConfig cfg;
+    cfg.sourceCount = NUM_STEP_SEQUENCERS;
+    cfg.dragPrefix = "SEQ";
+    cfg.getLabel = [](int i) { return "SEQ " + juce::String(i + 1); };
+    cfg.getSourceColour = &StepSequencerComponent::getStepSequencerColour;
+    cfg.getCurrentValue = [&proc](int i) { return proc.stepSequencerParameters.getCurrentValue(i); };
+    cfg.isSourceActive = [&proc](int i) { return proc.stepSequencerParameters.isActive(i); };
+    cfg.getAssignments = [&proc]() { return proc.stepSequencerParameters.getAssignments(); };
+    cfg.addAssignment = [&proc](const ModAssignment& a) { proc.stepSequencerParameters.addAssignment(a); };
+    cfg.removeAssignment = [&proc](int idx, const juce::String& pid) { proc.stepSequencerParameters.removeAssignment(idx, pid); };
+    cfg.getParamDisplayName = [&proc](const juce::String& pid) -> juce::String {
+        return proc.getParamDisplayName(pid);
+    };
+    cfg.broadcaster = &proc.broadcaster;
+    cfg.getActiveTab = [&proc]() { return proc.stepSequencerParameters.activeTab; };
+    cfg.setActiveTab = [&proc](int i) { proc.stepSequencerParameters.activeTab = i; };
+#if OSCI_PREMIUM
+    cfg.typeId = "seq";
+    cfg.midiCCManager = &proc.midiCCManager;
+    cfg.buildModDepthCustomId = [](int idx, const juce::String& pid) {
+        return OscirenderAudioProcessor::modDepthCustomId("seq", idx, pid);
+    };
+    cfg.buildModDepthSetter = [&proc](int idx, const juce::String& pid) {
+        return proc.buildModDepthSetter("seq", idx, pid);
+    };
+#endif
+    return cfg;
+}
+
+static ModulationRateConfig buildStepSequencerRateConfig(OscirenderAudioProcessor& proc) {
+    ModulationRateConfig cfg;
+    cfg.getRateParam = [&proc](int i) -> osci::FloatParameter* { return proc.stepSequencerParameters.rate[i]; };
+    cfg.getRateMode = [&proc](int i) { return proc.stepSequencerParameters.getRateMode(i); };
+    cfg.setRateMode = [&proc](int i, LfoRateMode m) { proc.stepSequencerParameters.setRateMode(i, m); };
+    cfg.getTempoDivision = [&proc](int i) { return proc.stepSequencerParameters.getTempoDivision(i); };
+    cfg.setTempoDivision = [&proc](int i, int d) { proc.stepSequencerParameters.setTempoDivision(i, d); };
+    cfg.getCurrentBpm = [&proc]() { return proc.currentBpm.load(std::memory_order_relaxed); };
+    cfg.maxIndex = NUM_STEP_SEQUENCERS;
+    return cfg;
+}
+
+static ModulationModeConfig buildStepSequencerLengthConfig(OscirenderAudioProcessor& proc) {
+    ModulationModeConfig cfg;
+    for (int steps = 1; steps <= seq::kMaxSteps; ++steps)
+        cfg.modes.push_back({ steps, juce::String(steps) });
+    cfg.getMode = [&proc](int i) { return proc.stepSequencerParameters.getLength(i); };
+    cfg.setMode = [&proc](int i, int m) { proc.stepSequencerParameters.setLength(i, m); };
+    cfg.labelText = "STEPS";
+    cfg.maxIndex = NUM_STEP_SEQUENCERS;
+    return cfg;
+}
+
+// ============================================================================
+// StepSequencerComponent
+// ============================================================================
+
+StepSequencerComponent::StepSequencerComponent(OscirenderAudioProcessor& processor)
+    : ModulationSourceComponent(buildStepSequencerConfig(processor)),
+      audioProcessor(processor),
+      rateControl(buildStepSequencerRateConfig(processor), 0),
+      lengthControl(buildStepSequencerLengthConfig(processor), 0) {
+
+    // Setup grid
+    grid.setCornerRadius(6.0f);
+    grid.onSequenceChanged = [this](const StepSequence& sequence) {
+        audioProcessor.stepSequencerParameters.setSequence(getActiveSourceIndex(), sequence);
+    };
+    grid.onEditFinished = [this](const StepSequence& before) {
+        // Record the processor-side change so undo works even if the editor
+        // has been destroyed and reopened.
+        auto& params = audioProcessor.stepSequencerParameters;
+        auto& um = audioProcessor.getUndoManager();
+        um.beginNewTransaction("Edit Steps");
+        um.perform(new StepSequenceChangeAction(params.sequences, params.sequenceLock,
+                                                getActiveSourceIndex(), before, grid.getSequence()));
+    };
+    grid.onLengthChanged = [this](int length) {
+        audioProcessor.stepSequencerParameters.setLength(getActiveSourceIndex(), length);
+    };
+    addAndMakeVisible(grid);
+
+    // Rate control
+    rateControl.setSourceIndex(getActiveSourceIndex());
+    addAndMakeVisible(rateControl);
+
+    // Length control
+    lengthControl.setSourceIndex(getActiveSourceIndex());
+    addAndMakeVisible(lengthControl);
+
+    // Register as listener on all step sequencer parameters so undo/redo triggers a UI sync
+    for (int i = 0; i < NUM_STEP_SEQUENCERS; ++i) {
+        paramSync.track(audioProcessor.stepSequencerParameters.rate[i]);
+        paramSync.track(audioProcessor.stepSequencerParameters.rateMode[i]);
+        paramSync.track(audioProcessor.stepSequencerParameters.tempoDivision[i]);
+        paramSync.track(audioProcessor.stepSequencerParameters.length[i]);
+    }
+
+    // Restore state
+    syncFromProcessorState();
+}
+
+StepSequencerComponent::~StepSequencerComponent() {
+}
+
+void StepSequencerComponent::timerCallback() {
+    ModulationSourceComponent::timerCallback();
+
+    // Steps aren't parameters, so poll them to pick up undo/redo and loads.
+    syncGridFromProcessor();
+    grid.setCurrentStep(audioProcessor.stepSequencerParameters.getCurrentStep(getActiveSourceIndex()));
+}
+
+void StepSequencerComponent::resized() {
+    ModulationSourceComponent::resized();
+    if (isCollapsed()) return;
+
+    auto bounds = getContentBounds();
+
+    // Bottom row: length + rate controls
+    auto bottomRow = bounds.removeFromBottom(kRateHeight);
+    bounds.removeFromBottom(kRateGap);
+
+    int availW = bottomRow.getWidth() - kRateGap;
+    int lengthW = juce::jmin(kMaxLengthWidth, availW / 2);
+    int rateW = juce::jmin(kMaxRateWidth, availW / 2);
+    int totalW = lengthW + rateW + kRateGap;
+    int leftPad = (bottomRow.getWidth() - totalW) / 2;
+    if (leftPad > 0) bottomRow.removeFromLeft(leftPad);
+    lengthControl.setBounds(bottomRow.removeFromLeft(lengthW));
+    bottomRow.removeFromLeft(kRateGap);
+    rateControl.setBounds(bottomRow.removeFromLeft(rateW));
+
+    grid.setBounds(bounds);
+    setOutlineBounds(grid.getBounds());
+}
+
+void StepSequencerComponent::onActiveSourceChanged(int index) {
+    syncGridColours();
+    syncGridFromProcessor();
+    rateControl.setSourceIndex(index);
+    rateControl.syncFromProcessor();
+    lengthControl.setSourceIndex(index);
+    lengthControl.syncFromProcessor();
+}
+
+void StepSequencerComponent::syncGridFromProcessor() {
+    int idx = getActiveSourceIndex();
+    auto& params = audioProcessor.stepSequencerParameters;
+    grid.setSequence(params.getSequence(idx), params.getLength(idx));
+}
+
+void StepSequencerComponent::syncGridColours() {
+    grid.setAccentColour(getStepSequencerColour(getActiveSourceIndex()));
+}
+
+void StepSequencerComponent::syncFromProcessorState() {
+    ModulationSourceComponent::syncFromProcessorState();
+
+    syncGridColours();
+    syncGridFromProcessor();
+
+    rateControl.setSourceIndex(getActiveSourceIndex());
+    rateControl.syncFromProcessor();
+    lengthControl.setSourceIndex(getActiveSourceIndex());
+    lengthControl.syncFromProcessor();
+}
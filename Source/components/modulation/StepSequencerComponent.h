@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StepSequencerGridComponent.h"
+#include "ModulationRateComponent.h"
+#include "ModulationModeComponent.h"
+#include "../../audio/modulation/StepSequencerState.h"
+#include "ModulationSourceComponent.h"
+#include "../ParameterSyncHelper.h"
+
+class OscirenderAudioProcessor;
+
+// Step sequencer panel: subclass of ModulationSourceComponent that adds a
+// step grid, rate control, and length selector.
+class StepSequencerComponent : public ModulationSourceComponent {
+public:
+    StepSequencerComponent(OscirenderAudioProcessor& processor);
+    ~StepSequencerComponent() override;
+
+    void resized() override;
+    void timerCallback() override;
+
+    static juce::Colour getStepSequencerColour(int index);
+
+    void syncFromProcessorState() override;
+
+protected:
+    void onActiveSourceChanged(int newIndex) override;
+
+private:
+    OscirenderAudioProcessor& audioProcessor;
+
+    StepSequencerGridComponent grid;
+    ModulationRateComponent rateControl;
+    ModulationModeComponent lengthControl;
+
+    // Layout constants
+    static constexpr int kRateHeight  = 48;
+    static constexpr int kRateGap     = 4;
+    static constexpr int kMaxRateWidth   = 130;
+    static constexpr int kMaxLengthWidth = 130;
+
+    ParameterSyncHelper paramSync { [this] { syncFromProcessorState(); } };
+
+    void syncGridFromProcessor();
+    void syncGridColours();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StepSequencerComponent)
+};
@@ -0,0 +1,250 @@
+#include "StepSequencerGridComponent.h"
+#include "../../LookAndFeel.h"
+
+StepSequencerGridComponent::StepSequencerGridComponent() {
+    setColour(backgroundColourId, Colours::veryDark());
+    setColour(gridLineColourId, juce::Colours::white.withAlpha(0.1f));
+    setColour(lineColourId, juce::Colour(0xFFF1FA8C));
+    setColour(fillColourId, juce::Colour(0xFFF1FA8C).withAlpha(0.15f));
+}
+
+void StepSequencerGridComponent::setSequence(const StepSequence& newSequence, int newLength) {
+    if (editing) return;
+    newLength = juce::jlimit(1, seq::kMaxSteps, newLength);
+    if (newLength == length && newSequence.steps == sequence.steps) return;
+    sequence = newSequence;
+    length = newLength;
+    repaint();
+}
+
+void StepSequencerGridComponent::setCurrentStep(int step) {
+    if (step == currentStep) return;
+    currentStep = step;
+    repaint();
+}
+
+void StepSequencerGridComponent::setAccentColour(juce::Colour colour) {
+    setColour(lineColourId, colour);
+    setColour(fillColourId, colour.withAlpha(0.15f));
+    repaint();
+}
+
+// ============================================================================
+// Geometry
+// ============================================================================
+
+juce::Rectangle<float> StepSequencerGridComponent::getStepBounds(int step) const {
+    auto area = getLocalBounds().toFloat().reduced(kPadding);
+    float stepW = area.getWidth() / (float)length;
+    return { area.getX() + stepW * (float)step, area.getY(), stepW, area.getHeight() };
+}
+
+int StepSequencerGridComponent::stepAt(float x) const {
+    auto area = getLocalBounds().toFloat().reduced(kPadding);
+    if (area.getWidth() <= 0.0f) return 0;
+    int step = (int)std::floor((x - area.getX()) / area.getWidth() * (float)length);
+    return juce::jlimit(0, length - 1, step);
+}
+
+float StepSequencerGridComponent::valueAt(float y) const {
+    auto area = getLocalBounds().toFloat().reduced(kPadding);
+    if (area.getHeight() <= 0.0f) return 0.0f;
+    return juce::jlimit(0.0f, 1.0f, 1.0f - (y - area.getY()) / area.getHeight());
+}
+
+// ============================================================================
+// Painting
+// ============================================================================
+
+void StepSequencerGridComponent::paint(juce::Graphics& g) {
+    auto bounds = getLocalBounds().toFloat();
+
+    if (cornerRadius > 0) {
+        juce::Path clip;
+        clip.addRoundedRectangle(bounds, cornerRadius);
+        g.reduceClipRegion(clip);
+    }
+
+    g.setColour(findColour(backgroundColourId));
+    g.fillRect(bounds);
+
+    // Quarter lines, and a divider every four steps
+    auto gridColour = findColour(gridLineColourId);
+    g.setColour(gridColour.withMultipliedAlpha(0.5f));
+    g.drawHorizontalLine(getHeight() / 4, 0.0f, bounds.getWidth());
+    g.drawHorizontalLine(3 * getHeight() / 4, 0.0f, bounds.getWidth());
+    g.setColour(gridColour);
+    g.drawHorizontalLine(getHeight() / 2, 0.0f, bounds.getWidth());
+    for (int i = 4; i < length; i += 4)
+        g.drawVerticalLine((int)getStepBounds(i).getX(), 0.0f, bounds.getHeight());
+
+    auto lineColour = findColour(lineColourId);
+    auto fillColour = findColour(fillColourId);
+
+    for (int i = 0; i < length; ++i) {
+        const auto& step = sequence.steps[(size_t)i];
+        auto cell = getStepBounds(i);
+        auto bar = cell.reduced(kBarGap * 0.5f, 0.0f);
+        float top = cell.getY() + cell.getHeight() * (1.0f - step.value);
+
+        if (i == currentStep) {
+            g.setColour(lineColour.withAlpha(0.12f));
+            g.fillRect(cell);
+        }
+
+        // Steps that rarely play are drawn fainter
+        float alpha = 0.35f + 0.65f * step.probability;
+
+        juce::Path fill;
+        if (step.glide) {
+            // Ramp up from where the previous step left off
+            const auto& prev = sequence.steps[(size_t)((i + length - 1) % length)];
+            float prevTop = cell.getY() + cell.getHeight() * (1.0f - prev.value);
+            fill.startNewSubPath(bar.getX(), bar.getBottom());
+            fill.lineTo(bar.getX(), prevTop);
+            fill.lineTo(bar.getRight(), top);
+            fill.lineTo(bar.getRight(), bar.getBottom());
+            fill.closeSubPath();
+        } else {
+            fill.addRectangle(bar.withTop(top));
+        }
+        g.setColour(fillColour.withMultipliedAlpha(i == currentStep ? 2.0f : 1.0f));
+        g.fillPath(fill);
+
+        g.setColour(lineColour.withAlpha(0.9f * alpha));
+        if (step.glide) {
+            const auto& prev = sequence.steps[(size_t)((i + length - 1) % length)];
+            float prevTop = cell.getY() + cell.getHeight() * (1.0f - prev.value);
+            g.drawLine(bar.getX(), prevTop, bar.getRight(), top, 1.75f);
+        } else {
+            g.fillRect(bar.withTop(top).withHeight(1.75f));
+        }
+
+        if (step.probability < 1.0f && cell.getWidth() > 14.0f) {
+            g.setColour(juce::Colours::white.withAlpha(0.6f));
+            g.setFont(juce::FontOptions(9.0f));
+            g.drawText(juce::String(juce::roundToInt(step.probability * 100.0f)) + "%",
+                       cell.withTrimmedBottom(2.0f).toNearestInt(), juce::Justification::centredBottom, false);
+        }
+    }
+}
+
+// ============================================================================
+// Editing
+// ============================================================================
+
+void StepSequencerGridComponent::beginEdit() {
+    if (editing) return;
+    editing = true;
+    sequenceBeforeEdit = sequence;
+}
+
+void StepSequencerGridComponent::endEdit() {
+    if (!editing) return;
+    editing = false;
+    if (sequenceBeforeEdit.steps != sequence.steps && onEditFinished)
+        onEditFinished(sequenceBeforeEdit);
+}
+
+void StepSequencerGridComponent::setStepValue(int step, float value) {
+    auto& s = sequence.steps[(size_t)step];
+    if (s.value == value) return;
+    s.value = value;
+    if (onSequenceChanged) onSequenceChanged(sequence);
+    repaint();
+}
+
+void StepSequencerGridComponent::mouseDown(const juce::MouseEvent& e) {
+    int step = stepAt((float)e.x);
+
+    if (e.mods.isPopupMenu()) {
+        showStepMenu(step);
+        return;
+    }
+
+    beginEdit();
+    if (e.mods.isAltDown()) {
+        auto& s = sequence.steps[(size_t)step];
+        s.glide = !s.glide;
+        if (onSequenceChanged) onSequenceChanged(sequence);
+        repaint();
+        lastDragStep = -1;
+        return;
+    }
+
+    lastDragStep = step;
+    lastDragValue = valueAt((float)e.y);
+    setStepValue(step, lastDragValue);
+}
+
+void StepSequencerGridComponent::mouseDrag(const juce::MouseEvent& e) {
+    if (!editing || lastDragStep < 0) return;
+
+    // Fill every step crossed since the last event, so fast drags draw a
+    // continuous line rather than skipping bars.
+    int step = stepAt((float)e.x);
+    float value = valueAt((float)e.y);
+    int dir = step > lastDragStep ? 1 : -1;
+    for (int i = lastDragStep; i != step; i += dir) {
+        float t = (float)(i - lastDragStep) / (float)(step - lastDragStep);
+        setStepValue(i, lastDragValue + t * (value - lastDragValue));
+    }
+    setStepValue(step, value);
+
+    lastDragStep = step;
+    lastDragValue = value;
+}
+
+void StepSequencerGridComponent::mouseUp(const juce::MouseEvent&) {
+    lastDragStep = -1;
+    endEdit();
+}
+
+void StepSequencerGridComponent::mouseDoubleClick(const juce::MouseEvent& e) {
+    if (e.mods.isPopupMenu() || e.mods.isAltDown()) return;
+    int step = stepAt((float)e.x);
+    beginEdit();
+    sequence.steps[(size_t)step] = SequencerStep();
+    if (onSequenceChanged) onSequenceChanged(sequence);
+    repaint();
+    endEdit();
+}
+
+void StepSequencerGridComponent::showStepMenu(int step) {
+    const auto& s = sequence.steps[(size_t)step];
+
+    juce::PopupMenu probability;
+    for (int percent : { 100, 75, 50, 25, 10 })
+        probability.addItem(100 + percent, juce::String(percent) + "%", true,
+                            juce::roundToInt(s.probability * 100.0f) == percent);
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Step " + juce::String(step + 1));
+    menu.addItem(1, "Glide", true, s.glide);
+    menu.addSubMenu("Probability", probability);
+    menu.addSeparator();
+    menu.addItem(2, "End sequence here", step + 1 != length);
+    menu.addItem(3, "Reset step");
+
+    auto safeThis = juce::Component::SafePointer<StepSequencerGridComponent>(this);
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this).withMousePosition(),
+        [safeThis, step](int result) {
+            if (safeThis == nullptr || result == 0) return;
+            if (result == 2) {
+                if (safeThis->onLengthChanged) safeThis->onLengthChanged(step + 1);
+                return;
+            }
+
+            safeThis->beginEdit();
+            auto& edited = safeThis->sequence.steps[(size_t)step];
+            if (result == 1)
+                edited.glide = !edited.glide;
+            else if (result == 3)
+                edited = SequencerStep();
+            else if (result > 100)
+                edited.probability = (float)(result - 100) / 100.0f;
+            if (safeThis->onSequenceChanged) safeThis->onSequenceChanged(safeThis->sequence);
+            safeThis->repaint();
+            safeThis->endEdit();
+        });
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../audio/modulation/StepSequencerState.h"
+
+// Bar editor for one step sequence. Drag across the bars to draw values,
+// alt-click a step to toggle glide, and right-click for probability and
+// length. Uses the same colour IDs as RandomGraphComponent.
+class StepSequencerGridComponent : public juce::Component {
+public:
+    StepSequencerGridComponent();
+    ~StepSequencerGridComponent() override = default;
+
+    void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent& e) override;
+    void mouseDrag(const juce::MouseEvent& e) override;
+    void mouseUp(const juce::MouseEvent& e) override;
+    void mouseDoubleClick(const juce::MouseEvent& e) override;
+
+    // Show a sequence. Ignored while the user is editing.
+    void setSequence(const StepSequence& sequence, int length);
+    const StepSequence& getSequence() const { return sequence; }
+
+    // Highlight the step that's playing.
+    void setCurrentStep(int step);
+
+    // Set the accent colour for the bars.
+    void setAccentColour(juce::Colour colour);
+
+    // Set the corner radius for rounded clipping.
+    void setCornerRadius(float r) { cornerRadius = r; repaint(); }
+
+    // Called with each change to the steps.
+    std::function<void(const StepSequence&)> onSequenceChanged;
+    // Called once an edit is finished with the sequence from before it, so
+    // the edit can be recorded for undo.
+    std::function<void(const StepSequence& before)> onEditFinished;
+    // Called when "End sequence here" is picked from the step menu.
+    std::function<void(int length)> onLengthChanged;
+
+    enum ColourIds {
+        backgroundColourId = 0x7002000,
+        gridLineColourId   = 0x7002001,
+        lineColourId       = 0x7002002,
+        fillColourId       = 0x7002003,
+    };
+
+private:
+    StepSequence sequence;
+    StepSequence sequenceBeforeEdit;
+    int length = seq::kDefaultLength;
+    int currentStep = -1;
+    bool editing = false;
+    int lastDragStep = -1;
+    float lastDragValue = 0.0f;
+    float cornerRadius = 6.0f;
+
+    static constexpr float kBarGap = 1.0f;
+    static constexpr float kPadding = 2.0f;
+
+    juce::Rectangle<float> getStepBounds(int step) const;
+    int stepAt(float x) const;
+    float valueAt(float y) const;
+
+    void beginEdit();
+    void endEdit();
+    void setStepValue(int step, float value);
+    void showStepMenu(int step);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StepSequencerGridComponent)
+};
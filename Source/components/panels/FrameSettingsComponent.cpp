@@ -22,6 +22,7 @@ FrameSettingsComponent::FrameSettingsComponent(OscirenderAudioProcessor& p, Osci
 	addAndMakeVisible(invertImage);
 	addAndMakeVisible(threshold);
 	addAndMakeVisible(stride);
+	addChildComponent(hiddenLines);
 
 	rateLabel.setText("Frames per Second", juce::dontSendNotification);
 	rateBox.setJustification(juce::Justification::left);
@@ -134,6 +135,14 @@ void FrameSettingsComponent::resized() {
         secondColumnHeight += rowHeight; // Stride row
     }
     
+    if (object) {
+        firstColumn.removeFromTop(5);
+        firstColumnHeight += 5; // Spacing
+
+        hiddenLines.setBounds(firstColumn.removeFromTop(rowHeight));
+        firstColumnHeight += rowHeight; // Hidden lines toggle row
+    }
+    
     // Add the taller of the two columns (they're side by side)
     heightUsed += juce::jmax(firstColumnHeight, secondColumnHeight);
     
@@ -180,6 +189,11 @@ void FrameSettingsComponent::setImage(bool image) {
     stride.setVisible(image);
 }
 
+void FrameSettingsComponent::setObject(bool object) {
+    this->object = object;
+    hiddenLines.setVisible(object);
+}
+
 int FrameSettingsComponent::getPreferredHeight() const {
     // Return cached height calculated during resized()
     // If not yet calculated (cachedPreferredHeight == 0), return a reasonable default
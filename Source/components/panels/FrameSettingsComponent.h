@@ -19,6 +19,7 @@ public:
     void update();
     void setAnimated(bool animated);
     void setImage(bool image);
+    void setObject(bool object);
     int getPreferredHeight() const;
     
 private:
@@ -27,6 +28,7 @@ private:
     
     bool animated = true;
     bool image = true;
+    bool object = false;
     
     // Cached preferred height calculated during resized()
     mutable int cachedPreferredHeight = 0;
@@ -42,5 +44,7 @@ private:
     EffectComponent threshold{*audioProcessor.imageThreshold};
     EffectComponent stride{*audioProcessor.imageStride};
 
+    jux::SwitchButton hiddenLines{audioProcessor.hiddenLineRemoval};
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameSettingsComponent)
 };
@@ -113,6 +113,10 @@ SettingsComponent::SettingsComponent(OscirenderAudioProcessor& p, OscirenderAudi
         addAndMakeVisible(*random);
         random->onDragActiveChanged = dragChanged;
 
+        stepSequencer = std::make_unique<StepSequencerComponent>(p);
+        addAndMakeVisible(*stepSequencer);
+        stepSequencer->onDragActiveChanged = dragChanged;
+
         sidechain = std::make_unique<SidechainComponent>(p);
         addAndMakeVisible(*sidechain);
         sidechain->onDragActiveChanged = dragChanged;
@@ -141,6 +145,7 @@ SettingsComponent::SettingsComponent(OscirenderAudioProcessor& p, OscirenderAudi
         lfo->onUncollapseRequested = uncollapse;
         envelope.onUncollapseRequested = uncollapse;
         random->onUncollapseRequested = uncollapse;
+        stepSequencer->onUncollapseRequested = uncollapse;
         sidechain->onUncollapseRequested = uncollapse;
 
         // Auto-uncollapse and select LFO tab when an LFO assignment is added
@@ -504,18 +509,21 @@ void SettingsComponent::layoutChildren() {
         lfo->setCollapsed(modPanelCollapsed);
         envelope.setCollapsed(modPanelCollapsed);
         random->setCollapsed(modPanelCollapsed);
+        stepSequencer->setCollapsed(modPanelCollapsed);
         sidechain->setCollapsed(modPanelCollapsed);
 
-        // --- Bottom modulation panel: LFO | Envelope | Random | Sidechain in a row ---
+        // --- Bottom modulation panel: LFO | Envelope | Random | Step Sequencer | Sidechain in a row ---
         static constexpr int kMaxRandW = 250;
+        static constexpr int kMaxSeqW = 300;
         static constexpr int kMaxScW = 200;
         static constexpr int kMinScW = 130;
 
-        int numGaps = midiOn ? 3 : 2;
+        int numGaps = midiOn ? 4 : 3;
         int totalW = bottomArea.getWidth() - kGap * numGaps;
-        int randW = juce::jmin(kMaxRandW, totalW * 25 / 100);
+        int randW = juce::jmin(kMaxRandW, totalW * 20 / 100);
+        int seqW = juce::jmin(kMaxSeqW, totalW * 20 / 100);
         int scW = juce::jlimit(kMinScW, kMaxScW, totalW * 15 / 100);
-        int flexW = totalW - randW - scW;
+        int flexW = totalW - randW - seqW - scW;
         int lfoW, envW;
         if (midiOn) {
             lfoW = flexW / 2;
@@ -539,6 +547,8 @@ void SettingsComponent::layoutChildren() {
 
         random->setBounds(modRow.removeFromLeft(randW));
         modRow.removeFromLeft(kGap);
+        stepSequencer->setBounds(modRow.removeFromLeft(seqW));
+        modRow.removeFromLeft(kGap);
         sidechain->setBounds(modRow.removeFromLeft(scW));
 
         if (isVisible() && getWidth() > 0 && getHeight() > 0) {
@@ -575,10 +585,12 @@ void SettingsComponent::fileUpdated(juce::String fileName) {
     fractalEditor.setVisible(false);
 #endif
 
-    // Check if the file is an image based on extension or Syphon/Spout input
+    // Check if the file is an image based on extension or live (Syphon/Spout or ffmpeg) input
     bool isSyphonActive = false;
 #if (JUCE_MAC || JUCE_WINDOWS) && OSCI_PREMIUM
     isSyphonActive = audioProcessor.syphonInputActive;
+#elif JUCE_LINUX && OSCI_PREMIUM
+    isSyphonActive = audioProcessor.liveVideoInputActive;
 #endif
 
     bool isImage = isSyphonActive ||
@@ -609,6 +621,13 @@ void SettingsComponent::fileUpdated(juce::String fileName) {
         frame.setVisible(true);
         frame.setAnimated(extension == ".gpla" || extension == ".gif" || extension == ".mov" || extension == ".mp4");
         frame.setImage(isImage);
+        frame.setObject(false);
+        frame.resized();
+    } else if (extension == ".obj") {
+        frame.setVisible(true);
+        frame.setAnimated(false);
+        frame.setImage(false);
+        frame.setObject(true);
         frame.resized();
     }
     fileControls.updateFileLabel();
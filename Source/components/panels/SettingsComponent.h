@@ -21,6 +21,7 @@
 #include "../modulation/LfoComponent.h"
 #include "../modulation/RandomComponent.h"
 #include "../modulation/SidechainComponent.h"
+#include "../modulation/StepSequencerComponent.h"
 
 class OscirenderAudioProcessorEditor;
 class SettingsComponent : public juce::Component, public juce::AudioProcessorParameter::Listener, public juce::ChangeListener, private juce::Timer {
@@ -59,6 +60,7 @@ private:
     std::unique_ptr<LfoComponent> lfo;
     std::unique_ptr<RandomComponent> random;
     std::unique_ptr<SidechainComponent> sidechain;
+    std::unique_ptr<StepSequencerComponent> stepSequencer;
     ScrollFadeViewport keyboardViewport;
     juce::CustomMidiKeyboardComponent keyboard;
 
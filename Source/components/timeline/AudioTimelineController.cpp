@@ -66,3 +66,18 @@ void AudioTimelineController::setup(
         setPlayingCallback(false);
     }
 }
+
+WaveformThumbnail* AudioTimelineController::getThumbnail()
+{
+    return &audioProcessor.audioFileThumbnail;
+}
+
+void AudioTimelineController::onSelectionChanged(juce::Range<double> range)
+{
+    audioProcessor.wavParser.setLoopRange(range);
+}
+
+juce::Range<double> AudioTimelineController::getSelection()
+{
+    return audioProcessor.wavParser.getLoopRange();
+}
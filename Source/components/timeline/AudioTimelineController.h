@@ -24,6 +24,9 @@ public:
         std::function<void(double)> setValueCallback,
         std::function<void(bool)> setPlayingCallback,
         std::function<void(bool)> setRepeatCallback) override;
+    WaveformThumbnail* getThumbnail() override;
+    void onSelectionChanged(juce::Range<double> range) override;
+    juce::Range<double> getSelection() override;
 
 private:
     CommonAudioProcessor& audioProcessor;
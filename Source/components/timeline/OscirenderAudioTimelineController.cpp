@@ -86,3 +86,33 @@ void OscirenderAudioTimelineController::setup(
         setPlayingCallback(false);
     }
 }
+
+WaveformThumbnail* OscirenderAudioTimelineController::getThumbnail()
+{
+    auto wav = getWavParser();
+    if (wav != thumbnailWav.lock()) {
+        thumbnailWav = wav;
+        if (wav != nullptr) {
+            auto block = audioProcessor.getFileBlock(audioProcessor.getCurrentFileIndex());
+            auto& processor = audioProcessor;
+            thumbnail.setSource(block, [&processor, block] { return processor.getFileHash(block); });
+        } else {
+            thumbnail.clear();
+        }
+    }
+    return &thumbnail;
+}
+
+void OscirenderAudioTimelineController::onSelectionChanged(juce::Range<double> range)
+{
+    auto wav = getWavParser();
+    if (wav != nullptr) {
+        wav->setLoopRange(range);
+    }
+}
+
+juce::Range<double> OscirenderAudioTimelineController::getSelection()
+{
+    auto wav = getWavParser();
+    return wav != nullptr ? wav->getLoopRange() : juce::Range<double>();
+}
@@ -24,11 +24,18 @@ public:
         std::function<void(double)> setValueCallback,
         std::function<void(bool)> setPlayingCallback,
         std::function<void(bool)> setRepeatCallback) override;
+    WaveformThumbnail* getThumbnail() override;
+    void onSelectionChanged(juce::Range<double> range) override;
+    juce::Range<double> getSelection() override;
 
 private:
     OscirenderAudioProcessor& audioProcessor;
     
     std::shared_ptr<WavParser> getWavParser();
+
+    // Peaks of the current file, rebuilt when the file's parser changes.
+    WaveformThumbnail thumbnail { audioProcessor.applicationFolder.getChildFile("Waveform Cache") };
+    std::weak_ptr<WavParser> thumbnailWav;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscirenderAudioTimelineController)
 };
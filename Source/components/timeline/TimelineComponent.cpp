@@ -11,6 +11,14 @@ TimelineComponent::TimelineComponent()
     slider.setColour(juce::Slider::ColourIds::trackColourId, juce::Colours::white.withAlpha(0.8f));
     slider.setColour(juce::Slider::ColourIds::backgroundColourId, juce::Colours::white.withAlpha(0.2f));
     slider.setColour(juce::Slider::ColourIds::thumbColourId, juce::Colours::white);
+
+    addAndMakeVisible(waveform);
+    waveform.onSeek = [this](double value) {
+        slider.setValue(value, juce::sendNotification);
+    };
+    waveform.onSelectionChanged = [this](juce::Range<double> range) {
+        if (controller) controller->onSelectionChanged(range);
+    };
     
     addChildComponent(playButton);
     addChildComponent(pauseButton);
@@ -113,6 +121,7 @@ void TimelineComponent::resized()
     repeatButton.setBounds(r.removeFromRight(25));
 
     slider.setBounds(r);
+    waveform.setBounds(r);
 }
 
 void TimelineComponent::setController(std::shared_ptr<TimelineController> newController)
@@ -131,6 +140,11 @@ void TimelineComponent::setController(std::shared_ptr<TimelineController> newCon
         };
         
         controller->setup(setValueCallback, setPlayingCallback, setRepeatCallback);
+        waveform.setThumbnail(controller->getThumbnail());
+        waveform.setSelection(controller->getSelection());
+    } else {
+        waveform.setThumbnail(nullptr);
+        waveform.setSelection({});
     }
 }
 
@@ -139,5 +153,10 @@ void TimelineComponent::timerCallback()
     if (controller) {
         double position = controller->getCurrentPosition();
         setValue(position, juce::dontSendNotification);
+
+        // The controller's source can change under it, e.g. a new file.
+        waveform.setThumbnail(controller->getThumbnail());
+        waveform.refresh();
+        waveform.setSelection(controller->getSelection());
     }
 }
@@ -4,6 +4,7 @@
 #include "TimelineLookAndFeel.h"
 #include "../SvgButton.h"
 #include "TimelineController.h"
+#include "WaveformDisplayComponent.h"
 
 class TimelineComponent : public juce::Component, public juce::Timer {
 public:
@@ -32,6 +33,7 @@ private:
     
     TimelineLookAndFeel timelineLookAndFeel;
     juce::Slider slider;
+    WaveformDisplayComponent waveform;
     SvgButton playButton{"Play", BinaryData::play_svg, juce::Colours::white, juce::Colours::white};
     SvgButton pauseButton{"Pause", BinaryData::pause_svg, juce::Colours::white, juce::Colours::white};
     SvgButton stopButton{"Stop", BinaryData::stop_svg, juce::Colours::white, juce::Colours::white};
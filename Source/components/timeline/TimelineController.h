@@ -2,6 +2,8 @@
 
 #include <JuceHeader.h>
 
+class WaveformThumbnail;
+
 /**
  * Interface for controlling timeline behavior.
  * Different implementations can provide specific behavior for audio playback,
@@ -63,4 +65,21 @@ public:
         std::function<void(double)> setValueCallback,
         std::function<void(bool)> setPlayingCallback,
         std::function<void(bool)> setRepeatCallback) = 0;
+
+    /**
+     * Returns the waveform of what this controller plays, or nullptr if it
+     * has none (e.g. animation frames). Called periodically, so it may change.
+     */
+    virtual WaveformThumbnail* getThumbnail() { return nullptr; }
+
+    /**
+     * Called when the user selects the region to loop and render.
+     * @param range Normalized range, or an empty range to clear the selection
+     */
+    virtual void onSelectionChanged(juce::Range<double> range) { juce::ignoreUnused(range); }
+
+    /**
+     * Returns the current selection, or an empty range if there is none.
+     */
+    virtual juce::Range<double> getSelection() { return {}; }
 };
@@ -0,0 +1,131 @@
+#include "WaveformDisplayComponent.h"
+#include "../../LookAndFeel.h"
+
+WaveformDisplayComponent::WaveformDisplayComponent()
+{
+    setInterceptsMouseClicks(false, false);
+    setTooltip("Shift-drag to select a region to loop and render. Double-click to clear it.");
+}
+
+void WaveformDisplayComponent::setThumbnail(WaveformThumbnail* newThumbnail)
+{
+    if (newThumbnail == thumbnail) return;
+    thumbnail = newThumbnail;
+    shownVersion = 0;
+    refresh();
+}
+
+void WaveformDisplayComponent::refresh()
+{
+    const uint64_t version = thumbnail != nullptr ? thumbnail->getPeaks().getVersion() : 0;
+    if (version == shownVersion) return;
+    shownVersion = version;
+
+    bool hasPeaks = false;
+    if (thumbnail != nullptr) {
+        VersionedSnapshot<WaveformPeaks>::Reader peaks(thumbnail->getPeaks());
+        hasPeaks = !peaks->isEmpty();
+    }
+    // Leave the slider underneath in charge until there's something to show.
+    setInterceptsMouseClicks(hasPeaks, false);
+    repaint();
+}
+
+void WaveformDisplayComponent::setSelection(juce::Range<double> range)
+{
+    if (!selecting) showSelection(range);
+}
+
+void WaveformDisplayComponent::showSelection(juce::Range<double> range)
+{
+    if (range == selection) return;
+    selection = range;
+    repaint();
+}
+
+double WaveformDisplayComponent::proportionAt(float x) const
+{
+    if (getWidth() <= 0) return 0.0;
+    return juce::jlimit(0.0, 1.0, (double) x / getWidth());
+}
+
+void WaveformDisplayComponent::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+
+    if (thumbnail != nullptr) {
+        VersionedSnapshot<WaveformPeaks>::Reader peaks(thumbnail->getPeaks());
+        if (!peaks->isEmpty()) {
+            peaks->getColumns(0.0, 1.0, getWidth(), columns);
+
+            const float laneHeight = bounds.getHeight() * 0.5f;
+            const float xCentre = bounds.getY() + laneHeight * 0.5f;
+            const float yCentre = xCentre + laneHeight;
+            const float scale = laneHeight * 0.5f;
+            const bool tinted = peaks->hasColour();
+
+            auto drawExtent = [&](float x, float centre, float lo, float hi) {
+                float top = centre - juce::jlimit(-1.0f, 1.0f, hi) * scale;
+                float bottom = centre - juce::jlimit(-1.0f, 1.0f, lo) * scale;
+                g.fillRect(x, top, 1.0f, juce::jmax(1.0f, bottom - top));
+            };
+
+            for (int x = 0; x < (int) columns.size(); ++x) {
+                const auto& column = columns[(size_t) x];
+                if (column.numSamples == 0) continue;
+                g.setColour((tinted ? column.getColour() : juce::Colours::white).withAlpha(0.3f));
+                drawExtent((float) x, xCentre, column.minX, column.maxX);
+                drawExtent((float) x, yCentre, column.minY, column.maxY);
+            }
+        }
+    }
+
+    if (!selection.isEmpty()) {
+        auto left = (float) (selection.getStart() * bounds.getWidth());
+        auto right = (float) (selection.getEnd() * bounds.getWidth());
+        auto accent = Colours::accentColor();
+        g.setColour(accent.withAlpha(0.2f));
+        g.fillRect(left, bounds.getY(), right - left, bounds.getHeight());
+        g.setColour(accent.withAlpha(0.8f));
+        g.drawVerticalLine((int) left, bounds.getY(), bounds.getBottom());
+        g.drawVerticalLine((int) right, bounds.getY(), bounds.getBottom());
+    }
+}
+
+void WaveformDisplayComponent::mouseDown(const juce::MouseEvent& e)
+{
+    const double position = proportionAt((float) e.x);
+    selecting = e.mods.isShiftDown();
+    if (selecting) {
+        selectionAnchor = position;
+        showSelection({ position, position });
+    } else if (onSeek) {
+        onSeek(position);
+    }
+}
+
+void WaveformDisplayComponent::mouseDrag(const juce::MouseEvent& e)
+{
+    const double position = proportionAt((float) e.x);
+    if (selecting) {
+        showSelection(juce::Range<double>::between(selectionAnchor, position));
+    } else if (onSeek) {
+        onSeek(position);
+    }
+}
+
+void WaveformDisplayComponent::mouseUp(const juce::MouseEvent&)
+{
+    if (!selecting) return;
+    selecting = false;
+    if (selection.getLength() < kMinSelection) {
+        showSelection({});
+    }
+    if (onSelectionChanged) onSelectionChanged(selection);
+}
+
+void WaveformDisplayComponent::mouseDoubleClick(const juce::MouseEvent&)
+{
+    setSelection({});
+    if (onSelectionChanged) onSelectionChanged(selection);
+}
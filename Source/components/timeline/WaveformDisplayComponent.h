@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../audio/wav/WaveformThumbnail.h"
+
+// Draws a WaveformThumbnail across the timeline, X in the top half and Y in
+// the bottom half, tinted by the file's colour channels if it has them.
+//
+// Sits over the timeline slider. Once peaks are available it takes the
+// mouse: dragging seeks, shift-dragging selects a region to loop and render,
+// and double-clicking clears the selection.
+class WaveformDisplayComponent : public juce::Component, public juce::SettableTooltipClient {
+public:
+    WaveformDisplayComponent();
+    ~WaveformDisplayComponent() override = default;
+
+    void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent& e) override;
+    void mouseDrag(const juce::MouseEvent& e) override;
+    void mouseUp(const juce::MouseEvent& e) override;
+    void mouseDoubleClick(const juce::MouseEvent& e) override;
+
+    void setThumbnail(WaveformThumbnail* thumbnail);
+    // Repaints if new peaks have been published since the last call.
+    void refresh();
+
+    // Ignored while the user is dragging out a selection.
+    void setSelection(juce::Range<double> range);
+    juce::Range<double> getSelection() const { return selection; }
+
+    std::function<void(double)> onSeek;
+    std::function<void(juce::Range<double>)> onSelectionChanged;
+
+private:
+    double proportionAt(float x) const;
+    void showSelection(juce::Range<double> range);
+
+    WaveformThumbnail* thumbnail = nullptr;
+    uint64_t shownVersion = 0;
+    std::vector<PeakBucket> columns;
+
+    juce::Range<double> selection;
+    double selectionAnchor = 0.0;
+    bool selecting = false;
+
+    // Selections narrower than this are treated as a click that clears it.
+    static constexpr double kMinSelection = 0.002;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformDisplayComponent)
+};
@@ -6,6 +6,7 @@
 // If not, use the luajit_win.bat or luajit_linux_macos.sh scripts in the git root from the dev environment.
 #include <lua.hpp>
 #include <cstring>
+#include <cctype>
 
 std::function<void(const std::string&)> LuaParser::onPrint;
 std::function<void()> LuaParser::onClear;
@@ -27,25 +28,57 @@ LuaParser::LuaParser(juce::String fileName, juce::String script, std::function<v
     // Pre-allocate to avoid audio-thread heap allocation when voices first call run().
     // 32 covers 16 ShapeVoice + 16 CustomEffect lua_State pointers.
     seenStates.reserve(32);
+
+    // Compile once here, off the audio thread. If the script doesn't compile
+    // there's no chunk and run() reports the error the usual way.
+    chunk = statePool->getChunk(script);
+    if (chunk != nullptr) {
+        detectUsedVariables(script);
+    }
 }
 
 void LuaParser::reset(lua_State*& L, juce::String script) {
     functionRef = -1;
 
     if (L != nullptr) {
-        seenStates.erase(std::remove(seenStates.begin(), seenStates.end(), L), seenStates.end());
-        if (lastSeenState == L) lastSeenState = nullptr;
-        lua_close(L);
+        seenStates.erase(std::remove_if(seenStates.begin(), seenStates.end(), [L](auto& state) { return state.L == L; }), seenStates.end());
+        lastSeenState = nullptr;
+        statePool->retire(L);
+        L = nullptr;
     }
-    
+
+    this->script = script;
+
+    if (chunk != nullptr && !usingFallbackScript) {
+        L = statePool->lease(*chunk);
+        if (L != nullptr) {
+            functionRef = chunk->getFunctionRef();
+            return;
+        }
+    }
+
+    // No ready state - build one here.
     L = luaL_newstate();
     luaL_openlibs(L);
 	luaopen_oscilibrary(L);
-    
-    this->script = script;
+
     parse(L);
 }
 
+LuaParser::StateGlobals& LuaParser::findOrAddState(lua_State* L) {
+    if (L != lastSeenState || lastSeenIndex < 0) {
+        auto it = std::find_if(seenStates.begin(), seenStates.end(), [L](auto& state) { return state.L == L; });
+        if (it == seenStates.end()) {
+            seenStates.push_back({});
+            seenStates.back().L = L;
+            it = seenStates.end() - 1;
+        }
+        lastSeenState = L;
+        lastSeenIndex = (int) (it - seenStates.begin());
+    }
+    return seenStates[lastSeenIndex];
+}
+
 void LuaParser::reportError(const char* errorChars) {
     std::string error = errorChars;
     std::regex nilRegex = std::regex(R"(attempt to.*nil value.*'slider_\w')");
@@ -67,6 +100,7 @@ void LuaParser::reportError(const char* errorChars) {
         int line = std::stoi(lineMatch[1]);
         // remove line number from error message
         error = std::regex_replace(error, lineRegex, "");
+        errorShown = true;
         errorCallback(line, fileName, error);
     }
 }
@@ -88,12 +122,75 @@ void LuaParser::detectUsedVariables(const juce::String& scriptText) {
     uint64_t mask = 0;
     auto text = scriptText.toRawUTF8();
 
-    // If script uses dynamic global access or loads external code, conservatively enable all variables
-    if (strstr(text, "_G") || strstr(text, "getfenv") || strstr(text, "rawget")
-        || strstr(text, "require") || strstr(text, "dofile") || strstr(text, "loadfile")) {
-        usedVarMask = ~uint64_t(0);
-        return;
+    // If script uses dynamic global access or turns strings into code, conservatively enable all variables.
+    // "load" also catches loadstring and loadfile, and "debug" catches debug.setfenv and debug.getregistry.
+    static const char* const dynamicAccess[] = {
+        "_G", "getfenv", "setfenv", "rawget", "rawset", "debug", "require", "dofile", "load",
+    };
+    for (auto* name : dynamicAccess) {
+        if (strstr(text, name)) {
+            usedVarMask = ~uint64_t(0);
+            writtenVarMask = ~uint64_t(0);
+            return;
+        }
+    }
+
+    // Looks for `name =` with name as a whole identifier, including anywhere
+    // in a name list such as `x, y = y, x`. `local name =` and lists that turn
+    // out not to be assignments also match, which only means the variable is
+    // pushed more often than needed.
+    auto assigns = [text](const char* name) {
+        const size_t length = strlen(name);
+        for (const char* p = strstr(text, name); p != nullptr; p = strstr(p + 1, name)) {
+            if (p > text && (isalnum((unsigned char) p[-1]) || p[-1] == '_' || p[-1] == '.' || p[-1] == ':'))
+                continue;
+            const char* q = p + length;
+            if (isalnum((unsigned char) *q) || *q == '_')
+                continue;
+            while (isspace((unsigned char) *q))
+                q++;
+            // Skip the rest of the name list up to its `=`.
+            while (*q == ',') {
+                q++;
+                while (isspace((unsigned char) *q))
+                    q++;
+                while (isalnum((unsigned char) *q) || *q == '_' || *q == '.' || *q == '[') {
+                    if (*q == '[') {
+                        while (*q != '\0' && *q != ']')
+                            q++;
+                        if (*q == '\0')
+                            break;
+                    }
+                    q++;
+                }
+                while (isspace((unsigned char) *q))
+                    q++;
+            }
+            if (q[0] == '=' && q[1] != '=')
+                return true;
+        }
+        return false;
+    };
+
+    static const std::pair<LuaVarBit, const char*> namedVars[] = {
+        { LuaVar_step, "step" }, { LuaVar_sampleRate, "sample_rate" }, { LuaVar_frequency, "frequency" },
+        { LuaVar_phase, "phase" }, { LuaVar_cycleCount, "cycle_count" },
+        { LuaVar_x, "x" }, { LuaVar_y, "y" }, { LuaVar_z, "z" }, { LuaVar_extX, "ext_x" }, { LuaVar_extY, "ext_y" },
+        { LuaVar_midiNote, "midi_note" }, { LuaVar_velocity, "velocity" }, { LuaVar_voiceIndex, "voice_index" },
+        { LuaVar_noteOn, "note_on" }, { LuaVar_bpm, "bpm" }, { LuaVar_playTime, "play_time" },
+        { LuaVar_playTimeBeats, "play_time_beats" }, { LuaVar_isPlaying, "is_playing" },
+        { LuaVar_timeSigNum, "time_sig_num" }, { LuaVar_timeSigDen, "time_sig_den" },
+        { LuaVar_envelope, "envelope" }, { LuaVar_envelopeStage, "envelope_stage" },
+    };
+
+    uint64_t written = 0;
+    for (auto& [bit, name] : namedVars) {
+        if (assigns(name)) written |= (1ULL << bit);
     }
+    for (int i = 0; i < NUM_SLIDERS; i++) {
+        if (assigns(SLIDER_NAMES[i])) written |= (1ULL << (LuaVar_sliderFirst + i));
+    }
+    writtenVarMask = written;
 
     if (strstr(text, "step"))               mask |= (1ULL << LuaVar_step);
     if (strstr(text, "sample_rate"))        mask |= (1ULL << LuaVar_sampleRate);
@@ -144,10 +241,17 @@ void LuaParser::setGlobalVariable(lua_State*& L, const char* name, bool value) {
     lua_setglobal(L, name);
 }
 
-void LuaParser::setGlobalVariables(lua_State*& L, LuaVariables& vars) {
+void LuaParser::setGlobalVariables(lua_State*& L, LuaVariables& vars, StateGlobals& globals) {
     auto set = [&](LuaVarBit bit, const char* name, auto value) {
-        if (usedVarMask & (1ULL << bit))
-            setGlobalVariable(L, name, value);
+        const uint64_t flag = 1ULL << bit;
+        if (!(usedVarMask & flag))
+            return;
+        const double asDouble = (double) value;
+        if ((globals.pushedMask & flag) && !(writtenVarMask & flag) && globals.values[bit] == asDouble)
+            return;
+        globals.values[bit] = asDouble;
+        globals.pushedMask |= flag;
+        setGlobalVariable(L, name, value);
     };
 
     set(LuaVar_step,       "step",        vars.step);
@@ -205,8 +309,7 @@ void LuaParser::revertToFallback(lua_State*& L) {
     usingFallbackScript = true;
     if (script != fallbackScript) {
         reset(L, fallbackScript);
-        seenStates.push_back(L);
-        lastSeenState = L;
+        findOrAddState(L);
     }
 }
 
@@ -232,19 +335,19 @@ LuaResult LuaParser::run(lua_State*& L, LuaVariables& vars) {
 
     // if we haven't seen this state before, reset it
     if (L == nullptr || L != lastSeenState) {
-        if (std::find(seenStates.begin(), seenStates.end(), L) == seenStates.end()) {
+        auto it = std::find_if(seenStates.begin(), seenStates.end(), [L](auto& state) { return state.L == L; });
+        if (L == nullptr || it == seenStates.end()) {
             reset(L, script);
-            seenStates.push_back(L);
         }
-        lastSeenState = L;
     }
+    auto& globals = findOrAddState(L);
 
     LuaResult result;
 
     // Reset instruction counter before setting globals and calling pcall.
     setMaximumInstructions(L, 5000000);
 	
-	setGlobalVariables(L, vars);
+	setGlobalVariables(L, vars, globals);
     
 	// Get the function from the registry
 	lua_rawgeti(L, LUA_REGISTRYINDEX, functionRef);
@@ -284,13 +387,17 @@ juce::String LuaParser::getScript() {
 }
 
 void LuaParser::resetErrors() {
+    if (!errorShown) {
+        return;
+    }
+    errorShown = false;
     errorCallback(-1, fileName, "");
 }
 
 void LuaParser::close(lua_State*& L) {
     if (L != nullptr) {
-        seenStates.erase(std::remove(seenStates.begin(), seenStates.end(), L), seenStates.end());
-        if (lastSeenState == L) lastSeenState = nullptr;
-        lua_close(L);
+        seenStates.erase(std::remove_if(seenStates.begin(), seenStates.end(), [L](auto& state) { return state.L == L; }), seenStates.end());
+        lastSeenState = nullptr;
+        statePool->retire(L);
     }
 }
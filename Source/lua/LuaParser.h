@@ -2,6 +2,7 @@
 #include <JuceHeader.h>
 #include <regex>
 #include <numbers>
+#include "LuaStatePool.h"
 
 class ErrorListener {
 public:
@@ -143,6 +144,15 @@ public:
 	static std::function<void()> onClear;
 
 private:
+	// The globals last pushed into a state. Most of them (sliders, transport,
+	// MIDI context) stay the same for a whole block, so run() only pushes the
+	// ones that changed since the previous sample.
+	struct StateGlobals {
+		lua_State* L = nullptr;
+		uint64_t pushedMask = 0;
+		double values[64] = {};
+	};
+
 	static void maximumInstructionsReached(lua_State* L, lua_Debug* D);
 	
 	void reset(lua_State*& L, juce::String script);
@@ -151,13 +161,14 @@ private:
 	void setGlobalVariable(lua_State*& L, const char* name, double value);
 	void setGlobalVariable(lua_State*& L, const char* name, int value);
 	void setGlobalVariable(lua_State*& L, const char* name, bool value);
-	void setGlobalVariables(lua_State*& L, LuaVariables& vars);
+	void setGlobalVariables(lua_State*& L, LuaVariables& vars, StateGlobals& globals);
 	void incrementVars(LuaVariables& vars);
 	void clearStack(lua_State*& L);
 	void revertToFallback(lua_State*& L);
 	void readTable(lua_State*& L, LuaResult& result);
 	void setMaximumInstructions(lua_State*& L, int count);
 	void detectUsedVariables(const juce::String& scriptText);
+	StateGlobals& findOrAddState(lua_State* L);
 
 	int functionRef = -1;
 	bool usingFallbackScript = false;
@@ -165,8 +176,20 @@ private:
 	juce::String fallbackScript;
 	std::function<void(int, juce::String, juce::String)> errorCallback;
 	juce::String fileName;
-	std::vector<lua_State*> seenStates;
+	std::vector<StateGlobals> seenStates;
 	lua_State* lastSeenState = nullptr;
+	int lastSeenIndex = -1;
 	uint64_t usedVarMask = ~uint64_t(0);
+	// Variables the script may assign to itself. These are pushed every sample
+	// so the script never sees its own value in place of the real one.
+	uint64_t writtenVarMask = ~uint64_t(0);
+	// Whether the last thing sent to errorCallback was an error, so clearing
+	// it is only reported once. Starts set so the first successful run clears
+	// any error left by the script this parser replaced.
+	bool errorShown = true;
 	std::atomic<bool> resetRequested{false};
+
+	// Pre-warmed states for the script, leased to voices as they first run it.
+	juce::SharedResourcePointer<LuaStatePool> statePool;
+	std::shared_ptr<LuaStatePool::Chunk> chunk;
 };
@@ -0,0 +1,236 @@
+#include "LuaStatePool.h"
+#include "LuaLibrary.h"
+#include <lua.hpp>
+
+namespace {
+    int writeBytecode(lua_State*, const void* data, size_t size, void* userData) {
+        static_cast<std::string*>(userData)->append(static_cast<const char*>(data), size);
+        return 0;
+    }
+}
+
+LuaStatePool::Chunk::Chunk(LuaStatePool& pool, const juce::String& hash, std::shared_ptr<const std::string> bytecode)
+    : pool(pool), hash(hash), bytecode(std::move(bytecode)) {
+    ready.reserve(kMaxReadyStates);
+}
+
+LuaStatePool::Chunk::~Chunk() {
+    juce::SpinLock::ScopedLockType lock(readyLock);
+    for (auto* L : ready) {
+        pool.retire(L);
+    }
+    ready.clear();
+}
+
+int LuaStatePool::Chunk::getNumReady() const {
+    juce::SpinLock::ScopedLockType lock(readyLock);
+    return (int) ready.size();
+}
+
+LuaStatePool::LuaStatePool() : juce::Thread("Lua State Pool") {
+    startThread();
+}
+
+LuaStatePool::~LuaStatePool() {
+    signalThreadShouldExit();
+    notify();
+    stopThread(2000);
+
+    for (; retiredCount > 0; retiredCount--) {
+        lua_close(retired[retiredHead]);
+        retiredHead = (retiredHead + 1) % retired.size();
+    }
+}
+
+juce::String LuaStatePool::hashScript(const juce::String& script) {
+    auto utf8 = script.toUTF8();
+    return juce::SHA256(utf8.getAddress(), utf8.sizeInBytes() - 1).toHexString();
+}
+
+lua_State* LuaStatePool::createState(const std::string& bytecode, int& functionRef) {
+    lua_State* L = luaL_newstate();
+    if (L == nullptr) {
+        return nullptr;
+    }
+    luaL_openlibs(L);
+    luaopen_oscilibrary(L);
+
+    if (luaL_loadbuffer(L, bytecode.data(), bytecode.size(), "=bytecode") != 0) {
+        lua_close(L);
+        return nullptr;
+    }
+    functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+    return L;
+}
+
+std::shared_ptr<LuaStatePool::Chunk> LuaStatePool::getChunk(const juce::String& script) {
+    const auto hash = hashScript(script);
+    std::shared_ptr<const std::string> bytecode;
+
+    {
+        juce::ScopedLock sl(chunksLock);
+        for (auto& weak : chunks) {
+            if (auto chunk = weak.lock()) {
+                if (chunk->hash == hash) {
+                    return chunk;
+                }
+            }
+        }
+
+        for (auto it = bytecodeCache.begin(); it != bytecodeCache.end(); ++it) {
+            if (it->first == hash) {
+                bytecode = it->second;
+                std::rotate(it, it + 1, bytecodeCache.end());
+                break;
+            }
+        }
+    }
+
+    if (bytecode == nullptr) {
+        // Compile from source with the same chunk name LuaParser uses, so error
+        // messages from the bytecode read the same.
+        lua_State* L = luaL_newstate();
+        if (L == nullptr) {
+            return nullptr;
+        }
+        if (luaL_loadstring(L, script.toUTF8()) != 0) {
+            lua_close(L);
+            return nullptr;
+        }
+        auto dumped = std::make_shared<std::string>();
+        const int ret = lua_dump(L, writeBytecode, dumped.get());
+        lua_close(L);
+        if (ret != 0 || dumped->empty()) {
+            return nullptr;
+        }
+        bytecode = std::move(dumped);
+    }
+
+    std::shared_ptr<Chunk> chunk(new Chunk(*this, hash, bytecode));
+
+    for (int i = 0; i < kMinReadyStates; i++) {
+        int ref = -1;
+        auto* L = createState(*bytecode, ref);
+        if (L == nullptr) {
+            return nullptr;
+        }
+        jassert(chunk->functionRef == -1 || chunk->functionRef == ref);
+        chunk->functionRef = ref;
+        chunk->ready.push_back(L);
+    }
+
+    {
+        juce::ScopedLock sl(chunksLock);
+        chunks.erase(std::remove_if(chunks.begin(), chunks.end(), [](auto& weak) { return weak.expired(); }), chunks.end());
+        chunks.push_back(chunk);
+
+        bytecodeCache.erase(std::remove_if(bytecodeCache.begin(), bytecodeCache.end(), [&](auto& entry) { return entry.first == hash; }), bytecodeCache.end());
+        bytecodeCache.emplace_back(hash, bytecode);
+        if ((int) bytecodeCache.size() > kMaxCachedBytecode) {
+            bytecodeCache.erase(bytecodeCache.begin());
+        }
+    }
+
+    notify();
+    return chunk;
+}
+
+lua_State* LuaStatePool::lease(Chunk& chunk) {
+    lua_State* L = nullptr;
+    {
+        juce::SpinLock::ScopedLockType lock(chunk.readyLock);
+        if (!chunk.ready.empty()) {
+            L = chunk.ready.back();
+            chunk.ready.pop_back();
+        }
+    }
+    if (L == nullptr) {
+        // More voices wanted this script at once than there were states for.
+        chunk.misses++;
+        int target = chunk.targetReady.load();
+        while (target < kMaxReadyStates && !chunk.targetReady.compare_exchange_weak(target, target + 1)) {}
+    }
+    workPending = true;
+    return L;
+}
+
+void LuaStatePool::retire(lua_State* L) {
+    if (L == nullptr) {
+        return;
+    }
+    bool full = false;
+    {
+        juce::SpinLock::ScopedLockType lock(retiredLock);
+        full = retiredCount == retired.size();
+        if (!full) {
+            retired[(retiredHead + retiredCount) % retired.size()] = L;
+            retiredCount++;
+        }
+    }
+    if (full) {
+        // Only if the pool thread has stalled; closing here beats leaking.
+        lua_close(L);
+        return;
+    }
+    workPending = true;
+}
+
+void LuaStatePool::run() {
+    std::vector<lua_State*> toClose;
+    toClose.reserve(kRetireCapacity);
+
+    while (!threadShouldExit()) {
+        workPending = false;
+        {
+            juce::SpinLock::ScopedLockType lock(retiredLock);
+            for (; retiredCount > 0; retiredCount--) {
+                toClose.push_back(retired[retiredHead]);
+                retiredHead = (retiredHead + 1) % retired.size();
+            }
+        }
+        for (auto* L : toClose) {
+            lua_close(L);
+        }
+        toClose.clear();
+
+        // Top up one state at a time so a chunk being released, or the thread
+        // being stopped, is noticed quickly.
+        bool createdAny = false;
+        std::vector<std::shared_ptr<Chunk>> live;
+        {
+            juce::ScopedLock sl(chunksLock);
+            for (auto& weak : chunks) {
+                if (auto chunk = weak.lock()) {
+                    live.push_back(std::move(chunk));
+                }
+            }
+        }
+
+        for (auto& chunk : live) {
+            if (threadShouldExit()) {
+                break;
+            }
+            if (chunk->getNumReady() >= chunk->getTargetReady()) {
+                continue;
+            }
+            int ref = -1;
+            auto* L = createState(*chunk->bytecode, ref);
+            if (L == nullptr || ref != chunk->functionRef) {
+                if (L != nullptr) {
+                    lua_close(L);
+                }
+                continue;
+            }
+            {
+                juce::SpinLock::ScopedLockType lock(chunk->readyLock);
+                chunk->ready.push_back(L);
+            }
+            createdAny = true;
+        }
+        live.clear();
+
+        if (!createdAny && !workPending) {
+            wait(kPollIntervalMs);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <JuceHeader.h>
+
+struct lua_State;
+
+// Keeps ready-to-run Lua states for each script so voices and effect clones
+// don't create and compile a state on the audio thread.
+//
+// Scripts are compiled once and stored as bytecode (lua_dump), keyed by a hash
+// of the source, so reloading the same script or opening it in several places
+// skips the parser. Each compiled script keeps a small stack of pre-warmed
+// states that have the libraries opened and the chunk loaded. The stack
+// starts at kMinReadyStates and grows by one each time a lease finds it
+// empty, so it settles at the most voices the script has started at once. A
+// background thread tops the stack up and closes states that have been
+// retired. The audio thread never wakes it: it sets a flag the thread polls.
+//
+// Share one pool with juce::SharedResourcePointer<LuaStatePool>.
+class LuaStatePool : private juce::Thread {
+public:
+	class Chunk {
+	public:
+		~Chunk();
+
+		// Registry reference of the script's function in every state from this chunk.
+		int getFunctionRef() const { return functionRef; }
+		int getNumReady() const;
+		// How many states the pool thread keeps ready for this chunk.
+		int getTargetReady() const { return targetReady.load(); }
+		// How many leases found no ready state, so the caller built its own.
+		int getNumMisses() const { return misses.load(); }
+
+	private:
+		friend class LuaStatePool;
+		Chunk(LuaStatePool& pool, const juce::String& hash, std::shared_ptr<const std::string> bytecode);
+
+		LuaStatePool& pool;
+		juce::String hash;
+		std::shared_ptr<const std::string> bytecode;
+		int functionRef = -1;
+
+		juce::SpinLock readyLock;
+		std::vector<lua_State*> ready;
+		std::atomic<int> targetReady { kMinReadyStates };
+		std::atomic<int> misses { 0 };
+
+		JUCE_DECLARE_NON_COPYABLE(Chunk)
+	};
+
+	LuaStatePool();
+	~LuaStatePool() override;
+
+	// Returns the compiled chunk for a script, compiling it if no cached
+	// bytecode matches. Returns nullptr if the script doesn't compile. Call this
+	// off the audio thread - the first few states are created before it returns.
+	std::shared_ptr<Chunk> getChunk(const juce::String& script);
+
+	// Takes a ready state for the chunk, or nullptr if none are ready, in
+	// which case the chunk keeps one more ready from then on. Safe to call on
+	// the audio thread.
+	lua_State* lease(Chunk& chunk);
+
+	// Hands a state over to be closed on the pool thread. Safe to call on the
+	// audio thread.
+	void retire(lua_State* L);
+
+	// States kept ready per chunk to begin with, created by getChunk().
+	static constexpr int kMinReadyStates = 2;
+	// Most a chunk grows to. A chunk is shared by every parser running the
+	// same script, so this covers two full 16-voice instruments using it at
+	// once, plus the kill-fade overlap voice.
+	static constexpr int kMaxReadyStates = 33;
+	static constexpr int kMaxCachedBytecode = 32;
+	static constexpr int kRetireCapacity = 256;
+	// How often the pool thread checks for work flagged by the audio thread.
+	static constexpr int kPollIntervalMs = 10;
+
+private:
+	void run() override;
+
+	lua_State* createState(const std::string& bytecode, int& functionRef);
+	static juce::String hashScript(const juce::String& script);
+
+	juce::CriticalSection chunksLock;
+	std::vector<std::weak_ptr<Chunk>> chunks;
+	// Most recently used bytecode last.
+	std::vector<std::pair<juce::String, std::shared_ptr<const std::string>>> bytecodeCache;
+
+	// Retired states waiting to be closed, as a fixed ring so retiring never
+	// allocates.
+	juce::SpinLock retiredLock;
+	std::array<lua_State*, kRetireCapacity> retired {};
+	size_t retiredHead = 0;
+	size_t retiredCount = 0;
+	std::atomic<bool> workPending { false };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LuaStatePool)
+};
@@ -1,36 +1,46 @@
 #include "Camera.h"
 
-Camera::Camera() : frustum(1, 1, 0.001, 100) {
-    viewMatrix = mathter::Identity();
-}
+Camera::Camera() : frustum(1, 1, 0.001, 100), position(0, 0, 0) {}
 
 void Camera::setPosition(Vec3& position) {
-    viewMatrix(0, 3) = -position.x;
-    viewMatrix(1, 3) = -position.y;
-    viewMatrix(2, 3) = -position.z;
+    this->position = position;
+    framedFov = std::numeric_limits<float>::quiet_NaN();
 }
 
 Vec3 Camera::toCameraSpace(Vec3& point) {
-    return viewMatrix * point;
+    return Vec3(point.x - position.x, point.y - position.y, point.z - position.z);
 }
 
 Vec3 Camera::toWorldSpace(Vec3& point) {
-    return mathter::Inverse(viewMatrix) * point;
+    return Vec3(point.x + position.x, point.y + position.y, point.z + position.z);
 }
 
 void Camera::setFov(double fov) {
     frustum.setCameraInternals(fov, frustum.ratio, frustum.nearDistance, frustum.farDistance);
+    framedFov = std::numeric_limits<float>::quiet_NaN();
+}
+
+void Camera::frameUnitSphere(float fov) {
+    if (fov == framedFov) {
+        return;
+    }
+    Vec3 origin = Vec3(0, 0, -1.0f / std::sin(0.5f * fov));
+    setPosition(origin);
+    setFov(fov);
+    framedFov = fov;
 }
 
 Vec3 Camera::project(Vec3& pWorld) {
-    Vec3 p = viewMatrix * pWorld;
+    Vec3 p = toCameraSpace(pWorld);
 
     frustum.clipToFrustum(p);
 
-    float x = p.x * frustum.focalLength / p.z;
-    float y = p.y * frustum.focalLength / p.z;
+    const float scale = frustum.focalLength / p.z;
+    return Vec3(p.x * scale, p.y * scale, 0);
+}
 
-    return Vec3(x, y, 0);
+bool Camera::clipSegment(Vec3& a, Vec3& b, float& t0, float& t1) {
+    return frustum.clipSegment(toCameraSpace(a), toCameraSpace(b), t0, t1);
 }
 
 Frustum Camera::getFrustum() {
@@ -1,10 +1,8 @@
 #pragma once
 
-#include "../../modules/Mathter/include/Mathter/Matrix.hpp"
+#include <limits>
 #include "Frustum.h"
 
-using Matrix = mathter::Matrix<float, 4, 4, mathter::eMatrixOrder::PRECEDE_VECTOR, mathter::eMatrixLayout::ROW_MAJOR, false>;
-
 class Camera {
 public:
 	Camera();
@@ -13,7 +11,16 @@ public:
 	Vec3 toCameraSpace(Vec3& point);
 	Vec3 toWorldSpace(Vec3& point);
 	void setFov(double fov);
+	// Sets the field of view and moves the camera back until the view is
+	// tangent to the unit sphere, as the perspective effect does. Does
+	// nothing if the camera is already framed for this fov, so it's cheap
+	// to call per sample.
+	void frameUnitSphere(float fov);
+	// Clamps p to the frustum and projects it onto the screen.
 	Vec3 project(Vec3& p);
+	// Clips the world space segment from a to b to the frustum, narrowing
+	// [t0, t1]. Returns false if none of it can be seen.
+	bool clipSegment(Vec3& a, Vec3& b, float& t0, float& t1);
 	Frustum getFrustum();
 private:
 	const double VERTEX_VALUE_THRESHOLD = 1.0;
@@ -24,5 +31,7 @@ private:
 
 	Frustum frustum;
 
-	Matrix viewMatrix;
+	// The camera only ever moves, so the view is just this translation
+	Vec3 position;
+	float framedFov = std::numeric_limits<float>::quiet_NaN();
 };
\ No newline at end of file
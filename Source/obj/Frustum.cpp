@@ -35,4 +35,34 @@ void Frustum::clipToFrustum(Vec3 &p) {
 	pcx = pcx < -aux ? -aux : (pcx > aux ? aux : pcx);
 
 	p = Vec3(pcx, pcy, pcz);
-}
\ No newline at end of file
+}
+
+bool Frustum::clipSegment(const Vec3& a, const Vec3& b, float& t0, float& t1) const {
+	const float tangX = tang * ratio;
+
+	// Signed distances to each plane, positive on the inside. They're linear
+	// along the segment, so each plane cuts it at most once.
+	const float inside[6][2] = {
+		{ a.z - nearDistance, b.z - nearDistance },
+		{ farDistance - a.z, farDistance - b.z },
+		{ a.z * tangX - a.x, b.z * tangX - b.x },
+		{ a.z * tangX + a.x, b.z * tangX + b.x },
+		{ a.z * tang - a.y, b.z * tang - b.y },
+		{ a.z * tang + a.y, b.z * tang + b.y },
+	};
+
+	for (const auto& plane : inside) {
+		const float da = plane[0];
+		const float db = plane[1];
+		if (da < 0 && db < 0) {
+			return false;
+		}
+		if (da < 0) {
+			t0 = std::max(t0, da / (da - db));
+		} else if (db < 0) {
+			t1 = std::min(t1, da / (da - db));
+		}
+	}
+
+	return t0 < t1;
+}
@@ -18,4 +18,7 @@ public:
 
 	void setCameraInternals(float fov, float ratio, float nearD, float farD);
 	void clipToFrustum(Vec3 &p);
+	// Narrows [t0, t1] to the part of the segment from a to b, both in camera
+	// space, that lies inside the frustum. Returns false if none of it does.
+	bool clipSegment(const Vec3& a, const Vec3& b, float& t0, float& t1) const;
 };
@@ -63,17 +63,9 @@ void ObjectServer::run() {
                                 juce::MemoryOutputStream binStream;
                                 juce::String messageString = message.get();
                                 if (juce::Base64::convertFromBase64(binStream, messageString)) {
-                                    std::vector<std::vector<osci::Line>> receivedFrames;
-                                    int bytesRead = binStream.getDataSize();
-                                    if (bytesRead < 8) return;
-                                    char* gplaData = (char*)binStream.getData();
-                                    receivedFrames = LineArtParser::parseBinaryFrames(gplaData, bytesRead);
-                                    if (receivedFrames.size() <= 0) continue;
-                                    frameContainer = receivedFrames[0];
-                                }
-                                else {
-                                    continue;
+                                    addGplaFrame((char*)binStream.getData(), (int) binStream.getDataSize());
                                 }
+                                continue;
                             }
                             else {
 
@@ -109,14 +101,7 @@ void ObjectServer::run() {
                                 frameContainer = LineArtParser::generateFrame(objects, focalLength);
                             }
 
-                            std::vector<std::unique_ptr<osci::Shape>> frame;
-
-                            for (int i = 0; i < frameContainer.size(); i++) {
-                                osci::Line l = frameContainer[i];
-                                frame.push_back(std::make_unique<osci::Line>(l.x1, l.y1, l.x2, l.y2));
-                            }
-
-                            audioProcessor.objectServerSound->addFrame(frame, false);
+                            addFrame(frameContainer);
                         }
                     }
                 }
@@ -124,3 +109,25 @@ void ObjectServer::run() {
         }
     }
 }
+
+bool ObjectServer::addGplaFrame(char* data, int size) {
+    if (size < 8) {
+        return false;
+    }
+    auto receivedFrames = LineArtParser::parseBinaryFrames(data, size);
+    if (receivedFrames.empty()) {
+        return false;
+    }
+    addFrame(receivedFrames[0]);
+    return true;
+}
+
+void ObjectServer::addFrame(const std::vector<osci::Line>& lines) {
+    std::vector<std::unique_ptr<osci::Shape>> frame;
+
+    for (const auto& l : lines) {
+        frame.push_back(std::make_unique<osci::Line>(l.x1, l.y1, l.x2, l.y2));
+    }
+
+    audioProcessor.objectServerSound->addFrame(frame, false);
+}
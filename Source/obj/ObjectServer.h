@@ -12,7 +12,13 @@ public:
     void run() override;
     void reload();
 
+    // Parses a binary GPLA frame and queues it for drawing. Returns false if
+    // there was nothing to draw.
+    bool addGplaFrame(char* data, int size);
+
 private:
+    void addFrame(const std::vector<osci::Line>& lines);
+
     OscirenderAudioProcessor& audioProcessor;
 
     int port = 51677;
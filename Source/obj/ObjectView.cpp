@@ -0,0 +1,239 @@
+#include "ObjectView.h"
+
+namespace {
+    // How much nearer than the edge a face has to be to hide it, relative to
+    // the edge's depth, or absolute without perspective
+    constexpr float kDepthBias = 0.01f;
+    // Samples taken along an edge per pixel it crosses
+    constexpr float kSamplesPerPixel = 2.0f;
+    constexpr int kMaxSamples = 4 * ObjectView::kDepthBufferSize;
+
+    osci::Point pointAt(const osci::Line& line, float t) {
+        return osci::Point(line.x1 + (line.x2 - line.x1) * t, line.y1 + (line.y2 - line.y1) * t, line.z1 + (line.z2 - line.z1) * t);
+    }
+
+    osci::Line between(const osci::Line& line, float t0, float t1) {
+        return osci::Line(pointAt(line, t0), pointAt(line, t1));
+    }
+}
+
+void ObjectView::Settings::rotate(float x, float y, float z) {
+    for (auto* p : { &origin, &xAxis, &yAxis, &zAxis }) {
+        p->rotate(x * std::numbers::pi, y * std::numbers::pi, z * std::numbers::pi);
+    }
+}
+
+void ObjectView::Settings::scale(float x, float y, float z) {
+    for (auto* p : { &origin, &xAxis, &yAxis, &zAxis }) {
+        *p = osci::Point(p->x * x, p->y * y, p->z * z);
+    }
+}
+
+void ObjectView::Settings::translate(float x, float y, float z) {
+    for (auto* p : { &origin, &xAxis, &yAxis, &zAxis }) {
+        *p = osci::Point(p->x + x, p->y + y, p->z + z);
+    }
+}
+
+osci::Point ObjectView::Settings::transform(const osci::Point& p) const {
+    return osci::Point(
+        origin.x + p.x * (xAxis.x - origin.x) + p.y * (yAxis.x - origin.x) + p.z * (zAxis.x - origin.x),
+        origin.y + p.x * (xAxis.y - origin.y) + p.y * (yAxis.y - origin.y) + p.z * (zAxis.y - origin.y),
+        origin.z + p.x * (xAxis.z - origin.z) + p.y * (yAxis.z - origin.z) + p.z * (zAxis.z - origin.z)
+    );
+}
+
+bool ObjectView::Settings::operator==(const Settings& other) const {
+    auto same = [](const osci::Point& a, const osci::Point& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    };
+    return same(origin, other.origin) && same(xAxis, other.xAxis) && same(yAxis, other.yAxis) && same(zAxis, other.zAxis)
+        && perspective == other.perspective && fovDegrees == other.fovDegrees && hiddenLineRemoval == other.hiddenLineRemoval;
+}
+
+ObjectView::ObjectView(std::vector<osci::Line> edges, std::vector<float> vertices, std::vector<int> triangles)
+    : edges(std::move(edges)), vertices(std::move(vertices)), triangles(std::move(triangles)) {}
+
+const std::vector<osci::Line>& ObjectView::getVisibleEdges(const Settings& newSettings) {
+    if (!hasSettings || newSettings != settings) {
+        settings = newSettings;
+        hasSettings = true;
+        update();
+    }
+    return visibleEdges;
+}
+
+void ObjectView::update() {
+    visibleEdges.clear();
+
+    // With no perspective at all the edges are drawn flat, so nothing is
+    // clipped and faces are compared by z.
+    perspective = settings.perspective > 0.0f;
+    const float fov = juce::degreesToRadians(juce::jlimit(1.5f, 179.0f, settings.fovDegrees));
+    camera.frameUnitSphere(fov);
+    cameraDistance = 1.0f / std::sin(0.5f * fov);
+    focalLength = camera.getFrustum().focalLength;
+
+    if (settings.hiddenLineRemoval) {
+        const int numVertices = (int) vertices.size() / 3;
+        viewVertices.resize(numVertices);
+        for (int i = 0; i < numVertices; i++) {
+            viewVertices[i] = settings.transform(osci::Point(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]));
+        }
+        rasteriseFaces();
+    }
+
+    for (const auto& edge : edges) {
+        float t0 = 0.0f;
+        float t1 = 1.0f;
+        if (perspective) {
+            auto a = settings.transform(osci::Point(edge.x1, edge.y1, edge.z1));
+            auto b = settings.transform(osci::Point(edge.x2, edge.y2, edge.z2));
+            Vec3 va(a.x, a.y, a.z);
+            Vec3 vb(b.x, b.y, b.z);
+            if (!camera.clipSegment(va, vb, t0, t1)) {
+                continue;
+            }
+        }
+
+        if (settings.hiddenLineRemoval) {
+            addVisibleSpans(edge, t0, t1);
+        } else if (t0 > 0.0f || t1 < 1.0f) {
+            visibleEdges.push_back(between(edge, t0, t1));
+        } else {
+            visibleEdges.push_back(edge);
+        }
+    }
+}
+
+// Maps a view space point to depth buffer pixels, which cover the same
+// square as the oscilloscope screen.
+ObjectView::Projected ObjectView::project(const osci::Point& p) const {
+    float x = p.x;
+    float y = p.y;
+    float nearness = -p.z;
+    if (perspective) {
+        const float depth = p.z + cameraDistance;
+        x = x * focalLength / depth;
+        y = y * focalLength / depth;
+        nearness = 1.0f / depth;
+    }
+    const float half = 0.5f * kDepthBufferSize;
+    return { (x + 1.0f) * half, (1.0f - y) * half, nearness };
+}
+
+void ObjectView::rasteriseFaces() {
+    const int size = kDepthBufferSize;
+    const float empty = -std::numeric_limits<float>::infinity();
+    nearest.assign((size_t) (size * size), empty);
+
+    const float nearPlane = camera.getFrustum().nearDistance;
+
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        Projected corners[3];
+        bool behind = false;
+        for (int c = 0; c < 3; c++) {
+            const auto& v = viewVertices[(size_t) triangles[i + c]];
+            behind |= perspective && v.z + cameraDistance < nearPlane;
+            corners[c] = project(v);
+        }
+        // Faces crossing the camera plane would project inside out
+        if (behind) {
+            continue;
+        }
+
+        const auto& a = corners[0];
+        const auto& b = corners[1];
+        const auto& c = corners[2];
+        const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (std::abs(area) < 1e-9f) {
+            continue;
+        }
+
+        const int minX = juce::jmax(0, (int) std::floor(juce::jmin(a.x, b.x, c.x)));
+        const int maxX = juce::jmin(size - 1, (int) std::ceil(juce::jmax(a.x, b.x, c.x)));
+        const int minY = juce::jmax(0, (int) std::floor(juce::jmin(a.y, b.y, c.y)));
+        const int maxY = juce::jmin(size - 1, (int) std::ceil(juce::jmax(a.y, b.y, c.y)));
+
+        for (int py = minY; py <= maxY; py++) {
+            const float y = py + 0.5f;
+            for (int px = minX; px <= maxX; px++) {
+                const float x = px + 0.5f;
+                // Barycentric weights, all the same sign inside the face
+                const float wa = ((b.x - x) * (c.y - y) - (b.y - y) * (c.x - x)) / area;
+                const float wb = ((c.x - x) * (a.y - y) - (c.y - y) * (a.x - x)) / area;
+                const float wc = 1.0f - wa - wb;
+                if (wa < 0.0f || wb < 0.0f || wc < 0.0f) {
+                    continue;
+                }
+                const float nearness = wa * a.nearness + wb * b.nearness + wc * c.nearness;
+                auto& pixel = nearest[(size_t) (py * size + px)];
+                pixel = juce::jmax(pixel, nearness);
+            }
+        }
+    }
+
+    // Take the furthest face around each pixel, so an edge is only hidden
+    // once it's a pixel inside whatever covers it.
+    depth.resize(nearest.size());
+    for (int py = 0; py < size; py++) {
+        for (int px = 0; px < size; px++) {
+            float furthest = nearest[(size_t) (py * size + px)];
+            for (int ny = juce::jmax(0, py - 1); ny <= juce::jmin(size - 1, py + 1); ny++) {
+                for (int nx = juce::jmax(0, px - 1); nx <= juce::jmin(size - 1, px + 1); nx++) {
+                    furthest = juce::jmin(furthest, nearest[(size_t) (ny * size + nx)]);
+                }
+            }
+            depth[(size_t) (py * size + px)] = furthest;
+        }
+    }
+}
+
+bool ObjectView::isVisible(const Projected& p) const {
+    const int px = (int) std::floor(p.x);
+    const int py = (int) std::floor(p.y);
+    if (px < 0 || py < 0 || px >= kDepthBufferSize || py >= kDepthBufferSize) {
+        return true;
+    }
+    const float face = depth[(size_t) (py * kDepthBufferSize + px)];
+    if (perspective) {
+        // The face's depth is within kDepthBias of the edge's, or further
+        return face <= p.nearness / (1.0f - kDepthBias);
+    }
+    return face <= p.nearness + kDepthBias;
+}
+
+// Splits the part of the edge between t0 and t1 into the runs of samples
+// that aren't behind a face.
+void ObjectView::addVisibleSpans(const osci::Line& edge, float t0, float t1) {
+    const auto a = settings.transform(osci::Point(edge.x1, edge.y1, edge.z1));
+    const auto b = settings.transform(osci::Point(edge.x2, edge.y2, edge.z2));
+    auto at = [&](float t) {
+        return project(osci::Point(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t));
+    };
+
+    const auto start = at(t0);
+    const auto end = at(t1);
+    const float pixels = std::hypot(end.x - start.x, end.y - start.y);
+    const int numSamples = juce::jlimit(1, kMaxSamples, (int) std::ceil(pixels * kSamplesPerPixel));
+
+    float spanStart = -1.0f;
+    float lastVisible = -1.0f;
+    for (int i = 0; i <= numSamples; i++) {
+        const float t = t0 + (t1 - t0) * (float) i / (float) numSamples;
+        if (isVisible(at(t))) {
+            if (spanStart < 0.0f) {
+                spanStart = t;
+            }
+            lastVisible = t;
+        } else if (spanStart >= 0.0f) {
+            if (lastVisible > spanStart) {
+                visibleEdges.push_back(between(edge, spanStart, lastVisible));
+            }
+            spanStart = -1.0f;
+        }
+    }
+    if (spanStart >= 0.0f && lastVisible > spanStart) {
+        visibleEdges.push_back(between(edge, spanStart, lastVisible));
+    }
+}
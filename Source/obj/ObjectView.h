@@ -0,0 +1,81 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Camera.h"
+
+// Works out which parts of an OBJ's edges can be seen, so that edges leaving
+// the view are cut at the frustum rather than smeared along it, and solid
+// models can hide the edges their faces cover.
+//
+// The view is the rotate, scale and translate effects followed by the
+// perspective camera. They still run per sample afterwards; the visible
+// spans are returned in object space so those effects draw them unchanged.
+class ObjectView {
+public:
+    struct Settings {
+        // Where the effects take the origin and the ends of the unit axes
+        osci::Point origin{ 0, 0, 0 };
+        osci::Point xAxis{ 1, 0, 0 };
+        osci::Point yAxis{ 0, 1, 0 };
+        osci::Point zAxis{ 0, 0, 1 };
+
+        // Perspective effect strength and field of view in degrees
+        float perspective = 1.0f;
+        float fovDegrees = 50.0f;
+        bool hiddenLineRemoval = false;
+
+        // Same maths as the effects, applied to the view so far
+        void rotate(float x, float y, float z);
+        void scale(float x, float y, float z);
+        void translate(float x, float y, float z);
+
+        osci::Point transform(const osci::Point& p) const;
+
+        bool operator==(const Settings& other) const;
+        bool operator!=(const Settings& other) const { return !(*this == other); }
+    };
+
+    // vertices holds xyz triples, and triangles holds three vertex indices
+    // for each face that can hide edges.
+    ObjectView(std::vector<osci::Line> edges, std::vector<float> vertices, std::vector<int> triangles);
+
+    // Returns the visible parts of the edges, recomputed only when the
+    // settings change.
+    const std::vector<osci::Line>& getVisibleEdges(const Settings& settings);
+
+    static constexpr int kDepthBufferSize = 256;
+
+private:
+    struct Projected {
+        float x, y;
+        // Linear in screen space so it can be interpolated across faces:
+        // 1 / depth with perspective, or -z without. Bigger is nearer.
+        float nearness;
+    };
+
+    void update();
+    Projected project(const osci::Point& p) const;
+    void rasteriseFaces();
+    void addVisibleSpans(const osci::Line& edge, float t0, float t1);
+    bool isVisible(const Projected& p) const;
+
+    std::vector<osci::Line> edges;
+    std::vector<float> vertices;
+    std::vector<int> triangles;
+
+    Settings settings;
+    bool hasSettings = false;
+    bool perspective = true;
+    Camera camera;
+    float cameraDistance = 1.0f;
+    float focalLength = 1.0f;
+
+    std::vector<osci::Point> viewVertices;
+    // Nearness of the closest face at each pixel
+    std::vector<float> nearest;
+    // The furthest of nearest around each pixel, so edges on a face's border
+    // aren't hidden by the face itself
+    std::vector<float> depth;
+
+    std::vector<osci::Line> visibleEdges;
+};
@@ -0,0 +1,327 @@
+#include "OscServer.h"
+
+namespace {
+    constexpr int kMaxBundleDepth = 8;
+    constexpr int kMaxChunksPerFrame = 16384;
+
+    int padded(int size) {
+        return (size + 3) & ~3;
+    }
+
+    bool readInt32(const char*& p, const char* end, juce::int32& value) {
+        if (end - p < 4) {
+            return false;
+        }
+        value = (juce::int32) juce::ByteOrder::bigEndianInt(p);
+        p += 4;
+        return true;
+    }
+
+    bool readInt64(const char*& p, const char* end, juce::int64& value) {
+        if (end - p < 8) {
+            return false;
+        }
+        value = (juce::int64) juce::ByteOrder::bigEndianInt64(p);
+        p += 8;
+        return true;
+    }
+
+    // Reads a null-terminated string padded to four bytes
+    bool readString(const char*& p, const char* end, const char*& string, int& length) {
+        const auto* terminator = static_cast<const char*>(std::memchr(p, 0, (size_t) (end - p)));
+        if (terminator == nullptr) {
+            return false;
+        }
+        length = (int) (terminator - p);
+        if (end - p < padded(length + 1)) {
+            return false;
+        }
+        string = p;
+        p += padded(length + 1);
+        return true;
+    }
+}
+
+bool OscServer::Argument::isNumber() const {
+    return type == 'i' || type == 'h' || type == 'f' || type == 'd' || type == 'T' || type == 'F';
+}
+
+OscServer::OscServer(Listener& listener) : juce::Thread("OSC Server"), listener(listener) {}
+
+OscServer::~OscServer() {
+    stop();
+    cancelPendingUpdate();
+}
+
+bool OscServer::start(int port) {
+    stop();
+
+    socket = std::make_unique<juce::DatagramSocket>(false);
+    if (!socket->bindToPort(port, "127.0.0.1")) {
+        juce::Logger::writeToLog("OscServer: couldn't bind to port " + juce::String(port));
+        socket.reset();
+        return false;
+    }
+
+    startThread();
+    return true;
+}
+
+void OscServer::stop() {
+    stopThread(1000);
+    socket.reset();
+    pendingFrames.clear();
+}
+
+bool OscServer::isRunning() const {
+    return isThreadRunning();
+}
+
+int OscServer::getPort() const {
+    return socket != nullptr ? socket->getBoundPort() : 0;
+}
+
+void OscServer::run() {
+    std::vector<char> packet((size_t) kMaxPacketSize);
+
+    while (!threadShouldExit()) {
+        if (socket->waitUntilReady(true, 200) != 1) {
+            continue;
+        }
+
+        const int size = socket->read(packet.data(), kMaxPacketSize, false);
+        if (size <= 0) {
+            continue;
+        }
+
+        if (!parsePacket(packet.data(), size, [this](const Message& message) { handleMessage(message); })) {
+            juce::Logger::writeToLog("OscServer: ignored a malformed packet of " + juce::String(size) + " bytes");
+        }
+    }
+}
+
+bool OscServer::parsePacket(const char* data, int size, const std::function<void(const Message&)>& handler) {
+    return parseElement(data, size, 0, handler);
+}
+
+bool OscServer::parseElement(const char* data, int size, int depth, const std::function<void(const Message&)>& handler) {
+    const char* p = data;
+    const char* end = data + size;
+
+    if (size >= 8 && std::memcmp(data, "#bundle", 8) == 0) {
+        if (depth >= kMaxBundleDepth) {
+            return false;
+        }
+        juce::int64 timeTag;
+        p += 8;
+        if (!readInt64(p, end, timeTag)) {
+            return false;
+        }
+        while (p < end) {
+            juce::int32 elementSize;
+            if (!readInt32(p, end, elementSize) || elementSize < 0 || elementSize > end - p || elementSize % 4 != 0) {
+                return false;
+            }
+            if (!parseElement(p, elementSize, depth + 1, handler)) {
+                return false;
+            }
+            p += elementSize;
+        }
+        return true;
+    }
+
+    Message message;
+    const char* address;
+    int addressLength;
+    if (!readString(p, end, address, addressLength) || addressLength == 0 || address[0] != '/') {
+        return false;
+    }
+    message.address = juce::String::fromUTF8(address, addressLength);
+
+    // Very old senders leave out the type tags when there are no arguments
+    if (p == end) {
+        handler(message);
+        return true;
+    }
+
+    const char* tags;
+    int numTags;
+    if (!readString(p, end, tags, numTags) || numTags == 0 || tags[0] != ',') {
+        return false;
+    }
+
+    for (int i = 1; i < numTags; i++) {
+        Argument argument;
+        argument.type = tags[i];
+
+        switch (argument.type) {
+            case 'i': {
+                juce::int32 value;
+                if (!readInt32(p, end, value)) return false;
+                argument.number = value;
+                break;
+            }
+            case 'h': {
+                juce::int64 value;
+                if (!readInt64(p, end, value)) return false;
+                argument.number = (double) value;
+                break;
+            }
+            case 'f': {
+                juce::int32 bits;
+                if (!readInt32(p, end, bits)) return false;
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                argument.number = value;
+                break;
+            }
+            case 'd': {
+                juce::int64 bits;
+                if (!readInt64(p, end, bits)) return false;
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                argument.number = value;
+                break;
+            }
+            case 's':
+            case 'S': {
+                const char* string;
+                int length;
+                if (!readString(p, end, string, length)) return false;
+                argument.string = juce::String::fromUTF8(string, length);
+                break;
+            }
+            case 'b': {
+                juce::int32 blobSize;
+                if (!readInt32(p, end, blobSize) || blobSize < 0 || end - p < padded(blobSize)) return false;
+                argument.blob = p;
+                argument.blobSize = blobSize;
+                p += padded(blobSize);
+                break;
+            }
+            case 'T':
+                argument.number = 1.0;
+                break;
+            case 'F':
+                argument.number = 0.0;
+                break;
+            case 'N':
+            case 'I':
+                break;
+            default:
+                // Anything else has a size we don't know, so the rest can't be read
+                return false;
+        }
+
+        message.arguments.push_back(std::move(argument));
+    }
+
+    handler(message);
+    return true;
+}
+
+void OscServer::handleMessage(const Message& message) {
+    const auto& args = message.arguments;
+
+    if (message.address.startsWith("/param/")) {
+        if (args.empty() || !args[0].isNumber()) {
+            return;
+        }
+
+        {
+            auto scope = queue.write(1);
+            if (scope.blockSize1 == 0) {
+                droppedMessages++;
+                return;
+            }
+            auto& change = changes[(size_t) scope.startIndex1];
+            change.id = message.address.substring(7);
+            change.value = (float) args[0].number;
+        }
+        triggerAsyncUpdate();
+    } else if (message.address == "/frame") {
+        if (args.size() == 1 && args[0].type == 'b') {
+            // Copied so the frame is aligned for the GPLA parser
+            assembled.replaceAll(args[0].blob, (size_t) args[0].blobSize);
+            listener.oscFrameReceived(assembled);
+        } else if (args.size() == 4 && args[0].isNumber() && args[1].isNumber() && args[2].isNumber() && args[3].type == 'b') {
+            handleFrameChunk((int) args[0].number, (int) args[1].number, (int) args[2].number, args[3].blob, args[3].blobSize);
+        }
+    } else if (message.address == "/frame/end") {
+        pendingFrames.clear();
+        listener.oscFramesEnded();
+    }
+}
+
+// Chunks can arrive in any order, and a frame whose chunks never all arrive
+// is eventually pushed out by newer ones.
+void OscServer::handleFrameChunk(int frameId, int index, int count, const char* data, int size) {
+    if (count < 1 || count > kMaxChunksPerFrame || index < 0 || index >= count) {
+        return;
+    }
+
+    auto pending = std::find_if(pendingFrames.begin(), pendingFrames.end(), [frameId](const PendingFrame& frame) { return frame.id == frameId; });
+    if (pending == pendingFrames.end()) {
+        if ((int) pendingFrames.size() >= kMaxPendingFrames) {
+            pendingFrames.erase(pendingFrames.begin());
+        }
+        PendingFrame frame;
+        frame.id = frameId;
+        frame.count = count;
+        frame.chunks.resize((size_t) count);
+        frame.arrived.resize((size_t) count, false);
+        pendingFrames.push_back(std::move(frame));
+        pending = pendingFrames.end() - 1;
+    }
+    if (pending->count != count) {
+        pendingFrames.erase(pending);
+        return;
+    }
+
+    if (!pending->arrived[(size_t) index]) {
+        if (pending->size + size > kMaxFrameSize) {
+            pendingFrames.erase(pending);
+            return;
+        }
+        pending->chunks[(size_t) index].replaceAll(data, (size_t) size);
+        pending->arrived[(size_t) index] = true;
+        pending->size += size;
+        pending->received++;
+    }
+    if (pending->received < count) {
+        return;
+    }
+
+    assembled.setSize(0);
+    assembled.ensureSize((size_t) pending->size);
+    for (const auto& c : pending->chunks) {
+        assembled.append(c.getData(), c.getSize());
+    }
+    pendingFrames.erase(pending);
+
+    listener.oscFrameReceived(assembled);
+}
+
+void OscServer::handleAsyncUpdate() {
+    auto scope = queue.read(queue.getNumReady());
+    auto apply = [this](int start, int size) {
+        for (int i = start; i < start + size; i++) {
+            auto& change = changes[(size_t) i];
+            listener.oscParameterReceived(change.id, change.value);
+        }
+    };
+    apply(scope.startIndex1, scope.blockSize1);
+    apply(scope.startIndex2, scope.blockSize2);
+}
+
+void OscServer::setParameterValue(juce::AudioProcessorParameter& parameter, float value) {
+    if (auto* floatParameter = dynamic_cast<osci::FloatParameter*>(&parameter)) {
+        floatParameter->setUnnormalisedValueNotifyingHost(value);
+    } else if (auto* intParameter = dynamic_cast<osci::IntParameter*>(&parameter)) {
+        intParameter->setUnnormalisedValueNotifyingHost(juce::roundToInt(value));
+    } else if (auto* booleanParameter = dynamic_cast<osci::BooleanParameter*>(&parameter)) {
+        booleanParameter->setBoolValueNotifyingHost(value >= 0.5f);
+    } else {
+        parameter.setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, value));
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Receives OSC over UDP on localhost, for controllers and live-coding tools
+// that would rather fire packets than hold a TCP connection to ObjectServer.
+//
+//   /param/<id> <value>                    sets a parameter, in its own units
+//   /frame <blob>                          a binary GPLA frame
+//   /frame <id> <index> <count> <blob>     one chunk of a frame too big for a packet
+//   /frame/end                             stops drawing received frames
+//
+// Bundles are unpacked and applied as they arrive, ignoring their time tags.
+// Parameter changes are queued for the message thread; when the queue is
+// full they're dropped rather than blocking the socket.
+class OscServer : private juce::Thread, private juce::AsyncUpdater {
+public:
+    class Listener {
+    public:
+        virtual ~Listener() = default;
+
+        // Called on the message thread for each /param message.
+        virtual void oscParameterReceived(const juce::String& id, float value) = 0;
+        // Called on the server thread with each complete GPLA frame. The
+        // block is reused for the next frame.
+        virtual void oscFrameReceived(juce::MemoryBlock& frame) = 0;
+        // Called on the server thread for /frame/end.
+        virtual void oscFramesEnded() = 0;
+    };
+
+    struct Argument {
+        char type = 0;
+        // i, h, f, d, T and F arguments
+        double number = 0.0;
+        juce::String string;
+        // b arguments point into the packet
+        const char* blob = nullptr;
+        int blobSize = 0;
+
+        bool isNumber() const;
+    };
+
+    struct Message {
+        juce::String address;
+        std::vector<Argument> arguments;
+    };
+
+    OscServer(Listener& listener);
+    ~OscServer() override;
+
+    // Binds to port on 127.0.0.1, or any free port if it's 0, and starts
+    // listening. Returns false if the port couldn't be bound.
+    bool start(int port);
+    void stop();
+    bool isRunning() const;
+    int getPort() const;
+
+    int getNumDroppedMessages() const { return droppedMessages.load(); }
+
+    // Calls handler with every message in the packet, unpacking bundles.
+    // Returns false if the packet is malformed, in which case handler may
+    // already have been called for messages before the error.
+    static bool parsePacket(const char* data, int size, const std::function<void(const Message&)>& handler);
+
+    // Sets a parameter from an unnormalised value, as a host would.
+    static void setParameterValue(juce::AudioProcessorParameter& parameter, float value);
+
+    static constexpr int kDefaultPort = 51678;
+    static constexpr int kMaxPacketSize = 65536;
+    static constexpr int kQueueSize = 1024;
+    static constexpr int kMaxFrameSize = 10 * 1024 * 1024;
+    static constexpr int kMaxPendingFrames = 4;
+
+private:
+    void run() override;
+    void handleAsyncUpdate() override;
+    void handleMessage(const Message& message);
+    void handleFrameChunk(int frameId, int index, int count, const char* data, int size);
+
+    static bool parseElement(const char* data, int size, int depth, const std::function<void(const Message&)>& handler);
+
+    Listener& listener;
+    std::unique_ptr<juce::DatagramSocket> socket;
+
+    struct ParameterChange {
+        juce::String id;
+        float value = 0.0f;
+    };
+    juce::AbstractFifo queue{ kQueueSize };
+    std::array<ParameterChange, kQueueSize> changes;
+    std::atomic<int> droppedMessages = 0;
+
+    // Frames that arrived in chunks, only touched on the server thread
+    struct PendingFrame {
+        int id = 0;
+        int count = 0;
+        int received = 0;
+        int size = 0;
+        std::vector<juce::MemoryBlock> chunks;
+        std::vector<bool> arrived;
+    };
+    std::vector<PendingFrame> pendingFrames;
+    juce::MemoryBlock assembled;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscServer)
+};
@@ -96,6 +96,8 @@ WorldObject::WorldObject(const std::string& obj_string) {
     // 
     std::vector<tinyobj::shape_t> shapes = reader.GetShapes();
     std::unordered_set<std::pair<int, int>, pair_hash> edge_set;
+    // fan triangulation of each face, so faces can hide the edges behind them
+    std::vector<int> triangles;
 
 	for (auto& shape : shapes) {
         int i = 0;
@@ -112,6 +114,9 @@ WorldObject::WorldObject(const std::string& obj_string) {
                 if (j == 0) {
                     firstVertex = vertex;
                 }
+                if (j >= 2) {
+                    triangles.insert(triangles.end(), { firstVertex, prevVertex, vertex });
+                }
                 if (j == num_face_vertices - 1) {
                     lastVertex = vertex;
                 }
@@ -235,12 +240,14 @@ WorldObject::WorldObject(const std::string& obj_string) {
             prevVertex = vertex;
         }
     }
+
+    view = std::make_unique<ObjectView>(edges, vs, std::move(triangles));
 }
 
-std::vector<std::unique_ptr<osci::Shape>> WorldObject::draw() {
+std::vector<std::unique_ptr<osci::Shape>> WorldObject::draw(const ObjectView::Settings& settings) {
     std::vector<std::unique_ptr<osci::Shape>> shapes;
 
-    for (auto& edge : edges) {
+    for (auto& edge : view->getVisibleEdges(settings)) {
         shapes.push_back(edge.clone());
     }
     return shapes;
@@ -1,14 +1,18 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ObjectView.h"
 
 class WorldObject {
 public:
 	WorldObject(const std::string&);
 
-    std::vector<std::unique_ptr<osci::Shape>> draw();
+    std::vector<std::unique_ptr<osci::Shape>> draw(const ObjectView::Settings& settings);
     
     std::vector<osci::Line> edges;
     std::vector<float> vs;
     int numVertices;
+
+private:
+    std::unique_ptr<ObjectView> view;
 };
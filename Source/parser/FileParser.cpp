@@ -1,5 +1,6 @@
 #include "FileParser.h"
 #include <numbers>
+#include <utility>
 #include "../PluginProcessor.h"
 
 FileParser::FileParser(OscirenderAudioProcessor &p, std::function<void(int, juce::String, juce::String)> errorCallback) 
@@ -9,7 +10,7 @@ FileParser::FileParser(OscirenderAudioProcessor &p, std::function<void(int, juce
 void FileParser::showFileSizeWarning(juce::String fileName, int64_t totalBytes, int64_t mbLimit,
 	juce::String fileType, std::function<void()> callback) {
 
-	if (totalBytes <= mbLimit * 1024 * 1024) {
+	if (totalBytes <= mbLimit * 1024 * 1024 || audioProcessor.isHeadless()) {
 		callback();
 		return;
 	}
@@ -26,7 +27,6 @@ void FileParser::showFileSizeWarning(juce::String fileName, int64_t totalBytes,
 			"Cancel",
 			nullptr,
 			juce::ModalCallbackFunction::create([this, callback](int result) {
-				juce::SpinLock::ScopedLockType scope(lock);
 				if (result == 1) { // 1 = OK button pressed
 					callback();
 				} else {
@@ -44,89 +44,103 @@ void FileParser::showFileSizeWarning(juce::String fileName, int64_t totalBytes,
 	});
 }
 
+// Parsing happens without the lock held, into a fresh set of parsers that is
+// swapped in at the end, so the audio thread only ever waits for the swap.
 void FileParser::parse(juce::String fileId, juce::String fileName, juce::String extension, std::unique_ptr<juce::InputStream> stream, juce::Font font) {
-	juce::SpinLock::ScopedLockType scope(lock);
-
+	// lua is only replaced here, on the message thread, so it can be read
+	// without the lock.
 	if (extension == ".lua" && lua != nullptr && lua->isFunctionValid()) {
 		fallbackLuaScript = lua->getScript();
 	}
 
-	object = nullptr;
-	svg = nullptr;
-	text = nullptr;
-	gpla = nullptr;
-	lua = nullptr;
-	img = nullptr;
-	wav = nullptr;
-#if OSCI_PREMIUM
-	fractal = nullptr;
-#endif
+	auto next = std::make_shared<Contents>();
 	
 	if (extension == ".obj") {
 		const int64_t fileSize = stream->getTotalLength();
 		juce::String objContent = stream->readEntireStreamAsString();
-		showFileSizeWarning(fileName, fileSize, 1, "OBJ", [this, objContent]() {
-			object = std::make_shared<WorldObject>(objContent.toStdString());
-            isAnimatable = false;
-            sampleSource = false;
+		showFileSizeWarning(fileName, fileSize, 1, "OBJ", [this, next, objContent]() {
+			next->object = std::make_shared<WorldObject>(objContent.toStdString());
+			if (next->installed) {
+				install(*next);
+			}
 		});
 	} else if (extension == ".svg") {
-		svg = std::make_shared<SvgParser>(stream->readEntireStreamAsString());
+		next->svg = std::make_shared<SvgParser>(stream->readEntireStreamAsString());
 	} else if (extension == ".txt") {
-        text = std::make_shared<TextParser>(stream->readEntireStreamAsString(), audioProcessor.font);
+		// Lines unchanged since the last version of the file keep their
+		// layout. Like lua, text is only replaced on this thread.
+		next->text = std::make_shared<TextParser>(stream->readEntireStreamAsString(), audioProcessor.font, text.get());
 	} else if (extension == ".lua") {
-		lua = std::make_shared<LuaParser>(fileId, stream->readEntireStreamAsString(), errorCallback, fallbackLuaScript);
+		next->lua = std::make_shared<LuaParser>(fileId, stream->readEntireStreamAsString(), errorCallback, fallbackLuaScript);
 	} else if (extension == ".gpla") {
 		juce::MemoryBlock buffer{};
 		int bytesRead = stream->readIntoMemoryBlock(buffer);
-		if (bytesRead < 8) return;
-		char* gplaData = (char*)buffer.getData();
-		const char tag[] = "GPLA    ";
-		bool isBinary = true;
-		for (int i = 0; i < 8; i++) {
-			isBinary = isBinary && tag[i] == gplaData[i];
-		}
-		if (isBinary) {
-			gpla = std::make_shared<LineArtParser>(gplaData, bytesRead);
-		} else {
-			stream->setPosition(0);
-			gpla = std::make_shared<LineArtParser>(stream->readEntireStreamAsString());
+		if (bytesRead >= 8) {
+			next->gpla = std::make_shared<LineArtParser>(buffer, audioProcessor.applicationFolder.getChildFile("GPLA Cache"));
 		}
 	} else if (extension == ".gif" || extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".mp4" || extension == ".mov") {
 		juce::MemoryBlock buffer{};
 		int bytesRead = stream->readIntoMemoryBlock(buffer);
+		next->animatedImage = extension == ".gif" || extension == ".mp4" || extension == ".mov";
 
 		showFileSizeWarning(fileName, bytesRead, 20, (extension == ".mp4" || extension == ".mov") ? "video" : "image",
-			[this, buffer, extension]() {
-				img = std::make_shared<ImageParser>(audioProcessor, extension, buffer);
-                isAnimatable = extension == ".gif" || extension == ".mp4" || extension == ".mov";
-                sampleSource = true;
+			[this, next, buffer, extension]() {
+				next->img = std::make_shared<ImageParser>(audioProcessor, extension, buffer);
+				if (next->installed) {
+					install(*next);
+				}
 			}
 		);
 	} else if (extension == ".lsystem") {
 #if OSCI_PREMIUM
-		fractal = std::make_shared<FractalParser>(stream->readEntireStreamAsString());
+		next->fractal = std::make_shared<FractalParser>(stream->readEntireStreamAsString());
 #endif
 	} else if (extension == ".wav" || extension == ".aiff" || extension == ".flac" || extension == ".ogg" || extension == ".mp3") {
-		wav = std::make_shared<WavParser>(audioProcessor);
-		if (!wav->parse(std::move(stream))) {
-			juce::MessageManager::callAsync([this, fileName] {
-				juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::AlertIconType::WarningIcon,
-					"Error Loading " + fileName,
-					"The audio file '" + fileName + "' could not be loaded.");
-			});
+		next->wav = std::make_shared<WavParser>(audioProcessor);
+		if (!next->wav->parse(std::move(stream))) {
+			if (audioProcessor.isHeadless()) {
+				juce::Logger::writeToLog("The audio file '" + fileName + "' could not be loaded.");
+			} else {
+				juce::MessageManager::callAsync([this, fileName] {
+					juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::AlertIconType::WarningIcon,
+						"Error Loading " + fileName,
+						"The audio file '" + fileName + "' could not be loaded.");
+				});
+			}
 		}
 	}
 
-	isAnimatable = gpla != nullptr || (img != nullptr && (extension == ".gif" || extension == ".mp4" || extension == ".mov"));
-	sampleSource = lua != nullptr || img != nullptr || wav != nullptr;
+	// A large OBJ or image waiting on the size warning installs itself once
+	// it has been confirmed and parsed.
+	install(*next);
+	next->installed = true;
+}
+
+// Swaps next in. The previous parsers are released once the lock is dropped.
+void FileParser::install(Contents& next) {
+	Contents previous;
+	{
+		juce::SpinLock::ScopedLockType scope(lock);
+		previous.object = std::exchange(object, next.object);
+		previous.svg = std::exchange(svg, next.svg);
+		previous.text = std::exchange(text, next.text);
+		previous.gpla = std::exchange(gpla, next.gpla);
+		previous.lua = std::exchange(lua, next.lua);
+		previous.img = std::exchange(img, next.img);
+		previous.wav = std::exchange(wav, next.wav);
+#if OSCI_PREMIUM
+		previous.fractal = std::exchange(fractal, next.fractal);
+#endif
+		isAnimatable = gpla != nullptr || (img != nullptr && next.animatedImage);
+		sampleSource = lua != nullptr || img != nullptr || wav != nullptr;
+	}
 }
 
 std::vector<std::unique_ptr<osci::Shape>> FileParser::nextFrame() {
     juce::SpinLock::ScopedLockType scope(lock);
 
     if (object != nullptr) {
-        return object->draw();
+        return object->draw(audioProcessor.getObjectViewSettings());
     } else if (svg != nullptr) {
         return svg->draw();
     } else if (text != nullptr) {
@@ -217,6 +231,11 @@ std::shared_ptr<LuaParser> FileParser::getLua() {
     return lua;
 }
 
+bool FileParser::isLua() {
+    juce::SpinLock::ScopedLockType scope(lock);
+    return lua != nullptr;
+}
+
 std::shared_ptr<ImageParser> FileParser::getImg() {
     return img;
 }
@@ -232,6 +251,7 @@ std::shared_ptr<FractalParser> FileParser::getFractal() {
 #endif
 
 int FileParser::getNumFrames() {
+    juce::SpinLock::ScopedLockType scope(lock);
     if (gpla != nullptr) {
         return gpla->numFrames;
     } else if (img != nullptr) {
@@ -241,6 +261,7 @@ int FileParser::getNumFrames() {
 }
 
 int FileParser::getCurrentFrame() {
+    juce::SpinLock::ScopedLockType scope(lock);
     if (gpla != nullptr) {
         return gpla->frameNumber;
     } else if (img != nullptr) {
@@ -250,6 +271,7 @@ int FileParser::getCurrentFrame() {
 }
 
 void FileParser::setFrame(int frame) {
+    juce::SpinLock::ScopedLockType scope(lock);
     if (gpla != nullptr) {
         gpla->setFrame(frame);
     } else if (img != nullptr) {
@@ -23,6 +23,7 @@ public:
 	osci::Point nextSample(lua_State*& L, LuaVariables& vars);
 
 	bool isSample();
+	bool isLua();
 	bool isActive();
 	void disable();
 	void enable();
@@ -43,16 +44,33 @@ public:
 	std::shared_ptr<FractalParser> getFractal();
 #endif
 
-	bool isAnimatable = false;
+	std::atomic<bool> isAnimatable = false;
 
 private:
+	struct Contents {
+		std::shared_ptr<WorldObject> object;
+		std::shared_ptr<SvgParser> svg;
+		std::shared_ptr<TextParser> text;
+		std::shared_ptr<LineArtParser> gpla;
+		std::shared_ptr<LuaParser> lua;
+		std::shared_ptr<ImageParser> img;
+		std::shared_ptr<WavParser> wav;
+#if OSCI_PREMIUM
+		std::shared_ptr<FractalParser> fractal;
+#endif
+		bool animatedImage = false;
+		// Set once parse() has returned.
+		bool installed = false;
+	};
+
+	void install(Contents& next);
 	void showFileSizeWarning(juce::String fileName, int64_t totalBytes, int64_t mbLimit, 
 		juce::String fileType, std::function<void()> callback);
 
 	OscirenderAudioProcessor& audioProcessor;
 
 	bool active = true;
-	bool sampleSource = false;
+	std::atomic<bool> sampleSource = false;
 	juce::SpinLock lock;
 
 	std::shared_ptr<WorldObject> object;
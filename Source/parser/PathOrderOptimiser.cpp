@@ -0,0 +1,317 @@
+#include "PathOrderOptimiser.h"
+
+namespace {
+
+// Uniform grid over path endpoints in the XY plane. Entries are removed as
+// their paths are visited, so lookups only ever see unvisited endpoints.
+class EndpointGrid {
+public:
+    struct Entry {
+        int path;
+        bool isEnd;
+    };
+
+    EndpointGrid(const std::vector<PathOrderOptimiser::Path>& paths, bool allowReversal) : paths(paths) {
+        minX = minY = std::numeric_limits<double>::max();
+        double maxX = std::numeric_limits<double>::lowest(), maxY = std::numeric_limits<double>::lowest();
+        for (auto& path : paths) {
+            for (auto* p : { &path.start, &path.end }) {
+                minX = std::min(minX, (double) p->x);
+                minY = std::min(minY, (double) p->y);
+                maxX = std::max(maxX, (double) p->x);
+                maxY = std::max(maxY, (double) p->y);
+            }
+        }
+
+        // Around two endpoints per cell.
+        cellsPerSide = juce::jlimit(1, 1024, (int) std::ceil(std::sqrt((double) paths.size())));
+        cellSize = std::max({ maxX - minX, maxY - minY, 1.0e-9 }) / cellsPerSide;
+        cells.resize((size_t) cellsPerSide * cellsPerSide);
+
+        for (int i = 0; i < (int) paths.size(); ++i) {
+            cells[cellIndex(cellOf(paths[i].start.x, minX), cellOf(paths[i].start.y, minY))].push_back({ i, false });
+            if (allowReversal && paths[i].reversible)
+                cells[cellIndex(cellOf(paths[i].end.x, minX), cellOf(paths[i].end.y, minY))].push_back({ i, true });
+        }
+    }
+
+    // Nearest endpoint of an unvisited path, or path -1 if none are left.
+    Entry nearest(const osci::Point& from, const std::vector<bool>& visited) {
+        Entry best { -1, false };
+        double bestDistance = std::numeric_limits<double>::max();
+        const int cx = cellOf(from.x, minX);
+        const int cy = cellOf(from.y, minY);
+
+        for (int ring = 0; ring <= cellsPerSide; ++ring) {
+            for (int y = cy - ring; y <= cy + ring; ++y) {
+                if (y < 0 || y >= cellsPerSide)
+                    continue;
+                const bool edgeRow = y == cy - ring || y == cy + ring;
+                for (int x = cx - ring; x <= cx + ring; x += (edgeRow || ring == 0) ? 1 : 2 * ring) {
+                    if (x < 0 || x >= cellsPerSide)
+                        continue;
+                    scanCell(cells[cellIndex(x, y)], from, visited, best, bestDistance);
+                }
+            }
+            // Anything in the next ring is at least ring cells away.
+            if (best.path >= 0 && bestDistance <= ring * cellSize)
+                break;
+        }
+        return best;
+    }
+
+private:
+    int cellOf(double v, double min) const {
+        return juce::jlimit(0, cellsPerSide - 1, (int) ((v - min) / cellSize));
+    }
+
+    size_t cellIndex(int x, int y) const {
+        return (size_t) y * cellsPerSide + x;
+    }
+
+    void scanCell(std::vector<Entry>& cell, const osci::Point& from, const std::vector<bool>& visited, Entry& best, double& bestDistance) {
+        for (size_t i = 0; i < cell.size();) {
+            if (visited[cell[i].path]) {
+                cell[i] = cell.back();
+                cell.pop_back();
+                continue;
+            }
+            auto& path = paths[cell[i].path];
+            const double d = PathOrderOptimiser::distance(from, cell[i].isEnd ? path.end : path.start);
+            if (d < bestDistance) {
+                bestDistance = d;
+                best = cell[i];
+            }
+            ++i;
+        }
+    }
+
+    const std::vector<PathOrderOptimiser::Path>& paths;
+    std::vector<std::vector<Entry>> cells;
+    int cellsPerSide = 1;
+    double cellSize = 1.0;
+    double minX = 0.0, minY = 0.0;
+};
+
+}
+
+double PathOrderOptimiser::distance(const osci::Point& a, const osci::Point& b) {
+    const double dx = (double) a.x - b.x;
+    const double dy = (double) a.y - b.y;
+    const double dz = (double) a.z - b.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+juce::String PathOrderOptimiser::Result::describe() const {
+    const double saved = travelBefore > 0.0 ? 100.0 * (1.0 - travelAfter / travelBefore) : 0.0;
+    return juce::String((int) order.size()) + " paths, travel " + juce::String(travelBefore, 3)
+        + " -> " + juce::String(travelAfter, 3) + " (" + juce::String(saved, 1) + "% less)";
+}
+
+void PathOrderOptimiser::Result::add(const Result& other) {
+    order.insert(order.end(), other.order.begin(), other.order.end());
+    reversed.insert(reversed.end(), other.reversed.begin(), other.reversed.end());
+    travelBefore += other.travelBefore;
+    travelAfter += other.travelAfter;
+}
+
+PathOrderOptimiser::Result PathOrderOptimiser::optimise(const std::vector<Path>& paths, const Options& options) {
+    const double startTime = juce::Time::getMillisecondCounterHiRes();
+    const int n = (int) paths.size();
+
+    Result result;
+    result.order.reserve(n);
+    result.reversed.reserve(n);
+
+    for (int i = 0; i < n; ++i)
+        result.travelBefore += distance(paths[i].end, paths[(i + 1) % n].start);
+
+    if (n <= 2) {
+        for (int i = 0; i < n; ++i) {
+            result.order.push_back(i);
+            result.reversed.push_back(false);
+        }
+        result.travelAfter = result.travelBefore;
+        return result;
+    }
+
+    // Nearest-neighbour tour, starting from the first path as given.
+    {
+        EndpointGrid grid(paths, options.allowReversal);
+        std::vector<bool> visited(n, false);
+        visited[0] = true;
+        result.order.push_back(0);
+        result.reversed.push_back(false);
+        osci::Point position = paths[0].end;
+
+        for (int i = 1; i < n; ++i) {
+            auto next = grid.nearest(position, visited);
+            jassert(next.path >= 0);
+            visited[next.path] = true;
+            result.order.push_back(next.path);
+            result.reversed.push_back(next.isEnd);
+            position = next.isEnd ? paths[next.path].start : paths[next.path].end;
+        }
+    }
+
+    auto entry = [&](int pos) -> const osci::Point& {
+        auto& path = paths[result.order[pos]];
+        return result.reversed[pos] ? path.end : path.start;
+    };
+    auto exit = [&](int pos) -> const osci::Point& {
+        auto& path = paths[result.order[pos]];
+        return result.reversed[pos] ? path.start : path.end;
+    };
+
+    // 2-opt: reversing the tour between positions i and j also flips the
+    // direction of every path in between, so only the two links at either end
+    // of the segment change. Segments containing a path that can't be
+    // reversed are skipped.
+    if (options.allowReversal) {
+        std::vector<int> fixedBefore(n + 1, 0);
+        auto countFixed = [&] {
+            for (int i = 0; i < n; ++i)
+                fixedBefore[i + 1] = fixedBefore[i] + (paths[result.order[i]].reversible ? 0 : 1);
+        };
+        countFixed();
+
+        bool improved = true;
+        bool outOfTime = false;
+        while (improved && ! outOfTime) {
+            improved = false;
+            for (int i = 1; i < n - 1 && ! outOfTime; ++i) {
+                for (int j = i + 1; j < n; ++j) {
+                    if (fixedBefore[j + 1] - fixedBefore[i] > 0)
+                        break;
+
+                    const int after = (j + 1) % n;
+                    const double delta = distance(exit(i - 1), exit(j)) + distance(entry(i), entry(after))
+                        - distance(exit(i - 1), entry(i)) - distance(exit(j), entry(after));
+
+                    if (delta < -1.0e-9) {
+                        std::reverse(result.order.begin() + i, result.order.begin() + j + 1);
+                        std::reverse(result.reversed.begin() + i, result.reversed.begin() + j + 1);
+                        for (int k = i; k <= j; ++k)
+                            result.reversed[k] = ! result.reversed[k];
+                        improved = true;
+                    }
+                }
+                outOfTime = juce::Time::getMillisecondCounterHiRes() - startTime > options.timeBudgetMs;
+            }
+        }
+    }
+
+    for (int i = 0; i < n; ++i)
+        result.travelAfter += distance(exit(i), entry((i + 1) % n));
+
+    return result;
+}
+
+std::unique_ptr<osci::Shape> PathOrderOptimiser::reversedShape(const osci::Shape& shape) {
+    const auto start = const_cast<osci::Shape&>(shape).nextVector(0.0);
+    const auto end = const_cast<osci::Shape&>(shape).nextVector(1.0);
+
+    if (dynamic_cast<const osci::Line*>(&shape) != nullptr)
+        return std::make_unique<osci::Line>(end.x, end.y, start.x, start.y);
+
+    // Control points are recovered from points on the curve, so this doesn't
+    // depend on how the curve stores them.
+    if (dynamic_cast<const osci::QuadraticBezierCurve*>(&shape) != nullptr) {
+        // B(1/2) = (P0 + 2 P1 + P2) / 4
+        const auto mid = const_cast<osci::Shape&>(shape).nextVector(0.5);
+        const double cx = 2.0 * mid.x - 0.5 * (start.x + end.x);
+        const double cy = 2.0 * mid.y - 0.5 * (start.y + end.y);
+        return std::make_unique<osci::QuadraticBezierCurve>(end.x, end.y, cx, cy, start.x, start.y);
+    }
+
+    if (dynamic_cast<const osci::CubicBezierCurve*>(&shape) != nullptr) {
+        // B(1/3) = (8 P0 + 12 P1 + 6 P2 + P3) / 27
+        // B(2/3) = (P0 + 6 P1 + 12 P2 + 8 P3) / 27
+        const auto a = const_cast<osci::Shape&>(shape).nextVector(1.0 / 3.0);
+        const auto b = const_cast<osci::Shape&>(shape).nextVector(2.0 / 3.0);
+        auto solve = [](double p0, double p3, double at, double bt, double& c1, double& c2) {
+            const double u = 27.0 * at - 8.0 * p0 - p3; // 12 P1 + 6 P2
+            const double v = 27.0 * bt - p0 - 8.0 * p3; // 6 P1 + 12 P2
+            c1 = (2.0 * u - v) / 18.0;
+            c2 = (2.0 * v - u) / 18.0;
+        };
+        double c1x, c2x, c1y, c2y;
+        solve(start.x, end.x, a.x, b.x, c1x, c2x);
+        solve(start.y, end.y, a.y, b.y, c1y, c2y);
+        return std::make_unique<osci::CubicBezierCurve>(end.x, end.y, c2x, c2y, c1x, c1y, start.x, start.y);
+    }
+
+    return nullptr;
+}
+
+PathOrderOptimiser::Result PathOrderOptimiser::optimiseShapes(std::vector<std::unique_ptr<osci::Shape>>& shapes, const Options& options) {
+    constexpr double kJoinTolerance = 1.0e-5;
+
+    // Group shapes into runs that join end to start.
+    std::vector<std::pair<size_t, size_t>> runs;
+    std::vector<Path> paths;
+    size_t runStart = 0;
+    bool runReversible = true;
+    osci::Point runFirst;
+
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        const auto start = shapes[i]->nextVector(0.0);
+        const auto end = shapes[i]->nextVector(1.0);
+        if (i == runStart) {
+            runFirst = start;
+            runReversible = true;
+        }
+
+        runReversible = runReversible
+            && (dynamic_cast<osci::Line*>(shapes[i].get()) != nullptr
+                || dynamic_cast<osci::QuadraticBezierCurve*>(shapes[i].get()) != nullptr
+                || dynamic_cast<osci::CubicBezierCurve*>(shapes[i].get()) != nullptr);
+
+        const bool joinsNext = i + 1 < shapes.size() && distance(end, shapes[i + 1]->nextVector(0.0)) < kJoinTolerance;
+        if (! joinsNext) {
+            runs.push_back({ runStart, i + 1 });
+            paths.push_back({ runFirst, end, runReversible });
+            runStart = i + 1;
+        }
+    }
+
+    auto result = optimise(paths, options);
+
+    std::vector<std::unique_ptr<osci::Shape>> reordered;
+    reordered.reserve(shapes.size());
+    for (size_t k = 0; k < result.order.size(); ++k) {
+        const auto [begin, end] = runs[result.order[k]];
+        if (result.reversed[k]) {
+            for (size_t i = end; i-- > begin;)
+                reordered.push_back(reversedShape(*shapes[i]));
+        } else {
+            for (size_t i = begin; i < end; ++i)
+                reordered.push_back(std::move(shapes[i]));
+        }
+    }
+    shapes = std::move(reordered);
+
+    return result;
+}
+
+PathOrderOptimiser::Result PathOrderOptimiser::optimiseStrokes(std::vector<std::vector<osci::Point>>& strokes, const Options& options) {
+    strokes.erase(std::remove_if(strokes.begin(), strokes.end(), [](auto& stroke) { return stroke.empty(); }), strokes.end());
+
+    std::vector<Path> paths;
+    paths.reserve(strokes.size());
+    for (auto& stroke : strokes)
+        paths.push_back({ stroke.front(), stroke.back(), true });
+
+    auto result = optimise(paths, options);
+
+    std::vector<std::vector<osci::Point>> reordered;
+    reordered.reserve(strokes.size());
+    for (size_t k = 0; k < result.order.size(); ++k) {
+        reordered.push_back(std::move(strokes[result.order[k]]));
+        if (result.reversed[k])
+            std::reverse(reordered.back().begin(), reordered.back().end());
+    }
+    strokes = std::move(reordered);
+
+    return result;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Reorders (and optionally reverses) the paths of a frame so the beam spends
+// as little time as possible travelling between them.
+//
+// A nearest-neighbour tour is built first, using a uniform grid over the path
+// endpoints so each lookup only visits nearby cells. The tour is then improved
+// with 2-opt moves until no move helps or the time budget runs out. The tour
+// is treated as a loop, since frames are drawn repeatedly and the beam jumps
+// from the end of the last path back to the start of the first.
+//
+// The first path always stays first and keeps its direction.
+class PathOrderOptimiser {
+public:
+    struct Path {
+        osci::Point start;
+        osci::Point end;
+        bool reversible = true;
+    };
+
+    struct Options {
+        bool allowReversal = true;
+        // Budget for 2-opt. The nearest-neighbour tour is always completed.
+        double timeBudgetMs = 20.0;
+    };
+
+    struct Result {
+        // Input indices in drawing order, and whether each is drawn reversed.
+        std::vector<int> order;
+        std::vector<bool> reversed;
+        double travelBefore = 0.0;
+        double travelAfter = 0.0;
+
+        juce::String describe() const;
+        // Adds another reordering's paths and travel, so describe() can report
+        // several of them as one.
+        void add(const Result& other);
+    };
+
+    static Result optimise(const std::vector<Path>& paths, const Options& options);
+
+    // Reorders shapes in place. Runs of shapes joined end to start are kept
+    // together and treated as one path. Lines and Bézier curves can be reversed.
+    static Result optimiseShapes(std::vector<std::unique_ptr<osci::Shape>>& shapes, const Options& options);
+
+    // Reorders polyline strokes in place.
+    static Result optimiseStrokes(std::vector<std::vector<osci::Point>>& strokes, const Options& options);
+
+    // The same shape traced from end to start, or nullptr if the shape type
+    // can't be reversed.
+    static std::unique_ptr<osci::Shape> reversedShape(const osci::Shape& shape);
+
+    static double distance(const osci::Point& a, const osci::Point& b);
+};
@@ -67,7 +67,15 @@ void FractalParser::parse(const juce::String& jsonContent) {
         axiom = "F";
     }
 
-    commandsDirty = true;
+    int lineCap = kDefaultMaxLines;
+    if (auto* obj = result.getDynamicObject()) {
+        auto maxLinesVar = obj->getProperty("maxLines");
+        if (maxLinesVar.isInt() || maxLinesVar.isInt64() || maxLinesVar.isDouble())
+            lineCap = (int) juce::jlimit<juce::int64>(1, kMaxLinesLimit, (juce::int64) maxLinesVar);
+    }
+    maxLines.store(lineCap, std::memory_order_relaxed);
+
+    grammarDirty = true;
     frameDirty.store(true, std::memory_order_release);
 }
 
@@ -85,6 +93,9 @@ juce::String FractalParser::toJson() const {
     }
     obj->setProperty("rules", rulesArray);
 
+    if (getMaxLines() != kDefaultMaxLines)
+        obj->setProperty("maxLines", getMaxLines());
+
     return juce::JSON::toString(juce::var(obj), false);
 }
 
@@ -118,181 +129,246 @@ void FractalParser::setIterations(int iterations) {
     }
 }
 
+void FractalParser::setMaxLines(int lines) {
+    int clamped = juce::jlimit(1, kMaxLinesLimit, lines);
+    int prev = maxLines.exchange(clamped, std::memory_order_relaxed);
+    if (prev != clamped) {
+        frameDirty.store(true, std::memory_order_release);
+    }
+}
+
 bool FractalParser::consumeDirty() {
     return frameDirty.exchange(false, std::memory_order_acq_rel);
 }
 
-// ---- String rewriting ----
-
-std::string FractalParser::applyRules(const std::string& input) const {
-    std::string result;
-    result.reserve(input.size() * 4);
-
-    for (char ch : input) {
-        bool replaced = false;
-        for (const auto& rule : rules) {
-            // Only match rules whose variable is exactly one character long.
-            if (rule.variable.length() == 1 && ch == (char)rule.variable[0]) {
-                auto rep = rule.replacement.toStdString();
-                result.append(rep);
-                replaced = true;
-                break;
-            }
-        }
-        if (!replaced) {
-            result.push_back(ch);
-        }
+// ---- Grammar ----
+
+namespace {
+    constexpr juce::int64 kSaturated = (juce::int64) 1 << 60;
+
+    juce::int64 saturatingAdd(juce::int64 a, juce::int64 b) {
+        return juce::jlimit(-kSaturated, kSaturated, a + b);
     }
 
-    return result;
+    bool isDraw(unsigned char symbol) {
+        return symbol >= 'A' && symbol <= 'Z' && symbol != 'X' && symbol != 'Y';
+    }
 }
 
-// ---- Convert L-system string to compact command list (shared_ptr for zero-copy) ----
-
-std::shared_ptr<std::vector<FractalCmd>> FractalParser::stringToCommands(const std::string& lsystemString) const {
-    auto commands = std::make_shared<std::vector<FractalCmd>>();
-    commands->reserve(lsystemString.size());
-
-    for (char ch : lsystemString) {
-        if ((ch >= 'A' && ch <= 'Z') && ch != 'X' && ch != 'Y') {
-            commands->push_back(FractalCmd::Draw);
-        } else if (ch == 'f') {
-            commands->push_back(FractalCmd::Move);
-        } else if (ch == '+') {
-            commands->push_back(FractalCmd::TurnRight);
-        } else if (ch == '-') {
-            commands->push_back(FractalCmd::TurnLeft);
-        } else if (ch == '[') {
-            commands->push_back(FractalCmd::Push);
-        } else if (ch == ']') {
-            commands->push_back(FractalCmd::Pop);
+void FractalParser::compileGrammar() {
+    grammar.productions.fill({});
+    grammar.hasProduction.fill(false);
+
+    for (const auto& rule : rules) {
+        // Only rules whose variable is exactly one character long apply,
+        // and the first rule for a variable wins.
+        if (rule.variable.length() != 1) continue;
+        auto variable = rule.variable.toStdString();
+        if (variable.size() != 1) continue;
+        auto symbol = (unsigned char) variable[0];
+        if (grammar.hasProduction[symbol]) continue;
+        grammar.productions[symbol] = rule.replacement.toStdString();
+        grammar.hasProduction[symbol] = true;
+    }
+
+    grammar.stats.assign(MAX_ITERATIONS + 1, {});
+    for (int symbol = 0; symbol < NUM_SYMBOLS; ++symbol) {
+        auto& leaf = grammar.stats[0][symbol];
+        leaf.lines = isDraw((unsigned char) symbol) ? 1 : 0;
+        leaf.visits = 1;
+        leaf.net = symbol == '[' ? 1 : symbol == ']' ? -1 : 0;
+        leaf.lowest = std::min<juce::int64>(0, leaf.net);
+    }
+    for (int depth = 1; depth <= MAX_ITERATIONS; ++depth) {
+        for (int symbol = 0; symbol < NUM_SYMBOLS; ++symbol) {
+            grammar.stats[depth][symbol] = grammar.hasProduction[symbol]
+                ? getSequenceStats(grammar.productions[symbol], depth - 1)
+                : grammar.stats[0][symbol];
         }
     }
 
-    return commands;
+    localPaths.clear();
+    localPaths.resize((size_t) (MAX_ITERATIONS + 1) * NUM_SYMBOLS);
+    cachedLines = 0;
+    levels.assign(MAX_ITERATIONS + 1, nullptr);
+    grammarDirty = false;
 }
 
-// ---- Rebuild all level caches ----
+FractalParser::SymbolStats FractalParser::getSequenceStats(const std::string& symbols, int depth) const {
+    SymbolStats total;
+    for (char ch : symbols) {
+        const auto& child = grammar.stats[depth][(unsigned char) ch];
+        total.lines = saturatingAdd(total.lines, child.lines);
+        total.visits = saturatingAdd(total.visits, child.visits);
+        total.lowest = std::min(total.lowest, saturatingAdd(total.net, child.lowest));
+        total.net = saturatingAdd(total.net, child.net);
+    }
+    // Expanding a symbol is a step of its own, even to nothing
+    total.visits = saturatingAdd(total.visits, 1);
+    return total;
+}
 
-void FractalParser::rebuildAllLevels() {
-    levels.clear();
-    levels.resize(MAX_ITERATIONS + 1);
-    maxCachedLevel = -1;
+// Picks the deepest iteration up to the requested one that keeps within the
+// line cap, so deep iterations lose detail rather than stalling.
+int FractalParser::chooseLevel(int iterations) const {
+    const juce::int64 lineCap = getMaxLines();
+    const auto symbols = axiom.toStdString();
+    for (int level = iterations; level > 0; --level) {
+        auto stats = getSequenceStats(symbols, level);
+        if (stats.lines <= lineCap && stats.visits <= lineCap * MAX_VISITS_PER_LINE)
+            return level;
+    }
+    return 0;
+}
 
-    std::string current = axiom.toStdString();
+// ---- Streaming turtle walk ----
+//
+// Walks the rewrite tree depth first without ever building the expanded
+// string. Each frame is a position in one production, so the explicit stack
+// is never deeper than the iteration count. Symbols whose expansion keeps
+// its brackets balanced are drawn once into a LocalPath and then stamped
+// wherever they occur, which also carries over between iterations.
+
+void FractalParser::walk(const std::string& symbols, int depth, Turtle& turtle,
+                         std::vector<FractalPath::DrawSegment>& out) {
+    struct Frame { const char* next; const char* end; int depth; };
+    std::array<Frame, MAX_ITERATIONS + 1> frames;
+    int numFrames = 0;
+    frames[numFrames++] = { symbols.data(), symbols.data() + symbols.size(), depth };
+
+    while (numFrames > 0) {
+        auto& frame = frames[numFrames - 1];
+        if (frame.next == frame.end) {
+            --numFrames;
+            continue;
+        }
 
-    for (int level = 0; level <= MAX_ITERATIONS; ++level) {
-        levels[level].commands = stringToCommands(current);
+        const auto symbol = (unsigned char) *frame.next++;
+        const int symbolDepth = frame.depth;
 
-        int drawCount = 0;
-        for (FractalCmd cmd : *levels[level].commands) {
-            if (cmd == FractalCmd::Draw) drawCount++;
-        }
-        levels[level].numDraws = drawCount;
-        levels[level].norm = traceNormAndBuildSegments(*levels[level].commands, baseAngleDegrees, levels[level].segments);
-        maxCachedLevel = level;
-
-        if (level < MAX_ITERATIONS) {
-            std::string next = applyRules(current);
-            if ((int)next.size() > MAX_STRING_LENGTH) {
-                // String exceeded limit — keep this clean level as the cap
-                for (int rest = level + 1; rest <= MAX_ITERATIONS; ++rest) {
-                    levels[rest].commands = levels[level].commands;
-                    levels[rest].numDraws = levels[level].numDraws;
-                    levels[rest].norm = levels[level].norm;
-                    levels[rest].segments = levels[level].segments;
-                }
-                maxCachedLevel = MAX_ITERATIONS;
-                break;
+        if (symbolDepth > 0 && grammar.hasProduction[symbol]) {
+            if (auto* path = getLocalPath(symbol, symbolDepth)) {
+                place(*path, turtle, out);
+            } else {
+                const auto& production = grammar.productions[symbol];
+                frames[numFrames++] = { production.data(), production.data() + production.size(), symbolDepth - 1 };
             }
-            current = std::move(next);
+        } else {
+            step(symbol, turtle, out);
         }
     }
+}
+
+const FractalParser::LocalPath* FractalParser::getLocalPath(unsigned char symbol, int depth) {
+    auto& cached = localPaths[(size_t) depth * NUM_SYMBOLS + symbol];
+    if (cached != nullptr) return cached.get();
+
+    const auto& stats = grammar.stats[depth][symbol];
+    // A path that pops past its own pushes would need the caller's stack
+    if (stats.net != 0 || stats.lowest < 0) return nullptr;
+    if (stats.visits < MIN_CACHED_VISITS) return nullptr;
+    if (cachedLines + stats.lines > getMaxLines()) return nullptr;
 
-    commandsDirty = false;
+    cachedLines += stats.lines;
+    auto path = std::make_unique<LocalPath>();
+    path->segments.reserve((size_t) stats.lines);
+
+    Turtle local;
+    walk(grammar.productions[symbol], depth - 1, local, path->segments);
+    path->endX = local.x;
+    path->endY = local.y;
+    path->endHeading = local.heading;
+
+    cached = std::move(path);
+    return cached.get();
 }
 
-// ---- Single-pass turtle walk: compute bounding box and build normalised segments ----
-//
-// Walks the command list once, collecting raw (unnormalised) draw segments
-// and tracking the bounding box simultaneously.  After the walk the segments
-// are normalised in-place.
+void FractalParser::step(unsigned char symbol, Turtle& turtle, std::vector<FractalPath::DrawSegment>& out) const {
+    if (isDraw(symbol)) {
+        float rad = turtle.heading * (juce::MathConstants<float>::pi / 180.0f);
+        float cosVal = std::cos(rad);
+        float sinVal = std::sin(rad);
+        // Store raw (unnormalised) segment — normalised once the level is built
+        out.push_back({turtle.x, turtle.y, cosVal, sinVal});
+        turtle.x += cosVal;
+        turtle.y += sinVal;
+        return;
+    }
 
-FractalParser::NormParams FractalParser::traceNormAndBuildSegments(
-        const std::vector<FractalCmd>& cmds, float angleDeg,
-        std::shared_ptr<const std::vector<FractalPath::DrawSegment>>& outSegments) {
-    const int cmdCount = static_cast<int>(cmds.size());
+    switch (symbol) {
+        case 'f': {
+            float rad = turtle.heading * (juce::MathConstants<float>::pi / 180.0f);
+            turtle.x += std::cos(rad);
+            turtle.y += std::sin(rad);
+            break;
+        }
+        case '+': turtle.heading += baseAngleDegrees; break;
+        case '-': turtle.heading -= baseAngleDegrees; break;
+        case '[': turtle.stack.push_back({turtle.x, turtle.y, turtle.heading}); break;
+        case ']':
+            if (!turtle.stack.empty()) {
+                turtle.x = turtle.stack.back().x; turtle.y = turtle.stack.back().y; turtle.heading = turtle.stack.back().heading;
+                turtle.stack.pop_back();
+            }
+            break;
+        default: break;
+    }
+}
+
+void FractalParser::place(const LocalPath& path, Turtle& turtle, std::vector<FractalPath::DrawSegment>& out) {
+    float rad = turtle.heading * (juce::MathConstants<float>::pi / 180.0f);
+    float c = std::cos(rad);
+    float s = std::sin(rad);
+
+    for (const auto& seg : path.segments) {
+        out.push_back({turtle.x + c * seg.x - s * seg.y, turtle.y + s * seg.x + c * seg.y,
+                       c * seg.dx - s * seg.dy, s * seg.dx + c * seg.dy});
+    }
+
+    turtle.x += c * path.endX - s * path.endY;
+    turtle.y += s * path.endX + c * path.endY;
+    turtle.heading += path.endHeading;
+}
+
+// ---- Build one iteration's normalised segments ----
+
+std::shared_ptr<const std::vector<FractalPath::DrawSegment>> FractalParser::buildLevel(int level) {
+    const auto symbols = axiom.toStdString();
 
     auto segs = std::make_shared<std::vector<FractalPath::DrawSegment>>();
-    // Rough upper-bound reserve — most commands are draws in typical fractals
-    segs->reserve(cmdCount);
+    segs->reserve((size_t) getSequenceStats(symbols, level).lines);
 
-    float x = 0.0f, y = 0.0f, heading = 90.0f;
-    float minX = 0.0f, maxX = 0.0f, minY = 0.0f, maxY = 0.0f;
+    Turtle turtle;
+    turtle.heading = 90.0f;
+    walk(symbols, level, turtle, *segs);
 
-    struct StackEntry { float x, y, heading; };
-    std::vector<StackEntry> stack;
-    stack.reserve(64);
-
-    for (int i = 0; i < cmdCount; ++i) {
-        switch (cmds[i]) {
-            case FractalCmd::Draw: {
-                minX = std::min(minX, x); maxX = std::max(maxX, x);
-                minY = std::min(minY, y); maxY = std::max(maxY, y);
-                float rad = heading * (juce::MathConstants<float>::pi / 180.0f);
-                float cosVal = std::cos(rad);
-                float sinVal = std::sin(rad);
-                // Store raw (unnormalised) segment — will be normalised below
-                segs->push_back({x, y, cosVal, sinVal});
-                x += cosVal;
-                y += sinVal;
-                minX = std::min(minX, x); maxX = std::max(maxX, x);
-                minY = std::min(minY, y); maxY = std::max(maxY, y);
-                break;
-            }
-            case FractalCmd::Move: {
-                float rad = heading * (juce::MathConstants<float>::pi / 180.0f);
-                x += std::cos(rad);
-                y += std::sin(rad);
-                break;
-            }
-            case FractalCmd::TurnRight: heading += angleDeg; break;
-            case FractalCmd::TurnLeft:  heading -= angleDeg; break;
-            case FractalCmd::Push: stack.push_back({x, y, heading}); break;
-            case FractalCmd::Pop:
-                if (!stack.empty()) {
-                    x = stack.back().x; y = stack.back().y; heading = stack.back().heading;
-                    stack.pop_back();
-                }
-                break;
-        }
+    // Bounding box of every drawn point, and the starting point
+    float minX = 0.0f, maxX = 0.0f, minY = 0.0f, maxY = 0.0f;
+    for (const auto& seg : *segs) {
+        minX = std::min({minX, seg.x, seg.x + seg.dx}); maxX = std::max({maxX, seg.x, seg.x + seg.dx});
+        minY = std::min({minY, seg.y, seg.y + seg.dy}); maxY = std::max({maxY, seg.y, seg.y + seg.dy});
     }
 
-    // Compute norm params from bounding box
     float w = maxX - minX;
     float h = maxY - minY;
     float maxDim = std::max(w, h);
 
-    NormParams norm;
-    if (maxDim < 1e-8f) {
-        norm.cx = norm.cy = 0;
-        norm.scale = 1.0f;
-    } else {
-        norm.cx = (minX + maxX) * 0.5f;
-        norm.cy = (minY + maxY) * 0.5f;
-        norm.scale = 2.0f / maxDim;
+    float cx = 0.0f, cy = 0.0f, scale = 1.0f;
+    if (maxDim >= 1e-8f) {
+        cx = (minX + maxX) * 0.5f;
+        cy = (minY + maxY) * 0.5f;
+        scale = 2.0f / maxDim;
     }
 
     // Normalise segments in-place
     for (auto& seg : *segs) {
-        seg.x  = (seg.x - norm.cx) * norm.scale;
-        seg.y  = (seg.y - norm.cy) * norm.scale;
-        seg.dx *= norm.scale;
-        seg.dy *= norm.scale;
+        seg.x  = (seg.x - cx) * scale;
+        seg.y  = (seg.y - cy) * scale;
+        seg.dx *= scale;
+        seg.dy *= scale;
     }
 
-    outSegments = std::move(segs);
-    return norm;
+    return segs;
 }
 
 // ---- Main draw: returns a single FractalPath shape ----
@@ -300,16 +376,21 @@ FractalParser::NormParams FractalParser::traceNormAndBuildSegments(
 std::vector<std::unique_ptr<osci::Shape>> FractalParser::draw() {
     int iters = currentIterations.load(std::memory_order_relaxed);
 
-    if (commandsDirty) {
-        rebuildAllLevels();
+    if (grammarDirty) {
+        compileGrammar();
     }
 
-    int level = juce::jlimit(0, maxCachedLevel, iters);
-    auto& data = levels[level];
+    int level = chooseLevel(iters);
+    renderedIterations.store(level, std::memory_order_relaxed);
+
+    auto& segments = levels[level];
+    if (segments == nullptr) {
+        segments = buildLevel(level);
+    }
 
     std::vector<std::unique_ptr<osci::Shape>> shapes;
-    if (data.numDraws > 0) {
-        shapes.push_back(std::make_unique<FractalPath>(data.segments));
+    if (!segments->empty()) {
+        shapes.push_back(std::make_unique<FractalPath>(segments));
     }
     return shapes;
 }
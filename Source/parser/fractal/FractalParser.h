@@ -6,6 +6,7 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <array>
 #include "../../../modules/osci_render_core/shape/osci_Shape.h"
 #include "../../../modules/osci_render_core/shape/osci_Point.h"
 
@@ -51,12 +52,23 @@ private:
 
 class FractalParser {
 public:
+    static constexpr int kDefaultMaxLines = 1 << 20;
+    static constexpr int kMaxLinesLimit = 1 << 24;
+
     FractalParser(const juce::String& jsonContent);
 
     std::vector<std::unique_ptr<osci::Shape>> draw();
 
     void setIterations(int iterations);
 
+    // Caps the number of lines in a frame. Iterations that would draw more
+    // fall back to the deepest iteration that fits.
+    void setMaxLines(int maxLines);
+    int getMaxLines() const { return maxLines.load(std::memory_order_relaxed); }
+
+    // The iteration the last draw() rendered, after the line cap.
+    int getRenderedIterations() const { return renderedIterations.load(std::memory_order_relaxed); }
+
     // Returns true (and atomically clears) if parameters have changed
     // since the last call.  Drives the queue-flush path in FrameProducer.
     bool consumeDirty();
@@ -75,32 +87,68 @@ private:
     std::vector<FractalRule> rules;
 
     std::atomic<int> currentIterations{3};
+    std::atomic<int> maxLines{kDefaultMaxLines};
+    std::atomic<int> renderedIterations{0};
     std::atomic<bool> frameDirty{false};
 
-    struct NormParams { float cx, cy, scale; };
+    static constexpr int MAX_ITERATIONS = 16;
+    static constexpr int NUM_SYMBOLS = 256;
+
+    // How a symbol grows when expanded to some depth. Counts saturate
+    // rather than overflow for grammars that explode.
+    struct SymbolStats {
+        juce::int64 lines = 0;   // Draw commands
+        juce::int64 visits = 0;  // symbols the turtle walk steps through
+        juce::int64 net = 0;     // [ minus ]
+        juce::int64 lowest = 0;  // lowest running value of net
+    };
+
+    // The rules compiled to a table indexed by symbol, with stats per depth.
+    // None of this depends on the angle.
+    struct Grammar {
+        std::array<std::string, NUM_SYMBOLS> productions;
+        std::array<bool, NUM_SYMBOLS> hasProduction{};
+        std::vector<std::array<SymbolStats, NUM_SYMBOLS>> stats;
+    };
 
-    // Per-level cached data
-    struct LevelData {
-        std::shared_ptr<std::vector<FractalCmd>> commands;
-        int numDraws = 0;
-        NormParams norm{0, 0, 1.0f};
-        std::shared_ptr<const std::vector<FractalPath::DrawSegment>> segments;
+    // What one symbol draws when expanded to a depth, starting at the origin
+    // facing along +x. Placed by rotating and translating to the turtle.
+    struct LocalPath {
+        std::vector<FractalPath::DrawSegment> segments;
+        float endX = 0.0f, endY = 0.0f, endHeading = 0.0f;
     };
 
-    std::vector<LevelData> levels;
-    int maxCachedLevel = -1;
-    bool commandsDirty = true;
+    struct Turtle {
+        struct State { float x, y, heading; };
+        float x = 0.0f, y = 0.0f, heading = 0.0f;
+        std::vector<State> stack;
+    };
 
-    static NormParams traceNormAndBuildSegments(
-        const std::vector<FractalCmd>& cmds, float angleDeg,
-        std::shared_ptr<const std::vector<FractalPath::DrawSegment>>& outSegments);
+    Grammar grammar;
+    bool grammarDirty = true;
 
-    std::string applyRules(const std::string& input) const;
-    std::shared_ptr<std::vector<FractalCmd>> stringToCommands(const std::string& lsystemString) const;
-    void rebuildAllLevels();
+    // Indexed by depth * NUM_SYMBOLS + symbol. Shared by every iteration, and
+    // together never more than the line cap.
+    std::vector<std::unique_ptr<LocalPath>> localPaths;
+    juce::int64 cachedLines = 0;
 
-    static constexpr int MAX_ITERATIONS = 16;
-    static constexpr int MAX_STRING_LENGTH = 3000000;
+    // Normalised segments per iteration, built on first use
+    std::vector<std::shared_ptr<const std::vector<FractalPath::DrawSegment>>> levels;
+
+    void compileGrammar();
+    SymbolStats getSequenceStats(const std::string& symbols, int depth) const;
+    int chooseLevel(int iterations) const;
+    std::shared_ptr<const std::vector<FractalPath::DrawSegment>> buildLevel(int level);
+
+    void walk(const std::string& symbols, int depth, Turtle& turtle, std::vector<FractalPath::DrawSegment>& out);
+    const LocalPath* getLocalPath(unsigned char symbol, int depth);
+    void step(unsigned char symbol, Turtle& turtle, std::vector<FractalPath::DrawSegment>& out) const;
+    static void place(const LocalPath& path, Turtle& turtle, std::vector<FractalPath::DrawSegment>& out);
+
+    // Symbols that visit fewer than this are cheaper to walk than to cache
+    static constexpr int MIN_CACHED_VISITS = 64;
+    // Walking a level may visit at most this many symbols per allowed line
+    static constexpr int MAX_VISITS_PER_LINE = 8;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FractalParser)
 };
@@ -0,0 +1,448 @@
+#include "IndexedLineArt.h"
+#include "LineArtParser.h"
+#include "../PathOrderOptimiser.h"
+
+namespace {
+    constexpr char kMagic[8] = { 'G', 'P', 'L', 'A', 'I', 'D', 'X', '\0' };
+    // 2: strokes are stored in drawing order.
+    constexpr juce::uint32 kVersion = 2;
+    constexpr size_t kHeaderSize = 40;
+    constexpr size_t kFrameHeaderSize = 16;
+    constexpr size_t kObjectHeaderSize = 16 * 8 + 8;
+    constexpr size_t kStrokeHeaderSize = 8;
+
+    constexpr double kIdentity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+    // Reads the 8-byte words of a binary GPLA file, mirroring the walk in
+    // LineArtParser::parseBinaryFrames.
+    struct WordReader {
+        const char* data;
+        size_t numWords;
+        size_t index = 0;
+
+        bool next(int64_t& word) {
+            if (index >= numWords) return false;
+            std::memcpy(&word, data + index * 8, 8);
+            index++;
+            return true;
+        }
+
+        bool nextTag(int64_t& word) { return next(word); }
+
+        static bool is(int64_t word, const char* tag) {
+            return std::memcmp(&word, tag, 8) == 0;
+        }
+
+        static double asDouble(int64_t word) {
+            double d;
+            std::memcpy(&d, &word, 8);
+            return d;
+        }
+    };
+
+    struct PendingObject {
+        double matrix[16];
+        std::vector<std::vector<double>> strokes;
+    };
+
+    // Strokes are reordered here, once per file, so drawing a frame never
+    // has to and every loop of an animation draws them in the same order.
+    void writeFrame(juce::OutputStream& out, double focalLength, const std::vector<PendingObject>& objects, PathOrderOptimiser::Result& ordering) {
+        out.writeDouble(focalLength);
+        out.writeInt((int) objects.size());
+        out.writeInt(0);
+        for (auto& object : objects) {
+            for (double m : object.matrix) {
+                out.writeDouble(m);
+            }
+
+            std::vector<std::vector<osci::Point>> strokes;
+            strokes.reserve(object.strokes.size());
+            for (auto& flat : object.strokes) {
+                // Empty strokes break reordering and have nothing to draw.
+                if (flat.size() < 3) continue;
+                auto& stroke = strokes.emplace_back();
+                stroke.reserve(flat.size() / 3);
+                for (size_t v = 0; v + 2 < flat.size(); v += 3) {
+                    stroke.emplace_back(flat[v], flat[v + 1], flat[v + 2]);
+                }
+            }
+            ordering.add(PathOrderOptimiser::optimiseStrokes(strokes, { true, IndexedLineArt::kReorderBudgetMs }));
+
+            out.writeInt((int) strokes.size());
+            out.writeInt(0);
+            for (auto& stroke : strokes) {
+                out.writeInt((int) stroke.size());
+                out.writeInt(0);
+                for (auto& point : stroke) {
+                    out.writeDouble(point.x);
+                    out.writeDouble(point.y);
+                    out.writeDouble(point.z);
+                }
+            }
+        }
+    }
+}
+
+IndexedLineArt::IndexedLineArt(std::unique_ptr<juce::MemoryMappedFile> mapped, std::unique_ptr<juce::MemoryBlock> memory)
+    : mappedFile(std::move(mapped)), memoryIndex(std::move(memory)) {
+    if (mappedFile != nullptr) {
+        base = static_cast<const char*>(mappedFile->getData());
+        size = mappedFile->getSize();
+    } else if (memoryIndex != nullptr) {
+        base = static_cast<const char*>(memoryIndex->getData());
+        size = memoryIndex->getSize();
+    }
+}
+
+IndexedLineArt::~IndexedLineArt() = default;
+
+juce::uint64 IndexedLineArt::hashSource(const void* data, size_t size) {
+    // 64-bit FNV-1a over whole words - only used to key the cache, and the
+    // source size is checked as well.
+    juce::uint64 hash = 14695981039346656037ull;
+    auto bytes = static_cast<const char*>(data);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        juce::uint64 word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ (juce::uint8) bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+juce::uint64 IndexedLineArt::readUInt64(size_t offset) const {
+    juce::uint64 value;
+    std::memcpy(&value, base + offset, 8);
+    return juce::ByteOrder::swapIfBigEndian(value);
+}
+
+bool IndexedLineArt::validate(juce::uint64 expectedSourceSize, juce::uint64 expectedSourceHash) {
+    if (base == nullptr || size < kHeaderSize || std::memcmp(base, kMagic, 8) != 0) return false;
+    if (juce::ByteOrder::littleEndianInt(base + 8) != kVersion) return false;
+
+    numFrames = (int) juce::ByteOrder::littleEndianInt(base + 12);
+    tableOffset = (size_t) readUInt64(32);
+
+    if (readUInt64(16) != expectedSourceSize || readUInt64(24) != expectedSourceHash) return false;
+    if (numFrames <= 0 || tableOffset < kHeaderSize || tableOffset > size) return false;
+    if ((size - tableOffset) / 8 < (size_t) numFrames + 1) return false;
+
+    return readUInt64(tableOffset + (size_t) numFrames * 8) <= tableOffset;
+}
+
+void IndexedLineArt::pruneCache(const juce::File& cacheDirectory) {
+    auto files = cacheDirectory.findChildFiles(juce::File::findFiles, false, "*.gplaidx");
+    if (files.size() <= kMaxCacheFiles) return;
+
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b) {
+        return a.getLastModificationTime() > b.getLastModificationTime();
+    });
+    for (int i = kMaxCacheFiles; i < files.size(); i++) {
+        files[i].deleteFile();
+    }
+}
+
+std::unique_ptr<IndexedLineArt> IndexedLineArt::open(const juce::MemoryBlock& data, const juce::File& cacheDirectory) {
+    const auto sourceHash = hashSource(data.getData(), data.getSize());
+    const auto sourceSize = (juce::uint64) data.getSize();
+
+    auto cacheFile = cacheDirectory.getChildFile(juce::String::toHexString((juce::int64) sourceHash) + ".gplaidx");
+
+    auto mapFile = [&]() -> std::unique_ptr<IndexedLineArt> {
+        auto mapped = std::make_unique<juce::MemoryMappedFile>(cacheFile, juce::MemoryMappedFile::readOnly);
+        if (mapped->getData() == nullptr) return nullptr;
+        std::unique_ptr<IndexedLineArt> index(new IndexedLineArt(std::move(mapped), nullptr));
+        if (!index->validate(sourceSize, sourceHash)) return nullptr;
+        // Access times aren't reliably kept up to date, so a hit refreshes
+        // the modification time instead, which is what pruneCache sorts by.
+        cacheFile.setLastModificationTime(juce::Time::getCurrentTime());
+        return index;
+    };
+
+    if (cacheFile.existsAsFile()) {
+        if (auto index = mapFile()) return index;
+        cacheFile.deleteFile();
+    }
+
+    if (cacheDirectory.createDirectory()) {
+        juce::TemporaryFile temp(cacheFile);
+        bool built = false;
+        {
+            juce::FileOutputStream out(temp.getFile());
+            built = out.openedOk() && build(data.getData(), data.getSize(), out) > 0;
+            out.flush();
+            built = built && !out.getStatus().failed();
+        }
+        if (built && temp.overwriteTargetFileWithTemporary()) {
+            pruneCache(cacheDirectory);
+            if (auto index = mapFile()) return index;
+        }
+    }
+
+    // Couldn't use the cache - keep the index in memory instead.
+    auto memory = std::make_unique<juce::MemoryBlock>();
+    {
+        juce::MemoryOutputStream out(*memory, false);
+        if (build(data.getData(), data.getSize(), out) <= 0) return nullptr;
+    }
+    std::unique_ptr<IndexedLineArt> index(new IndexedLineArt(nullptr, std::move(memory)));
+    if (!index->validate(sourceSize, sourceHash)) return nullptr;
+    return index;
+}
+
+int IndexedLineArt::build(const void* data, size_t size, juce::OutputStream& out) {
+    const auto start = out.getPosition();
+
+    out.write(kMagic, 8);
+    out.writeInt((int) kVersion);
+    out.writeInt(0);  // numFrames, patched below
+    out.writeInt64((juce::int64) size);
+    out.writeInt64((juce::int64) hashSource(data, size));
+    out.writeInt64(0); // tableOffset, patched below
+
+    std::vector<juce::uint64> offsets;
+    PathOrderOptimiser::Result ordering;
+    int frames;
+    auto bytes = static_cast<const char*>(data);
+    if (size >= 8 && std::memcmp(bytes, "GPLA    ", 8) == 0) {
+        frames = buildFromBinary(bytes, size, out, offsets, ordering);
+    } else {
+        frames = buildFromJson(juce::String::fromUTF8(bytes, (int) size), out, offsets, ordering);
+    }
+    if (frames <= 0) return frames;
+    juce::Logger::writeToLog("IndexedLineArt: indexed " + juce::String(frames) + " frames, " + ordering.describe());
+
+    const auto tableOffset = out.getPosition() - start;
+    offsets.push_back((juce::uint64) tableOffset);
+    for (auto offset : offsets) {
+        out.writeInt64((juce::int64) offset);
+    }
+
+    const auto end = out.getPosition();
+    if (!out.setPosition(start + 12)) return -1;
+    out.writeInt(frames);
+    out.setPosition(start + 32);
+    out.writeInt64(tableOffset);
+    out.setPosition(end);
+
+    return frames;
+}
+
+int IndexedLineArt::buildFromBinary(const char* data, size_t size, juce::OutputStream& out, std::vector<juce::uint64>& offsets, PathOrderOptimiser::Result& ordering) {
+    const auto start = out.getPosition() - (juce::int64) kHeaderSize;
+    WordReader reader { data, size / 8 };
+    int64_t word;
+
+    // Header: tag, major, minor, patch, "FILE", then key/value pairs until DONE.
+    for (int i = 0; i < 4; i++) {
+        if (!reader.next(word)) return -1;
+    }
+    if (!reader.next(word) || !WordReader::is(word, "FILE    ")) return -1;
+    if (!reader.nextTag(word)) return -1;
+    while (!WordReader::is(word, "DONE    ")) {
+        if (!reader.next(word) || !reader.nextTag(word)) return -1;
+    }
+
+    if (!reader.nextTag(word)) return -1;
+    while (!WordReader::is(word, "END GPLA")) {
+        if (WordReader::is(word, "FRAME   ")) {
+            double focalLength = 0.0;
+            std::vector<PendingObject> objects;
+
+            if (!reader.nextTag(word)) return -1;
+            while (!WordReader::is(word, "OBJECTS ")) {
+                int64_t value;
+                if (!reader.next(value)) return -1;
+                if (WordReader::is(word, "focalLen")) {
+                    focalLength = WordReader::asDouble(value);
+                }
+                if (!reader.nextTag(word)) return -1;
+            }
+
+            if (!reader.nextTag(word)) return -1;
+            while (!WordReader::is(word, "DONE    ")) {
+                if (WordReader::is(word, "OBJECT  ")) {
+                    PendingObject object;
+                    std::copy(std::begin(kIdentity), std::end(kIdentity), object.matrix);
+
+                    if (!reader.nextTag(word)) return -1;
+                    while (!WordReader::is(word, "DONE    ")) {
+                        if (WordReader::is(word, "MATRIX  ")) {
+                            for (int i = 0; i < 16; i++) {
+                                if (!reader.next(word)) return -1;
+                                object.matrix[i] = WordReader::asDouble(word);
+                            }
+                            if (!reader.next(word)) return -1;
+                        } else if (WordReader::is(word, "STROKES ")) {
+                            if (!reader.nextTag(word)) return -1;
+                            while (!WordReader::is(word, "DONE    ")) {
+                                if (WordReader::is(word, "STROKE  ")) {
+                                    auto& stroke = object.strokes.emplace_back();
+                                    int64_t vertexCount = 0;
+
+                                    if (!reader.nextTag(word)) return -1;
+                                    while (!WordReader::is(word, "DONE    ")) {
+                                        if (WordReader::is(word, "vertexCt")) {
+                                            if (!reader.next(vertexCount)) return -1;
+                                        } else if (WordReader::is(word, "VERTICES")) {
+                                            if (vertexCount < 0 || reader.index + (size_t) vertexCount * 3 > reader.numWords) return -1;
+                                            stroke.resize((size_t) vertexCount * 3);
+                                            std::memcpy(stroke.data(), data + reader.index * 8, stroke.size() * sizeof(double));
+                                            reader.index += stroke.size();
+
+                                            if (!reader.nextTag(word)) return -1;
+                                            while (!WordReader::is(word, "DONE    ")) {
+                                                if (!reader.nextTag(word)) return -1;
+                                            }
+                                        }
+                                        if (!reader.nextTag(word)) return -1;
+                                    }
+                                }
+                                if (!reader.nextTag(word)) return -1;
+                            }
+                        }
+                        if (!reader.nextTag(word)) return -1;
+                    }
+                    objects.push_back(std::move(object));
+                }
+                if (!reader.nextTag(word)) return -1;
+            }
+
+            offsets.push_back((juce::uint64) (out.getPosition() - start));
+            writeFrame(out, focalLength, objects, ordering);
+        }
+        if (!reader.nextTag(word)) return -1;
+    }
+
+    return (int) offsets.size();
+}
+
+int IndexedLineArt::buildFromJson(const juce::String& jsonStr, juce::OutputStream& out, std::vector<juce::uint64>& offsets, PathOrderOptimiser::Result& ordering) {
+    const auto start = out.getPosition() - (juce::int64) kHeaderSize;
+
+    juce::var json;
+    if (juce::JSON::parse(jsonStr, json).failed()) return -1;
+
+    auto* jsonFrames = json.getProperty("frames", juce::var()).getArray();
+    if (jsonFrames == nullptr) return -1;
+
+    // Same format as LineArtParser::parseJsonFrames. Frames without objects or
+    // a focal length are skipped, as they are there.
+    for (auto& jsonFrame : *jsonFrames) {
+        auto* objectsVar = jsonFrame.getProperty("objects", juce::var()).getArray();
+        auto focalLengthVar = jsonFrame.getProperty("focalLength", juce::var());
+        if (objectsVar == nullptr || objectsVar->isEmpty() || focalLengthVar.isVoid()) continue;
+
+        std::vector<PendingObject> objects;
+        for (auto& objectVar : *objectsVar) {
+            PendingObject object;
+            std::copy(std::begin(kIdentity), std::end(kIdentity), object.matrix);
+
+            if (auto* matrix = objectVar.getProperty("matrix", juce::var()).getArray()) {
+                for (int i = 0; i < juce::jmin(16, matrix->size()); i++) {
+                    object.matrix[i] = (*matrix)[i];
+                }
+            }
+
+            if (auto* strokes = objectVar.getProperty("vertices", juce::var()).getArray()) {
+                for (auto& strokeVar : *strokes) {
+                    auto& stroke = object.strokes.emplace_back();
+                    if (auto* vertices = strokeVar.getArray()) {
+                        stroke.reserve((size_t) vertices->size() * 3);
+                        for (auto& vertex : *vertices) {
+                            stroke.push_back(vertex.getProperty("x", 0));
+                            stroke.push_back(vertex.getProperty("y", 0));
+                            stroke.push_back(vertex.getProperty("z", 0));
+                        }
+                    }
+                }
+            }
+            objects.push_back(std::move(object));
+        }
+
+        offsets.push_back((juce::uint64) (out.getPosition() - start));
+        writeFrame(out, (double) focalLengthVar, objects, ordering);
+    }
+
+    return (int) offsets.size();
+}
+
+std::vector<osci::Line> IndexedLineArt::decodeFrame(int index) {
+    const size_t begin = (size_t) readUInt64(tableOffset + (size_t) index * 8);
+    const size_t end = (size_t) readUInt64(tableOffset + (size_t) (index + 1) * 8);
+    if (begin < kHeaderSize || end > tableOffset || begin + kFrameHeaderSize > end) return {};
+
+    auto readDouble = [this](size_t offset) {
+        double value;
+        std::memcpy(&value, base + offset, 8);
+        return value;
+    };
+    auto readCount = [this](size_t offset) {
+        return (size_t) juce::ByteOrder::littleEndianInt(base + offset);
+    };
+
+    size_t pos = begin;
+    const double focalLength = readDouble(pos);
+    const size_t numObjects = readCount(pos + 8);
+    pos += kFrameHeaderSize;
+    // Counts come from the file, so check them before reserving anything.
+    if (numObjects > (end - pos) / kObjectHeaderSize) return {};
+
+    std::vector<std::vector<std::vector<osci::Point>>> allVertices;
+    std::vector<std::vector<double>> allMatrices;
+    allVertices.reserve(numObjects);
+    allMatrices.reserve(numObjects);
+
+    for (size_t o = 0; o < numObjects; o++) {
+        if (pos + kObjectHeaderSize > end) return {};
+        auto& matrix = allMatrices.emplace_back(16);
+        for (int i = 0; i < 16; i++) {
+            matrix[i] = readDouble(pos + (size_t) i * 8);
+        }
+        const size_t numStrokes = readCount(pos + 128);
+        pos += kObjectHeaderSize;
+        if (numStrokes > (end - pos) / kStrokeHeaderSize) return {};
+
+        auto& strokes = allVertices.emplace_back();
+        strokes.reserve(numStrokes);
+        for (size_t s = 0; s < numStrokes; s++) {
+            if (pos + kStrokeHeaderSize > end) return {};
+            const size_t numVertices = readCount(pos);
+            pos += kStrokeHeaderSize;
+            if (numVertices > (end - pos) / 24) return {};
+
+            auto& stroke = strokes.emplace_back();
+            stroke.reserve(numVertices);
+            for (size_t v = 0; v < numVertices; v++) {
+                stroke.emplace_back(readDouble(pos), readDouble(pos + 8), readDouble(pos + 16));
+                pos += 24;
+            }
+        }
+    }
+
+    return LineArtParser::assembleFrame(allVertices, allMatrices, focalLength);
+}
+
+std::shared_ptr<const std::vector<osci::Line>> IndexedLineArt::getFrame(int index) {
+    if (index < 0 || index >= numFrames) return nullptr;
+
+    juce::ScopedLock sl(cacheLock);
+    for (auto it = decodedFrames.begin(); it != decodedFrames.end(); ++it) {
+        if (it->first == index) {
+            // Move to the front so the least recently used frame is evicted first.
+            std::rotate(decodedFrames.begin(), it, it + 1);
+            return decodedFrames.front().second;
+        }
+    }
+
+    auto frame = std::make_shared<const std::vector<osci::Line>>(decodeFrame(index));
+    decodedFrames.insert(decodedFrames.begin(), { index, frame });
+    if ((int) decodedFrames.size() > kDecodedFrameCacheSize) {
+        decodedFrames.pop_back();
+    }
+    return frame;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <JuceHeader.h>
+#include "../PathOrderOptimiser.h"
+
+// Indexed, memory-mapped form of a GPLA animation.
+//
+// The first time a GPLA file (binary or JSON) is opened it is streamed once
+// into an indexed cache file: raw per-frame object/stroke/vertex records
+// followed by a frame offset table. Later opens map that file and do no
+// parsing at all. Strokes are reordered to minimise beam travel while the
+// index is built and stored in that order. Building happens synchronously
+// inside open(), so that first open still costs a full pass over the file
+// (and, for JSON, a juce::var tree of all of it). Frames are only decoded
+// (perspective projection) when they are drawn, and the last few decoded
+// frames are kept so scrubbing back and forth stays cheap.
+//
+// Layout (little-endian):
+//   header:  char[8] "GPLAIDX\0", uint32 version, uint32 numFrames,
+//            uint64 sourceSize, uint64 sourceHash, uint64 tableOffset
+//   frame:   double focalLength, uint32 numObjects, uint32 reserved
+//   object:  double matrix[16], uint32 numStrokes, uint32 reserved
+//   stroke:  uint32 numVertices, uint32 reserved, double xyz[numVertices * 3]
+//   table:   uint64 frameOffset[numFrames + 1]
+class IndexedLineArt {
+public:
+    // Opens the indexed form of the GPLA file in data, building it into
+    // cacheDirectory if it isn't there yet. If the cache can't be written the
+    // index is built in memory instead. Returns nullptr if the file can't be
+    // parsed or contains no frames.
+    static std::unique_ptr<IndexedLineArt> open(const juce::MemoryBlock& data, const juce::File& cacheDirectory);
+
+    // Builds the index into an output stream. Returns the number of frames
+    // written, or -1 if the source couldn't be parsed.
+    static int build(const void* data, size_t size, juce::OutputStream& out);
+
+    ~IndexedLineArt();
+
+    int getNumFrames() const { return numFrames; }
+
+    // Decodes and projects a frame, or returns it from the decoded-frame cache.
+    std::shared_ptr<const std::vector<osci::Line>> getFrame(int index);
+
+    static constexpr int kDecodedFrameCacheSize = 4;
+    // Index files kept in the cache directory; the least recently opened go first.
+    static constexpr int kMaxCacheFiles = 16;
+    // Budget for 2-opt per object while the index is built, which keeps the
+    // first open of a long animation bounded.
+    static constexpr double kReorderBudgetMs = 2.0;
+
+private:
+    IndexedLineArt(std::unique_ptr<juce::MemoryMappedFile> mapped, std::unique_ptr<juce::MemoryBlock> memory);
+
+    bool validate(juce::uint64 expectedSourceSize, juce::uint64 expectedSourceHash);
+    std::vector<osci::Line> decodeFrame(int index);
+    juce::uint64 readUInt64(size_t offset) const;
+
+    static juce::uint64 hashSource(const void* data, size_t size);
+    static void pruneCache(const juce::File& cacheDirectory);
+    static int buildFromBinary(const char* data, size_t size, juce::OutputStream& out, std::vector<juce::uint64>& offsets, PathOrderOptimiser::Result& ordering);
+    static int buildFromJson(const juce::String& json, juce::OutputStream& out, std::vector<juce::uint64>& offsets, PathOrderOptimiser::Result& ordering);
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    std::unique_ptr<juce::MemoryBlock> memoryIndex;
+    const char* base = nullptr;
+    size_t size = 0;
+    int numFrames = 0;
+    size_t tableOffset = 0;
+
+    juce::CriticalSection cacheLock;
+    std::vector<std::pair<int, std::shared_ptr<const std::vector<osci::Line>>>> decodedFrames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(IndexedLineArt)
+};
@@ -1,19 +1,46 @@
 #include "LineArtParser.h"
+#include "../PathOrderOptimiser.h"
 
 
 LineArtParser::LineArtParser(juce::String json) {
     frames.clear();
     numFrames = 0;
-    frames = parseJsonFrames(json);
+    PathOrderOptimiser::Result ordering;
+    frames = parseJsonFrames(json, &ordering);
     numFrames = frames.size();
+    juce::Logger::writeToLog("LineArtParser: " + ordering.describe());
 }
 
 LineArtParser::LineArtParser(char* data, int dataLength) {
     frames.clear();
     numFrames = 0;
-    frames = parseBinaryFrames(data, dataLength);
+    PathOrderOptimiser::Result ordering;
+    frames = parseBinaryFrames(data, dataLength, &ordering);
     numFrames = frames.size();
     if (numFrames == 0) frames = epicFail();
+    juce::Logger::writeToLog("LineArtParser: " + ordering.describe());
+}
+
+LineArtParser::LineArtParser(const juce::MemoryBlock& data, const juce::File& cacheDirectory) {
+    indexed = IndexedLineArt::open(data, cacheDirectory);
+    if (indexed != nullptr) {
+        numFrames = indexed->getNumFrames();
+        return;
+    }
+
+    // Couldn't index it - parse it the old way so the usual fallbacks apply.
+    char* bytes = (char*)data.getData();
+    int size = (int)data.getSize();
+    PathOrderOptimiser::Result ordering;
+    if (size >= 8 && memcmp(bytes, "GPLA    ", 8) == 0) {
+        frames = parseBinaryFrames(bytes, size, &ordering);
+    } else {
+        frames = parseJsonFrames(juce::String::fromUTF8(bytes, size), &ordering);
+    }
+    numFrames = frames.size();
+    if (numFrames == 0) frames = epicFail();
+    numFrames = frames.size();
+    juce::Logger::writeToLog("LineArtParser: " + ordering.describe());
 }
 
 LineArtParser::~LineArtParser() {
@@ -34,7 +61,7 @@ std::vector<std::vector<osci::Line>> LineArtParser::epicFail() {
     return parseJsonFrames(juce::String(BinaryData::fallback_gpla, BinaryData::fallback_gplaSize));
 }
 
-std::vector<std::vector<osci::Line>> LineArtParser::parseBinaryFrames(char* bytes, int bytesLength) {
+std::vector<std::vector<osci::Line>> LineArtParser::parseBinaryFrames(char* bytes, int bytesLength, PathOrderOptimiser::Result* ordering) {
     int64_t* data = (int64_t*)bytes;
     int dataLength = bytesLength / 8;
     std::vector<std::vector<osci::Line>> tFrames;
@@ -221,7 +248,7 @@ std::vector<std::vector<osci::Line>> LineArtParser::parseBinaryFrames(char* byte
                         index++;
                         makeChars(rawData, tag);
                     }
-                    allVertices.push_back(reorderVertices(vertices));
+                    allVertices.push_back(reorderVertices(vertices, ordering));
                     allMatrices.push_back(matrix);
                     vertices.clear();
                     matrix.clear();
@@ -242,7 +269,7 @@ std::vector<std::vector<osci::Line>> LineArtParser::parseBinaryFrames(char* byte
     return tFrames;
 }
 
-std::vector<std::vector<osci::Line>> LineArtParser::parseJsonFrames(juce::String jsonStr) {
+std::vector<std::vector<osci::Line>> LineArtParser::parseJsonFrames(juce::String jsonStr, PathOrderOptimiser::Result* ordering) {
     std::vector<std::vector<osci::Line>> frames;
 
     // format of json is:
@@ -293,7 +320,7 @@ std::vector<std::vector<osci::Line>> LineArtParser::parseJsonFrames(juce::String
         // Ensure that there actually are objects and that the focal length is defined
         if (objects.size() > 0 && !focalLengthVar.isVoid()) {
             double focalLength = focalLengthVar;
-            std::vector<osci::Line> frame = generateFrame(objects, focalLength);
+            std::vector<osci::Line> frame = generateFrame(objects, focalLength, ordering);
             if (frame.size() > 0) {
                 hasValidFrames = true;
             }
@@ -315,6 +342,17 @@ void LineArtParser::setFrame(int fNum) {
 
 std::vector<std::unique_ptr<osci::Shape>> LineArtParser::draw() {
 	std::vector<std::unique_ptr<osci::Shape>> tempShapes;
+
+	if (indexed != nullptr) {
+		auto frame = indexed->getFrame(frameNumber);
+		if (frame != nullptr) {
+			tempShapes.reserve(frame->size());
+			for (const osci::Line& shape : *frame) {
+				tempShapes.push_back(shape.clone());
+			}
+		}
+		return tempShapes;
+	}
 	
 	for (osci::Line shape : frames[frameNumber]) {
 		tempShapes.push_back(shape.clone());
@@ -322,52 +360,15 @@ std::vector<std::unique_ptr<osci::Shape>> LineArtParser::draw() {
     return tempShapes;
 }
 
-std::vector<std::vector<osci::Point>> LineArtParser::reorderVertices(std::vector<std::vector<osci::Point>> vertices) {
-    std::vector<std::vector<osci::Point>> reorderedVertices;
-
-    if (vertices.size() > 0) {
-        std::vector<bool> visited = std::vector<bool>(vertices.size(), false);
-        std::vector<int> order = std::vector<int>(vertices.size(), 0);
-        visited[0] = true;
-
-        auto endPoint = vertices[0].back();
-
-        for (int i = 1; i < vertices.size(); i++) {
-            int minPath = 0;
-            double minDistance = 9999999;
-            for (int j = 0; j < vertices.size(); j++) {
-                if (!visited[j]) {
-                    auto startPoint = vertices[j][0];
-
-                    double diffX = endPoint.x - startPoint.x;
-                    double diffY = endPoint.y - startPoint.y;
-                    double diffZ = endPoint.z - startPoint.z;
-
-                    double distance = std::sqrt(diffX * diffX + diffY * diffY + diffZ * diffZ);
-                    if (distance < minDistance) {
-                        minPath = j;
-                        minDistance = distance;
-                    }
-                }
-            }
-            visited[minPath] = true;
-            order[i] = minPath;
-            endPoint = vertices[minPath].back();
-        }
-
-        for (int i = 0; i < vertices.size(); i++) {
-            std::vector<osci::Point> reorderedVertex;
-            int index = order[i];
-            for (int j = 0; j < vertices[index].size(); j++) {
-                reorderedVertex.push_back(vertices[index][j]);
-            }
-            reorderedVertices.push_back(reorderedVertex);
-        }
+std::vector<std::vector<osci::Point>> LineArtParser::reorderVertices(std::vector<std::vector<osci::Point>> vertices, PathOrderOptimiser::Result* ordering) {
+    auto result = PathOrderOptimiser::optimiseStrokes(vertices, { true, 2.0 });
+    if (ordering != nullptr) {
+        ordering->add(result);
     }
-    return reorderedVertices;
+    return vertices;
 }
 
-std::vector<osci::Line> LineArtParser::generateFrame(juce::Array <juce::var> objects, double focalLength)
+std::vector<osci::Line> LineArtParser::generateFrame(juce::Array <juce::var> objects, double focalLength, PathOrderOptimiser::Result* ordering)
 {
     std::vector<std::vector<double>> allMatrices;
     std::vector<std::vector<std::vector<osci::Point>>> allVertices;
@@ -393,7 +394,7 @@ std::vector<osci::Line> LineArtParser::generateFrame(juce::Array <juce::var> obj
             allMatrices[i].push_back(value);
         }
 
-        allVertices.push_back(reorderVertices(vertices));
+        allVertices.push_back(reorderVertices(vertices, ordering));
     }
     return assembleFrame(allVertices, allMatrices, focalLength);
 }
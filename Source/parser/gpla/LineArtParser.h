@@ -1,20 +1,28 @@
 #pragma once
 #include <JuceHeader.h>
 #include "../svg/SvgParser.h"
+#include "IndexedLineArt.h"
+#include "../PathOrderOptimiser.h"
 
 class LineArtParser {
 public:
 	LineArtParser(juce::String json);
 	LineArtParser(char* data, int dataLength);
+	// Opens a binary or JSON GPLA file through an indexed cache in cacheDirectory
+	// so frames are only decoded when drawn.
+	LineArtParser(const juce::MemoryBlock& data, const juce::File& cacheDirectory);
 	~LineArtParser();
 
 	void setFrame(int fNum);
 	std::vector<std::unique_ptr<osci::Shape>> draw();
 
-	static std::vector<std::vector<osci::Line>> parseJsonFrames(juce::String jsonStr);
-	static std::vector<std::vector<osci::Line>> parseBinaryFrames(char* data, int dataLength);
+	// If ordering is given, every object's stroke reordering is added to it.
+	static std::vector<std::vector<osci::Line>> parseJsonFrames(juce::String jsonStr, PathOrderOptimiser::Result* ordering = nullptr);
+	static std::vector<std::vector<osci::Line>> parseBinaryFrames(char* data, int dataLength, PathOrderOptimiser::Result* ordering = nullptr);
 
-	static std::vector<osci::Line> generateFrame(juce::Array < juce::var> objects, double focalLength);
+	static std::vector<osci::Line> generateFrame(juce::Array < juce::var> objects, double focalLength, PathOrderOptimiser::Result* ordering = nullptr);
+	static std::vector<std::vector<osci::Point>> reorderVertices(std::vector<std::vector<osci::Point>> vertices, PathOrderOptimiser::Result* ordering = nullptr);
+	static std::vector<osci::Line> assembleFrame(std::vector<std::vector<std::vector<osci::Point>>> allVertices, std::vector<std::vector<double>> allMatrices, double focalLength);
 
 	int numFrames = 0;
 	int frameNumber = 0;
@@ -22,8 +30,8 @@ private:
 	static std::vector<std::vector<osci::Line>> epicFail();
 	static double makeDouble(int64_t data);
 	static void makeChars(int64_t data, char* chars);
-	static std::vector<std::vector<osci::Point>> reorderVertices(std::vector<std::vector<osci::Point>> vertices);
-	static std::vector<osci::Line> assembleFrame(std::vector<std::vector<std::vector<osci::Point>>> allVertices, std::vector<std::vector<double>> allMatrices, double focalLength);
 	std::vector<std::vector<osci::Line>> frames;
+	// When set, frames are decoded on demand from here instead of `frames`.
+	std::unique_ptr<IndexedLineArt> indexed;
 	
 };
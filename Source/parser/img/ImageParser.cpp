@@ -54,6 +54,13 @@ ImageParser::ImageParser(OscirenderAudioProcessor& p) : audioProcessor(p), using
     height = 1;
 }
 
+// Constructor for live video input
+ImageParser::ImageParser(OscirenderAudioProcessor& p, LatestFrameSlot& liveFrames) : audioProcessor(p), liveFrames(&liveFrames) {
+    width = 1;
+    height = 1;
+    visited = std::vector<bool>(1, false);
+}
+
 void ImageParser::updateLiveFrame(const juce::Image& newImage)
 {
     if (newImage.isValid()) {
@@ -324,6 +331,21 @@ void ImageParser::setFrame(int index) {
     std::fill(visited.begin(), visited.end(), false);
 }
 
+// Audio thread only. Swaps in the newest live video frame, if there is one.
+void ImageParser::pollLiveFrames() {
+    if (!liveFrames->acquireLatest()) {
+        return;
+    }
+    const auto& frame = liveFrames->getReadFrame();
+    if (frame.width != width || frame.height != height) {
+        // Only happens when the source changes size, not every frame
+        width = frame.width;
+        height = frame.height;
+        visited = std::vector<bool>(width * height, false);
+        resetPosition();
+    }
+}
+
 bool ImageParser::isOverThreshold(double pixel, double thresholdPow) {
     float threshold = std::pow(pixel, thresholdPow);
     return pixel > 0.2 && rng.nextFloat() < threshold;
@@ -351,11 +373,18 @@ float ImageParser::getPixelValue(int x, int y, bool invert) {
         return 0;
     }
     
+    const std::vector<uint8_t>* pixels = nullptr;
+    if (liveFrames != nullptr) {
+        pixels = &liveFrames->getReadFrame().pixels;
+    } else if (frames.size() > 0) {
+        pixels = &frames[frameIndex];
+    }
+
     int index = (height - y - 1) * width + x;
-    if (index < 0 || frames.size() <= 0 || index >= frames[frameIndex].size()) {
+    if (index < 0 || pixels == nullptr || index >= pixels->size()) {
         return 0;
     }
-    float pixel = frames[frameIndex][index] / (float) std::numeric_limits<uint8_t>::max();
+    float pixel = (*pixels)[index] / (float) std::numeric_limits<uint8_t>::max();
     if (invert && pixel > 0) {
         pixel = 1 - pixel;
     }
@@ -410,6 +439,10 @@ void ImageParser::findNearestNeighbour(int searchRadius, float thresholdPow, int
 
 osci::Point ImageParser::getSample(int blockSampleIndex) {
     juce::SpinLock::ScopedLockType lock(liveImageLock);
+
+    if (liveFrames != nullptr && blockSampleIndex == 0) {
+        pollLiveFrames();
+    }
     
     if (ALGORITHM == "HILLIGOSS") {
         if (count % jumpFrequency() == 0) {
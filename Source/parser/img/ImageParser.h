@@ -2,6 +2,7 @@
 #include <JuceHeader.h>
 
 #include "../svg/SvgParser.h"
+#include "../../video/LatestFrameSlot.h"
 
 class OscirenderAudioProcessor;
 class CommonPluginEditor;
@@ -11,6 +12,8 @@ public:
     ImageParser(OscirenderAudioProcessor& p, juce::String fileName, juce::MemoryBlock image);
     // Constructor for live Syphon/Spout input
     ImageParser(OscirenderAudioProcessor& p);
+    // Constructor for live video streamed into `liveFrames`, e.g. by ffmpeg
+    ImageParser(OscirenderAudioProcessor& p, LatestFrameSlot& liveFrames);
     ~ImageParser();
 
     // Update the live frame (for Syphon/Spout)
@@ -24,6 +27,7 @@ public:
 private:
     void findNearestNeighbour(int searchRadius, float thresholdPow, int stride, bool invert);
     void resetPosition();
+    void pollLiveFrames();
     float getPixelValue(int x, int y, bool invert);
     int getPixelIndex(int x, int y);
     void findWhite(double thresholdPow, bool invert);
@@ -69,4 +73,7 @@ private:
     juce::SpinLock liveImageLock;
     bool usingLiveImage = false;
     juce::Image liveImage;
+
+    // Live video support - the parser only ever reads the slot's read frame
+    LatestFrameSlot* liveFrames = nullptr;
 };
@@ -1,4 +1,5 @@
 #include "SvgParser.h"
+#include "../PathOrderOptimiser.h"
 
 SvgParser::SvgParser(juce::String svgFile) {
 	auto doc = juce::XmlDocument::parse(svgFile);
@@ -14,6 +15,9 @@ SvgParser::SvgParser(juce::String svgFile) {
             // Instead of separate scaling for width and height, just get the path as is
             pathToShapes(path, shapes, true); // Enable normalization
             osci::Shape::removeOutOfBounds(shapes);
+
+            auto ordering = PathOrderOptimiser::optimiseShapes(shapes, { true, 50.0 });
+            juce::Logger::writeToLog("SvgParser: " + ordering.describe());
             return;
         }
     }
@@ -69,8 +73,14 @@ void SvgParser::pathToShapes(juce::Path& path, std::vector<std::unique_ptr<osci:
 		}
 	}
 	
-	// Normalize shapes if requested and if there are shapes to normalize
-	if (normalise && !shapes.empty()) {
+	if (normalise) {
+		normaliseShapes(shapes);
+	}
+}
+
+// Centres the shapes and scales them uniformly to fit within -1 to 1
+void SvgParser::normaliseShapes(std::vector<std::unique_ptr<osci::Shape>>& shapes) {
+	if (!shapes.empty()) {
 		// Find the bounding box of all shapes
         float minX = std::numeric_limits<float>::max();
         float minY = std::numeric_limits<float>::max();
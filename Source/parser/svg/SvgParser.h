@@ -7,6 +7,7 @@ public:
 	~SvgParser();
 
 	static void pathToShapes(juce::Path& path, std::vector<std::unique_ptr<osci::Shape>>& shapes, bool normalise = false);
+	static void normaliseShapes(std::vector<std::unique_ptr<osci::Shape>>& shapes);
 
 	std::vector<std::unique_ptr<osci::Shape>> draw();
 private:
@@ -0,0 +1,42 @@
+#include "GlyphOutlineCache.h"
+#include "../svg/SvgParser.h"
+
+juce::String GlyphOutlineCache::getFontKey(const juce::Font& font) {
+    // toString() covers the typeface, height and style. Synthetic bold,
+    // italic and squashing aren't part of the style name.
+    return font.toString()
+        + ";" + juce::String((int) font.isBold()) + juce::String((int) font.isItalic())
+        + ";" + juce::String(font.getHorizontalScale());
+}
+
+std::shared_ptr<const GlyphOutlineCache::Outline> GlyphOutlineCache::getOutline(const juce::Font& font, int glyphCode) {
+    const auto key = getFontKey(font) + ";" + juce::String(glyphCode);
+
+    {
+        const juce::ScopedLock scope(lock);
+        auto it = outlines.find(key);
+        if (it != outlines.end()) {
+            return it->second;
+        }
+    }
+
+    // Build outside the lock so other parsers aren't held up by the typeface.
+    juce::Path path;
+    juce::PositionedGlyph glyph(font, 0, glyphCode, 0.0f, 0.0f, 0.0f, false);
+    glyph.createPath(path);
+
+    auto outline = std::make_shared<Outline>();
+    SvgParser::pathToShapes(path, *outline, false);
+
+    const juce::ScopedLock scope(lock);
+    if ((int) outlines.size() >= kMaxOutlines) {
+        outlines.clear();
+    }
+    auto [it, inserted] = outlines.emplace(key, std::move(outline));
+    return it->second;
+}
+
+int GlyphOutlineCache::getNumCached() const {
+    const juce::ScopedLock scope(lock);
+    return (int) outlines.size();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Flattened outlines of single glyphs, keyed by font and glyph code, so
+// laying out text only has to clone and move shapes rather than ask the
+// typeface for outlines and convert paths again.
+//
+// Outlines have the glyph's origin on the baseline at (0, 0), with y
+// flipped the same way as SvgParser::pathToShapes.
+//
+// Share one cache with juce::SharedResourcePointer<GlyphOutlineCache>.
+class GlyphOutlineCache {
+public:
+    using Outline = std::vector<std::unique_ptr<osci::Shape>>;
+
+    // Returns the outline, creating it if it isn't cached. Whitespace and
+    // glyphs the font can't draw give an empty outline. Thread safe.
+    std::shared_ptr<const Outline> getOutline(const juce::Font& font, int glyphCode);
+
+    int getNumCached() const;
+
+    // Identifies everything about a font that changes its outlines
+    static juce::String getFontKey(const juce::Font& font);
+
+    // Outlines kept before the cache is emptied and starts again. Text that
+    // is being shown keeps its outlines alive through its own references.
+    static constexpr int kMaxOutlines = 8192;
+
+private:
+    juce::CriticalSection lock;
+    std::unordered_map<juce::String, std::shared_ptr<const Outline>> outlines;
+};
@@ -1,18 +1,19 @@
 #include "TextParser.h"
 #include "../svg/SvgParser.h"
+#include "../PathOrderOptimiser.h"
 
 
-TextParser::TextParser(juce::String text, juce::Font& font) : text(text), font(font) {
-    parse(text);
+TextParser::TextParser(juce::String text, juce::Font& font, const TextParser* previous) : font(font), text(text) {
+    parse(text, previous);
 }
 
 TextParser::~TextParser() {
 }
 
-void TextParser::parse(juce::String text) {
+void TextParser::parse(juce::String text, const TextParser* previous) {
     currentFont = font;
-    
-    juce::Path textPath;
+
+    auto shapes = std::make_shared<std::vector<std::unique_ptr<osci::Shape>>>();
 
 #if OSCI_PREMIUM
     // Apply formatting markers if the font is bold or italic
@@ -27,57 +28,141 @@ void TextParser::parse(juce::String text) {
     }
     
     // Parse the text with formatting
-    attributedString = parseFormattedText(formattedText, currentFont);
-    
-    // Create a TextLayout from the AttributedString
-    juce::TextLayout layout;
-    layout.createLayout(attributedString, 64.0f);
+    auto attributedString = parseFormattedText(formattedText, currentFont);
 
-    // Iterate through all lines and all runs in each line
-    for (int i = 0; i < layout.getNumLines(); ++i) {
-        const juce::TextLayout::Line& line = layout.getLine(i);
-        
-        for (int j = 0; j < line.runs.size(); ++j) {
-            juce::TextLayout::Run* run = line.runs.getUnchecked(j);
-            
-            // Create a GlyphArrangement for this run
-            juce::GlyphArrangement glyphs;
-            
-            // Process each glyph in the run
-            for (int k = 0; k < run->glyphs.size(); ++k) {
-                juce::TextLayout::Glyph glyph = run->glyphs.getUnchecked(k);
-                
-                // Create positioned glyph using the glyph's metrics
-                juce::PositionedGlyph positionedGlyph = juce::PositionedGlyph(
-                    run->font,
-                    glyph.glyphCode,  // Use the glyph code directly
-                    glyph.glyphCode,
-                    line.lineOrigin.x + glyph.anchor.x - 1,
-                    line.lineOrigin.y + glyph.anchor.y - 1,
-                    glyph.width,
-                    false  // Don't assume it's whitespace based on character
-                );
-                glyphs.addGlyph(positionedGlyph);
+    // Lay out each line on its own, reusing any line this parser or the one
+    // it replaces has already laid out, and stack them.
+    std::unordered_map<juce::String, std::shared_ptr<const Paragraph>> laidOut;
+    // Blank lines take their height from the base font
+    const auto baseKey = GlyphOutlineCache::getFontKey(currentFont) + "\x1d";
+    numLines = 0;
+    numLinesLaidOut = 0;
+    float y = 0.0f;
+
+    for (const auto& paragraphText : splitParagraphs(attributedString)) {
+        const auto key = baseKey + getParagraphKey(paragraphText);
+        std::shared_ptr<const Paragraph> paragraph;
+
+        if (auto it = laidOut.find(key); it != laidOut.end()) {
+            paragraph = it->second;
+        }
+        for (const TextParser* source : { static_cast<const TextParser*>(this), previous }) {
+            if (paragraph == nullptr && source != nullptr) {
+                const juce::ScopedLock scope(source->paragraphLock);
+                if (auto it = source->paragraphs.find(key); it != source->paragraphs.end()) {
+                    paragraph = it->second;
+                }
             }
-            
-            // Add glyphs to the path
-            glyphs.createPath(textPath);
         }
+
+        if (paragraph == nullptr) {
+            paragraph = layoutParagraph(paragraphText);
+            numLinesLaidOut++;
+        }
+        laidOut[key] = paragraph;
+        numLines++;
+
+        for (const auto& glyph : paragraph->glyphs) {
+            addGlyph(*shapes, *glyph.outline, glyph.x, y + glyph.y);
+        }
+        y += paragraph->height;
+    }
+
+    {
+        const juce::ScopedLock scope(paragraphLock);
+        paragraphs = std::move(laidOut);
     }
     
     // If the layout has no text, fallback to original method
-    if (textPath.isEmpty()) {
+    if (shapes->empty()) {
 #endif
         juce::GlyphArrangement glyphs;
         glyphs.addFittedText(currentFont, text, -2, -2, 4, 4, juce::Justification::centred, 2);
-        glyphs.createPath(textPath);
+        for (int i = 0; i < glyphs.getNumGlyphs(); ++i) {
+            const auto& glyph = glyphs.getGlyph(i);
+            addGlyph(*shapes, *glyphCache->getOutline(glyph.getFont(), glyph.getGlyphNumber()), glyph.getLeft(), glyph.getBaselineY());
+        }
 #if OSCI_PREMIUM
     }
 #endif
 
-    // Convert path to shapes
-    shapes = std::vector<std::unique_ptr<osci::Shape>>();
-    SvgParser::pathToShapes(textPath, shapes, true);
+    SvgParser::normaliseShapes(*shapes);
+
+    // Glyphs come out in layout order, so the beam would otherwise sweep back
+    // and forth across each line. The budget is kept short so typing doesn't
+    // stall frame production.
+    PathOrderOptimiser::optimiseShapes(*shapes, { true, 5.0 });
+
+    frame = std::move(shapes);
+}
+
+// Splits at newlines, keeping each run's font. The newlines themselves are
+// dropped since each paragraph is laid out as a single line of source text.
+std::vector<juce::AttributedString> TextParser::splitParagraphs(const juce::AttributedString& attributed) {
+    std::vector<juce::AttributedString> result(1);
+    const auto& allText = attributed.getText();
+
+    for (int i = 0; i < attributed.getNumAttributes(); ++i) {
+        const auto& attribute = attributed.getAttribute(i);
+        auto run = allText.substring(attribute.range.getStart(), attribute.range.getEnd());
+
+        while (true) {
+            const int newline = run.indexOfChar('\n');
+            auto piece = newline < 0 ? run : run.substring(0, newline);
+            if (piece.isNotEmpty()) {
+                result.back().append(piece, attribute.font);
+            }
+            if (newline < 0) {
+                break;
+            }
+            result.emplace_back();
+            run = run.substring(newline + 1);
+        }
+    }
+
+    return result;
+}
+
+juce::String TextParser::getParagraphKey(const juce::AttributedString& paragraph) {
+    juce::String key;
+    for (int i = 0; i < paragraph.getNumAttributes(); ++i) {
+        const auto& attribute = paragraph.getAttribute(i);
+        key << GlyphOutlineCache::getFontKey(attribute.font) << "\x1f"
+            << paragraph.getText().substring(attribute.range.getStart(), attribute.range.getEnd()) << "\x1e";
+    }
+    return key;
+}
+
+std::shared_ptr<const TextParser::Paragraph> TextParser::layoutParagraph(const juce::AttributedString& paragraphText) {
+    auto paragraph = std::make_shared<Paragraph>();
+
+    juce::TextLayout layout;
+    layout.createLayout(paragraphText, 64.0f);
+
+    // Iterate through all lines and all runs in each line
+    for (int i = 0; i < layout.getNumLines(); ++i) {
+        const juce::TextLayout::Line& line = layout.getLine(i);
+
+        for (auto* run : line.runs) {
+            for (const auto& glyph : run->glyphs) {
+                paragraph->glyphs.push_back({ glyphCache->getOutline(run->font, glyph.glyphCode),
+                                              line.lineOrigin.x + glyph.anchor.x,
+                                              line.lineOrigin.y + glyph.anchor.y });
+            }
+        }
+    }
+
+    paragraph->height = layout.getNumLines() > 0 ? layout.getHeight() : currentFont.getHeight();
+    return paragraph;
+}
+
+void TextParser::addGlyph(std::vector<std::unique_ptr<osci::Shape>>& shapes, const GlyphOutlineCache::Outline& outline, float x, float y) {
+    for (const auto& shape : outline) {
+        auto placed = shape->clone();
+        // Outlines are stored with y flipped
+        placed->translate(x, -y, 0);
+        shapes.push_back(std::move(placed));
+    }
 }
 
 juce::AttributedString TextParser::parseFormattedText(const juce::String& text, juce::Font font) {
@@ -233,14 +318,14 @@ void TextParser::processFormattedTextBody(const juce::String& text, juce::Attrib
 std::vector<std::unique_ptr<osci::Shape>> TextParser::draw() {
     // reparse text if font changes
     if (font != currentFont) {
-        currentFont = font;
-        parse(text);
+        parse(text, nullptr);
     }
     
     // clone with deep copy
     std::vector<std::unique_ptr<osci::Shape>> tempShapes;
+    tempShapes.reserve(frame->size());
     
-    for (auto& shape : shapes) {
+    for (auto& shape : *frame) {
         tempShapes.push_back(shape->clone());
     }
     return tempShapes;
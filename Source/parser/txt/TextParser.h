@@ -1,21 +1,56 @@
 #pragma once
 #include <JuceHeader.h>
+#include "GlyphOutlineCache.h"
 
 class TextParser {
 public:
-	TextParser(juce::String text, juce::Font& font);
+	// previous is the parser for an earlier version of the same file, if
+	// any. Paragraphs it laid out with the same text and fonts are reused.
+	TextParser(juce::String text, juce::Font& font, const TextParser* previous = nullptr);
 	~TextParser();
 
 	std::vector<std::unique_ptr<osci::Shape>> draw();
+
+	// Lines of source text in the current layout, and how many of them had
+	// to be laid out rather than reused
+	int getNumLines() const { return numLines; }
+	int getNumLinesLaidOut() const { return numLinesLaidOut; }
     
 private:
-    void parse(juce::String text);
+    // A glyph's cached outline and where its origin sits in a paragraph
+    struct PlacedGlyph {
+        std::shared_ptr<const GlyphOutlineCache::Outline> outline;
+        float x, y;
+    };
+
+    // One line of source text laid out on its own, so editing a line only
+    // lays that line out again
+    struct Paragraph {
+        std::vector<PlacedGlyph> glyphs;
+        float height = 0.0f;
+    };
+
+    void parse(juce::String text, const TextParser* previous);
     juce::AttributedString parseFormattedText(const juce::String& text, juce::Font font);
     void processFormattedTextBody(const juce::String& text, juce::AttributedString& result, juce::Font font);
-    
+
+    std::shared_ptr<const Paragraph> layoutParagraph(const juce::AttributedString& paragraph);
+    static std::vector<juce::AttributedString> splitParagraphs(const juce::AttributedString& attributed);
+    static juce::String getParagraphKey(const juce::AttributedString& paragraph);
+    void addGlyph(std::vector<std::unique_ptr<osci::Shape>>& shapes, const GlyphOutlineCache::Outline& outline, float x, float y);
+
+    juce::SharedResourcePointer<GlyphOutlineCache> glyphCache;
+
     juce::Font& font;
-	std::vector<std::unique_ptr<osci::Shape>> shapes;
     juce::Font currentFont;
     juce::String text;
-    juce::AttributedString attributedString;
+
+    // Paragraphs in the current layout, keyed by their text and fonts
+    juce::CriticalSection paragraphLock;
+    std::unordered_map<juce::String, std::shared_ptr<const Paragraph>> paragraphs;
+    int numLines = 0;
+    int numLinesLaidOut = 0;
+
+    // Laid out once per change and cloned for every frame
+    std::shared_ptr<const std::vector<std::unique_ptr<osci::Shape>>> frame;
 };
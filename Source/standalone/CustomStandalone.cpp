@@ -63,6 +63,9 @@
 
 // #include <juce_audio_plugin_client/Standalone/juce_StandaloneFilterWindow.h>
 #include "CustomStandaloneFilterWindow.h"
+#ifndef SOSCI
+ #include "HeadlessRenderer.h"
+#endif
 
 namespace juce
 {
@@ -145,6 +148,17 @@ public:
     //==============================================================================
     void initialise (const String& commandLine) override
     {
+#ifndef SOSCI
+        // Command-line renders run without a window or audio device and quit
+        // when they finish.
+        if (HeadlessRenderer::isHeadlessCommandLine (commandLine))
+        {
+            setApplicationReturnValue (HeadlessRenderer::run (commandLine));
+            quit();
+            return;
+        }
+#endif
+
 #if JUCE_MAC && OSCI_PREMIUM
         if (ProcessAudioPermissions::isProcessTapAvailable())
         {
@@ -0,0 +1,155 @@
+#include "HeadlessRenderer.h"
+
+#include <iostream>
+
+#include "../PluginProcessor.h"
+#include "../audio/OfflineProjectRenderer.h"
+
+namespace {
+    void print(const juce::String& text) {
+        std::cout << text << std::endl;
+    }
+
+    void printError(const juce::String& text) {
+        std::cerr << "error: " << text << std::endl;
+    }
+}
+
+bool HeadlessRenderer::isHeadlessCommandLine(const juce::String& commandLine) {
+    return juce::StringArray::fromTokens(commandLine, true).contains("--render");
+}
+
+void HeadlessRenderer::printUsage() {
+    print("Usage: osci-render --render <project.osci | file> [options]\n"
+          "\n"
+          "  --output <file.wav>      Write the XYZRGB output here. Leave out to only benchmark.\n"
+          "  --seconds <n>            Length to render (default 10). 0 renders a MIDI file to its end.\n"
+          "  --sample-rate <hz>       Sample rate (default 48000).\n"
+          "  --block-size <n>         Samples per block (default 512).\n"
+          "  --voices <n>             Polyphony (default: the project's).\n"
+          "  --midi <file.mid>        Play this MIDI file instead of a single held note.\n"
+          "  --note <n>               MIDI note to hold when there's no MIDI file (default 60).\n"
+          "  --bpm <n>                Tempo reported to the project (default 120).\n"
+          "  --bits <16|24|32>        WAV bit depth (default 32).\n"
+          "  --profile-json <file>    Write the audio profiler report as JSON.");
+}
+
+int HeadlessRenderer::run(const juce::String& commandLine) {
+    juce::ArgumentList args("osci-render", juce::StringArray::fromTokens(commandLine, true));
+
+    if (args.containsOption("--help|-h")) {
+        printUsage();
+        return 0;
+    }
+
+    OfflineProjectRenderer::Settings settings;
+    auto doubleOption = [&args](const juce::String& option, double fallback) {
+        return args.containsOption(option) ? args.getValueForOption(option).getDoubleValue() : fallback;
+    };
+    auto intOption = [&args](const juce::String& option, int fallback) {
+        return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : fallback;
+    };
+    // Relative paths are relative to the working directory. Returns an
+    // invalid File if the option wasn't given.
+    auto fileOption = [&args](const juce::String& option) {
+        const auto path = args.getValueForOption(option).unquoted();
+        return path.isEmpty() ? juce::File() : juce::File::getCurrentWorkingDirectory().getChildFile(path);
+    };
+    settings.lengthSeconds = doubleOption("--seconds", settings.lengthSeconds);
+    settings.sampleRate = doubleOption("--sample-rate", settings.sampleRate);
+    settings.blockSize = intOption("--block-size", settings.blockSize);
+    settings.bpm = doubleOption("--bpm", settings.bpm);
+    settings.note = intOption("--note", settings.note);
+    settings.bitsPerSample = intOption("--bits", settings.bitsPerSample);
+
+    const auto input = fileOption("--render");
+    if (!input.existsAsFile()) {
+        printError("No input file found at '" + args.getValueForOption("--render") + "'.");
+        printUsage();
+        return 1;
+    }
+
+    if (args.containsOption("--midi")) {
+        settings.midiFile = fileOption("--midi");
+        if (!settings.midiFile.existsAsFile()) {
+            printError("No MIDI file found at '" + args.getValueForOption("--midi") + "'.");
+            return 1;
+        }
+    }
+
+    const auto output = fileOption("--output");
+    const auto profileJson = fileOption("--profile-json");
+
+    OscirenderAudioProcessor processor;
+    processor.setHeadless(true);
+
+    if (input.hasFileExtension("osci")) {
+        juce::MemoryBlock data;
+        if (!input.loadFileAsData(data)) {
+            printError("Could not read " + input.getFullPathName() + ".");
+            return 1;
+        }
+        processor.setStateInformation(data.getData(), (int) data.getSize());
+        processor.currentProjectFile = input.getFullPathName();
+    } else {
+        juce::SpinLock::ScopedLockType parsersLock(processor.parsersLock);
+        juce::SpinLock::ScopedLockType effectsLock(processor.effectsLock);
+        processor.addFile(input);
+    }
+
+    if (args.containsOption("--voices")) {
+        processor.voices->setUnnormalisedValueNotifyingHost((float) intOption("--voices", 1));
+    }
+
+    print("Rendering " + input.getFileName() + ": " + juce::String(settings.lengthSeconds, 2) + " s at "
+          + juce::String(settings.sampleRate, 0) + " Hz, " + juce::String(settings.blockSize) + " samples per block, "
+          + juce::String((int) processor.voices->getValueUnnormalised()) + " voices");
+
+#if OSCI_AUDIO_PROFILER
+    processor.profiler.reset();
+#endif
+
+    OfflineProjectRenderer renderer(processor);
+    const auto result = renderer.render(settings, output);
+
+    if (!result.success) {
+        printError(result.errorMessage.isNotEmpty() ? result.errorMessage : juce::String("Render failed."));
+        return 1;
+    }
+
+    const double audioSeconds = (double) result.samplesRendered / settings.sampleRate;
+    print("Rendered " + juce::String(audioSeconds, 2) + " s of audio in " + juce::String(result.renderSeconds, 3)
+          + " s (" + juce::String(result.getRealTimeFactor(settings.sampleRate), 1) + "x real time)");
+    if (output != juce::File()) {
+        print("Wrote " + output.getFullPathName());
+    }
+
+#if OSCI_AUDIO_PROFILER
+    const auto report = processor.profiler.getReport();
+    print("\n" + juce::String(report.blocks) + " blocks, " + juce::String(report.overruns)
+          + " slower than real time (deadline " + juce::String(report.lastDeadlineUs, 0) + " us)\n");
+    print(juce::String("Stage").paddedRight(' ', 28) + juce::String("mean us").paddedLeft(' ', 10)
+          + juce::String("p50 us").paddedLeft(' ', 10) + juce::String("p99 us").paddedLeft(' ', 10)
+          + juce::String("max us").paddedLeft(' ', 10) + juce::String("blamed").paddedLeft(' ', 8));
+    for (auto& slot : report.slots) {
+        print(slot.name.paddedRight(' ', 28) + juce::String(slot.meanUs, 1).paddedLeft(' ', 10)
+              + juce::String(slot.p50Us, 1).paddedLeft(' ', 10) + juce::String(slot.p99Us, 1).paddedLeft(' ', 10)
+              + juce::String(slot.maxUs, 1).paddedLeft(' ', 10) + juce::String(slot.overrunsBlamed).paddedLeft(' ', 8));
+    }
+
+    if (profileJson != juce::File()) {
+        if (!profileJson.replaceWithText(processor.profiler.exportJson())) {
+            printError("Could not write " + profileJson.getFullPathName() + ".");
+            return 1;
+        }
+        print("\nWrote profile to " + profileJson.getFullPathName());
+    }
+#else
+    if (profileJson != juce::File()) {
+        printError("This build has the audio profiler compiled out (OSCI_AUDIO_PROFILER=0).");
+        return 1;
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Renders a project from the command line without creating a window, e.g.
+//
+//   osci-render --render song.osci --seconds 30 --output song.wav
+//   osci-render --render shape.obj --sample-rate 96000 --block-size 64 --voices 8
+//
+// The standalone app runs this instead of opening its window when the command
+// line contains --render. It loads a .osci project or a single input file,
+// renders it through OfflineProjectRenderer, optionally writes the six-channel
+// WAV, and prints the real-time factor and per-stage audio profiler timings.
+// Leaving out --output renders without writing anything, for benchmarking.
+class HeadlessRenderer {
+public:
+    static bool isHeadlessCommandLine(const juce::String& commandLine);
+
+    // Blocking. Returns the process exit code.
+    static int run(const juce::String& commandLine);
+
+private:
+    static void printUsage();
+};
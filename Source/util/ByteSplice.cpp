@@ -0,0 +1,99 @@
+#include "ByteSplice.h"
+
+ByteSplice ByteSplice::between(const juce::MemoryBlock& before, const juce::MemoryBlock& after) {
+    auto* a = static_cast<const char*>(before.getData());
+    auto* b = static_cast<const char*>(after.getData());
+    const size_t aSize = before.getSize();
+    const size_t bSize = after.getSize();
+
+    size_t prefix = 0;
+    const size_t shortest = juce::jmin(aSize, bSize);
+    while (prefix < shortest && a[prefix] == b[prefix]) {
+        prefix++;
+    }
+
+    // The suffix can't reach back into the prefix, or an insertion of a
+    // repeated character would be counted twice.
+    size_t suffix = 0;
+    while (suffix < shortest - prefix && a[aSize - 1 - suffix] == b[bSize - 1 - suffix]) {
+        suffix++;
+    }
+
+    ByteSplice splice;
+    splice.offset = prefix;
+    splice.removed.append(a + prefix, aSize - prefix - suffix);
+    splice.inserted.append(b + prefix, bSize - prefix - suffix);
+    return splice;
+}
+
+std::optional<juce::MemoryBlock> ByteSplice::replace(const juce::MemoryBlock& source, size_t offset,
+                                                     const juce::MemoryBlock& expected, const juce::MemoryBlock& replacement) {
+    if (offset > source.getSize() || expected.getSize() > source.getSize() - offset) {
+        return std::nullopt;
+    }
+    auto* data = static_cast<const char*>(source.getData());
+    if (expected.getSize() > 0 && std::memcmp(data + offset, expected.getData(), expected.getSize()) != 0) {
+        return std::nullopt;
+    }
+
+    juce::MemoryBlock result;
+    result.ensureSize(source.getSize() - expected.getSize() + replacement.getSize());
+    result.append(data, offset);
+    result.append(replacement.getData(), replacement.getSize());
+    const size_t tail = offset + expected.getSize();
+    result.append(data + tail, source.getSize() - tail);
+    return result;
+}
+
+std::optional<juce::MemoryBlock> ByteSplice::apply(const juce::MemoryBlock& source) const {
+    return replace(source, offset, removed, inserted);
+}
+
+std::optional<juce::MemoryBlock> ByteSplice::revert(const juce::MemoryBlock& source) const {
+    return replace(source, offset, inserted, removed);
+}
+
+std::optional<ByteSplice> ByteSplice::followedBy(const ByteSplice& next) const {
+    // Both splices are positioned in the version between them: this one wrote
+    // [offset, offset + inserted) and `next` replaces [next.offset, next.offset + next.removed).
+    const size_t firstEnd = offset + inserted.getSize();
+    const size_t secondEnd = next.offset + next.removed.getSize();
+    if (next.offset > firstEnd || offset > secondEnd) {
+        return std::nullopt;
+    }
+
+    // Together the two ranges cover [start, end) of the middle version, so
+    // its bytes there can be rebuilt from them alone.
+    const size_t start = juce::jmin(offset, next.offset);
+    const size_t end = juce::jmax(firstEnd, secondEnd);
+    juce::MemoryBlock middle(end - start);
+    middle.copyFrom(inserted.getData(), (int) (offset - start), inserted.getSize());
+
+    // Where they overlap both must have seen the same bytes, otherwise they
+    // weren't made against the same version.
+    auto* middleData = static_cast<const char*>(middle.getData());
+    const size_t overlapStart = juce::jmax(offset, next.offset);
+    const size_t overlapEnd = juce::jmin(firstEnd, secondEnd);
+    if (overlapEnd > overlapStart
+        && std::memcmp(middleData + (overlapStart - start),
+                       static_cast<const char*>(next.removed.getData()) + (overlapStart - next.offset),
+                       overlapEnd - overlapStart) != 0) {
+        return std::nullopt;
+    }
+    middle.copyFrom(next.removed.getData(), (int) (next.offset - start), next.removed.getSize());
+
+    auto substitute = [&](size_t at, size_t length, const juce::MemoryBlock& with) {
+        juce::MemoryBlock result;
+        result.ensureSize(middle.getSize() - length + with.getSize());
+        result.append(middleData, at);
+        result.append(with.getData(), with.getSize());
+        result.append(middleData + at + length, middle.getSize() - at - length);
+        return result;
+    };
+
+    ByteSplice merged;
+    merged.offset = start;
+    merged.removed = substitute(offset - start, inserted.getSize(), removed);
+    merged.inserted = substitute(next.offset - start, next.removed.getSize(), next.inserted);
+    return merged;
+}
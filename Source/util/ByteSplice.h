@@ -0,0 +1,37 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <optional>
+
+// The difference between two versions of a file as a single replaced range:
+// at `offset`, the bytes in `removed` were replaced by the bytes in `inserted`.
+//
+// Undo history keeps splices rather than whole copies of a file, so an edit
+// costs memory in proportion to what changed, not to the size of the file.
+struct ByteSplice {
+    size_t offset = 0;
+    juce::MemoryBlock removed;
+    juce::MemoryBlock inserted;
+
+    // Smallest splice that turns `before` into `after`, found by trimming the
+    // common prefix and suffix. Takes time in proportion to the file but only
+    // keeps the bytes that differ.
+    static ByteSplice between(const juce::MemoryBlock& before, const juce::MemoryBlock& after);
+
+    // Returns nullopt if `source` doesn't contain the bytes this splice
+    // expects to replace, e.g. because it was made against another version.
+    std::optional<juce::MemoryBlock> apply(const juce::MemoryBlock& source) const;
+    std::optional<juce::MemoryBlock> revert(const juce::MemoryBlock& source) const;
+
+    // A single splice with the effect of this one followed by `next`, if the
+    // two touch or overlap. Edits far apart can't be merged without keeping
+    // the bytes between them, so they return nullopt.
+    std::optional<ByteSplice> followedBy(const ByteSplice& next) const;
+
+    bool isEmpty() const { return removed.isEmpty() && inserted.isEmpty(); }
+    size_t getSizeInBytes() const { return removed.getSize() + inserted.getSize(); }
+
+private:
+    static std::optional<juce::MemoryBlock> replace(const juce::MemoryBlock& source, size_t offset,
+                                                    const juce::MemoryBlock& expected, const juce::MemoryBlock& replacement);
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ByteSplice.h"
+
+// The project's list of files, as the file undo actions see it.
+//
+// File contents are treated as immutable: an edit publishes a new block
+// rather than changing the old one in place, so a block can be shared by the
+// live project, parsers and undo history without copying.
+class UndoableFileList {
+public:
+    virtual ~UndoableFileList() = default;
+
+    // Runs `edit` with whatever locks the methods below need held.
+    virtual void withFilesLocked(const std::function<void()>& edit) = 0;
+
+    virtual int numFiles() = 0;
+    virtual juce::String getFileName(int index) = 0;
+    // Unique to one open file for as long as it stays open. Reopening a file
+    // gives it a new id.
+    virtual juce::String getFileId(int index) = 0;
+    virtual std::shared_ptr<juce::MemoryBlock> getFileBlock(int index) = 0;
+    virtual void updateFileBlock(int index, std::shared_ptr<juce::MemoryBlock> block) = 0;
+    virtual void insertFile(int index, juce::String fileName, std::shared_ptr<juce::MemoryBlock> data) = 0;
+    virtual void removeFile(int index) = 0;
+
+    // Called once an undo or redo has changed a file's contents behind the
+    // back of whatever is showing it. Locks are held.
+    virtual void fileContentsRestored(int index) {}
+
+    // Settings that belong to a file besides its contents, such as the
+    // keymap zones that play it. Saved just before the file is closed and
+    // restored just after undo reopens it. Locks are held.
+    virtual void saveFileSettings(int index, juce::XmlElement& settings) {}
+    virtual void restoreFileSettings(int index, const juce::XmlElement& settings) {}
+};
+
+// UndoableAction for an edit to the contents of a file.
+//
+// Only the changed bytes are kept. Edits to the same file that touch each
+// other coalesce into one action, so typing a line costs one splice the
+// size of the line rather than one per keystroke.
+struct FileContentChangeAction : public juce::UndoableAction {
+    UndoableFileList& files;
+    int index;
+    juce::String fileName;
+    ByteSplice splice;
+    // The contents are already in place when the action is first performed,
+    // so only later redos need to tell the editor.
+    bool performed = false;
+
+    FileContentChangeAction(UndoableFileList& f, int idx, juce::String name, ByteSplice s)
+        : files(f), index(idx), fileName(std::move(name)), splice(std::move(s)) {}
+
+    // Records the change from the file's current contents to `newContents`.
+    // Locks must be held.
+    static FileContentChangeAction* fromEdit(UndoableFileList& files, int index, const juce::MemoryBlock& newContents) {
+        auto current = files.getFileBlock(index);
+        return new FileContentChangeAction(files, index, files.getFileName(index),
+                                           ByteSplice::between(*current, newContents));
+    }
+
+    bool perform() override {
+        const bool redo = std::exchange(performed, true);
+        return change(redo, [this](const juce::MemoryBlock& b) { return splice.apply(b); });
+    }
+
+    bool undo() override {
+        return change(true, [this](const juce::MemoryBlock& b) { return splice.revert(b); });
+    }
+
+    int getSizeInUnits() override {
+        return (int) (sizeof(*this) + splice.getSizeInBytes());
+    }
+
+    juce::UndoableAction* createCoalescedAction(juce::UndoableAction* nextAction) override {
+        auto* next = dynamic_cast<FileContentChangeAction*>(nextAction);
+        if (next == nullptr || &next->files != &files || next->index != index || next->fileName != fileName) {
+            return nullptr;
+        }
+        auto merged = splice.followedBy(next->splice);
+        if (!merged.has_value()) {
+            return nullptr;
+        }
+        auto* action = new FileContentChangeAction(files, index, fileName, std::move(*merged));
+        action->performed = true;
+        return action;
+    }
+
+private:
+    template <typename Transform>
+    bool change(bool notify, Transform&& transform) {
+        bool ok = false;
+        files.withFilesLocked([&] {
+            // The file list may have changed shape since; don't apply a
+            // splice to a different file that now sits at this index.
+            if (index < 0 || index >= files.numFiles() || files.getFileName(index) != fileName) {
+                return;
+            }
+            auto result = transform(*files.getFileBlock(index));
+            if (!result.has_value()) {
+                return;
+            }
+            files.updateFileBlock(index, std::make_shared<juce::MemoryBlock>(std::move(*result)));
+            if (notify) {
+                files.fileContentsRestored(index);
+            }
+            ok = true;
+        });
+        return ok;
+    }
+};
+
+// UndoableAction for adding or removing a file.
+//
+// Keeps a reference to the file's block rather than a copy: while the file
+// is open the history costs nothing extra, and once it is closed the history
+// is all that keeps it. The open file is found again by its id, since
+// content undo and redo replace its block.
+struct FileListChangeAction : public juce::UndoableAction {
+    UndoableFileList& files;
+    int index;
+    juce::String fileName;
+    std::shared_ptr<juce::MemoryBlock> block;
+    bool adding;
+    // Id of the file while it is open, or empty while it is closed.
+    juce::String fileId;
+    // The file's settings from when it was last closed.
+    juce::XmlElement settings { "fileSettings" };
+
+    static FileListChangeAction* add(UndoableFileList& f, juce::String name, std::shared_ptr<juce::MemoryBlock> data) {
+        return new FileListChangeAction(f, -1, std::move(name), std::move(data), true);
+    }
+
+    // Locks must be held.
+    static FileListChangeAction* remove(UndoableFileList& f, int idx) {
+        auto* action = new FileListChangeAction(f, idx, f.getFileName(idx), f.getFileBlock(idx), false);
+        action->fileId = f.getFileId(idx);
+        return action;
+    }
+
+    bool perform() override {
+        return adding ? insert() : erase();
+    }
+
+    bool undo() override {
+        return adding ? erase() : insert();
+    }
+
+    int getSizeInUnits() override {
+        // Adding a file shares the block the project holds; removing one
+        // leaves the history holding it alone.
+        const size_t held = adding ? 0 : block->getSize();
+        return (int) juce::jmin((size_t) std::numeric_limits<int>::max(), sizeof(*this) + held);
+    }
+
+private:
+    FileListChangeAction(UndoableFileList& f, int idx, juce::String name, std::shared_ptr<juce::MemoryBlock> data, bool isAdd)
+        : files(f), index(idx), fileName(std::move(name)), block(std::move(data)), adding(isAdd) {
+        jassert(block != nullptr);
+    }
+
+    bool insert() {
+        files.withFilesLocked([this] {
+            if (index < 0 || index > files.numFiles()) {
+                index = files.numFiles();
+            }
+            files.insertFile(index, fileName, block);
+            fileId = files.getFileId(index);
+            files.restoreFileSettings(index, settings);
+        });
+        return true;
+    }
+
+    bool erase() {
+        bool ok = false;
+        files.withFilesLocked([&] {
+            if (fileId.isEmpty()) {
+                return;
+            }
+            for (int i = 0; i < files.numFiles(); ++i) {
+                if (files.getFileId(i) == fileId) {
+                    // Take the current contents, so a later insert puts
+                    // back what was closed.
+                    block = files.getFileBlock(i);
+                    settings = juce::XmlElement("fileSettings");
+                    files.saveFileSettings(i, settings);
+                    files.removeFile(i);
+                    index = i;
+                    fileId = {};
+                    ok = true;
+                    return;
+                }
+            }
+        });
+        return ok;
+    }
+};
@@ -0,0 +1,140 @@
+#include "ProjectBlobStore.h"
+
+ProjectBlobStore::ProjectBlobStore(juce::File dir) : directory(std::move(dir)) {}
+
+bool ProjectBlobStore::isValidHash(const juce::String& hash) {
+    return hash.length() == 64 && hash.containsOnly("0123456789abcdef");
+}
+
+juce::File ProjectBlobStore::getFileFor(const juce::String& hash) const {
+    // Fan out by the first two hex digits so no single directory gets huge.
+    return directory.getChildFile(hash.substring(0, 2)).getChildFile(hash + ".blob");
+}
+
+bool ProjectBlobStore::contains(const juce::String& hash) const {
+    return isValidHash(hash) && getFileFor(hash).existsAsFile();
+}
+
+void ProjectBlobStore::pruneExpired() {
+    for (auto it = hashes.begin(); it != hashes.end();) {
+        if (it->second.block.expired()) {
+            it = hashes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = loaded.begin(); it != loaded.end();) {
+        if (it->second.expired()) {
+            it = loaded.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+juce::String ProjectBlobStore::hashOf(const std::shared_ptr<juce::MemoryBlock>& block) {
+    if (block == nullptr) {
+        return {};
+    }
+
+    {
+        juce::ScopedLock sl(lock);
+        auto it = hashes.find(block.get());
+        if (it != hashes.end() && it->second.block.lock() == block) {
+            return it->second.hash;
+        }
+    }
+
+    // Hash outside the lock - large files can take a while.
+    auto hash = juce::SHA256(block->getData(), block->getSize()).toHexString();
+    remember(hash, block);
+    return hash;
+}
+
+void ProjectBlobStore::remember(const juce::String& hash, const std::shared_ptr<juce::MemoryBlock>& block) {
+    if (block == nullptr) {
+        return;
+    }
+    juce::ScopedLock sl(lock);
+    pruneExpired();
+    hashes[block.get()] = { block, hash };
+    loaded[hash] = block;
+}
+
+bool ProjectBlobStore::store(const juce::String& hash, const juce::MemoryBlock& block) {
+    return store(hash, block.getData(), block.getSize());
+}
+
+bool ProjectBlobStore::store(const juce::String& hash, const void* data, size_t size) {
+    if (!isValidHash(hash)) {
+        return false;
+    }
+
+    auto file = getFileFor(hash);
+    if (file.existsAsFile() && file.getSize() == (juce::int64) size) {
+        file.setLastModificationTime(juce::Time::getCurrentTime());
+        return true;
+    }
+
+    if (!file.getParentDirectory().createDirectory()) {
+        juce::Logger::writeToLog("ProjectBlobStore: could not create " + file.getParentDirectory().getFullPathName());
+        return false;
+    }
+
+    // Write to a temporary file first so a crash mid-write never leaves a
+    // truncated blob behind under a valid name.
+    juce::TemporaryFile temp(file);
+    if (!temp.getFile().replaceWithData(data, size) || !temp.overwriteTargetFileWithTemporary()) {
+        juce::Logger::writeToLog("ProjectBlobStore: failed to write blob " + hash);
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<juce::MemoryBlock> ProjectBlobStore::load(const juce::String& hash) {
+    if (!isValidHash(hash)) {
+        return nullptr;
+    }
+
+    {
+        juce::ScopedLock sl(lock);
+        auto it = loaded.find(hash);
+        if (it != loaded.end()) {
+            if (auto block = it->second.lock()) {
+                return block;
+            }
+        }
+    }
+
+    auto file = getFileFor(hash);
+    auto block = std::make_shared<juce::MemoryBlock>();
+    if (!file.existsAsFile() || !file.loadFileAsData(*block)) {
+        return nullptr;
+    }
+
+    remember(hash, block);
+    return block;
+}
+
+bool ProjectBlobStore::touch(const juce::String& hash) {
+    if (!contains(hash)) {
+        return false;
+    }
+    return getFileFor(hash).setLastModificationTime(juce::Time::getCurrentTime());
+}
+
+int ProjectBlobStore::prune(const juce::StringArray& keep, juce::RelativeTime maxAge) {
+    const auto cutoff = juce::Time::getCurrentTime() - maxAge;
+    int deleted = 0;
+    for (const auto& entry : juce::RangedDirectoryIterator(directory, true, "*.blob", juce::File::findFiles)) {
+        auto file = entry.getFile();
+        auto hash = file.getFileNameWithoutExtension();
+        if (!isValidHash(hash) || keep.contains(hash) || entry.getModificationTime() >= cutoff) {
+            continue;
+        }
+        if (file.deleteFile()) {
+            deleted++;
+        }
+    }
+    return deleted;
+}
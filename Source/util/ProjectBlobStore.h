@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include <unordered_map>
+
+// Content-addressed storage for file payloads referenced by project state.
+//
+// Each blob is stored once, named by the SHA-256 of its contents, so the same
+// WAV or OBJ used by many projects (or many times in one project) only takes
+// up space once. Host state only references its blobs, so they live here;
+// project files saved to disk embed theirs so they can be moved between
+// machines. Blocks handed out by load() are shared between everyone that
+// asks for the same hash, and hashes of blocks are cached so saving a project
+// repeatedly doesn't rehash files that haven't changed.
+//
+// Thread-safe.
+class ProjectBlobStore {
+public:
+    explicit ProjectBlobStore(juce::File directory);
+
+    // SHA-256 of the block as lowercase hex. Cached per block, so blocks must
+    // not be modified in place once they have been hashed.
+    juce::String hashOf(const std::shared_ptr<juce::MemoryBlock>& block);
+
+    // Writes the block to the store if it isn't already there. A blob that is
+    // already stored has its modification time refreshed, which keeps it from
+    // being pruned.
+    bool store(const juce::String& hash, const juce::MemoryBlock& block);
+    bool store(const juce::String& hash, const void* data, size_t size);
+    // Refreshes a stored blob's modification time. Returns false if it isn't stored.
+    bool touch(const juce::String& hash);
+
+    // Returns the blob for hash, reading it from disk on first use. Returns
+    // nullptr if the blob isn't in the store.
+    std::shared_ptr<juce::MemoryBlock> load(const juce::String& hash);
+
+    // Associates an already-loaded block with its hash, e.g. a blob read from
+    // an embedded chunk, so it is shared and not rehashed on the next save.
+    void remember(const juce::String& hash, const std::shared_ptr<juce::MemoryBlock>& block);
+
+    // Deletes blobs not in `keep` that haven't been stored or touched for
+    // `maxAge`. Returns how many were deleted.
+    int prune(const juce::StringArray& keep, juce::RelativeTime maxAge);
+
+    bool contains(const juce::String& hash) const;
+    juce::File getFileFor(const juce::String& hash) const;
+    const juce::File& getDirectory() const { return directory; }
+
+    static bool isValidHash(const juce::String& hash);
+
+private:
+    void pruneExpired();
+
+    juce::File directory;
+
+    struct CachedHash {
+        std::weak_ptr<juce::MemoryBlock> block;
+        juce::String hash;
+    };
+
+    juce::CriticalSection lock;
+    // Keyed by block address; the weak_ptr guards against address reuse.
+    std::unordered_map<const juce::MemoryBlock*, CachedHash> hashes;
+    std::map<juce::String, std::weak_ptr<juce::MemoryBlock>> loaded;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProjectBlobStore)
+};
@@ -0,0 +1,157 @@
+#include "ProjectChunkFormat.h"
+
+juce::uint32 ProjectChunkFormat::chunkId(const char (&id)[5]) {
+    return juce::ByteOrder::littleEndianInt(id);
+}
+
+bool ProjectChunkFormat::isChunkedProject(const void* data, size_t sizeInBytes) {
+    return data != nullptr && sizeInBytes >= headerSize && juce::ByteOrder::littleEndianInt(data) == magic;
+}
+
+void ProjectChunkFormat::writeChunk(juce::MemoryOutputStream& out, juce::uint32 id, const void* payload, size_t payloadSize, juce::uint32 flags) {
+    out.writeInt((int) id);
+    out.writeInt((int) flags);
+    out.writeInt64((juce::int64) payloadSize);
+    if (payloadSize > 0) {
+        out.write(payload, payloadSize);
+    }
+}
+
+//==============================================================================
+ProjectChunkFormat::Writer::Writer(ProjectBlobStore& s, bool embed) : store(s), embedBlobs(embed) {}
+
+juce::String ProjectChunkFormat::Writer::addBlob(const std::shared_ptr<juce::MemoryBlock>& block) {
+    jassert(block != nullptr);
+    auto hash = store.hashOf(block);
+
+    for (auto& blob : blobs) {
+        if (blob.hash == hash) {
+            return hash;
+        }
+    }
+
+    bool embed = embedBlobs;
+    if (!embed && !store.store(hash, *block)) {
+        embed = true;
+    }
+
+    blobs.push_back({ hash, block, embed });
+    return hash;
+}
+
+bool ProjectChunkFormat::Writer::addStoredBlob(const juce::String& hash) {
+    for (auto& blob : blobs) {
+        if (blob.hash == hash) {
+            return true;
+        }
+    }
+
+    if (!embedBlobs) {
+        if (!store.touch(hash)) {
+            return false;
+        }
+        blobs.push_back({ hash, nullptr, false });
+        return true;
+    }
+
+    auto block = store.load(hash);
+    if (block == nullptr) {
+        return false;
+    }
+    blobs.push_back({ hash, block, true });
+    return true;
+}
+
+void ProjectChunkFormat::Writer::write(const juce::XmlElement& xml, juce::MemoryBlock& destData) const {
+    juce::MemoryOutputStream out(destData, false);
+    out.writeInt((int) magic);
+    out.writeInt((int) currentVersion);
+
+    juce::MemoryBlock compressedXml;
+    {
+        juce::MemoryOutputStream xmlStream(compressedXml, false);
+        juce::GZIPCompressorOutputStream gzip(xmlStream);
+        xml.writeTo(gzip, juce::XmlElement::TextFormat().singleLine().withoutHeader());
+        gzip.flush();
+    }
+    writeChunk(out, chunkId("PRMS"), compressedXml.getData(), compressedXml.getSize());
+
+    for (auto& blob : blobs) {
+        if (!blob.embed) {
+            continue;
+        }
+        juce::MemoryBlock hashBytes;
+        hashBytes.loadFromHexString(blob.hash);
+        jassert(hashBytes.getSize() == hashSize);
+
+        out.writeInt((int) chunkId("BLOB"));
+        out.writeInt(0);
+        out.writeInt64((juce::int64) (hashSize + blob.block->getSize()));
+        out.write(hashBytes.getData(), hashSize);
+        out.write(blob.block->getData(), blob.block->getSize());
+    }
+
+    out.flush();
+}
+
+//==============================================================================
+ProjectChunkFormat::Reader::Reader(const void* d, size_t sizeInBytes) : data(static_cast<const char*>(d)), size(sizeInBytes) {
+    if (!isChunkedProject(data, size)) {
+        return;
+    }
+
+    version = juce::ByteOrder::littleEndianInt(data + 4);
+    if (version == 0 || version > currentVersion) {
+        juce::Logger::writeToLog("ProjectChunkFormat: unsupported project format version " + juce::String(version));
+        return;
+    }
+
+    size_t offset = headerSize;
+    while (offset + chunkHeaderSize <= size) {
+        auto id = juce::ByteOrder::littleEndianInt(data + offset);
+        auto payloadSize = (juce::uint64) juce::ByteOrder::littleEndianInt64(data + offset + 8);
+        auto payloadOffset = offset + chunkHeaderSize;
+
+        if (payloadSize > size - payloadOffset) {
+            juce::Logger::writeToLog("ProjectChunkFormat: truncated chunk at offset " + juce::String((juce::int64) offset));
+            break;
+        }
+
+        if (id == chunkId("PRMS")) {
+            xmlChunk = Range { payloadOffset, (size_t) payloadSize };
+        } else if (id == chunkId("BLOB") && payloadSize >= hashSize) {
+            auto hash = juce::String::toHexString(data + payloadOffset, (int) hashSize, 0);
+            embeddedBlobs[hash] = Range { payloadOffset + hashSize, (size_t) payloadSize - hashSize };
+        }
+
+        offset = payloadOffset + (size_t) payloadSize;
+    }
+
+    valid = xmlChunk.has_value();
+}
+
+std::unique_ptr<juce::XmlElement> ProjectChunkFormat::Reader::readXml() const {
+    if (!valid) {
+        return nullptr;
+    }
+
+    juce::MemoryInputStream compressed(data + xmlChunk->offset, xmlChunk->size, false);
+    juce::GZIPDecompressorInputStream gzip(compressed);
+    return juce::XmlDocument::parse(gzip.readEntireStreamAsString());
+}
+
+std::shared_ptr<juce::MemoryBlock> ProjectChunkFormat::Reader::getBlob(const juce::String& hash, ProjectBlobStore& store) const {
+    auto it = embeddedBlobs.find(hash);
+    if (it == embeddedBlobs.end()) {
+        return store.load(hash);
+    }
+
+    auto block = std::make_shared<juce::MemoryBlock>(data + it->second.offset, it->second.size);
+    store.remember(hash, block);
+    return block;
+}
+
+bool ProjectChunkFormat::Reader::copyBlobToStore(const juce::String& hash, ProjectBlobStore& store) const {
+    auto it = embeddedBlobs.find(hash);
+    return it != embeddedBlobs.end() && store.store(hash, data + it->second.offset, it->second.size);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <optional>
+#include "ProjectBlobStore.h"
+
+// Versioned binary container for project state.
+//
+// Layout (little-endian):
+//
+//   uint32 magic ("OSCP"), uint32 format version
+//   chunk*: char[4] id, uint32 flags, uint64 size, payload[size]
+//
+// Chunks:
+//   "PRMS"  GZIP-compressed project XML. File entries reference their
+//           contents by hash (<file name=".." blob="<sha256>" size=".."/>)
+//           instead of carrying Base64 text.
+//   "BLOB"  32-byte SHA-256 followed by the raw file bytes. Only written when
+//           a blob is embedded rather than kept in a ProjectBlobStore.
+//
+// Unknown chunks are skipped, so newer versions can add chunks without
+// breaking older readers.
+class ProjectChunkFormat {
+public:
+    static constexpr juce::uint32 magic = 0x5043534f; // "OSCP"
+    static constexpr juce::uint32 currentVersion = 1;
+
+    static bool isChunkedProject(const void* data, size_t sizeInBytes);
+
+    class Writer {
+    public:
+        // If embedBlobs is false, blobs go to the store and are only referenced.
+        // Blobs the store fails to write are embedded so nothing is lost.
+        Writer(ProjectBlobStore& store, bool embedBlobs);
+
+        // Returns the hash to reference the block by. The same contents added
+        // twice are only written once.
+        juce::String addBlob(const std::shared_ptr<juce::MemoryBlock>& block);
+        // Adds a blob that is already in the store by its hash, without
+        // reading it unless it has to be embedded. Returns false if the store
+        // doesn't have it.
+        bool addStoredBlob(const juce::String& hash);
+
+        void write(const juce::XmlElement& xml, juce::MemoryBlock& destData) const;
+
+    private:
+        struct PendingBlob {
+            juce::String hash;
+            std::shared_ptr<juce::MemoryBlock> block;
+            bool embed;
+        };
+
+        ProjectBlobStore& store;
+        bool embedBlobs;
+        std::vector<PendingBlob> blobs;
+    };
+
+    // Indexes the chunks of a project without copying any file data. Blob
+    // contents are only copied out when requested by getBlob(). The reader
+    // refers to the caller's buffer, which must outlive it.
+    class Reader {
+    public:
+        Reader(const void* data, size_t sizeInBytes);
+
+        bool isValid() const { return valid; }
+        juce::uint32 getVersion() const { return version; }
+
+        std::unique_ptr<juce::XmlElement> readXml() const;
+
+        // Looks for an embedded blob first and falls back to the store.
+        // Returns nullptr if the blob can't be found anywhere.
+        std::shared_ptr<juce::MemoryBlock> getBlob(const juce::String& hash, ProjectBlobStore& store) const;
+
+        bool hasEmbeddedBlob(const juce::String& hash) const { return embeddedBlobs.count(hash) > 0; }
+        // Writes an embedded blob straight into the store without copying it
+        // into a MemoryBlock first.
+        bool copyBlobToStore(const juce::String& hash, ProjectBlobStore& store) const;
+
+    private:
+        struct Range {
+            size_t offset;
+            size_t size;
+        };
+
+        const char* data;
+        size_t size;
+        bool valid = false;
+        juce::uint32 version = 0;
+        std::optional<Range> xmlChunk;
+        std::map<juce::String, Range> embeddedBlobs;
+    };
+
+private:
+    static constexpr size_t headerSize = 8;
+    static constexpr size_t chunkHeaderSize = 16;
+    static constexpr size_t hashSize = 32;
+
+    static juce::uint32 chunkId(const char (&id)[5]);
+    static void writeChunk(juce::MemoryOutputStream& out, juce::uint32 id, const void* payload, size_t payloadSize, juce::uint32 flags = 0);
+};
@@ -0,0 +1,62 @@
+#include "ProjectFiles.h"
+
+void ProjectFiles::save(const std::vector<File>& files, ProjectChunkFormat::Writer& writer, juce::XmlElement& filesXml) {
+    for (auto& file : files) {
+        auto fileXml = filesXml.createNewChildElement("file");
+        fileXml->setAttribute("name", file.name);
+
+        if (file.block != nullptr) {
+            fileXml->setAttribute("blob", writer.addBlob(file.block));
+            fileXml->setAttribute("size", juce::String((juce::int64) file.block->getSize()));
+            continue;
+        }
+
+        // Still waiting in the store. Keep the reference even if the blob has
+        // gone, so the file is reported missing rather than silently dropped.
+        fileXml->setAttribute("blob", file.pendingBlob);
+        if (!writer.addStoredBlob(file.pendingBlob)) {
+            juce::Logger::writeToLog("ProjectFiles: blob " + file.pendingBlob + " for " + file.name + " is no longer in the store");
+        }
+    }
+}
+
+ProjectFiles::Restored ProjectFiles::restore(const juce::XmlElement& filesXml, const ProjectChunkFormat::Reader* reader, ProjectBlobStore& store, bool base64Stream) {
+    Restored restored;
+
+    for (auto fileXml : filesXml.getChildIterator()) {
+        File file;
+        file.name = fileXml->getStringAttribute("name");
+
+        if (fileXml->hasAttribute("blob")) {
+            // Blobs embedded by a project file go to the store to wait until
+            // the file is first used, and are only kept in memory if that
+            // fails. Ones already stored are left alone.
+            auto hash = fileXml->getStringAttribute("blob");
+            if (store.touch(hash)) {
+                file.pendingBlob = hash;
+            } else if (reader != nullptr && reader->hasEmbeddedBlob(hash)) {
+                file.pendingBlob = hash;
+                if (!reader->copyBlobToStore(hash, store)) {
+                    file.block = reader->getBlob(hash, store);
+                }
+            } else {
+                juce::Logger::writeToLog("ProjectFiles: missing file blob " + hash + " for " + file.name);
+                restored.missingNames.add(file.name);
+                restored.missingIndices.push_back((int) restored.files.size());
+                continue;
+            }
+        } else if (base64Stream) {
+            // Older versions of osci-render opened files in a silly way
+            juce::MemoryOutputStream stream;
+            juce::Base64::convertFromBase64(stream, fileXml->getAllSubText());
+            file.block = std::make_shared<juce::MemoryBlock>(stream.getData(), stream.getDataSize());
+        } else {
+            file.block = std::make_shared<juce::MemoryBlock>();
+            file.block->fromBase64Encoding(fileXml->getAllSubText());
+        }
+
+        restored.files.push_back(std::move(file));
+    }
+
+    return restored;
+}
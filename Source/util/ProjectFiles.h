@@ -0,0 +1,37 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ProjectChunkFormat.h"
+
+// The <files> section of project state.
+//
+// Files are saved by blob hash. A restored file that hasn't been opened yet is
+// saved under the hash it was restored with, so saving never reads or rehashes
+// it. Restoring leaves hash-referenced files waiting in the store; only files
+// from legacy XML states, which carry them as Base64, are decoded up front.
+class ProjectFiles {
+public:
+    struct File {
+        juce::String name;
+        // The file's bytes, or nullptr while it waits in the store.
+        std::shared_ptr<juce::MemoryBlock> block;
+        // The blob the file waits in until it is first opened, else empty.
+        juce::String pendingBlob;
+    };
+
+    // Adds every file to the writer and lists it in filesXml. Opened files
+    // may be hashed and written to the store, so don't hold any lock the
+    // audio thread takes while calling this.
+    static void save(const std::vector<File>& files, ProjectChunkFormat::Writer& writer, juce::XmlElement& filesXml);
+
+    struct Restored {
+        std::vector<File> files;
+        // Files whose blobs couldn't be found, and the index each would have had.
+        juce::StringArray missingNames;
+        std::vector<int> missingIndices;
+    };
+
+    // reader is nullptr for legacy XML states. States from before 2.2.0
+    // encoded files with juce::Base64 rather than MemoryBlock's own encoding.
+    static Restored restore(const juce::XmlElement& filesXml, const ProjectChunkFormat::Reader* reader, ProjectBlobStore& store, bool base64Stream);
+};
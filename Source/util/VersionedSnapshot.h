@@ -0,0 +1,134 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Publishes immutable versions of a value to lock-free readers.
+//
+// Writers build a complete new T and publish() it; readers take a Reader,
+// which pins whatever version was current without locking or allocating, so
+// it is safe to use on the audio thread. Replaced versions are freed on the
+// writer's thread once no reader can still see them, using two epochs: a
+// reader registers in the slot of the epoch it started in, and a version
+// retired in epoch E is freed once the epoch has advanced to E + 2, which is
+// only possible after both slots have drained.
+//
+// A single long-lived reader (the audio thread) can also hold() a version,
+// for when it keeps raw pointers into the value after its Reader goes away.
+// The held version is kept until a later one is held.
+template <typename T>
+class VersionedSnapshot {
+    struct Node {
+        std::unique_ptr<T> value;
+        uint64_t version;
+        uint64_t retiredEpoch;
+    };
+
+public:
+    explicit VersionedSnapshot(std::unique_ptr<T> initial = std::make_unique<T>())
+        : current(new Node { std::move(initial), 1, 0 }) {}
+
+    ~VersionedSnapshot() {
+        delete current.load();
+        for (auto* node : retired) {
+            delete node;
+        }
+    }
+
+    class Reader {
+    public:
+        explicit Reader(const VersionedSnapshot& snapshot) : owner(snapshot) {
+            slot = (int) (owner.epoch.load() & 1);
+            owner.readers[slot].fetch_add(1);
+            node = owner.current.load();
+        }
+
+        ~Reader() {
+            owner.readers[slot].fetch_sub(1);
+        }
+
+        const T& operator*() const { return *node->value; }
+        const T* operator->() const { return node->value.get(); }
+        const T* get() const { return node->value.get(); }
+        uint64_t getVersion() const { return node->version; }
+
+    private:
+        friend class VersionedSnapshot;
+
+        const VersionedSnapshot& owner;
+        int slot = 0;
+        const Node* node = nullptr;
+
+        JUCE_DECLARE_NON_COPYABLE(Reader)
+    };
+
+    // Replaces the current version. Never call this from the audio thread -
+    // it takes a lock and frees versions that are no longer visible.
+    void publish(std::unique_ptr<T> next) {
+        jassert(next != nullptr);
+        const juce::ScopedLock sl(writeLock);
+        auto* node = new Node { std::move(next), nextVersion++, 0 };
+        auto* previous = current.exchange(node);
+        previous->retiredEpoch = epoch.load();
+        retired.push_back(previous);
+        collectLocked();
+    }
+
+    // Frees retired versions that readers have finished with. publish() does
+    // this too; call it periodically if publishes are rare.
+    void collect() {
+        const juce::ScopedLock sl(writeLock);
+        collectLocked();
+    }
+
+    // Keeps the reader's version alive after the Reader is destroyed, until a
+    // later version is held. Call it while the Reader is still alive.
+    void hold(const Reader& reader) {
+        jassert(&reader.owner == this);
+        heldVersion.store(reader.getVersion());
+    }
+
+    uint64_t getVersion() const { return current.load()->version; }
+
+    int getNumRetired() const {
+        const juce::ScopedLock sl(writeLock);
+        return (int) retired.size();
+    }
+
+private:
+    void collectLocked() {
+        // Two advances are enough to free everything retired so far when no
+        // reader is mid-way through a read.
+        for (int i = 0; i < 2 && !retired.empty(); i++) {
+            const auto e = epoch.load();
+            if (readers[(e + 1) & 1].load() != 0) {
+                break;
+            }
+            epoch.store(e + 1);
+        }
+
+        const auto e = epoch.load();
+        const auto held = heldVersion.load();
+        retired.erase(std::remove_if(retired.begin(), retired.end(), [&](Node* node) {
+            if (node->retiredEpoch + 2 > e || node->version == held) {
+                return false;
+            }
+            delete node;
+            return true;
+        }), retired.end());
+    }
+
+    std::atomic<Node*> current;
+    std::atomic<uint64_t> epoch { 0 };
+    mutable std::atomic<int> readers[2] { { 0 }, { 0 } };
+    std::atomic<uint64_t> heldVersion { 0 };
+
+    juce::CriticalSection writeLock;
+    uint64_t nextVersion = 2;
+    std::vector<Node*> retired;
+
+    JUCE_DECLARE_NON_COPYABLE(VersionedSnapshot)
+};
@@ -0,0 +1,108 @@
+#include "FFmpegLiveVideoSource.h"
+
+FFmpegLiveVideoSource::FFmpegLiveVideoSource(juce::File ffmpegExecutable, juce::String input, LatestFrameSlot& slot, int width, int height)
+    : juce::Thread("FFmpeg Live Video"), ffmpegExecutable(std::move(ffmpegExecutable)), input(std::move(input)), slot(slot), width(width), height(height) {}
+
+FFmpegLiveVideoSource::~FFmpegLiveVideoSource() {
+    stop();
+}
+
+juce::StringArray FFmpegLiveVideoSource::buildCommand(const juce::File& ffmpegExecutable, const juce::String& input, int width, int height) {
+    juce::StringArray command;
+    command.add(ffmpegExecutable.getFullPathName());
+    command.add("-nostdin");
+    command.add("-hide_banner");
+
+    if (input.startsWith("/dev/video")) {
+        command.add("-f");
+        command.add("v4l2");
+    } else {
+        // Generators and files would otherwise run as fast as ffmpeg can
+        // decode them; -re paces them at their own frame rate like a camera.
+        command.add("-re");
+        if (input.startsWith("testsrc") || input.startsWith("smptebars") || input.startsWith("color=")) {
+            command.add("-f");
+            command.add("lavfi");
+        }
+    }
+    command.add("-i");
+    command.add(input);
+
+    command.add("-an");
+    command.add("-vf");
+    command.add("scale=" + juce::String(width) + ":" + juce::String(height));
+    command.add("-f");
+    command.add("rawvideo");
+    command.add("-pix_fmt");
+    command.add("gray");
+    command.add("-v");
+    command.add("error");
+    command.add("pipe:1");
+    return command;
+}
+
+juce::StringArray FFmpegLiveVideoSource::findCaptureDevices() {
+    juce::StringArray devices;
+#if JUCE_LINUX
+    for (const auto& entry : juce::RangedDirectoryIterator(juce::File("/dev"), false, "video*", juce::File::findFiles)) {
+        devices.add(entry.getFile().getFullPathName());
+    }
+    devices.sortNatural();
+#endif
+    return devices;
+}
+
+bool FFmpegLiveVideoSource::start() {
+    stop();
+    finished = false;
+    framesRead = 0;
+
+    // Only stdout: stderr shares the pipe otherwise, and one stray warning
+    // would shift every frame after it.
+    if (!ffmpegProcess.start(buildCommand(ffmpegExecutable, input, width, height), juce::ChildProcess::wantStdOut)) {
+        juce::Logger::writeToLog("Live video: failed to start ffmpeg for '" + input + "'");
+        return false;
+    }
+    startThread();
+    return true;
+}
+
+void FFmpegLiveVideoSource::stop() {
+    signalThreadShouldExit();
+    // Killing ffmpeg closes its end of the pipe, which unblocks a pending read.
+    if (ffmpegProcess.isRunning()) {
+        ffmpegProcess.kill();
+    }
+    stopThread(2000);
+}
+
+void FFmpegLiveVideoSource::run() {
+    const size_t frameSize = (size_t) width * (size_t) height;
+
+    while (!threadShouldExit()) {
+        auto& frame = slot.getWriteFrame();
+        frame.width = width;
+        frame.height = height;
+        frame.pixels.resize(frameSize);
+
+        // A read can return part of a frame, so keep going until it's whole.
+        size_t filled = 0;
+        while (filled < frameSize && !threadShouldExit()) {
+            const int bytesRead = ffmpegProcess.readProcessOutput(frame.pixels.data() + filled, (int) (frameSize - filled));
+            if (bytesRead <= 0) {
+                break;
+            }
+            filled += (size_t) bytesRead;
+        }
+
+        if (filled < frameSize) {
+            // ffmpeg exited or was killed; the partial frame is never shown.
+            break;
+        }
+
+        slot.publish();
+        framesRead++;
+    }
+
+    finished = true;
+}
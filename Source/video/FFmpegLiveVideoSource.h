@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "LatestFrameSlot.h"
+
+// Streams live video from ffmpeg into a LatestFrameSlot.
+//
+// ffmpeg runs as a child process writing raw greyscale frames of a fixed size
+// to its stdout, and a background thread reads them one whole frame at a time
+// and publishes each to the slot, so whoever samples the slot always sees the
+// newest complete frame. The input can be a V4L2 capture device (/dev/videoN),
+// one of ffmpeg's lavfi generators such as "testsrc", or any file or URL
+// ffmpeg can open.
+class FFmpegLiveVideoSource : private juce::Thread {
+public:
+    FFmpegLiveVideoSource(juce::File ffmpegExecutable, juce::String input, LatestFrameSlot& slot, int width = 320, int height = 240);
+    ~FFmpegLiveVideoSource() override;
+
+    // Launches ffmpeg and the reader thread. Returns false if ffmpeg couldn't
+    // be started.
+    bool start();
+    // Stops ffmpeg and waits for the reader thread to finish.
+    void stop();
+
+    // False once ffmpeg has exited, e.g. because the device went away.
+    bool isActive() const { return isThreadRunning() && !finished; }
+    int getNumFramesRead() const { return framesRead; }
+    juce::String getSourceName() const { return input; }
+
+    // The ffmpeg arguments that stream `input` as width x height greyscale frames.
+    static juce::StringArray buildCommand(const juce::File& ffmpegExecutable, const juce::String& input, int width, int height);
+    // Video capture devices present on this machine, e.g. /dev/video0.
+    static juce::StringArray findCaptureDevices();
+
+private:
+    void run() override;
+
+    juce::File ffmpegExecutable;
+    juce::String input;
+    LatestFrameSlot& slot;
+    int width;
+    int height;
+
+    juce::ChildProcess ffmpegProcess;
+    std::atomic<int> framesRead = 0;
+    std::atomic<bool> finished = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FFmpegLiveVideoSource)
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Hands greyscale video frames from one producer thread to one consumer
+// without locks, keeping only the most recent.
+//
+// A triple buffer: the producer fills its own frame and swaps it into the
+// shared middle slot; the consumer swaps the middle into its own frame only
+// when something new has arrived. Neither side ever waits on the other, and a
+// consumer that falls behind simply skips to the latest frame. Each frame
+// carries its own size, so only the producer ever resizes its pixels.
+class LatestFrameSlot {
+public:
+    struct Frame {
+        int width = 0;
+        int height = 0;
+        // Counts up from 1 with each published frame; 0 until the first.
+        juce::uint32 sequence = 0;
+        // One byte per pixel, row-major, top row first.
+        std::vector<uint8_t> pixels;
+    };
+
+    // Producer only: the frame to fill before publish().
+    Frame& getWriteFrame() { return frames[(size_t) writeIndex]; }
+
+    // Producer only: makes the write frame the latest and takes back whichever
+    // frame the consumer isn't holding.
+    void publish() {
+        frames[(size_t) writeIndex].sequence = ++publishedCount;
+        writeIndex = middle.exchange(writeIndex | kFreshBit, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Consumer only: swaps in the latest frame if one has been published since
+    // the last call. Returns true if the read frame changed.
+    bool acquireLatest() {
+        if ((middle.load(std::memory_order_relaxed) & kFreshBit) == 0) {
+            return false;
+        }
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    // Consumer only: the frame last acquired. Empty until the first frame.
+    const Frame& getReadFrame() const { return frames[(size_t) readIndex]; }
+
+private:
+    static constexpr int kIndexMask = 0x3;
+    static constexpr int kFreshBit = 0x4;
+
+    std::array<Frame, 3> frames;
+    int writeIndex = 0;
+    int readIndex = 2;
+    std::atomic<int> middle{ 1 };
+    juce::uint32 publishedCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(LatestFrameSlot)
+};
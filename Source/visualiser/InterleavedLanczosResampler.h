@@ -0,0 +1,179 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Lanczos upsampler for up to eight channels at once.
+//
+// Input frames are stored interleaved, so each output sample works out the
+// windowed-sinc kernel once and applies it to a SIMD register's worth of
+// channels per tap, instead of every channel redoing the kernel in its own
+// resampler. The history is mirrored so the taps are always contiguous.
+class InterleavedLanczosResampler {
+public:
+    static constexpr int kMaxChannels = 8;
+    // Kernel half-width in input samples.
+    static constexpr int kA = 8;
+    static constexpr int kFilterWidth = 2 * kA;
+
+    InterleavedLanczosResampler() {
+        reset();
+    }
+
+    // ratio is output samples per input sample.
+    void prepare(double ratio) {
+        jassert(ratio > 0.0);
+        outputStep = 1.0 / ratio;
+        reset();
+    }
+
+    void reset() {
+        std::fill(std::begin(history), std::end(history), 0.0f);
+        writeIndex = 0;
+        inputPhase = 0;
+        outputPhase = 0.0;
+    }
+
+    // Pushes numSamples frames and writes up to maxOutputs upsampled frames
+    // to each output. A null input is read as silence and a null output is
+    // skipped. Output starts kA + 1 input samples late and is otherwise
+    // continuous across calls. Returns the number of frames written.
+    int process(const float* const* inputs, float* const* outputs, int numChannels, int numSamples, int maxOutputs) noexcept {
+        jassert(numChannels > 0 && numChannels <= kMaxChannels);
+        numChannels = juce::jlimit(1, kMaxChannels, numChannels);
+
+        int written = 0;
+        for (int start = 0; start < numSamples; start += kChunkSize) {
+            const int chunk = juce::jmin(kChunkSize, numSamples - start);
+            push(inputs, numChannels, start, chunk);
+            written = drain(outputs, numChannels, written, maxOutputs);
+        }
+        return written;
+    }
+
+private:
+    static constexpr int kBufferSize = 1024;
+    // Frames pushed before draining. Draining reads at most kFilterWidth + 2
+    // frames further back, which must not have been overwritten.
+    static constexpr int kChunkSize = kBufferSize / 2;
+    static constexpr int kTableSize = 1024;
+
+#if JUCE_USE_SIMD
+    using Register = juce::dsp::SIMDRegister<float>;
+    static constexpr int kLanes = (int) Register::SIMDNumElements;
+    static_assert(kMaxChannels % kLanes == 0, "Channel groups must fill whole registers");
+#endif
+
+    struct KernelTable {
+        // values[t][i] is the kernel for tap i when the read position is
+        // t / kTableSize past a whole sample; deltas step to t + 1.
+        float values[kTableSize + 1][kFilterWidth];
+        float deltas[kTableSize][kFilterWidth];
+
+        KernelTable() {
+            for (int t = 0; t <= kTableSize; t++) {
+                const double frac = (double) t / kTableSize;
+                for (int i = 0; i < kFilterWidth; i++) {
+                    values[t][i] = (float) kernel(frac + kA - 1 - i);
+                }
+            }
+            for (int t = 0; t < kTableSize; t++) {
+                for (int i = 0; i < kFilterWidth; i++) {
+                    deltas[t][i] = values[t + 1][i] - values[t][i];
+                }
+            }
+        }
+
+        static double kernel(double x) {
+            if (std::abs(x) < 1.0e-7) {
+                return 1.0;
+            }
+            if (std::abs(x) >= kA) {
+                return 0.0;
+            }
+            const double pi = juce::MathConstants<double>::pi;
+            return kA * std::sin(pi * x) * std::sin(pi * x / kA) / (pi * pi * x * x);
+        }
+    };
+
+    static const KernelTable& getTable() {
+        static const KernelTable table;
+        return table;
+    }
+
+    void push(const float* const* inputs, int numChannels, int start, int numSamples) noexcept {
+        for (int c = 0; c < numChannels; c++) {
+            const float* input = inputs[c];
+            int index = writeIndex;
+            for (int i = 0; i < numSamples; i++) {
+                const float value = input != nullptr ? input[start + i] : 0.0f;
+                history[index * kMaxChannels + c] = value;
+                history[(index + kBufferSize) * kMaxChannels + c] = value;
+                index = (index + 1) & (kBufferSize - 1);
+            }
+        }
+        writeIndex = (writeIndex + numSamples) & (kBufferSize - 1);
+        inputPhase += numSamples;
+
+        // Keep the phases small so the fraction stays precise. Moving both
+        // by whole buffers leaves every read at the same buffer index.
+        if (inputPhase > (1 << 24)) {
+            const juce::int64 shift = (inputPhase / kBufferSize - 1) * kBufferSize;
+            inputPhase -= shift;
+            outputPhase -= (double) shift;
+        }
+    }
+
+    int drain(float* const* outputs, int numChannels, int written, int maxOutputs) noexcept {
+        const auto& table = getTable();
+        alignas(32) float coefficients[kFilterWidth];
+        alignas(32) float result[kMaxChannels];
+
+        while (written < maxOutputs && (double) inputPhase - outputPhase > kA + 1) {
+            const double whole = std::floor(outputPhase);
+            const double tablePosition = (outputPhase - whole) * kTableSize;
+            const int t = juce::jmin(kTableSize - 1, (int) tablePosition);
+            const float blend = (float) (tablePosition - t);
+            for (int i = 0; i < kFilterWidth; i++) {
+                coefficients[i] = table.values[t][i] + blend * table.deltas[t][i];
+            }
+
+            // First tap is kA - 1 samples before the read position.
+            const int first = (int) (((juce::int64) whole - kA + 1) & (kBufferSize - 1));
+            const float* taps = history + first * kMaxChannels;
+
+#if JUCE_USE_SIMD
+            for (int group = 0; group < numChannels; group += kLanes) {
+                auto sum = Register::expand(0.0f);
+                for (int i = 0; i < kFilterWidth; i++) {
+                    sum += Register::fromRawArray(taps + i * kMaxChannels + group) * coefficients[i];
+                }
+                sum.copyToRawArray(result + group);
+            }
+#else
+            for (int c = 0; c < numChannels; c++) {
+                float sum = 0.0f;
+                for (int i = 0; i < kFilterWidth; i++) {
+                    sum += taps[i * kMaxChannels + c] * coefficients[i];
+                }
+                result[c] = sum;
+            }
+#endif
+
+            for (int c = 0; c < numChannels; c++) {
+                if (outputs[c] != nullptr) {
+                    outputs[c][written] = result[c];
+                }
+            }
+            written++;
+            outputPhase += outputStep;
+        }
+        return written;
+    }
+
+    // Two copies of the last kBufferSize frames, kMaxChannels floats each.
+    alignas(32) float history[2 * kBufferSize * kMaxChannels];
+    int writeIndex = 0;
+    juce::int64 inputPhase = 0;
+    double outputPhase = 0.0;
+    double outputStep = 1.0;
+};
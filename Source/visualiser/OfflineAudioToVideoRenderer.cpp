@@ -13,6 +13,7 @@ juce::String OfflineAudioToVideoRendererComponent::toPercentString(double progre
 bool OfflineAudioToVideoRendererComponent::runFfmpegMux(const juce::File& ffmpegExe,
                                                        const juce::File& videoInput,
                                                        const juce::File& audioInput,
+                                                       const juce::StringArray& audioInputArgs,
                                                        const juce::File& output,
                                                        const juce::StringArray& audioCodecArgs,
                                                        const std::atomic<bool>& cancelRequested,
@@ -40,6 +41,7 @@ bool OfflineAudioToVideoRendererComponent::runFfmpegMux(const juce::File& ffmpeg
     args.add(ffmpegExe.getFullPathName());
     args.addArray({"-hide_banner", "-loglevel", "error"});
     args.addArray({"-i", videoInput.getFullPathName()});
+    args.addArray(audioInputArgs);
     args.addArray({"-i", audioInput.getFullPathName()});
     args.addArray({"-c:v", "copy"});
     args.addArray(audioCodecArgs);
@@ -106,6 +108,7 @@ OfflineAudioToVideoRendererComponent::WorkerThread::WorkerThread(OfflineAudioToV
 
 void OfflineAudioToVideoRendererComponent::WorkerThread::run()
 {
+    juce::ScopedNoDenormals noDenormals;
     auto result = owner.renderToFile();
     owner.finishAsync(result);
 }
@@ -316,6 +319,7 @@ OfflineAudioToVideoRendererComponent::Result OfflineAudioToVideoRendererComponen
 
     // Derive render mode from the audio file channel count.
     // >= 5: XYRGB, >= 3: XYZ, >= 2: XY, else: XY (mono -> duplicated).
+    // 6 channels is osci-render's native XYZRGB layout (e.g. from an offline project render).
     const auto derivedRenderMode = (decodeChannels >= 5)
         ? VisualiserRenderer::RenderMode::XYRGB
         : (decodeChannels >= 3)
@@ -331,8 +335,14 @@ OfflineAudioToVideoRendererComponent::Result OfflineAudioToVideoRendererComponen
     preview.setFrameRate(fps);
     preview.prepareTask(fileSampleRate, samplesPerFrame);
 
-    const juce::int64 totalSamples = (juce::int64) wav.totalSamples.load();
+    // Only the selected region, if the timeline had one.
+    const juce::int64 fileSamples = (juce::int64) wav.totalSamples.load();
+    const juce::int64 startSample = (juce::int64) (renderRange.getStart() * (double) fileSamples);
+    const juce::int64 endSample = renderRange.isEmpty() ? fileSamples : (juce::int64) (renderRange.getEnd() * (double) fileSamples);
+    const juce::int64 totalSamples = juce::jmax<juce::int64>(0, endSample - startSample);
     const juce::int64 totalFrames = std::max<juce::int64>(1, (totalSamples + (juce::int64) samplesPerFrame - 1) / (juce::int64) samplesPerFrame);
+    if (startSample > 0)
+        wav.setProgress((double) startSample / (double) fileSamples);
 
     // Setup ffmpeg video encoder (raw RGBA frames piped to stdin)
     auto ffmpegFile = processor.getFFmpegFile();
@@ -408,7 +418,13 @@ OfflineAudioToVideoRendererComponent::Result OfflineAudioToVideoRendererComponen
         if (decodeChannels >= 3)
             juce::FloatVectorOperations::copy(renderBuffer.getWritePointer(2), decodeBuffer.getReadPointer(2), samplesPerFrame);
 
-        if (decodeChannels >= 5)
+        if (decodeChannels >= 6)
+        {
+            // Native XYZRGB: channels map one-to-one.
+            for (int channel = 3; channel < 6; ++channel)
+                juce::FloatVectorOperations::copy(renderBuffer.getWritePointer(channel), decodeBuffer.getReadPointer(channel), samplesPerFrame);
+        }
+        else if (decodeChannels >= 5)
         {
             // Use channels 2/3/4 as RGB, and set Z to 1.0 for XYRGB mode.
             juce::FloatVectorOperations::fill(renderBuffer.getWritePointer(2), 1.0f, samplesPerFrame);
@@ -486,8 +502,18 @@ OfflineAudioToVideoRendererComponent::Result OfflineAudioToVideoRendererComponen
 
     if (recordingSettings.recordingAudio())
     {
+        // Only X/Y belong in the soundtrack; the remaining channels drive the picture.
+        auto audioCodecArgs = recordingSettings.getAudioCodecArgs();
+        if (decodeChannels > 2)
+            audioCodecArgs.addArray({"-af", "pan=stereo|c0=c0|c1=c1"});
+
+        juce::StringArray audioInputArgs;
+        if (startSample > 0 || endSample < fileSamples)
+            audioInputArgs.addArray({"-ss", juce::String((double) startSample / fileSampleRate, 6),
+                                     "-t", juce::String((double) totalSamples / fileSampleRate, 6)});
+
         juce::String muxError;
-        if (!runFfmpegMux(ffmpegFile, tempVideoFile, inputAudioFile, tempFinal.getFile(), recordingSettings.getAudioCodecArgs(), cancelRequested, muxError))
+        if (!runFfmpegMux(ffmpegFile, tempVideoFile, inputAudioFile, audioInputArgs, tempFinal.getFile(), audioCodecArgs, cancelRequested, muxError))
         {
             tempFinal.getFile().deleteFile();
             tempVideoFile.deleteFile();
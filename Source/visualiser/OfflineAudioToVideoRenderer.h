@@ -42,6 +42,8 @@ public:
     void cancel();
 
     void setOnFinished(FinishedCallback cb) { onFinished = std::move(cb); }
+    // Renders only part of the file, given as 0-1 progress. Call before start().
+    void setRenderRange(juce::Range<double> range) { renderRange = range.getIntersectionWith({ 0.0, 1.0 }); }
 
 private:
     static juce::String toPercentString(double progress);
@@ -49,6 +51,7 @@ private:
     static bool runFfmpegMux(const juce::File& ffmpegExe,
                              const juce::File& videoInput,
                              const juce::File& audioInput,
+                             const juce::StringArray& audioInputArgs,
                              const juce::File& output,
                              const juce::StringArray& audioCodecArgs,
                              const std::atomic<bool>& cancelRequested,
@@ -99,6 +102,7 @@ private:
     juce::TextButton cancelButton { "Cancel" };
 
     const VisualiserRenderer::RenderMode initialRenderMode;
+    juce::Range<double> renderRange { 0.0, 1.0 };
 
     std::atomic<bool> cancelRequested { false };
     std::unique_ptr<WorkerThread> worker;
@@ -80,6 +80,42 @@ RecordingSettings::RecordingSettings(RecordingParameters& ps) : parameters(ps) {
     
     sosciLink.setColour(juce::HyperlinkButton::textColourId, Colours::accentColor());
 #endif
+
+    addAndMakeVisible(audioFormatLabel);
+    addAndMakeVisible(audioFormatSelector);
+    addAndMakeVisible(audioBitDepthLabel);
+    addAndMakeVisible(audioBitDepthSelector);
+    addAndMakeVisible(audioChannelsLabel);
+    addAndMakeVisible(audioChannelsSelector);
+
+    audioFormatSelector.addItem("WAV", static_cast<int>(AudioRecordingFormat::Wav) + 1);
+    audioFormatSelector.addItem("AIFF", static_cast<int>(AudioRecordingFormat::Aiff) + 1);
+    audioFormatSelector.addItem("FLAC", static_cast<int>(AudioRecordingFormat::Flac) + 1);
+    audioFormatSelector.setSelectedId(static_cast<int>(parameters.audioFormat) + 1, juce::dontSendNotification);
+    audioFormatSelector.onChange = [this] {
+        parameters.audioFormat = static_cast<AudioRecordingFormat>(audioFormatSelector.getSelectedId() - 1);
+        updateAudioBitDepths();
+    };
+    audioFormatLabel.setTooltip("The file format audio is recorded in. Only WAV files store which visualiser channel each channel holds, so sosci can play them back with the right colours.");
+
+    audioBitDepthSelector.onChange = [this] {
+        parameters.audioBitDepth = audioBitDepthSelector.getSelectedId();
+    };
+    updateAudioBitDepths();
+    audioBitDepthLabel.setTooltip("The bit depth of recorded audio. 32-bit WAV files are stored as floating point, so nothing above full scale is clipped.");
+
+    audioChannelsSelector.addItem("X, Y", ChannelLayout::kMaskXY);
+    audioChannelsSelector.addItem("X, Y, Z", ChannelLayout::kMaskXYZ);
+    audioChannelsSelector.addItem("X, Y, R, G, B", ChannelLayout::kMaskXYRGB);
+    audioChannelsSelector.addItem("X, Y, Z, R, G, B", ChannelLayout::kMaskAll);
+    audioChannelsSelector.setSelectedId(parameters.audioChannelMask, juce::dontSendNotification);
+    if (audioChannelsSelector.getSelectedId() == 0) {
+        audioChannelsSelector.setSelectedId(ChannelLayout::kMaskXY);
+    }
+    audioChannelsSelector.onChange = [this] {
+        parameters.audioChannelMask = audioChannelsSelector.getSelectedId();
+    };
+    audioChannelsLabel.setTooltip("The visualiser channels recorded to the audio file. Z is brightness, and R, G and B are the colour channels. Videos only include X and Y.");
 }
 
 RecordingSettings::~RecordingSettings() {}
@@ -89,9 +125,34 @@ void RecordingSettings::updateLosslessAudioEnabled() {
                              && parameters.videoCodec != VideoCodec::VP9);
 }
 
+void RecordingSettings::updateAudioBitDepths() {
+    // Only offer bit depths the chosen format can store.
+    juce::Array<int> depths;
+    switch (parameters.audioFormat) {
+        case AudioRecordingFormat::Flac:
+        case AudioRecordingFormat::Aiff:
+            depths = { 16, 24 };
+            break;
+        case AudioRecordingFormat::Wav:
+        default:
+            depths = { 16, 24, 32 };
+            break;
+    }
+
+    audioBitDepthSelector.clear(juce::dontSendNotification);
+    for (int depth : depths) {
+        audioBitDepthSelector.addItem(depth == 32 ? "32 (float)" : juce::String(depth), depth);
+    }
+    if (!depths.contains(parameters.audioBitDepth)) {
+        parameters.audioBitDepth = depths.getLast();
+    }
+    audioBitDepthSelector.setSelectedId(parameters.audioBitDepth, juce::dontSendNotification);
+}
+
 void RecordingSettings::resized() {
 	auto area = getLocalBounds().reduced(20);
     double rowHeight = 30;
+    juce::Rectangle<int> row;
     
 #if OSCI_PREMIUM
     losslessAudio.setBounds(area.removeFromTop(rowHeight));
@@ -102,7 +163,7 @@ void RecordingSettings::resized() {
     recordAudio.setBounds(area.removeFromTop(rowHeight));
     recordVideo.setBounds(area.removeFromTop(rowHeight));
     
-    auto row = area.removeFromTop(rowHeight);
+    row = area.removeFromTop(rowHeight);
     compressionPresetLabel.setBounds(row.removeFromLeft(170));
     compressionPreset.setBounds(row.removeFromRight(100));
     
@@ -121,4 +182,19 @@ void RecordingSettings::resized() {
     sosciLink.setBounds(area.removeFromTop(rowHeight));
 #endif
 
+    area.removeFromTop(5);
+    row = area.removeFromTop(rowHeight);
+    audioFormatLabel.setBounds(row.removeFromLeft(170));
+    audioFormatSelector.setBounds(row.removeFromRight(100));
+
+    area.removeFromTop(5);
+    row = area.removeFromTop(rowHeight);
+    audioBitDepthLabel.setBounds(row.removeFromLeft(170));
+    audioBitDepthSelector.setBounds(row.removeFromRight(100));
+
+    area.removeFromTop(5);
+    row = area.removeFromTop(rowHeight);
+    audioChannelsLabel.setBounds(row.removeFromLeft(170));
+    audioChannelsSelector.setBounds(row.removeFromRight(100));
+
 }
@@ -5,6 +5,7 @@
 #include "../components/SvgButton.h"
 #include "../LookAndFeel.h"
 #include "../components/SwitchButton.h"
+#include "../audio/AudioRecorder.h"
 
 // Define codec options
 enum class VideoCodec {
@@ -69,6 +70,10 @@ public:
     juce::String compressionPreset = "fast";
     VideoCodec videoCodec = VideoCodec::H264;
 
+    AudioRecordingFormat audioFormat = AudioRecordingFormat::Wav;
+    int audioBitDepth = 32;
+    int audioChannelMask = ChannelLayout::kMaskXY;
+
     void save(juce::XmlElement* xml) {
         auto settingsXml = xml->createNewChildElement("recordingSettings");
         losslessAudio.save(settingsXml->createNewChildElement("losslessAudio"));
@@ -78,6 +83,9 @@ public:
         settingsXml->setAttribute("compressionPreset", compressionPreset);
         settingsXml->setAttribute("customSharedTextureServerName", customSharedTextureServerName);
         settingsXml->setAttribute("videoCodec", static_cast<int>(videoCodec));
+        settingsXml->setAttribute("audioFormat", static_cast<int>(audioFormat));
+        settingsXml->setAttribute("audioBitDepth", audioBitDepth);
+        settingsXml->setAttribute("audioChannelMask", audioChannelMask);
         
         auto qualityXml = settingsXml->createNewChildElement("quality");
         qualityEffect->save(qualityXml);
@@ -114,6 +122,15 @@ public:
                 int codecValue = settingsXml->getIntAttribute("videoCodec", 0);
                 videoCodec = static_cast<VideoCodec>(codecValue);
             }
+            if (settingsXml->hasAttribute("audioFormat")) {
+                audioFormat = static_cast<AudioRecordingFormat>(settingsXml->getIntAttribute("audioFormat", 0));
+            }
+            if (settingsXml->hasAttribute("audioBitDepth")) {
+                audioBitDepth = settingsXml->getIntAttribute("audioBitDepth", 32);
+            }
+            if (settingsXml->hasAttribute("audioChannelMask")) {
+                audioChannelMask = settingsXml->getIntAttribute("audioChannelMask", ChannelLayout::kMaskXY);
+            }
             if (auto* qualityXml = settingsXml->getChildByName("quality")) {
                 qualityEffect->load(qualityXml);
             }
@@ -193,11 +210,30 @@ public:
         }
     }
 
+    AudioRecordingFormat getAudioFormat() {
+        return parameters.audioFormat;
+    }
+
+    int getAudioBitDepth() {
+        return parameters.audioBitDepth;
+    }
+
+    int getAudioChannelMask() {
+        return parameters.audioChannelMask;
+    }
+
     juce::StringArray getAudioCodecArgs() const {
+        juce::StringArray args;
+        // The video only gets X and Y, however many channels were recorded.
+        if (parameters.audioChannelMask != ChannelLayout::kMaskXY) {
+            args.addArray({"-af", "\"pan=stereo|c0=c0|c1=c1\""});
+        }
         if (parameters.losslessAudio.getBoolValue() && parameters.videoCodec != VideoCodec::VP9) {
-            return {"-c:a", "pcm_s16le"};
+            args.addArray({"-c:a", "pcm_s16le"});
+        } else {
+            args.addArray({"-c:a", "aac", "-b:a", "384k"});
         }
-        return {"-c:a", "aac", "-b:a", "384k"};
+        return args;
     }
 
     RecordingParameters& parameters;
@@ -223,10 +259,20 @@ private:
     juce::Label videoCodecLabel{"Video Codec", "Video Codec"};
     juce::ComboBox videoCodecSelector;
     
+    juce::Label audioFormatLabel{"Audio Format", "Audio Format"};
+    juce::ComboBox audioFormatSelector;
+
+    juce::Label audioBitDepthLabel{"Audio Bit Depth", "Audio Bit Depth"};
+    juce::ComboBox audioBitDepthSelector;
+
+    juce::Label audioChannelsLabel{"Audio Channels", "Audio Channels"};
+    juce::ComboBox audioChannelsSelector;
+
     juce::Label customSharedTextureOutputLabel{"Custom Syphon/Spout Name", "Custom Syphon/Spout Name"};
     juce::TextEditor customSharedTextureOutputEditor{"customSharedTextureOutputEditor"};
 
     void updateLosslessAudioEnabled();
+    void updateAudioBitDepths();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordingSettings)
 };
@@ -452,12 +452,14 @@ void VisualiserComponent::setRecording(bool recording) {
         }
 
         if (recordingAudio) {
-            tempAudioFile = std::make_unique<juce::TemporaryFile>(".wav");
+            audioRecorder.setFormat(recordingSettings.getAudioFormat(), recordingSettings.getAudioBitDepth(), recordingSettings.getAudioChannelMask());
+            tempAudioFile = std::make_unique<juce::TemporaryFile>("." + audioRecorder.getFileExtension());
             audioRecorder.startRecording(tempAudioFile->getFile());
         }
 #else
         // audio only recording
-        tempAudioFile = std::make_unique<juce::TemporaryFile>(".wav");
+        audioRecorder.setFormat(recordingSettings.getAudioFormat(), recordingSettings.getAudioBitDepth(), recordingSettings.getAudioChannelMask());
+        tempAudioFile = std::make_unique<juce::TemporaryFile>("." + audioRecorder.getFileExtension());
         audioRecorder.startRecording(tempAudioFile->getFile());
 #endif
 
@@ -470,7 +472,7 @@ void VisualiserComponent::setRecording(bool recording) {
         recordingAudio = false;
         recordingVideo = false;
 
-        juce::String extension = wasRecordingVideo ? recordingSettings.getFileExtensionForCodec() : "wav";
+        juce::String extension = wasRecordingVideo ? recordingSettings.getFileExtensionForCodec() : audioRecorder.getFileExtension();
         if (wasRecordingAudio) {
             audioRecorder.stop();
         }
@@ -479,7 +481,7 @@ void VisualiserComponent::setRecording(bool recording) {
         }
 #else
         audioRecorder.stop();
-        juce::String extension = "wav";
+        juce::String extension = audioRecorder.getFileExtension();
 #endif
         chooser = std::make_unique<juce::FileChooser>("Save recording", audioProcessor.getLastOpenedDirectory(), "*." + extension);
         auto flags = juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles | juce::FileBrowserComponent::warnAboutOverwriting;
@@ -45,26 +45,24 @@ VisualiserRenderer::~VisualiserRenderer() {
 }
 
 void VisualiserRenderer::runTask(const juce::AudioBuffer<float>& buffer) {
+    // Runs on a background thread, which doesn't inherit the audio thread's
+    // flush-to-zero mode.
+    juce::ScopedNoDenormals noDenormals;
     {
         juce::CriticalSection::ScopedLockType lock(samplesLock);
 
         const int numSamples = buffer.getNumSamples();
         const int numChannels = buffer.getNumChannels();
 
-        // copy the buffer before applying effects
-        audioOutputBuffer.setSize(2, numSamples, false, true, true);
-        audioOutputBuffer.copyFrom(0, 0, buffer, 0, 0, numSamples);
-        audioOutputBuffer.copyFrom(1, 0, buffer, 1, 0, numSamples);
-
-        xSamples.clear();
-        ySamples.clear();
-        zSamples.clear();
-        rSamples.clear();
-        gSamples.clear();
-        bSamples.clear();
+        // copy the buffer before applying effects, keeping every channel so
+        // the recorder can write any of them
+        audioOutputBuffer.setSize(numChannels, numSamples, false, true, true);
+        for (int ch = 0; ch < numChannels; ++ch) {
+            audioOutputBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+        }
 
         // Create a working buffer for effects processing (6 channels: XYZRGB)
-        tempBuffer.setSize(6, numSamples, false, true, false);
+        tempBuffer.setSize(6, numSamples, false, true, true);
         
         // Copy input channels to temp buffer
         for (int ch = 0; ch < juce::jmin(6, numChannels); ++ch) {
@@ -103,144 +101,22 @@ void VisualiserRenderer::runTask(const juce::AudioBuffer<float>& buffer) {
 #endif
 
         auto mode = renderMode.load();
-        
-        // Get array of read pointers for all 6 channels (XYZRGB)
-        auto channelData = tempBuffer.getArrayOfReadPointers();
-        
-        if (parameters.isSweepEnabled()) {
-            double sweepIncrement = getSweepIncrement();
-            double triggerValue = parameters.getTriggerValue();
-            bool belowTrigger = false;
-
-            for (int i = 0; i < numSamples; ++i) {
-                long samplePosition = sampleCount - lastTriggerPosition;
-                double startPoint = 1.135;
-                float sweep = samplePosition * sweepIncrement * 2 * startPoint - startPoint;
-
-                float value = channelData[0][i];
-
-                if (sweep > startPoint && belowTrigger && value >= triggerValue) {
-                    lastTriggerPosition = sampleCount;
-                }
-
-                belowTrigger = value < triggerValue;
-
-                xSamples.push_back(sweep);
-                ySamples.push_back(value);
-                if (mode == RenderMode::XYZ) {
-                    zSamples.push_back(1.0f); // legacy: third component treated as brightness
-                } else if (mode == RenderMode::XYRGB) {
-                    // no colour specified — sentinel -1 flows through
-                    rSamples.push_back(numChannels > 3 ? channelData[3][i] : -1.0f);
-                    gSamples.push_back(numChannels > 4 ? channelData[4][i] : -1.0f);
-                    bSamples.push_back(numChannels > 5 ? channelData[5][i] : -1.0f);
-                }
 
-                sampleCount++;
-            }
-        } else {
-            // Helper lambda to copy channel data or fill with default value
-            auto copyOrFillChannel = [&](std::vector<float>& dest, int channelIndex, float defaultValue) {
-                dest.resize(numSamples);
-                if (numChannels > channelIndex) {
-                    juce::FloatVectorOperations::copy(dest.data(), channelData[channelIndex], numSamples);
-                } else {
-                    juce::FloatVectorOperations::fill(dest.data(), defaultValue, numSamples);
-                }
-            };
-            
+        VisualiserSamples::Settings settings;
+        settings.brightness = mode == RenderMode::XYZ;
+        settings.colour = mode == RenderMode::XYRGB;
+        settings.upsampling = parameters.upsamplingEnabled->getBoolValue();
+        settings.sweep = parameters.isSweepEnabled();
+        settings.sweepIncrement = getSweepIncrement();
+        settings.triggerValue = parameters.getTriggerValue();
 #if OSCI_PREMIUM
-            if (parameters.isGoniometer()) {
-                // x and y go to a diagonal currently, so we need to scale them down, and rotate them
-                const float xScale = -1.0f / std::sqrt(2.0f);
-                const float yScale = 1.0f / std::sqrt(2.0f);
-                const float rotationAngle = -juce::MathConstants<float>::pi / 4.0f;
-                const float cosAngle = std::cos(rotationAngle);
-                const float sinAngle = std::sin(rotationAngle);
-                
-                // Resize output vectors to hold all samples
-                xSamples.resize(numSamples);
-                ySamples.resize(numSamples);
-                
-                // Create temporary buffers for scaled values
-                std::vector<float> scaledX(numSamples);
-                std::vector<float> scaledY(numSamples);
-                
-                // Scale X and Y channels
-                juce::FloatVectorOperations::copyWithMultiply(scaledX.data(), channelData[0], xScale, numSamples);
-                juce::FloatVectorOperations::copyWithMultiply(scaledY.data(), channelData[1], yScale, numSamples);
-                
-                // Apply rotation: rotatedX = scaledX * cosAngle - scaledY * sinAngle
-                juce::FloatVectorOperations::copyWithMultiply(xSamples.data(), scaledX.data(), cosAngle, numSamples);
-                juce::FloatVectorOperations::addWithMultiply(xSamples.data(), scaledY.data(), -sinAngle, numSamples);
-                
-                // Apply rotation: rotatedY = scaledX * sinAngle + scaledY * cosAngle
-                juce::FloatVectorOperations::copyWithMultiply(ySamples.data(), scaledX.data(), sinAngle, numSamples);
-                juce::FloatVectorOperations::addWithMultiply(ySamples.data(), scaledY.data(), cosAngle, numSamples);
-            } else
+        settings.goniometer = parameters.isGoniometer();
 #endif
-            {
-                // Resize output vectors to hold all samples
-                xSamples.resize(numSamples);
-                ySamples.resize(numSamples);
-                
-                // Copy X and Y channels directly
-                juce::FloatVectorOperations::copy(xSamples.data(), channelData[0], numSamples);
-                juce::FloatVectorOperations::copy(ySamples.data(), channelData[1], numSamples);
-            }
-            
-            // Handle Z/RGB channels using helper lambda
-            if (mode == RenderMode::XYZ) {
-                copyOrFillChannel(zSamples, 2, 1.0f);
-            } else if (mode == RenderMode::XYRGB) {
-                copyOrFillChannel(rSamples, 3, -1.0f);
-                copyOrFillChannel(gSamples, 4, -1.0f);
-                copyOrFillChannel(bSamples, 5, -1.0f);
-            }
-        }
-
-        sampleBufferCount++;
 
-        if (parameters.upsamplingEnabled->getBoolValue()) {
-            int newResampledSize = xSamples.size() * RESAMPLE_RATIO;
+        // All 6 channels (XYZRGB) of the processed block
+        samples.process(tempBuffer.getArrayOfReadPointers(), numChannels, numSamples, settings);
 
-            smoothedXSamples.resize(newResampledSize);
-            smoothedYSamples.resize(newResampledSize);
-            if (mode == RenderMode::XYZ) smoothedZSamples.resize(newResampledSize);
-            if (mode == RenderMode::XYRGB) {
-                smoothedRSamples.resize(newResampledSize);
-                smoothedGSamples.resize(newResampledSize);
-                smoothedBSamples.resize(newResampledSize);
-            }
-
-            if (parameters.isSweepEnabled()) {
-                // interpolate between sweep values to avoid any artifacts from quickly going from one sweep to the next
-                for (int i = 0; i < newResampledSize; ++i) {
-                    int index = i / RESAMPLE_RATIO;
-                    if (index < xSamples.size() - 1) {
-                        double thisSample = xSamples[index];
-                        double nextSample = xSamples[index + 1];
-                        if (nextSample > thisSample) {
-                            smoothedXSamples[i] = xSamples[index] + (i % (int)RESAMPLE_RATIO) * (nextSample - thisSample) / RESAMPLE_RATIO;
-                        } else {
-                            smoothedXSamples[i] = xSamples[index];
-                        }
-                    } else {
-                        smoothedXSamples[i] = xSamples[index];
-                    }
-                }
-            } else {
-                xResampler.process(xSamples.data(), smoothedXSamples.data(), (int) xSamples.size());
-            }
-            yResampler.process(ySamples.data(), smoothedYSamples.data(), (int) ySamples.size());
-            if (mode == RenderMode::XYZ) {
-                if (!zSamples.empty()) zResampler.process(zSamples.data(), smoothedZSamples.data(), (int) zSamples.size());
-            } else if (mode == RenderMode::XYRGB) {
-                if (!rSamples.empty()) rResampler.process(rSamples.data(), smoothedRSamples.data(), (int) rSamples.size());
-                if (!gSamples.empty()) gResampler.process(gSamples.data(), smoothedGSamples.data(), (int) gSamples.size());
-                if (!bSamples.empty()) bResampler.process(bSamples.data(), smoothedBSamples.data(), (int) bSamples.size());
-            }
-        }
+        sampleBufferCount++;
     }
 
     // this just triggers a repaint
@@ -267,18 +143,18 @@ void VisualiserRenderer::runTask(const juce::AudioBuffer<float>& buffer) {
 
 int VisualiserRenderer::prepareTask(double sampleRate, int bufferSize) {
     this->sampleRate = sampleRate;
-    xResampler.prepare(sampleRate, RESAMPLE_RATIO);
-    yResampler.prepare(sampleRate, RESAMPLE_RATIO);
-    zResampler.prepare(sampleRate, RESAMPLE_RATIO);
-    rResampler.prepare(sampleRate, RESAMPLE_RATIO);
-    gResampler.prepare(sampleRate, RESAMPLE_RATIO);
-    bResampler.prepare(sampleRate, RESAMPLE_RATIO);
 
     int desiredBufferSize = sampleRate / frameRate;
 
     // Use desiredBufferSize when bufferSize is invalid (e.g. -1 from setFrameRate)
     int effectBufferSize = bufferSize > 0 ? bufferSize : desiredBufferSize;
 
+    {
+        // Size the sample buffers up front so runTask doesn't allocate
+        juce::CriticalSection::ScopedLockType lock(samplesLock);
+        samples.prepare(juce::jmax(desiredBufferSize, effectBufferSize));
+    }
+
     // Prepare audio effects with the correct sample rate
     for (auto& effect : parameters.audioEffects) {
         effect->prepareToPlay(sampleRate, effectBufferSize);
@@ -560,9 +436,9 @@ void VisualiserRenderer::renderOpenGL() {
             juce::CriticalSection::ScopedLockType lock(samplesLock);
 
             if (parameters.upsamplingEnabled->getBoolValue()) {
-                renderScope(smoothedXSamples, smoothedYSamples, smoothedRSamples, smoothedGSamples, smoothedBSamples);
+                renderScope(samples.smoothedXSamples, samples.smoothedYSamples, samples.smoothedRSamples, samples.smoothedGSamples, samples.smoothedBSamples);
             } else {
-                renderScope(xSamples, ySamples, rSamples, gSamples, bSamples);
+                renderScope(samples.xSamples, samples.ySamples, samples.rSamples, samples.gSamples, samples.bSamples);
             }
 
             if (postRenderCallback) {
@@ -762,7 +638,7 @@ void VisualiserRenderer::drawLineTexture(const std::vector<float> &xPoints, cons
     const std::vector<float>* brightness = nullptr;
     auto mode = renderMode.load();
     if (mode == RenderMode::XYZ) {
-        brightness = parameters.getUpsamplingEnabled() ? &smoothedZSamples : &zSamples;
+        brightness = parameters.getUpsamplingEnabled() ? &samples.smoothedZSamples : &samples.zSamples;
     }
     drawLine(xPoints, yPoints, brightness, rPoints, gPoints, bPoints, renderMode.load());
     glBindTexture(GL_TEXTURE_2D, targetTexture.value().id);
@@ -5,6 +5,7 @@
 #include <algorithm>
 
 #include "VisualiserParameters.h"
+#include "VisualiserSamples.h"
 
 struct Texture {
     GLuint id;
@@ -103,27 +104,13 @@ private:
     int nEdges = 0;
 
     juce::CriticalSection samplesLock;
-    long sampleCount = 0;
-    // XYRGB sample buffers (currently RGB derived from legacy Z brightness until full pipeline provides color)
-    std::vector<float> xSamples{2};
-    std::vector<float> ySamples{2};
-    // brightness (Z) channel used only in XYZ mode
-    std::vector<float> zSamples{2};
-    std::vector<float> rSamples{2};
-    std::vector<float> gSamples{2};
-    std::vector<float> bSamples{2};
-    std::vector<float> smoothedXSamples;
-    std::vector<float> smoothedYSamples;
-    std::vector<float> smoothedZSamples;
-    std::vector<float> smoothedRSamples;
-    std::vector<float> smoothedGSamples;
-    std::vector<float> smoothedBSamples;
+    // XYZRGB sample buffers, raw and upsampled
+    VisualiserSamples samples;
     std::atomic<int> sampleBufferCount = 0;
     // -1 means no pending request; any value > 0 is a requested texture resolution
     // to be applied on the next renderOpenGL invocation.
     std::atomic<int> pendingResolution = -1;
     int prevSampleBufferCount = 0;
-    long lastTriggerPosition = 0;
 
     juce::AudioBuffer<float> tempBuffer = juce::AudioBuffer<float>(6, 1);
     juce::MidiBuffer midiMessages;
@@ -208,16 +195,9 @@ private:
     std::atomic<int> resolution;
     double frameRate;
 
-    const double RESAMPLE_RATIO = 6.0;
+    const double RESAMPLE_RATIO = VisualiserSamples::kUpsampleRatio;
     double sampleRate = -1;
     double oldSampleRate = -1;
-    chowdsp::ResamplingTypes::LanczosResampler<2048, 8> xResampler;
-    chowdsp::ResamplingTypes::LanczosResampler<2048, 8> yResampler;
-    chowdsp::ResamplingTypes::LanczosResampler<2048, 8> zResampler;
-    // Dedicated colour channel resamplers to maintain independent filter state per channel
-    chowdsp::ResamplingTypes::LanczosResampler<2048, 8> rResampler;
-    chowdsp::ResamplingTypes::LanczosResampler<2048, 8> gResampler;
-    chowdsp::ResamplingTypes::LanczosResampler<2048, 8> bResampler;
     std::atomic<RenderMode> renderMode { RenderMode::XYRGB };
 
     void setOffsetAndScale(juce::OpenGLShaderProgram* shader);
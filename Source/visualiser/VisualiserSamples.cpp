@@ -0,0 +1,224 @@
+#include "VisualiserSamples.h"
+
+VisualiserSamples::VisualiserSamples() {
+    resampler.prepare(kUpsampleRatio);
+}
+
+void VisualiserSamples::prepare(int maxBlockSize) {
+    resampler.prepare(kUpsampleRatio);
+
+    const size_t size = (size_t) juce::jmax(1, maxBlockSize);
+    for (auto* samples : { &xSamples, &ySamples, &zSamples, &rSamples, &gSamples, &bSamples }) {
+        samples->reserve(size);
+    }
+    for (auto* samples : { &smoothedXSamples, &smoothedYSamples, &smoothedZSamples, &smoothedRSamples, &smoothedGSamples, &smoothedBSamples }) {
+        samples->reserve(size * kUpsampleRatio);
+    }
+}
+
+void VisualiserSamples::process(const float* const* channels, int numChannels, int numSamples, const Settings& settings) {
+    xSamples.clear();
+    ySamples.clear();
+    zSamples.clear();
+    rSamples.clear();
+    gSamples.clear();
+    bSamples.clear();
+
+    auto copyOrFillChannel = [&](std::vector<float>& dest, int channelIndex, float defaultValue) {
+        dest.resize(numSamples);
+        if (numChannels > channelIndex) {
+            juce::FloatVectorOperations::copy(dest.data(), channels[channelIndex], numSamples);
+        } else {
+            juce::FloatVectorOperations::fill(dest.data(), defaultValue, numSamples);
+        }
+    };
+
+    xSamples.resize(numSamples);
+    ySamples.resize(numSamples);
+
+    if (settings.sweep) {
+        juce::FloatVectorOperations::copy(ySamples.data(), channels[0], numSamples);
+        processSweep(channels[0], numSamples, settings);
+    } else if (settings.goniometer) {
+        // x and y go to a diagonal, so scale them down and rotate them by
+        // -45 degrees, done as a single 2x2 matrix.
+        const float xScale = -1.0f / std::sqrt(2.0f);
+        const float yScale = 1.0f / std::sqrt(2.0f);
+        const float rotationAngle = -juce::MathConstants<float>::pi / 4.0f;
+        const float cosAngle = std::cos(rotationAngle);
+        const float sinAngle = std::sin(rotationAngle);
+
+        juce::FloatVectorOperations::copyWithMultiply(xSamples.data(), channels[0], xScale * cosAngle, numSamples);
+        juce::FloatVectorOperations::addWithMultiply(xSamples.data(), channels[1], -yScale * sinAngle, numSamples);
+        juce::FloatVectorOperations::copyWithMultiply(ySamples.data(), channels[0], xScale * sinAngle, numSamples);
+        juce::FloatVectorOperations::addWithMultiply(ySamples.data(), channels[1], yScale * cosAngle, numSamples);
+    } else {
+        juce::FloatVectorOperations::copy(xSamples.data(), channels[0], numSamples);
+        juce::FloatVectorOperations::copy(ySamples.data(), channels[1], numSamples);
+    }
+
+    if (settings.brightness) {
+        // In sweep mode the brightness channel isn't used.
+        if (settings.sweep) {
+            zSamples.resize(numSamples);
+            juce::FloatVectorOperations::fill(zSamples.data(), 1.0f, numSamples);
+        } else {
+            copyOrFillChannel(zSamples, 2, 1.0f);
+        }
+    } else if (settings.colour) {
+        // no colour specified — sentinel -1 flows through
+        copyOrFillChannel(rSamples, 3, -1.0f);
+        copyOrFillChannel(gSamples, 4, -1.0f);
+        copyOrFillChannel(bSamples, 5, -1.0f);
+    }
+
+    if (settings.upsampling) {
+        upsample(settings);
+    }
+}
+
+void VisualiserSamples::processSweep(const float* y, int numSamples, const Settings& settings) {
+    const double increment = settings.sweepIncrement;
+
+    // The smallest float that is >= the trigger value, so comparing floats
+    // with it gives the same answers as comparing them with the double.
+    float trigger = (float) settings.triggerValue;
+    if ((double) trigger < settings.triggerValue) {
+        trigger = std::nextafter(trigger, std::numeric_limits<float>::infinity());
+    }
+
+    // Each pass fills the sweep up to and including the next trigger. The
+    // trigger can only fire once the sweep is past the right-hand edge, on a
+    // sample at or above the trigger value whose predecessor in this block
+    // was below it.
+    int i = 0;
+    while (i < numSamples) {
+        const juce::int64 position = sampleCount + i - lastTriggerPosition;
+        const int armed = i + findSweepEnd(position, increment, numSamples - i);
+        const int edge = findRisingEdge(y, juce::jmax(armed, 1), numSamples, trigger);
+        const int end = edge < numSamples ? edge + 1 : numSamples;
+
+        float* x = xSamples.data();
+        for (int j = i; j < end; j++) {
+            x[j] = sweepAt(position + (j - i), increment);
+        }
+
+        if (edge < numSamples) {
+            lastTriggerPosition = sampleCount + edge;
+        }
+        i = end;
+    }
+
+    sampleCount += numSamples;
+}
+
+// Returns how many samples after position the sweep first passes the
+// right-hand edge, or limit if it doesn't within limit samples.
+int VisualiserSamples::findSweepEnd(juce::int64 position, double increment, int limit) {
+    if (!(increment > 0.0) || !std::isfinite(increment)) {
+        return limit;
+    }
+
+    // The sweep passes the edge once position * increment > 1. Start from
+    // there and correct for rounding against the exact comparison.
+    const double estimate = juce::jlimit((double) position, (double) (position + limit), std::floor(1.0 / increment));
+    auto p = (juce::int64) estimate;
+    while (p > position && sweepAt(p - 1, increment) > kSweepStart) {
+        p--;
+    }
+    while (p < position + limit && !(sweepAt(p, increment) > kSweepStart)) {
+        p++;
+    }
+    return (int) (p - position);
+}
+
+// Returns the first index in [from, to) where samples[index - 1] is below
+// the trigger and samples[index] isn't, or to if there is none. from must be
+// at least 1.
+int VisualiserSamples::findRisingEdge(const float* samples, int from, int to, float trigger) {
+    jassert(from >= 1);
+    int index = from;
+
+    // Branch-free over blocks of eight so the compiler can vectorise it.
+    constexpr int kBlock = 8;
+    for (; index + kBlock <= to; index += kBlock) {
+        int found = 0;
+        for (int j = 0; j < kBlock; j++) {
+            found |= (int) (samples[index + j - 1] < trigger) & (int) (samples[index + j] >= trigger);
+        }
+        if (found != 0) {
+            break;
+        }
+    }
+
+    for (; index < to; index++) {
+        if (samples[index - 1] < trigger && samples[index] >= trigger) {
+            return index;
+        }
+    }
+    return to;
+}
+
+void VisualiserSamples::upsample(const Settings& settings) {
+    const int numSamples = (int) xSamples.size();
+    const int resampledSize = numSamples * kUpsampleRatio;
+
+    smoothedXSamples.resize(resampledSize);
+    smoothedYSamples.resize(resampledSize);
+    if (settings.brightness) {
+        smoothedZSamples.resize(resampledSize);
+    }
+    if (settings.colour) {
+        smoothedRSamples.resize(resampledSize);
+        smoothedGSamples.resize(resampledSize);
+        smoothedBSamples.resize(resampledSize);
+    }
+
+    if (settings.sweep) {
+        // interpolate between sweep values to avoid any artifacts from quickly going from one sweep to the next
+        for (int index = 0; index < numSamples; ++index) {
+            const double thisSample = xSamples[index];
+            float* smoothed = smoothedXSamples.data() + index * kUpsampleRatio;
+            if (index < numSamples - 1 && xSamples[index + 1] > thisSample) {
+                const double nextSample = xSamples[index + 1];
+                for (int step = 0; step < kUpsampleRatio; ++step) {
+                    smoothed[step] = thisSample + step * (nextSample - thisSample) / (double) kUpsampleRatio;
+                }
+            } else {
+                std::fill(smoothed, smoothed + kUpsampleRatio, (float) thisSample);
+            }
+        }
+    }
+
+    // All channels go through one resampler in X, Y, Z, R, G, B order. The
+    // sweep isn't resampled and unused channels are left silent.
+    const float* inputs[] = {
+        settings.sweep ? nullptr : xSamples.data(),
+        ySamples.data(),
+        settings.brightness ? zSamples.data() : nullptr,
+        settings.colour ? rSamples.data() : nullptr,
+        settings.colour ? gSamples.data() : nullptr,
+        settings.colour ? bSamples.data() : nullptr,
+    };
+    float* outputs[] = {
+        settings.sweep ? nullptr : smoothedXSamples.data(),
+        smoothedYSamples.data(),
+        settings.brightness ? smoothedZSamples.data() : nullptr,
+        settings.colour ? smoothedRSamples.data() : nullptr,
+        settings.colour ? smoothedGSamples.data() : nullptr,
+        settings.colour ? smoothedBSamples.data() : nullptr,
+    };
+    const int numChannels = settings.colour ? 6 : settings.brightness ? 3 : 2;
+
+    const int written = resampler.process(inputs, outputs, numChannels, numSamples, resampledSize);
+
+    // The first block comes up short by the filter's delay, and phase
+    // rounding can leave others a sample short. Hold the last value rather
+    // than leaving stale samples at the end.
+    for (int c = 0; c < numChannels; c++) {
+        if (outputs[c] != nullptr && written < resampledSize) {
+            const float last = written > 0 ? outputs[c][written - 1] : 0.0f;
+            std::fill(outputs[c] + written, outputs[c] + resampledSize, last);
+        }
+    }
+}
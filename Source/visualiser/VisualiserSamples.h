@@ -0,0 +1,72 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "InterleavedLanczosResampler.h"
+
+// Turns each block the visualiser receives into the sample vectors the
+// renderer draws: the sweep (time base) and its trigger, the goniometer
+// rotation, the brightness and colour channels, and the upsampled copies.
+//
+// Everything is sized in prepare(), so process() doesn't allocate for blocks
+// up to the prepared size. It has no OpenGL state, so it can be benchmarked
+// on its own.
+class VisualiserSamples {
+public:
+    static constexpr int kUpsampleRatio = 6;
+
+    struct Settings {
+        // XYZ mode: channel 2 is brightness.
+        bool brightness = false;
+        // XYRGB mode: channels 3, 4 and 5 are colour.
+        bool colour = false;
+        bool goniometer = false;
+        bool upsampling = false;
+        bool sweep = false;
+        double sweepIncrement = 0.0;
+        double triggerValue = 0.0;
+    };
+
+    VisualiserSamples();
+
+    void prepare(int maxBlockSize);
+
+    // channels must hold at least six pointers, but only the first
+    // numChannels are read. Missing colour channels are -1 and missing
+    // brightness is 1.
+    void process(const float* const* channels, int numChannels, int numSamples, const Settings& settings);
+
+    std::vector<float> xSamples;
+    std::vector<float> ySamples;
+    std::vector<float> zSamples;
+    std::vector<float> rSamples;
+    std::vector<float> gSamples;
+    std::vector<float> bSamples;
+    std::vector<float> smoothedXSamples;
+    std::vector<float> smoothedYSamples;
+    std::vector<float> smoothedZSamples;
+    std::vector<float> smoothedRSamples;
+    std::vector<float> smoothedGSamples;
+    std::vector<float> smoothedBSamples;
+
+private:
+    void processSweep(const float* y, int numSamples, const Settings& settings);
+    void upsample(const Settings& settings);
+
+    // The sweep runs from -kSweepStart to kSweepStart, a little past the
+    // edges of the screen.
+    static constexpr double kSweepStart = 1.135;
+
+    static float sweepAt(juce::int64 position, double increment) {
+        return (float) (position * increment * 2 * kSweepStart - kSweepStart);
+    }
+
+    static int findSweepEnd(juce::int64 position, double increment, int limit);
+    static int findRisingEdge(const float* samples, int from, int to, float trigger);
+
+    InterleavedLanczosResampler resampler;
+    juce::int64 sampleCount = 0;
+    juce::int64 lastTriggerPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VisualiserSamples)
+};
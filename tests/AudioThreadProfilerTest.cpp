@@ -0,0 +1,274 @@
+#include <JuceHeader.h>
+#include "../Source/audio/AudioThreadProfiler.h"
+
+// ============================================================================
+// Audio Thread Profiler Tests — a synthetic workload that spins for known
+// times inside nested stages checks the histograms and percentiles, that an
+// overrun is blamed on the stage that caused it, and that the JSON export
+// holds the same numbers. The export is written to the temp directory so it
+// can be inspected after a run.
+// ============================================================================
+
+#if OSCI_AUDIO_PROFILER
+
+class AudioThreadProfilerTest : public juce::UnitTest {
+public:
+    AudioThreadProfilerTest() : juce::UnitTest("Audio Thread Profiler", "Audio") {}
+
+    void runTest() override {
+        testBuckets();
+        testStageHistograms();
+        testOverrunBlame();
+        testDisableAndReset();
+        testStoppedScope();
+        testJsonExport();
+    }
+
+private:
+    static constexpr double kSampleRate = 48000.0;
+
+    static void spinFor(double microseconds) {
+        const auto end = juce::Time::getHighResolutionTicks()
+                       + juce::Time::secondsToHighResolutionTicks(microseconds / 1.0e6);
+        while (juce::Time::getHighResolutionTicks() < end) {}
+    }
+
+    // One block shaped like renderBlock(): modulation, then the synth with
+    // an effect nested in the voice effects stage, then output.
+    static void runBlock(AudioThreadProfiler& profiler, int numSamples, int effectSlot,
+                         double modulationUs, double effectUs, double outputUs) {
+        OSCI_PROFILE_BEGIN_BLOCK(profiler, numSamples, kSampleRate);
+        {
+            OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::Modulation);
+            spinFor(modulationUs);
+        }
+        {
+            OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::Synth);
+            OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::VoiceEffects);
+            OSCI_PROFILE_SCOPE(profiler, effectSlot);
+            spinFor(effectUs);
+        }
+        {
+            OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::Output);
+            spinFor(outputUs);
+        }
+        OSCI_PROFILE_END_BLOCK(profiler);
+    }
+
+    static const AudioThreadProfiler::SlotReport* findSlot(const AudioThreadProfiler::Report& report, const juce::String& name) {
+        for (auto& slot : report.slots) {
+            if (slot.name == name) {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    void testBuckets() {
+        beginTest("Bucket edges cover every duration in order");
+
+        int previous = 0;
+        for (juce::int64 ns = 1; ns < ((juce::int64) 1 << 30); ns = ns * 5 / 4 + 1) {
+            const int bucket = AudioThreadProfiler::getBucket(ns);
+            expect(bucket >= previous, "Buckets must not decrease as durations grow");
+            expect(bucket >= 0 && bucket < AudioThreadProfiler::kNumBuckets);
+            expect(ns / 1000.0 <= AudioThreadProfiler::getBucketUpperUs(bucket),
+                   "Duration " + juce::String(ns) + " ns is above its bucket's upper edge");
+            if (bucket > 0) {
+                expect(ns / 1000.0 >= AudioThreadProfiler::getBucketUpperUs(bucket - 1),
+                       "Duration " + juce::String(ns) + " ns fits the bucket below");
+            }
+            previous = bucket;
+        }
+        expectEquals(AudioThreadProfiler::getBucket(1), 0);
+        expectEquals(AudioThreadProfiler::getBucket((juce::int64) 1 << 40), AudioThreadProfiler::kNumBuckets - 1);
+    }
+
+    void testStageHistograms() {
+        beginTest("Stage times land in their histograms");
+
+        AudioThreadProfiler profiler;
+        const int effect = profiler.getSlot("Effect: test");
+        expectEquals(profiler.getSlot("Effect: test"), effect);
+
+        const int numBlocks = 40;
+        for (int i = 0; i < numBlocks; i++) {
+            // A one second deadline, so nothing overruns.
+            runBlock(profiler, (int) kSampleRate, effect, 50.0, 400.0, 0.0);
+        }
+
+        auto report = profiler.getReport();
+        expectEquals((int) report.blocks, numBlocks);
+        expectEquals((int) report.overruns, 0);
+
+        auto* block = findSlot(report, "Block");
+        auto* modulation = findSlot(report, "Modulation");
+        auto* synth = findSlot(report, "Synth");
+        auto* effectSlot = findSlot(report, "Effect: test");
+        expect(block != nullptr && modulation != nullptr && synth != nullptr && effectSlot != nullptr);
+        if (block == nullptr || modulation == nullptr || synth == nullptr || effectSlot == nullptr) {
+            return;
+        }
+        expect(findSlot(report, "Lua effects") == nullptr, "Untouched stages are left out");
+
+        expectEquals((int) effectSlot->blocks, numBlocks);
+        expectGreaterOrEqual(effectSlot->meanUs, 400.0);
+        expectGreaterOrEqual(modulation->meanUs, 50.0);
+        expectGreaterThan(synth->meanUs, modulation->meanUs);
+        expectGreaterOrEqual(block->meanUs, synth->meanUs + modulation->meanUs);
+
+        for (auto& slot : report.slots) {
+            expectLessOrEqual(slot.p50Us, slot.p99Us);
+            expectLessOrEqual(slot.p99Us, slot.maxUs);
+            juce::uint64 counted = 0;
+            for (auto count : slot.histogram) {
+                counted += count;
+            }
+            expectEquals((int) counted, (int) slot.blocks);
+        }
+        // Bucket edges are within 25% of each other.
+        expectGreaterOrEqual(effectSlot->p50Us, 400.0 / 1.25);
+    }
+
+    void testOverrunBlame() {
+        beginTest("Overruns are blamed on the innermost slow stage");
+
+        AudioThreadProfiler profiler;
+        const int slow = profiler.getSlot("Effect: slow");
+
+        // 48 samples is a 1 ms deadline. The effect takes twice that.
+        for (int i = 0; i < 5; i++) {
+            runBlock(profiler, 48, slow, 20.0, 2000.0, 20.0);
+        }
+        // These fit comfortably.
+        for (int i = 0; i < 5; i++) {
+            runBlock(profiler, 4800, slow, 20.0, 20.0, 20.0);
+        }
+
+        auto report = profiler.getReport();
+        expectEquals((int) report.blocks, 10);
+        expectEquals((int) report.overruns, 5);
+        expectEquals((int) report.recentOverruns.size(), 5);
+
+        for (auto& overrun : report.recentOverruns) {
+            expectEquals(overrun.blamed, juce::String("Effect: slow"));
+            expectGreaterThan(overrun.blockUs, overrun.deadlineUs);
+            expectGreaterOrEqual(overrun.blamedUs, 2000.0);
+        }
+        // Most recent first.
+        expectEquals((int) report.recentOverruns.front().block, 4);
+
+        auto* effect = findSlot(report, "Effect: slow");
+        auto* synth = findSlot(report, "Synth");
+        expect(effect != nullptr && synth != nullptr);
+        if (effect != nullptr && synth != nullptr) {
+            expectEquals((int) effect->overrunsBlamed, 5);
+            expectEquals((int) synth->overrunsBlamed, 0);
+            expectGreaterOrEqual(effect->overrunUs, 5 * 2000.0);
+        }
+    }
+
+    void testDisableAndReset() {
+        beginTest("Disabled blocks aren't recorded and reset clears everything");
+
+        AudioThreadProfiler profiler;
+        const int effect = profiler.getSlot("Effect: test");
+
+        profiler.setEnabled(false);
+        runBlock(profiler, 48, effect, 0.0, 1500.0, 0.0);
+        expectEquals((int) profiler.getReport().blocks, 0);
+
+        profiler.setEnabled(true);
+        runBlock(profiler, 48, effect, 0.0, 1500.0, 0.0);
+        expectEquals((int) profiler.getReport().blocks, 1);
+        expectEquals((int) profiler.getReport().overruns, 1);
+
+        // The reset is applied by the next block, which is then recorded.
+        profiler.reset();
+        runBlock(profiler, 4800, effect, 0.0, 0.0, 0.0);
+        auto report = profiler.getReport();
+        expectEquals((int) report.blocks, 1);
+        expectEquals((int) report.overruns, 0);
+        expect(report.recentOverruns.empty());
+    }
+
+    void testStoppedScope() {
+        beginTest("A stopped scope ends where it was stopped");
+
+        AudioThreadProfiler profiler;
+        OSCI_PROFILE_BEGIN_BLOCK(profiler, (int) kSampleRate, kSampleRate);
+        OSCI_PROFILE_SCOPE_NAMED(synthScope, profiler, AudioThreadProfiler::Synth);
+        spinFor(50.0);
+        OSCI_PROFILE_STOP(synthScope);
+        // Not nested in Synth any more, and stopping twice does nothing.
+        {
+            OSCI_PROFILE_SCOPE(profiler, AudioThreadProfiler::Output);
+            spinFor(2000.0);
+        }
+        OSCI_PROFILE_STOP(synthScope);
+        OSCI_PROFILE_END_BLOCK(profiler);
+
+        auto report = profiler.getReport();
+        auto* synth = findSlot(report, "Synth");
+        auto* output = findSlot(report, "Output");
+        auto* block = findSlot(report, "Block");
+        expect(synth != nullptr && output != nullptr && block != nullptr);
+        if (synth == nullptr || output == nullptr || block == nullptr) {
+            return;
+        }
+        expectEquals((int) synth->blocks, 1);
+        expectGreaterOrEqual(synth->meanUs, 50.0);
+        expectLessThan(synth->meanUs, 2000.0);
+        expectGreaterOrEqual(output->meanUs, 2000.0);
+        expectGreaterOrEqual(block->meanUs, synth->meanUs + output->meanUs);
+    }
+
+    void testJsonExport() {
+        beginTest("JSON export matches the report");
+
+        AudioThreadProfiler profiler;
+        const int slow = profiler.getSlot("Effect: slow");
+        for (int i = 0; i < 20; i++) {
+            runBlock(profiler, i % 4 == 0 ? 48 : 4800, slow, 30.0, i % 4 == 0 ? 1500.0 : 100.0, 10.0);
+        }
+
+        auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("osci-audio-profile.json");
+        expect(file.replaceWithText(profiler.exportJson()));
+        logMessage("Audio profile written to " + file.getFullPathName());
+
+        auto json = juce::JSON::parse(file.loadFileAsString());
+        expectEquals((int) json["blocks"], 20);
+        expectEquals((int) json["overruns"], 5);
+
+        auto* stages = json["stages"].getArray();
+        expect(stages != nullptr);
+        if (stages == nullptr) {
+            return;
+        }
+
+        const auto report = profiler.getReport();
+        expectEquals(stages->size(), (int) report.slots.size());
+        bool foundEffect = false;
+        for (auto& stage : *stages) {
+            expect(stage["histogram"].getArray() != nullptr);
+            expectEquals(stage["histogram"].getArray()->size(), AudioThreadProfiler::kNumBuckets);
+            expectLessOrEqual((double) stage["p50Us"], (double) stage["maxUs"]);
+            if (stage["name"].toString() == "Effect: slow") {
+                foundEffect = true;
+                expectEquals((int) stage["blocks"], 20);
+                expectEquals((int) stage["overrunsBlamed"], 5);
+            }
+        }
+        expect(foundEffect);
+
+        auto* recent = json["recentOverruns"].getArray();
+        expect(recent != nullptr && recent->size() == 5);
+        if (recent != nullptr && !recent->isEmpty()) {
+            expectEquals(recent->getFirst()["blamed"].toString(), juce::String("Effect: slow"));
+        }
+    }
+};
+
+static AudioThreadProfilerTest audioThreadProfilerTest;
+
+#endif
@@ -0,0 +1,377 @@
+#include <JuceHeader.h>
+#include "TestCleanup.h"
+#include "TestBinaryData.h"
+#include "../Source/audio/AffineChain.h"
+#include "../Source/audio/effects/BulgeEffect.h"
+#include "../Source/audio/effects/RotateEffect.h"
+#include "../Source/audio/effects/ScaleEffect.h"
+#include "../Source/audio/effects/SkewEffect.h"
+#include "../Source/audio/effects/SmoothEffect.h"
+#include "../Source/audio/effects/TranslateEffect.h"
+#include "../Source/audio/effects/WobbleEffect.h"
+
+// ============================================================================
+// Affine Chain Tests — runs of adjacent scale, rotate, translate and skew
+// effects fused into one transform give the same output as running each
+// effect per sample, anything non-affine or modulated within the block breaks
+// the run, a voice's clones carry on smoothly when its run breaks up, and a
+// typical ten-effect chain is timed both ways.
+// ============================================================================
+
+class AffineChainBenchmarkTest : public juce::UnitTest {
+public:
+    AffineChainBenchmarkTest() : juce::UnitTest("Affine Chain Benchmark", "Effects") {}
+
+    void runTest() override {
+        testTransform();
+        testMatchesUnfused();
+        testInactiveEffectsDontBreakRuns();
+        testModulationBreaksRuns();
+        testVoiceClonesFollowFusedRuns();
+        benchmarkChain();
+    }
+
+private:
+    static constexpr double kSampleRate = 48000.0;
+    static constexpr int kBlockSize = 512;
+
+    using Chain = std::vector<std::shared_ptr<osci::Effect>>;
+
+    // Rotate, scale, translate | bulge | skew, rotate, translate | smooth | scale | wobble:
+    // two fusable runs of three, a lone affine effect, and three that aren't affine.
+    static Chain buildChain(juce::Random random) {
+        Chain chain = {
+            RotateEffectApp().build(),
+            ScaleEffectApp().build(),
+            TranslateEffectApp().build(),
+            BulgeEffect().build(),
+            SkewEffect().build(),
+            RotateEffectApp().build(),
+            TranslateEffectApp().build(),
+            SmoothEffect().build(),
+            ScaleEffectApp().build(),
+            WobbleEffect().build(),
+        };
+        for (auto& effect : chain) {
+            for (auto* parameter : effect->parameters) {
+                parameter->lfo->setUnnormalisedValueNotifyingHost((int) osci::LfoType::Static);
+                parameter->setValueNotifyingHost(0.2f + 0.6f * random.nextFloat());
+            }
+            effect->prepareToPlay(kSampleRate, kBlockSize);
+        }
+        return chain;
+    }
+
+    static void cleanup(Chain& chain) {
+        for (auto& effect : chain) {
+            testutil::cleanupEffectParams(*effect);
+        }
+    }
+
+    // A spiral in X/Y with a ramp in Z and no colour.
+    static void fillSignal(juce::AudioBuffer<float>& buffer, juce::int64 start) {
+        buffer.clear();
+        for (int i = 0; i < buffer.getNumSamples(); ++i) {
+            const double t = (double) (start + i) / kSampleRate;
+            const double angle = juce::MathConstants<double>::twoPi * 220.0 * t;
+            const double radius = 0.3 + 0.2 * std::sin(juce::MathConstants<double>::twoPi * 3.0 * t);
+            buffer.setSample(0, i, (float) (radius * std::cos(angle)));
+            buffer.setSample(1, i, (float) (radius * std::sin(angle)));
+            buffer.setSample(2, i, (float) std::fmod(t * 5.0, 1.0) - 0.5f);
+        }
+        for (int ch = 3; ch < buffer.getNumChannels(); ++ch) {
+            juce::FloatVectorOperations::fill(buffer.getWritePointer(ch), -1.0f, buffer.getNumSamples());
+        }
+    }
+
+    template <typename IsActive>
+    static void processUnfused(Chain& chain, juce::AudioBuffer<float>& buffer, IsActive&& isActive) {
+        juce::MidiBuffer midi;
+        for (auto& effect : chain) {
+            effect->animateValues(buffer.getNumSamples(), nullptr);
+        }
+        for (auto& effect : chain) {
+            if (isActive(*effect)) {
+                effect->processBlockWithInputs(buffer, midi, nullptr, nullptr, nullptr);
+            }
+        }
+    }
+
+    // The same walk applyToggleableEffectsToBuffer does.
+    template <typename IsActive>
+    static void processFused(AffineChain& affine, Chain& chain, juce::AudioBuffer<float>& buffer, IsActive&& isActive) {
+        juce::MidiBuffer midi;
+        for (auto& effect : chain) {
+            effect->animateValues(buffer.getNumSamples(), nullptr);
+        }
+        affine.prepareBlock(chain, buffer.getNumSamples(), isActive);
+        for (size_t e = 0; e < chain.size(); e++) {
+            if (auto* run = affine.runAt(e)) {
+                run->transform.apply(buffer);
+                e = run->end - 1;
+                continue;
+            }
+            if (isActive(*chain[e])) {
+                chain[e]->processBlockWithInputs(buffer, midi, nullptr, nullptr, nullptr);
+            }
+        }
+    }
+
+    using Clones = std::vector<std::shared_ptr<osci::Effect>>;
+
+    static Clones cloneChain(Chain& chain) {
+        Clones clones;
+        for (auto& effect : chain) {
+            auto clone = std::dynamic_pointer_cast<osci::SimpleEffect>(effect)->cloneWithSharedParameters();
+            clone->prepareToPlay(kSampleRate, kBlockSize);
+            clones.push_back(clone);
+        }
+        return clones;
+    }
+
+    // A voice without fusing: the global effects animate, the voice's clones
+    // process.
+    static void processVoiceUnfused(Chain& chain, Clones& clones, juce::AudioBuffer<float>& buffer) {
+        juce::MidiBuffer midi;
+        for (auto& effect : chain) {
+            effect->animateValues(buffer.getNumSamples(), nullptr);
+        }
+        for (auto& clone : clones) {
+            clone->processBlockWithInputs(buffer, midi, nullptr, nullptr, nullptr);
+        }
+    }
+
+    // The walk applyToggleableEffectsToBuffer does for a voice: runs are
+    // fused from the global effects, and the clones they stand in for are
+    // still animated.
+    static void processVoiceFused(AffineChain& affine, Chain& chain, Clones& clones, juce::AudioBuffer<float>& buffer) {
+        juce::MidiBuffer midi;
+        for (auto& effect : chain) {
+            effect->animateValues(buffer.getNumSamples(), nullptr);
+        }
+        affine.prepareBlock(chain, buffer.getNumSamples(), allActive);
+        for (size_t e = 0; e < chain.size(); e++) {
+            if (auto* run = affine.runAt(e)) {
+                for (size_t r = e; r < run->end; r++) {
+                    clones[r]->animateValues(buffer.getNumSamples(), nullptr);
+                }
+                run->transform.apply(buffer);
+                e = run->end - 1;
+                continue;
+            }
+            clones[e]->processBlockWithInputs(buffer, midi, nullptr, nullptr, nullptr);
+        }
+    }
+
+    static float maxDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b) {
+        float worst = 0.0f;
+        for (int ch = 0; ch < a.getNumChannels(); ++ch) {
+            for (int i = 0; i < a.getNumSamples(); ++i) {
+                worst = juce::jmax(worst, std::abs(a.getSample(ch, i) - b.getSample(ch, i)));
+            }
+        }
+        return worst;
+    }
+
+    // Runs both versions of the chain side by side and returns the largest
+    // difference seen in any block.
+    template <typename IsActive>
+    float compare(Chain& reference, Chain& fused, AffineChain& affine, int numBlocks, IsActive&& isActive) {
+        juce::AudioBuffer<float> expected(6, kBlockSize);
+        juce::AudioBuffer<float> actual(6, kBlockSize);
+        float worst = 0.0f;
+        for (int block = 0; block < numBlocks; ++block) {
+            fillSignal(expected, (juce::int64) block * kBlockSize);
+            actual.makeCopyOf(expected);
+            processUnfused(reference, expected, isActive);
+            processFused(affine, fused, actual, isActive);
+            worst = juce::jmax(worst, maxDifference(expected, actual));
+        }
+        return worst;
+    }
+
+    static bool allActive(osci::Effect&) { return true; }
+
+    void testTransform() {
+        beginTest("Transform maps each channel through its row");
+
+        AffineChain::Transform transform;
+        juce::AudioBuffer<float> buffer(6, 200);
+        fillSignal(buffer, 0);
+        juce::AudioBuffer<float> original(buffer);
+
+        transform.apply(buffer);
+        expectEquals(maxDifference(buffer, original), 0.0f);
+
+        // x' = 2y + 1, y' = -x, z' = x + y + z
+        const float rows[3][4] = { { 0, 2, 0, 1 }, { -1, 0, 0, 0 }, { 1, 1, 1, 0 } };
+        std::memcpy(transform.m, rows, sizeof(rows));
+        transform.apply(buffer);
+        for (int i = 0; i < buffer.getNumSamples(); ++i) {
+            const float x = original.getSample(0, i), y = original.getSample(1, i), z = original.getSample(2, i);
+            expectWithinAbsoluteError(buffer.getSample(0, i), 2 * y + 1, 1e-6f);
+            expectWithinAbsoluteError(buffer.getSample(1, i), -x, 1e-6f);
+            expectWithinAbsoluteError(buffer.getSample(2, i), x + y + z, 1e-6f);
+            expectEquals(buffer.getSample(3, i), -1.0f);
+        }
+
+        // A stereo buffer has no Z, which reads as zero.
+        juce::AudioBuffer<float> stereo(2, 3);
+        stereo.setSample(0, 0, 0.5f);
+        stereo.setSample(1, 0, 0.25f);
+        transform.apply(stereo);
+        expectWithinAbsoluteError(stereo.getSample(0, 0), 1.5f, 1e-6f);
+        expectWithinAbsoluteError(stereo.getSample(1, 0), -0.5f, 1e-6f);
+    }
+
+    void testMatchesUnfused() {
+        beginTest("Fused runs match the effects run one sample at a time");
+
+        auto reference = buildChain(juce::Random(1234));
+        auto fused = buildChain(juce::Random(1234));
+        AffineChain affine;
+
+        const float worst = compare(reference, fused, affine, 50, allActive);
+        expectLessThan(worst, 1e-4f, "Fused chain drifted from the per-sample chain");
+
+        auto* first = affine.runAt(0);
+        auto* second = affine.runAt(4);
+        expect(first != nullptr && first->numFused == 3 && first->end == 3);
+        expect(second != nullptr && second->numFused == 3 && second->end == 7);
+        expect(affine.runAt(8) == nullptr, "A lone affine effect is left alone");
+        for (size_t e : { 1, 2, 3, 5, 6, 7, 9 }) {
+            expect(affine.runAt(e) == nullptr);
+        }
+
+        cleanup(reference);
+        cleanup(fused);
+    }
+
+    void testInactiveEffectsDontBreakRuns() {
+        beginTest("Disabled effects between affine ones don't break the run");
+
+        auto reference = buildChain(juce::Random(99));
+        auto fused = buildChain(juce::Random(99));
+        AffineChain affine;
+
+        // Bulge and smooth switched off leave rotate..translate and scale adjacent.
+        auto isActive = [](osci::Effect& effect) {
+            return effect.getId() != "bulge" && effect.getId() != "smoothing";
+        };
+        const float worst = compare(reference, fused, affine, 20, isActive);
+        expectLessThan(worst, 1e-4f);
+
+        auto* run = affine.runAt(0);
+        expect(run != nullptr && run->numFused == 7 && run->end == 9, "Expected one run of seven up to wobble");
+
+        cleanup(reference);
+        cleanup(fused);
+    }
+
+    void testModulationBreaksRuns() {
+        beginTest("An effect modulated within the block isn't fused");
+
+        auto reference = buildChain(juce::Random(7));
+        auto fused = buildChain(juce::Random(7));
+        for (auto* chain : { &reference, &fused }) {
+            auto* rotateY = (*chain)[5]->parameters[1];
+            rotateY->lfo->setUnnormalisedValueNotifyingHost((int) osci::LfoType::Sine);
+            rotateY->lfoRate->setUnnormalisedValueNotifyingHost(5.0f);
+        }
+        AffineChain affine;
+
+        const float worst = compare(reference, fused, affine, 20, allActive);
+        expectLessThan(worst, 1e-4f);
+
+        expect(affine.runAt(0) != nullptr);
+        // Skew and translate are each left on their own by the rotate between them.
+        expect(affine.runAt(4) == nullptr);
+        expect(affine.runAt(6) == nullptr);
+
+        cleanup(reference);
+        cleanup(fused);
+    }
+
+    void testVoiceClonesFollowFusedRuns() {
+        beginTest("A voice's clones carry on smoothly when its run breaks up");
+
+        auto reference = buildChain(juce::Random(5));
+        auto fused = buildChain(juce::Random(5));
+        auto referenceClones = cloneChain(reference);
+        auto fusedClones = cloneChain(fused);
+        AffineChain affine;
+
+        juce::AudioBuffer<float> expected(6, kBlockSize);
+        juce::AudioBuffer<float> actual(6, kBlockSize);
+        bool fusedBeforeChange = false;
+        bool brokenAfterChange = false;
+        float worst = 0.0f;
+
+        for (int block = 0; block < 60; ++block) {
+            if (block == 30) {
+                // Move the scale and start modulating the rotate in the first
+                // run, so the run stops fusing and the clones take over.
+                for (auto* chain : { &reference, &fused }) {
+                    (*chain)[1]->parameters[0]->setValueNotifyingHost(0.95f);
+                    auto* rotateZ = (*chain)[0]->parameters[2];
+                    rotateZ->lfo->setUnnormalisedValueNotifyingHost((int) osci::LfoType::Sine);
+                    rotateZ->lfoRate->setUnnormalisedValueNotifyingHost(3.0f);
+                }
+            }
+
+            fillSignal(expected, (juce::int64) block * kBlockSize);
+            actual.makeCopyOf(expected);
+            processVoiceUnfused(reference, referenceClones, expected);
+            processVoiceFused(affine, fused, fusedClones, actual);
+            worst = juce::jmax(worst, maxDifference(expected, actual));
+
+            if (block < 30) {
+                fusedBeforeChange |= affine.runAt(0) != nullptr;
+            } else {
+                brokenAfterChange |= affine.runAt(0) == nullptr;
+            }
+        }
+
+        expect(fusedBeforeChange, "The first run should fuse while nothing moves");
+        expect(brokenAfterChange, "Modulating the rotate should break the first run up");
+        expectLessThan(worst, 1e-4f, "The voice jumped when its run broke up");
+
+        referenceClones.clear();
+        fusedClones.clear();
+        cleanup(reference);
+        cleanup(fused);
+    }
+
+    void benchmarkChain() {
+        beginTest("Ten-effect chain, fused and unfused");
+
+        auto reference = buildChain(juce::Random(42));
+        auto fused = buildChain(juce::Random(42));
+        AffineChain affine;
+        juce::AudioBuffer<float> buffer(6, kBlockSize);
+
+        const int numBlocks = 2000;
+        auto time = [&](auto&& process) {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int block = 0; block < numBlocks; ++block) {
+                fillSignal(buffer, (juce::int64) block * kBlockSize);
+                process();
+            }
+            return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0;
+        };
+
+        const double unfusedMs = time([&] { processUnfused(reference, buffer, allActive); });
+        const double fusedMs = time([&] { processFused(affine, fused, buffer, allActive); });
+
+        juce::Logger::outputDebugString(juce::String::formatted(
+            "  Affine chain (%d blocks of %d): unfused %.2f ms, fused %.2f ms, %.2fx",
+            numBlocks, kBlockSize, unfusedMs, fusedMs, unfusedMs / juce::jmax(fusedMs, 1e-9)));
+        expectGreaterThan(unfusedMs, 0.0);
+        expectGreaterThan(fusedMs, 0.0);
+
+        cleanup(reference);
+        cleanup(fused);
+    }
+};
+
+static AffineChainBenchmarkTest affineChainBenchmarkTest;
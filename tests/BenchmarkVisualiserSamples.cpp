@@ -0,0 +1,289 @@
+#include <JuceHeader.h>
+#include "../Source/visualiser/VisualiserSamples.h"
+
+// ============================================================================
+// Visualiser Samples Tests — the sweep and trigger match the per-sample loop
+// the renderer used to run, the interleaved resampler reproduces each channel
+// on its own, nothing reallocates once prepared, and each visualiser mode is
+// timed at typical and high sample rates.
+// ============================================================================
+
+class VisualiserSamplesBenchmarkTest : public juce::UnitTest {
+public:
+    VisualiserSamplesBenchmarkTest() : juce::UnitTest("Visualiser Samples Benchmark", "Visualiser") {}
+
+    void runTest() override {
+        testSweepMatchesLegacy();
+        testGoniometerMatchesLegacy();
+        testResamplerTracksEachChannel();
+        testNoReallocation();
+        benchmarkModes();
+    }
+
+private:
+    // The per-sample sweep loop VisualiserRenderer::runTask used to run.
+    struct LegacySweep {
+        long sampleCount = 0;
+        long lastTriggerPosition = 0;
+        std::vector<float> xSamples;
+        std::vector<float> ySamples;
+
+        void process(const float* y, int numSamples, double sweepIncrement, double triggerValue) {
+            xSamples.clear();
+            ySamples.clear();
+            bool belowTrigger = false;
+
+            for (int i = 0; i < numSamples; ++i) {
+                long samplePosition = sampleCount - lastTriggerPosition;
+                double startPoint = 1.135;
+                float sweep = samplePosition * sweepIncrement * 2 * startPoint - startPoint;
+
+                float value = y[i];
+
+                if (sweep > startPoint && belowTrigger && value >= triggerValue) {
+                    lastTriggerPosition = sampleCount;
+                }
+
+                belowTrigger = value < triggerValue;
+
+                xSamples.push_back(sweep);
+                ySamples.push_back(value);
+
+                sampleCount++;
+            }
+        }
+    };
+
+    static void fillSignal(juce::AudioBuffer<float>& buffer, double sampleRate, juce::int64 start) {
+        for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
+            const double frequency = 110.0 * (ch + 1);
+            auto* data = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); i++) {
+                data[i] = (float) std::sin(juce::MathConstants<double>::twoPi * frequency * (double) (start + i) / sampleRate);
+            }
+        }
+    }
+
+    void testSweepMatchesLegacy() {
+        beginTest("Sweep and trigger match the per-sample loop");
+
+        juce::Random random(0x5eed);
+        const double sampleRate = 48000.0;
+
+        for (double sweepSeconds : { 0.001, 0.0073, 0.02, 0.3 }) {
+            for (double triggerValue : { 0.0, 0.1, -0.37, 0.999 }) {
+                LegacySweep legacy;
+                VisualiserSamples samples;
+                samples.prepare(4096);
+
+                VisualiserSamples::Settings settings;
+                settings.sweep = true;
+                settings.sweepIncrement = 1.0 / (sampleRate * sweepSeconds);
+                settings.triggerValue = triggerValue;
+
+                juce::int64 position = 0;
+                bool matches = true;
+                for (int block = 0; block < 40 && matches; block++) {
+                    const int numSamples = 1 + random.nextInt(4095);
+                    juce::AudioBuffer<float> buffer(2, numSamples);
+                    fillSignal(buffer, sampleRate, position);
+                    // Noise so values land exactly on and around the trigger
+                    for (int i = 0; i < numSamples; i += 1 + random.nextInt(64)) {
+                        buffer.setSample(0, i, random.nextBool() ? (float) triggerValue : random.nextFloat() * 2.0f - 1.0f);
+                    }
+                    position += numSamples;
+
+                    legacy.process(buffer.getReadPointer(0), numSamples, settings.sweepIncrement, settings.triggerValue);
+                    samples.process(buffer.getArrayOfReadPointers(), 2, numSamples, settings);
+
+                    matches = legacy.xSamples == samples.xSamples && legacy.ySamples == samples.ySamples;
+                }
+                expect(matches, "sweep of " + juce::String(sweepSeconds) + "s with trigger " + juce::String(triggerValue) + " diverged");
+            }
+        }
+    }
+
+    void testGoniometerMatchesLegacy() {
+        beginTest("Goniometer matches the two-step rotation");
+
+        const int numSamples = 1024;
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        fillSignal(buffer, 48000.0, 0);
+
+        VisualiserSamples samples;
+        samples.prepare(numSamples);
+        VisualiserSamples::Settings settings;
+        settings.goniometer = true;
+        samples.process(buffer.getArrayOfReadPointers(), 2, numSamples, settings);
+
+        const float xScale = -1.0f / std::sqrt(2.0f);
+        const float yScale = 1.0f / std::sqrt(2.0f);
+        const float rotationAngle = -juce::MathConstants<float>::pi / 4.0f;
+        float maxError = 0.0f;
+        for (int i = 0; i < numSamples; i++) {
+            const float scaledX = buffer.getSample(0, i) * xScale;
+            const float scaledY = buffer.getSample(1, i) * yScale;
+            const float x = scaledX * std::cos(rotationAngle) - scaledY * std::sin(rotationAngle);
+            const float y = scaledX * std::sin(rotationAngle) + scaledY * std::cos(rotationAngle);
+            maxError = juce::jmax(maxError, std::abs(samples.xSamples[i] - x), std::abs(samples.ySamples[i] - y));
+        }
+        expectLessThan(maxError, 1.0e-6f);
+    }
+
+    void testResamplerTracksEachChannel() {
+        beginTest("Interleaved resampler tracks each channel");
+
+        const double sampleRate = 48000.0;
+        const int ratio = VisualiserSamples::kUpsampleRatio;
+        const int numChannels = 6;
+
+        InterleavedLanczosResampler resampler;
+        resampler.prepare(ratio);
+
+        std::vector<std::vector<float>> output(numChannels);
+        juce::int64 position = 0;
+        for (int block = 0; block < 12; block++) {
+            // Odd sizes, and one bigger than the resampler's history
+            const int numSamples = block == 5 ? 3000 : 733;
+            juce::AudioBuffer<float> buffer(numChannels, numSamples);
+            fillSignal(buffer, sampleRate, position);
+            position += numSamples;
+
+            std::vector<float> blockOutput((size_t) (numChannels * numSamples * ratio));
+            float* outputs[numChannels];
+            for (int ch = 0; ch < numChannels; ch++) {
+                outputs[ch] = blockOutput.data() + ch * numSamples * ratio;
+            }
+
+            const int written = resampler.process(buffer.getArrayOfReadPointers(), outputs, numChannels, numSamples, numSamples * ratio);
+            expect(written <= numSamples * ratio);
+            for (int ch = 0; ch < numChannels; ch++) {
+                output[ch].insert(output[ch].end(), outputs[ch], outputs[ch] + written);
+            }
+        }
+
+        // Output frame k is the input at k / ratio, once the filter is full
+        for (int ch = 0; ch < numChannels; ch++) {
+            const double frequency = 110.0 * (ch + 1);
+            float maxError = 0.0f;
+            for (size_t k = (size_t) (InterleavedLanczosResampler::kA * ratio); k < output[ch].size(); k++) {
+                const double expected = std::sin(juce::MathConstants<double>::twoPi * frequency * (double) k / (ratio * sampleRate));
+                maxError = juce::jmax(maxError, (float) std::abs(output[ch][k] - expected));
+            }
+            expectLessThan(maxError, 2.0e-3f, "channel " + juce::String(ch));
+            expectGreaterThan((int) output[ch].size(), (int) ((position - 2 * InterleavedLanczosResampler::kA) * ratio));
+        }
+    }
+
+    static juce::Array<const float*> getDataPointers(const VisualiserSamples& samples) {
+        return {
+            samples.xSamples.data(), samples.ySamples.data(), samples.zSamples.data(),
+            samples.rSamples.data(), samples.gSamples.data(), samples.bSamples.data(),
+            samples.smoothedXSamples.data(), samples.smoothedYSamples.data(), samples.smoothedZSamples.data(),
+            samples.smoothedRSamples.data(), samples.smoothedGSamples.data(), samples.smoothedBSamples.data(),
+        };
+    }
+
+    void testNoReallocation() {
+        beginTest("Prepared buffers aren't reallocated");
+
+        const int maxBlockSize = 3200;
+        VisualiserSamples samples;
+        samples.prepare(maxBlockSize);
+        const auto pointers = getDataPointers(samples);
+
+        juce::AudioBuffer<float> buffer(6, maxBlockSize);
+        fillSignal(buffer, 192000.0, 0);
+
+        for (const auto& mode : getModes()) {
+            for (int numSamples : { 1, 800, maxBlockSize }) {
+                samples.process(buffer.getArrayOfReadPointers(), 6, numSamples, mode.settings);
+            }
+        }
+        expect(getDataPointers(samples) == pointers);
+    }
+
+    struct Mode {
+        juce::String name;
+        VisualiserSamples::Settings settings;
+    };
+
+    static std::vector<Mode> getModes() {
+        std::vector<Mode> modes;
+        for (bool upsampling : { false, true }) {
+            const juce::String suffix = upsampling ? " upsampled" : "";
+            VisualiserSamples::Settings settings;
+            settings.upsampling = upsampling;
+            modes.push_back({ "XY" + suffix, settings });
+
+            auto brightness = settings;
+            brightness.brightness = true;
+            modes.push_back({ "XYZ" + suffix, brightness });
+
+            auto colour = settings;
+            colour.colour = true;
+            modes.push_back({ "XYRGB" + suffix, colour });
+
+            auto goniometer = settings;
+            goniometer.goniometer = true;
+            modes.push_back({ "Goniometer" + suffix, goniometer });
+
+            auto sweep = settings;
+            sweep.sweep = true;
+            sweep.sweepIncrement = 1.0 / (48000.0 * 0.01);
+            modes.push_back({ "Sweep" + suffix, sweep });
+        }
+        return modes;
+    }
+
+    void benchmarkModes() {
+        beginTest("Benchmark: visualiser modes");
+
+        juce::Logger::outputDebugString("\n========== Visualiser Samples Benchmark ==========");
+
+        struct Config {
+            double sampleRate;
+            int blockSize;
+        };
+
+        for (const auto& config : { Config { 48000.0, 800 }, Config { 192000.0, 3200 } }) {
+            const int numBlocks = (int) (10.0 * config.sampleRate / config.blockSize);
+            juce::AudioBuffer<float> buffer(6, config.blockSize);
+            fillSignal(buffer, config.sampleRate, 0);
+
+            juce::Logger::outputDebugString(juce::String::formatted("  %.0f Hz, %d-sample blocks, 10s of audio:",
+                config.sampleRate, config.blockSize));
+
+            for (auto mode : getModes()) {
+                mode.settings.sweepIncrement *= 48000.0 / config.sampleRate;
+
+                VisualiserSamples samples;
+                samples.prepare(config.blockSize);
+
+                auto start = juce::Time::getHighResolutionTicks();
+                for (int block = 0; block < numBlocks; block++) {
+                    samples.process(buffer.getArrayOfReadPointers(), 6, config.blockSize, mode.settings);
+                }
+                auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+                juce::Logger::outputDebugString(juce::String::formatted("    %-22s %8.3f ms  (%.2f us/block)",
+                    mode.name.toRawUTF8(), seconds * 1000.0, seconds * 1.0e6 / numBlocks));
+                expectGreaterThan(seconds, 0.0, mode.name + " should take measurable time");
+            }
+
+            LegacySweep legacy;
+            const double increment = 1.0 / (config.sampleRate * 0.01);
+            auto start = juce::Time::getHighResolutionTicks();
+            for (int block = 0; block < numBlocks; block++) {
+                legacy.process(buffer.getReadPointer(0), config.blockSize, increment, 0.0);
+            }
+            auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            juce::Logger::outputDebugString(juce::String::formatted("    %-22s %8.3f ms  (%.2f us/block)",
+                "Sweep (per-sample loop)", seconds * 1000.0, seconds * 1.0e6 / numBlocks));
+        }
+
+        juce::Logger::outputDebugString("==================================================\n");
+    }
+};
+
+static VisualiserSamplesBenchmarkTest visualiserSamplesBenchmarkTest;
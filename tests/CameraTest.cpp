@@ -0,0 +1,67 @@
+#include <JuceHeader.h>
+#include "../Source/obj/Camera.h"
+
+// ============================================================================
+// Camera Tests — the projection the perspective effect uses per sample
+// matches the frustum maths written out in full, including after the field
+// of view changes back and forth, and camera and world space round trip.
+// ============================================================================
+
+class CameraTest : public juce::UnitTest {
+public:
+    CameraTest() : juce::UnitTest("Camera", "Obj") {}
+
+    void runTest() override {
+        testProjectionMatchesFrustum();
+        testSpacesRoundTrip();
+    }
+
+private:
+    // Projection of p by a camera framing the unit sphere, clamped to the
+    // frustum as Frustum::clipToFrustum does
+    static Vec3 reference(Vec3 p, float fov) {
+        const float tang = std::tan(0.5f * fov);
+        float z = juce::jlimit(0.001f, 100.0f, p.z + 1.0f / std::sin(0.5f * fov));
+        const float limit = std::abs(z * tang);
+        const float x = juce::jlimit(-limit, limit, p.x);
+        const float y = juce::jlimit(-limit, limit, p.y);
+        return Vec3(x / (z * tang), y / (z * tang), 0);
+    }
+
+    void testProjectionMatchesFrustum() {
+        beginTest("Projection matches the frustum as the fov changes");
+
+        Camera camera;
+        juce::Random random(0xca3e);
+        const float fovs[] = { 50.0f, 50.0f, 90.0f, 50.0f, 1.5f, 179.0f };
+
+        for (float fovDegrees : fovs) {
+            const float fov = juce::degreesToRadians(fovDegrees);
+            for (int i = 0; i < 200; i++) {
+                camera.frameUnitSphere(fov);
+                Vec3 p(random.nextFloat() * 4.0f - 2.0f, random.nextFloat() * 4.0f - 2.0f, random.nextFloat() * 4.0f - 2.0f);
+                const Vec3 projected = camera.project(p);
+                const Vec3 expected = reference(p, fov);
+                expectWithinAbsoluteError(projected.x, expected.x, 1e-4f);
+                expectWithinAbsoluteError(projected.y, expected.y, 1e-4f);
+                expectEquals(projected.z, 0.0f);
+            }
+        }
+    }
+
+    void testSpacesRoundTrip() {
+        beginTest("Camera and world space round trip");
+
+        Camera camera;
+        camera.frameUnitSphere(juce::degreesToRadians(50.0f));
+        Vec3 p(0.25f, -0.5f, 0.75f);
+        Vec3 cameraSpace = camera.toCameraSpace(p);
+        const Vec3 world = camera.toWorldSpace(cameraSpace);
+        expectWithinAbsoluteError(world.x, p.x, 1e-6f);
+        expectWithinAbsoluteError(world.y, p.y, 1e-6f);
+        expectWithinAbsoluteError(world.z, p.z, 1e-6f);
+        expectGreaterThan(cameraSpace.z, p.z);
+    }
+};
+
+static CameraTest cameraTest;
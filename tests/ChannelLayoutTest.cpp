@@ -0,0 +1,108 @@
+#include <JuceHeader.h>
+#include "../Source/audio/ChannelLayout.h"
+
+// ============================================================================
+// Channel Layout Tests — the iXML chunk recordings use to say which of
+// X, Y, Z, R, G, B each channel holds survives a round trip through a real
+// WAV file, and files that don't describe their channels this way are left
+// to sosci's signal detection.
+// ============================================================================
+
+class ChannelLayoutTest : public juce::UnitTest {
+public:
+    ChannelLayoutTest() : juce::UnitTest("Channel Layout", "Audio") {}
+
+    void runTest() override {
+        testMask();
+        testIXmlRoundTrip();
+        testWavRoundTrip();
+        testRejectsForeignIXml();
+    }
+
+private:
+    void testMask() {
+        beginTest("Masks lay channels out in XYZRGB order");
+
+        auto layout = ChannelLayout::fromMask(ChannelLayout::kMaskXYRGB);
+        expectEquals(layout.getNumChannels(), 5);
+        expectEquals(layout.getChannel(ChannelLayout::X), 0);
+        expectEquals(layout.getChannel(ChannelLayout::Y), 1);
+        expectEquals(layout.getChannel(ChannelLayout::Z), -1);
+        expectEquals(layout.getChannel(ChannelLayout::R), 2);
+        expectEquals(layout.getChannel(ChannelLayout::B), 4);
+
+        expect(ChannelLayout().isEmpty());
+        expectEquals(ChannelLayout::fromMask(ChannelLayout::kMaskAll).getNumChannels(), 6);
+    }
+
+    void testIXmlRoundTrip() {
+        beginTest("iXML round trip");
+
+        for (int mask : { ChannelLayout::kMaskXY, ChannelLayout::kMaskXYZ, ChannelLayout::kMaskXYRGB, ChannelLayout::kMaskAll }) {
+            auto layout = ChannelLayout::fromMask(mask);
+            auto parsed = ChannelLayout::fromIXml(layout.toIXml());
+            expectEquals(parsed.getNumChannels(), layout.getNumChannels());
+            for (int role = 0; role < ChannelLayout::NumRoles; role++) {
+                expectEquals(parsed.getChannel((ChannelLayout::Role) role), layout.getChannel((ChannelLayout::Role) role));
+            }
+        }
+    }
+
+    void testWavRoundTrip() {
+        beginTest("Layout survives a WAV file");
+
+        const auto layout = ChannelLayout::fromMask(ChannelLayout::kMaskXYRGB);
+        const int numSamples = 256;
+        juce::AudioBuffer<float> buffer(layout.getNumChannels(), numSamples);
+        for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
+            for (int i = 0; i < numSamples; i++) {
+                buffer.setSample(ch, i, 0.1f * (float) (ch + 1));
+            }
+        }
+
+        juce::MemoryBlock data;
+        {
+            juce::WavAudioFormat wavFormat;
+            std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(new juce::MemoryOutputStream(data, false), 48000.0,
+                juce::AudioChannelSet::discreteChannels(layout.getNumChannels()), 24, layout.createWavMetadata(), 0));
+            expect(writer != nullptr);
+            if (writer == nullptr) {
+                return;
+            }
+            expect(writer->writeFromAudioSampleBuffer(buffer, 0, numSamples));
+        }
+
+        juce::WavAudioFormat wavFormat;
+        std::unique_ptr<juce::AudioFormatReader> reader(wavFormat.createReaderFor(new juce::MemoryInputStream(data, false), true));
+        expect(reader != nullptr);
+        if (reader == nullptr) {
+            return;
+        }
+        expectEquals((int) reader->numChannels, 5);
+
+        auto parsed = ChannelLayout::fromMetadata(reader->metadataValues);
+        expectEquals(parsed.getNumChannels(), 5);
+        expectEquals(parsed.getChannel(ChannelLayout::Z), -1);
+        expectEquals(parsed.getChannel(ChannelLayout::G), 3);
+
+        juce::AudioBuffer<float> readBack(5, numSamples);
+        reader->read(&readBack, 0, numSamples, 0, true, true);
+        expectWithinAbsoluteError(readBack.getSample(parsed.getChannel(ChannelLayout::G), 100), 0.4f, 1.0e-4f);
+    }
+
+    void testRejectsForeignIXml() {
+        beginTest("Other iXML isn't mistaken for a layout");
+
+        expect(ChannelLayout::fromIXml("").isEmpty());
+        expect(ChannelLayout::fromIXml("<BWFXML><PROJECT>Take 1</PROJECT></BWFXML>").isEmpty());
+        expect(ChannelLayout::fromIXml("<BWFXML><TRACK_LIST><TRACK><INTERLEAVE_INDEX>1</INTERLEAVE_INDEX><NAME>Boom</NAME></TRACK>"
+                                       "</TRACK_LIST></BWFXML>").isEmpty());
+        expect(ChannelLayout::fromIXml("<BWFXML><TRACK_LIST>"
+                                       "<TRACK><INTERLEAVE_INDEX>1</INTERLEAVE_INDEX><NAME>X</NAME></TRACK>"
+                                       "<TRACK><INTERLEAVE_INDEX>2</INTERLEAVE_INDEX><NAME>X</NAME></TRACK>"
+                                       "</TRACK_LIST></BWFXML>").isEmpty());
+        expect(ChannelLayout::fromMetadata({}).isEmpty());
+    }
+};
+
+static ChannelLayoutTest channelLayoutTest;
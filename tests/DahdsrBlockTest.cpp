@@ -0,0 +1,217 @@
+#include <JuceHeader.h>
+#include "../Source/audio/modulation/DahdsrEnvelope.h"
+
+// ============================================================================
+// DAHDSR Block Tests — DahdsrState::advanceBlock() must produce the same
+// values, stage transitions and end state as calling advance() per sample,
+// across curve shapes, zero-length stages, releases and odd block sizes.
+// ============================================================================
+
+class DahdsrBlockTest : public juce::UnitTest {
+public:
+    DahdsrBlockTest() : juce::UnitTest("DAHDSR Block Rendering", "Envelope") {}
+
+    void runTest() override {
+        testMatchesPerSampleForCurves();
+        testZeroLengthStages();
+        testReleaseMidStage();
+        testNullOutputAdvancesState();
+        testDoneStopsEarly();
+        testRandomisedParams();
+        benchmarkBlockVsPerSample();
+    }
+
+private:
+    static constexpr double kSampleRate = 48000.0;
+    static constexpr double kDt = 1.0 / kSampleRate;
+    static constexpr float kTolerance = 1.0e-5f;
+
+    static DahdsrParams makeParams(double delay, double attack, double hold, double decay, double sustain, double release,
+                                   float attackCurve, float decayCurve, float releaseCurve) {
+        DahdsrParams p;
+        p.delaySeconds = delay;
+        p.attackSeconds = attack;
+        p.holdSeconds = hold;
+        p.decaySeconds = decay;
+        p.sustainLevel = sustain;
+        p.releaseSeconds = release;
+        p.attackCurve = attackCurve;
+        p.decayCurve = decayCurve;
+        p.releaseCurve = releaseCurve;
+        return p;
+    }
+
+    // Runs both paths for heldSamples, then releases and runs releaseSamples
+    // more, comparing every sample in blocks of blockSize.
+    void compare(const DahdsrParams& params, int heldSamples, int releaseSamples, int blockSize) {
+        DahdsrState reference, block;
+        reference.reset(params);
+        block.reset(params);
+
+        std::vector<float> expected, actual(blockSize);
+        std::vector<DahdsrState::Stage> expectedStages, stages(blockSize);
+        float maxError = 0.0f;
+        int stageMismatches = 0;
+
+        auto runPhase = [&](int total) {
+            int done = 0;
+            while (done < total) {
+                const int n = juce::jmin(blockSize, total - done);
+
+                expected.clear();
+                expectedStages.clear();
+                for (int i = 0; i < n; ++i) {
+                    expected.push_back(reference.advance(kDt));
+                    expectedStages.push_back(reference.getStage());
+                    if (reference.getStage() == DahdsrState::Stage::Done)
+                        break;
+                }
+
+                const int rendered = block.advanceBlock(actual.data(), n, kDt, stages.data());
+                expectEquals(rendered, (int) expected.size());
+
+                for (int i = 0; i < juce::jmin(rendered, (int) expected.size()); ++i) {
+                    maxError = juce::jmax(maxError, std::abs(expected[i] - actual[i]));
+                    if (expectedStages[i] != stages[i])
+                        ++stageMismatches;
+                }
+
+                expect(reference.getStage() == block.getStage());
+                expectWithinAbsoluteError(block.getCurrentValue(), reference.getCurrentValue(), kTolerance);
+                expectWithinAbsoluteError(block.getStageElapsed(), reference.getStageElapsed(), 1.0e-12);
+
+                if (reference.getStage() == DahdsrState::Stage::Done)
+                    return;
+                done += n;
+            }
+        };
+
+        runPhase(heldSamples);
+        reference.beginRelease();
+        block.beginRelease();
+        runPhase(releaseSamples);
+
+        expectEquals(stageMismatches, 0);
+        expect(maxError <= kTolerance, "Max error " + juce::String(maxError, 9));
+    }
+
+    void testMatchesPerSampleForCurves() {
+        beginTest("Matches per-sample advance for linear and curved stages");
+
+        const float curves[] = { 0.0f, 0.0005f, 3.0f, -3.0f, 12.0f, -12.0f };
+        for (float curve : curves) {
+            auto params = makeParams(0.01, 0.05, 0.02, 0.1, 0.4, 0.08, curve, -curve, curve * 0.5f);
+            for (int blockSize : { 1, 17, 64, 512, 4096 })
+                compare(params, (int) (0.3 * kSampleRate), (int) (0.2 * kSampleRate), blockSize);
+        }
+    }
+
+    void testZeroLengthStages() {
+        beginTest("Zero-length stages");
+
+        compare(makeParams(0.0, 0.0, 0.0, 0.0, 0.7, 0.0, 2.0f, 2.0f, 2.0f), 1000, 1000, 128);
+        compare(makeParams(0.0, 0.0, 0.0, 0.05, 0.5, 0.05, 0.0f, 4.0f, -4.0f), 4000, 4000, 256);
+        // Durations that are exact multiples of the sample period.
+        compare(makeParams(0.01, 0.01, 0.01, 0.01, 0.25, 0.01, 1.0f, 1.0f, 1.0f), 2400, 960, 480);
+    }
+
+    void testReleaseMidStage() {
+        beginTest("Release starting mid-attack and mid-decay");
+
+        auto params = makeParams(0.0, 0.2, 0.0, 0.3, 0.3, 0.15, 5.0f, -5.0f, 5.0f);
+        compare(params, (int) (0.1 * kSampleRate), (int) (0.3 * kSampleRate), 333);
+        compare(params, (int) (0.35 * kSampleRate), (int) (0.3 * kSampleRate), 333);
+    }
+
+    void testNullOutputAdvancesState() {
+        beginTest("Null output advances to the same state");
+
+        auto params = makeParams(0.005, 0.03, 0.01, 0.07, 0.6, 0.04, 6.0f, -2.0f, 3.0f);
+        DahdsrState reference, block;
+        reference.reset(params);
+        block.reset(params);
+
+        for (int b = 0; b < 40; ++b) {
+            for (int i = 0; i < 250; ++i)
+                reference.advance(kDt);
+            block.advanceBlock(nullptr, 250, kDt);
+
+            expect(reference.getStage() == block.getStage());
+            expectWithinAbsoluteError(block.getCurrentValue(), reference.getCurrentValue(), kTolerance);
+        }
+    }
+
+    void testDoneStopsEarly() {
+        beginTest("Stops on the sample the envelope finishes");
+
+        auto params = makeParams(0.0, 0.001, 0.0, 0.001, 0.5, 0.002, 0.0f, 0.0f, 0.0f);
+        DahdsrState reference, block;
+        reference.reset(params);
+        block.reset(params);
+        reference.beginRelease();
+        block.beginRelease();
+
+        int expected = 0;
+        while (reference.getStage() != DahdsrState::Stage::Done) {
+            reference.advance(kDt);
+            ++expected;
+        }
+
+        std::vector<float> out(1024, -1.0f);
+        expectEquals(block.advanceBlock(out.data(), (int) out.size(), kDt), expected);
+        expect(block.getStage() == DahdsrState::Stage::Done);
+        expectEquals(out[expected - 1], 0.0f);
+        expectEquals(out[expected], -1.0f);
+
+        // Already done: one silent sample, like advance().
+        expectEquals(block.advanceBlock(out.data(), (int) out.size(), kDt), 1);
+        expectEquals(out[0], 0.0f);
+    }
+
+    void testRandomisedParams() {
+        beginTest("Randomised parameters and block sizes");
+
+        juce::Random rng(1234);
+        for (int trial = 0; trial < 50; ++trial) {
+            auto time = [&] { return rng.nextFloat() < 0.2f ? 0.0 : rng.nextDouble() * 0.1; };
+            auto curve = [&] { return (rng.nextFloat() * 2.0f - 1.0f) * 15.0f; };
+            auto params = makeParams(time(), time(), time(), time(), rng.nextDouble(), time(), curve(), curve(), curve());
+            compare(params, rng.nextInt({ 1, 20000 }), rng.nextInt({ 1, 10000 }), rng.nextInt({ 1, 2048 }));
+        }
+    }
+
+    void benchmarkBlockVsPerSample() {
+        beginTest("Benchmark: 32 voices x 5 envelopes, 1 s at 48 kHz");
+
+        constexpr int kVoices = 32 * 5;
+        constexpr int kBlockSize = 512;
+        constexpr int kBlocks = (int) (kSampleRate / kBlockSize);
+        auto params = makeParams(0.0, 0.5, 0.1, 0.5, 0.5, 0.5, 4.0f, -4.0f, 4.0f);
+        std::vector<float> out(kBlockSize);
+
+        std::vector<DahdsrState> states(kVoices);
+        for (auto& s : states) s.reset(params);
+        double start = juce::Time::getMillisecondCounterHiRes();
+        float sink = 0.0f;
+        for (int b = 0; b < kBlocks; ++b)
+            for (auto& s : states)
+                for (int i = 0; i < kBlockSize; ++i)
+                    out[i] = s.advance(kDt);
+        sink += out[0];
+        const double perSampleMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+        for (auto& s : states) s.reset(params);
+        start = juce::Time::getMillisecondCounterHiRes();
+        for (int b = 0; b < kBlocks; ++b)
+            for (auto& s : states)
+                s.advanceBlock(out.data(), kBlockSize, kDt);
+        sink += out[0];
+        const double blockMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+        logMessage("  per-sample: " + juce::String(perSampleMs, 2) + " ms, block: " + juce::String(blockMs, 2)
+                   + " ms (" + juce::String(perSampleMs / juce::jmax(blockMs, 1.0e-3), 1) + "x)" + juce::String(sink > 1.0e9f ? " " : ""));
+        expect(true);
+    }
+};
+
+static DahdsrBlockTest dahdsrBlockTest;
@@ -0,0 +1,185 @@
+#include <JuceHeader.h>
+#include "../Source/parser/fractal/FractalParser.h"
+
+// ============================================================================
+// Fractal Parser Tests — the streaming turtle draws the same path as
+// rewriting the full L-system string and walking it, including grammars with
+// unbalanced brackets, and the line cap falls back to shallower iterations.
+// ============================================================================
+
+class FractalParserTest : public juce::UnitTest {
+public:
+    FractalParserTest() : juce::UnitTest("Fractal Parser", "Parser") {}
+
+    void runTest() override {
+        testMatchesStringExpansion();
+        testLineCap();
+        testMaxLinesRoundTrip();
+    }
+
+private:
+    struct Point { float x, y; };
+
+    static juce::String makeJson(const juce::String& axiom, double angle, const juce::StringPairArray& rules) {
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("axiom", axiom);
+        obj->setProperty("angle", angle);
+        juce::Array<juce::var> rulesArray;
+        for (auto& key : rules.getAllKeys()) {
+            auto* rule = new juce::DynamicObject();
+            rule->setProperty("variable", key);
+            rule->setProperty("replacement", rules[key]);
+            rulesArray.add(juce::var(rule));
+        }
+        obj->setProperty("rules", rulesArray);
+        return juce::JSON::toString(juce::var(obj), false);
+    }
+
+    // Rewrites the whole string and walks it, returning the normalised
+    // midpoint of every line.
+    static std::vector<Point> expandAndWalk(const juce::String& axiom, float angle, const juce::StringPairArray& rules, int iterations) {
+        std::string current = axiom.toStdString();
+        for (int i = 0; i < iterations; i++) {
+            std::string next;
+            for (char ch : current) {
+                auto key = juce::String::charToString(ch);
+                next += rules.containsKey(key) ? rules[key].toStdString() : std::string(1, ch);
+            }
+            current = next;
+        }
+
+        std::vector<Point> starts, directions;
+        float x = 0.0f, y = 0.0f, heading = 90.0f;
+        float minX = 0.0f, maxX = 0.0f, minY = 0.0f, maxY = 0.0f;
+        std::vector<std::array<float, 3>> stack;
+        for (char ch : current) {
+            float rad = heading * (juce::MathConstants<float>::pi / 180.0f);
+            if (ch >= 'A' && ch <= 'Z' && ch != 'X' && ch != 'Y') {
+                starts.push_back({ x, y });
+                directions.push_back({ std::cos(rad), std::sin(rad) });
+                x += std::cos(rad);
+                y += std::sin(rad);
+                minX = juce::jmin(minX, x, starts.back().x); maxX = juce::jmax(maxX, x, starts.back().x);
+                minY = juce::jmin(minY, y, starts.back().y); maxY = juce::jmax(maxY, y, starts.back().y);
+            } else if (ch == 'f') {
+                x += std::cos(rad);
+                y += std::sin(rad);
+            } else if (ch == '+') {
+                heading += angle;
+            } else if (ch == '-') {
+                heading -= angle;
+            } else if (ch == '[') {
+                stack.push_back({ x, y, heading });
+            } else if (ch == ']' && !stack.empty()) {
+                x = stack.back()[0]; y = stack.back()[1]; heading = stack.back()[2];
+                stack.pop_back();
+            }
+        }
+
+        float maxDim = juce::jmax(maxX - minX, maxY - minY);
+        float cx = maxDim < 1e-8f ? 0.0f : (minX + maxX) * 0.5f;
+        float cy = maxDim < 1e-8f ? 0.0f : (minY + maxY) * 0.5f;
+        float scale = maxDim < 1e-8f ? 1.0f : 2.0f / maxDim;
+
+        std::vector<Point> midpoints;
+        for (size_t i = 0; i < starts.size(); i++) {
+            midpoints.push_back({ (starts[i].x + 0.5f * directions[i].x - cx) * scale,
+                                  (starts[i].y + 0.5f * directions[i].y - cy) * scale });
+        }
+        return midpoints;
+    }
+
+    void expectMatches(const juce::String& axiom, float angle, const juce::StringPairArray& rules, int maxIterations) {
+        FractalParser parser(makeJson(axiom, angle, rules));
+
+        for (int iterations = 0; iterations <= maxIterations; iterations++) {
+            parser.setIterations(iterations);
+            auto shapes = parser.draw();
+            expectEquals(parser.getRenderedIterations(), iterations);
+
+            auto expected = expandAndWalk(axiom, angle, rules, iterations);
+            if (expected.empty()) {
+                expect(shapes.empty());
+                continue;
+            }
+            expectEquals((int) shapes.size(), 1);
+            if (shapes.size() != 1) {
+                return;
+            }
+
+            auto& path = *shapes[0];
+            const int numLines = (int) path.length();
+            expectEquals(numLines, (int) expected.size(), axiom + " at iteration " + juce::String(iterations));
+            if (numLines != (int) expected.size()) {
+                return;
+            }
+
+            float maxError = 0.0f;
+            for (int i = 0; i < numLines; i++) {
+                auto point = path.nextVector(((float) i + 0.5f) / (float) numLines);
+                maxError = juce::jmax(maxError, std::abs(point.x - expected[i].x), std::abs(point.y - expected[i].y));
+            }
+            expectLessThan(maxError, 1.0e-3f, axiom + " at iteration " + juce::String(iterations));
+        }
+    }
+
+    void testMatchesStringExpansion() {
+        beginTest("Streaming walk matches string expansion");
+
+        juce::StringPairArray sierpinski;
+        sierpinski.set("F", "F-G+F+G-F");
+        sierpinski.set("G", "GG");
+        expectMatches("F-G-G", 120.0f, sierpinski, 7);
+
+        juce::StringPairArray plant;
+        plant.set("X", "F+[[X]-X]-F[-FX]+X");
+        plant.set("F", "FF");
+        expectMatches("X", 25.0f, plant, 6);
+
+        juce::StringPairArray dragon;
+        dragon.set("X", "X+YF+");
+        dragon.set("Y", "-FX-Y");
+        expectMatches("FX", 90.0f, dragon, 10);
+
+        // Brackets that only balance across symbols can't be stamped
+        juce::StringPairArray unbalanced;
+        unbalanced.set("F", "F[+G");
+        unbalanced.set("G", "]F-");
+        expectMatches("F", 30.0f, unbalanced, 6);
+    }
+
+    void testLineCap() {
+        beginTest("Line cap falls back to a shallower iteration");
+
+        juce::StringPairArray bush;
+        bush.set("F", "F[+F]F[-F]F");
+        FractalParser parser(makeJson("F", 25.0, bush));
+
+        parser.setMaxLines(1000);
+        parser.setIterations(16);
+        auto shapes = parser.draw();
+        // 5^4 = 625 lines fits, 5^5 doesn't
+        expectEquals(parser.getRenderedIterations(), 4);
+        expectEquals((int) shapes[0]->length(), 625);
+
+        parser.setMaxLines(5000);
+        expect(parser.consumeDirty());
+        shapes = parser.draw();
+        expectEquals(parser.getRenderedIterations(), 5);
+        expectEquals((int) shapes[0]->length(), 3125);
+    }
+
+    void testMaxLinesRoundTrip() {
+        beginTest("Line cap is saved with the file");
+
+        FractalParser parser(FractalParser::defaultJson());
+        expectEquals(parser.getMaxLines(), FractalParser::kDefaultMaxLines);
+        expect(!parser.toJson().contains("maxLines"));
+
+        parser.setMaxLines(12345);
+        FractalParser reloaded(parser.toJson());
+        expectEquals(reloaded.getMaxLines(), 12345);
+    }
+};
+
+static FractalParserTest fractalParserTest;
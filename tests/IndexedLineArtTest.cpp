@@ -0,0 +1,365 @@
+#include <JuceHeader.h>
+#include "../Source/parser/gpla/IndexedLineArt.h"
+#include "../Source/parser/gpla/LineArtParser.h"
+
+// ============================================================================
+// Indexed Line Art Tests — the indexed form of binary and JSON GPLA files
+// draws the same frames as the legacy parse, a truncated, corrupt, outdated
+// or mismatched cache file is rebuilt rather than trusted, and both the cache
+// directory and the decoded-frame cache evict the least recently used entry.
+// ============================================================================
+
+class IndexedLineArtTest : public juce::UnitTest {
+public:
+    IndexedLineArtTest() : juce::UnitTest("Indexed Line Art", "Parser") {}
+
+    void runTest() override {
+        testBinaryMatchesLegacyParse();
+        testJsonMatchesLegacyParse();
+        testTruncatedCacheRebuilt();
+        testCorruptCountsRejected();
+        testStaleCacheRebuilt();
+        testCacheDirectoryEviction();
+        testDecodedFrameEviction();
+    }
+
+private:
+    struct Object {
+        double matrix[16];
+        std::vector<std::vector<osci::Point>> strokes;
+    };
+
+    struct Frame {
+        double focalLength;
+        std::vector<Object> objects;
+    };
+
+    // Coordinates are multiples of 1/8 so they survive the JSON text exactly.
+    static std::vector<Frame> makeAnimation(int numFrames, int seed) {
+        juce::Random rng(seed);
+        auto coordinate = [&rng] { return (rng.nextInt(17) - 8) / 8.0; };
+
+        std::vector<Frame> frames;
+        for (int f = 0; f < numFrames; f++) {
+            auto& frame = frames.emplace_back();
+            frame.focalLength = 1.5 + f * 0.125;
+            for (int o = 0; o < 2; o++) {
+                auto& object = frame.objects.emplace_back();
+                const double matrix[16] = { 1, 0, 0, o * 0.25, 0, 1, 0, 0, 0, 0, 1, -4, 0, 0, 0, 1 };
+                std::copy(std::begin(matrix), std::end(matrix), object.matrix);
+                for (int s = 0; s < 5; s++) {
+                    auto& stroke = object.strokes.emplace_back();
+                    const int numVertices = 2 + rng.nextInt(3);
+                    for (int v = 0; v < numVertices; v++) {
+                        stroke.emplace_back(coordinate(), coordinate(), coordinate());
+                    }
+                }
+            }
+        }
+        return frames;
+    }
+
+    static juce::MemoryBlock toBinary(const std::vector<Frame>& frames) {
+        juce::MemoryOutputStream out;
+        auto tag = [&out](const char* name) { out.write(name, 8); };
+
+        tag("GPLA    ");
+        out.writeInt64(1);
+        out.writeInt64(0);
+        out.writeInt64(0);
+        tag("FILE    ");
+        tag("fCount  ");
+        out.writeInt64((juce::int64) frames.size());
+        tag("DONE    ");
+
+        for (auto& frame : frames) {
+            tag("FRAME   ");
+            tag("focalLen");
+            out.writeDouble(frame.focalLength);
+            tag("OBJECTS ");
+            for (auto& object : frame.objects) {
+                tag("OBJECT  ");
+                tag("MATRIX  ");
+                for (double m : object.matrix) {
+                    out.writeDouble(m);
+                }
+                tag("DONE    ");
+                tag("STROKES ");
+                for (auto& stroke : object.strokes) {
+                    tag("STROKE  ");
+                    tag("vertexCt");
+                    out.writeInt64((juce::int64) stroke.size());
+                    tag("VERTICES");
+                    for (auto& point : stroke) {
+                        out.writeDouble(point.x);
+                        out.writeDouble(point.y);
+                        out.writeDouble(point.z);
+                    }
+                    tag("DONE    ");
+                    tag("DONE    ");
+                }
+                tag("DONE    ");
+                tag("DONE    ");
+            }
+            tag("DONE    ");
+        }
+        tag("END GPLA");
+        return out.getMemoryBlock();
+    }
+
+    static juce::String toJson(const std::vector<Frame>& frames) {
+        juce::Array<juce::var> framesVar;
+        for (auto& frame : frames) {
+            juce::Array<juce::var> objectsVar;
+            for (auto& object : frame.objects) {
+                juce::Array<juce::var> strokesVar;
+                for (auto& stroke : object.strokes) {
+                    juce::Array<juce::var> verticesVar;
+                    for (auto& point : stroke) {
+                        auto vertex = new juce::DynamicObject();
+                        vertex->setProperty("x", point.x);
+                        vertex->setProperty("y", point.y);
+                        vertex->setProperty("z", point.z);
+                        verticesVar.add(juce::var(vertex));
+                    }
+                    strokesVar.add(verticesVar);
+                }
+                juce::Array<juce::var> matrixVar;
+                for (double m : object.matrix) {
+                    matrixVar.add(m);
+                }
+                auto objectVar = new juce::DynamicObject();
+                objectVar->setProperty("name", "Line Art");
+                objectVar->setProperty("vertices", strokesVar);
+                objectVar->setProperty("matrix", matrixVar);
+                objectsVar.add(juce::var(objectVar));
+            }
+            auto frameVar = new juce::DynamicObject();
+            frameVar->setProperty("objects", objectsVar);
+            frameVar->setProperty("focalLength", frame.focalLength);
+            framesVar.add(juce::var(frameVar));
+        }
+        auto root = new juce::DynamicObject();
+        root->setProperty("frames", framesVar);
+        return juce::JSON::toString(juce::var(root));
+    }
+
+    struct TempDir {
+        juce::TemporaryFile dir;
+        ~TempDir() { dir.getFile().deleteRecursively(); }
+        juce::File get() const { return dir.getFile(); }
+        juce::Array<juce::File> cacheFiles() const { return get().findChildFiles(juce::File::findFiles, false, "*.gplaidx"); }
+    };
+
+    void expectSameFrames(IndexedLineArt& indexed, const std::vector<std::vector<osci::Line>>& legacy, const juce::String& what) {
+        expectEquals(indexed.getNumFrames(), (int) legacy.size(), what + ": frame count");
+        for (int f = 0; f < juce::jmin(indexed.getNumFrames(), (int) legacy.size()); f++) {
+            auto frame = indexed.getFrame(f);
+            expect(frame != nullptr);
+            if (frame == nullptr) {
+                continue;
+            }
+            expectEquals((int) frame->size(), (int) legacy[(size_t) f].size(), what + ": lines in frame " + juce::String(f));
+            for (size_t i = 0; i < juce::jmin(frame->size(), legacy[(size_t) f].size()); i++) {
+                osci::Line indexedLine = (*frame)[i];
+                osci::Line legacyLine = legacy[(size_t) f][i];
+                for (double t : { 0.0, 1.0 }) {
+                    auto a = indexedLine.nextVector(t);
+                    auto b = legacyLine.nextVector(t);
+                    expectWithinAbsoluteError((double) a.x, (double) b.x, 1e-6);
+                    expectWithinAbsoluteError((double) a.y, (double) b.y, 1e-6);
+                }
+            }
+        }
+    }
+
+    void testBinaryMatchesLegacyParse() {
+        beginTest("Indexed binary GPLA draws the same frames as the legacy parse");
+
+        TempDir temp;
+        auto data = toBinary(makeAnimation(4, 1));
+        auto legacy = LineArtParser::parseBinaryFrames(static_cast<char*>(data.getData()), (int) data.getSize());
+
+        auto indexed = IndexedLineArt::open(data, temp.get());
+        expect(indexed != nullptr);
+        if (indexed != nullptr) {
+            expectSameFrames(*indexed, legacy, "Built");
+        }
+        expectEquals(temp.cacheFiles().size(), 1);
+
+        // Opened again, straight from the cache.
+        indexed = IndexedLineArt::open(data, temp.get());
+        expect(indexed != nullptr);
+        if (indexed != nullptr) {
+            expectSameFrames(*indexed, legacy, "Cached");
+        }
+    }
+
+    void testJsonMatchesLegacyParse() {
+        beginTest("Indexed JSON GPLA draws the same frames as the legacy parse");
+
+        TempDir temp;
+        auto json = toJson(makeAnimation(3, 2));
+        auto legacy = LineArtParser::parseJsonFrames(json);
+
+        juce::MemoryBlock data(json.toRawUTF8(), json.getNumBytesAsUTF8());
+        auto indexed = IndexedLineArt::open(data, temp.get());
+        expect(indexed != nullptr);
+        if (indexed != nullptr) {
+            expectSameFrames(*indexed, legacy, "JSON");
+        }
+    }
+
+    void testTruncatedCacheRebuilt() {
+        beginTest("A truncated cache file is rebuilt");
+
+        TempDir temp;
+        auto data = toBinary(makeAnimation(3, 3));
+        auto legacy = LineArtParser::parseBinaryFrames(static_cast<char*>(data.getData()), (int) data.getSize());
+        expect(IndexedLineArt::open(data, temp.get()) != nullptr);
+
+        auto cacheFile = temp.cacheFiles()[0];
+        const auto fullSize = cacheFile.getSize();
+        for (juce::int64 cut : { fullSize - 4, fullSize / 2, (juce::int64) 12 }) {
+            juce::MemoryBlock contents;
+            expect(cacheFile.loadFileAsData(contents));
+            contents.setSize((size_t) cut);
+            expect(cacheFile.replaceWithData(contents.getData(), contents.getSize()));
+
+            auto indexed = IndexedLineArt::open(data, temp.get());
+            expect(indexed != nullptr);
+            if (indexed != nullptr) {
+                expectSameFrames(*indexed, legacy, "Cut to " + juce::String(cut));
+            }
+            expectEquals(cacheFile.getSize(), fullSize);
+        }
+    }
+
+    void testCorruptCountsRejected() {
+        beginTest("Corrupt counts in a cache file give an empty frame, not an exception");
+
+        TempDir temp;
+        auto data = toBinary(makeAnimation(2, 4));
+        expect(IndexedLineArt::open(data, temp.get()) != nullptr);
+
+        // The first frame starts straight after the 40-byte header: its object
+        // count is 8 bytes in, and the first object's stroke count 128 bytes
+        // into the object, after the frame's 16-byte header.
+        auto cacheFile = temp.cacheFiles()[0];
+        for (size_t offset : { (size_t) 40 + 8, (size_t) 40 + 16 + 128 }) {
+            juce::MemoryBlock contents;
+            expect(IndexedLineArt::open(data, temp.get()) != nullptr);
+            expect(cacheFile.loadFileAsData(contents));
+            const juce::uint32 huge = 0xffffffff;
+            contents.copyFrom(&huge, (int) offset, 4);
+            expect(cacheFile.replaceWithData(contents.getData(), contents.getSize()));
+
+            auto indexed = IndexedLineArt::open(data, temp.get());
+            expect(indexed != nullptr);
+            if (indexed == nullptr) {
+                continue;
+            }
+            std::shared_ptr<const std::vector<osci::Line>> frame;
+            try {
+                frame = indexed->getFrame(0);
+            } catch (const std::exception& e) {
+                expect(false, "Decoding threw " + juce::String(e.what()));
+            }
+            expect(frame != nullptr && frame->empty());
+            expect(indexed->getFrame(1) != nullptr && !indexed->getFrame(1)->empty(), "Other frames still decode");
+            cacheFile.deleteFile();
+        }
+    }
+
+    void testStaleCacheRebuilt() {
+        beginTest("Cache files from another version or source are rebuilt");
+
+        TempDir temp;
+        auto data = toBinary(makeAnimation(2, 5));
+        auto legacy = LineArtParser::parseBinaryFrames(static_cast<char*>(data.getData()), (int) data.getSize());
+        expect(IndexedLineArt::open(data, temp.get()) != nullptr);
+        auto cacheFile = temp.cacheFiles()[0];
+
+        // An older version.
+        juce::MemoryBlock contents;
+        expect(cacheFile.loadFileAsData(contents));
+        const juce::uint32 oldVersion = 1;
+        contents.copyFrom(&oldVersion, 8, 4);
+        expect(cacheFile.replaceWithData(contents.getData(), contents.getSize()));
+        auto indexed = IndexedLineArt::open(data, temp.get());
+        expect(indexed != nullptr);
+        if (indexed != nullptr) {
+            expectSameFrames(*indexed, legacy, "Old version");
+        }
+
+        // Another animation's index under this one's name, as a hash
+        // collision would leave it.
+        TempDir otherDir;
+        auto other = toBinary(makeAnimation(5, 6));
+        expect(IndexedLineArt::open(other, otherDir.get()) != nullptr);
+        expect(otherDir.cacheFiles()[0].copyFileTo(cacheFile));
+        indexed = IndexedLineArt::open(data, temp.get());
+        expect(indexed != nullptr);
+        if (indexed != nullptr) {
+            expectSameFrames(*indexed, legacy, "Other source");
+        }
+    }
+
+    void testCacheDirectoryEviction() {
+        beginTest("The least recently opened cache files are evicted first");
+
+        TempDir temp;
+        std::vector<juce::MemoryBlock> sources;
+        std::vector<juce::File> cacheFiles;
+        for (int i = 0; i < IndexedLineArt::kMaxCacheFiles; i++) {
+            sources.push_back(toBinary(makeAnimation(1, 100 + i)));
+            const auto before = temp.cacheFiles();
+            expect(IndexedLineArt::open(sources.back(), temp.get()) != nullptr);
+            for (auto& file : temp.cacheFiles()) {
+                if (!before.contains(file)) {
+                    cacheFiles.push_back(file);
+                }
+            }
+        }
+        expectEquals((int) cacheFiles.size(), IndexedLineArt::kMaxCacheFiles);
+
+        // Oldest first, then open the oldest again so the next is the least
+        // recently used.
+        const auto now = juce::Time::getCurrentTime();
+        for (size_t i = 0; i < cacheFiles.size(); i++) {
+            expect(cacheFiles[i].setLastModificationTime(now - juce::RelativeTime::minutes(100.0 - (double) i)));
+        }
+        expect(IndexedLineArt::open(sources[0], temp.get()) != nullptr);
+
+        expect(IndexedLineArt::open(toBinary(makeAnimation(1, 99)), temp.get()) != nullptr);
+        expectEquals(temp.cacheFiles().size(), IndexedLineArt::kMaxCacheFiles);
+        expect(cacheFiles[0].existsAsFile(), "A file opened again is kept");
+        expect(!cacheFiles[1].existsAsFile(), "The least recently opened file is evicted");
+        expect(cacheFiles[2].existsAsFile());
+    }
+
+    void testDecodedFrameEviction() {
+        beginTest("The least recently drawn decoded frame is evicted first");
+
+        TempDir temp;
+        auto indexed = IndexedLineArt::open(toBinary(makeAnimation(IndexedLineArt::kDecodedFrameCacheSize + 2, 7)), temp.get());
+        expect(indexed != nullptr);
+        if (indexed == nullptr) {
+            return;
+        }
+
+        auto first = indexed->getFrame(0);
+        auto second = indexed->getFrame(1);
+        for (int f = 2; f < IndexedLineArt::kDecodedFrameCacheSize; f++) {
+            indexed->getFrame(f);
+        }
+        // Drawing frame 0 again makes frame 1 the least recently used.
+        expect(indexed->getFrame(0) == first);
+        indexed->getFrame(IndexedLineArt::kDecodedFrameCacheSize);
+
+        expect(indexed->getFrame(0) == first, "A recently drawn frame stays decoded");
+        expect(indexed->getFrame(1) != second, "The least recently drawn frame is decoded again");
+    }
+};
+
+static IndexedLineArtTest indexedLineArtTest;
@@ -0,0 +1,541 @@
+#include <JuceHeader.h>
+#include "../Source/audio/synth/VoiceManager.h"
+#include "../Source/audio/synth/KeyMap.h"
+#include "../Source/audio/synth/SharedFrameSource.h"
+#include "../Source/audio/synth/SoundRegistry.h"
+#include "../Source/util/VersionedSnapshot.h"
+
+// ============================================================================
+// Key Map Tests — zones pick a file per note and velocity and follow files as
+// they are inserted and removed, each file's frames are taken off its queue
+// once however many voices draw them, voices pick their sound by the rules
+// ShapeVoice uses, and a chord spread across three files has each voice
+// drawing its own file, picked from the published sound registry, until that
+// file is closed.
+// ============================================================================
+
+// One file's sound: just its frames.
+struct TestSound : public juce::SynthesiserSound {
+    SharedFrameSource frames { 16 };
+
+    bool appliesToNote(int) override { return true; }
+    bool appliesToChannel(int) override { return true; }
+};
+using TestRegistry = SoundRegistry<TestSound>;
+
+// The processor's side of the file list: the published registry, the version
+// pinned for the block being rendered, and the sound fileSelect picks.
+struct TestFiles {
+    VersionedSnapshot<TestRegistry> registry;
+    const TestRegistry* pinned = nullptr;
+    const TestRegistry* applied = nullptr;
+    TestSound* selected = nullptr;
+
+    void publish(const std::vector<juce::ReferenceCountedObjectPtr<TestSound>>& sounds, const KeyMap& keyMap) {
+        auto next = std::make_unique<TestRegistry>();
+        next->sounds = sounds;
+        next->keyMap = keyMap;
+        registry.publish(std::move(next));
+    }
+};
+
+// A voice that picks and drops its sound through the same SoundRegistry
+// helpers as ShapeVoice, and draws the first shape of each frame through its
+// own cursor.
+class KeyedVoice : public juce::SynthesiserVoice {
+public:
+    explicit KeyedVoice(TestFiles& files) : files(files) {}
+
+    void onActivated(int midiNote, float velocity) {
+        setSound(TestRegistry::pickSound(files.pinned, midiNote, velocity, files.selected, keyMapped));
+        note = midiNote;
+        playing = true;
+    }
+
+    void dropUnloadedSound(const TestRegistry& loaded, TestSound* fallback) {
+        if (!playing || !loaded.mustDrop(sound, keyMapped)) {
+            return;
+        }
+        keyMapped = false;
+        setSound(fallback);
+    }
+
+    void onStopped() { playing = false; }
+    bool isPlaying() const { return playing; }
+    bool isKeyMapped() const { return keyMapped; }
+    TestSound* getSound() const { return sound; }
+
+    int note = -1;
+    std::vector<double> drawnX;
+
+    bool canPlaySound(juce::SynthesiserSound*) override { return true; }
+    void startNote(int, float, juce::SynthesiserSound*, int) override {}
+    void stopNote(float, bool) override {}
+    void pitchWheelMoved(int) override {}
+    void controllerMoved(int, int) override {}
+
+    void renderNextBlock(juce::AudioSampleBuffer&, int, int) override {
+        if (!playing || frame == nullptr) {
+            return;
+        }
+        drawnX.push_back(frame->shapes[0]->nextVector(0.5).x);
+        sound->frames.next(cursor, frame);
+    }
+
+private:
+    void setSound(TestSound* newSound) {
+        if (newSound != sound) {
+            sound = newSound;
+            frame = nullptr;
+            if (sound != nullptr) {
+                cursor = sound->frames.makeCursor();
+                sound->frames.next(cursor, frame);
+            }
+        }
+    }
+
+    TestFiles& files;
+    TestSound* sound = nullptr;
+    bool keyMapped = false;
+    SharedFrameSource::Cursor cursor;
+    SharedFrameSource::FramePtr frame;
+    bool playing = false;
+};
+
+class KeyedClient : public VoiceManagerClient {
+public:
+    void voiceActivated(ManagedVoice& mv, bool) override {
+        if (auto* v = cast(mv)) v->onActivated(mv.getState().midiNote, mv.getState().velocity);
+    }
+    void voiceDeactivated(ManagedVoice& mv) override {
+        if (auto* v = cast(mv)) v->onStopped();
+    }
+    void voiceKilled(ManagedVoice& mv) override {
+        if (auto* v = cast(mv)) v->onStopped();
+    }
+    bool isVoiceSilent(ManagedVoice& mv) const override {
+        auto* v = cast(mv);
+        return v == nullptr || !v->isPlaying();
+    }
+    double getVoiceFrequency(const ManagedVoice&) const override { return 440.0; }
+    void captureDrawingState(ManagedVoice&) override {}
+    void restoreDrawingState(ManagedVoice&, const ManagedVoice&) override {}
+    double noteToFrequency(int note, int) override { return juce::MidiMessage::getMidiNoteInHertz(note); }
+
+private:
+    static KeyedVoice* cast(const ManagedVoice& mv) {
+        return dynamic_cast<KeyedVoice*>(mv.getJuceVoice());
+    }
+};
+
+class KeyMapTest : public juce::UnitTest {
+public:
+    KeyMapTest() : juce::UnitTest("Key Map", "Synth") {}
+
+    void runTest() override {
+        testZoneLookup();
+        testFollowsFiles();
+        testXmlRoundTrip();
+        testZonesRestoredWithFile();
+        testFramesSharedBetweenCursors();
+        testFreshFrame();
+        testSoundSelection();
+        testChordAcrossFiles();
+        testClosedFileFallsBack();
+    }
+
+private:
+    static KeyZone makeZone(int lowNote, int highNote, int fileIndex, int lowVelocity = 1, int highVelocity = 127) {
+        KeyZone zone;
+        zone.lowNote = lowNote;
+        zone.highNote = highNote;
+        zone.lowVelocity = lowVelocity;
+        zone.highVelocity = highVelocity;
+        zone.fileIndex = fileIndex;
+        return zone;
+    }
+
+    // A one-line frame whose x position identifies it.
+    static void pushFrame(SharedFrameSource& source, double x) {
+        std::vector<std::unique_ptr<osci::Shape>> shapes;
+        shapes.push_back(std::make_unique<osci::Line>(x, -0.5, x, 0.5));
+        source.push(shapes, false);
+    }
+
+    static double frameX(const SharedFrameSource::FramePtr& frame) {
+        return frame->shapes[0]->nextVector(0.5).x;
+    }
+
+    void testZoneLookup() {
+        beginTest("Zones pick a file by note and velocity");
+
+        KeyMap keyMap;
+        expectEquals(keyMap.findFile(60, 1.0f), -1, "No zones leaves every note to fileSelect");
+
+        // Soft and hard layers over the middle octave, and one file below it.
+        keyMap.zones = { makeZone(60, 71, 1, 1, 63), makeZone(60, 71, 2, 64, 127), makeZone(0, 59, 0) };
+        expectEquals(keyMap.findFile(64, 30.0f / 127.0f), 1);
+        expectEquals(keyMap.findFile(64, 100.0f / 127.0f), 2);
+        expectEquals(keyMap.findFile(71, 1.0f), 2);
+        expectEquals(keyMap.findFile(40, 0.5f), 0);
+        expectEquals(keyMap.findFile(72, 0.5f), -1);
+        // A near-silent note still counts as velocity 1.
+        expectEquals(keyMap.findFile(60, 0.0f), 1);
+
+        // Overlapping zones: the first one wins.
+        keyMap.zones.insert(keyMap.zones.begin(), makeZone(64, 64, 3));
+        expectEquals(keyMap.findFile(64, 1.0f), 3);
+        expectEquals(keyMap.findFile(65, 1.0f), 2);
+    }
+
+    void testFollowsFiles() {
+        beginTest("Zones stay on their files as files come and go");
+
+        KeyMap keyMap;
+        keyMap.zones = { makeZone(0, 59, 0), makeZone(60, 71, 1), makeZone(72, 127, 2) };
+
+        keyMap.fileInserted(1);
+        expectEquals(keyMap.findFile(40, 1.0f), 0);
+        expectEquals(keyMap.findFile(64, 1.0f), 2);
+        expectEquals(keyMap.findFile(80, 1.0f), 3);
+
+        // Removing the file a zone plays removes the zone.
+        keyMap.fileRemoved(2);
+        expectEquals((int) keyMap.zones.size(), 2);
+        expectEquals(keyMap.findFile(64, 1.0f), -1);
+        expectEquals(keyMap.findFile(80, 1.0f), 2);
+
+        keyMap.fileRemoved(0);
+        expectEquals(keyMap.findFile(40, 1.0f), -1);
+        expectEquals(keyMap.findFile(80, 1.0f), 1);
+    }
+
+    void testXmlRoundTrip() {
+        beginTest("Zones survive saving and loading");
+
+        KeyMap keyMap;
+        keyMap.zones = { makeZone(36, 47, 0, 1, 90), makeZone(36, 47, 1, 91, 127), makeZone(48, 127, 2) };
+
+        juce::XmlElement xml("project");
+        keyMap.save(&xml);
+
+        KeyMap loaded;
+        loaded.zones = { makeZone(0, 127, 5) };
+        loaded.load(&xml);
+        expect(loaded.zones == keyMap.zones);
+
+        // Projects saved before there were zones load with none.
+        juce::XmlElement oldXml("project");
+        loaded.load(&oldXml);
+        expect(loaded.zones.empty());
+    }
+
+    void testZonesRestoredWithFile() {
+        beginTest("Zones saved with a closed file come back in their places");
+
+        KeyMap keyMap;
+        keyMap.zones = { makeZone(0, 59, 1, 1, 63), makeZone(0, 59, 0), makeZone(60, 71, 1), makeZone(72, 127, 2) };
+        const auto original = keyMap.zones;
+
+        juce::XmlElement settings("fileSettings");
+        keyMap.saveFile(1, &settings);
+        keyMap.fileRemoved(1);
+        expectEquals((int) keyMap.zones.size(), 2);
+
+        keyMap.fileInserted(1);
+        keyMap.restoreFile(1, &settings);
+        expect(keyMap.zones == original, "The soft layer should be first again, ahead of file 0's zone");
+
+        // Reopened somewhere else, the zones follow the file.
+        settings = juce::XmlElement("fileSettings");
+        keyMap.saveFile(2, &settings);
+        keyMap.fileRemoved(2);
+        keyMap.fileInserted(0);
+        keyMap.restoreFile(0, &settings);
+        expectEquals(keyMap.findFile(80, 1.0f), 0);
+        expectEquals(keyMap.findFile(40, 1.0f), 1);
+
+        // Nothing saved, nothing restored.
+        const auto before = keyMap.zones;
+        settings = juce::XmlElement("fileSettings");
+        keyMap.restoreFile(0, &settings);
+        expect(keyMap.zones == before);
+    }
+
+    void testFramesSharedBetweenCursors() {
+        beginTest("Each frame is taken once however many cursors draw it");
+
+        SharedFrameSource source(8);
+        for (int i = 0; i < 4; i++) {
+            pushFrame(source, i * 0.1);
+        }
+
+        auto first = source.makeCursor();
+        auto second = source.makeCursor();
+        SharedFrameSource::FramePtr firstFrame;
+        SharedFrameSource::FramePtr secondFrame;
+
+        for (int i = 0; i < 4; i++) {
+            expect(source.next(first, firstFrame));
+            expect(source.next(second, secondFrame));
+            expect(firstFrame == secondFrame, "Both cursors should be on the same frame");
+            expectWithinAbsoluteError(frameX(firstFrame), i * 0.1, 1e-9);
+        }
+        expectEquals((int) source.getNumFramesTaken(), 4);
+
+        // Nothing left: the cursors keep the frame they have.
+        expect(!source.next(first, firstFrame));
+        expect(firstFrame == secondFrame);
+
+        // A cursor that falls behind catches up on the latest frame rather
+        // than taking one of its own.
+        pushFrame(source, 1.0);
+        pushFrame(source, 2.0);
+        expect(source.next(first, firstFrame));
+        expect(source.next(first, firstFrame));
+        expect(source.next(second, secondFrame));
+        expect(firstFrame == secondFrame);
+        expectEquals((int) source.getNumFramesTaken(), 6);
+    }
+
+    void testFreshFrame() {
+        beginTest("A fresh frame replaces the queue for every cursor");
+
+        SharedFrameSource source(8);
+        pushFrame(source, 0.0);
+        pushFrame(source, 0.1);
+
+        auto first = source.makeCursor();
+        auto second = source.makeCursor();
+        SharedFrameSource::FramePtr firstFrame;
+        SharedFrameSource::FramePtr secondFrame;
+        expect(source.next(first, firstFrame));
+        expect(source.next(second, secondFrame));
+        expect(!source.consumeFresh(first));
+
+        std::vector<std::unique_ptr<osci::Shape>> shapes;
+        shapes.push_back(std::make_unique<osci::Line>(0.9, -0.5, 0.9, 0.5));
+        source.replaceWith(shapes);
+
+        // A cursor made now starts from the fresh frame, so has nothing to catch up on.
+        auto late = source.makeCursor();
+        expect(!source.consumeFresh(late));
+
+        expect(source.consumeFresh(first));
+        expect(!source.consumeFresh(first), "Fresh is reported once per cursor");
+        expect(source.next(first, firstFrame));
+        expectWithinAbsoluteError(frameX(firstFrame), 0.9, 1e-9);
+
+        // The second cursor was level with the stale frame but still gets the
+        // fresh one, not the frame that was queued behind it.
+        expect(source.consumeFresh(second));
+        expect(source.next(second, secondFrame));
+        expect(firstFrame == secondFrame);
+        expectEquals((int) source.getNumFramesTaken(), 2);
+    }
+
+    void testSoundSelection() {
+        beginTest("Voices take their zone's sound, or the selected one");
+
+        auto sounds = makeSounds(3, 1);
+        TestRegistry registry;
+        registry.sounds = sounds;
+        registry.keyMap.zones = { makeZone(60, 71, 1, 1, 63), makeZone(60, 71, 2, 64, 127), makeZone(0, 59, 0) };
+        auto* selected = sounds[2].get();
+
+        bool keyMapped = true;
+        expect(TestRegistry::pickSound(&registry, 64, 30.0f / 127.0f, selected, keyMapped) == sounds[1].get());
+        expect(keyMapped);
+        expect(TestRegistry::pickSound(&registry, 64, 1.0f, selected, keyMapped) == sounds[2].get());
+        expect(keyMapped, "A zone on the selected file still pins the voice to it");
+
+        expect(TestRegistry::pickSound(&registry, 80, 1.0f, selected, keyMapped) == selected);
+        expect(!keyMapped);
+        expect(TestRegistry::pickSound(nullptr, 40, 1.0f, selected, keyMapped) == selected);
+        expect(!keyMapped, "With no registry every note follows fileSelect");
+
+        // A zone whose file isn't in this version plays the selected sound.
+        registry.keyMap.zones.push_back(makeZone(72, 127, 5));
+        expect(TestRegistry::pickSound(&registry, 90, 1.0f, selected, keyMapped) == selected);
+        expect(!keyMapped);
+
+        // Only key-mapped voices on a sound that's gone are moved.
+        TestSound closed;
+        expect(!registry.mustDrop(sounds[0].get(), true));
+        expect(registry.mustDrop(&closed, true));
+        expect(!registry.mustDrop(&closed, false), "Voices following fileSelect are moved by it instead");
+    }
+
+    // Renders a block the way the processor does: pin the published
+    // registry, move voices off files it no longer has, render, then hold the
+    // version the voices now point into.
+    static void renderBlock(TestFiles& files, VoiceManager& vm, juce::MidiBuffer& midi) {
+        VersionedSnapshot<TestRegistry>::Reader reader(files.registry);
+        files.pinned = reader.get();
+        if (files.pinned != files.applied) {
+            files.applied = files.pinned;
+            for (int i = 0; i < vm.getNumVoices(); i++) {
+                if (auto* voice = dynamic_cast<KeyedVoice*>(vm.getVoice(i))) {
+                    voice->dropUnloadedSound(*files.pinned, files.selected);
+                }
+            }
+        }
+
+        juce::AudioSampleBuffer buffer(2, 256);
+        buffer.clear();
+        vm.renderNextBlock(buffer, midi, 0, buffer.getNumSamples());
+        files.registry.hold(reader);
+        midi.clear();
+    }
+
+    static std::vector<juce::ReferenceCountedObjectPtr<TestSound>> makeSounds(int numFiles, int numFrames) {
+        std::vector<juce::ReferenceCountedObjectPtr<TestSound>> sounds;
+        for (int file = 0; file < numFiles; file++) {
+            sounds.push_back(new TestSound());
+            for (int i = 0; i < numFrames; i++) {
+                pushFrame(sounds.back()->frames, file + i * 0.01);
+            }
+        }
+        return sounds;
+    }
+
+    static std::map<int, const KeyedVoice*> playingVoicesByNote(VoiceManager& vm) {
+        std::map<int, const KeyedVoice*> voicesByNote;
+        for (int i = 0; i < vm.getNumVoices(); i++) {
+            auto* voice = dynamic_cast<KeyedVoice*>(vm.getVoice(i));
+            if (voice != nullptr && voice->isPlaying()) {
+                voicesByNote[voice->note] = voice;
+            }
+        }
+        return voicesByNote;
+    }
+
+    void testChordAcrossFiles() {
+        beginTest("A chord plays a different file on each key");
+
+        constexpr int numFiles = 3;
+        constexpr int numFrames = 6;
+        auto sounds = makeSounds(numFiles, numFrames);
+
+        KeyMap keyMap;
+        keyMap.zones = { makeZone(0, 59, 0), makeZone(60, 71, 1), makeZone(72, 127, 2) };
+
+        TestFiles files;
+        files.selected = sounds[0].get();
+        files.publish(sounds, keyMap);
+
+        KeyedClient client;
+        VoiceManager vm;
+        vm.setCurrentPlaybackSampleRate(44100.0);
+        vm.setPolyphony(8);
+        vm.setClient(&client);
+        for (int i = 0; i < 9; i++) {
+            vm.addVoice(new KeyedVoice(files));
+        }
+
+        // Two of the notes share the middle file.
+        const std::vector<int> chord = { 48, 60, 64, 76 };
+        juce::MidiBuffer midi;
+        for (int note : chord) {
+            midi.addEvent(juce::MidiMessage::noteOn(1, note, 0.8f), 0);
+        }
+
+        constexpr int numBlocks = 4;
+        for (int block = 0; block < numBlocks; block++) {
+            renderBlock(files, vm, midi);
+        }
+
+        auto voicesByNote = playingVoicesByNote(vm);
+        expectEquals((int) voicesByNote.size(), (int) chord.size());
+
+        for (int note : chord) {
+            auto* voice = voicesByNote[note];
+            if (voice == nullptr) {
+                continue;
+            }
+            const int file = keyMap.findFile(note, 0.8f);
+            expect(voice->isKeyMapped());
+            expect(voice->getSound() == sounds[(size_t) file].get());
+            expectEquals((int) voice->drawnX.size(), numBlocks);
+            for (int block = 0; block < (int) voice->drawnX.size(); block++) {
+                expectWithinAbsoluteError(voice->drawnX[(size_t) block], file + block * 0.01, 1e-9,
+                                          "Note " + juce::String(note) + " drew the wrong frame");
+            }
+        }
+
+        // The middle file's frames were taken once for both of its notes.
+        expectEquals((int) sounds[1]->frames.getNumFramesTaken(), numBlocks + 1);
+        expectEquals((int) sounds[0]->frames.getNumFramesTaken(), numBlocks + 1);
+
+        // A note outside every zone plays the selected file.
+        keyMap.zones.pop_back();
+        files.publish(sounds, keyMap);
+        midi.addEvent(juce::MidiMessage::noteOn(1, 90, 0.8f), 0);
+        renderBlock(files, vm, midi);
+        auto* unmapped = playingVoicesByNote(vm)[90];
+        expect(unmapped != nullptr);
+        if (unmapped != nullptr) {
+            expect(!unmapped->isKeyMapped());
+            expect(unmapped->getSound() == sounds[0].get());
+        }
+    }
+
+    void testClosedFileFallsBack() {
+        beginTest("Closing a file moves its notes onto the selected file");
+
+        auto sounds = makeSounds(3, 8);
+
+        KeyMap keyMap;
+        keyMap.zones = { makeZone(0, 59, 0), makeZone(60, 71, 1), makeZone(72, 127, 2) };
+
+        TestFiles files;
+        files.selected = sounds[2].get();
+        files.publish(sounds, keyMap);
+
+        KeyedClient client;
+        VoiceManager vm;
+        vm.setCurrentPlaybackSampleRate(44100.0);
+        vm.setPolyphony(8);
+        vm.setClient(&client);
+        for (int i = 0; i < 4; i++) {
+            vm.addVoice(new KeyedVoice(files));
+        }
+
+        juce::MidiBuffer midi;
+        for (int note : { 48, 64, 76 }) {
+            midi.addEvent(juce::MidiMessage::noteOn(1, note, 0.8f), 0);
+        }
+        renderBlock(files, vm, midi);
+
+        // Close the middle file while its note is held. The voice still
+        // points at it until the next block applies the new version, so the
+        // held version has to keep it alive.
+        juce::ReferenceCountedObjectPtr<TestSound> closed = sounds[1];
+        sounds.erase(sounds.begin() + 1);
+        keyMap.fileRemoved(1);
+        files.publish(sounds, keyMap);
+        expectEquals(closed->getReferenceCount(), 2, "The held registry version should still own the closed sound");
+
+        renderBlock(files, vm, midi);
+
+        auto voicesByNote = playingVoicesByNote(vm);
+        expectEquals((int) voicesByNote.size(), 3);
+        for (auto& [note, voice] : voicesByNote) {
+            if (note == 64) {
+                expect(!voice->isKeyMapped(), "The closed file's note should fall back");
+                expect(voice->getSound() == files.selected);
+                expectWithinAbsoluteError(voice->drawnX.back(), 2.0, 0.1, "It should draw the selected file");
+            } else {
+                expect(voice->isKeyMapped(), "Notes on open files keep their file");
+                expect(voice->getSound() == sounds[note < 60 ? 0 : 1].get());
+            }
+        }
+
+        // Nothing points at the closed sound any more, so once the new
+        // version is held the old one can go.
+        files.registry.collect();
+        expectEquals(closed->getReferenceCount(), 1);
+    }
+};
+
+static KeyMapTest keyMapTest;
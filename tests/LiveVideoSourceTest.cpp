@@ -0,0 +1,190 @@
+#include <JuceHeader.h>
+#include "../Source/video/LatestFrameSlot.h"
+#include "../Source/video/FFmpegLiveVideoSource.h"
+
+// ============================================================================
+// Live Video Source Tests — the latest-frame slot hands whole frames from one
+// thread to another without tearing, and an ffmpeg child process streaming
+// its built-in testsrc generator fills the slot with moving greyscale frames,
+// so no camera is needed.
+// ============================================================================
+
+class LiveVideoSourceTest : public juce::UnitTest {
+public:
+    LiveVideoSourceTest() : juce::UnitTest("Live Video Source", "Video") {}
+
+    void runTest() override {
+        testSlotKeepsLatest();
+        testSlotDoesNotTear();
+        testCommand();
+        testStreamsTestSource();
+    }
+
+private:
+    static void publishUniform(LatestFrameSlot& slot, int width, int height, uint8_t value) {
+        auto& frame = slot.getWriteFrame();
+        frame.width = width;
+        frame.height = height;
+        frame.pixels.assign((size_t) (width * height), value);
+        slot.publish();
+    }
+
+    // Finds ffmpeg on the PATH, since the test project doesn't download it.
+    static juce::File findFFmpeg() {
+        auto path = juce::SystemStats::getEnvironmentVariable("PATH", {});
+        for (auto& dir : juce::StringArray::fromTokens(path, ":", {})) {
+            auto candidate = juce::File(dir).getChildFile("ffmpeg");
+            if (candidate.existsAsFile()) {
+                return candidate;
+            }
+        }
+        return {};
+    }
+
+    void testSlotKeepsLatest() {
+        beginTest("Slot hands over only the newest frame");
+
+        LatestFrameSlot slot;
+        expect(!slot.acquireLatest());
+        expect(slot.getReadFrame().pixels.empty());
+
+        publishUniform(slot, 4, 2, 10);
+        expect(slot.acquireLatest());
+        expectEquals(slot.getReadFrame().width, 4);
+        expectEquals(slot.getReadFrame().height, 2);
+        expectEquals((int) slot.getReadFrame().pixels[0], 10);
+        expect(!slot.acquireLatest(), "Nothing new was published");
+
+        // A consumer that falls behind skips straight to the last frame.
+        for (int value : { 20, 30, 40 }) {
+            publishUniform(slot, 4, 2, (uint8_t) value);
+        }
+        expect(slot.acquireLatest());
+        expectEquals((int) slot.getReadFrame().pixels[7], 40);
+        expectEquals((int) slot.getReadFrame().sequence, 4);
+
+        // Frames carry their own size.
+        publishUniform(slot, 3, 3, 50);
+        expect(slot.acquireLatest());
+        expectEquals((int) slot.getReadFrame().pixels.size(), 9);
+    }
+
+    void testSlotDoesNotTear() {
+        beginTest("Frames read while another thread writes are never torn");
+
+        LatestFrameSlot slot;
+        constexpr int width = 64;
+        constexpr int height = 48;
+        constexpr int numFrames = 20000;
+
+        std::atomic<bool> done = false;
+        std::thread producer([&] {
+            for (int i = 1; i <= numFrames; ++i) {
+                publishUniform(slot, width, height, (uint8_t) (i % 256));
+            }
+            done = true;
+        });
+
+        int framesSeen = 0;
+        int tornFrames = 0;
+        bool inOrder = true;
+        juce::uint32 lastSequence = 0;
+        while (true) {
+            // Checked before acquiring, so the last frame is never missed.
+            const bool producerFinished = done;
+            if (!slot.acquireLatest()) {
+                if (producerFinished) {
+                    break;
+                }
+                continue;
+            }
+            const auto& frame = slot.getReadFrame();
+            framesSeen++;
+            inOrder &= frame.sequence > lastSequence;
+            lastSequence = frame.sequence;
+            const uint8_t first = frame.pixels.front();
+            const bool uniform = std::all_of(frame.pixels.begin(), frame.pixels.end(), [first](uint8_t p) { return p == first; });
+            const bool matchesSequence = first == (uint8_t) (frame.sequence % 256);
+            if (!uniform || !matchesSequence) {
+                tornFrames++;
+            }
+        }
+        producer.join();
+
+        expectGreaterThan(framesSeen, 0);
+        expectEquals(tornFrames, 0);
+        expect(inOrder, "Frames went backwards");
+    }
+
+    void testCommand() {
+        beginTest("ffmpeg is asked for raw greyscale frames of the right size");
+
+        juce::File ffmpeg("/usr/bin/ffmpeg");
+
+        auto camera = FFmpegLiveVideoSource::buildCommand(ffmpeg, "/dev/video0", 64, 48);
+        expect(camera.contains("v4l2"));
+        expect(!camera.contains("-re"), "A camera already runs in real time");
+
+        auto generator = FFmpegLiveVideoSource::buildCommand(ffmpeg, "testsrc", 64, 48);
+        expect(generator.contains("lavfi"));
+        expect(generator.contains("-re"));
+
+        for (auto& command : { camera, generator }) {
+            expectEquals(command[0], ffmpeg.getFullPathName());
+            expect(command.contains("scale=64:48"));
+            expectEquals(command[command.indexOf("-pix_fmt") + 1], juce::String("gray"));
+            expectEquals(command[command.indexOf("-f", false, command.indexOf("-i")) + 1], juce::String("rawvideo"));
+            expectEquals(command[command.size() - 1], juce::String("pipe:1"));
+        }
+    }
+
+    void testStreamsTestSource() {
+        beginTest("Streams ffmpeg's testsrc into the slot");
+
+        auto ffmpeg = findFFmpeg();
+        if (!ffmpeg.existsAsFile()) {
+            juce::Logger::outputDebugString("  ffmpeg not found on the PATH, skipping");
+            return;
+        }
+
+        constexpr int width = 64;
+        constexpr int height = 48;
+        LatestFrameSlot slot;
+        FFmpegLiveVideoSource source(ffmpeg, "testsrc=size=160x120:rate=25", slot, width, height);
+        expect(source.start());
+
+        // testsrc's counter and scrolling gradient change every frame.
+        std::vector<uint8_t> firstFrame;
+        bool changed = false;
+        const auto deadline = juce::Time::getMillisecondCounter() + 10000;
+        while (juce::Time::getMillisecondCounter() < deadline && !changed) {
+            if (slot.acquireLatest()) {
+                const auto& frame = slot.getReadFrame();
+                expectEquals(frame.width, width);
+                expectEquals(frame.height, height);
+                expectEquals((int) frame.pixels.size(), width * height);
+                if (firstFrame.empty()) {
+                    firstFrame = frame.pixels;
+                } else {
+                    changed = frame.pixels != firstFrame;
+                }
+            }
+            juce::Thread::sleep(5);
+        }
+
+        expect(!firstFrame.empty(), "No frames arrived from ffmpeg");
+        expect(changed, "The stream never moved");
+        expect(source.isActive());
+        expectGreaterOrEqual(source.getNumFramesRead(), 2);
+
+        if (!firstFrame.empty()) {
+            auto [lowest, highest] = std::minmax_element(firstFrame.begin(), firstFrame.end());
+            expectGreaterThan(*highest - *lowest, 64, "Expected testsrc's pattern, not a flat frame");
+        }
+
+        source.stop();
+        expect(!source.isActive());
+    }
+};
+
+static LiveVideoSourceTest liveVideoSourceTest;
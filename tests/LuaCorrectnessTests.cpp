@@ -41,6 +41,11 @@ public:
         testReturnValues();
         testGlobalVariables();
         testSliderAccess();
+        testChangedGlobalsReachScript();
+        testScriptAssignedGlobalsRestored();
+        testMultipleAssignedGlobalsRestored();
+        testGlobalsWrittenByLoadedCodeRestored();
+        testErrorClearIsEdgeTriggered();
         testMidiVariables();
         testDawTransport();
         testEnvelopeVariables();
@@ -150,6 +155,126 @@ private:
         expectWithinAbsoluteError(result[2], 1.0f, 0.001f);
     }
 
+    void testChangedGlobalsReachScript() {
+        beginTest("Globals are only pushed when changed, but changes still arrive");
+        ErrorCollector errors;
+        LuaParser parser("test.lua", "return {slider_a, bpm, step}", errors.callback());
+        lua_State* L = nullptr;
+        LuaVariables vars;
+        vars.sampleRate = 44100;
+        vars.frequency = 440;
+
+        vars.sliders[0] = 0.25;
+        auto r1 = parser.run(L, vars);
+        auto r2 = parser.run(L, vars);
+        expectWithinAbsoluteError(r2.values[0], 0.25f, 0.001f);
+        expectWithinAbsoluteError(r2.values[2], r1.values[2] + 1.0f, 0.001f);
+
+        vars.sliders[0] = 0.5;
+        vars.bpm = 90.0;
+        auto r3 = parser.run(L, vars);
+        expectWithinAbsoluteError(r3.values[0], 0.5f, 0.001f);
+        expectWithinAbsoluteError(r3.values[1], 90.0f, 0.001f);
+
+        // A second state must get its own copy, not rely on the first's cache.
+        lua_State* L2 = nullptr;
+        auto r4 = parser.run(L2, vars);
+        expectWithinAbsoluteError(r4.values[0], 0.5f, 0.001f);
+        expectWithinAbsoluteError(r4.values[1], 90.0f, 0.001f);
+
+        parser.close(L);
+        parser.close(L2);
+    }
+
+    void testScriptAssignedGlobalsRestored() {
+        beginTest("Globals the script overwrites are restored every sample");
+        ErrorCollector errors;
+        LuaParser parser("test.lua", "local v = slider_a\nslider_a = slider_a + 1\nreturn {v, 0}", errors.callback());
+        lua_State* L = nullptr;
+        LuaVariables vars;
+        vars.sampleRate = 44100;
+        vars.frequency = 440;
+        vars.sliders[0] = 0.25;
+
+        for (int i = 0; i < 3; i++) {
+            auto result = parser.run(L, vars);
+            expectWithinAbsoluteError(result.values[0], 0.25f, 0.001f);
+        }
+        parser.close(L);
+    }
+
+    void testMultipleAssignedGlobalsRestored() {
+        beginTest("Globals overwritten by multiple assignment are restored every sample");
+        ErrorCollector errors;
+        LuaParser parser("test.lua",
+            "local function f() return 5, 6 end\n"
+            "local a, b, c = slider_a, slider_b, slider_c\n"
+            "slider_a, slider_b = slider_b, slider_a\n"
+            "slider_c, t = f()\n"
+            "return {a, b, c}", errors.callback());
+        lua_State* L = nullptr;
+        LuaVariables vars;
+        vars.sampleRate = 44100;
+        vars.frequency = 440;
+        vars.sliders[0] = 0.25;
+        vars.sliders[1] = 0.75;
+        vars.sliders[2] = 0.5;
+
+        for (int i = 0; i < 3; i++) {
+            auto result = parser.run(L, vars);
+            expectEquals(result.count, 3);
+            expectWithinAbsoluteError(result.values[0], 0.25f, 0.001f);
+            expectWithinAbsoluteError(result.values[1], 0.75f, 0.001f);
+            expectWithinAbsoluteError(result.values[2], 0.5f, 0.001f);
+        }
+        parser.close(L);
+    }
+
+    void testGlobalsWrittenByLoadedCodeRestored() {
+        beginTest("Globals written by code built from strings are restored every sample");
+        // None of these scripts spell out an assignment to slider_a or name
+        // the globals table, so only the functions they call give the write away.
+        const char* scripts[] = {
+            "local v = slider_a\nloadstring('slider' .. '_a = 5')()\nreturn {v, 0}",
+            "local v = slider_a\nload('slider' .. '_a = 5')()\nreturn {v, 0}",
+            "local v = slider_a\nrawset(package.loaded['_' .. 'G'], 'slider' .. '_a', 5)\nreturn {v, 0}",
+        };
+        for (auto* script : scripts) {
+            ErrorCollector errors;
+            LuaParser parser("test.lua", script, errors.callback());
+            lua_State* L = nullptr;
+            LuaVariables vars;
+            vars.sampleRate = 44100;
+            vars.frequency = 440;
+            vars.sliders[0] = 0.25;
+
+            for (int i = 0; i < 3; i++) {
+                auto result = parser.run(L, vars);
+                expectEquals(result.count, 2);
+                expectWithinAbsoluteError(result.values[0], 0.25f, 0.001f, script);
+            }
+            expect(!errors.hasErrors(), script);
+            parser.close(L);
+        }
+    }
+
+    void testErrorClearIsEdgeTriggered() {
+        beginTest("Error clearing is only reported once");
+        int clears = 0;
+        LuaParser parser("test.lua", "return {1, 0}", [&](int line, juce::String, juce::String) {
+            if (line == -1)
+                clears++;
+        });
+        lua_State* L = nullptr;
+        auto vars = makeDefaultVars();
+
+        for (int i = 0; i < 100; i++)
+            parser.run(L, vars);
+        parser.resetErrors();
+        expectEquals(clears, 1);
+        parser.close(L);
+    }
+
     void testMidiVariables() {
         beginTest("MIDI context variables");
         LuaVariables vars;
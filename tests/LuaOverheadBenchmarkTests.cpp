@@ -39,14 +39,93 @@ public:
         juce::Logger::outputDebugString("  Sources of overhead:");
         juce::Logger::outputDebugString("    - lastSeenState check + seenStates fallback lookup");
         juce::Logger::outputDebugString("    - setMaximumInstructions (hook setup, no reset)");
-        juce::Logger::outputDebugString("    - usedVarMask-gated global variable setting");
+        juce::Logger::outputDebugString("    - usedVarMask-gated global variable setting (changed values only)");
         juce::Logger::outputDebugString("    - incrementVars (phase calculation)");
         juce::Logger::outputDebugString("    - Error callback infrastructure");
 
         expectGreaterThan(rawResult.callsPerSecond(), 0.0);
+
+        // Block constants: a script reading every slider plus transport and
+        // MIDI context, where only step and phase change from sample to sample.
+        logHeader("Per-sample globals: every used global vs changed values only");
+        juce::String blockScript = "return { step + phase";
+        for (int i = 0; i < NUM_SLIDERS; i++)
+            blockScript << " + " << SLIDER_NAMES[i];
+        blockScript << " + bpm + play_time + midi_note + velocity, 0 }";
+        logSeparator();
+
+        beginTest("Before: push every used global each sample");
+        auto everySample = benchmarkPushEveryGlobal(blockScript, N, warmup);
+        logBenchmark("Push all 32 globals per sample", everySample);
+
+        beginTest("After: LuaParser::run() pushing changed globals only");
+        auto changedOnly = benchmarkLuaParser(blockScript, N, warmup);
+        logBenchmark("LuaParser::run() (changed only)", changedOnly);
+
+        logSeparator();
+        juce::Logger::outputDebugString(juce::String::formatted(
+            "  Saved per sample: %.1f ns (%.1fx)",
+            everySample.perCallNanoseconds() - changedOnly.perCallNanoseconds(),
+            everySample.perCallNanoseconds() / changedOnly.perCallNanoseconds()));
+
+        expectGreaterThan(changedOnly.callsPerSecond(), 0.0);
     }
 
 private:
+    // What run() did before globals were cached per state: set every global
+    // the script reads on every sample, then clear errors.
+    BenchmarkResult benchmarkPushEveryGlobal(const juce::String& script, int iterations, int warmup) {
+        lua_State* L = luaL_newstate();
+        luaL_openlibs(L);
+        luaopen_oscilibrary(L);
+
+        luaL_loadstring(L, script.toUTF8());
+        int funcRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
+        double step = 1, phase = 0;
+        double phaseInc = 2.0 * juce::MathConstants<double>::pi * 440.0 / 44100.0;
+        int errorCallbacks = 0;
+        std::function<void(int, juce::String, juce::String)> errorCallback = [&](int, juce::String, juce::String) { errorCallbacks++; };
+
+        auto runOnce = [&]() {
+            lua_sethook(L, [](lua_State*, lua_Debug*) {}, LUA_MASKCOUNT, 5000000);
+
+            lua_pushnumber(L, step);
+            lua_setglobal(L, "step");
+            lua_pushnumber(L, phase);
+            lua_setglobal(L, "phase");
+            for (int i = 0; i < NUM_SLIDERS; i++) {
+                lua_pushnumber(L, 0.5);
+                lua_setglobal(L, SLIDER_NAMES[i]);
+            }
+            lua_pushnumber(L, 120.0);
+            lua_setglobal(L, "bpm");
+            lua_pushnumber(L, 0.0);
+            lua_setglobal(L, "play_time");
+            lua_pushnumber(L, 60);
+            lua_setglobal(L, "midi_note");
+            lua_pushnumber(L, 1.0);
+            lua_setglobal(L, "velocity");
+
+            lua_rawgeti(L, LUA_REGISTRYINDEX, funcRef);
+            lua_pcall(L, 0, LUA_MULTRET, 0);
+            lua_settop(L, 0);
+            errorCallback(-1, "bench.lua", "");
+
+            step++;
+            phase += phaseInc;
+        };
+
+        for (int i = 0; i < warmup; i++) runOnce();
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < iterations; i++) runOnce();
+        const auto end = juce::Time::getHighResolutionTicks();
+
+        lua_close(L);
+        return {juce::Time::highResolutionTicksToSeconds(end - start), iterations};
+    }
+
     BenchmarkResult benchmarkRawApi(const juce::String& script, int iterations, int warmup) {
         lua_State* L = luaL_newstate();
         luaL_openlibs(L);
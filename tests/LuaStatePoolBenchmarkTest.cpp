@@ -0,0 +1,263 @@
+#include "LuaBenchmarkHelpers.h"
+#include "../Source/lua/LuaStatePool.h"
+
+// ============================================================================
+// Benchmark 6: Note-on latency with 32 Lua voices
+//
+// Compares the first run() of each voice when it builds its own state (open
+// libraries, compile the script) against leasing a pre-warmed state from
+// LuaStatePool, reporting the worst voice and how many voices found no
+// pre-warmed state apart from the mean. Also checks pooled states behave like
+// freshly built ones.
+// ============================================================================
+
+class LuaStatePoolBenchmarkTest : public juce::UnitTest {
+public:
+    LuaStatePoolBenchmarkTest() : juce::UnitTest("Lua State Pool Benchmark", "Lua Benchmark") {}
+
+    void initialise() override {
+        initBenchmarkCallbacks();
+    }
+
+    void runTest() override {
+        testPooledStatesMatchFreshStates();
+        testChunksAreShared();
+        testCompileErrorsStillReported();
+        testPoolGrowsOnDemand();
+        benchmarkNoteOn();
+    }
+
+private:
+    static constexpr int kVoices = 32;
+
+    const juce::String script =
+        "local t = {}\n"
+        "for i = 1, 16 do t[i] = math.sin(i * phase) end\n"
+        "counter = (counter or 0) + 1\n"
+        "return { t[1] * slider_a, t[2] + midi_note / 127, counter }";
+
+    static LuaVariables makeVars(int voice) {
+        LuaVariables vars;
+        vars.sampleRate = 48000;
+        vars.frequency = 220;
+        vars.midiNote = 48 + voice;
+        vars.voiceIndex = voice;
+        vars.sliders[0] = 0.5;
+        return vars;
+    }
+
+    // Waits for the background thread to fill the pool for a script.
+    bool waitForPool(const juce::String& source) {
+        juce::SharedResourcePointer<LuaStatePool> pool;
+        auto chunk = pool->getChunk(source);
+        const auto deadline = juce::Time::getMillisecondCounter() + 5000;
+        while (chunk != nullptr && chunk->getNumReady() < chunk->getTargetReady()) {
+            if (juce::Time::getMillisecondCounter() > deadline)
+                return false;
+            juce::Thread::sleep(1);
+        }
+        return chunk != nullptr;
+    }
+
+    void testPooledStatesMatchFreshStates() {
+        beginTest("Pooled states give the same results as fresh states");
+
+        LuaParser parser("pool.lua", script, [](int, juce::String, juce::String) {});
+        expect(waitForPool(script));
+
+        // Reference: the script run in a state built directly from source.
+        lua_State* ref = luaL_newstate();
+        luaL_openlibs(ref);
+        luaopen_oscilibrary(ref);
+        expectEquals(luaL_loadstring(ref, script.toUTF8()), 0);
+        const int refFunction = luaL_ref(ref, LUA_REGISTRYINDEX);
+
+        std::vector<lua_State*> states(kVoices, nullptr);
+        for (int voice = 0; voice < kVoices; ++voice) {
+            auto vars = makeVars(voice);
+            for (int i = 0; i < 3; ++i) {
+                auto phase = vars.phase;
+                auto result = parser.run(states[voice], vars);
+
+                lua_pushnumber(ref, phase);
+                lua_setglobal(ref, "phase");
+                lua_pushnumber(ref, 0.5);
+                lua_setglobal(ref, "slider_a");
+                lua_pushnumber(ref, 48 + voice);
+                lua_setglobal(ref, "midi_note");
+                lua_pushnil(ref);
+                lua_setglobal(ref, "counter");
+                for (int k = 0; k <= i; ++k) {
+                    lua_rawgeti(ref, LUA_REGISTRYINDEX, refFunction);
+                    lua_pcall(ref, 0, 1, 0);
+                    if (k < i)
+                        lua_pop(ref, 1);
+                }
+
+                expectEquals(result.count, 3);
+                for (int v = 0; v < 3; ++v) {
+                    lua_rawgeti(ref, -1, v + 1);
+                    expectWithinAbsoluteError(result.values[v], (float) lua_tonumber(ref, -1), 1.0e-6f);
+                    lua_pop(ref, 1);
+                }
+                lua_settop(ref, 0);
+            }
+        }
+
+        // Every voice got its own state, so globals don't leak between voices.
+        std::sort(states.begin(), states.end());
+        expect(std::adjacent_find(states.begin(), states.end()) == states.end());
+
+        for (auto*& L : states)
+            parser.close(L);
+        lua_close(ref);
+    }
+
+    void testChunksAreShared() {
+        beginTest("Parsers with the same script share one compiled chunk");
+
+        juce::SharedResourcePointer<LuaStatePool> pool;
+        auto a = pool->getChunk(script);
+        auto b = pool->getChunk(script);
+        auto c = pool->getChunk(script + " ");
+        expect(a != nullptr && a == b);
+        expect(c != nullptr && c != a);
+        expect(pool->getChunk("return {") == nullptr);
+    }
+
+    void testCompileErrorsStillReported() {
+        beginTest("Compile errors are reported and fall back");
+
+        int errorLine = -1;
+        LuaParser parser("broken.lua", "return { x, \n", [&](int line, juce::String, juce::String) {
+            if (line != -1)
+                errorLine = line;
+        });
+
+        lua_State* L = nullptr;
+        auto vars = makeVars(0);
+        auto result = parser.run(L, vars);
+        expectGreaterThan(errorLine, 0);
+        expectEquals(result.count, 2);
+        parser.close(L);
+    }
+
+    void testPoolGrowsOnDemand() {
+        beginTest("Chunks start small and grow to the voices that use them");
+
+        juce::SharedResourcePointer<LuaStatePool> pool;
+        const juce::String source = script + "\n-- grows";
+        auto chunk = pool->getChunk(source);
+        expect(chunk != nullptr);
+        expectEquals(chunk->getTargetReady(), LuaStatePool::kMinReadyStates);
+        expect(waitForPool(source));
+
+        // A chord bigger than the pool: the misses raise the target.
+        const int chord = 6;
+        std::vector<lua_State*> leased;
+        for (int i = 0; i < chord; ++i)
+            leased.push_back(pool->lease(*chunk));
+        // The pool thread may refill between leases, so some might not miss.
+        expectGreaterThan(chunk->getTargetReady(), LuaStatePool::kMinReadyStates);
+        expectLessOrEqual(chunk->getTargetReady(), chord);
+        expect(waitForPool(source));
+        expectEquals(chunk->getNumReady(), chunk->getTargetReady());
+
+        // Growth stops at one state per voice.
+        for (int i = 0; i < 2 * LuaStatePool::kMaxReadyStates; ++i)
+            leased.push_back(pool->lease(*chunk));
+        expectEquals(chunk->getTargetReady(), LuaStatePool::kMaxReadyStates);
+
+        for (auto* L : leased)
+            pool->retire(L);
+    }
+
+    void benchmarkNoteOn() {
+        logHeader("Note-on latency: 32 Lua voices");
+        beginTest("Benchmark: first run() for 32 voices");
+
+        LuaParser parser("bench.lua", script, [](int, juce::String, juce::String) {});
+
+        // Building a state per voice, as voices did before the pool.
+        std::vector<double> coldUs;
+        for (int voice = 0; voice < kVoices; ++voice) {
+            auto vars = makeVars(voice);
+            const auto start = juce::Time::getHighResolutionTicks();
+            lua_State* L = luaL_newstate();
+            luaL_openlibs(L);
+            luaopen_oscilibrary(L);
+            luaL_loadstring(L, script.toUTF8());
+            const int function = luaL_ref(L, LUA_REGISTRYINDEX);
+            lua_pushnumber(L, vars.phase);
+            lua_setglobal(L, "phase");
+            lua_pushnumber(L, vars.sliders[0]);
+            lua_setglobal(L, "slider_a");
+            lua_pushnumber(L, vars.midiNote);
+            lua_setglobal(L, "midi_note");
+            lua_rawgeti(L, LUA_REGISTRYINDEX, function);
+            lua_pcall(L, 0, 1, 0);
+            lua_settop(L, 0);
+            coldUs.push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1e6);
+            lua_close(L);
+        }
+
+        // Play the chord until the pool has learned how many voices use the
+        // script. The pool thread refills while the chord starts, so a single
+        // chord can miss fewer times than it's short.
+        juce::SharedResourcePointer<LuaStatePool> pool;
+        auto chunk = pool->getChunk(script);
+        expect(chunk != nullptr);
+        expectGreaterOrEqual(LuaStatePool::kMaxReadyStates, kVoices);
+        for (int attempt = 0; attempt < 10 && chunk->getTargetReady() < kVoices; ++attempt) {
+            std::vector<lua_State*> warmup(kVoices, nullptr);
+            for (int voice = 0; voice < kVoices; ++voice) {
+                auto vars = makeVars(voice);
+                parser.run(warmup[voice], vars);
+            }
+            for (auto*& L : warmup)
+                parser.close(L);
+            expect(waitForPool(script));
+        }
+        expectGreaterOrEqual(chunk->getTargetReady(), kVoices);
+
+        const int missesBefore = chunk->getNumMisses();
+        std::vector<double> pooledUs;
+        std::vector<lua_State*> states(kVoices, nullptr);
+        for (int voice = 0; voice < kVoices; ++voice) {
+            auto vars = makeVars(voice);
+            const auto start = juce::Time::getHighResolutionTicks();
+            parser.run(states[voice], vars);
+            pooledUs.push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1e6);
+        }
+        const int pooledMisses = chunk->getNumMisses() - missesBefore;
+        for (auto*& L : states)
+            parser.close(L);
+
+        auto summarise = [](const juce::String& label, std::vector<double> us) {
+            std::sort(us.begin(), us.end());
+            double total = 0.0;
+            for (double u : us)
+                total += u;
+            juce::Logger::outputDebugString(juce::String::formatted(
+                "  %-30s  mean %8.1f us  median %8.1f us  [%.3f ms for the chord]",
+                label.toRawUTF8(), total / us.size(), us[us.size() / 2], total / 1000.0));
+            return total;
+        };
+        auto worst = [](const std::vector<double>& us) { return *std::max_element(us.begin(), us.end()); };
+
+        logSeparator();
+        const double coldTotal = summarise("New state per voice", coldUs);
+        const double pooledTotal = summarise("Leased from LuaStatePool", pooledUs);
+        logSeparator();
+        juce::Logger::outputDebugString(juce::String::formatted("  Worst voice, new state:     %8.1f us", worst(coldUs)));
+        juce::Logger::outputDebugString(juce::String::formatted("  Worst voice, leased:        %8.1f us", worst(pooledUs)));
+        juce::Logger::outputDebugString(juce::String::formatted("  Voices built inline:        %d of %d", pooledMisses, kVoices));
+        logSeparator();
+        juce::Logger::outputDebugString(juce::String::formatted("  Speedup: %.1fx", coldTotal / juce::jmax(pooledTotal, 1.0e-3)));
+
+        expectEquals(pooledMisses, 0, "Every voice should lease a pre-warmed state");
+        expectLessThan(pooledTotal, coldTotal);
+    }
+};
+
+static LuaStatePoolBenchmarkTest luaStatePoolBenchmarkTest;
@@ -0,0 +1,169 @@
+#include <JuceHeader.h>
+#include "../Source/obj/ObjectView.h"
+
+// ============================================================================
+// Object View Tests — edges leaving the view are cut at the frustum rather
+// than squashed onto it, and with hidden line removal a solid cube only shows
+// the edges that aren't behind its own faces.
+// ============================================================================
+
+class ObjectViewTest : public juce::UnitTest {
+public:
+    ObjectViewTest() : juce::UnitTest("Object View", "Obj") {}
+
+    void runTest() override {
+        testUnchangedInsideView();
+        testClipsToFrustum();
+        testDropsEdgesBehindCamera();
+        testHidesBackOfCube();
+        testRotatedCube();
+        testSettingsAreCached();
+    }
+
+private:
+    // A cube of side 0.5 centred on the origin, with its faces split into
+    // triangles as WorldObject does
+    static ObjectView makeCube() {
+        std::vector<float> vertices;
+        for (int i = 0; i < 8; i++) {
+            vertices.push_back(i & 1 ? 0.25f : -0.25f);
+            vertices.push_back(i & 2 ? 0.25f : -0.25f);
+            vertices.push_back(i & 4 ? 0.25f : -0.25f);
+        }
+
+        std::vector<osci::Line> edges;
+        for (int a = 0; a < 8; a++) {
+            for (int bit = 1; bit < 8; bit <<= 1) {
+                const int b = a | bit;
+                if (b != a) {
+                    edges.push_back(osci::Line(vertices[a * 3], vertices[a * 3 + 1], vertices[a * 3 + 2], vertices[b * 3], vertices[b * 3 + 1], vertices[b * 3 + 2]));
+                }
+            }
+        }
+
+        const int faces[6][4] = {
+            { 0, 1, 3, 2 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 },
+            { 2, 3, 7, 6 }, { 0, 2, 6, 4 }, { 1, 3, 7, 5 },
+        };
+        std::vector<int> triangles;
+        for (const auto& face : faces) {
+            triangles.insert(triangles.end(), { face[0], face[1], face[2], face[0], face[2], face[3] });
+        }
+
+        return ObjectView(edges, vertices, triangles);
+    }
+
+    static float length(const osci::Line& line) {
+        return std::hypot(line.x2 - line.x1, line.y2 - line.y1, line.z2 - line.z1);
+    }
+
+    static float totalLength(const std::vector<osci::Line>& lines) {
+        float total = 0.0f;
+        for (const auto& line : lines) {
+            total += length(line);
+        }
+        return total;
+    }
+
+    void testUnchangedInsideView() {
+        beginTest("Edges inside the view are unchanged");
+
+        auto cube = makeCube();
+        ObjectView::Settings settings;
+        expectEquals((int) cube.getVisibleEdges(settings).size(), 12);
+        expectWithinAbsoluteError(totalLength(cube.getVisibleEdges(settings)), 6.0f, 1e-5f);
+
+        settings.perspective = 0.0f;
+        expectEquals((int) cube.getVisibleEdges(settings).size(), 12);
+    }
+
+    void testClipsToFrustum() {
+        beginTest("Edges leaving the view are clipped at its edge");
+
+        osci::Line edge(0, 0, 0, 4, 0, 0);
+        ObjectView view({ edge }, {}, {});
+        ObjectView::Settings settings;
+        const auto& visible = view.getVisibleEdges(settings);
+
+        expectEquals((int) visible.size(), 1);
+        if (visible.size() == 1) {
+            // Where the edge leaves the screen, with the camera framing the
+            // unit sphere at a 50 degree field of view
+            const float fov = juce::degreesToRadians(settings.fovDegrees);
+            const float projected = visible[0].x2 * std::sin(0.5f * fov) / std::tan(0.5f * fov);
+            expectWithinAbsoluteError(visible[0].x1, 0.0f, 1e-5f);
+            expectWithinAbsoluteError(projected, 1.0f, 1e-3f);
+            expectLessThan(visible[0].x2, 4.0f);
+        }
+
+        // Flat drawing has no frustum to clip to
+        settings.perspective = 0.0f;
+        expectWithinAbsoluteError(length(view.getVisibleEdges(settings)[0]), 4.0f, 1e-5f);
+    }
+
+    void testDropsEdgesBehindCamera() {
+        beginTest("Edges behind the camera are dropped");
+
+        ObjectView view({ osci::Line(-0.5, 0, -10, 0.5, 0, -10) }, {}, {});
+        ObjectView::Settings settings;
+        expect(view.getVisibleEdges(settings).empty());
+
+        // Moving the camera's view past it brings it back
+        settings.translate(0, 0, 10.5f);
+        expectEquals((int) view.getVisibleEdges(settings).size(), 1);
+    }
+
+    void testHidesBackOfCube() {
+        beginTest("A cube seen face on only shows its front face");
+
+        auto cube = makeCube();
+        ObjectView::Settings settings;
+        settings.hiddenLineRemoval = true;
+        const auto& visible = cube.getVisibleEdges(settings);
+
+        float front = 0.0f;
+        float back = 0.0f;
+        for (const auto& line : visible) {
+            if (line.z1 < -0.2f && line.z2 < -0.2f) {
+                front += length(line);
+            } else if (line.z1 > 0.2f && line.z2 > 0.2f) {
+                back += length(line);
+            }
+        }
+
+        expectWithinAbsoluteError(front, 2.0f, 0.02f);
+        expectEquals(back, 0.0f);
+        // Edges along z are only visible close to the front face, where
+        // they're too foreshortened to tell apart from its corners
+        expectLessThan(totalLength(visible) - front, 0.5f);
+    }
+
+    void testRotatedCube() {
+        beginTest("A turned cube shows the edges of three faces");
+
+        auto cube = makeCube();
+        ObjectView::Settings settings;
+        settings.perspective = 0.0f;
+        settings.rotate(0.1f, 0.25f, 0.0f);
+        settings.hiddenLineRemoval = true;
+
+        // The three edges meeting at the back corner are hidden
+        expectWithinAbsoluteError(totalLength(cube.getVisibleEdges(settings)), 4.5f, 0.1f);
+    }
+
+    void testSettingsAreCached() {
+        beginTest("Visible edges are only recomputed when the view changes");
+
+        auto cube = makeCube();
+        ObjectView::Settings settings;
+        settings.hiddenLineRemoval = true;
+        const auto* first = cube.getVisibleEdges(settings).data();
+        const auto count = cube.getVisibleEdges(settings).size();
+        expect(cube.getVisibleEdges(settings).data() == first);
+
+        settings.hiddenLineRemoval = false;
+        expectGreaterThan(cube.getVisibleEdges(settings).size(), count);
+    }
+};
+
+static ObjectViewTest objectViewTest;
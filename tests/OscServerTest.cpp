@@ -0,0 +1,323 @@
+#include <JuceHeader.h>
+#include "../Source/obj/OscServer.h"
+
+// ============================================================================
+// OSC Server Tests — packets are decoded as the OSC 1.0 spec lays them out,
+// /param messages sent over loopback UDP reach their parameters on the
+// message thread, chunked /frame blobs are reassembled in any order, and the
+// parameter queue drops rather than grows when the message thread is busy.
+// ============================================================================
+
+class OscServerTest : public juce::UnitTest {
+public:
+    OscServerTest() : juce::UnitTest("OSC Server", "OSC") {}
+
+    void initialise() override {
+        juce::MessageManager::getInstance();
+    }
+
+    void runTest() override {
+        testParsePacket();
+        testRejectsMalformedPackets();
+        testParametersOverLoopback();
+        testFramesOverLoopback();
+        testQueueIsBounded();
+    }
+
+private:
+    // Builds OSC messages and bundles
+    class Writer {
+    public:
+        Writer& address(const juce::String& address) {
+            return string(address);
+        }
+
+        Writer& string(const juce::String& string) {
+            writeString(string);
+            return *this;
+        }
+
+        Writer& tags(const juce::String& tags) {
+            writeString("," + tags);
+            return *this;
+        }
+
+        Writer& int32(juce::int32 value) {
+            value = (juce::int32) juce::ByteOrder::swapIfLittleEndian((juce::uint32) value);
+            data.append(&value, 4);
+            return *this;
+        }
+
+        Writer& float32(float value) {
+            juce::int32 bits;
+            std::memcpy(&bits, &value, 4);
+            return int32(bits);
+        }
+
+        Writer& float64(double value) {
+            juce::uint64 bits;
+            std::memcpy(&bits, &value, 8);
+            bits = juce::ByteOrder::swapIfLittleEndian(bits);
+            data.append(&bits, 8);
+            return *this;
+        }
+
+        Writer& blob(const void* bytes, int size) {
+            int32(size);
+            data.append(bytes, (size_t) size);
+            pad();
+            return *this;
+        }
+
+        Writer& element(const juce::MemoryBlock& element) {
+            int32((juce::int32) element.getSize());
+            data.append(element.getData(), element.getSize());
+            return *this;
+        }
+
+        static Writer bundle() {
+            Writer writer;
+            writer.data.append("#bundle\0", 8);
+            writer.int32(0).int32(1);
+            return writer;
+        }
+
+        juce::MemoryBlock data;
+
+    private:
+        void writeString(const juce::String& string) {
+            data.append(string.toRawUTF8(), string.getNumBytesAsUTF8());
+            data.append("\0", 1);
+            pad();
+        }
+
+        void pad() {
+            while (data.getSize() % 4 != 0) {
+                data.append("\0", 1);
+            }
+        }
+    };
+
+    static juce::MemoryBlock paramMessage(const juce::String& id, float value) {
+        return Writer().address("/param/" + id).tags("f").float32(value).data;
+    }
+
+    struct TestListener : OscServer::Listener {
+        void oscParameterReceived(const juce::String& id, float value) override {
+            numParameterChanges++;
+            if (auto it = parameters.find(id); it != parameters.end()) {
+                OscServer::setParameterValue(*it->second, value);
+            }
+        }
+
+        void oscFrameReceived(juce::MemoryBlock& frame) override {
+            const juce::ScopedLock scope(lock);
+            frames.push_back(frame);
+        }
+
+        void oscFramesEnded() override {
+            ended = true;
+        }
+
+        int getNumFrames() {
+            const juce::ScopedLock scope(lock);
+            return (int) frames.size();
+        }
+
+        std::map<juce::String, juce::AudioProcessorParameter*> parameters;
+        int numParameterChanges = 0;
+        juce::CriticalSection lock;
+        std::vector<juce::MemoryBlock> frames;
+        std::atomic<bool> ended = false;
+    };
+
+    static bool pumpUntil(std::function<bool()> condition, int timeoutMs = 2000) {
+        auto start = juce::Time::getMillisecondCounterHiRes();
+        while (juce::Time::getMillisecondCounterHiRes() - start < timeoutMs) {
+            if (condition()) {
+                return true;
+            }
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(10);
+        }
+        return condition();
+    }
+
+    static void send(juce::DatagramSocket& socket, int port, const juce::MemoryBlock& packet) {
+        socket.write("127.0.0.1", port, packet.getData(), (int) packet.getSize());
+    }
+
+    void testParsePacket() {
+        beginTest("Messages and nested bundles are decoded");
+
+        const char blobBytes[] = { 1, 2, 3, 4, 5 };
+        auto message = Writer().address("/test").tags("ifdsbTF")
+            .int32(-7).float32(0.5f).float64(1.25).string("hello").blob(blobBytes, 5)
+            .data;
+
+        auto inner = Writer::bundle().element(paramMessage("a", 1.0f));
+        auto outer = Writer::bundle().element(message).element(inner.data);
+
+        std::vector<OscServer::Message> messages;
+        expect(OscServer::parsePacket((const char*) outer.data.getData(), (int) outer.data.getSize(),
+            [&](const OscServer::Message& m) { messages.push_back(m); }));
+
+        expectEquals((int) messages.size(), 2);
+        if (messages.size() != 2) {
+            return;
+        }
+
+        const auto& args = messages[0].arguments;
+        expectEquals(messages[0].address, juce::String("/test"));
+        expectEquals((int) args.size(), 7);
+        if (args.size() == 7) {
+            expectEquals(args[0].number, -7.0);
+            expectEquals(args[1].number, 0.5);
+            expectEquals(args[2].number, 1.25);
+            expectEquals(args[3].string, juce::String("hello"));
+            expectEquals(args[4].blobSize, 5);
+            expect(std::memcmp(args[4].blob, blobBytes, 5) == 0);
+            expectEquals(args[5].number, 1.0);
+            expectEquals(args[6].number, 0.0);
+        }
+
+        expectEquals(messages[1].address, juce::String("/param/a"));
+    }
+
+    void testRejectsMalformedPackets() {
+        beginTest("Truncated and malformed packets are rejected");
+
+        auto valid = Writer().address("/frame").tags("b").blob("abcdefgh", 8).data;
+        int numMessages = 0;
+        auto count = [&](const OscServer::Message&) { numMessages++; };
+
+        // Cutting it straight after the address leaves a valid message with no arguments
+        for (int size = 9; size < (int) valid.getSize(); size++) {
+            expect(!OscServer::parsePacket((const char*) valid.getData(), size, count), "truncated to " + juce::String(size));
+        }
+        expectEquals(numMessages, 0);
+
+        auto badTag = Writer().address("/x").tags("q").int32(0).data;
+        expect(!OscServer::parsePacket((const char*) badTag.getData(), (int) badTag.getSize(), count));
+
+        auto badBundle = Writer::bundle().int32(1000).data;
+        expect(!OscServer::parsePacket((const char*) badBundle.getData(), (int) badBundle.getSize(), count));
+
+        juce::Random random(0x05c);
+        for (int i = 0; i < 2000; i++) {
+            juce::MemoryBlock noise((size_t) (1 + random.nextInt(200)));
+            random.fillBitsRandomly(noise.getData(), noise.getSize());
+            OscServer::parsePacket((const char*) noise.getData(), (int) noise.getSize(), count);
+        }
+    }
+
+    void testParametersOverLoopback() {
+        beginTest("Parameters are set from loopback packets");
+
+        osci::FloatParameter gain("gain", "gain", 2, 0.5f, 0.0f, 4.0f, 0.001f);
+        osci::IntParameter steps("steps", "steps", 2, 1, 0, 16);
+        osci::BooleanParameter enabled("enabled", "enabled", 2, false, "");
+
+        TestListener listener;
+        listener.parameters = { { "gain", &gain }, { "steps", &steps }, { "enabled", &enabled } };
+
+        OscServer server(listener);
+        expect(server.start(0));
+        const int port = server.getPort();
+        expectGreaterThan(port, 0);
+
+        juce::DatagramSocket sender;
+        send(sender, port, paramMessage("gain", 3.0f));
+        auto bundle = Writer::bundle()
+            .element(Writer().address("/param/steps").tags("i").int32(9).data)
+            .element(Writer().address("/param/enabled").tags("T").data)
+            .element(paramMessage("unknown", 1.0f));
+        send(sender, port, bundle.data);
+
+        expect(pumpUntil([&] { return listener.numParameterChanges == 4; }));
+        expectWithinAbsoluteError(gain.getValueUnnormalised(), 3.0f, 0.001f);
+        expectEquals(steps.getValueUnnormalised(), 9);
+        expect(enabled.getBoolValue());
+
+        server.stop();
+    }
+
+    void testFramesOverLoopback() {
+        beginTest("Chunked frames are reassembled");
+
+        TestListener listener;
+        OscServer server(listener);
+        expect(server.start(0));
+        const int port = server.getPort();
+
+        juce::MemoryBlock frame(5000);
+        juce::Random(0xf4a3).fillBitsRandomly(frame.getData(), frame.getSize());
+        auto* bytes = static_cast<const char*>(frame.getData());
+
+        auto chunk = [&](int frameId, int index, int count) {
+            const int size = (int) frame.getSize() / count;
+            const int start = index * size;
+            const int length = index == count - 1 ? (int) frame.getSize() - start : size;
+            return Writer().address("/frame").tags("iiib").int32(frameId).int32(index).int32(count).blob(bytes + start, length).data;
+        };
+
+        juce::DatagramSocket sender;
+        // Frame 1 never completes; frame 2 arrives out of order with a duplicate
+        send(sender, port, chunk(1, 0, 3));
+        send(sender, port, chunk(2, 2, 3));
+        send(sender, port, chunk(2, 0, 3));
+        send(sender, port, chunk(2, 0, 3));
+        send(sender, port, chunk(2, 1, 3));
+        send(sender, port, Writer().address("/frame").tags("b").blob(bytes, 100).data);
+
+        expect(pumpUntil([&] { return listener.getNumFrames() == 2; }));
+        {
+            const juce::ScopedLock scope(listener.lock);
+            if (listener.frames.size() == 2) {
+                expect(listener.frames[0] == frame);
+                expect(listener.frames[1] == juce::MemoryBlock(bytes, 100));
+            }
+        }
+
+        send(sender, port, Writer().address("/frame/end").tags("").data);
+        expect(pumpUntil([&] { return listener.ended.load(); }));
+        expectEquals(listener.getNumFrames(), 2);
+
+        server.stop();
+    }
+
+    void testQueueIsBounded() {
+        beginTest("Parameter queue drops changes when full");
+
+        TestListener listener;
+        OscServer server(listener);
+        expect(server.start(0));
+
+        // One packet with more changes than the queue holds, sent without
+        // letting the message thread drain it
+        const int numChanges = 2000;
+        auto bundle = Writer::bundle();
+        for (int i = 0; i < numChanges; i++) {
+            bundle.element(paramMessage("p", (float) i));
+        }
+        expectLessThan((int) bundle.data.getSize(), OscServer::kMaxPacketSize);
+
+        juce::DatagramSocket sender;
+        send(sender, server.getPort(), bundle.data);
+
+        const auto start = juce::Time::getMillisecondCounter();
+        while (server.getNumDroppedMessages() == 0 && juce::Time::getMillisecondCounter() - start < 2000) {
+            juce::Thread::sleep(5);
+        }
+        juce::Thread::sleep(50);
+
+        const int queued = OscServer::kQueueSize - 1;
+        expectEquals(server.getNumDroppedMessages(), numChanges - queued);
+        expect(pumpUntil([&] { return listener.numParameterChanges == queued; }));
+        pumpUntil([] { return false; }, 50);
+        expectEquals(listener.numParameterChanges, queued);
+
+        server.stop();
+    }
+};
+
+static OscServerTest oscServerTest;
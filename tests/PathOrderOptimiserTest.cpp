@@ -0,0 +1,184 @@
+#include <JuceHeader.h>
+#include "../Source/parser/PathOrderOptimiser.h"
+
+// ============================================================================
+// Path Order Optimiser Tests — reordering must keep every path exactly once,
+// never make travel worse, respect non-reversible paths, and reverse shapes
+// without changing the curve they trace.
+// ============================================================================
+
+class PathOrderOptimiserTest : public juce::UnitTest {
+public:
+    PathOrderOptimiserTest() : juce::UnitTest("Path Order Optimiser", "Parser") {}
+
+    void runTest() override {
+        testPermutationAndTravel();
+        testReversalFindsObviousOrder();
+        testNonReversiblePaths();
+        testReversedShapes();
+        testShapeRunsStayTogether();
+        benchmarkLargeFrame();
+    }
+
+private:
+    static std::vector<PathOrderOptimiser::Path> randomPaths(juce::Random& rng, int count) {
+        std::vector<PathOrderOptimiser::Path> paths;
+        for (int i = 0; i < count; ++i) {
+            osci::Point start(rng.nextFloat() * 2.0f - 1.0f, rng.nextFloat() * 2.0f - 1.0f, 0.0f);
+            osci::Point end(start.x + rng.nextFloat() * 0.1f, start.y + rng.nextFloat() * 0.1f, 0.0f);
+            paths.push_back({ start, end, true });
+        }
+        return paths;
+    }
+
+    // Travel recomputed independently from the returned order.
+    static double travelOf(const std::vector<PathOrderOptimiser::Path>& paths, const PathOrderOptimiser::Result& result) {
+        const int n = (int) result.order.size();
+        double travel = 0.0;
+        for (int i = 0; i < n; ++i) {
+            auto& a = paths[result.order[i]];
+            auto& b = paths[result.order[(i + 1) % n]];
+            auto& exit = result.reversed[i] ? a.start : a.end;
+            auto& entry = result.reversed[(i + 1) % n] ? b.end : b.start;
+            travel += PathOrderOptimiser::distance(exit, entry);
+        }
+        return travel;
+    }
+
+    void testPermutationAndTravel() {
+        beginTest("Order is a permutation and travel never increases");
+
+        juce::Random rng(42);
+        for (int count : { 0, 1, 2, 3, 10, 200 }) {
+            auto paths = randomPaths(rng, count);
+            auto result = PathOrderOptimiser::optimise(paths, { true, 1000.0 });
+
+            expectEquals((int) result.order.size(), count);
+            std::vector<bool> seen(count, false);
+            for (int index : result.order) {
+                expect(! seen[index]);
+                seen[index] = true;
+            }
+            if (count > 0) {
+                expectEquals(result.order[0], 0);
+                expect(! result.reversed[0]);
+            }
+
+            expectWithinAbsoluteError(result.travelAfter, travelOf(paths, result), 1.0e-6);
+            expect(result.travelAfter <= result.travelBefore + 1.0e-9);
+        }
+    }
+
+    void testReversalFindsObviousOrder() {
+        beginTest("Reversal joins a zig-zag into one continuous run");
+
+        // Horizontal strokes all drawn left to right, stacked vertically. The
+        // best loop draws alternate strokes backwards.
+        std::vector<PathOrderOptimiser::Path> paths;
+        for (int i = 0; i < 8; ++i) {
+            const float y = i * 0.1f;
+            paths.push_back({ osci::Point(0.0f, y, 0.0f), osci::Point(1.0f, y, 0.0f), true });
+        }
+
+        auto forwardOnly = PathOrderOptimiser::optimise(paths, { false, 1000.0 });
+        auto withReversal = PathOrderOptimiser::optimise(paths, { true, 1000.0 });
+
+        for (bool r : forwardOnly.reversed)
+            expect(! r);
+        expect(withReversal.travelAfter < forwardOnly.travelAfter);
+        // Seven 0.1 steps up and about one diagonal back.
+        expect(withReversal.travelAfter < 2.0, "Travel " + juce::String(withReversal.travelAfter));
+    }
+
+    void testNonReversiblePaths() {
+        beginTest("Non-reversible paths are never reversed");
+
+        juce::Random rng(7);
+        auto paths = randomPaths(rng, 100);
+        for (int i = 0; i < (int) paths.size(); i += 3)
+            paths[i].reversible = false;
+
+        auto result = PathOrderOptimiser::optimise(paths, { true, 1000.0 });
+        for (size_t k = 0; k < result.order.size(); ++k) {
+            if (! paths[result.order[k]].reversible)
+                expect(! result.reversed[k]);
+        }
+        expectWithinAbsoluteError(result.travelAfter, travelOf(paths, result), 1.0e-6);
+    }
+
+    void expectSameCurve(osci::Shape& original, osci::Shape& reversed) {
+        for (int i = 0; i <= 10; ++i) {
+            const double t = i / 10.0;
+            auto a = original.nextVector(t);
+            auto b = reversed.nextVector(1.0 - t);
+            expectWithinAbsoluteError(b.x, a.x, 1.0e-4f);
+            expectWithinAbsoluteError(b.y, a.y, 1.0e-4f);
+        }
+    }
+
+    void testReversedShapes() {
+        beginTest("Reversed lines and curves trace the same points backwards");
+
+        osci::Line line(-0.3, 0.2, 0.7, -0.4);
+        osci::QuadraticBezierCurve quadratic(-0.5, -0.5, 0.9, 0.1, 0.2, 0.6);
+        osci::CubicBezierCurve cubic(0.0, 0.0, 0.3, 0.8, -0.6, 0.4, 0.5, -0.2);
+
+        for (osci::Shape* shape : std::initializer_list<osci::Shape*> { &line, &quadratic, &cubic }) {
+            auto reversed = PathOrderOptimiser::reversedShape(*shape);
+            expect(reversed != nullptr);
+            if (reversed != nullptr)
+                expectSameCurve(*shape, *reversed);
+        }
+    }
+
+    void testShapeRunsStayTogether() {
+        beginTest("Connected shapes stay together and joined");
+
+        std::vector<std::unique_ptr<osci::Shape>> shapes;
+        // Two closed squares far apart, then a third next to the first.
+        auto square = [&](double x, double y) {
+            shapes.push_back(std::make_unique<osci::Line>(x, y, x + 0.1, y));
+            shapes.push_back(std::make_unique<osci::Line>(x + 0.1, y, x + 0.1, y + 0.1));
+            shapes.push_back(std::make_unique<osci::Line>(x + 0.1, y + 0.1, x, y + 0.1));
+            shapes.push_back(std::make_unique<osci::Line>(x, y + 0.1, x, y));
+        };
+        square(-0.9, -0.9);
+        square(0.8, 0.8);
+        square(-0.7, -0.9);
+
+        auto result = PathOrderOptimiser::optimiseShapes(shapes, { true, 1000.0 });
+        expectEquals((int) result.order.size(), 3);
+        expectEquals((int) shapes.size(), 12);
+
+        int breaks = 0;
+        for (size_t i = 0; i + 1 < shapes.size(); ++i) {
+            auto end = shapes[i]->nextVector(1.0);
+            auto next = shapes[i + 1]->nextVector(0.0);
+            if (PathOrderOptimiser::distance(end, next) > 1.0e-5)
+                ++breaks;
+        }
+        expectEquals(breaks, 2);
+        expect(result.travelAfter <= result.travelBefore + 1.0e-9);
+    }
+
+    void benchmarkLargeFrame() {
+        beginTest("Benchmark: 5000 random strokes");
+
+        juce::Random rng(99);
+        std::vector<std::vector<osci::Point>> strokes;
+        for (int i = 0; i < 5000; ++i) {
+            osci::Point start(rng.nextFloat() * 2.0f - 1.0f, rng.nextFloat() * 2.0f - 1.0f, 0.0f);
+            strokes.push_back({ start, osci::Point(start.x + 0.01f, start.y + 0.01f, 0.0f) });
+        }
+
+        const double start = juce::Time::getMillisecondCounterHiRes();
+        auto result = PathOrderOptimiser::optimiseStrokes(strokes, { true, 50.0 });
+        const double elapsed = juce::Time::getMillisecondCounterHiRes() - start;
+
+        logMessage("  " + result.describe() + " in " + juce::String(elapsed, 1) + " ms");
+        expectEquals((int) strokes.size(), 5000);
+        expect(result.travelAfter < result.travelBefore);
+    }
+};
+
+static PathOrderOptimiserTest pathOrderOptimiserTest;
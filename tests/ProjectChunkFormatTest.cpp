@@ -0,0 +1,226 @@
+#include <JuceHeader.h>
+#include "../Source/util/ProjectChunkFormat.h"
+
+// ============================================================================
+// Project Chunk Format Tests — round-tripping project XML and file blobs
+// through the binary chunk container, blob deduplication, the external
+// content-addressed store and its pruning, and rejection of legacy/corrupt data.
+// ============================================================================
+
+class ProjectChunkFormatTest : public juce::UnitTest {
+public:
+    ProjectChunkFormatTest() : juce::UnitTest("Project Chunk Format", "Project") {}
+
+    void runTest() override {
+        testEmbeddedRoundTrip();
+        testDuplicateBlobsWrittenOnce();
+        testExternalBlobsReferenced();
+        testMissingExternalBlob();
+        testEmbeddedBlobCopiedToStore();
+        testPruneUnusedBlobs();
+        testLegacyXmlNotDetected();
+        testTruncatedData();
+    }
+
+private:
+    static std::shared_ptr<juce::MemoryBlock> makeBlock(int size, int seed) {
+        auto block = std::make_shared<juce::MemoryBlock>((size_t) size);
+        juce::Random rng(seed);
+        for (int i = 0; i < size; i++) {
+            static_cast<char*>(block->getData())[i] = (char) rng.nextInt(256);
+        }
+        return block;
+    }
+
+    static juce::XmlElement makeProject(const juce::String& hash) {
+        juce::XmlElement xml("project");
+        xml.setAttribute("version", "2.6.0");
+        auto file = xml.createNewChildElement("files")->createNewChildElement("file");
+        file->setAttribute("name", "cube.obj");
+        file->setAttribute("blob", hash);
+        return xml;
+    }
+
+    struct TempStore {
+        juce::TemporaryFile dir;
+        ProjectBlobStore store { dir.getFile() };
+        ~TempStore() { dir.getFile().deleteRecursively(); }
+    };
+
+    void testEmbeddedRoundTrip() {
+        beginTest("Embedded blobs round-trip with the project XML");
+
+        TempStore temp;
+        auto block = makeBlock(100000, 1);
+
+        ProjectChunkFormat::Writer writer(temp.store, true);
+        auto hash = writer.addBlob(block);
+        expect(ProjectBlobStore::isValidHash(hash));
+
+        juce::MemoryBlock data;
+        writer.write(makeProject(hash), data);
+        expect(ProjectChunkFormat::isChunkedProject(data.getData(), data.getSize()));
+        expect(!temp.store.contains(hash), "Embedded blobs should not be written to the store");
+
+        ProjectChunkFormat::Reader reader(data.getData(), data.getSize());
+        expect(reader.isValid());
+        expectEquals((int) reader.getVersion(), (int) ProjectChunkFormat::currentVersion);
+
+        auto xml = reader.readXml();
+        expect(xml != nullptr && xml->hasTagName("project"));
+        auto fileXml = xml->getChildByName("files")->getChildByName("file");
+        expectEquals(fileXml->getStringAttribute("name"), juce::String("cube.obj"));
+        expectEquals(fileXml->getStringAttribute("blob"), hash);
+
+        ProjectBlobStore otherStore(temp.dir.getFile().getSiblingFile("unused"));
+        auto loaded = reader.getBlob(hash, otherStore);
+        expect(loaded != nullptr && *loaded == *block);
+    }
+
+    void testDuplicateBlobsWrittenOnce() {
+        beginTest("Identical file contents are stored once");
+
+        TempStore temp;
+        auto a = makeBlock(50000, 2);
+        auto b = std::make_shared<juce::MemoryBlock>(*a);
+
+        ProjectChunkFormat::Writer single(temp.store, true);
+        single.addBlob(a);
+        juce::MemoryBlock singleData;
+        single.write(makeProject("x"), singleData);
+
+        ProjectChunkFormat::Writer duplicate(temp.store, true);
+        auto hashA = duplicate.addBlob(a);
+        auto hashB = duplicate.addBlob(b);
+        juce::MemoryBlock duplicateData;
+        duplicate.write(makeProject("x"), duplicateData);
+
+        expectEquals(hashA, hashB);
+        expectEquals((int) duplicateData.getSize(), (int) singleData.getSize());
+    }
+
+    void testExternalBlobsReferenced() {
+        beginTest("External blobs are referenced, not inlined");
+
+        TempStore temp;
+        auto block = makeBlock(200000, 3);
+
+        ProjectChunkFormat::Writer writer(temp.store, false);
+        auto hash = writer.addBlob(block);
+        juce::MemoryBlock data;
+        writer.write(makeProject(hash), data);
+
+        expect(temp.store.contains(hash));
+        expect(data.getSize() < 10000, "State should only carry the reference, got " + juce::String((int) data.getSize()) + " bytes");
+
+        // A fresh store on the same directory simulates loading in a new session.
+        ProjectBlobStore freshStore(temp.dir.getFile());
+        ProjectChunkFormat::Reader reader(data.getData(), data.getSize());
+        auto loaded = reader.getBlob(hash, freshStore);
+        expect(loaded != nullptr && *loaded == *block);
+
+        // Loading again shares the same block rather than reading it twice.
+        expect(freshStore.load(hash) == loaded);
+    }
+
+    void testMissingExternalBlob() {
+        beginTest("Missing external blob returns nullptr");
+
+        TempStore temp;
+        auto hash = juce::SHA256(juce::String("not stored").toUTF8()).toHexString();
+        juce::MemoryBlock data;
+        ProjectChunkFormat::Writer(temp.store, false).write(makeProject(hash), data);
+
+        ProjectChunkFormat::Reader reader(data.getData(), data.getSize());
+        expect(reader.isValid());
+        expect(reader.getBlob(hash, temp.store) == nullptr);
+    }
+
+    void testEmbeddedBlobCopiedToStore() {
+        beginTest("Embedded blobs can be parked in the store until first use");
+
+        TempStore temp;
+        auto block = makeBlock(30000, 5);
+        ProjectChunkFormat::Writer writer(temp.store, true);
+        auto hash = writer.addBlob(block);
+        juce::MemoryBlock data;
+        writer.write(makeProject(hash), data);
+
+        ProjectChunkFormat::Reader reader(data.getData(), data.getSize());
+        expect(reader.hasEmbeddedBlob(hash));
+        expect(!reader.hasEmbeddedBlob(juce::String::repeatedString("0", 64)));
+        expect(reader.copyBlobToStore(hash, temp.store));
+
+        // Read back in a new session, after the state data has gone.
+        data.reset();
+        ProjectBlobStore freshStore(temp.dir.getFile());
+        auto loaded = freshStore.load(hash);
+        expect(loaded != nullptr && *loaded == *block);
+    }
+
+    void testPruneUnusedBlobs() {
+        beginTest("Pruning deletes only old blobs nothing is waiting on");
+
+        TempStore temp;
+        juce::StringArray hashes;
+        for (int i = 0; i < 3; i++) {
+            auto block = makeBlock(1000, 10 + i);
+            auto hash = temp.store.hashOf(block);
+            expect(temp.store.store(hash, *block));
+            hashes.add(hash);
+        }
+
+        const auto longAgo = juce::Time::getCurrentTime() - juce::RelativeTime::days(60);
+        expect(temp.store.getFileFor(hashes[0]).setLastModificationTime(longAgo));
+        expect(temp.store.getFileFor(hashes[1]).setLastModificationTime(longAgo));
+        expect(temp.store.getFileFor(hashes[2]).setLastModificationTime(longAgo));
+        // Storing or touching a blob again counts as using it.
+        expect(temp.store.touch(hashes[2]));
+
+        expectEquals(temp.store.prune({ hashes[1] }, juce::RelativeTime::days(30)), 1);
+        expect(!temp.store.contains(hashes[0]));
+        expect(temp.store.contains(hashes[1]), "Blobs a project is waiting on are kept");
+        expect(temp.store.contains(hashes[2]), "Recently used blobs are kept");
+
+        expect(!temp.store.touch(hashes[0]));
+        expectEquals(temp.store.prune({}, juce::RelativeTime::days(30)), 1);
+        expect(temp.store.contains(hashes[2]));
+    }
+
+    void testLegacyXmlNotDetected() {
+        beginTest("Legacy XML state is not mistaken for the chunk format");
+
+        juce::MemoryBlock binaryXml;
+        juce::AudioProcessor::copyXmlToBinary(makeProject("x"), binaryXml);
+        expect(!ProjectChunkFormat::isChunkedProject(binaryXml.getData(), binaryXml.getSize()));
+
+        auto text = makeProject("x").toString();
+        expect(!ProjectChunkFormat::isChunkedProject(text.toRawUTF8(), text.getNumBytesAsUTF8()));
+
+        ProjectChunkFormat::Reader reader(text.toRawUTF8(), text.getNumBytesAsUTF8());
+        expect(!reader.isValid());
+        expect(reader.readXml() == nullptr);
+    }
+
+    void testTruncatedData() {
+        beginTest("Truncated data is rejected without reading out of bounds");
+
+        TempStore temp;
+        auto block = makeBlock(4096, 4);
+        ProjectChunkFormat::Writer writer(temp.store, true);
+        auto hash = writer.addBlob(block);
+        juce::MemoryBlock data;
+        writer.write(makeProject(hash), data);
+
+        // Cut into the blob chunk: the XML survives, the blob doesn't.
+        ProjectChunkFormat::Reader partial(data.getData(), data.getSize() - 100);
+        expect(partial.isValid());
+        expect(partial.getBlob(hash, temp.store) == nullptr);
+
+        // Cut into the header.
+        ProjectChunkFormat::Reader header(data.getData(), 12);
+        expect(!header.isValid());
+    }
+};
+
+static ProjectChunkFormatTest projectChunkFormatTest;
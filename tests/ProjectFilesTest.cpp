@@ -0,0 +1,177 @@
+#include <JuceHeader.h>
+#include "../Source/util/ProjectFiles.h"
+
+// ============================================================================
+// Project Files Tests — the <files> section of saved state: legacy Base64
+// files still load, host state only references blobs and restores them
+// without reading them, files that were never opened are saved without being
+// read or rehashed, and project files embed everything.
+// ============================================================================
+
+class ProjectFilesTest : public juce::UnitTest {
+public:
+    ProjectFilesTest() : juce::UnitTest("Project Files", "Project") {}
+
+    void runTest() override {
+        testLegacyXml();
+        testLazyRestore();
+        testPendingFilesSavedByReference();
+        testPortableExport();
+        testMissingBlob();
+    }
+
+private:
+    static std::shared_ptr<juce::MemoryBlock> makeBlock(int size, int seed) {
+        auto block = std::make_shared<juce::MemoryBlock>((size_t) size);
+        juce::Random rng(seed);
+        for (int i = 0; i < size; i++) {
+            static_cast<char*>(block->getData())[i] = (char) rng.nextInt(256);
+        }
+        return block;
+    }
+
+    struct TempStore {
+        juce::TemporaryFile dir;
+        ProjectBlobStore store { dir.getFile() };
+        ~TempStore() { dir.getFile().deleteRecursively(); }
+    };
+
+    // Saves files as the processor does and returns the state data.
+    static juce::MemoryBlock saveState(const std::vector<ProjectFiles::File>& files, ProjectBlobStore& store, bool embed) {
+        juce::XmlElement xml("project");
+        ProjectChunkFormat::Writer writer(store, embed);
+        ProjectFiles::save(files, writer, *xml.createNewChildElement("files"));
+        juce::MemoryBlock data;
+        writer.write(xml, data);
+        return data;
+    }
+
+    static ProjectFiles::Restored restoreState(const juce::MemoryBlock& data, ProjectBlobStore& store) {
+        ProjectChunkFormat::Reader reader(data.getData(), data.getSize());
+        auto xml = reader.readXml();
+        if (xml == nullptr || xml->getChildByName("files") == nullptr) {
+            return {};
+        }
+        return ProjectFiles::restore(*xml->getChildByName("files"), &reader, store, false);
+    }
+
+    void testLegacyXml() {
+        beginTest("Legacy XML states decode their Base64 files");
+
+        TempStore temp;
+        auto block = makeBlock(5000, 1);
+
+        auto text = "<project version=\"2.4.0\"><files>"
+                    "<file name=\"a.obj\">" + block->toBase64Encoding() + "</file>"
+                    "</files></project>";
+        auto xml = juce::XmlDocument::parse(text);
+        expect(xml != nullptr);
+
+        auto restored = ProjectFiles::restore(*xml->getChildByName("files"), nullptr, temp.store, false);
+        expectEquals((int) restored.files.size(), 1);
+        expectEquals(restored.files[0].name, juce::String("a.obj"));
+        expect(restored.files[0].pendingBlob.isEmpty(), "Legacy files are opened straight away");
+        expect(restored.files[0].block != nullptr && *restored.files[0].block == *block);
+
+        // Before 2.2.0, files were encoded with juce::Base64.
+        juce::XmlElement old("files");
+        old.createNewChildElement("file")->setAttribute("name", "b.svg");
+        old.getChildElement(0)->addTextElement(juce::Base64::toBase64(block->getData(), block->getSize()));
+        restored = ProjectFiles::restore(old, nullptr, temp.store, true);
+        expectEquals((int) restored.files.size(), 1);
+        expect(restored.files[0].block != nullptr && *restored.files[0].block == *block);
+        expect(restored.missingNames.isEmpty());
+    }
+
+    void testLazyRestore() {
+        beginTest("Host state only references blobs and restores them unread");
+
+        TempStore temp;
+        auto block = makeBlock(200000, 2);
+        auto data = saveState({ { "big.wav", block, {} } }, temp.store, false);
+        expect(data.getSize() < 10000, "State should only carry the reference, got " + juce::String((int) data.getSize()) + " bytes");
+
+        // A fresh store on the same directory simulates a new session.
+        ProjectBlobStore freshStore(temp.dir.getFile());
+        auto restored = restoreState(data, freshStore);
+        expectEquals((int) restored.files.size(), 1);
+        expect(restored.files[0].block == nullptr, "The file should wait in the store until it's opened");
+        expectEquals(restored.files[0].pendingBlob, temp.store.hashOf(block));
+
+        auto opened = freshStore.load(restored.files[0].pendingBlob);
+        expect(opened != nullptr && *opened == *block);
+    }
+
+    void testPendingFilesSavedByReference() {
+        beginTest("Files that were never opened are saved without being read");
+
+        TempStore temp;
+        auto block = makeBlock(50000, 3);
+        auto hash = temp.store.hashOf(block);
+        expect(temp.store.store(hash, *block));
+
+        // Swap the stored bytes for others of the same size. Saving the
+        // pending file must keep its hash, which it only would if it neither
+        // read nor rehashed the blob.
+        ProjectBlobStore freshStore(temp.dir.getFile());
+        expect(freshStore.getFileFor(hash).replaceWithData(makeBlock(50000, 4)->getData(), 50000));
+
+        auto data = saveState({ { "pending.obj", nullptr, hash } }, freshStore, false);
+        auto restored = restoreState(data, freshStore);
+        expectEquals((int) restored.files.size(), 1);
+        expectEquals(restored.files[0].pendingBlob, hash);
+        expect(restored.files[0].block == nullptr);
+    }
+
+    void testPortableExport() {
+        beginTest("Project files embed every blob, including unopened ones");
+
+        TempStore temp;
+        auto opened = makeBlock(30000, 5);
+        auto pending = makeBlock(40000, 6);
+        auto pendingHash = temp.store.hashOf(pending);
+        expect(temp.store.store(pendingHash, *pending));
+
+        auto data = saveState({ { "opened.obj", opened, {} }, { "pending.obj", nullptr, pendingHash } }, temp.store, true);
+        expect(data.getSize() > 70000, "Both blobs should be embedded");
+
+        // Opened on another machine, with an empty store.
+        TempStore other;
+        auto restored = restoreState(data, other.store);
+        expectEquals((int) restored.files.size(), 2);
+        expect(restored.missingNames.isEmpty());
+        for (auto& file : restored.files) {
+            expect(other.store.contains(file.pendingBlob), "Embedded blobs should wait in the store");
+        }
+        auto loaded = other.store.load(restored.files[1].pendingBlob);
+        expect(loaded != nullptr && *loaded == *pending);
+
+        // Opening it again finds the blobs already stored and doesn't write
+        // them out again: swapped bytes of the same size would be overwritten.
+        auto swapped = makeBlock(40000, 9);
+        expect(other.store.getFileFor(pendingHash).replaceWithData(swapped->getData(), swapped->getSize()));
+        restored = restoreState(data, other.store);
+        expectEquals((int) restored.files.size(), 2);
+        juce::MemoryBlock onDisk;
+        expect(other.store.getFileFor(pendingHash).loadFileAsData(onDisk));
+        expect(onDisk == *swapped);
+    }
+
+    void testMissingBlob() {
+        beginTest("Files whose blobs are gone are reported where they were");
+
+        TempStore temp;
+        auto a = makeBlock(1000, 7);
+        auto b = makeBlock(1000, 8);
+        auto data = saveState({ { "a.obj", a, {} }, { "b.obj", b, {} }, { "c.obj", a, {} } }, temp.store, false);
+        expect(temp.store.getFileFor(temp.store.hashOf(b)).deleteFile());
+
+        auto restored = restoreState(data, temp.store);
+        expectEquals((int) restored.files.size(), 2);
+        expect(restored.missingNames == juce::StringArray { "b.obj" });
+        expect(restored.missingIndices == std::vector<int> { 1 });
+        expectEquals(restored.files[1].name, juce::String("c.obj"));
+    }
+};
+
+static ProjectFilesTest projectFilesTest;
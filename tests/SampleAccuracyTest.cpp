@@ -3,6 +3,7 @@
 #include "../Source/audio/modulation/LfoState.h"
 #include "../Source/audio/modulation/ModulationEngine.h"
 #include "../Source/audio/modulation/LfoParameters.h"
+#include "../Source/audio/SubBlockSplitter.h"
 
 using namespace osci;
 
@@ -334,3 +335,216 @@ public:
 };
 
 static LfoSyncTimelineAnchorTest lfoSyncTimelineAnchorTest;
+
+// ============================================================================
+// Test 7: MIDI CCs take effect on their own sample within a large block
+// ============================================================================
+class ControllerSampleAccuracyTest : public juce::UnitTest {
+public:
+    ControllerSampleAccuracyTest() : juce::UnitTest("MIDI CC Sample Accuracy", "LFO") {}
+
+    void runTest() override {
+        testSplitPoints();
+        testCcReachesEffectOnItsSample();
+        testMappedCcThroughRenderPath();
+        testPlayHeadFollowsSubBlocks();
+    }
+
+private:
+    static constexpr int kBlockSize = 1024;
+    static constexpr double kSampleRate = 48000.0;
+
+    struct FixedPlayHead : public juce::AudioPlayHead {
+        bool playing = true;
+
+        juce::Optional<PositionInfo> getPosition() const override {
+            PositionInfo info;
+            info.setIsPlaying(playing);
+            info.setBpm(120.0);
+            info.setTimeInSamples(48000);
+            info.setTimeInSeconds(1.0);
+            info.setPpqPosition(2.0);
+            return info;
+        }
+    };
+
+    static juce::MidiBuffer ccAt(std::initializer_list<std::pair<int, int>> positionsAndValues) {
+        juce::MidiBuffer midi;
+        for (auto [pos, value] : positionsAndValues)
+            midi.addEvent(juce::MidiMessage::controllerEvent(1, 1, value), pos);
+        return midi;
+    }
+
+    void testSplitPoints() {
+        beginTest("Blocks split at controllers, merging ones closer than the minimum");
+
+        expect(SubBlockSplitter::findSplitPoints({}, kBlockSize).empty());
+
+        auto points = SubBlockSplitter::findSplitPoints(ccAt({ { 0, 1 }, { 10, 2 }, { 300, 3 }, { 310, 4 }, { 700, 5 } }), kBlockSize);
+        expectEquals((int)points.size(), 2);
+        if (points.size() == 2) {
+            expectEquals(points[0], 300);
+            expectEquals(points[1], 700);
+        }
+
+        juce::MidiBuffer notes;
+        notes.addEvent(juce::MidiMessage::noteOn(1, 60, 1.0f), 500);
+        expect(SubBlockSplitter::findSplitPoints(notes, kBlockSize).empty(),
+               "Notes are already sample-accurate in the voices and shouldn't split");
+    }
+
+    void testCcReachesEffectOnItsSample() {
+        beginTest("CC-mapped parameter changes on the CC's sample at 1024-sample blocks");
+
+        TestEffect effect;
+        effect.addParam("cc", 0.0f, 0.0f, 1.0f);
+        effect.prepareToPlay(kSampleRate, kBlockSize);
+
+        SubBlockSplitter splitter;
+        splitter.prepareToPlay(kBlockSize);
+
+        juce::AudioBuffer<float> buffer(2, kBlockSize);
+        std::vector<float> values(kBlockSize);
+        std::vector<int> chunkSizes;
+        int written = 0;
+
+        // Stands in for the processor: apply this chunk's CCs, then animate.
+        auto render = [&](juce::AudioBuffer<float>& sub, juce::MidiBuffer& midi, juce::AudioPlayHead*) {
+            for (const auto metadata : midi) {
+                auto message = metadata.getMessage();
+                if (message.isController())
+                    effect.parameters[0]->setUnnormalisedValueNotifyingHost(message.getControllerValue() / 127.0f);
+            }
+            int n = sub.getNumSamples();
+            effect.animateValues(n, nullptr);
+            for (int i = 0; i < n && written + i < kBlockSize; ++i)
+                values[(size_t)(written + i)] = effect.getAnimatedValue(0, (size_t)i);
+            written += n;
+            chunkSizes.push_back(n);
+        };
+
+        // Let the parameter settle at its starting value.
+        for (int b = 0; b < 20; ++b) {
+            juce::MidiBuffer empty;
+            written = 0;
+            chunkSizes.clear();
+            splitter.render(buffer, empty, nullptr, kSampleRate, render);
+        }
+        expectEquals((int)chunkSizes.size(), 1, "A block without CCs renders in one piece");
+
+        written = 0;
+        chunkSizes.clear();
+        auto midi = ccAt({ { 300, 127 }, { 700, 0 } });
+        splitter.render(buffer, midi, nullptr, kSampleRate, render);
+
+        expectEquals(written, kBlockSize);
+        expectEquals((int)chunkSizes.size(), 3);
+        expectWithinAbsoluteError(values[299], values[0], 1e-6f, "CC applied before its sample");
+        // Allow a few samples for the parameter's own smoothing to get going.
+        expect(values[308] > values[299] + 1e-6f, "CC at 300 should move the value from sample 300");
+        expect(values[699] > values[308], "Value should keep rising until the next CC");
+        expect(values[708] < values[699], "CC at 700 should move the value back from sample 700");
+    }
+
+    void testMappedCcThroughRenderPath() {
+        beginTest("A learned CC mapping moves its parameter on the CC's sample");
+
+        TestEffect effect;
+        effect.addParam("cc", 0.0f, 0.0f, 1.0f);
+        effect.prepareToPlay(kSampleRate, kBlockSize);
+
+        // Learn CC 1 the way the UI does, then let the message thread finish it.
+        MidiCCManager ccManager;
+        ccManager.startLearning(effect.parameters[0]);
+        auto learn = ccAt({ { 0, 0 } });
+        ccManager.processMidiBuffer(learn);
+        const auto deadline = juce::Time::getMillisecondCounter() + 2000;
+        while (ccManager.getAssignedCC(effect.parameters[0]) != 1 && juce::Time::getMillisecondCounter() < deadline) {
+            if (auto* mm = juce::MessageManager::getInstanceWithoutCreating())
+                mm->runDispatchLoopUntil(10);
+            else
+                juce::Thread::sleep(10);
+        }
+        expectEquals(ccManager.getAssignedCC(effect.parameters[0]), 1);
+
+        SubBlockSplitter splitter;
+        splitter.prepareToPlay(kBlockSize);
+        juce::MidiKeyboardState keyboardState;
+
+        juce::AudioBuffer<float> buffer(2, kBlockSize);
+        std::vector<float> values(kBlockSize);
+        int written = 0;
+
+        // The start of renderBlock for each chunk: keyboard merge, CC
+        // mappings, then the once-per-chunk animation.
+        auto render = [&](juce::AudioBuffer<float>& sub, juce::MidiBuffer& midi, juce::AudioPlayHead*) {
+            const int n = sub.getNumSamples();
+            keyboardState.processNextMidiBuffer(midi, 0, n, true);
+            ccManager.processMidiBuffer(midi);
+            effect.animateValues(n, nullptr);
+            for (int i = 0; i < n && written + i < kBlockSize; ++i)
+                values[(size_t)(written + i)] = effect.getAnimatedValue(0, (size_t)i);
+            written += n;
+        };
+
+        for (int b = 0; b < 20; ++b) {
+            juce::MidiBuffer empty;
+            written = 0;
+            splitter.render(buffer, empty, nullptr, kSampleRate, render);
+        }
+
+        written = 0;
+        auto midi = ccAt({ { 300, 127 }, { 700, 0 } });
+        splitter.render(buffer, midi, nullptr, kSampleRate, render);
+
+        expectEquals(written, kBlockSize);
+        expectWithinAbsoluteError(values[299], values[0], 1e-6f, "CC applied before its sample");
+        expect(values[308] > values[299] + 1e-6f, "CC at 300 should move the value from sample 300");
+        expect(values[699] > values[308], "Value should keep rising until the next CC");
+        expect(values[708] < values[699], "CC at 700 should move the value back from sample 700");
+    }
+
+    void testPlayHeadFollowsSubBlocks() {
+        beginTest("Sub-blocks see the host position advanced to their first sample");
+
+        SubBlockSplitter splitter;
+        splitter.prepareToPlay(kBlockSize);
+        juce::AudioBuffer<float> buffer(2, kBlockSize);
+        FixedPlayHead host;
+
+        std::vector<juce::AudioPlayHead::PositionInfo> positions;
+        auto render = [&](juce::AudioBuffer<float>&, juce::MidiBuffer&, juce::AudioPlayHead* head) {
+            expect(head != nullptr);
+            if (head != nullptr)
+                positions.push_back(*head->getPosition());
+        };
+
+        auto midi = ccAt({ { 480, 64 } });
+        splitter.render(buffer, midi, &host, kSampleRate, render);
+
+        expectEquals((int)positions.size(), 2);
+        if (positions.size() == 2) {
+            expectEquals((int)*positions[0].getTimeInSamples(), 48000);
+            expectEquals((int)*positions[1].getTimeInSamples(), 48480);
+            expectWithinAbsoluteError(*positions[1].getTimeInSeconds(), 1.01, 1e-9);
+            // 10ms at 120 bpm is 0.02 beats
+            expectWithinAbsoluteError(*positions[1].getPpqPosition(), 2.02, 1e-9);
+        }
+
+        positions.clear();
+        host.playing = false;
+        midi = ccAt({ { 480, 64 } });
+        splitter.render(buffer, midi, &host, kSampleRate, render);
+        if (positions.size() == 2)
+            expectEquals((int)*positions[1].getTimeInSamples(), 48000, "A stopped transport doesn't move");
+
+        positions.clear();
+        midi = ccAt({ { 480, 64 } });
+        splitter.render(buffer, midi, nullptr, kSampleRate,
+                        [&](juce::AudioBuffer<float>&, juce::MidiBuffer&, juce::AudioPlayHead* head) {
+                            expect(head == nullptr, "No host play head means none for the sub-blocks either");
+                        });
+    }
+};
+
+static ControllerSampleAccuracyTest controllerSampleAccuracyTest;
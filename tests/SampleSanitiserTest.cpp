@@ -0,0 +1,253 @@
+#include <JuceHeader.h>
+#include "TestCleanup.h"
+#include "TestBinaryData.h"
+#include "../Source/audio/SampleSanitiser.h"
+#include "../Source/audio/effects/AutoGainControlEffect.h"
+#include "../Source/audio/effects/BitCrushEffect.h"
+#include "../Source/audio/effects/BounceEffect.h"
+#include "../Source/audio/effects/BulgeEffect.h"
+#include "../Source/audio/effects/DashedLineEffect.h"
+#include "../Source/audio/effects/DelayEffect.h"
+#include "../Source/audio/effects/DistortEffect.h"
+#include "../Source/audio/effects/GodRayEffect.h"
+#include "../Source/audio/effects/KaleidoscopeEffect.h"
+#include "../Source/audio/effects/MultiplexEffect.h"
+#include "../Source/audio/effects/PerspectiveEffect.h"
+#include "../Source/audio/effects/PolygonizerEffect.h"
+#include "../Source/audio/effects/RippleEffect.h"
+#include "../Source/audio/effects/RotateEffect.h"
+#include "../Source/audio/effects/ScaleEffect.h"
+#include "../Source/audio/effects/SkewEffect.h"
+#include "../Source/audio/effects/SmoothEffect.h"
+#include "../Source/audio/effects/SpiralBitCrushEffect.h"
+#include "../Source/audio/effects/StereoEffect.h"
+#include "../Source/audio/effects/SwirlEffect.h"
+#include "../Source/audio/effects/TranslateEffect.h"
+#include "../Source/audio/effects/TwistEffect.h"
+#include "../Source/audio/effects/UnfoldEffect.h"
+#include "../Source/audio/effects/VectorCancellingEffect.h"
+#include "../Source/audio/effects/VortexEffect.h"
+#include "../Source/audio/effects/WobbleEffect.h"
+
+// ============================================================================
+// Sample Sanitiser Tests — NaN, Inf and runaway samples are caught and
+// replaced, and every effect fed them recovers once it has been reset, so a
+// single bad block can't poison the chain for good.
+//
+// The Lua and duplicator effects aren't covered: they need the Lua effect
+// state and the full processor, which the test project doesn't build.
+// ============================================================================
+
+class SampleSanitiserTest : public juce::UnitTest {
+public:
+    SampleSanitiserTest() : juce::UnitTest("Sample Sanitiser", "Audio") {}
+
+    void runTest() override {
+        testDetection();
+        testReplacement();
+        testStagesAreIsolated();
+        testEffectsRecover();
+    }
+
+private:
+    static constexpr double kSampleRate = 48000.0;
+    static constexpr int kBlockSize = 256;
+
+    static std::vector<std::shared_ptr<osci::Effect>> buildAllEffects() {
+        return {
+            AutoGainControlEffect().build(),
+            BitCrushEffect().build(),
+            BounceEffect().build(),
+            BulgeEffect().build(),
+            DashedLineEffect().build(),
+            TraceEffect().build(),
+            DelayEffect().build(),
+            DistortEffect().build(),
+            GodRayEffect().build(),
+            KaleidoscopeEffect().build(),
+            MultiplexEffect().build(),
+            PerspectiveEffect().build(),
+            PolygonizerEffect().build(),
+            RippleEffectApp().build(),
+            RotateEffectApp().build(),
+            ScaleEffectApp().build(),
+            SkewEffect().build(),
+            SmoothEffect().build(),
+            SpiralBitCrushEffect().build(),
+            StereoEffect().build(),
+            SwirlEffectApp().build(),
+            TranslateEffectApp().build(),
+            TwistEffect().build(),
+            UnfoldEffect().build(),
+            VectorCancellingEffect().build(),
+            VortexEffect().build(),
+            WobbleEffect().build(),
+        };
+    }
+
+    // A circle on X/Y with no colour, as a voice would render it.
+    static void fillCircle(juce::AudioBuffer<float>& buffer, int& phase) {
+        buffer.clear();
+        for (int i = 0; i < buffer.getNumSamples(); ++i, ++phase) {
+            const double angle = juce::MathConstants<double>::twoPi * 200.0 * phase / kSampleRate;
+            buffer.setSample(0, i, 0.5f * (float) std::cos(angle));
+            buffer.setSample(1, i, 0.5f * (float) std::sin(angle));
+        }
+        for (int ch = 3; ch < buffer.getNumChannels(); ++ch) {
+            juce::FloatVectorOperations::fill(buffer.getWritePointer(ch), -1.0f, buffer.getNumSamples());
+        }
+    }
+
+    static bool isClean(const juce::AudioBuffer<float>& buffer) {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
+            if (!SampleSanitiser::isClean(buffer.getReadPointer(ch), buffer.getNumSamples())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void process(osci::Effect& effect, juce::AudioBuffer<float>& buffer) {
+        juce::MidiBuffer midi;
+        effect.animateValues(buffer.getNumSamples(), nullptr);
+        effect.processBlockWithInputs(buffer, midi, nullptr, nullptr, nullptr);
+    }
+
+    void testDetection() {
+        beginTest("Only NaN, Inf and runaway samples are bad");
+
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        const float inf = std::numeric_limits<float>::infinity();
+        const float denormal = std::numeric_limits<float>::denorm_min();
+
+        std::vector<float> block(64, 0.25f);
+        for (float good : { 0.0f, -0.0f, denormal, SampleSanitiser::kMaxMagnitude, -SampleSanitiser::kMaxMagnitude }) {
+            block[17] = good;
+            expect(SampleSanitiser::isClean(block.data(), (int) block.size()), juce::String(good) + " should be clean");
+        }
+        for (float bad : { nan, -nan, inf, -inf, 1.0e30f, -SampleSanitiser::kMaxMagnitude * 2.0f }) {
+            for (int at : { 0, 17, 63 }) {
+                std::fill(block.begin(), block.end(), 0.25f);
+                block[(size_t) at] = bad;
+                expect(!SampleSanitiser::isClean(block.data(), (int) block.size()),
+                       juce::String(bad) + " at " + juce::String(at) + " should be caught");
+            }
+        }
+        expect(SampleSanitiser::isClean(block.data(), 0));
+    }
+
+    void testReplacement() {
+        beginTest("Bad samples are replaced and nothing else is touched");
+
+        juce::AudioBuffer<float> buffer(6, 16);
+        int phase = 0;
+        fillCircle(buffer, phase);
+        juce::AudioBuffer<float> original(buffer);
+
+        expectEquals(SampleSanitiser::sanitise(buffer), 0);
+        expect(!SampleSanitiser::contain(buffer, nullptr, kSampleRate, kBlockSize));
+
+        buffer.setSample(0, 3, std::numeric_limits<float>::quiet_NaN());
+        buffer.setSample(1, 3, -std::numeric_limits<float>::infinity());
+        buffer.setSample(4, 7, 1.0e20f);
+        expectEquals(SampleSanitiser::sanitise(buffer), 3);
+
+        // Spatial channels fall back to the origin, colour to "no colour".
+        expectEquals(buffer.getSample(0, 3), 0.0f);
+        expectEquals(buffer.getSample(1, 3), 0.0f);
+        expectEquals(buffer.getSample(4, 7), -1.0f);
+
+        int untouched = 0;
+        for (int ch = 0; ch < 6; ++ch) {
+            for (int i = 0; i < 16; ++i) {
+                const bool replaced = (i == 3 && ch < 2) || (i == 7 && ch == 4);
+                if (!replaced && buffer.getSample(ch, i) == original.getSample(ch, i)) {
+                    untouched++;
+                }
+            }
+        }
+        expectEquals(untouched, 6 * 16 - 3);
+    }
+
+    void testStagesAreIsolated() {
+        beginTest("Containing a stage keeps the next stateful effect clean");
+
+        // Without containment a single NaN stays in the smoother's average
+        // for good; contained before it arrives, the smoother never sees it.
+        auto smooth = SmoothEffect().build();
+        smooth->prepareToPlay(kSampleRate, kBlockSize);
+
+        juce::AudioBuffer<float> buffer(6, kBlockSize);
+        int phase = 0;
+        int smootherContained = 0;
+        for (int block = 0; block < 32; ++block) {
+            fillCircle(buffer, phase);
+            if (block % 4 == 1) {
+                buffer.setSample(0, block % kBlockSize, std::numeric_limits<float>::quiet_NaN());
+            }
+            expect(SampleSanitiser::contain(buffer, nullptr, kSampleRate, kBlockSize) == (block % 4 == 1));
+
+            process(*smooth, buffer);
+            if (SampleSanitiser::contain(buffer, smooth.get(), kSampleRate, kBlockSize)) {
+                smootherContained++;
+            }
+        }
+        expectEquals(smootherContained, 0);
+
+        testutil::cleanupEffectParams(*smooth);
+    }
+
+    void testEffectsRecover() {
+        beginTest("Every effect recovers from NaN, Inf and huge input");
+
+        juce::ScopedNoDenormals noDenormals;
+        const float poisons[] = {
+            std::numeric_limits<float>::quiet_NaN(),
+            std::numeric_limits<float>::infinity(),
+            -std::numeric_limits<float>::infinity(),
+            std::numeric_limits<float>::max(),
+            -1.0e30f,
+            SampleSanitiser::kMaxMagnitude,
+            std::numeric_limits<float>::denorm_min(),
+        };
+        auto random = getRandom();
+
+        // Long enough for the longest delay line in any effect (one second)
+        // to have been flushed by the reset, or to have come back round.
+        const int recoveryBlocks = (int) (2.0 * kSampleRate / kBlockSize);
+
+        for (auto& effect : buildAllEffects()) {
+            const juce::String name = effect->getName();
+            effect->prepareToPlay(kSampleRate, kBlockSize);
+
+            juce::AudioBuffer<float> buffer(6, kBlockSize);
+            int phase = 0;
+            bool alwaysContained = true;
+            for (int block = 0; block < 64; ++block) {
+                fillCircle(buffer, phase);
+                const int numPoisoned = 1 + random.nextInt(8);
+                for (int p = 0; p < numPoisoned; ++p) {
+                    buffer.setSample(random.nextInt(6), random.nextInt(kBlockSize), poisons[random.nextInt((int) std::size(poisons))]);
+                }
+                process(*effect, buffer);
+                SampleSanitiser::contain(buffer, effect.get(), kSampleRate, kBlockSize);
+                alwaysContained &= isClean(buffer);
+            }
+            expect(alwaysContained, name + " let bad samples past containment");
+
+            int lateContainments = 0;
+            for (int block = 0; block < recoveryBlocks; ++block) {
+                fillCircle(buffer, phase);
+                process(*effect, buffer);
+                if (SampleSanitiser::contain(buffer, effect.get(), kSampleRate, kBlockSize) && block >= recoveryBlocks / 2) {
+                    lateContainments++;
+                }
+            }
+            expectEquals(lateContainments, 0, name + " still produces bad samples from clean input");
+
+            testutil::cleanupEffectParams(*effect);
+        }
+    }
+};
+
+static SampleSanitiserTest sampleSanitiserTest;
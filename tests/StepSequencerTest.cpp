@@ -0,0 +1,347 @@
+#include <JuceHeader.h>
+#include "TestCleanup.h"
+#include "../Source/audio/modulation/ModulationEngine.h"
+#include "../Source/audio/modulation/StepSequencerParameters.h"
+
+using namespace osci;
+
+// ============================================================================
+// Step Sequencer Tests — steps change on exactly the sample the transport
+// reaches their boundary, however the host splits its blocks, and glide,
+// probability, length and saved state behave as edited.
+// ============================================================================
+
+class StepSequencerTest : public juce::UnitTest {
+public:
+    StepSequencerTest() : juce::UnitTest("Step Sequencer", "Modulation") {}
+
+    void runTest() override {
+        testStepBoundaries();
+        testBoundariesIndependentOfBlockSize();
+        testTempoModes();
+        testSecondsMode();
+        testLengthWraps();
+        testGlide();
+        testProbability();
+        testFreezeHolds();
+        testModulatesParameter();
+        testSaveAndLoad();
+    }
+
+private:
+    static constexpr double kSampleRate = 48000.0;
+    static constexpr double kBpm = 120.0;
+    // 1/16 at 120 bpm is an eighth of a second
+    static constexpr int kSixteenthDivision = 10;
+    static constexpr int kSamplesPerSixteenth = 6000;
+
+    // Minimal Effect with one static parameter to modulate
+    class TargetEffect : public Effect {
+    public:
+        TargetEffect() {
+            auto* p = new EffectParameter("target", "target", "target", 1, 0.0f, 0.0f, 1.0f);
+            p->lfo->setUnnormalisedValueNotifyingHost((int)LfoType::Static);
+            parameters.push_back(p);
+            actualValues = std::vector<std::atomic<float>>(parameters.size());
+            actualValues[0] = 0.0f;
+        }
+        ~TargetEffect() override {
+            testutil::cleanupEffectParams(*this);
+        }
+        const juce::String getName() const override { return "TargetEffect"; }
+        std::vector<EffectParameter*> initialiseParameters() const override { return {}; }
+        void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {}
+    };
+
+    // Sequencer 0 with each step's value set to its index / 64, so the
+    // output identifies the step.
+    static void setRamp(StepSequencerParameters& params, int length) {
+        StepSequence sequence;
+        for (int i = 0; i < seq::kMaxSteps; ++i)
+            sequence.steps[i].value = (float)i / seq::kMaxSteps;
+        params.setSequence(0, sequence);
+        params.setLength(0, length);
+    }
+
+    static int stepOf(float value) {
+        return juce::roundToInt(value * seq::kMaxSteps);
+    }
+
+    // Runs sequencer 0 from the start of the transport, as the processor
+    // does, and returns its output.
+    static std::vector<float> render(StepSequencerParameters& params, int numSamples, int blockSize,
+                                     double bpm = kBpm) {
+        std::vector<float> output;
+        params.prepareToPlay(kSampleRate, blockSize);
+        for (int start = 0; start < numSamples; start += blockSize) {
+            int n = juce::jmin(blockSize, numSamples - start);
+            double seconds = start / kSampleRate;
+            params.fillBlockBuffers(n, kSampleRate, bpm, seconds, seconds * bpm / 60.0);
+            output.insert(output.end(), params.blockBuffer[0].begin(), params.blockBuffer[0].begin() + n);
+        }
+        return output;
+    }
+
+    void testStepBoundaries() {
+        beginTest("Steps change on the sample the transport reaches them");
+
+        StepSequencerParameters params;
+        setRamp(params, 16);
+        params.setRateMode(0, LfoRateMode::Tempo);
+        params.setTempoDivision(0, kSixteenthDivision);
+
+        const int numSamples = kSamplesPerSixteenth * 20;
+        auto output = render(params, numSamples, 512);
+
+        int mismatches = 0;
+        for (int s = 0; s < numSamples; ++s) {
+            if (stepOf(output[(size_t)s]) != (s / kSamplesPerSixteenth) % 16)
+                mismatches++;
+        }
+        expectEquals(mismatches, 0);
+
+        // Either side of a boundary that falls inside a 512 sample block
+        expectEquals(stepOf(output[kSamplesPerSixteenth - 1]), 0);
+        expectEquals(stepOf(output[kSamplesPerSixteenth]), 1);
+        expectEquals(params.getCurrentStep(0), (numSamples - 1) / kSamplesPerSixteenth % 16);
+
+        testutil::cleanupStepSequencerParams(params);
+    }
+
+    void testBoundariesIndependentOfBlockSize() {
+        beginTest("Output doesn't depend on how the host splits blocks");
+
+        StepSequencerParameters a, b;
+        for (auto* params : { &a, &b }) {
+            setRamp(*params, 7);
+            params->setRateMode(0, LfoRateMode::TempoTriplets);
+            params->setTempoDivision(0, kSixteenthDivision);
+        }
+
+        const int numSamples = 48000;
+        auto big = render(a, numSamples, 512, 133.0);
+        auto odd = render(b, numSamples, 37, 133.0);
+        expect(big == odd);
+
+        testutil::cleanupStepSequencerParams(a);
+        testutil::cleanupStepSequencerParams(b);
+    }
+
+    void testTempoModes() {
+        beginTest("Dotted and triplet steps are 1.5x and 2/3 as long");
+
+        for (auto [mode, samples] : { std::pair{ LfoRateMode::TempoDotted, 9000 },
+                                      std::pair{ LfoRateMode::TempoTriplets, 4000 } }) {
+            StepSequencerParameters params;
+            setRamp(params, 64);
+            params.setRateMode(0, mode);
+            params.setTempoDivision(0, kSixteenthDivision);
+
+            auto output = render(params, samples * 3 + 1, 512);
+            expectEquals(stepOf(output[(size_t)samples - 1]), 0);
+            expectEquals(stepOf(output[(size_t)samples]), 1);
+            expectEquals(stepOf(output[(size_t)samples * 3]), 3);
+
+            testutil::cleanupStepSequencerParams(params);
+        }
+    }
+
+    void testSecondsMode() {
+        beginTest("Seconds mode steps at the rate in Hz");
+
+        StepSequencerParameters params;
+        setRamp(params, 64);
+        params.setRateMode(0, LfoRateMode::Seconds);
+        params.rate[0]->setUnnormalisedValueNotifyingHost(10.0f);
+
+        auto output = render(params, 48000, 512);
+        expectEquals(stepOf(output[4799]), 0);
+        expectEquals(stepOf(output[4800]), 1);
+        expectEquals(stepOf(output[47999]), 9);
+
+        testutil::cleanupStepSequencerParams(params);
+    }
+
+    void testLengthWraps() {
+        beginTest("Sequences wrap at their length");
+
+        StepSequencerParameters params;
+        setRamp(params, 3);
+        params.setTempoDivision(0, kSixteenthDivision);
+
+        auto output = render(params, kSamplesPerSixteenth * 4, 512);
+        expectEquals(stepOf(output[kSamplesPerSixteenth * 2]), 2);
+        expectEquals(stepOf(output[kSamplesPerSixteenth * 3]), 0);
+
+        testutil::cleanupStepSequencerParams(params);
+    }
+
+    void testGlide() {
+        beginTest("Glide steps ramp from the previous value");
+
+        StepSequencerParameters params;
+        StepSequence sequence;
+        sequence.steps[0].value = 0.0f;
+        sequence.steps[1].value = 1.0f;
+        sequence.steps[1].glide = true;
+        params.setSequence(0, sequence);
+        params.setLength(0, 2);
+        params.setTempoDivision(0, kSixteenthDivision);
+
+        auto output = render(params, kSamplesPerSixteenth * 2, 512);
+        expectEquals(output[kSamplesPerSixteenth - 1], 0.0f);
+        expectWithinAbsoluteError(output[kSamplesPerSixteenth], 0.0f, 1e-6f);
+        expectWithinAbsoluteError(output[kSamplesPerSixteenth + kSamplesPerSixteenth / 2], 0.5f, 1e-4f);
+        expectWithinAbsoluteError(output[kSamplesPerSixteenth * 2 - 1], 1.0f, 1e-3f);
+
+        testutil::cleanupStepSequencerParams(params);
+    }
+
+    void testProbability() {
+        beginTest("Skipped steps hold the previous value, reproducibly");
+
+        StepSequencerAudioState state;
+        expect(state.rollStep(5, 1.0f));
+        expect(!state.rollStep(5, 0.0f));
+        int played = 0;
+        for (int64_t step = 0; step < 10000; ++step)
+            played += state.rollStep(step, 0.25f) ? 1 : 0;
+        expectWithinAbsoluteError(played, 2500, 150);
+
+        StepSequencerParameters a, b;
+        for (auto* params : { &a, &b }) {
+            StepSequence sequence;
+            for (int i = 0; i < 8; ++i) {
+                sequence.steps[i].value = (float)(i + 1) / seq::kMaxSteps;
+                sequence.steps[i].probability = i == 0 ? 1.0f : 0.5f;
+            }
+            params->setSequence(0, sequence);
+            params->setLength(0, 8);
+            params->setTempoDivision(0, kSixteenthDivision);
+        }
+
+        const int numSteps = 64;
+        auto first = render(a, kSamplesPerSixteenth * numSteps, 512);
+        auto second = render(b, kSamplesPerSixteenth * numSteps, 1000);
+        expect(first == second);
+
+        int held = 0;
+        for (int i = 1; i < numSteps; ++i) {
+            int step = stepOf(first[(size_t)(i * kSamplesPerSixteenth)]);
+            int previous = stepOf(first[(size_t)(i * kSamplesPerSixteenth - 1)]);
+            if (step == previous)
+                held++;
+            else
+                expectEquals(step, i % 8 + 1);
+        }
+        expectGreaterThan(held, 10);
+        expectLessThan(held, 50);
+
+        testutil::cleanupStepSequencerParams(a);
+        testutil::cleanupStepSequencerParams(b);
+    }
+
+    void testFreezeHolds() {
+        beginTest("Freeze holds the current value");
+
+        StepSequencerParameters params;
+        setRamp(params, 16);
+        params.setTempoDivision(0, kSixteenthDivision);
+        render(params, kSamplesPerSixteenth * 3 + 10, 512);
+
+        params.setTempoDivision(0, 0);
+        auto output = render(params, kSamplesPerSixteenth * 4, 512);
+        for (auto value : output)
+            expectEquals(stepOf(value), 3);
+
+        testutil::cleanupStepSequencerParams(params);
+    }
+
+    void testModulatesParameter() {
+        beginTest("Step boundaries reach parameters through the modulation engine");
+
+        const int blockSize = 512;
+        TargetEffect target;
+        target.prepareToPlay(kSampleRate, blockSize);
+
+        std::unordered_map<juce::String, ParamLocation> paramMap;
+        paramMap["target"] = { &target, 0 };
+
+        StepSequencerParameters params;
+        StepSequence sequence;
+        sequence.steps[1].value = 1.0f;
+        sequence.steps[0].value = 0.0f;
+        params.setSequence(0, sequence);
+        params.setLength(0, 2);
+        params.setTempoDivision(0, kSixteenthDivision);
+
+        ModAssignment assignment;
+        assignment.sourceIndex = 0;
+        assignment.paramId = "target";
+        assignment.depth = 1.0f;
+        params.addAssignment(assignment);
+
+        ModulationEngine engine(paramMap);
+        engine.addSource(&params);
+        engine.prepareToPlay(kSampleRate, blockSize);
+        params.prepareToPlay(kSampleRate, blockSize);
+
+        // The block holding the first boundary starts at sample 5632
+        const int blockStart = (kSamplesPerSixteenth / blockSize) * blockSize;
+        const double seconds = blockStart / kSampleRate;
+        target.animateValues(blockSize, nullptr);
+        params.fillBlockBuffers(blockSize, kSampleRate, kBpm, seconds, seconds * kBpm / 60.0);
+        engine.applyAllModulation(blockSize);
+
+        const int boundary = kSamplesPerSixteenth - blockStart;
+        expectWithinAbsoluteError(target.getAnimatedValue(0, boundary - 1), 0.0f, 1e-6f);
+        expectWithinAbsoluteError(target.getAnimatedValue(0, boundary), 1.0f, 1e-6f);
+
+        testutil::cleanupStepSequencerParams(params);
+    }
+
+    void testSaveAndLoad() {
+        beginTest("Steps and assignments are saved with the project");
+
+        StepSequencerParameters params;
+        StepSequence sequence;
+        sequence.steps[0] = { 0.25f, false, 1.0f };
+        sequence.steps[13] = { 0.75f, true, 0.5f };
+        sequence.steps[63] = { 1.0f, false, 0.1f };
+        params.setSequence(2, sequence);
+        params.activeTab = 2;
+
+        ModAssignment assignment;
+        assignment.sourceIndex = 2;
+        assignment.paramId = "target";
+        assignment.depth = 0.4f;
+        params.addAssignment(assignment);
+
+        juce::XmlElement root("project");
+        params.saveToXml(&root);
+
+        StepSequencerParameters loaded;
+        loaded.loadFromXml(&root);
+
+        expectEquals(loaded.activeTab, 2);
+        expect(loaded.getSequence(2).steps == sequence.steps);
+        expect(loaded.getSequence(0).steps == StepSequence().steps);
+        auto assignments = loaded.getAssignments();
+        expectEquals((int)assignments.size(), 1);
+        if (assignments.size() == 1) {
+            expectEquals(assignments[0].sourceIndex, 2);
+            expectEquals(assignments[0].paramId, juce::String("target"));
+        }
+
+        // Projects from before step sequencers load with defaults
+        juce::XmlElement empty("project");
+        loaded.loadFromXml(&empty);
+        expect(loaded.getSequence(2).steps == StepSequence().steps);
+        expect(loaded.getAssignments().empty());
+
+        testutil::cleanupStepSequencerParams(params);
+        testutil::cleanupStepSequencerParams(loaded);
+    }
+};
+
+static StepSequencerTest stepSequencerTest;
@@ -0,0 +1,30 @@
+#pragma once
+
+// The test project has no binary resources, so give the effects' build()
+// methods the icon names they refer to.
+namespace BinaryData {
+    inline const char* bitcrush_svg = "";
+    inline const char* bounce_svg = "";
+    inline const char* bulge_svg = "";
+    inline const char* dash_svg = "";
+    inline const char* delay_svg = "";
+    inline const char* distort_svg = "";
+    inline const char* god_ray_svg = "";
+    inline const char* kaleidoscope_svg = "";
+    inline const char* multiplex_svg = "";
+    inline const char* polygonizer_svg = "";
+    inline const char* ripple_svg = "";
+    inline const char* rotate_svg = "";
+    inline const char* scale_svg = "";
+    inline const char* skew_svg = "";
+    inline const char* smoothing_svg = "";
+    inline const char* spiral_bitcrush_svg = "";
+    inline const char* swirl_svg = "";
+    inline const char* trace_svg = "";
+    inline const char* translate_svg = "";
+    inline const char* twist_svg = "";
+    inline const char* unfold_svg = "";
+    inline const char* vectorcancelling_svg = "";
+    inline const char* vortex_svg = "";
+    inline const char* wobble_svg = "";
+}
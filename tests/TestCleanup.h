@@ -1,6 +1,7 @@
 #pragma once
 #include <JuceHeader.h>
 #include "../Source/audio/modulation/LfoParameters.h"
+#include "../Source/audio/modulation/StepSequencerParameters.h"
 
 namespace testutil {
 
@@ -42,4 +43,14 @@ inline void cleanupLfoParams(LfoParameters& lp) {
     }
 }
 
+// Clean up a StepSequencerParameters the same way as cleanupLfoParams.
+inline void cleanupStepSequencerParams(StepSequencerParameters& sp) {
+    for (int i = 0; i < NUM_STEP_SEQUENCERS; ++i) {
+        delete sp.rate[i];          sp.rate[i] = nullptr;
+        delete sp.rateMode[i];      sp.rateMode[i] = nullptr;
+        delete sp.tempoDivision[i]; sp.tempoDivision[i] = nullptr;
+        delete sp.length[i];        sp.length[i] = nullptr;
+    }
+}
+
 } // namespace testutil
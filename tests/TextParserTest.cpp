@@ -0,0 +1,195 @@
+#include <JuceHeader.h>
+#include "../Source/parser/txt/TextParser.h"
+#include "../Source/parser/svg/SvgParser.h"
+
+// ============================================================================
+// Text Parser Tests — text built from cached glyph outlines one line at a
+// time must match laying the whole text out as one path, edited text must
+// reuse the lines that didn't change, font and style changes must lay
+// everything out again, and the outline cache must stay bounded.
+// ============================================================================
+
+class TextParserTest : public juce::UnitTest {
+public:
+    TextParserTest() : juce::UnitTest("Text Parser", "Parser") {}
+
+    void runTest() override {
+        testMatchesWholeTextLayout();
+        testEditReusesUnchangedLines();
+        testFontChangeInvalidates();
+        testOutlineCacheKeys();
+        testOutlineCacheEviction();
+    }
+
+private:
+    static juce::Font makeFont() {
+        return juce::Font(juce::Font::getDefaultMonospacedFontName(), 1.0f, juce::Font::plain);
+    }
+
+    // The layout TextParser used before glyph outlines were cached: the whole
+    // text in one TextLayout, turned into a single path and then shapes.
+    static std::vector<std::unique_ptr<osci::Shape>> layoutWholeText(const juce::String& text, const juce::Font& font) {
+        juce::AttributedString attributed;
+        attributed.append(text, font);
+        juce::TextLayout layout;
+        layout.createLayout(attributed, 64.0f);
+
+        juce::Path textPath;
+        for (int i = 0; i < layout.getNumLines(); ++i) {
+            const auto& line = layout.getLine(i);
+            for (auto* run : line.runs) {
+                juce::GlyphArrangement glyphs;
+                for (const auto& glyph : run->glyphs) {
+                    glyphs.addGlyph(juce::PositionedGlyph(run->font, glyph.glyphCode, glyph.glyphCode,
+                                                          line.lineOrigin.x + glyph.anchor.x - 1,
+                                                          line.lineOrigin.y + glyph.anchor.y - 1,
+                                                          glyph.width, false));
+                }
+                glyphs.createPath(textPath);
+            }
+        }
+
+        std::vector<std::unique_ptr<osci::Shape>> shapes;
+        SvgParser::pathToShapes(textPath, shapes, true);
+        return shapes;
+    }
+
+    // Shapes are reordered and reversed after layout, so frames are compared
+    // by what they draw rather than the order they draw it in.
+    void expectSameDrawing(const std::vector<std::unique_ptr<osci::Shape>>& actual,
+                           const std::vector<std::unique_ptr<osci::Shape>>& expected, const juce::String& what) {
+        expectEquals((int) actual.size(), (int) expected.size(), what + ": shape count");
+        if (actual.size() != expected.size()) {
+            return;
+        }
+
+        auto summarise = [](const std::vector<std::unique_ptr<osci::Shape>>& shapes, std::vector<double>& lengths, juce::Rectangle<double>& bounds) {
+            double minX = 1e9, minY = 1e9, maxX = -1e9, maxY = -1e9;
+            for (auto& shape : shapes) {
+                lengths.push_back(shape->length());
+                for (double t : { 0.0, 0.5, 1.0 }) {
+                    auto p = shape->nextVector(t);
+                    minX = juce::jmin(minX, (double) p.x);
+                    maxX = juce::jmax(maxX, (double) p.x);
+                    minY = juce::jmin(minY, (double) p.y);
+                    maxY = juce::jmax(maxY, (double) p.y);
+                }
+            }
+            std::sort(lengths.begin(), lengths.end());
+            bounds = { minX, minY, maxX - minX, maxY - minY };
+        };
+
+        std::vector<double> actualLengths, expectedLengths;
+        juce::Rectangle<double> actualBounds, expectedBounds;
+        summarise(actual, actualLengths, actualBounds);
+        summarise(expected, expectedLengths, expectedBounds);
+
+        double worst = 0.0;
+        for (size_t i = 0; i < actualLengths.size(); ++i) {
+            worst = juce::jmax(worst, std::abs(actualLengths[i] - expectedLengths[i]));
+        }
+        expectLessThan(worst, 1.0e-3, what + ": shape lengths");
+        expectWithinAbsoluteError(actualBounds.getX(), expectedBounds.getX(), 1.0e-3, what + ": left");
+        expectWithinAbsoluteError(actualBounds.getY(), expectedBounds.getY(), 1.0e-3, what + ": bottom");
+        expectWithinAbsoluteError(actualBounds.getWidth(), expectedBounds.getWidth(), 1.0e-3, what + ": width");
+        expectWithinAbsoluteError(actualBounds.getHeight(), expectedBounds.getHeight(), 1.0e-3, what + ": height");
+    }
+
+    void testMatchesWholeTextLayout() {
+        beginTest("Cached line layout draws the same as the whole-text layout");
+
+        auto font = makeFont();
+        for (juce::String text : { "osci-render", "first line\nsecond line\nthird", "top\n\nafter a blank line" }) {
+            TextParser parser(text, font);
+            expectSameDrawing(parser.draw(), layoutWholeText(text, font), text.replace("\n", "|"));
+        }
+    }
+
+    void testEditReusesUnchangedLines() {
+        beginTest("Editing one line reuses the other lines' layout");
+
+        auto font = makeFont();
+        TextParser first("alpha\nbeta\ngamma\nalpha", font);
+        expectEquals(first.getNumLines(), 4);
+        // The repeated line is laid out once
+        expectEquals(first.getNumLinesLaidOut(), 3);
+
+        const juce::String edited = "alpha\nBETA\ngamma\nalpha";
+        TextParser next(edited, font, &first);
+        expectEquals(next.getNumLines(), 4);
+        expectEquals(next.getNumLinesLaidOut(), 1);
+
+        TextParser fresh(edited, font);
+        expectEquals(fresh.getNumLinesLaidOut(), 3);
+        expectSameDrawing(next.draw(), fresh.draw(), "reused lines");
+    }
+
+    void testFontChangeInvalidates() {
+        beginTest("Font and style changes lay every line out again");
+
+        auto font = makeFont();
+        const juce::String text = "alpha\nbeta";
+        TextParser parser(text, font);
+        auto plain = parser.draw();
+        expectEquals(parser.getNumLinesLaidOut(), 2);
+
+        font = font.boldened();
+        auto bold = parser.draw();
+        expectEquals(parser.getNumLinesLaidOut(), 2);
+        TextParser freshBold(text, font);
+        expectSameDrawing(bold, freshBold.draw(), "bold");
+
+        // A parser for the same text in another style has nothing to reuse
+        auto italic = makeFont().italicised();
+        TextParser next(text, italic, &freshBold);
+        expectEquals(next.getNumLinesLaidOut(), 2);
+
+        auto taller = makeFont().withHeight(2.0f);
+        TextParser nextTaller(text, taller, &freshBold);
+        expectEquals(nextTaller.getNumLinesLaidOut(), 2);
+    }
+
+    void testOutlineCacheKeys() {
+        beginTest("Glyph outlines are shared per font and style");
+
+        GlyphOutlineCache cache;
+        auto font = makeFont();
+        juce::GlyphArrangement glyphs;
+        glyphs.addLineOfText(font, "A", 0.0f, 0.0f);
+        const int glyphCode = glyphs.getGlyph(0).getGlyphNumber();
+
+        auto outline = cache.getOutline(font, glyphCode);
+        expect(outline != nullptr && !outline->empty());
+        expect(cache.getOutline(font, glyphCode) == outline);
+        expectEquals(cache.getNumCached(), 1);
+
+        for (auto other : { font.boldened(), font.italicised(), font.withHeight(2.0f), font.withHorizontalScale(1.5f) }) {
+            expect(GlyphOutlineCache::getFontKey(other) != GlyphOutlineCache::getFontKey(font));
+            expect(cache.getOutline(other, glyphCode) != outline);
+        }
+        expectEquals(cache.getNumCached(), 5);
+    }
+
+    void testOutlineCacheEviction() {
+        beginTest("The outline cache empties at kMaxOutlines and held outlines survive");
+
+        GlyphOutlineCache cache;
+        auto font = makeFont();
+        auto held = cache.getOutline(font, 0);
+
+        // Distinct keys from a range of heights, so the font's glyph count
+        // doesn't matter
+        for (int i = 1; i < GlyphOutlineCache::kMaxOutlines; ++i) {
+            cache.getOutline(font.withHeight(1.0f + (float) (i / 64)), i % 64);
+        }
+        expectEquals(cache.getNumCached(), GlyphOutlineCache::kMaxOutlines);
+        expect(cache.getOutline(font, 0) == held, "Lookups don't evict");
+
+        cache.getOutline(font.withHeight(1000.0f), 1);
+        expectEquals(cache.getNumCached(), 1);
+        expect(held != nullptr && held.use_count() == 1, "Outlines in use outlive the cache");
+        expect(cache.getOutline(font, 0) != held);
+    }
+};
+
+static TextParserTest textParserTest;
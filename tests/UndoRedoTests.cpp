@@ -1,11 +1,13 @@
 #include <JuceHeader.h>
 #include "TestCleanup.h"
+#include "../Source/util/FileUndoActions.h"
 #include <unordered_map>
 
 // ============================================================================
 // Undo / Redo Tests — comprehensive coverage of the ValueTree-backed undo
 // system for FloatParameter, IntParameter, BooleanParameter, undoGrouping,
-// undoSuppressed, linked parameter coalescing, and effect precedence.
+// undoSuppressed, linked parameter coalescing, and effect precedence, plus
+// the splice-based history for file contents and the file list.
 // ============================================================================
 
 // ---------------------------------------------------------------------------
@@ -667,3 +669,420 @@ public:
     }
 };
 static ValueTreeSyncTest valueTreeSyncTest;
+
+// ============================================================================
+// ByteSplice — the diff file edits are stored as
+// ============================================================================
+
+class ByteSpliceTest : public juce::UnitTest {
+public:
+    ByteSpliceTest() : juce::UnitTest("Byte Splice", "Undo") {}
+
+    static juce::MemoryBlock block(const char* text) {
+        return juce::MemoryBlock(text, std::strlen(text));
+    }
+
+    static juce::String text(const juce::MemoryBlock& b) {
+        return b.toString();
+    }
+
+    void runTest() override {
+        beginTest("between() keeps only the changed bytes and round-trips");
+        {
+            auto before = block("the quick brown fox");
+            auto after = block("the quick red fox");
+            auto splice = ByteSplice::between(before, after);
+
+            expectEquals((int) splice.offset, 10);
+            expectEquals(text(splice.removed), juce::String("brown"));
+            expectEquals(text(splice.inserted), juce::String("red"));
+
+            auto applied = splice.apply(before);
+            expect(applied.has_value() && *applied == after, "apply should produce the new version");
+            auto reverted = splice.revert(after);
+            expect(reverted.has_value() && *reverted == before, "revert should produce the old version");
+        }
+
+        beginTest("between() handles repeated characters, empties and identical blocks");
+        {
+            auto splice = ByteSplice::between(block("aaa"), block("aaaa"));
+            expectEquals((int) splice.removed.getSize(), 0);
+            expectEquals((int) splice.inserted.getSize(), 1);
+            expect(*splice.apply(block("aaa")) == block("aaaa"));
+
+            auto fromEmpty = ByteSplice::between(juce::MemoryBlock(), block("abc"));
+            expect(*fromEmpty.apply(juce::MemoryBlock()) == block("abc"));
+            auto toEmpty = ByteSplice::between(block("abc"), juce::MemoryBlock());
+            expect(toEmpty.apply(block("abc"))->isEmpty());
+
+            expect(ByteSplice::between(block("same"), block("same")).isEmpty());
+        }
+
+        beginTest("apply() refuses a version it wasn't made against");
+        {
+            auto splice = ByteSplice::between(block("hello world"), block("hello there"));
+            expect(!splice.apply(block("hello")).has_value(), "Too short");
+            expect(!splice.apply(block("hello WORLD")).has_value(), "Different bytes");
+        }
+
+        beginTest("followedBy() merges typing and backspacing");
+        {
+            // "ab|" -> type "c" -> type "d" -> backspace -> "abc"
+            auto v0 = block("ab");
+            auto v1 = block("abc");
+            auto v2 = block("abcd");
+            auto v3 = block("abc");
+            auto s1 = ByteSplice::between(v0, v1);
+            auto s2 = ByteSplice::between(v1, v2);
+            auto s3 = ByteSplice::between(v2, v3);
+
+            auto merged = s1.followedBy(s2);
+            expect(merged.has_value(), "Adjacent inserts should merge");
+            merged = merged->followedBy(s3);
+            expect(merged.has_value(), "A backspace over typed text should merge");
+            expect(*merged->apply(v0) == v3);
+            expect(*merged->revert(v3) == v0);
+            expect(merged->getSizeInBytes() <= 2, "Merged splice should only hold what changed");
+        }
+
+        beginTest("followedBy() merges a replacement overlapping an earlier one");
+        {
+            auto v0 = block("0123456789");
+            auto v1 = block("012abc6789");
+            auto v2 = block("01XYZc6789");
+            auto merged = ByteSplice::between(v0, v1).followedBy(ByteSplice::between(v1, v2));
+            expect(merged.has_value());
+            expect(*merged->apply(v0) == v2);
+            expect(*merged->revert(v2) == v0);
+        }
+
+        beginTest("followedBy() leaves edits far apart unmerged");
+        {
+            auto v0 = block("0123456789");
+            auto v1 = block("x123456789");
+            auto v2 = block("x12345678y");
+            expect(!ByteSplice::between(v0, v1).followedBy(ByteSplice::between(v1, v2)).has_value());
+        }
+    }
+};
+static ByteSpliceTest byteSpliceTest;
+
+// ============================================================================
+// File undo — content edits and the file list
+// ============================================================================
+
+class FileUndoTest : public juce::UnitTest {
+public:
+    FileUndoTest() : juce::UnitTest("File Undo", "Undo") {}
+
+    struct TestFileList : public UndoableFileList {
+        std::vector<juce::String> names;
+        std::vector<std::shared_ptr<juce::MemoryBlock>> blocks;
+        std::vector<int> ids;
+        int nextId = 0;
+        int restored = 0;
+        std::vector<std::pair<int, juce::String>> restoredSettings;
+
+        void withFilesLocked(const std::function<void()>& edit) override { edit(); }
+        int numFiles() override { return (int) blocks.size(); }
+        juce::String getFileName(int index) override { return names[(size_t) index]; }
+        juce::String getFileId(int index) override { return juce::String(ids[(size_t) index]); }
+        std::shared_ptr<juce::MemoryBlock> getFileBlock(int index) override { return blocks[(size_t) index]; }
+        void updateFileBlock(int index, std::shared_ptr<juce::MemoryBlock> block) override { blocks[(size_t) index] = block; }
+        void insertFile(int index, juce::String fileName, std::shared_ptr<juce::MemoryBlock> data) override {
+            names.insert(names.begin() + index, fileName);
+            blocks.insert(blocks.begin() + index, data);
+            ids.insert(ids.begin() + index, nextId++);
+        }
+        void removeFile(int index) override {
+            names.erase(names.begin() + index);
+            blocks.erase(blocks.begin() + index);
+            ids.erase(ids.begin() + index);
+        }
+        void fileContentsRestored(int) override { restored++; }
+        void saveFileSettings(int index, juce::XmlElement& settings) override {
+            settings.setAttribute("tag", names[(size_t) index] + " settings");
+        }
+        void restoreFileSettings(int index, const juce::XmlElement& settings) override {
+            restoredSettings.push_back({ index, settings.getStringAttribute("tag") });
+        }
+
+        void add(const juce::String& name, size_t size) {
+            auto data = std::make_shared<juce::MemoryBlock>(size);
+            auto* bytes = static_cast<char*>(data->getData());
+            for (size_t i = 0; i < size; ++i)
+                bytes[i] = (char) ('a' + (i * 7 + names.size()) % 26);
+            names.push_back(name);
+            blocks.push_back(data);
+            ids.push_back(nextId++);
+        }
+    };
+
+    static ByteSplice insertion(size_t at, char c) {
+        ByteSplice splice;
+        splice.offset = at;
+        splice.inserted.append(&c, 1);
+        return splice;
+    }
+
+    static ByteSplice deletion(const juce::MemoryBlock& from, size_t at) {
+        ByteSplice splice;
+        splice.offset = at;
+        splice.removed.append(static_cast<const char*>(from.getData()) + at, 1);
+        return splice;
+    }
+
+    static int undoAll(juce::UndoManager& um) {
+        int count = 0;
+        while (um.canUndo() && um.undo())
+            count++;
+        return count;
+    }
+
+    void runTest() override {
+        beginTest("Content edit undo/redo, notifying only on undo and redo");
+        {
+            TestFileList files;
+            files.add("a.lua", 64);
+            auto original = files.blocks[0];
+            juce::MemoryBlock edited(*original);
+            edited.append("-- edited", 9);
+
+            juce::UndoManager um;
+            um.beginNewTransaction("Edit a.lua");
+            um.perform(FileContentChangeAction::fromEdit(files, 0, edited));
+            expect(*files.blocks[0] == edited);
+            expectEquals(files.restored, 0, "First perform comes from the editor, which already shows it");
+
+            um.undo();
+            expect(*files.blocks[0] == *original);
+            expectEquals(files.restored, 1);
+
+            um.redo();
+            expect(*files.blocks[0] == edited);
+            expectEquals(files.restored, 2);
+        }
+
+        beginTest("Typing coalesces into one action; edits far apart don't");
+        {
+            TestFileList files;
+            files.add("a.txt", 100);
+            auto original = *files.blocks[0];
+
+            juce::UndoManager um;
+            um.beginNewTransaction("Edit a.txt");
+            for (int i = 0; i < 5; ++i)
+                um.perform(new FileContentChangeAction(files, 0, "a.txt", insertion(10 + (size_t) i, 'x')));
+            um.perform(new FileContentChangeAction(files, 0, "a.txt", deletion(*files.blocks[0], 14)));
+            expectEquals(um.getNumActionsInCurrentTransaction(), 1, "Adjacent keystrokes should coalesce");
+
+            um.perform(new FileContentChangeAction(files, 0, "a.txt", insertion(80, 'y')));
+            expectEquals(um.getNumActionsInCurrentTransaction(), 2, "A distant edit stays separate");
+
+            um.undo();
+            expect(*files.blocks[0] == original, "One undo reverts the whole run of typing");
+        }
+
+        beginTest("An edit aimed at a file that has since moved is refused");
+        {
+            TestFileList files;
+            files.add("a.txt", 32);
+            files.add("b.txt", 32);
+
+            juce::UndoManager um;
+            um.beginNewTransaction();
+            um.perform(new FileContentChangeAction(files, 1, "b.txt", insertion(0, 'z')));
+            files.removeFile(0);
+            auto before = files.blocks[0];
+            um.undo();
+            expect(files.blocks[0] == before, "b.txt is no longer at index 1, so nothing is changed");
+            expect(!um.canUndo() && !um.canRedo(), "A failed undo clears the history");
+        }
+
+        beginTest("Thousands of edits across a large project cost only what changed");
+        {
+            const int numFiles = 16;
+            const size_t fileSize = 256 * 1024;
+            const int numTransactions = 160;
+            const int keystrokesPerTransaction = 25;
+
+            TestFileList files;
+            for (int i = 0; i < numFiles; ++i)
+                files.add("file" + juce::String(i) + ".txt", fileSize);
+            auto originals = files.blocks;
+
+            // Far less than a single copy of any file: if history held
+            // copies, the cap would leave almost nothing to undo.
+            juce::UndoManager um;
+            um.setMaxNumberOfStoredUnits(64 * 1024, 1);
+
+            juce::Random random(1234);
+            // The last few files are never touched.
+            const int editedFiles = numFiles - 4;
+            for (int t = 0; t < numTransactions; ++t) {
+                const int index = t % editedFiles;
+                const auto name = files.names[(size_t) index];
+                size_t cursor = (size_t) random.nextInt((int) fileSize);
+                um.beginNewTransaction("Edit " + name);
+                for (int k = 0; k < keystrokesPerTransaction; ++k) {
+                    if (k % 5 == 4) {
+                        cursor--;
+                        um.perform(new FileContentChangeAction(files, index, name, deletion(*files.blocks[(size_t) index], cursor)));
+                    } else {
+                        um.perform(new FileContentChangeAction(files, index, name, insertion(cursor++, (char) ('A' + k))));
+                    }
+                }
+            }
+            auto finals = files.blocks;
+
+            for (int i = editedFiles; i < numFiles; ++i)
+                expect(files.blocks[(size_t) i] == originals[(size_t) i], "Untouched files keep sharing their block");
+
+            expectEquals(undoAll(um), numTransactions, "Every transaction should fit under the cap");
+            bool allRestored = true;
+            for (int i = 0; i < numFiles; ++i)
+                allRestored = allRestored && *files.blocks[(size_t) i] == *originals[(size_t) i];
+            expect(allRestored, "Undoing everything restores every file byte for byte");
+
+            int redone = 0;
+            while (um.canRedo() && um.redo())
+                redone++;
+            expectEquals(redone, numTransactions);
+            bool allRedone = true;
+            for (int i = 0; i < numFiles; ++i)
+                allRedone = allRedone && *files.blocks[(size_t) i] == *finals[(size_t) i];
+            expect(allRedone, "Redoing everything gets back to the final state");
+        }
+
+        beginTest("Add and remove share the file's block rather than copying it");
+        {
+            TestFileList files;
+            files.add("a.txt", 1024);
+            auto block = std::make_shared<juce::MemoryBlock>(2048);
+
+            juce::UndoManager um;
+            um.beginNewTransaction("Open b.txt");
+            um.perform(FileListChangeAction::add(files, "b.txt", block));
+            expectEquals(files.numFiles(), 2);
+            expect(files.blocks[1] == block);
+
+            um.beginNewTransaction("Close a.txt");
+            auto a = files.blocks[0];
+            um.perform(FileListChangeAction::remove(files, 0));
+            expectEquals(files.numFiles(), 1);
+            expectEquals(files.names[0], juce::String("b.txt"));
+
+            um.undo();
+            expectEquals(files.numFiles(), 2);
+            expectEquals(files.names[0], juce::String("a.txt"));
+            expect(files.blocks[0] == a, "Undoing a close puts back the same block");
+
+            um.undo();
+            expectEquals(files.numFiles(), 1);
+            um.redo();
+            expect(files.blocks[1] == block);
+        }
+
+        beginTest("Undoing an open still closes the file after its edits are undone");
+        {
+            TestFileList files;
+            auto block = std::make_shared<juce::MemoryBlock>(256);
+
+            juce::UndoManager um;
+            um.beginNewTransaction("Open a.lua");
+            um.perform(FileListChangeAction::add(files, "a.lua", block));
+            um.beginNewTransaction("Edit a.lua");
+            um.perform(new FileContentChangeAction(files, 0, "a.lua", insertion(4, 'x')));
+
+            expect(um.undo());
+            expect(files.blocks[0] != block, "Undoing the edit publishes a new block");
+            expect(*files.blocks[0] == *block);
+
+            expect(um.undo(), "Undoing the open should find the file by its id");
+            expectEquals(files.numFiles(), 0);
+            expect(um.canRedo(), "History survives the undo");
+
+            expect(um.redo());
+            expect(um.redo());
+            expectEquals(files.numFiles(), 1);
+            expectEquals(files.blocks[0]->getSize(), (size_t) 257);
+        }
+
+        beginTest("Redoing a close finds the file after its edits are undone and redone");
+        {
+            TestFileList files;
+            files.add("a.txt", 64);
+            files.add("b.txt", 64);
+
+            juce::UndoManager um;
+            um.beginNewTransaction("Edit b.txt");
+            um.perform(new FileContentChangeAction(files, 1, "b.txt", insertion(0, 'z')));
+            auto edited = *files.blocks[1];
+            um.beginNewTransaction("Close b.txt");
+            um.perform(FileListChangeAction::remove(files, 1));
+            expectEquals(files.numFiles(), 1);
+
+            expect(um.undo());
+            expect(um.undo());
+            expect(um.redo());
+            expect(*files.blocks[1] == edited);
+
+            expect(um.redo(), "The reopened file has new blocks but the same id");
+            expectEquals(files.numFiles(), 1);
+            expectEquals(files.names[0], juce::String("a.txt"));
+
+            expect(um.undo());
+            expectEquals(files.numFiles(), 2);
+            expect(*files.blocks[1] == edited, "Undoing the close again puts back the edited contents");
+        }
+
+        beginTest("Undoing a close restores the file's settings");
+        {
+            TestFileList files;
+            files.add("a.txt", 32);
+            files.add("b.txt", 32);
+
+            juce::UndoManager um;
+            um.beginNewTransaction("Open c.txt");
+            um.perform(FileListChangeAction::add(files, "c.txt", std::make_shared<juce::MemoryBlock>(8)));
+            expectEquals((int) files.restoredSettings.size(), 1);
+            expectEquals(files.restoredSettings[0].second, juce::String(), "A newly opened file has no settings yet");
+
+            um.beginNewTransaction("Close a.txt");
+            um.perform(FileListChangeAction::remove(files, 0));
+            um.undo();
+            expectEquals((int) files.restoredSettings.size(), 2);
+            expectEquals(files.restoredSettings[1].first, 0);
+            expectEquals(files.restoredSettings[1].second, juce::String("a.txt settings"));
+        }
+
+        beginTest("The memory cap drops the oldest closed files");
+        {
+            const size_t fileSize = 256 * 1024;
+            TestFileList files;
+            for (int i = 0; i < 4; ++i)
+                files.add("file" + juce::String(i) + ".txt", fileSize);
+
+            std::vector<std::weak_ptr<juce::MemoryBlock>> closed;
+            for (auto& b : files.blocks)
+                closed.push_back(b);
+
+            juce::UndoManager um;
+            um.setMaxNumberOfStoredUnits((int) (fileSize + fileSize / 2), 1);
+            for (int i = 0; i < 4; ++i) {
+                um.beginNewTransaction("Close");
+                um.perform(FileListChangeAction::remove(files, 0));
+            }
+            expectEquals(files.numFiles(), 0);
+
+            for (int i = 0; i < 3; ++i)
+                expect(closed[(size_t) i].expired(), "Dropped history frees the file it held");
+            expect(!closed[3].expired(), "The newest close is still undoable");
+
+            expectEquals(undoAll(um), 1);
+            expectEquals(files.numFiles(), 1);
+            expectEquals(files.names[0], juce::String("file3.txt"));
+        }
+    }
+};
+static FileUndoTest fileUndoTest;
@@ -0,0 +1,142 @@
+#include <JuceHeader.h>
+#include "../Source/util/VersionedSnapshot.h"
+
+// ============================================================================
+// Versioned Snapshot Tests — readers keep the version they pinned, replaced
+// versions are only freed once no reader or holder can see them, and a
+// reader thread racing a publishing thread never sees a freed value.
+// ============================================================================
+
+class VersionedSnapshotTest : public juce::UnitTest {
+public:
+    VersionedSnapshotTest() : juce::UnitTest("Versioned Snapshot", "Util") {}
+
+    void runTest() override {
+        testReadersSeeLatest();
+        testPinnedVersionSurvivesPublish();
+        testHeldVersionSurvivesReader();
+        testConcurrentReaders();
+    }
+
+private:
+    // Counts live instances so tests can see when versions are freed.
+    struct Tracked {
+        explicit Tracked(int value, std::atomic<int>& live) : value(value), live(live), check(value * 7) {
+            live.fetch_add(1);
+        }
+        ~Tracked() {
+            check = -1;
+            live.fetch_sub(1);
+        }
+        int value;
+        std::atomic<int>& live;
+        int check;
+    };
+
+    void testReadersSeeLatest() {
+        beginTest("Readers see the latest published version");
+
+        std::atomic<int> live { 0 };
+        {
+            VersionedSnapshot<Tracked> snapshot(std::make_unique<Tracked>(0, live));
+            for (int i = 1; i <= 10; i++) {
+                snapshot.publish(std::make_unique<Tracked>(i, live));
+                VersionedSnapshot<Tracked>::Reader reader(snapshot);
+                expectEquals(reader->value, i);
+                expectEquals((int) reader.getVersion(), i + 1);
+            }
+            // Nothing pinned, so only the current version is alive.
+            snapshot.collect();
+            expectEquals(live.load(), 1);
+            expectEquals(snapshot.getNumRetired(), 0);
+        }
+        expectEquals(live.load(), 0);
+    }
+
+    void testPinnedVersionSurvivesPublish() {
+        beginTest("A pinned version is kept until its reader goes away");
+
+        std::atomic<int> live { 0 };
+        VersionedSnapshot<Tracked> snapshot(std::make_unique<Tracked>(1, live));
+        {
+            VersionedSnapshot<Tracked>::Reader reader(snapshot);
+            for (int i = 2; i <= 5; i++) {
+                snapshot.publish(std::make_unique<Tracked>(i, live));
+            }
+            expectEquals(reader->value, 1);
+            expectEquals(reader->check, 7);
+            expectGreaterThan(live.load(), 1);
+        }
+        snapshot.collect();
+        expectEquals(live.load(), 1);
+    }
+
+    void testHeldVersionSurvivesReader() {
+        beginTest("A held version is kept until a later one is held");
+
+        std::atomic<int> live { 0 };
+        VersionedSnapshot<Tracked> snapshot(std::make_unique<Tracked>(1, live));
+        const Tracked* held = nullptr;
+        {
+            VersionedSnapshot<Tracked>::Reader reader(snapshot);
+            held = reader.get();
+            snapshot.hold(reader);
+        }
+
+        snapshot.publish(std::make_unique<Tracked>(2, live));
+        snapshot.publish(std::make_unique<Tracked>(3, live));
+        snapshot.collect();
+        // Version 2 was never held, so only 1 (held) and 3 (current) remain.
+        expectEquals(live.load(), 2);
+        expectEquals(held->check, 7);
+
+        {
+            VersionedSnapshot<Tracked>::Reader reader(snapshot);
+            snapshot.hold(reader);
+        }
+        snapshot.collect();
+        expectEquals(live.load(), 1);
+    }
+
+    void testConcurrentReaders() {
+        beginTest("Concurrent reads never see a freed version");
+
+        std::atomic<int> live { 0 };
+        VersionedSnapshot<Tracked> snapshot(std::make_unique<Tracked>(0, live));
+        std::atomic<bool> stop { false };
+        std::atomic<int> bad { 0 };
+        std::atomic<int> reads { 0 };
+
+        // Reads like renderBlock: pin, use, hold, unpin.
+        std::thread reader([&] {
+            const Tracked* held = nullptr;
+            while (!stop.load()) {
+                VersionedSnapshot<Tracked>::Reader pinned(snapshot);
+                if (pinned->check != pinned->value * 7) {
+                    bad.fetch_add(1);
+                }
+                if (held != nullptr && held->check != held->value * 7) {
+                    bad.fetch_add(1);
+                }
+                held = pinned.get();
+                snapshot.hold(pinned);
+                reads.fetch_add(1);
+            }
+        });
+
+        for (int i = 1; i <= 20000; i++) {
+            snapshot.publish(std::make_unique<Tracked>(i, live));
+        }
+        stop.store(true);
+        reader.join();
+
+        expectEquals(bad.load(), 0);
+        expectGreaterThan(reads.load(), 0);
+        // Once the reader has stopped, only its held version is left over.
+        snapshot.collect();
+        expectLessThan(snapshot.getNumRetired(), 2);
+        expectLessThan(live.load(), 3);
+    }
+};
+
+static VersionedSnapshotTest versionedSnapshotTest;
@@ -0,0 +1,234 @@
+#include <JuceHeader.h>
+#include "../Source/audio/wav/WaveformPeaks.h"
+#include "../Source/audio/wav/WaveformThumbnail.h"
+
+// ============================================================================
+// Waveform Peaks Tests — the timeline's peak pyramid keeps the true extent of
+// X and Y at every level, averages colour channels, and reads back exactly
+// what was written to its cache file. The thumbnail's cache is keyed cheaply
+// for files and trimmed least recently used first.
+// ============================================================================
+
+class WaveformPeaksTest : public juce::UnitTest {
+public:
+    WaveformPeaksTest() : juce::UnitTest("Waveform Peaks", "Audio") {}
+
+    void runTest() override {
+        testPyramidShape();
+        testExtentsSurviveMerging();
+        testColumns();
+        testColour();
+        testRoundTrip();
+        testFileCacheKey();
+        testCacheTrim();
+    }
+
+private:
+    // A ramp on X and a single spike on Y at spikeAt.
+    static std::unique_ptr<WaveformPeaks> buildRamp(int numSamples, int spikeAt, int chunkSize = 1000) {
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        for (int i = 0; i < numSamples; ++i) {
+            buffer.setSample(0, i, -1.0f + 2.0f * (float) i / (float) (numSamples - 1));
+            buffer.setSample(1, i, i == spikeAt ? 0.9f : 0.0f);
+        }
+
+        WaveformPeaks::Builder builder(WaveformPeaks::Channels::forFile(2, ChannelLayout()));
+        // Feed it in uneven chunks, as a reader would.
+        for (int pos = 0; pos < numSamples; pos += chunkSize) {
+            const int n = juce::jmin(chunkSize, numSamples - pos);
+            const float* channels[] = { buffer.getReadPointer(0, pos), buffer.getReadPointer(1, pos) };
+            builder.addSamples(channels, 2, n);
+        }
+        return builder.finish(48000.0);
+    }
+
+    void testPyramidShape() {
+        beginTest("Levels shrink by the fan-out down to one bucket");
+
+        const int numSamples = 100000;
+        auto peaks = buildRamp(numSamples, 5000);
+        expectEquals(peaks->getTotalSamples(), (juce::int64) numSamples);
+
+        const int baseBuckets = (numSamples + WaveformPeaks::kBaseBucketSize - 1) / WaveformPeaks::kBaseBucketSize;
+        expectEquals((int) peaks->getLevel(0).size(), baseBuckets);
+        for (int l = 1; l < peaks->getNumLevels(); ++l) {
+            const int below = (int) peaks->getLevel(l - 1).size();
+            expectEquals((int) peaks->getLevel(l).size(), (below + WaveformPeaks::kFanout - 1) / WaveformPeaks::kFanout);
+        }
+        expectEquals((int) peaks->getLevel(peaks->getNumLevels() - 1).size(), 1);
+
+        uint32_t counted = 0;
+        for (const auto& b : peaks->getLevel(0)) counted += b.numSamples;
+        expectEquals((int) counted, numSamples);
+
+        auto empty = WaveformPeaks::Builder(WaveformPeaks::Channels()).finish(48000.0);
+        expect(empty->isEmpty());
+    }
+
+    void testExtentsSurviveMerging() {
+        beginTest("A one-sample spike shows at every level");
+
+        auto peaks = buildRamp(100000, 54321, 777);
+        for (int l = 0; l < peaks->getNumLevels(); ++l) {
+            float maxY = 0.0f;
+            for (const auto& b : peaks->getLevel(l)) maxY = juce::jmax(maxY, b.maxY);
+            expectWithinAbsoluteError(maxY, 0.9f, 1e-6f, "Level " + juce::String(l));
+        }
+
+        const auto& top = peaks->getLevel(peaks->getNumLevels() - 1)[0];
+        expectWithinAbsoluteError(top.minX, -1.0f, 1e-6f);
+        expectWithinAbsoluteError(top.maxX, 1.0f, 1e-6f);
+    }
+
+    void testColumns() {
+        beginTest("Columns cover their part of the file at any zoom");
+
+        const int numSamples = 100000;
+        auto peaks = buildRamp(numSamples, 5000);
+        std::vector<PeakBucket> columns;
+
+        peaks->getColumns(0.0, 1.0, 10, columns);
+        expectEquals((int) columns.size(), 10);
+        for (int c = 0; c < 10; ++c) {
+            // The ramp crosses this column's share of [-1, 1], give or take a
+            // bucket (4096 samples at this zoom) at each edge.
+            const float lo = -1.0f + 0.2f * c;
+            const float slack = 0.1f;
+            expect(columns[(size_t) c].minX <= lo + 0.001f && columns[(size_t) c].minX >= lo - slack,
+                   "Column " + juce::String(c) + " min " + juce::String(columns[(size_t) c].minX));
+            expect(columns[(size_t) c].maxX >= lo + 0.2f - 0.001f && columns[(size_t) c].maxX <= lo + 0.2f + slack);
+        }
+        expectWithinAbsoluteError(columns[0].maxY, 0.9f, 1e-6f, "Spike is in the first column");
+        expectEquals(columns[5].maxY, 0.0f);
+
+        // Zoomed in past the base resolution, every column still has data.
+        peaks->getColumns(0.5, 0.501, 400, columns);
+        for (const auto& column : columns) {
+            expect(column.numSamples > 0);
+            expect(column.minX > -0.01f && column.maxX < 0.01f);
+        }
+
+        peaks->getColumns(0.0, 1.0, 0, columns);
+        expect(columns.empty());
+    }
+
+    void testColour() {
+        beginTest("Colour channels are averaged per bucket");
+
+        const int numSamples = 4096;
+        auto layout = ChannelLayout::fromMask(ChannelLayout::kMaskXYRGB);
+        auto channels = WaveformPeaks::Channels::forFile(5, layout);
+        expect(channels.hasColour());
+        expectEquals(channels.red, 2);
+
+        juce::AudioBuffer<float> buffer(5, numSamples);
+        buffer.clear();
+        for (int i = 0; i < numSamples; ++i) {
+            // Red for the first half, blue for the second.
+            buffer.setSample(i < numSamples / 2 ? 2 : 4, i, 1.0f);
+        }
+
+        WaveformPeaks::Builder builder(channels);
+        builder.addSamples(buffer.getArrayOfReadPointers(), 5, numSamples);
+        auto peaks = builder.finish(48000.0);
+        expect(peaks->hasColour());
+
+        const auto& first = peaks->getLevel(0).front();
+        expectWithinAbsoluteError(first.red, 1.0f, 1e-6f);
+        expectWithinAbsoluteError(first.blue, 0.0f, 1e-6f);
+
+        const auto& top = peaks->getLevel(peaks->getNumLevels() - 1)[0];
+        expectWithinAbsoluteError(top.red, 0.5f, 1e-4f);
+        expectWithinAbsoluteError(top.blue, 0.5f, 1e-4f);
+        expectWithinAbsoluteError(top.green, 0.0f, 1e-6f);
+
+        expect(!WaveformPeaks::Channels::forFile(2, ChannelLayout()).hasColour());
+        expect(WaveformPeaks::Channels::forFile(6, ChannelLayout()).hasColour());
+    }
+
+    void testRoundTrip() {
+        beginTest("Cache file round trip");
+
+        auto peaks = buildRamp(50000, 1234);
+        juce::MemoryOutputStream out;
+        peaks->writeTo(out);
+
+        juce::MemoryInputStream in(out.getData(), out.getDataSize(), false);
+        auto loaded = WaveformPeaks::readFrom(in);
+        expect(loaded != nullptr);
+        if (loaded == nullptr) return;
+
+        expectEquals(loaded->getTotalSamples(), peaks->getTotalSamples());
+        expectEquals(loaded->getSampleRate(), peaks->getSampleRate());
+        expectEquals(loaded->getNumLevels(), peaks->getNumLevels());
+        for (int l = 0; l < peaks->getNumLevels(); ++l) {
+            const auto& a = peaks->getLevel(l);
+            const auto& b = loaded->getLevel(l);
+            expectEquals((int) b.size(), (int) a.size());
+            bool same = a.size() == b.size();
+            for (size_t i = 0; same && i < a.size(); ++i) {
+                same = a[i].minX == b[i].minX && a[i].maxX == b[i].maxX && a[i].minY == b[i].minY
+                    && a[i].maxY == b[i].maxY && a[i].numSamples == b[i].numSamples;
+            }
+            expect(same, "Level " + juce::String(l) + " differs after reload");
+        }
+
+        // Truncated or foreign data is rejected rather than half-loaded.
+        juce::MemoryInputStream truncated(out.getData(), out.getDataSize() / 2, false);
+        expect(WaveformPeaks::readFrom(truncated) == nullptr);
+        const char garbage[] = "not a peaks file at all";
+        juce::MemoryInputStream foreign(garbage, sizeof(garbage), false);
+        expect(WaveformPeaks::readFrom(foreign) == nullptr);
+    }
+
+    void testFileCacheKey() {
+        beginTest("Files are keyed by path, size and modification time");
+
+        juce::TemporaryFile temp(".wav");
+        const auto file = temp.getFile();
+        expect(WaveformThumbnail::getCacheKeyFor(file).isEmpty(), "A missing file has no key");
+
+        expect(file.replaceWithText("first"));
+        file.setLastModificationTime(juce::Time(2020, 0, 1, 0, 0));
+        const auto key = WaveformThumbnail::getCacheKeyFor(file);
+        expect(key.isNotEmpty());
+        expectEquals(WaveformThumbnail::getCacheKeyFor(file), key);
+
+        expect(file.replaceWithText("second, longer"));
+        file.setLastModificationTime(juce::Time(2020, 0, 1, 0, 0));
+        expect(WaveformThumbnail::getCacheKeyFor(file) != key, "A different size changes the key");
+
+        expect(file.replaceWithText("first"));
+        file.setLastModificationTime(juce::Time(2021, 0, 1, 0, 0));
+        expect(WaveformThumbnail::getCacheKeyFor(file) != key, "A new modification time changes the key");
+    }
+
+    void testCacheTrim() {
+        beginTest("Trimming the cache deletes the least recently used files first");
+
+        const auto dir = juce::File::createTempFile("waveform-cache");
+        expect(dir.createDirectory());
+
+        // Oldest first.
+        juce::Array<juce::File> files;
+        for (int i = 0; i < 4; ++i) {
+            auto file = dir.getChildFile("peaks" + juce::String(i) + ".peaks");
+            juce::MemoryBlock data(1000, true);
+            expect(file.replaceWithData(data.getData(), data.getSize()));
+            file.setLastModificationTime(juce::Time(2020, 0, 1 + i, 0, 0));
+            files.add(file);
+        }
+        auto other = dir.getChildFile("notes.txt");
+        expect(other.replaceWithText("not a cache file"));
+
+        expectEquals(WaveformThumbnail::trimCache(dir, 4000), 0);
+        expectEquals(WaveformThumbnail::trimCache(dir, 2500), 2);
+        expect(!files[0].exists() && !files[1].exists());
+        expect(files[2].exists() && files[3].exists());
+        expect(other.exists(), "Only cache files are trimmed");
+
+        dir.deleteRecursively();
+    }
+};
+
+static WaveformPeaksTest waveformPeaksTest;